@@ -37,6 +37,8 @@
 #include "src/shared/types/column_wrapper.h"
 #include "src/table_store/test_utils.h"
 
+DECLARE_int64(carnot_exec_threads);
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -130,6 +132,17 @@ void BM_Query_Int(benchmark::State& state, std::vector<types::DataType> types,
   BM_Query(state, types, distribution_types, query, num_batches, default_params, default_params);
 }
 
+// Runs the query with state.range(1) exec threads.
+// NOLINTNEXTLINE : runtime/references.
+void BM_Query_Int_Threads(benchmark::State& state, std::vector<types::DataType> types,
+                          std::vector<datagen::DistributionType> distribution_types,
+                          const std::string& query, int64_t num_batches) {
+  auto default_threads = FLAGS_carnot_exec_threads;
+  FLAGS_carnot_exec_threads = state.range(1);
+  BM_Query_Int(state, types, distribution_types, query, num_batches);
+  FLAGS_carnot_exec_threads = default_threads;
+}
+
 const std::unique_ptr<const datagen::DistributionParams> sample_selection_params =
     std::make_unique<const datagen::ZipfianParams>(2, 2, 999);
 const std::unique_ptr<const datagen::DistributionParams> sample_length_params =
@@ -198,6 +211,31 @@ BENCHMARK_CAPTURE(BM_Query_Int, eval_group_by_one_exponential_int,
     ->RangeMultiplier(2)
     ->Range(1, 1 << 16);
 
+BENCHMARK_CAPTURE(BM_Query_Int, eval_group_by_two_exponential_ints,
+                  {types::DataType::INT64, types::DataType::INT64, types::DataType::INT64},
+                  {datagen::DistributionType::kExponential, datagen::DistributionType::kExponential,
+                   datagen::DistributionType::kUniform},
+                  kGroupByTwoQuery, 20)
+    ->RangeMultiplier(2)
+    ->Range(1, 1 << 16);
+
+// Parallel pipeline tests
+BENCHMARK_CAPTURE(BM_Query_Int_Threads, eval_group_by_none_threads,
+                  {types::DataType::INT64, types::DataType::INT64},
+                  {datagen::DistributionType::kUniform, datagen::DistributionType::kUniform},
+                  kGroupByNoneQuery, 200)
+    ->Args({1 << 16, 1})
+    ->Args({1 << 16, 4})
+    ->Args({1 << 16, 16});
+
+BENCHMARK_CAPTURE(BM_Query_Int_Threads, eval_group_by_one_uniform_int_threads,
+                  {types::DataType::INT64, types::DataType::INT64},
+                  {datagen::DistributionType::kUniform, datagen::DistributionType::kUniform},
+                  kGroupByOneQuery, 200)
+    ->Args({1 << 16, 1})
+    ->Args({1 << 16, 4})
+    ->Args({1 << 16, 16});
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
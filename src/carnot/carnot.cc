@@ -172,6 +172,7 @@ Status CarnotImpl::RegisterUDFsInPlanFragment(exec::ExecState* exec_state, plan:
         return WalkExpression(exec_state, *filter.expression());
       })
       .OnLimit(no_op)
+      .OnSort(no_op)
       .OnMemorySink(no_op)
       .OnMemorySource(no_op)
       .OnUnion(no_op)
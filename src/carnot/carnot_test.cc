@@ -38,6 +38,8 @@
 #include "src/common/testing/testing.h"
 #include "src/table_store/table_store.h"
 
+DECLARE_int64(carnot_exec_threads);
+
 namespace px {
 namespace carnot {
 
@@ -441,6 +443,33 @@ px.display(aggDF, 'test_output'))pxl";
   EXPECT_EQ(expected, actual);
 }
 
+TEST_F(CarnotTest, parallel_group_by_test) {
+  PX_SET_FOR_SCOPE(FLAGS_carnot_exec_threads, 4);
+  auto query = R"pxl(
+import px
+queryDF = px.DataFrame(table='big_test_table', select=['time_', 'col3', 'num_groups', 'string_groups'])
+queryDF = queryDF[queryDF.col3 > 0]
+aggDF = queryDF.groupby(['num_groups', 'string_groups']).agg(sum=('col3', px.sum))
+px.display(aggDF, 'test_output'))pxl";
+  ASSERT_OK(carnot_->ExecuteQuery(query, sole::uuid4(), 0));
+
+  EXPECT_THAT(result_server_->output_tables(), UnorderedElementsAre("test_output"));
+  std::map<std::pair<int64_t, std::string>, int64_t> actual;
+  for (const auto& rb : result_server_->query_results("test_output")) {
+    auto num_grp = static_cast<arrow::Int64Array*>(rb.ColumnAt(0).get());
+    auto str_grp = static_cast<arrow::StringArray*>(rb.ColumnAt(1).get());
+    auto agg = static_cast<arrow::Int64Array*>(rb.ColumnAt(2).get());
+    for (int i = 0; i < rb.num_rows(); ++i) {
+      actual[{num_grp->Value(i), str_grp->GetString(i)}] += agg->Value(i);
+    }
+  }
+
+  std::map<std::pair<int64_t, std::string>, int64_t> expected = {
+      {{1, "sum"}, 6}, {{1, "mean"}, 7}, {{3, "sum"}, 24}, {{2, "sum"}, 60}, {{2, "mean"}, 69},
+  };
+  EXPECT_EQ(expected, actual);
+}
+
 TEST_F(CarnotTest, string_filter) {
   std::string query = R"pxl(
 import px
@@ -0,0 +1,206 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <grpcpp/grpcpp.h>
+
+#include "src/carnot/carnot.h"
+#include "src/carnot/exec/grpc_router.h"
+#include "src/carnot/exec/local_grpc_result_server.h"
+#include "src/carnot/exec/test_utils.h"
+#include "src/carnot/funcs/funcs.h"
+#include "src/carnot/planner/logical_planner.h"
+#include "src/carnot/planner/test_utils.h"
+#include "src/carnot/udf_exporter/udf_exporter.h"
+#include "src/common/testing/testing.h"
+#include "src/table_store/table_store.h"
+
+namespace px {
+namespace carnot {
+
+using table_store::schema::RowBatch;
+using table_store::schema::RowDescriptor;
+
+constexpr char kSchema[] = R"proto(
+relation_map {
+  key: "http_events"
+  value {
+    columns {
+      column_name: "time_"
+      column_type: TIME64NS
+      column_semantic_type: ST_NONE
+    }
+    columns {
+      column_name: "req_path"
+      column_type: STRING
+      column_semantic_type: ST_NONE
+    }
+    columns {
+      column_name: "resp_status"
+      column_type: INT64
+      column_semantic_type: ST_NONE
+    }
+  }
+}
+)proto";
+
+constexpr char kQuery[] = R"pxl(
+import px
+df = px.DataFrame(table='http_events')
+df = df.groupby('req_path').agg(count=('resp_status', px.count))
+px.display(df, 'out')
+)pxl";
+
+// The Kelvin addresses of CreateTwoPEMsTwoKelvinsPlannerState.
+constexpr char kGatherKelvinAddress[] = "1111";
+constexpr char kPartitionKelvinAddress[] = "1112";
+
+/**
+ * Runs a query planned over two PEMs and two Kelvins on four local Carnot instances. The Kelvins'
+ * GRPC routers are served in process, so that the PEMs' partitioned sinks and the partition
+ * Kelvin's sink reach them without opening a port.
+ */
+class DistributedShuffleTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    Test::SetUp();
+    result_server_ = std::make_unique<exec::LocalGRPCResultSinkServer>();
+    for (const auto& address : {kGatherKelvinAddress, kPartitionKelvinAddress}) {
+      kelvins_[address] = CreateCarnot(std::make_shared<table_store::TableStore>(), address);
+    }
+    pem_tables_["pem1"] = HTTPEventsTable({"/a", "/b", "/c", "/a", "/d", "/a"});
+    pem_tables_["pem2"] = HTTPEventsTable({"/b", "/a", "/e", "/b", "/c"});
+    for (const auto& [pem, table] : pem_tables_) {
+      auto table_store = std::make_shared<table_store::TableStore>();
+      table_store->AddTable("http_events", table);
+      pems_[pem] = CreateCarnot(table_store, "");
+    }
+  }
+
+  void TearDown() override {
+    for (auto& [address, server] : kelvin_servers_) {
+      server->Shutdown();
+    }
+  }
+
+  static std::shared_ptr<table_store::Table> HTTPEventsTable(
+      const std::vector<std::string>& req_paths) {
+    table_store::schema::Relation rel({types::TIME64NS, types::STRING, types::INT64},
+                                      {"time_", "req_path", "resp_status"});
+    auto table = table_store::Table::Create("http_events", rel);
+    std::vector<types::Time64NSValue> times;
+    std::vector<types::StringValue> paths;
+    std::vector<types::Int64Value> statuses;
+    for (const auto& path : req_paths) {
+      times.push_back(static_cast<int64_t>(times.size()));
+      paths.push_back(path);
+      statuses.push_back(200);
+    }
+    RowBatch rb(RowDescriptor(rel.col_types()), req_paths.size());
+    PX_CHECK_OK(rb.AddColumn(types::ToArrow(times, arrow::default_memory_pool())));
+    PX_CHECK_OK(rb.AddColumn(types::ToArrow(paths, arrow::default_memory_pool())));
+    PX_CHECK_OK(rb.AddColumn(types::ToArrow(statuses, arrow::default_memory_pool())));
+    PX_CHECK_OK(table->WriteRowBatch(rb));
+    return table;
+  }
+
+  // Creates a Carnot. If kelvin_address is set, its GRPC router is served in process under that
+  // address.
+  std::unique_ptr<Carnot> CreateCarnot(std::shared_ptr<table_store::TableStore> table_store,
+                                       const std::string& kelvin_address) {
+    auto func_registry = std::make_unique<udf::Registry>("default_registry");
+    funcs::RegisterFuncsOrDie(func_registry.get());
+    auto clients_config = std::make_unique<Carnot::ClientsConfig>(Carnot::ClientsConfig{
+        [this](const std::string& address, const std::string&)
+            -> std::unique_ptr<carnotpb::ResultSinkService::StubInterface> {
+          auto it = kelvin_channels_.find(address);
+          if (it != kelvin_channels_.end()) {
+            return carnotpb::ResultSinkService::NewStub(it->second);
+          }
+          return result_server_->StubGenerator(address);
+        },
+        [](grpc::ClientContext*) {},
+    });
+    auto server_config = std::make_unique<Carnot::ServerConfig>();
+    server_config->grpc_server_creds = grpc::InsecureServerCredentials();
+    server_config->grpc_server_port = 0;
+    if (!kelvin_address.empty()) {
+      grpc::ServerBuilder builder;
+      builder.RegisterService(&server_config->grpc_router);
+      auto server = builder.BuildAndStart();
+      kelvin_channels_[kelvin_address] = server->InProcessChannel(grpc::ChannelArguments());
+      kelvin_servers_[kelvin_address] = std::move(server);
+    }
+    return Carnot::Create(sole::uuid4(), std::move(func_registry), table_store,
+                          std::move(clients_config), std::move(server_config))
+        .ConsumeValueOrDie();
+  }
+
+  // Returns the count of each req_path in the query's output table.
+  std::map<std::string, int64_t> OutputCounts() {
+    std::map<std::string, int64_t> counts;
+    for (const auto& rb : result_server_->query_results("out")) {
+      for (int64_t i = 0; i < rb.num_rows(); ++i) {
+        auto path = types::GetValueFromArrowArray<types::STRING>(rb.ColumnAt(0).get(), i);
+        auto count = types::GetValueFromArrowArray<types::INT64>(rb.ColumnAt(1).get(), i).val;
+        EXPECT_EQ(counts.count(path), 0) << "req_path " << path << " was output twice";
+        counts[path] = count;
+      }
+    }
+    return counts;
+  }
+
+  std::unique_ptr<exec::LocalGRPCResultSinkServer> result_server_;
+  std::map<std::string, std::shared_ptr<table_store::Table>> pem_tables_;
+  std::map<std::string, std::unique_ptr<Carnot>> pems_;
+  std::map<std::string, std::unique_ptr<Carnot>> kelvins_;
+  std::map<std::string, std::unique_ptr<grpc::Server>> kelvin_servers_;
+  std::map<std::string, std::shared_ptr<grpc::Channel>> kelvin_channels_;
+};
+
+TEST_F(DistributedShuffleTest, partitioned_agg_matches_single_node) {
+  auto info = udfexporter::ExportUDFInfo().ConsumeValueOrDie()->info_pb();
+  ASSERT_OK_AND_ASSIGN(auto planner, planner::LogicalPlanner::Create(info));
+  plannerpb::QueryRequest query_request;
+  query_request.set_query_str(kQuery);
+  *query_request.mutable_logical_planner_state() =
+      planner::testutils::CreateTwoPEMsTwoKelvinsPlannerState(kSchema);
+  ASSERT_OK_AND_ASSIGN(auto plan, planner->Plan(query_request));
+  ASSERT_OK_AND_ASSIGN(auto plan_pb, plan->ToProto());
+  const auto& plans = plan_pb.qb_address_to_plan();
+
+  // The GRPC routers hold on to row batches that arrive before their query starts, so the
+  // fragments can run one after another, from the data stores up to the gather Kelvin.
+  auto query_id = sole::uuid4();
+  for (const auto& [pem, carnot] : pems_) {
+    ASSERT_OK(carnot->ExecutePlan(plans.at(pem), query_id));
+  }
+  ASSERT_OK(kelvins_[kPartitionKelvinAddress]->ExecutePlan(plans.at("kelvin2"), query_id));
+  ASSERT_OK(kelvins_[kGatherKelvinAddress]->ExecutePlan(plans.at("kelvin1"), query_id));
+
+  std::map<std::string, int64_t> expected{{"/a", 4}, {"/b", 3}, {"/c", 2}, {"/d", 1}, {"/e", 1}};
+  EXPECT_EQ(OutputCounts(), expected);
+}
+
+}  // namespace carnot
+}  // namespace px
@@ -34,6 +34,9 @@
 #include "src/common/testing/testing.h"
 #include "src/table_store/table_store.h"
 
+DECLARE_int64(carnot_join_memory_limit_bytes);
+DECLARE_string(carnot_join_spill_dir);
+
 namespace px {
 namespace carnot {
 
@@ -141,5 +144,44 @@ TEST_F(JoinTest, self_join) {
   EXPECT_TRUE(rb1.ColumnAt(1)->Equals(types::ToArrow(expected_col2, arrow::default_memory_pool())));
 }
 
+TEST_F(JoinTest, spill_to_disk) {
+  // With no memory for build rows, every partition of the build side is spilled, and the join is
+  // done one partition at a time once both inputs are complete.
+  px::testing::TempDir temp_dir;
+  PX_SET_FOR_SCOPE(FLAGS_carnot_join_spill_dir, temp_dir.path().string());
+  PX_SET_FOR_SCOPE(FLAGS_carnot_join_memory_limit_bytes, 0);
+
+  std::string queryString =
+      "import px\n"
+      "src1 = px.DataFrame(table='left_table', select=['col1', 'col2'])\n"
+      "src2 = px.DataFrame(table='right_table', select=['col1', 'col2'])\n"
+      "join = src1.merge(src2, how='inner', left_on=['col1', 'col2'], right_on=['col1', 'col2'], "
+      "suffixes=['', '_x'])\n"
+      "join['left_col1'] = join['col1']\n"
+      "join['right_col2'] = join['col2']\n"
+      "df = join[['left_col1', 'right_col2']]\n"
+      "px.display(df, 'joined')";
+
+  auto query = absl::StrJoin({queryString}, "\n");
+  auto query_id = sole::uuid4();
+  // No time column, doesn't use a time parameter.
+  auto s = carnot_->ExecuteQuery(query, query_id, 0);
+  ASSERT_OK(s);
+
+  EXPECT_THAT(result_server_->output_tables(), ::testing::UnorderedElementsAre("joined"));
+  // Spilled partitions are joined out of order, so compare the rows of all of the batches.
+  using Row = std::tuple<double, int64_t>;
+  std::vector<Row> rows;
+  for (const auto& rb : result_server_->query_results("joined")) {
+    for (int64_t i = 0; i < rb.num_rows(); ++i) {
+      rows.emplace_back(
+          types::GetValueFromArrowArray<types::FLOAT64>(rb.ColumnAt(0).get(), i).val,
+          types::GetValueFromArrowArray<types::INT64>(rb.ColumnAt(1).get(), i).val);
+    }
+  }
+  EXPECT_THAT(rows, ::testing::UnorderedElementsAre(Row{0.5, 1}, Row{1.2, 2}, Row{5.3, 3},
+                                                    Row{0.1, 5}, Row{5.1, 6}));
+}
+
 }  // namespace carnot
 }  // namespace px
@@ -0,0 +1,455 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/agg_hash_table.h"
+
+#include <farmhash.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <string_view>
+
+#include "src/common/base/hash_utils.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/column_wrapper.h"
+#include "src/shared/types/type_utils.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+namespace {
+
+constexpr uint64_t kMinCapacity = 64;
+// Number of rows ahead of the current row whose slot is prefetched while probing.
+constexpr int64_t kPrefetchDistance = 16;
+
+// Returns the number of 64-bit words needed to store a key column of the given type in a fixed
+// width key, or 0 if the type can't be stored in a fixed width key.
+size_t FixedWidthKeyWords(types::DataType data_type) {
+  switch (data_type) {
+    case types::INT64:
+    case types::TIME64NS:
+      return 1;
+    case types::UINT128:
+      return 2;
+    default:
+      return 0;
+  }
+}
+
+// Returns the index of the i-th selected row, where a null selection selects every row.
+inline int64_t SelectedRow(const int64_t* rows, int64_t i) { return rows == nullptr ? i : rows[i]; }
+
+// Typed helpers for hashing and comparing keys column by column. Fixed size values are hashed and
+// compared bitwise, which matches the behavior of RowTuple.
+template <types::DataType DT>
+void HashColumn(const arrow::Array* arr, const int64_t* rows, int64_t num_rows,
+                std::vector<uint64_t>* hashes) {
+  using ValueType = typename types::DataTypeTraits<DT>::value_type;
+  for (int64_t i = 0; i < num_rows; ++i) {
+    ValueType val = types::GetValueFromArrowArray<DT>(arr, SelectedRow(rows, i));
+    (*hashes)[i] = HashCombine(
+        (*hashes)[i], ::util::Hash64(reinterpret_cast<const char*>(&val.val), sizeof(val.val)));
+  }
+}
+
+template <>
+void HashColumn<types::STRING>(const arrow::Array* arr, const int64_t* rows, int64_t num_rows,
+                               std::vector<uint64_t>* hashes) {
+  for (int64_t i = 0; i < num_rows; ++i) {
+    auto val = types::GetStringViewFromArrowArray(arr, SelectedRow(rows, i));
+    (*hashes)[i] = HashCombine((*hashes)[i], ::util::Hash64(val.data(), val.size()));
+  }
+}
+
+template <types::DataType DT>
+bool KeyEquals(const arrow::Array* arr, int64_t row, const types::ColumnWrapper* keys,
+               int64_t group) {
+  using ValueType = typename types::DataTypeTraits<DT>::value_type;
+  using WrapperType = typename types::ColumnWrapperType<DT>::type;
+  ValueType val = types::GetValueFromArrowArray<DT>(arr, row);
+  const ValueType& key = static_cast<const WrapperType*>(keys)->UnsafeRawData()[group];
+  return std::memcmp(&val.val, &key.val, sizeof(val.val)) == 0;
+}
+
+template <>
+bool KeyEquals<types::STRING>(const arrow::Array* arr, int64_t row,
+                              const types::ColumnWrapper* keys, int64_t group) {
+  return types::GetStringViewFromArrowArray(arr, row) == keys->GetView(group);
+}
+
+template <types::DataType DT>
+void AppendKey(const arrow::Array* arr, int64_t row, types::ColumnWrapper* keys) {
+  types::ExtractValueToColumnWrapper<DT>(keys, const_cast<arrow::Array*>(arr), row);
+}
+
+// The typed functions for a key column, picked once per column so that the batch loops don't
+// switch on the data type.
+struct KeyFns {
+  void (*hash)(const arrow::Array*, const int64_t*, int64_t, std::vector<uint64_t>*);
+  bool (*equals)(const arrow::Array*, int64_t, const types::ColumnWrapper*, int64_t);
+  void (*append)(const arrow::Array*, int64_t, types::ColumnWrapper*);
+};
+
+KeyFns GetKeyFns(types::DataType data_type) {
+#define TYPE_CASE(_dt_) return KeyFns{&HashColumn<_dt_>, &KeyEquals<_dt_>, &AppendKey<_dt_>};
+  PX_SWITCH_FOREACH_DATATYPE(data_type, TYPE_CASE);
+#undef TYPE_CASE
+}
+
+}  // namespace
+
+void HashKeyColumns(const std::vector<const arrow::Array*>& keys,
+                    const std::vector<types::DataType>& key_types, std::vector<uint64_t>* hashes) {
+  DCHECK_EQ(keys.size(), key_types.size());
+  int64_t num_rows = keys.empty() ? 0 : keys[0]->length();
+  hashes->assign(num_rows, 0);
+  for (size_t col_idx = 0; col_idx < keys.size(); ++col_idx) {
+    GetKeyFns(key_types[col_idx]).hash(keys[col_idx], nullptr, num_rows, hashes);
+  }
+}
+
+void GroupHashTable::Clear() {
+  std::fill(slots_.begin(), slots_.end(), Slot{});
+  num_groups_ = 0;
+  ClearKeys();
+}
+
+void GroupHashTable::Reserve(int64_t num_rows) {
+  // Keep the load factor at or below 1/2, so that probe sequences stay short.
+  uint64_t needed = 2 * static_cast<uint64_t>(num_groups_ + num_rows);
+  if (needed <= slots_.size()) {
+    return;
+  }
+  uint64_t capacity = std::max<uint64_t>(slots_.size(), kMinCapacity);
+  while (capacity < needed) {
+    capacity *= 2;
+  }
+  std::vector<Slot> old_slots(capacity);
+  slots_.swap(old_slots);
+  mask_ = capacity - 1;
+  for (const auto& slot : old_slots) {
+    if (slot.group == kEmptySlot) {
+      continue;
+    }
+    uint64_t idx = slot.hash & mask_;
+    while (slots_[idx].group != kEmptySlot) {
+      idx = (idx + 1) & mask_;
+    }
+    slots_[idx] = slot;
+  }
+}
+
+template <bool kInsert, typename TKeyEquals, typename TInsertKey>
+void GroupHashTable::Probe(int64_t num_rows, const TKeyEquals& key_equals,
+                           const TInsertKey& insert_key, std::vector<int64_t>* group_ids) {
+  group_ids->resize(num_rows);
+  if (slots_.empty()) {
+    // Nothing has been inserted yet, so there's nothing to find.
+    DCHECK(!kInsert || num_rows == 0);
+    std::fill(group_ids->begin(), group_ids->end(), kNotFound);
+    return;
+  }
+  DCHECK(!kInsert || slots_.size() >= 2 * static_cast<uint64_t>(num_groups_ + num_rows));
+  for (int64_t i = 0; i < num_rows; ++i) {
+    // The hashes are all known up front, so start loading the slots of upcoming rows while this
+    // row is probed.
+    if (i + kPrefetchDistance < num_rows) {
+      __builtin_prefetch(&slots_[hashes_[i + kPrefetchDistance] & mask_]);
+    }
+    uint64_t hash = hashes_[i];
+    uint64_t idx = hash & mask_;
+    while (true) {
+      Slot& slot = slots_[idx];
+      if (slot.group == kEmptySlot) {
+        if constexpr (kInsert) {
+          slot.hash = hash;
+          slot.group = num_groups_++;
+          insert_key(i);
+          (*group_ids)[i] = slot.group;
+        } else {
+          (*group_ids)[i] = kNotFound;
+        }
+        break;
+      }
+      if (slot.hash == hash && key_equals(i, slot.group)) {
+        (*group_ids)[i] = slot.group;
+        break;
+      }
+      idx = (idx + 1) & mask_;
+    }
+  }
+}
+
+namespace {
+
+/**
+ * FixedWidthGroupHashTable stores each key as kWords packed 64-bit words.
+ */
+template <size_t kWords>
+class FixedWidthGroupHashTable : public GroupHashTable {
+ public:
+  using Key = std::array<uint64_t, kWords>;
+
+  explicit FixedWidthGroupHashTable(std::vector<types::DataType> key_types)
+      : GroupHashTable(std::move(key_types)) {
+    size_t offset = 0;
+    for (const auto& data_type : key_types_) {
+      word_offsets_.push_back(offset);
+      offset += FixedWidthKeyWords(data_type);
+    }
+    DCHECK_EQ(offset, kWords);
+  }
+
+  void FindOrInsert(const std::vector<const arrow::Array*>& keys,
+                    std::vector<int64_t>* group_ids) override {
+    int64_t num_rows = keys.empty() ? 0 : keys[0]->length();
+    Insert(keys, nullptr, num_rows, group_ids);
+  }
+
+  void FindOrInsert(const std::vector<const arrow::Array*>& keys, const std::vector<int64_t>& rows,
+                    std::vector<int64_t>* group_ids) override {
+    Insert(keys, rows.data(), static_cast<int64_t>(rows.size()), group_ids);
+  }
+
+  void Find(const std::vector<const arrow::Array*>& keys, const std::vector<int64_t>& rows,
+            std::vector<int64_t>* group_ids) override {
+    DCHECK_EQ(keys.size(), key_types_.size());
+    auto num_rows = static_cast<int64_t>(rows.size());
+    PackAndHash(keys, rows.data(), num_rows);
+    Probe</*kInsert*/ false>(
+        num_rows, [this](int64_t i, int64_t group) { return batch_keys_[i] == group_keys_[group]; },
+        [](int64_t) {}, group_ids);
+  }
+
+  std::vector<std::shared_ptr<arrow::Array>> KeysToArrow(
+      arrow::MemoryPool* mem_pool) const override {
+    std::vector<std::shared_ptr<arrow::Array>> arrays;
+    for (size_t col_idx = 0; col_idx < key_types_.size(); ++col_idx) {
+      auto data_type = key_types_[col_idx];
+      size_t offset = word_offsets_[col_idx];
+      auto col = types::ColumnWrapper::Make(data_type, group_keys_.size());
+      switch (data_type) {
+        case types::INT64:
+          UnpackColumn<types::INT64>(offset, col.get());
+          break;
+        case types::TIME64NS:
+          UnpackColumn<types::TIME64NS>(offset, col.get());
+          break;
+        case types::UINT128:
+          UnpackColumn<types::UINT128>(offset, col.get());
+          break;
+        default:
+          LOG(DFATAL) << "Unexpected fixed width key type: " << data_type;
+      }
+      arrays.push_back(col->ConvertToArrow(mem_pool));
+    }
+    return arrays;
+  }
+
+ protected:
+  void ClearKeys() override { group_keys_.clear(); }
+
+ private:
+  void Insert(const std::vector<const arrow::Array*>& keys, const int64_t* rows, int64_t num_rows,
+              std::vector<int64_t>* group_ids) {
+    DCHECK_EQ(keys.size(), key_types_.size());
+    Reserve(num_rows);
+    PackAndHash(keys, rows, num_rows);
+    Probe</*kInsert*/ true>(
+        num_rows, [this](int64_t i, int64_t group) { return batch_keys_[i] == group_keys_[group]; },
+        [this](int64_t i) { group_keys_.push_back(batch_keys_[i]); }, group_ids);
+  }
+
+  // Packs the keys of the selected rows into batch_keys_ one column at a time, then hashes them.
+  void PackAndHash(const std::vector<const arrow::Array*>& keys, const int64_t* rows,
+                   int64_t num_rows) {
+    batch_keys_.resize(num_rows);
+    for (size_t col_idx = 0; col_idx < keys.size(); ++col_idx) {
+      PackColumn(key_types_[col_idx], keys[col_idx], word_offsets_[col_idx], rows, num_rows);
+    }
+    hashes_.resize(num_rows);
+    for (int64_t i = 0; i < num_rows; ++i) {
+      hashes_[i] =
+          ::util::Hash64(reinterpret_cast<const char*>(batch_keys_[i].data()), sizeof(Key));
+    }
+  }
+
+  // Packs a key column into the words starting at offset of each key in batch_keys_.
+  void PackColumn(types::DataType data_type, const arrow::Array* arr, size_t offset,
+                  const int64_t* rows, int64_t num_rows) {
+    if (data_type == types::UINT128) {
+      for (int64_t i = 0; i < num_rows; ++i) {
+        types::UInt128Value val =
+            types::GetValueFromArrowArray<types::UINT128>(arr, SelectedRow(rows, i));
+        batch_keys_[i][offset] = val.High64();
+        batch_keys_[i][offset + 1] = val.Low64();
+      }
+      return;
+    }
+    // INT64 and TIME64NS arrays are both backed by int64 values.
+    const int64_t* values = arr->data()->GetValues<int64_t>(1);
+    for (int64_t i = 0; i < num_rows; ++i) {
+      batch_keys_[i][offset] = static_cast<uint64_t>(values[SelectedRow(rows, i)]);
+    }
+  }
+
+  // Unpacks the key column starting at offset of each group's key into col.
+  template <types::DataType DT>
+  void UnpackColumn(size_t offset, types::ColumnWrapper* col) const {
+    auto* typed_col = static_cast<typename types::ColumnWrapperType<DT>::type*>(col);
+    for (size_t group = 0; group < group_keys_.size(); ++group) {
+      const Key& key = group_keys_[group];
+      if constexpr (DT == types::UINT128) {
+        (*typed_col)[group] = types::UInt128Value(key[offset], key[offset + 1]);
+      } else {
+        (*typed_col)[group] = static_cast<int64_t>(key[offset]);
+      }
+    }
+  }
+
+  std::vector<size_t> word_offsets_;
+  // The keys of the current batch.
+  std::vector<Key> batch_keys_;
+  // The key of each group, indexed by group id.
+  std::vector<Key> group_keys_;
+};
+
+/**
+ * GenericGroupHashTable stores the keys in one ColumnWrapper per key column, and supports keys of
+ * any type.
+ */
+class GenericGroupHashTable : public GroupHashTable {
+ public:
+  explicit GenericGroupHashTable(std::vector<types::DataType> key_types)
+      : GroupHashTable(std::move(key_types)) {
+    for (const auto& data_type : key_types_) {
+      group_keys_.push_back(types::ColumnWrapper::Make(data_type, 0));
+      key_fns_.push_back(GetKeyFns(data_type));
+    }
+  }
+
+  void FindOrInsert(const std::vector<const arrow::Array*>& keys,
+                    std::vector<int64_t>* group_ids) override {
+    int64_t num_rows = keys.empty() ? 0 : keys[0]->length();
+    Insert(keys, nullptr, num_rows, group_ids);
+  }
+
+  void FindOrInsert(const std::vector<const arrow::Array*>& keys, const std::vector<int64_t>& rows,
+                    std::vector<int64_t>* group_ids) override {
+    Insert(keys, rows.data(), static_cast<int64_t>(rows.size()), group_ids);
+  }
+
+  void Find(const std::vector<const arrow::Array*>& keys, const std::vector<int64_t>& rows,
+            std::vector<int64_t>* group_ids) override {
+    DCHECK_EQ(keys.size(), key_types_.size());
+    auto num_rows = static_cast<int64_t>(rows.size());
+    Hash(keys, rows.data(), num_rows);
+    Probe</*kInsert*/ false>(
+        num_rows, [&](int64_t i, int64_t group) { return KeyEqualsGroup(keys, rows[i], group); },
+        [](int64_t) {}, group_ids);
+  }
+
+  std::vector<std::shared_ptr<arrow::Array>> KeysToArrow(
+      arrow::MemoryPool* mem_pool) const override {
+    std::vector<std::shared_ptr<arrow::Array>> arrays;
+    for (const auto& col : group_keys_) {
+      arrays.push_back(col->ConvertToArrow(mem_pool));
+    }
+    return arrays;
+  }
+
+ protected:
+  void ClearKeys() override {
+    for (auto& col : group_keys_) {
+      col->Clear();
+    }
+  }
+
+ private:
+  void Insert(const std::vector<const arrow::Array*>& keys, const int64_t* rows, int64_t num_rows,
+              std::vector<int64_t>* group_ids) {
+    DCHECK_EQ(keys.size(), key_types_.size());
+    Reserve(num_rows);
+    Hash(keys, rows, num_rows);
+    Probe</*kInsert*/ true>(
+        num_rows,
+        [&](int64_t i, int64_t group) { return KeyEqualsGroup(keys, SelectedRow(rows, i), group); },
+        [&](int64_t i) {
+          for (size_t col_idx = 0; col_idx < keys.size(); ++col_idx) {
+            key_fns_[col_idx].append(keys[col_idx], SelectedRow(rows, i),
+                                     group_keys_[col_idx].get());
+          }
+        },
+        group_ids);
+  }
+
+  void Hash(const std::vector<const arrow::Array*>& keys, const int64_t* rows, int64_t num_rows) {
+    hashes_.assign(num_rows, 0);
+    for (size_t col_idx = 0; col_idx < keys.size(); ++col_idx) {
+      key_fns_[col_idx].hash(keys[col_idx], rows, num_rows, &hashes_);
+    }
+  }
+
+  bool KeyEqualsGroup(const std::vector<const arrow::Array*>& keys, int64_t row,
+                      int64_t group) const {
+    for (size_t col_idx = 0; col_idx < keys.size(); ++col_idx) {
+      if (!key_fns_[col_idx].equals(keys[col_idx], row, group_keys_[col_idx].get(), group)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  std::vector<KeyFns> key_fns_;
+  // The key of each group, by key column.
+  std::vector<types::SharedColumnWrapper> group_keys_;
+};
+
+}  // namespace
+
+std::unique_ptr<GroupHashTable> GroupHashTable::Create(
+    const std::vector<types::DataType>& key_types) {
+  size_t num_words = 0;
+  for (const auto& data_type : key_types) {
+    size_t words = FixedWidthKeyWords(data_type);
+    if (words == 0) {
+      num_words = 0;
+      break;
+    }
+    num_words += words;
+  }
+  switch (num_words) {
+    case 1:
+      return std::make_unique<FixedWidthGroupHashTable<1>>(key_types);
+    case 2:
+      return std::make_unique<FixedWidthGroupHashTable<2>>(key_types);
+    case 3:
+      return std::make_unique<FixedWidthGroupHashTable<3>>(key_types);
+    case 4:
+      return std::make_unique<FixedWidthGroupHashTable<4>>(key_types);
+    default:
+      return std::make_unique<GenericGroupHashTable>(key_types);
+  }
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
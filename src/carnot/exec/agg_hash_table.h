@@ -0,0 +1,147 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/array.h>
+#include <arrow/memory_pool.h>
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/shared/types/types.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * Hashes the key of each row, one column at a time, into hashes (which is resized to the number of
+ * rows). Equal keys always have equal hashes, so this can be used to partition rows by key.
+ */
+void HashKeyColumns(const std::vector<const arrow::Array*>& keys,
+                    const std::vector<types::DataType>& key_types, std::vector<uint64_t>* hashes);
+
+/**
+ * GroupHashTable maps the group by keys of an aggregate (or the build keys of a join) to dense
+ * group ids, a batch at a time.
+ *
+ * FindOrInsert first hashes the keys of the whole batch, one column at a time, and then probes an
+ * open addressing (linear probing) table with the precomputed hashes. Groups are numbered in the
+ * order they were first inserted, so that per-group state can be kept in a plain vector indexed by
+ * group id, rather than in a hash map node per group.
+ *
+ * Keys made up only of INT64, TIME64NS and UINT128 columns (up to kMaxFixedWidthWords 64-bit
+ * words, e.g. a upid) are packed into fixed size arrays, which are cheap to hash and compare. All
+ * other keys are stored in one ColumnWrapper per key column and compared column by column.
+ */
+class GroupHashTable : public NotCopyable {
+ public:
+  static constexpr size_t kMaxFixedWidthWords = 4;
+  static constexpr int64_t kNotFound = -1;
+
+  /**
+   * Creates a hash table for keys of the given types, picking the fixed width implementation when
+   * the keys allow it.
+   */
+  static std::unique_ptr<GroupHashTable> Create(const std::vector<types::DataType>& key_types);
+
+  virtual ~GroupHashTable() = default;
+
+  /**
+   * Finds the group id of each row, inserting a new group for each key that hasn't been seen yet.
+   * @param keys the key columns, in the same order as the key types. They must all have the same
+   * length.
+   * @param group_ids output, resized to the number of rows.
+   */
+  virtual void FindOrInsert(const std::vector<const arrow::Array*>& keys,
+                            std::vector<int64_t>* group_ids) = 0;
+
+  /**
+   * Like FindOrInsert above, but only for the selected rows.
+   * @param rows the indices of the rows to find or insert.
+   * @param group_ids output, resized to the number of selected rows.
+   */
+  virtual void FindOrInsert(const std::vector<const arrow::Array*>& keys,
+                            const std::vector<int64_t>& rows, std::vector<int64_t>* group_ids) = 0;
+
+  /**
+   * Finds the group id of each of the selected rows, without inserting any groups.
+   * @param keys the key columns, in the same order as the key types.
+   * @param rows the indices of the rows to look up.
+   * @param group_ids output, resized to the number of selected rows. Rows whose key isn't in the
+   * table get kNotFound.
+   */
+  virtual void Find(const std::vector<const arrow::Array*>& keys, const std::vector<int64_t>& rows,
+                    std::vector<int64_t>* group_ids) = 0;
+
+  /**
+   * Returns one array per key column, holding the key of each group in group id order.
+   */
+  virtual std::vector<std::shared_ptr<arrow::Array>> KeysToArrow(
+      arrow::MemoryPool* mem_pool) const = 0;
+
+  /**
+   * Removes all of the groups. The memory of the table is kept for reuse.
+   */
+  void Clear();
+
+  int64_t NumGroups() const { return num_groups_; }
+  const std::vector<types::DataType>& key_types() const { return key_types_; }
+
+ protected:
+  explicit GroupHashTable(std::vector<types::DataType> key_types)
+      : key_types_(std::move(key_types)) {}
+
+  // Makes sure num_rows more groups can be inserted without going over the maximum load factor.
+  void Reserve(int64_t num_rows);
+
+  // Probes the table with the first num_rows hashes in hashes_, and writes the group id of each row
+  // to group_ids. key_equals(i, group) compares the i-th key against a group's key. When kInsert is
+  // set, insert_key(i) stores the i-th key as the key of the next group id, otherwise keys that
+  // aren't found get kNotFound.
+  template <bool kInsert, typename TKeyEquals, typename TInsertKey>
+  void Probe(int64_t num_rows, const TKeyEquals& key_equals, const TInsertKey& insert_key,
+             std::vector<int64_t>* group_ids);
+
+  virtual void ClearKeys() = 0;
+
+  const std::vector<types::DataType> key_types_;
+  // Scratch space for the hashes of the current batch.
+  std::vector<uint64_t> hashes_;
+
+ private:
+  static constexpr int64_t kEmptySlot = kNotFound;
+
+  struct Slot {
+    uint64_t hash = 0;
+    int64_t group = kEmptySlot;
+  };
+
+  // Slots are stored in a power of 2 sized vector, so that the hash can be masked into a slot.
+  std::vector<Slot> slots_;
+  uint64_t mask_ = 0;
+  int64_t num_groups_ = 0;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,175 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/agg_hash_table.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/types.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using ::testing::ElementsAre;
+
+template <typename TValue>
+std::shared_ptr<arrow::Array> MakeArray(const std::vector<TValue>& values) {
+  return types::ToArrow(values, arrow::default_memory_pool());
+}
+
+TEST(GroupHashTableTest, int64_keys) {
+  auto table = GroupHashTable::Create({types::INT64});
+  std::vector<int64_t> group_ids;
+
+  auto batch1 = MakeArray<types::Int64Value>({5, 3, 5, 7, 3});
+  table->FindOrInsert({batch1.get()}, &group_ids);
+  EXPECT_THAT(group_ids, ElementsAre(0, 1, 0, 2, 1));
+
+  auto batch2 = MakeArray<types::Int64Value>({7, 9, 5});
+  table->FindOrInsert({batch2.get()}, &group_ids);
+  EXPECT_THAT(group_ids, ElementsAre(2, 3, 0));
+  EXPECT_EQ(4, table->NumGroups());
+
+  auto keys = table->KeysToArrow(arrow::default_memory_pool());
+  ASSERT_EQ(1U, keys.size());
+  EXPECT_TRUE(keys[0]->Equals(MakeArray<types::Int64Value>({5, 3, 7, 9})));
+}
+
+TEST(GroupHashTableTest, uint128_and_time_keys) {
+  auto table = GroupHashTable::Create({types::UINT128, types::TIME64NS});
+  std::vector<int64_t> group_ids;
+
+  auto upids = MakeArray<types::UInt128Value>(
+      {types::UInt128Value(1, 2), types::UInt128Value(1, 3), types::UInt128Value(1, 2),
+       types::UInt128Value(1, 2)});
+  auto times = MakeArray<types::Time64NSValue>({10, 10, 10, 20});
+  table->FindOrInsert({upids.get(), times.get()}, &group_ids);
+  EXPECT_THAT(group_ids, ElementsAre(0, 1, 0, 2));
+
+  auto keys = table->KeysToArrow(arrow::default_memory_pool());
+  ASSERT_EQ(2U, keys.size());
+  EXPECT_TRUE(keys[0]->Equals(MakeArray<types::UInt128Value>(
+      {types::UInt128Value(1, 2), types::UInt128Value(1, 3), types::UInt128Value(1, 2)})));
+  EXPECT_TRUE(keys[1]->Equals(MakeArray<types::Time64NSValue>({10, 10, 20})));
+}
+
+TEST(GroupHashTableTest, string_and_int64_keys) {
+  auto table = GroupHashTable::Create({types::STRING, types::INT64});
+  std::vector<int64_t> group_ids;
+
+  auto strs = MakeArray<types::StringValue>({"abc", "def", "abc", "abc", "def"});
+  auto ints = MakeArray<types::Int64Value>({1, 1, 1, 2, 1});
+  table->FindOrInsert({strs.get(), ints.get()}, &group_ids);
+  EXPECT_THAT(group_ids, ElementsAre(0, 1, 0, 2, 1));
+
+  auto keys = table->KeysToArrow(arrow::default_memory_pool());
+  ASSERT_EQ(2U, keys.size());
+  EXPECT_TRUE(keys[0]->Equals(MakeArray<types::StringValue>({"abc", "def", "abc"})));
+  EXPECT_TRUE(keys[1]->Equals(MakeArray<types::Int64Value>({1, 1, 2})));
+}
+
+TEST(GroupHashTableTest, grows_past_initial_capacity) {
+  auto table = GroupHashTable::Create({types::INT64});
+  std::vector<int64_t> group_ids;
+
+  const int64_t kNumGroups = 10000;
+  std::vector<types::Int64Value> values;
+  for (int64_t i = 0; i < kNumGroups; ++i) {
+    values.emplace_back(i * 7919);
+  }
+  auto batch = MakeArray(values);
+  table->FindOrInsert({batch.get()}, &group_ids);
+  ASSERT_EQ(kNumGroups, table->NumGroups());
+
+  // Looking the keys up again must find the same groups.
+  table->FindOrInsert({batch.get()}, &group_ids);
+  ASSERT_EQ(kNumGroups, table->NumGroups());
+  for (int64_t i = 0; i < kNumGroups; ++i) {
+    EXPECT_EQ(i, group_ids[i]);
+  }
+}
+
+TEST(GroupHashTableTest, clear) {
+  auto table = GroupHashTable::Create({types::STRING});
+  std::vector<int64_t> group_ids;
+
+  auto batch1 = MakeArray<types::StringValue>({"a", "b"});
+  table->FindOrInsert({batch1.get()}, &group_ids);
+  table->Clear();
+  EXPECT_EQ(0, table->NumGroups());
+
+  auto batch2 = MakeArray<types::StringValue>({"b", "c", "b"});
+  table->FindOrInsert({batch2.get()}, &group_ids);
+  EXPECT_THAT(group_ids, ElementsAre(0, 1, 0));
+  auto keys = table->KeysToArrow(arrow::default_memory_pool());
+  EXPECT_TRUE(keys[0]->Equals(MakeArray<types::StringValue>({"b", "c"})));
+}
+
+TEST(GroupHashTableTest, find_selected_rows) {
+  for (const auto& key_type : {types::INT64, types::STRING}) {
+    auto table = GroupHashTable::Create({key_type});
+    std::vector<int64_t> group_ids;
+
+    std::shared_ptr<arrow::Array> build;
+    std::shared_ptr<arrow::Array> probe;
+    if (key_type == types::INT64) {
+      build = MakeArray<types::Int64Value>({10, 20, 30});
+      probe = MakeArray<types::Int64Value>({30, 40, 10, 20});
+    } else {
+      build = MakeArray<types::StringValue>({"a", "b", "c"});
+      probe = MakeArray<types::StringValue>({"c", "d", "a", "b"});
+    }
+    table->FindOrInsert({build.get()}, &group_ids);
+
+    table->Find({probe.get()}, {0, 1, 2}, &group_ids);
+    EXPECT_THAT(group_ids, ElementsAre(2, GroupHashTable::kNotFound, 0));
+    table->Find({probe.get()}, {3}, &group_ids);
+    EXPECT_THAT(group_ids, ElementsAre(1));
+    // Find doesn't insert anything.
+    EXPECT_EQ(3, table->NumGroups());
+  }
+}
+
+TEST(GroupHashTableTest, find_in_empty_table) {
+  auto table = GroupHashTable::Create({types::INT64});
+  std::vector<int64_t> group_ids;
+  auto probe = MakeArray<types::Int64Value>({1, 2});
+  table->Find({probe.get()}, {0, 1}, &group_ids);
+  EXPECT_THAT(group_ids, ElementsAre(GroupHashTable::kNotFound, GroupHashTable::kNotFound));
+}
+
+TEST(GroupHashTableTest, hash_key_columns) {
+  auto strs = MakeArray<types::StringValue>({"abc", "def", "abc"});
+  auto ints = MakeArray<types::Int64Value>({1, 1, 1});
+  std::vector<uint64_t> hashes;
+  HashKeyColumns({strs.get(), ints.get()}, {types::STRING, types::INT64}, &hashes);
+  ASSERT_EQ(3U, hashes.size());
+  EXPECT_EQ(hashes[0], hashes[2]);
+  EXPECT_NE(hashes[0], hashes[1]);
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -29,7 +29,6 @@
 #include "src/carnot/exec/expression_evaluator.h"
 #include "src/carnot/plan/scalar_expression.h"
 #include "src/carnot/planpb/plan.pb.h"
-#include "src/carnot/udf/udf_wrapper.h"
 #include "src/common/base/base.h"
 #include "src/shared/types/arrow_adapter.h"
 #include "src/shared/types/type_utils.h"
@@ -40,46 +39,10 @@ namespace carnot {
 namespace exec {
 
 using SharedArray = std::shared_ptr<arrow::Array>;
-constexpr int64_t kAggCompactionThreshold = 512;
 
 using table_store::schema::RowBatch;
 using table_store::schema::RowDescriptor;
 
-namespace {
-template <types::DataType DT>
-void ExtractIntoGroupArgs(std::vector<GroupArgs>* group_args, arrow::Array* col, int rt_col_idx) {
-  auto num_rows = col->length();
-  for (auto row_idx = 0; row_idx < num_rows; ++row_idx) {
-    ExtractIntoRowTuple<DT>((*group_args)[row_idx].rt, col, rt_col_idx, row_idx);
-  }
-}
-
-template <types::DataType DT>
-void AppendToBuilder(arrow::ArrayBuilder* builder, RowTuple* rt, size_t rt_idx) {
-  using ArrowBuilder = typename types::DataTypeTraits<DT>::arrow_builder_type;
-  using ValueType = typename types::DataTypeTraits<DT>::value_type;
-  auto status =
-      static_cast<ArrowBuilder*>(builder)->Append(udf::UnWrap(rt->GetValue<ValueType>(rt_idx)));
-  PX_DCHECK_OK(status);
-  PX_UNUSED(status);
-}
-
-template <types::DataType DT>
-void ExtractToColumnWrapper(const std::vector<GroupArgs>& group_args,
-                            const table_store::schema::RowBatch& rb, size_t col_idx,
-                            size_t rb_col_idx) {
-  size_t num_rows = rb.num_rows();
-  DCHECK(num_rows <= group_args.size());
-  for (size_t row_idx = 0; row_idx < num_rows; ++row_idx) {
-    DCHECK(group_args[row_idx].av != nullptr);
-    auto col_wrapper = group_args[row_idx].av->agg_cols[col_idx].get();
-    auto arr = rb.ColumnAt(rb_col_idx).get();
-    types::ExtractValueToColumnWrapper<DT>(col_wrapper, arr, row_idx);
-  }
-}
-
-}  // namespace
-
 std::string AggNode::DebugStringImpl() {
   return absl::Substitute("Exec::AggNode<$0>", plan_node_->DebugString());
 }
@@ -134,7 +97,8 @@ Status AggNode::InitImpl(const plan::Operator& plan_node) {
     value_data_types_.emplace_back(output_descriptor_->type(values_idx));
   }
 
-  return CreateColumnMapping();
+  group_table_ = GroupHashTable::Create(group_data_types_);
+  return Status::OK();
 }
 
 Status AggNode::PrepareImpl(ExecState* exec_state) {
@@ -161,13 +125,21 @@ Status AggNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_
 
 Status AggNode::CloseImpl(ExecState*) {
   udas_no_groups_.clear();
-  group_args_chunk_.clear();
-  group_args_pool_.Clear();
+  groups_.clear();
+  if (group_table_ != nullptr) {
+    group_table_->Clear();
+  }
   udas_pool_.Clear();
 
   return Status::OK();
 }
 
+bool AggNode::AcceptsSelection(const RowBatch&) const {
+  // Partial aggregates with groups only read the selected rows, when they update the UDAs of each
+  // group.
+  return plan_node_->partial_agg() && !HasNoGroups();
+}
+
 bool AggNode::ReadyToEmitBatches(const RowBatch& rb) const {
   return rb.eos() || (rb.eow() && plan_node_->windowed());
 }
@@ -177,7 +149,11 @@ Status AggNode::ClearAggState(ExecState* exec_state) {
     udas_no_groups_.clear();
     PX_RETURN_IF_ERROR(CreateUDAInfoValues(&udas_no_groups_, exec_state));
   }
-  agg_hash_map_.clear();
+  if (group_table_ != nullptr) {
+    group_table_->Clear();
+  }
+  groups_.clear();
+  batch_group_counters_.clear();
   return Status::OK();
 }
 
@@ -219,135 +195,113 @@ Status AggNode::AggregateGroupByNone(ExecState* exec_state, const RowBatch& rb)
   return Status::OK();
 }
 
-Status AggNode::ExtractRowTupleForBatch(const RowBatch& rb) {
-  // Grow the group_args_chunk_ to be the size of the RowBatch.
-  size_t num_rows = rb.num_rows();
-  if (group_args_chunk_.size() < num_rows) {
-    int prev_size = group_args_chunk_.size();
-    group_args_chunk_.reserve(num_rows);
-    for (size_t idx = prev_size; idx < num_rows; ++idx) {
-      group_args_chunk_.emplace_back(CreateGroupArgsRowTuple());
-    }
-  }
-
-  // Scan through all the group args in column order and extract the entire column.
-  for (size_t idx = 0; idx < plan_node_->groups().size(); idx++) {
-    auto grp = plan_node_->groups()[idx];
+Status AggNode::HashRowBatch(ExecState* exec_state, const RowBatch& rb) {
+  std::vector<const arrow::Array*> group_cols;
+  group_cols.reserve(plan_node_->groups().size());
+  for (const auto& grp : plan_node_->groups()) {
     DCHECK(grp.idx < input_descriptor_->size());
-    DCHECK(idx < group_data_types_.size());
-    auto dt = group_data_types_[idx];
-    auto col = rb.ColumnAt(grp.idx).get();
+    group_cols.push_back(rb.ColumnAt(grp.idx).get());
+  }
+  if (rb.HasSelection()) {
+    group_table_->FindOrInsert(group_cols, rb.selection(), &group_ids_);
+  } else {
+    group_table_->FindOrInsert(group_cols, &group_ids_);
+  }
 
-#define TYPE_CASE(_dt_) ExtractIntoGroupArgs<_dt_>(&group_args_chunk_, col, idx);
-    PX_SWITCH_FOREACH_DATATYPE(dt, TYPE_CASE);
-#undef TYPE_CASE
+  // Create the aggregate state of the groups that were first seen in this batch.
+  for (auto group = static_cast<int64_t>(groups_.size()); group < group_table_->NumGroups();
+       ++group) {
+    groups_.push_back(CreateAggHashValue(exec_state));
   }
   return Status::OK();
 }
 
-Status AggNode::HashRowBatch(ExecState* exec_state, const RowBatch& rb) {
-  PX_UNUSED(exec_state);
-  // Loop through all the row and basically store the values into column chunk based on which
-  // group they belong to.
-  for (auto row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
-    auto& ga = group_args_chunk_[row_idx];
-    AggHashValue* val = nullptr;
-    // Check to see if in hash
-    // TODO(zasgar): Change this to upsert.
-    auto it = agg_hash_map_.find(ga.rt);
-    // If not in hash then insert
-    if (it == agg_hash_map_.end()) {
-      // Create a val array.
-      val = CreateAggHashValue(exec_state);
-      agg_hash_map_[ga.rt] = val;
-      // We have inserted this, so the stored RowTuple is now in the table.
-      ga.rt = nullptr;
-    } else {
-      val = it->second;
+void AggNode::BuildSelectionVector(const RowBatch& rb) {
+  // Counting sort of the rows by group id, keeping the order of the rows within each group.
+  batch_group_counters_.resize(groups_.size(), 0);
+  batch_groups_.clear();
+  for (int64_t group : group_ids_) {
+    if (batch_group_counters_[group]++ == 0) {
+      batch_groups_.push_back(group);
     }
-    ga.av = val;
   }
-
-  // Now extract the values in the agg hash value.
-  for (size_t i = 0; i < stored_cols_data_types_.size(); ++i) {
-    const auto& rb_col_idx = stored_cols_to_plan_idx_[i];
-    const auto& dt = input_descriptor_->type(rb_col_idx);
-
-    // Even if we're not doing a partial agg we want to extract the group values.
-    if (plan_node_->partial_agg() || i < plan_node_->groups().size()) {
-#define TYPE_CASE(_dt_) ExtractToColumnWrapper<_dt_>(group_args_chunk_, rb, i, rb_col_idx);
-
-      PX_SWITCH_FOREACH_DATATYPE(dt, TYPE_CASE);
-#undef TYPE_CASE
-    }
+  batch_group_starts_.resize(batch_groups_.size() + 1);
+  batch_group_starts_[0] = 0;
+  for (size_t i = 0; i < batch_groups_.size(); ++i) {
+    int64_t group = batch_groups_[i];
+    batch_group_starts_[i + 1] = batch_group_starts_[i] + batch_group_counters_[group];
+    // From here on the counter holds the next position to write a row of the group to.
+    batch_group_counters_[group] = batch_group_starts_[i];
   }
-  if (!plan_node_->partial_agg()) {
-    // If we're not performing a partial_agg, then we're receiving serialized partial aggs, so we
-    // deserialize and merge them here.
-    PX_RETURN_IF_ERROR(DeserializeAndMergeGrouped(group_args_chunk_, rb));
+  selection_.resize(group_ids_.size());
+  for (size_t idx = 0; idx < group_ids_.size(); ++idx) {
+    int64_t row_idx = rb.HasSelection() ? rb.selection()[idx] : idx;
+    selection_[batch_group_counters_[group_ids_[idx]]++] = row_idx;
   }
-
-  return Status::OK();
-}
-
-Status AggNode::EvaluatePartialAggregates(ExecState* exec_state, size_t num_records) {
-  PX_UNUSED(exec_state);
-  // TODO(zasgar): This only needs to run for unique groups. We should find
-  // a way to optimize this.
-  for (size_t i = 0; i < num_records; ++i) {
-    DCHECK(i < group_args_chunk_.size());
-    auto& ga = group_args_chunk_[i];
-    DCHECK(ga.av != nullptr);
-    if (ga.av->agg_cols[0]->Size() > kAggCompactionThreshold) {
-      PX_RETURN_IF_ERROR(EvaluateAggHashValue(exec_state, ga.av));
-    }
+  for (int64_t group : batch_groups_) {
+    batch_group_counters_[group] = 0;
   }
-  return Status::OK();
 }
 
-Status AggNode::ResetGroupArgs() {
-  // Reset the group args. If the row tuple is null it has been consumed, so
-  // we can replace it with a new RowTuple. We also reset the
-  // agg hash value to nullptr.
-  for (size_t i = 0; i < group_args_chunk_.size(); ++i) {
-    group_args_chunk_[i].av = nullptr;
-    if (group_args_chunk_[i].rt == nullptr) {
-      group_args_chunk_[i].rt = CreateGroupArgsRowTuple();
-    } else {
-      group_args_chunk_[i].rt->Reset();
+Status AggNode::UpdateGroups(ExecState* exec_state, const RowBatch& rb) {
+  const auto& values = plan_node_->values();
+  for (size_t i = 0; i < values.size(); ++i) {
+    // The arguments are evaluated once for the whole batch, and each group reads its own rows.
+    std::vector<SharedArray> args;
+    plan::ExpressionWalker<StatusOr<SharedArray>> walker;
+    walker.OnScalarValue(
+        [&](const plan::ScalarValue& val,
+            const std::vector<StatusOr<SharedArray>>& children) -> std::shared_ptr<arrow::Array> {
+          DCHECK_EQ(children.size(), 0ULL);
+          return EvalScalarToArrow(exec_state, val, rb.num_rows());
+        });
+
+    walker.OnColumn(
+        [&](const plan::Column& col,
+            const std::vector<StatusOr<SharedArray>>& children) -> std::shared_ptr<arrow::Array> {
+          DCHECK_EQ(children.size(), 0ULL);
+          return rb.ColumnAt(col.Index());
+        });
+
+    walker.OnAggregateExpression(
+        [&](const plan::AggregateExpression&,
+            const std::vector<StatusOr<SharedArray>>& children) -> StatusOr<SharedArray> {
+          for (const auto& child : children) {
+            PX_RETURN_IF_ERROR(child);
+            args.push_back(child.ValueOrDie());
+          }
+          return SharedArray{};
+        });
+    PX_RETURN_IF_ERROR(walker.Walk(*values[i]));
+
+    std::vector<const arrow::Array*> raw_args;
+    raw_args.reserve(args.size());
+    for (const auto& arg : args) {
+      raw_args.push_back(arg.get());
+    }
+    for (size_t g = 0; g < batch_groups_.size(); ++g) {
+      const auto& uda_info = groups_[batch_groups_[g]]->udas[i];
+      DCHECK(values[i]->name() == uda_info.def->name());
+      DCHECK(raw_args.size() == uda_info.def->update_arguments().size());
+      const int64_t begin = batch_group_starts_[g];
+      PX_RETURN_IF_ERROR(uda_info.def->ExecBatchUpdateArrow(
+          uda_info.uda.get(), nullptr /* ctx */, raw_args, selection_.data() + begin,
+          batch_group_starts_[g + 1] - begin));
     }
   }
   return Status::OK();
 }
 
-Status AggNode::ConvertAggHashMapToRowBatch(ExecState* exec_state, RowBatch* output_rb) {
-  PX_UNUSED(exec_state);
+Status AggNode::ConvertGroupsToRowBatch(ExecState* exec_state, RowBatch* output_rb) {
   DCHECK(output_rb != nullptr);
-  std::vector<std::unique_ptr<arrow::ArrayBuilder>> group_builders;
-  for (const auto& group_dt : group_data_types_) {
-    group_builders.push_back(types::MakeArrowBuilder(group_dt, exec_state->exec_mem_pool()));
-  }
   std::vector<std::unique_ptr<arrow::ArrayBuilder>> value_builders;
   for (const auto& value_data_type : value_data_types_) {
     value_builders.push_back(types::MakeArrowBuilder(value_data_type, exec_state->exec_mem_pool()));
   }
 
-  // Agg into agg values and emit!
-  for (const auto& kv : agg_hash_map_) {
-    auto* groups_rt = kv.first;
-    auto* val = kv.second;
-
-    for (size_t i = 0; i < group_data_types_.size(); ++i) {
-      DCHECK(i < group_builders.size());
-
-#define TYPE_CASE(_dt_) AppendToBuilder<_dt_>(group_builders[i].get(), groups_rt, i);
-      PX_SWITCH_FOREACH_DATATYPE(group_data_types_[i], TYPE_CASE);
-#undef TYPE_CASE
-    }
-    if (plan_node_->partial_agg()) {
-      PX_RETURN_IF_ERROR(EvaluateAggHashValue(exec_state, val));
-    }
-
+  // Agg into agg values and emit! The groups are emitted in group id order, which matches the
+  // order of the keys returned by the group table.
+  for (auto* val : groups_) {
     if (plan_node_->finalize_results()) {
       // Actually Finalize the UDA based on the column wrapper chunks.
       for (size_t i = 0; i < val->udas.size(); ++i) {
@@ -364,9 +318,7 @@ Status AggNode::ConvertAggHashMapToRowBatch(ExecState* exec_state, RowBatch* out
     }
   }
 
-  for (const auto& group_builder : group_builders) {
-    std::shared_ptr<arrow::Array> arr;
-    PX_RETURN_IF_ERROR(group_builder->Finish(&arr));
+  for (const auto& arr : group_table_->KeysToArrow(exec_state->exec_mem_pool())) {
     PX_RETURN_IF_ERROR(output_rb->AddColumn(arr));
   }
 
@@ -380,23 +332,23 @@ Status AggNode::ConvertAggHashMapToRowBatch(ExecState* exec_state, RowBatch* out
 }
 
 Status AggNode::AggregateGroupByClause(ExecState* exec_state, const RowBatch& rb) {
-  // Extracts the row tuples (column wise).
-  // TODO(zasgar): PL-455 - Chunk this so we don't create a crazy number of row tuples if the batch
-  // is large. The process is as follows:
-  // 1. Extract each column into the appropriate part of the row tuple.
-  // 2. Hash row batch and update agg values.
-  // 3. If the agg values are large then run aggregate and compact.
-  // 4. Reset state to prepare for next row batch.
-  // 5. If it's the last batch then emit the values.
-  PX_RETURN_IF_ERROR(ExtractRowTupleForBatch(rb));
+  // The process is as follows:
+  // 1. Find the group id of each row in the group table (inserting new groups).
+  // 2. For partial aggs, update the UDAs of each group with the group's rows of the batch.
+  //    Otherwise, deserialize and merge the partial aggregates of each row into its group.
+  // 3. If it's the last batch then emit the values.
   PX_RETURN_IF_ERROR(HashRowBatch(exec_state, rb));
-  if (plan_node_->partial_agg() && plan_node_->values().size() > 0) {
-    PX_RETURN_IF_ERROR(EvaluatePartialAggregates(exec_state, rb.num_rows()));
+  if (plan_node_->partial_agg()) {
+    BuildSelectionVector(rb);
+    PX_RETURN_IF_ERROR(UpdateGroups(exec_state, rb));
+  } else {
+    // If we're not performing a partial_agg, then we're receiving serialized partial aggs, so we
+    // deserialize and merge them here.
+    PX_RETURN_IF_ERROR(DeserializeAndMergeGrouped(rb));
   }
-  PX_RETURN_IF_ERROR(ResetGroupArgs());
   if (ReadyToEmitBatches(rb)) {
-    RowBatch output_rb(*output_descriptor_, agg_hash_map_.size());
-    PX_RETURN_IF_ERROR(ConvertAggHashMapToRowBatch(exec_state, &output_rb));
+    RowBatch output_rb(*output_descriptor_, group_table_->NumGroups());
+    PX_RETURN_IF_ERROR(ConvertGroupsToRowBatch(exec_state, &output_rb));
     output_rb.set_eow(rb.eow());
     output_rb.set_eos(rb.eos());
     PX_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, output_rb));
@@ -462,99 +414,9 @@ Status AggNode::EvaluateSingleExpressionNoGroups(ExecState* exec_state, const UD
   return Status::OK();
 }
 
-Status AggNode::EvaluateAggHashValue(ExecState* exec_state, AggHashValue* val) {
-  size_t values_size = plan_node_->values().size();
-  for (size_t i = 0; i < values_size; ++i) {
-    const auto& uda_info = val->udas[i];
-    const auto& expr = *plan_node_->values()[i];
-    size_t num_records = val->agg_cols[0]->Size();
-    plan::ExpressionWalker<StatusOr<types::SharedColumnWrapper>> walker;
-    walker.OnScalarValue([&](const plan::ScalarValue& scalar_val,
-                             const std::vector<StatusOr<types::SharedColumnWrapper>>& children)
-                             -> types::SharedColumnWrapper {
-      DCHECK_EQ(children.size(), 0ULL);
-      return EvalScalarToColumnWrapper(exec_state, scalar_val, num_records);
-    });
-
-    walker.OnColumn([&](const plan::Column& col,
-                        const std::vector<StatusOr<types::SharedColumnWrapper>>& children)
-                        -> types::SharedColumnWrapper {
-      DCHECK_EQ(children.size(), 0ULL);
-      return val->agg_cols[plan_cols_to_stored_map_[col.Index()]];
-    });
-
-    walker.OnAggregateExpression(
-        [&](const plan::AggregateExpression& agg,
-            const std::vector<StatusOr<types::SharedColumnWrapper>>& children)
-            -> StatusOr<types::SharedColumnWrapper> {
-          DCHECK(agg.name() == uda_info.def->name());
-          DCHECK(children.size() == uda_info.def->update_arguments().size());
-          // collect the arguments.
-          std::vector<const types::ColumnWrapper*> raw_children;
-          raw_children.reserve(children.size());
-          for (auto& child : children) {
-            PX_RETURN_IF_ERROR(child);
-            raw_children.push_back(child.ValueOrDie().get());
-          }
-          PX_RETURN_IF_ERROR(
-              uda_info.def->ExecBatchUpdate(uda_info.uda.get(), nullptr /* ctx */, raw_children));
-          // Blocking aggregates don't produce results until all data is seen.
-          return {};
-        });
-    PX_RETURN_IF_ERROR(walker.Walk(expr));
-  }
-
-  for (auto& col : val->agg_cols) {
-    // Clear the values, so we don't aggregate them twice.
-    col->Clear();
-  }
-  return Status::OK();
-}
-
-Status AggNode::CreateColumnMapping() {
-  if (!plan_node_->partial_agg()) {
-    // If we're deserializing partial aggregates, then we have 1 column for each group and 1 column
-    // for each value.
-    auto groups_size = static_cast<int64_t>(plan_node_->groups().size());
-    auto values_size = static_cast<int64_t>(plan_node_->values().size());
-    for (int64_t i = 0; i < groups_size + values_size; i++) {
-      plan_cols_to_stored_map_[i] = i;
-      stored_cols_to_plan_idx_.emplace_back(i);
-      stored_cols_data_types_.emplace_back(input_descriptor_->type(i));
-    }
-    return Status::OK();
-  }
-  for (const auto& expr : plan_node_->values()) {
-    plan::ExpressionWalker<int> walker;
-
-    walker.OnScalarValue(
-        [&](const plan::ScalarValue&, const std::vector<int>&) -> int { return 0; });
-
-    walker.OnColumn([&](const plan::Column& col, const std::vector<int>&) -> int {
-      auto plan_col_idx = col.Index();
-      if (plan_cols_to_stored_map_.find(plan_col_idx) == plan_cols_to_stored_map_.end()) {
-        // We aren't currently capturing this col, so add it to the list of cols to store.
-        plan_cols_to_stored_map_[plan_col_idx] = stored_cols_to_plan_idx_.size();
-        stored_cols_to_plan_idx_.emplace_back(plan_col_idx);
-        stored_cols_data_types_.emplace_back(input_descriptor_->type(plan_col_idx));
-      }
-      return 0;
-    });
-
-    walker.OnAggregateExpression(
-        [&](const plan::AggregateExpression&, const std::vector<int>&) -> int { return 0; });
-
-    PX_RETURN_IF_ERROR(walker.Walk(*expr));
-  }
-  return Status::OK();
-}
-
 AggHashValue* AggNode::CreateAggHashValue(ExecState* exec_state) {
   auto* val = udas_pool_.Add(new AggHashValue);
   PX_CHECK_OK(CreateUDAInfoValues(&(val->udas), exec_state));
-  for (const auto& dt : stored_cols_data_types_) {
-    val->agg_cols.emplace_back(types::ColumnWrapper::Make(dt, 0));
-  }
   return val;
 }
 
@@ -589,13 +451,11 @@ Status AggNode::DeserializeAndMergeNoGroups(const RowBatch& rb) {
   return Status::OK();
 }
 
-Status AggNode::DeserializeAndMergeGrouped(const std::vector<GroupArgs>& group_args,
-                                           const RowBatch& rb) {
+Status AggNode::DeserializeAndMergeGrouped(const RowBatch& rb) {
   auto groups_size = static_cast<int64_t>(plan_node_->groups().size());
   for (int64_t row_idx = 0; row_idx < rb.num_rows(); row_idx++) {
-    DCHECK(group_args[row_idx].av != nullptr);
-    PX_RETURN_IF_ERROR(
-        DeserializeAndMergeRow(&group_args[row_idx].av->udas, rb, row_idx, groups_size));
+    auto* val = groups_[group_ids_[row_idx]];
+    PX_RETURN_IF_ERROR(DeserializeAndMergeRow(&val->udas, rb, row_idx, groups_size));
   }
 
   return Status::OK();
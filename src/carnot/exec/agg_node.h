@@ -18,16 +18,15 @@
 
 #pragma once
 #include <cstddef>
-#include <map>
 #include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "src/carnot/exec/agg_hash_table.h"
 #include "src/carnot/exec/exec_node.h"
 #include "src/carnot/exec/exec_state.h"
 #include "src/carnot/exec/expression_evaluator.h"
-#include "src/carnot/exec/row_tuple.h"
 #include "src/carnot/plan/operators.h"
 #include "src/carnot/plan/scalar_expression.h"
 #include "src/carnot/udf/base.h"
@@ -35,7 +34,6 @@
 #include "src/carnot/udf/udf_definition.h"
 #include "src/common/base/base.h"
 #include "src/common/memory/memory.h"
-#include "src/shared/types/column_wrapper.h"
 #include "src/shared/types/hash_utils.h"
 #include "src/shared/types/types.h"
 #include "src/table_store/schema/row_batch.h"
@@ -57,18 +55,9 @@ struct UDAInfo {
 
 struct AggHashValue {
   std::vector<UDAInfo> udas;
-  std::vector<types::SharedColumnWrapper> agg_cols;
-};
-
-struct GroupArgs {
-  explicit GroupArgs(RowTuple* rt) : rt(rt), av(nullptr) {}
-  RowTuple* rt;
-  AggHashValue* av;
 };
 
 class AggNode : public ProcessingNode {
-  using AggHashMap = AbslRowTupleHashMap<AggHashValue*>;
-
  public:
   AggNode() = default;
   virtual ~AggNode() = default;
@@ -84,9 +73,9 @@ class AggNode : public ProcessingNode {
   Status CloseImpl(ExecState* exec_state) override;
   Status ConsumeNextImpl(ExecState* exec_state, const table_store::schema::RowBatch& rb,
                          size_t parent_index) override;
+  bool AcceptsSelection(const table_store::schema::RowBatch& rb) const override;
 
  private:
-  AggHashMap agg_hash_map_;
   bool HasNoGroups() const { return plan_node_->groups().empty(); }
   // ReadyToEmitBatches returns true when the input stream has reached a point where output batches
   // can be emitted. In the windowed aggregate case, this happens whenever end of window (eow) is
@@ -98,12 +87,11 @@ class AggNode : public ProcessingNode {
   Status EvaluateSingleExpressionNoGroups(ExecState* exec_state, const UDAInfo& uda_info,
                                           plan::AggregateExpression* expr,
                                           const table_store::schema::RowBatch& rb);
-  Status EvaluateAggHashValue(ExecState* exec_state, AggHashValue* val);
   StatusOr<types::DataType> GetTypeOfDep(const plan::ScalarExpression& expr) const;
 
   Status DeserializeAndMergeNoGroups(const RowBatch& rb);
 
-  Status DeserializeAndMergeGrouped(const std::vector<GroupArgs>& group_args, const RowBatch& rb);
+  Status DeserializeAndMergeGrouped(const RowBatch& rb);
 
   Status DeserializeAndMergeRow(std::vector<UDAInfo>* udas, const RowBatch& rb, int64_t row_idx,
                                 int64_t groups_size);
@@ -122,43 +110,42 @@ class AggNode : public ProcessingNode {
 
   // Variables specific to GroupBy Agg.
 
-  // As the row batches come in we insert the correct values into the hash map based
-  // on the group by key. To do this we need to keep track of which input columns we need
-  // to eventually run the agg funcs.
-  // 1. We need to keep a mapping from plan columns to stored columns.
-  std::map<int64_t, int64_t> plan_cols_to_stored_map_;
-  // 2. The reverse mapping from stored_cols to plan cols. This can be a regular vector,
-  // since the stored column indices are contiguous.
-  std::vector<int64_t> stored_cols_to_plan_idx_;
-  // 3. The data type of the stored colums, by the index they are stored at.
-  std::vector<types::DataType> stored_cols_data_types_;
-
-  ObjectPool group_args_pool_{"group_args_pool"};
   ObjectPool udas_pool_{"udas_pool"};
 
   std::vector<types::DataType> group_data_types_;
   std::vector<types::DataType> value_data_types_;
 
-  // We construct row-tuples in a batch, chunked by each column.
-  // This vector holds pointers to the row_tuples which are managed by the group_args_pool_.
-
-  std::vector<GroupArgs> group_args_chunk_;
+  // Maps the group by keys to dense group ids.
+  std::unique_ptr<GroupHashTable> group_table_;
+  // The aggregate state of each group, indexed by group id. The values are managed by udas_pool_.
+  std::vector<AggHashValue*> groups_;
+
+  // Scratch space for the current row batch:
+  // The group id of each (selected) row.
+  std::vector<int64_t> group_ids_;
+  // The groups that appear in the batch, in order of first appearance.
+  std::vector<int64_t> batch_groups_;
+  // The range of selection_ that holds the rows of each group in batch_groups_ is
+  // [batch_group_starts_[i], batch_group_starts_[i + 1]).
+  std::vector<int64_t> batch_group_starts_;
+  // Per group counters used to build the selection vector, indexed by group id. They are all zero
+  // between batches.
+  std::vector<int64_t> batch_group_counters_;
+  // The row indices of the batch, ordered by group (in batch_groups_ order), so that the UDAs of
+  // each group can be updated with all of its rows at once.
+  std::vector<int64_t> selection_;
   // END: Variables specific to GroupBy Agg.
 
-  // Creates a mapping between plan cols and stored cols (see above comment).
-  Status CreateColumnMapping();
-
-  Status ExtractRowTupleForBatch(const table_store::schema::RowBatch& rb);
+  // Looks up the group of each row, creating new groups as needed.
   Status HashRowBatch(ExecState* exec_state, const table_store::schema::RowBatch& rb);
-  Status EvaluatePartialAggregates(ExecState* exec_state, size_t num_records);
-  Status ResetGroupArgs();
-  Status ConvertAggHashMapToRowBatch(ExecState* exec_state,
-                                     table_store::schema::RowBatch* output_rb);
+  // Orders the (selected) rows of the batch by group into selection_.
+  void BuildSelectionVector(const table_store::schema::RowBatch& rb);
+  // Updates the UDAs of each group in the batch with the group's rows, one batched update per
+  // group and value.
+  Status UpdateGroups(ExecState* exec_state, const table_store::schema::RowBatch& rb);
+  Status ConvertGroupsToRowBatch(ExecState* exec_state, table_store::schema::RowBatch* output_rb);
 
   AggHashValue* CreateAggHashValue(ExecState* exec_state);
-  RowTuple* CreateGroupArgsRowTuple() {
-    return group_args_pool_.Add(new RowTuple(&group_data_types_));
-  }
 
   Status CreateUDAInfoValues(std::vector<UDAInfo>* val, ExecState* exec_state);
 };
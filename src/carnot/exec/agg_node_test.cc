@@ -19,6 +19,8 @@
 #include "src/carnot/exec/agg_node.h"
 
 #include <algorithm>
+#include <memory>
+#include <vector>
 
 #include <google/protobuf/text_format.h>
 #include <gtest/gtest.h>
@@ -585,6 +587,37 @@ TEST_F(AggNodeTest, single_group_blocking) {
       .Close();
 }
 
+TEST_F(AggNodeTest, single_group_blocking_with_selection) {
+  auto plan_node = PlanNodeFromPbtxt(kBlockingSingleGroupAgg);
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64});
+
+  RowDescriptor output_rd({types::DataType::INT64, types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<AggNode, plan::AggregateOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+
+  // Only the selected rows are aggregated, so group 7 never shows up.
+  auto rb1 = RowBatchBuilder(input_rd, 4, /*eow*/ false, /*eos*/ false)
+                 .AddColumn<types::Int64Value>({1, 7, 2, 2})
+                 .AddColumn<types::Int64Value>({2, 3, 3, 1})
+                 .get();
+  rb1.set_selection(std::make_shared<const std::vector<int64_t>>(std::vector<int64_t>{0, 2, 3}));
+  auto rb2 = RowBatchBuilder(input_rd, 4, true, true)
+                 .AddColumn<types::Int64Value>({5, 1, 3, 7})
+                 .AddColumn<types::Int64Value>({1, 5, 3, 8})
+                 .get();
+  rb2.set_selection(std::make_shared<const std::vector<int64_t>>(std::vector<int64_t>{1, 2}));
+
+  tester.ConsumeNext(rb1, 0, 0)
+      .ConsumeNext(rb2, 0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 3, true, true)
+                          .AddColumn<types::Int64Value>({1, 2, 3})
+                          .AddColumn<types::Int64Value>({2, 3, 3})
+                          .get(),
+                      false)
+      .Close();
+}
+
 TEST_F(AggNodeTest, multiple_groups_blocking) {
   auto plan_node = PlanNodeFromPbtxt(kBlockingMultipleGroupAgg);
   RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64, types::DataType::INT64});
@@ -35,6 +35,14 @@
 #include "src/shared/types/arrow_adapter.h"
 #include "src/shared/types/type_utils.h"
 
+DEFINE_int64(carnot_join_memory_limit_bytes,
+             gflags::Int64FromEnv("PL_CARNOT_JOIN_MEMORY_LIMIT_BYTES", 256 * 1024 * 1024),
+             "The number of bytes of build rows a join keeps in memory before it spills partitions "
+             "to disk. Only used when --carnot_join_spill_dir is set.");
+DEFINE_string(carnot_join_spill_dir, gflags::StringFromEnv("PL_CARNOT_JOIN_SPILL_DIR", ""),
+              "The directory joins spill partitions to when they go over their memory limit. "
+              "Spilling is disabled when this is empty.");
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -131,111 +139,39 @@ Status EquijoinNode::PrepareImpl(ExecState* /*exec_state*/) {
   return Status::OK();
 }
 
-Status EquijoinNode::OpenImpl(ExecState* /*exec_state*/) { return Status::OK(); }
-
-Status EquijoinNode::CloseImpl(ExecState* /*exec_state*/) {
-  join_keys_chunk_.clear();
-  build_buffer_.clear();
-  probed_keys_.clear();
-  key_values_pool_.Clear();
+Status EquijoinNode::OpenImpl(ExecState* /*exec_state*/) {
+  size_t probe_parent = probe_table_ == EquijoinNode::JoinInputTable::kLeftTable ? 0 : 1;
+  const auto& probe_desc = input_descriptors_[probe_parent];
+  std::vector<types::DataType> probe_types;
+  for (size_t i = 0; i < probe_desc.size(); ++i) {
+    probe_types.push_back(probe_desc.type(i));
+  }
+  JoinHashTable::Options opts;
+  opts.memory_limit_bytes = FLAGS_carnot_join_memory_limit_bytes;
+  // Deferring the probe rows of spilled partitions would reorder the output, so time ordered joins
+  // never spill.
+  if (!plan_node_->order_by_time()) {
+    opts.spill_dir = FLAGS_carnot_join_spill_dir;
+  }
+  join_table_ = std::make_unique<JoinHashTable>(key_data_types_, build_spec_.input_col_types,
+                                                std::move(probe_types), std::move(opts));
   return Status::OK();
 }
 
-template <types::DataType DT>
-void ExtractIntoRowTuples(std::vector<RowTuple*>* row_tuples, arrow::Array* input_col,
-                          int rt_col_idx) {
-  auto num_rows = input_col->length();
-  for (auto row_idx = 0; row_idx < num_rows; ++row_idx) {
-    ExtractIntoRowTuple<DT>((*row_tuples)[row_idx], input_col, rt_col_idx, row_idx);
-  }
-}
-
-Status EquijoinNode::ExtractJoinKeysForBatch(const table_store::schema::RowBatch& rb,
-                                             bool is_probe) {
-  // Reset the row tuples
-  for (auto& rt : join_keys_chunk_) {
-    if (rt == nullptr) {
-      rt = key_values_pool_.Add(new RowTuple(&key_data_types_));
-    } else {
-      rt->Reset();
-    }
-  }
-
-  // Grow the join_keys_chunk_ to be the size of the RowBatch.
-  size_t num_rows = rb.num_rows();
-  if (join_keys_chunk_.size() < num_rows) {
-    int prev_size = join_keys_chunk_.size();
-    join_keys_chunk_.reserve(num_rows);
-    for (size_t idx = prev_size; idx < num_rows; ++idx) {
-      auto tuple_ptr = key_values_pool_.Add(new RowTuple(&key_data_types_));
-      join_keys_chunk_.emplace_back(tuple_ptr);
-    }
-  }
-
-  const TableSpec& spec = is_probe ? probe_spec_ : build_spec_;
-
-  // Scan through all the group args in column order and extract the entire column.
-  for (size_t tuple_col_idx = 0; tuple_col_idx < spec.key_indices.size(); ++tuple_col_idx) {
-    auto input_col_idx = spec.key_indices[tuple_col_idx];
-    auto dt = key_data_types_[tuple_col_idx];
-    auto col = rb.ColumnAt(input_col_idx).get();
-
-#define TYPE_CASE(_dt_) ExtractIntoRowTuples<_dt_>(&join_keys_chunk_, col, tuple_col_idx);
-    PX_SWITCH_FOREACH_DATATYPE(dt, TYPE_CASE);
-#undef TYPE_CASE
-  }
-
+Status EquijoinNode::CloseImpl(ExecState* /*exec_state*/) {
+  chunks_.clear();
+  join_table_.reset();
   return Status::OK();
 }
 
-std::vector<types::SharedColumnWrapper>* CreateWrapper(ObjectPool* pool,
-                                                       const std::vector<types::DataType>& types) {
-  auto ptr = pool->Add(new std::vector<types::SharedColumnWrapper>(types.size()));
-  for (size_t col_idx = 0; col_idx < types.size(); ++col_idx) {
-    (*ptr)[col_idx] = types::ColumnWrapper::Make(types[col_idx], 0);
+std::vector<const arrow::Array*> EquijoinNode::KeyColumns(const RowBatch& rb,
+                                                          const TableSpec& spec) const {
+  std::vector<const arrow::Array*> keys;
+  keys.reserve(spec.key_indices.size());
+  for (auto col_idx : spec.key_indices) {
+    keys.push_back(rb.ColumnAt(col_idx).get());
   }
-  return ptr;
-}
-
-Status EquijoinNode::HashRowBatch(const table_store::schema::RowBatch& rb) {
-  if (rb.num_rows() > static_cast<int64_t>(build_wrappers_chunk_.size())) {
-    build_wrappers_chunk_.resize(rb.num_rows());
-  }
-  for (auto row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
-    if (build_wrappers_chunk_[row_idx] == nullptr) {
-      build_wrappers_chunk_[row_idx] =
-          CreateWrapper(&column_values_pool_, build_spec_.input_col_types);
-    }
-  }
-
-  // Make sure the map has constructed the necessary column wrappers for all of the tuples.
-  for (auto row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
-    auto& rt = join_keys_chunk_[row_idx];
-    auto& current = build_buffer_[rt];
-    auto wrappers_ptr = current != nullptr ? current : build_wrappers_chunk_[row_idx];
-
-    // Now extract the values into the corresponding column wrappers.
-    for (size_t i = 0; i < build_spec_.input_col_indices.size(); ++i) {
-      const auto& rb_col_idx = build_spec_.input_col_indices[i];
-      auto arr = rb.ColumnAt(rb_col_idx).get();
-      const auto& dt = build_spec_.input_col_types[i];
-
-#define TYPE_CASE(_dt_) \
-  types::ExtractValueToColumnWrapper<_dt_>(wrappers_ptr->at(i).get(), arr, row_idx);
-      PX_SWITCH_FOREACH_DATATYPE(dt, TYPE_CASE);
-#undef TYPE_CASE
-    }
-    // Keep track of the number of rows that the build buffer matches for each key.
-    build_buffer_rows_[rt]++;
-
-    if (current == nullptr) {
-      std::swap(build_wrappers_chunk_[row_idx], current);
-      // Reset the new tuples that we added
-      join_keys_chunk_[row_idx] = nullptr;
-    }
-  }
-
-  return Status::OK();
+  return keys;
 }
 
 template <types::DataType DT>
@@ -327,13 +263,15 @@ Status EquijoinNode::FlushChunkedRows(ExecState* exec_state) {
 Status EquijoinNode::MatchBuildValuesAndFlush(ExecState* exec_state,
                                               std::vector<types::SharedColumnWrapper>* wrapper,
                                               std::shared_ptr<RowBatch> probe_rb,
-                                              int64_t probe_rb_row, int64_t matching_bb_rows) {
+                                              int64_t probe_rb_row, int64_t bb_start_row,
+                                              int64_t matching_bb_rows) {
   int64_t bb_rows_left = matching_bb_rows;
 
   while (bb_rows_left > 0) {
     auto available = output_rows_per_batch_ - (column_builders_[0]->length() + queued_rows_);
     auto chunk_rows = std::min(bb_rows_left, available);
-    OutputChunk c{probe_rb, wrapper, chunk_rows, matching_bb_rows - bb_rows_left, probe_rb_row};
+    OutputChunk c{probe_rb, wrapper, chunk_rows,
+                  bb_start_row + matching_bb_rows - bb_rows_left, probe_rb_row};
     chunks_.emplace_back(c);
     queued_rows_ += chunk_rows;
     bb_rows_left -= chunk_rows;
@@ -351,30 +289,22 @@ Status EquijoinNode::DoProbe(ExecState* exec_state, const table_store::schema::R
     probe_eos_ = true;
   }
 
-  PX_RETURN_IF_ERROR(ExtractJoinKeysForBatch(rb, true));
+  PX_RETURN_IF_ERROR(join_table_->ProbeBatch(KeyColumns(rb, probe_spec_), rb, &probe_results_));
 
-  if (rb.num_rows() > static_cast<int64_t>(probe_wrappers_chunk_.size())) {
-    probe_wrappers_chunk_.resize(rb.num_rows());
-  }
+  auto rb_ptr = std::make_shared<RowBatch>(rb);
 
   for (auto row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
-    auto it = build_buffer_.find(join_keys_chunk_[row_idx]);
-    if (it != build_buffer_.end()) {
-      probe_wrappers_chunk_[row_idx] = it->second;
-      probed_keys_.insert(it->first);
-    } else {
-      probe_wrappers_chunk_[row_idx] = nullptr;
+    const auto& result = probe_results_[row_idx];
+    // Deferred rows are joined once their partition is loaded back from disk.
+    if (result.partition == JoinHashTable::kDeferred) {
+      continue;
     }
-  }
-
-  auto rb_ptr = std::make_shared<RowBatch>(rb);
 
-  for (auto row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
     if (queued_rows_ >= output_rows_per_batch_ - column_builders_[0]->length()) {
       PX_RETURN_IF_ERROR(FlushChunkedRows(exec_state));
     }
 
-    if (probe_wrappers_chunk_[row_idx] == nullptr) {
+    if (result.partition == JoinHashTable::kNoMatch) {
       if (probe_spec_.emit_unmatched_rows) {
         OutputChunk c{rb_ptr, nullptr, 1, 0, row_idx};
         chunks_.emplace_back(c);
@@ -383,9 +313,9 @@ Status EquijoinNode::DoProbe(ExecState* exec_state, const table_store::schema::R
       continue;
     }
 
-    PX_RETURN_IF_ERROR(MatchBuildValuesAndFlush(exec_state, probe_wrappers_chunk_[row_idx], rb_ptr,
-                                                row_idx,
-                                                build_buffer_rows_[join_keys_chunk_[row_idx]]));
+    auto build_rows = join_table_->GetBuildRows(result.partition, result.key);
+    PX_RETURN_IF_ERROR(MatchBuildValuesAndFlush(exec_state, build_rows.values, rb_ptr, row_idx,
+                                                build_rows.start, build_rows.num_rows));
   }
 
   if (probe_eos_ && queued_rows_ > 0) {
@@ -395,17 +325,39 @@ Status EquijoinNode::DoProbe(ExecState* exec_state, const table_store::schema::R
   return Status::OK();
 }
 
-Status EquijoinNode::EmitUnmatchedBuildRows(ExecState* exec_state) {
-  for (auto it = build_buffer_.begin(); it != build_buffer_.end(); ++it) {
-    if (probed_keys_.find(it->first) != probed_keys_.end()) {
-      continue;
-    }
-    PX_RETURN_IF_ERROR(MatchBuildValuesAndFlush(exec_state, it->second, nullptr, 0,
-                                                build_buffer_rows_[it->first]));
+Status EquijoinNode::EmitUnmatchedBuildRows(ExecState* exec_state, int partition) {
+  for (int64_t key : join_table_->UnmatchedKeys(partition)) {
+    auto build_rows = join_table_->GetBuildRows(partition, key);
+    PX_RETURN_IF_ERROR(MatchBuildValuesAndFlush(exec_state, build_rows.values, nullptr, 0,
+                                                build_rows.start, build_rows.num_rows));
   }
+  return Status::OK();
+}
 
-  if (queued_rows_ > 0) {
-    PX_RETURN_IF_ERROR(FlushChunkedRows(exec_state));
+Status EquijoinNode::JoinSpilledPartitions(ExecState* exec_state) {
+  // Loading a partition that doesn't fit in memory splits it into new spilled partitions, which
+  // are appended to the partitions, and joined later in this loop instead.
+  for (int partition = 0; partition < join_table_->NumPartitions(); ++partition) {
+    if (!join_table_->IsSpilled(partition)) {
+      continue;
+    }
+    PX_RETURN_IF_ERROR(join_table_->LoadPartition(partition));
+    if (!join_table_->IsInMemory(partition)) {
+      continue;
+    }
+    for (size_t i = 0; i < join_table_->NumDeferredProbeBatches(partition); ++i) {
+      PX_ASSIGN_OR_RETURN(auto rb, join_table_->ReadDeferredProbeBatch(partition, i));
+      PX_RETURN_IF_ERROR(DoProbe(exec_state, rb));
+    }
+    if (build_spec_.emit_unmatched_rows) {
+      PX_RETURN_IF_ERROR(EmitUnmatchedBuildRows(exec_state, partition));
+    }
+    // Queued chunks point into the partition's build rows, so they have to be written out before
+    // the partition is released.
+    if (queued_rows_ > 0) {
+      PX_RETURN_IF_ERROR(FlushChunkedRows(exec_state));
+    }
+    join_table_->ReleasePartition(partition);
   }
   return Status::OK();
 }
@@ -416,10 +368,15 @@ Status EquijoinNode::ConsumeBuildBatch(ExecState* exec_state,
     build_eos_ = true;
   }
 
-  PX_RETURN_IF_ERROR(ExtractJoinKeysForBatch(rb, false));
-  PX_RETURN_IF_ERROR(HashRowBatch(rb));
+  std::vector<const arrow::Array*> values;
+  values.reserve(build_spec_.input_col_indices.size());
+  for (auto col_idx : build_spec_.input_col_indices) {
+    values.push_back(rb.ColumnAt(col_idx).get());
+  }
+  PX_RETURN_IF_ERROR(join_table_->AppendBuildBatch(KeyColumns(rb, build_spec_), values));
 
   if (build_eos_) {
+    PX_RETURN_IF_ERROR(join_table_->FinishBuild());
     while (probe_batches_.size()) {
       PX_RETURN_IF_ERROR(DoProbe(exec_state, probe_batches_.front()));
       probe_batches_.pop();
@@ -448,8 +405,17 @@ Status EquijoinNode::ConsumeNextImpl(ExecState* exec_state, const table_store::s
   }
 
   if (build_eos_ && probe_eos_) {
+    PX_RETURN_IF_ERROR(join_table_->FinishProbe());
     if (build_spec_.emit_unmatched_rows) {
-      PX_RETURN_IF_ERROR(EmitUnmatchedBuildRows(exec_state));
+      for (int partition = 0; partition < join_table_->NumPartitions(); ++partition) {
+        if (join_table_->IsInMemory(partition)) {
+          PX_RETURN_IF_ERROR(EmitUnmatchedBuildRows(exec_state, partition));
+        }
+      }
+    }
+    PX_RETURN_IF_ERROR(JoinSpilledPartitions(exec_state));
+    if (queued_rows_ > 0) {
+      PX_RETURN_IF_ERROR(FlushChunkedRows(exec_state));
     }
 
     if (column_builders_[0]->length()) {
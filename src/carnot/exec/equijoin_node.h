@@ -26,15 +26,12 @@
 #include <utility>
 #include <vector>
 
-#include <absl/container/flat_hash_map.h>
-
 #include "src/carnot/exec/exec_node.h"
 #include "src/carnot/exec/exec_state.h"
-#include "src/carnot/exec/row_tuple.h"
+#include "src/carnot/exec/join_hash_table.h"
 #include "src/carnot/plan/operators.h"
 #include "src/common/base/base.h"
 #include "src/common/base/status.h"
-#include "src/common/memory/memory.h"
 #include "src/shared/types/column_wrapper.h"
 #include "src/shared/types/types.h"
 #include "src/table_store/table_store.h"
@@ -77,15 +74,19 @@ class EquijoinNode : public ProcessingNode {
   Status InitializeColumnBuilders();
   bool IsProbeTable(size_t parent_index);
   Status FlushChunkedRows(ExecState* exec_state);
-  Status ExtractJoinKeysForBatch(const table_store::schema::RowBatch& rb, bool is_probe);
-  Status HashRowBatch(const table_store::schema::RowBatch& rb);
+  std::vector<const arrow::Array*> KeyColumns(const table_store::schema::RowBatch& rb,
+                                              const TableSpec& spec) const;
 
   Status DoProbe(ExecState* exec_state, const table_store::schema::RowBatch& rb);
   Status MatchBuildValuesAndFlush(ExecState* exec_state,
                                   std::vector<types::SharedColumnWrapper>* wrapper,
                                   std::shared_ptr<table_store::schema::RowBatch> probe_rb,
-                                  int64_t probe_rb_row_idx, int64_t matching_bb_rows);
-  Status EmitUnmatchedBuildRows(ExecState* exec_state);
+                                  int64_t probe_rb_row_idx, int64_t bb_start_row,
+                                  int64_t matching_bb_rows);
+  // Emits the build rows of an in-memory partition that didn't match any probe rows.
+  Status EmitUnmatchedBuildRows(ExecState* exec_state, int partition);
+  // Joins the deferred probe rows of each spilled partition, once both inputs are complete.
+  Status JoinSpilledPartitions(ExecState* exec_state);
   Status NextOutputBatch(ExecState* exec_state);
   Status ConsumeBuildBatch(ExecState* exec_state, const table_store::schema::RowBatch& rb);
   Status ConsumeProbeBatch(ExecState* exec_state, const table_store::schema::RowBatch& rb);
@@ -129,27 +130,11 @@ class EquijoinNode : public ProcessingNode {
   std::queue<table_store::schema::RowBatch> probe_batches_;
   // Column builders will flush a batch once they hit output_rows_per_batch_ rows.
   std::vector<std::unique_ptr<arrow::ArrayBuilder>> column_builders_;
-  // Manages the RowTuples containing the keys for the join.
-  ObjectPool key_values_pool_{"equijoin_kv_pool"};
-  ObjectPool column_values_pool_{"equijoin_col_vals_pool"};
-
-  // Chunk of data to use when extracting join keys.
-  std::vector<RowTuple*> join_keys_chunk_;
-  // Chunk of data to use when performing the build stage of the join.
-  std::vector<std::vector<types::SharedColumnWrapper>*> build_wrappers_chunk_;
-
-  // Chunk of data to use when performing the probe stage of the join.
-  // This will store build table data from `build_buffer_`.
-  std::vector<std::vector<types::SharedColumnWrapper>*> probe_wrappers_chunk_;
-  AbslRowTupleHashMap<std::vector<types::SharedColumnWrapper>*> build_buffer_;
-  // Store the number of rows that match a given set of keys for the build buffer.
-  // This is necessary to store in addition to the values in `build_buffer_` in
-  // the event that no columns from the build side are emitted.
-  AbslRowTupleHashMap<int64_t> build_buffer_rows_;
-
-  // For joins where the build_buffer_ needs to emit any non-probed rows at the end of the join,
-  // keep track of which ones they were.
-  AbslRowTupleHashSet probed_keys_;
+
+  // Holds the build rows, partitioned and grouped by key.
+  std::unique_ptr<JoinHashTable> join_table_;
+  // The result of looking up each row of the current probe batch.
+  std::vector<JoinHashTable::ProbeResult> probe_results_;
 
   // Handle on the most recent RowBatch (in case it's the final one).
   std::unique_ptr<table_store::schema::RowBatch> pending_output_batch_;
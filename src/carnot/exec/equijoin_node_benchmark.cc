@@ -0,0 +1,172 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+#include <google/protobuf/text_format.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <absl/strings/substitute.h>
+#include <sole.hpp>
+
+#include "src/carnot/exec/equijoin_node.h"
+#include "src/carnot/exec/test_utils.h"
+#include "src/carnot/planpb/plan.pb.h"
+#include "src/carnot/planpb/test_proto.h"
+#include "src/carnot/udf/registry.h"
+#include "src/common/base/base.h"
+#include "src/shared/types/types.h"
+
+DECLARE_int64(carnot_join_memory_limit_bytes);
+DECLARE_string(carnot_join_spill_dir);
+
+using px::carnot::exec::EquijoinNode;
+using px::carnot::exec::ExecState;
+using px::carnot::exec::MockMetricsStubGenerator;
+using px::carnot::exec::MockResultSinkStubGenerator;
+using px::carnot::exec::MockTraceStubGenerator;
+using px::carnot::exec::RowBatchBuilder;
+using px::table_store::schema::RowBatch;
+using px::table_store::schema::RowDescriptor;
+using px::types::DataType;
+
+namespace {
+
+// Inner join of [key:Int, build_val:Float] with [key:Int, probe_val:Int] on key.
+constexpr char kJoinOperator[] = R"(
+  type: INNER
+  equality_conditions {
+    left_column_index: 0
+    right_column_index: 0
+  }
+  output_columns: {
+    parent_index: 0
+    column_index: 1
+  }
+  output_columns: {
+    parent_index: 1
+    column_index: 1
+  }
+  column_names: "build_val"
+  column_names: "probe_val"
+  rows_per_batch: 1024
+)";
+
+constexpr int64_t kRowsPerBatch = 1024;
+
+std::vector<RowBatch> MakeBatches(const RowDescriptor& rd, int64_t num_rows, int64_t num_keys,
+                                  bool float_values, std::mt19937_64* rng) {
+  std::uniform_int_distribution<int64_t> key_dist(0, num_keys - 1);
+  std::vector<RowBatch> batches;
+  for (int64_t start = 0; start < num_rows; start += kRowsPerBatch) {
+    int64_t batch_rows = std::min(kRowsPerBatch, num_rows - start);
+    std::vector<px::types::Int64Value> keys;
+    std::vector<px::types::Int64Value> int_values;
+    std::vector<px::types::Float64Value> float_vals;
+    for (int64_t i = 0; i < batch_rows; ++i) {
+      keys.push_back(key_dist(*rng));
+      int_values.push_back(start + i);
+      float_vals.push_back(static_cast<double>(start + i));
+    }
+    bool eos = start + batch_rows >= num_rows;
+    auto builder = RowBatchBuilder(rd, batch_rows, /*eow*/ eos, /*eos*/ eos);
+    builder.AddColumn<px::types::Int64Value>(keys);
+    if (float_values) {
+      builder.AddColumn<px::types::Float64Value>(float_vals);
+    } else {
+      builder.AddColumn<px::types::Int64Value>(int_values);
+    }
+    batches.push_back(builder.get());
+  }
+  return batches;
+}
+
+// NOLINTNEXTLINE : runtime/references.
+void BM_EquijoinNode(benchmark::State& state, bool spill) {
+  int64_t num_build_rows = state.range(0);
+  int64_t num_probe_rows = state.range(1);
+  // Only probe keys below num_build_rows can match, so half of the probe rows have no match.
+  int64_t num_keys = num_build_rows;
+
+  auto func_registry = std::make_unique<px::carnot::udf::Registry>("test_registry");
+  auto table_store = std::make_shared<px::table_store::TableStore>();
+  auto exec_state = std::make_unique<ExecState>(
+      func_registry.get(), table_store, MockResultSinkStubGenerator, MockMetricsStubGenerator,
+      MockTraceStubGenerator, sole::uuid4(), nullptr);
+
+  px::carnot::planpb::Operator op_pb;
+  CHECK(google::protobuf::TextFormat::MergeFromString(
+      absl::Substitute(px::carnot::planpb::testutils::kOperatorProtoTmpl, "JOIN_OPERATOR",
+                       "join_op", kJoinOperator),
+      &op_pb));
+  auto plan_node = px::carnot::plan::JoinOperator::FromProto(op_pb, 1);
+
+  RowDescriptor build_rd({DataType::INT64, DataType::FLOAT64});
+  RowDescriptor probe_rd({DataType::INT64, DataType::INT64});
+  RowDescriptor output_rd({DataType::FLOAT64, DataType::INT64});
+
+  std::mt19937_64 rng(42);
+  auto build_batches = MakeBatches(build_rd, num_build_rows, num_keys, true, &rng);
+  auto probe_batches = MakeBatches(probe_rd, num_probe_rows, 2 * num_keys, false, &rng);
+
+  auto spill_dir = std::filesystem::temp_directory_path() / "equijoin_node_benchmark";
+  int64_t memory_limit = FLAGS_carnot_join_memory_limit_bytes;
+  if (spill) {
+    FLAGS_carnot_join_spill_dir = spill_dir.string();
+    // Small enough that most of the build side is spilled.
+    FLAGS_carnot_join_memory_limit_bytes = num_build_rows * 4;
+  }
+
+  for (auto _ : state) {
+    EquijoinNode node;
+    PX_CHECK_OK(node.Init(*plan_node, output_rd, {build_rd, probe_rd}));
+    PX_CHECK_OK(node.Prepare(exec_state.get()));
+    PX_CHECK_OK(node.Open(exec_state.get()));
+    for (const auto& rb : build_batches) {
+      PX_CHECK_OK(node.ConsumeNext(exec_state.get(), rb, 0));
+    }
+    for (const auto& rb : probe_batches) {
+      PX_CHECK_OK(node.ConsumeNext(exec_state.get(), rb, 1));
+    }
+    PX_CHECK_OK(node.Close(exec_state.get()));
+  }
+  state.SetItemsProcessed(state.iterations() * (num_build_rows + num_probe_rows));
+
+  if (spill) {
+    FLAGS_carnot_join_spill_dir = "";
+    FLAGS_carnot_join_memory_limit_bytes = memory_limit;
+    std::filesystem::remove_all(spill_dir);
+  }
+}
+
+}  // namespace
+
+BENCHMARK_CAPTURE(BM_EquijoinNode, in_memory, /*spill*/ false)
+    ->Args({1 << 10, 1 << 16})
+    ->Args({1 << 16, 1 << 18})
+    ->Args({1 << 20, 1 << 20})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_EquijoinNode, spill, /*spill*/ true)
+    ->Args({1 << 16, 1 << 18})
+    ->Args({1 << 20, 1 << 20})
+    ->Unit(benchmark::kMillisecond);
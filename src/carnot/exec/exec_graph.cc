@@ -36,6 +36,8 @@
 #include "src/carnot/exec/memory_sink_node.h"
 #include "src/carnot/exec/memory_source_node.h"
 #include "src/carnot/exec/otel_export_sink_node.h"
+#include "src/carnot/exec/sort_node.h"
+#include "src/carnot/exec/topk_node.h"
 #include "src/carnot/exec/udtf_source_node.h"
 #include "src/carnot/exec/union_node.h"
 #include "src/carnot/plan/operators.h"
@@ -43,6 +45,10 @@
 #include "src/common/perf/perf.h"
 #include "src/table_store/table_store.h"
 
+DEFINE_int64(carnot_exec_threads, gflags::Int64FromEnv("PL_CARNOT_EXEC_THREADS", 1),
+             "The number of threads that run each pipeline from a memory source to a blocking "
+             "aggregate. Pipelines run on the query's thread when this is 1.");
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -62,7 +68,7 @@ Status ExecutionGraph::Init(table_store::schema::Schema* schema, plan::PlanState
 
   std::unordered_map<int64_t, ExecNode*> nodes;
   std::unordered_map<int64_t, RowDescriptor> descriptors;
-  return plan::PlanFragmentWalker()
+  PX_RETURN_IF_ERROR(plan::PlanFragmentWalker()
       .OnMap([&](auto& node) {
         return OnOperatorImpl<plan::MapOperator, MapNode>(node, &descriptors);
       })
@@ -81,6 +87,12 @@ Status ExecutionGraph::Init(table_store::schema::Schema* schema, plan::PlanState
       .OnLimit([&](auto& node) {
         return OnOperatorImpl<plan::LimitOperator, LimitNode>(node, &descriptors);
       })
+      .OnSort([&](auto& node) {
+        if (node.limit() > 0) {
+          return OnOperatorImpl<plan::SortOperator, TopKNode>(node, &descriptors);
+        }
+        return OnOperatorImpl<plan::SortOperator, SortNode>(node, &descriptors);
+      })
       .OnUnion([&](auto& node) {
         return OnOperatorImpl<plan::UnionOperator, UnionNode>(node, &descriptors);
       })
@@ -108,7 +120,87 @@ Status ExecutionGraph::Init(table_store::schema::Schema* schema, plan::PlanState
       .OnOTelSink([&](auto& node) {
         return OnOperatorImpl<plan::OTelExportSinkOperator, OTelExportSinkNode>(node, &descriptors);
       })
-      .Walk(pf_);
+      .Walk(pf_));
+
+  // The workers of a parallel pipeline run copies of the plan's nodes, which don't have per node
+  // stats, so queries that collect them always run serially.
+  if (FLAGS_carnot_exec_threads > 1 && !collect_exec_node_stats_) {
+    PX_RETURN_IF_ERROR(CreateParallelPipelines(descriptors));
+  }
+  return Status::OK();
+}
+
+Status ExecutionGraph::CreateParallelPipelines(
+    const std::unordered_map<int64_t, RowDescriptor>& descriptors) {
+  auto& dag = pf_->dag();
+  auto& ops = pf_->nodes();
+  for (int64_t source_id : std::vector<int64_t>(sources_)) {
+    const auto* source_op = ops.at(source_id).get();
+    if (source_op->op_type() != planpb::MEMORY_SOURCE_OPERATOR ||
+        static_cast<const plan::MemorySourceOperator*>(source_op)->streaming()) {
+      continue;
+    }
+
+    // Follow the chain of maps and filters below the source, and check whether it ends in an
+    // aggregate that can be split into partial aggregates. Every node in the chain must have a
+    // single parent and a single child.
+    std::vector<int64_t> stage_ids;
+    const plan::AggregateOperator* agg_op = nullptr;
+    int64_t id = source_id;
+    while (true) {
+      auto children = dag.DependenciesOf(id);
+      if (children.size() != 1 || dag.ParentsOf(children[0]).size() != 1) {
+        break;
+      }
+      id = children[0];
+      const auto* op = ops.at(id).get();
+      if (op->op_type() == planpb::MAP_OPERATOR || op->op_type() == planpb::FILTER_OPERATOR) {
+        stage_ids.push_back(id);
+        continue;
+      }
+      if (op->op_type() == planpb::AGGREGATE_OPERATOR) {
+        agg_op = static_cast<const plan::AggregateOperator*>(op);
+      }
+      break;
+    }
+    if (agg_op == nullptr || !ParallelPipeline::CanParallelize(*agg_op, exec_state_)) {
+      continue;
+    }
+    int64_t agg_id = agg_op->id();
+    int64_t agg_parent_id = stage_ids.empty() ? source_id : stage_ids.back();
+
+    std::vector<ParallelPipeline::Stage> stages;
+    for (int64_t stage_id : stage_ids) {
+      stages.push_back({ops.at(stage_id).get(), descriptors.at(stage_id)});
+    }
+
+    // The merge node replaces the original aggregate, and sends its results to the aggregate's
+    // children.
+    PX_ASSIGN_OR_RETURN(auto merge_op, ParallelPipeline::MergeOperator(*agg_op));
+    auto merge_node = pool_.Add(new AggNode());
+    PX_RETURN_IF_ERROR(merge_node->Init(
+        *merge_op, descriptors.at(agg_id),
+        {ParallelPipeline::PartialDescriptor(*agg_op, descriptors.at(agg_parent_id))}));
+    for (int64_t child_id : dag.DependenciesOf(agg_id)) {
+      auto parents = dag.ParentsOf(child_id);
+      auto parent_idx = std::find(parents.begin(), parents.end(), agg_id) - parents.begin();
+      merge_node->AddChild(nodes_.at(child_id), parent_idx);
+    }
+
+    auto pipeline = std::make_unique<ParallelPipeline>(FLAGS_carnot_exec_threads);
+    PX_RETURN_IF_ERROR(pipeline->Init(*static_cast<const plan::MemorySourceOperator*>(source_op),
+                                      descriptors.at(source_id), stages, *agg_op, merge_node));
+    parallel_pipelines_.push_back(std::move(pipeline));
+
+    // The original nodes of the pipeline are never run.
+    sources_.erase(std::find(sources_.begin(), sources_.end(), source_id));
+    nodes_.erase(source_id);
+    for (int64_t stage_id : stage_ids) {
+      nodes_.erase(stage_id);
+    }
+    nodes_[agg_id] = merge_node;
+  }
+  return Status::OK();
 }
 
 bool ExecutionGraph::YieldWithTimeout() {
@@ -302,16 +394,41 @@ Status ExecutionGraph::Execute() {
   for (auto node : nodes) {
     PX_RETURN_IF_ERROR(node->Prepare(exec_state_));
   }
+  for (const auto& pipeline : parallel_pipelines_) {
+    PX_RETURN_IF_ERROR(pipeline->Prepare(exec_state_));
+  }
 
   for (auto node : nodes) {
     PX_RETURN_IF_ERROR(node->Open(exec_state_));
   }
+  for (const auto& pipeline : parallel_pipelines_) {
+    PX_RETURN_IF_ERROR(pipeline->Open(exec_state_));
+  }
 
   // We don't PX_RETURN_IF_ERROR here because we want to make sure we close all of our
   // nodes, even if there was an error during execution.
-  Status source_status = ExecuteSources();
+  Status source_status = Status::OK();
+  for (const auto& pipeline : parallel_pipelines_) {
+    source_status = pipeline->Run(exec_state_);
+    if (!source_status.ok()) {
+      break;
+    }
+  }
+  if (source_status.ok()) {
+    source_status = ExecuteSources();
+  }
   Status close_status = Status::OK();
 
+  for (const auto& pipeline : parallel_pipelines_) {
+    auto s = pipeline->Close(exec_state_);
+    if (!s.ok()) {
+      LOG(ERROR) << absl::Substitute(
+          "Error in ExecutionGraph::Execute() for query $0, could not close parallel pipeline: $1",
+          exec_state_->query_id().str(), s.msg());
+      close_status = s;
+    }
+  }
+
   for (auto node : nodes) {
     auto s = node->Close(exec_state_);
     if (!s.ok()) {
@@ -343,6 +460,10 @@ ExecutionStats ExecutionGraph::GetStats() const {
     bytes_processed += source_node->BytesProcessed();
     rows_processed += source_node->RowsProcessed();
   }
+  for (const auto& pipeline : parallel_pipelines_) {
+    bytes_processed += pipeline->BytesProcessed();
+    rows_processed += pipeline->RowsProcessed();
+  }
   return ExecutionStats({bytes_processed, rows_processed});
 }
 
@@ -32,6 +32,7 @@
 #include "src/carnot/exec/exec_node.h"
 #include "src/carnot/exec/exec_state.h"
 #include "src/carnot/exec/memory_source_node.h"
+#include "src/carnot/exec/parallel_pipeline.h"
 #include "src/carnot/plan/plan_fragment.h"
 #include "src/carnot/plan/plan_state.h"
 #include "src/common/base/base.h"
@@ -207,6 +208,11 @@ class ExecutionGraph {
     return Status::OK();
   }
 
+  // Replaces each memory source -> maps/filters -> aggregate pipeline that can run on several
+  // threads with a ParallelPipeline. See --carnot_exec_threads.
+  Status CreateParallelPipelines(
+      const std::unordered_map<int64_t, table_store::schema::RowDescriptor>& descriptors);
+
   Status ExecuteSources();
 
   ExecState* exec_state_;
@@ -218,6 +224,7 @@ class ExecutionGraph {
   absl::flat_hash_set<int64_t> grpc_sources_;
   absl::flat_hash_set<int64_t> grpc_sinks_;
   std::unordered_map<int64_t, ExecNode*> nodes_;
+  std::vector<std::unique_ptr<ParallelPipeline>> parallel_pipelines_;
 
   SystemTimePoint query_start_time_;
 
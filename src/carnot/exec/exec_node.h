@@ -46,7 +46,7 @@ struct ExecNodeStats {
     }
     ++batches_output;
     bytes_output += rb.NumBytes();
-    rows_output += rb.num_rows();
+    rows_output += rb.num_selected_rows();
   }
 
   void AddInputStats(const table_store::schema::RowBatch& rb) {
@@ -55,7 +55,7 @@ struct ExecNodeStats {
     }
     ++batches_input;
     bytes_input += rb.NumBytes();
-    rows_input += rb.num_rows();
+    rows_input += rb.num_selected_rows();
   }
 
   void ResumeChildTimer() {
@@ -220,7 +220,12 @@ class ExecNode {
     }
     stats_->AddInputStats(rb);
     stats_->ResumeTotalTimer();
-    PX_RETURN_IF_ERROR(ConsumeNextImpl(exec_state, rb, parent_index));
+    if (rb.HasSelection() && !AcceptsSelection(rb)) {
+      PX_ASSIGN_OR_RETURN(auto compacted_rb, rb.Compact());
+      PX_RETURN_IF_ERROR(ConsumeNextImpl(exec_state, *compacted_rb, parent_index));
+    } else {
+      PX_RETURN_IF_ERROR(ConsumeNextImpl(exec_state, rb, parent_index));
+    }
     stats_->StopTotalTimer();
     return Status::OK();
   }
@@ -313,6 +318,10 @@ class ExecNode {
   virtual Status ConsumeNextImpl(ExecState*, const table_store::schema::RowBatch&, size_t) {
     return error::Unimplemented("Implement in derived class (if sink or processing)");
   }
+
+  // Whether ConsumeNextImpl handles the selection vector of the given row batch. Otherwise the
+  // batch is compacted before it's passed to ConsumeNextImpl.
+  virtual bool AcceptsSelection(const table_store::schema::RowBatch&) const { return false; }
   bool is_closed() { return is_closed_; }
 
   std::unique_ptr<table_store::schema::RowDescriptor> output_descriptor_;
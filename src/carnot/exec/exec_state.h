@@ -158,13 +158,22 @@ class ExecState {
     return raw;
   }
 
-  udf::ScalarUDFDefinition* GetScalarUDFDefinition(int64_t id) { return id_to_scalar_udf_map_[id]; }
+  // Uses find rather than operator[], so that it's safe to call from the worker threads of a
+  // parallel pipeline.
+  udf::ScalarUDFDefinition* GetScalarUDFDefinition(int64_t id) {
+    auto it = id_to_scalar_udf_map_.find(id);
+    return it == id_to_scalar_udf_map_.end() ? nullptr : it->second;
+  }
 
   std::map<int64_t, udf::ScalarUDFDefinition*> id_to_scalar_udf_map() {
     return id_to_scalar_udf_map_;
   }
 
-  udf::UDADefinition* GetUDADefinition(int64_t id) { return id_to_uda_map_[id]; }
+  // See GetScalarUDFDefinition.
+  udf::UDADefinition* GetUDADefinition(int64_t id) {
+    auto it = id_to_uda_map_.find(id);
+    return it == id_to_uda_map_.end() ? nullptr : it->second;
+  }
 
   std::unique_ptr<udf::FunctionContext> CreateFunctionContext() {
     auto ctx = std::make_unique<udf::FunctionContext>(metadata_state_, model_pool_);
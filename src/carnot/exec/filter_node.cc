@@ -19,9 +19,9 @@
 #include "src/carnot/exec/filter_node.h"
 
 #include <arrow/array.h>
-#include <arrow/array/builder_binary.h>
 #include <arrow/memory_pool.h>
 #include <arrow/status.h>
+#include <memory>
 #include <ostream>
 #include <string>
 #include <utility>
@@ -31,7 +31,6 @@
 
 #include "src/carnot/plan/scalar_expression.h"
 #include "src/carnot/planpb/plan.pb.h"
-#include "src/carnot/udf/udf_wrapper.h"
 #include "src/common/base/base.h"
 #include "src/shared/types/arrow_adapter.h"
 #include "src/shared/types/column_wrapper.h"
@@ -75,63 +74,25 @@ Status FilterNode::CloseImpl(ExecState* exec_state) {
   return Status::OK();
 }
 
-template <types::DataType T>
-Status PredicateCopyValues(const types::BoolValueColumnWrapper& pred, const arrow::Array* input_col,
-                           RowBatch* output_rb) {
-  DCHECK_EQ(pred.Size(), static_cast<size_t>(input_col->length()));
-  size_t num_output_records = output_rb->num_rows();
-  size_t num_input_records = input_col->length();
-  auto output_col_builder_generic = MakeArrowBuilder(T, arrow::default_memory_pool());
-  auto* output_col_builder = static_cast<typename types::DataTypeTraits<T>::arrow_builder_type*>(
-      output_col_builder_generic.get());
-  PX_RETURN_IF_ERROR(output_col_builder->Reserve(num_output_records));
-  for (size_t idx = 0; idx < num_input_records; ++idx) {
-    if (udf::UnWrap(pred[idx])) {
-      output_col_builder->UnsafeAppend(types::GetValueFromArrowArray<T>(input_col, idx));
-    }
+namespace {
+
+// Writes the indices of the rows for which the predicate is true into selection. The loop is
+// branch free, since branches on the predicate are mispredicted at middling selectivities.
+void SelectRows(const types::BoolValueColumnWrapper& pred, std::vector<int64_t>* selection) {
+  size_t num_rows = pred.Size();
+  selection->resize(num_rows);
+  int64_t* out = selection->data();
+  size_t num_selected = 0;
+  for (size_t i = 0; i < num_rows; ++i) {
+    out[num_selected] = i;
+    num_selected += pred[i].val;
   }
-  std::shared_ptr<arrow::Array> output_array;
-  PX_RETURN_IF_ERROR(output_col_builder->Finish(&output_array));
-  PX_RETURN_IF_ERROR(output_rb->AddColumn(output_array));
-  return Status::OK();
+  selection->resize(num_selected);
 }
 
-template <>
-Status PredicateCopyValues<types::STRING>(const types::BoolValueColumnWrapper& pred,
-                                          const arrow::Array* input_col, RowBatch* output_rb) {
-  DCHECK_EQ(pred.Size(), static_cast<size_t>(input_col->length()));
-  size_t num_output_records = output_rb->num_rows();
-  size_t num_input_records = input_col->length();
-  size_t reserved =
-      100;  // This can be an arbritrary number, since we do exponential doubling below.
-  size_t total_size = 0;
-
-  auto output_col_builder_generic = MakeArrowBuilder(types::STRING, arrow::default_memory_pool());
-  auto* output_col_builder = static_cast<types::DataTypeTraits<types::STRING>::arrow_builder_type*>(
-      output_col_builder_generic.get());
-
-  PX_RETURN_IF_ERROR(output_col_builder->Reserve(num_output_records));
-  PX_RETURN_IF_ERROR(output_col_builder->ReserveData(reserved));
-  for (size_t idx = 0; idx < num_input_records; ++idx) {
-    if (udf::UnWrap(pred[idx])) {
-      auto res = types::GetValueFromArrowArray<types::STRING>(input_col, idx);
-      total_size += res.size();
-      while (total_size >= reserved) {
-        reserved *= 2;
-      }
-      PX_RETURN_IF_ERROR(output_col_builder->ReserveData(reserved));
-      output_col_builder->UnsafeAppend(std::move(res));
-    }
-  }
-  std::shared_ptr<arrow::Array> output_array;
-  PX_RETURN_IF_ERROR(output_col_builder->Finish(&output_array));
-  PX_RETURN_IF_ERROR(output_rb->AddColumn(output_array));
-  return Status::OK();
-}
+}  // namespace
 
 Status FilterNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_t) {
-  // Current implementation does not merge across row batches, we should
-  // consider this for cases where the filter has really low selectivity.
   PX_ASSIGN_OR_RETURN(auto pred_col, evaluator_->EvaluateSingleExpression(
                                          exec_state, rb, *plan_node_->expression()));
 
@@ -140,28 +101,20 @@ Status FilterNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, si
 
   const types::BoolValueColumnWrapper& pred_col_wrapper =
       *static_cast<types::BoolValueColumnWrapper*>(pred_col.get());
-  size_t num_pred = pred_col_wrapper.Size();
+  DCHECK_EQ(static_cast<size_t>(rb.num_rows()), pred_col_wrapper.Size());
 
-  DCHECK_EQ(static_cast<size_t>(rb.num_rows()), num_pred);
+  auto selection = std::make_shared<std::vector<int64_t>>();
+  SelectRows(pred_col_wrapper, selection.get());
 
-  // Find out how many of them returned true;
-  size_t num_output_records = 0;
-  for (size_t i = 0; i < num_pred; ++i) {
-    if (pred_col_wrapper[i].val) {
-      ++num_output_records;
-    }
-  }
-
-  RowBatch output_rb(*output_descriptor_, num_output_records);
+  // Rather than copying the selected rows, the output shares the input's columns and only selects
+  // the rows that passed the filter. Children that can't handle the selection compact the batch.
+  RowBatch output_rb(*output_descriptor_, rb.num_rows());
   DCHECK_EQ(output_descriptor_->size(), plan_node_->selected_cols().size());
-
-  for (const auto& [output_col_idx, input_col_idx] : Enumerate(plan_node_->selected_cols())) {
-    auto input_col = rb.ColumnAt(input_col_idx);
-    auto col_type = output_descriptor_->type(output_col_idx);
-#define TYPE_CASE(_dt_) \
-  PX_RETURN_IF_ERROR(PredicateCopyValues<_dt_>(pred_col_wrapper, input_col.get(), &output_rb));
-    PX_SWITCH_FOREACH_DATATYPE(col_type, TYPE_CASE);
-#undef TYPE_CASE
+  for (int64_t input_col_idx : plan_node_->selected_cols()) {
+    PX_RETURN_IF_ERROR(output_rb.AddColumn(rb.ColumnAt(input_col_idx)));
+  }
+  if (static_cast<int64_t>(selection->size()) < rb.num_rows()) {
+    output_rb.set_selection(std::move(selection));
   }
 
   output_rb.set_eow(rb.eow());
@@ -0,0 +1,155 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <absl/strings/str_cat.h>
+#include <sole.hpp>
+
+#include "src/carnot/exec/filter_node.h"
+#include "src/carnot/exec/test_utils.h"
+#include "src/carnot/planpb/test_proto.h"
+#include "src/carnot/udf/registry.h"
+#include "src/carnot/udf/udf.h"
+#include "src/common/base/base.h"
+#include "src/shared/types/types.h"
+
+using px::carnot::exec::ExecState;
+using px::carnot::exec::FilterNode;
+using px::carnot::exec::MockMetricsStubGenerator;
+using px::carnot::exec::MockResultSinkStubGenerator;
+using px::carnot::exec::MockTraceStubGenerator;
+using px::carnot::exec::RowBatchBuilder;
+using px::table_store::schema::RowBatch;
+using px::table_store::schema::RowDescriptor;
+using px::types::DataType;
+
+namespace {
+
+class EqUDF : public px::carnot::udf::ScalarUDF {
+ public:
+  px::types::BoolValue Exec(px::carnot::udf::FunctionContext*, px::types::Int64Value v1,
+                            px::types::Int64Value v2) {
+    return v1.val == v2.val;
+  }
+};
+
+// CountingSinkNode counts the rows it receives. When kAcceptsSelection is false, the rows that
+// pass the filter are copied into a compacted batch before they reach the sink, as they would be
+// for a sink or a map.
+template <bool kAcceptsSelection>
+class CountingSinkNode : public px::carnot::exec::SinkNode {
+ public:
+  int64_t num_rows() const { return num_rows_; }
+
+ protected:
+  std::string DebugStringImpl() override { return "CountingSinkNode"; }
+  px::Status InitImpl(const px::carnot::plan::Operator&) override { return px::Status::OK(); }
+  px::Status PrepareImpl(ExecState*) override { return px::Status::OK(); }
+  px::Status OpenImpl(ExecState*) override { return px::Status::OK(); }
+  px::Status CloseImpl(ExecState*) override { return px::Status::OK(); }
+  px::Status ConsumeNextImpl(ExecState*, const RowBatch& rb, size_t) override {
+    num_rows_ += rb.num_selected_rows();
+    return px::Status::OK();
+  }
+  bool AcceptsSelection(const RowBatch&) const override { return kAcceptsSelection; }
+
+ private:
+  int64_t num_rows_ = 0;
+};
+
+constexpr int64_t kRowsPerBatch = 1024;
+
+template <bool kAcceptsSelection>
+// NOLINTNEXTLINE : runtime/references.
+void BM_FilterNode(benchmark::State& state) {
+  int64_t num_rows = state.range(0);
+  // The filter keeps the rows whose first column is 1, so 1/num_values of the rows pass.
+  int64_t num_values = state.range(1);
+
+  auto func_registry = std::make_unique<px::carnot::udf::Registry>("test_registry");
+  PX_CHECK_OK(func_registry->Register<EqUDF>("eq"));
+  auto table_store = std::make_shared<px::table_store::TableStore>();
+  auto exec_state = std::make_unique<ExecState>(
+      func_registry.get(), table_store, MockResultSinkStubGenerator, MockMetricsStubGenerator,
+      MockTraceStubGenerator, sole::uuid4(), nullptr);
+  PX_CHECK_OK(exec_state->AddScalarUDF(0, "eq", {DataType::INT64, DataType::INT64}));
+
+  auto plan_node = px::carnot::plan::FilterOperator::FromProto(
+      px::carnot::planpb::testutils::CreateTestFilterTwoCols(), 1);
+  RowDescriptor rd({DataType::INT64, DataType::INT64, DataType::STRING});
+
+  std::mt19937_64 rng(42);
+  std::uniform_int_distribution<int64_t> value_dist(0, num_values - 1);
+  std::vector<RowBatch> batches;
+  for (int64_t start = 0; start < num_rows; start += kRowsPerBatch) {
+    int64_t batch_rows = std::min(kRowsPerBatch, num_rows - start);
+    std::vector<px::types::Int64Value> filter_col;
+    std::vector<px::types::Int64Value> int_col;
+    std::vector<px::types::StringValue> string_col;
+    for (int64_t i = 0; i < batch_rows; ++i) {
+      filter_col.push_back(value_dist(rng));
+      int_col.push_back(start + i);
+      string_col.push_back(absl::StrCat("/api/v1/resource/", start + i));
+    }
+    bool eos = start + batch_rows >= num_rows;
+    batches.push_back(RowBatchBuilder(rd, batch_rows, /*eow*/ eos, /*eos*/ eos)
+                          .AddColumn<px::types::Int64Value>(filter_col)
+                          .AddColumn<px::types::Int64Value>(int_col)
+                          .AddColumn<px::types::StringValue>(string_col)
+                          .get());
+  }
+
+  for (auto _ : state) {
+    FilterNode node;
+    CountingSinkNode<kAcceptsSelection> sink;
+    PX_CHECK_OK(node.Init(*plan_node, rd, {rd}));
+    PX_CHECK_OK(sink.Init(*plan_node, rd, {rd}));
+    node.AddChild(&sink, 0);
+    PX_CHECK_OK(node.Prepare(exec_state.get()));
+    PX_CHECK_OK(sink.Prepare(exec_state.get()));
+    PX_CHECK_OK(node.Open(exec_state.get()));
+    PX_CHECK_OK(sink.Open(exec_state.get()));
+    for (const auto& rb : batches) {
+      PX_CHECK_OK(node.ConsumeNext(exec_state.get(), rb, 0));
+    }
+    benchmark::DoNotOptimize(sink.num_rows());
+    PX_CHECK_OK(node.Close(exec_state.get()));
+    PX_CHECK_OK(sink.Close(exec_state.get()));
+  }
+  state.SetItemsProcessed(state.iterations() * num_rows);
+}
+
+}  // namespace
+
+BENCHMARK_TEMPLATE(BM_FilterNode, /*kAcceptsSelection*/ false)
+    ->Args({1 << 16, 1})
+    ->Args({1 << 16, 2})
+    ->Args({1 << 16, 10})
+    ->Args({1 << 16, 100});
+BENCHMARK_TEMPLATE(BM_FilterNode, /*kAcceptsSelection*/ true)
+    ->Args({1 << 16, 1})
+    ->Args({1 << 16, 2})
+    ->Args({1 << 16, 10})
+    ->Args({1 << 16, 100});
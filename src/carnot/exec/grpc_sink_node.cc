@@ -21,12 +21,16 @@
 #include <chrono>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include <absl/strings/str_join.h>
 #include <absl/strings/substitute.h>
 
 #include "src/carnot/carnotpb/carnot.pb.h"
+#include "src/carnot/exec/agg_hash_table.h"
 #include "src/carnot/planpb/plan.pb.h"
+#include "src/common/base/hash_utils.h"
 #include "src/common/base/macros.h"
 #include "src/common/uuid/uuid_utils.h"
 #include "src/table_store/table_store.h"
@@ -38,7 +42,26 @@ namespace exec {
 using table_store::schema::RowBatch;
 using table_store::schema::RowDescriptor;
 
+namespace {
+
+// The hash tables of the aggregates and joins on the destinations index rows by the low and high
+// bits of the same key hashes, so the hash is remixed before it picks a partition. Otherwise all
+// of the keys sent to one destination would share some of the bits used by its hash tables.
+constexpr uint64_t kPartitionHashSeed = 0x2545f4914f6cdd1dULL;
+
+inline size_t PartitionOf(uint64_t hash, size_t num_partitions) {
+  return HashCombine(hash, kPartitionHashSeed) % num_partitions;
+}
+
+}  // namespace
+
 std::string GRPCSinkNode::DebugStringImpl() {
+  if (!partitions_.empty()) {
+    return absl::Substitute("Exec::GRPCSinkNode: {partitions: $0, partition_columns: [$1], "
+                            "output: $2}",
+                            partitions_.size(), absl::StrJoin(partition_cols_, ","),
+                            input_descriptor_->DebugString());
+  }
   std::string destination;
   if (plan_node_->has_table_name()) {
     destination = absl::Substitute("table_name: $0", plan_node_->table_name());
@@ -68,7 +91,10 @@ StatusOr<carnotpb::TransferResultChunkRequest> RequestWithMetadata(
 }
 
 Status GRPCSinkNode::OptionallyCheckConnection(ExecState* exec_state) {
-  if (sent_eos_ || cancelled_) {
+  for (const auto& partition : partitions_) {
+    PX_RETURN_IF_ERROR(partition->OptionallyCheckConnection(exec_state));
+  }
+  if (!partitions_.empty() || sent_eos_ || cancelled_) {
     return Status::OK();
   }
 
@@ -99,10 +125,44 @@ Status GRPCSinkNode::InitImpl(const plan::Operator& plan_node) {
   input_descriptor_ = std::make_unique<RowDescriptor>(input_descriptors_[0]);
   const auto* sink_plan_node = static_cast<const plan::GRPCSinkOperator*>(&plan_node);
   plan_node_ = std::make_unique<plan::GRPCSinkOperator>(*sink_plan_node);
+  if (plan_node_->partitioned()) {
+    return InitPartitions();
+  }
+  return Status::OK();
+}
+
+Status GRPCSinkNode::InitPartitions() {
+  partition_cols_ = plan_node_->partition_column_indices();
+  if (partition_cols_.empty()) {
+    return error::InvalidArgument("Partitioned GRPCSink $0 has no partition columns",
+                                  plan_node_->id());
+  }
+  for (int64_t col_idx : partition_cols_) {
+    if (col_idx < 0 || col_idx >= static_cast<int64_t>(input_descriptor_->size())) {
+      return error::InvalidArgument("Partition column $0 of GRPCSink $1 is out of range", col_idx,
+                                    plan_node_->id());
+    }
+    partition_col_types_.push_back(input_descriptor_->type(col_idx));
+  }
+
+  for (int64_t i = 0; i < plan_node_->num_partitions(); ++i) {
+    auto partition_plan_node = std::make_unique<plan::GRPCSinkOperator>(plan_node_->id());
+    PX_RETURN_IF_ERROR(partition_plan_node->Init(plan_node_->PartitionPlan(i)));
+    auto partition = std::make_unique<GRPCSinkNode>(max_batch_size_, batch_size_factor_);
+    PX_RETURN_IF_ERROR(
+        partition->Init(*partition_plan_node, *output_descriptor_, input_descriptors_));
+    partition_plan_nodes_.push_back(std::move(partition_plan_node));
+    partitions_.push_back(std::move(partition));
+  }
   return Status::OK();
 }
 
-Status GRPCSinkNode::PrepareImpl(ExecState*) { return Status::OK(); }
+Status GRPCSinkNode::PrepareImpl(ExecState* exec_state) {
+  for (const auto& partition : partitions_) {
+    PX_RETURN_IF_ERROR(partition->Prepare(exec_state));
+  }
+  return Status::OK();
+}
 
 Status GRPCSinkNode::StartConnection(ExecState* exec_state) {
   return StartConnectionWithRetries(exec_state, kGRPCRetries);
@@ -183,7 +243,15 @@ Status GRPCSinkNode::TryWriteRequest(ExecState* exec_state,
   return Status::OK();
 }
 
-Status GRPCSinkNode::OpenImpl(ExecState* exec_state) { return StartConnection(exec_state); }
+Status GRPCSinkNode::OpenImpl(ExecState* exec_state) {
+  if (partitions_.empty()) {
+    return StartConnection(exec_state);
+  }
+  for (const auto& partition : partitions_) {
+    PX_RETURN_IF_ERROR(partition->Open(exec_state));
+  }
+  return Status::OK();
+}
 
 Status GRPCSinkNode::CloseWriter(ExecState* exec_state) {
   if (writer_ == nullptr) {
@@ -200,6 +268,16 @@ Status GRPCSinkNode::CloseWriter(ExecState* exec_state) {
 }
 
 Status GRPCSinkNode::CloseImpl(ExecState* exec_state) {
+  if (!partitions_.empty()) {
+    Status status = Status::OK();
+    for (const auto& partition : partitions_) {
+      auto s = partition->Close(exec_state);
+      if (!s.ok()) {
+        status = s;
+      }
+    }
+    return status;
+  }
   if (sent_eos_ || cancelled_) {
     return Status::OK();
   }
@@ -302,7 +380,49 @@ Status GRPCSinkNode::SplitAndSendBatch(ExecState* exec_state, const RowBatch& rb
   return ConsumeNextImplNoSplit(exec_state, *output_rb, parent_idx);
 }
 
+Status GRPCSinkNode::PartitionAndSendBatch(ExecState* exec_state, const RowBatch& rb) {
+  std::vector<const arrow::Array*> keys;
+  keys.reserve(partition_cols_.size());
+  for (int64_t col_idx : partition_cols_) {
+    keys.push_back(rb.ColumnAt(col_idx).get());
+  }
+  // This hashes the unselected rows too, which is cheaper than gathering the selected keys first.
+  HashKeyColumns(keys, partition_col_types_, &hashes_);
+
+  std::vector<std::vector<int64_t>> partition_rows(partitions_.size());
+  for (int64_t i = 0; i < rb.num_selected_rows(); ++i) {
+    int64_t row = rb.HasSelection() ? rb.selection()[i] : i;
+    partition_rows[PartitionOf(hashes_[row], partitions_.size())].push_back(row);
+  }
+
+  for (size_t i = 0; i < partitions_.size(); ++i) {
+    // Every destination has to see the end of each window and of the stream, even if none of the
+    // rows of this batch belong to it.
+    if (partition_rows[i].empty() && !rb.eow() && !rb.eos()) {
+      continue;
+    }
+    // The partition shares the columns of the input, and selects its rows. The partition's sink
+    // compacts them into a new batch before sending it.
+    RowBatch partition_rb(rb.desc(), rb.num_rows());
+    for (int64_t col_idx = 0; col_idx < rb.num_columns(); ++col_idx) {
+      PX_RETURN_IF_ERROR(partition_rb.AddColumn(rb.ColumnAt(col_idx)));
+    }
+    partition_rb.set_selection(
+        std::make_shared<const std::vector<int64_t>>(std::move(partition_rows[i])));
+    partition_rb.set_eow(rb.eow());
+    partition_rb.set_eos(rb.eos());
+    PX_RETURN_IF_ERROR(partitions_[i]->ConsumeNext(exec_state, partition_rb, 0));
+  }
+  if (rb.eos()) {
+    sent_eos_ = true;
+  }
+  return Status::OK();
+}
+
 Status GRPCSinkNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_t parent_idx) {
+  if (!partitions_.empty()) {
+    return PartitionAndSendBatch(exec_state, rb);
+  }
   if (rb.NumBytes() > (max_batch_size_ * batch_size_factor_)) {
     return SplitAndSendBatch(exec_state, rb, parent_idx);
   }
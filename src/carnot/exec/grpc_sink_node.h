@@ -51,6 +51,14 @@ constexpr float kBatchSizeFactor = 0.9f;
 // Number of times to retry connecting to grpc before giving up.
 constexpr size_t kGRPCRetries = 3;
 
+/**
+ * GRPCSinkNode sends its input to another Carnot instance (or to the query broker) over GRPC.
+ *
+ * A partitioned GRPCSinkNode hashes the partition columns of each row to pick one of several
+ * destinations for it. It keeps one unpartitioned GRPCSinkNode per destination, which owns the
+ * connection to that destination, and passes each of them the rows of its partition. Every
+ * destination gets the end of window and end of stream of every input batch.
+ */
 class GRPCSinkNode : public SinkNode {
  public:
   GRPCSinkNode(size_t max_batch_size, float batch_size_factor)
@@ -76,6 +84,11 @@ class GRPCSinkNode : public SinkNode {
   Status CloseImpl(ExecState* exec_state) override;
   Status ConsumeNextImpl(ExecState* exec_state, const table_store::schema::RowBatch& rb,
                          size_t parent_index) override;
+  // A partitioned sink picks the selected rows of each partition itself, so it doesn't need the
+  // batch to be compacted first.
+  bool AcceptsSelection(const table_store::schema::RowBatch&) const override {
+    return !partitions_.empty();
+  }
   Status ConsumeNextImplNoSplit(ExecState* exec_state, const table_store::schema::RowBatch& rb,
                                 size_t parent_index);
   Status SplitAndSendBatch(ExecState* exec_state, const table_store::schema::RowBatch& rb,
@@ -90,6 +103,8 @@ class GRPCSinkNode : public SinkNode {
   Status StartConnectionWithRetries(ExecState* exec_state, size_t n_retries);
   Status CancelledByServer(ExecState* exec_state);
   Status TryWriteRequest(ExecState* exec_state, const carnotpb::TransferResultChunkRequest& req);
+  Status InitPartitions();
+  Status PartitionAndSendBatch(ExecState* exec_state, const table_store::schema::RowBatch& rb);
 
   bool cancelled_ = false;
 
@@ -107,6 +122,14 @@ class GRPCSinkNode : public SinkNode {
 
   size_t max_batch_size_;
   float batch_size_factor_;
+
+  // Used when the sink is partitioned.
+  std::vector<int64_t> partition_cols_;
+  std::vector<types::DataType> partition_col_types_;
+  std::vector<std::unique_ptr<plan::GRPCSinkOperator>> partition_plan_nodes_;
+  std::vector<std::unique_ptr<GRPCSinkNode>> partitions_;
+  // Scratch space for the hashes of the partition columns of the current batch.
+  std::vector<uint64_t> hashes_;
 };
 
 }  // namespace exec
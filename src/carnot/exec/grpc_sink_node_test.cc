@@ -18,10 +18,14 @@
 
 #include "src/carnot/exec/grpc_sink_node.h"
 
+#include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
 #include <grpcpp/test/mock_stream.h>
+#include <absl/container/flat_hash_map.h>
+#include <google/protobuf/text_format.h>
 #include <gtest/gtest.h>
 #include <sole.hpp>
 
@@ -763,6 +767,115 @@ TEST_F(GRPCSinkNodeTest, check_connection_after_eos) {
   tester.Close();
 }
 
+constexpr char kPartitionedGRPCSink[] = R"proto(
+partition_column_indices: 0
+partition_destinations {
+  address: "localhost:1234"
+  grpc_source_id: 1
+}
+partition_destinations {
+  address: "localhost:1235"
+  grpc_source_id: 2
+}
+)proto";
+
+class GRPCSinkNodePartitionTest : public ::testing::Test {
+ public:
+  GRPCSinkNodePartitionTest() {
+    func_registry_ = std::make_unique<udf::Registry>("test_registry");
+    auto table_store = std::make_shared<table_store::TableStore>();
+
+    for (const auto& address : {"localhost:1234", "localhost:1235"}) {
+      auto mock = std::make_unique<MockResultSinkServiceStub>();
+      mocks_[address] = mock.get();
+      mocks_unique_[address] = std::move(mock);
+    }
+
+    exec_state_ = std::make_unique<ExecState>(
+        func_registry_.get(), table_store,
+        [this](const std::string& address,
+               const std::string&) -> std::unique_ptr<ResultSinkService::StubInterface> {
+          return std::move(mocks_unique_[address]);
+        },
+        MockMetricsStubGenerator, MockTraceStubGenerator, sole::uuid4(), nullptr, nullptr,
+        [](grpc::ClientContext*) {});
+  }
+
+ protected:
+  std::unique_ptr<ExecState> exec_state_;
+  std::unique_ptr<udf::Registry> func_registry_;
+  absl::flat_hash_map<std::string, MockResultSinkServiceStub*> mocks_;
+
+ private:
+  absl::flat_hash_map<std::string, std::unique_ptr<MockResultSinkServiceStub>> mocks_unique_;
+};
+
+TEST_F(GRPCSinkNodePartitionTest, partitions_rows_by_hash) {
+  planpb::GRPCSinkOperator op_proto;
+  ASSERT_TRUE(google::protobuf::TextFormat::ParseFromString(kPartitionedGRPCSink, &op_proto));
+  auto plan_node = std::make_unique<plan::GRPCSinkOperator>(1);
+  ASSERT_OK(plan_node->Init(op_proto));
+  RowDescriptor input_rd({types::DataType::INT64});
+  RowDescriptor output_rd({types::DataType::INT64});
+
+  TransferResultChunkResponse resp;
+  resp.set_success(true);
+
+  absl::flat_hash_map<std::string, std::vector<TransferResultChunkRequest>> requests;
+  for (const auto& [address, mock] : mocks_) {
+    auto writer = new grpc::testing::MockClientWriter<TransferResultChunkRequest>();
+    auto* address_requests = &requests[address];
+    EXPECT_CALL(*writer, Write(_, _))
+        .WillRepeatedly(DoAll(Invoke([address_requests](const TransferResultChunkRequest& req,
+                                                        grpc::WriteOptions) {
+                                address_requests->push_back(req);
+                              }),
+                              Return(true)));
+    EXPECT_CALL(*writer, WritesDone()).WillOnce(Return(true));
+    EXPECT_CALL(*writer, Finish()).WillOnce(Return(grpc::Status::OK));
+    EXPECT_CALL(*mock, TransferResultChunkRaw(_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(resp), Return(writer)));
+  }
+
+  auto tester = exec::ExecNodeTester<GRPCSinkNode, plan::GRPCSinkOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+
+  std::vector<types::Int64Value> data;
+  for (int64_t i = 0; i < 50; ++i) {
+    data.emplace_back(i);
+  }
+  for (bool last : {false, true}) {
+    auto rb = RowBatchBuilder(output_rd, data.size(), /*eow*/ last, /*eos*/ last)
+                  .AddColumn<types::Int64Value>(data)
+                  .get();
+    tester.ConsumeNext(rb, 5, 0);
+  }
+  tester.Close();
+
+  // Each value goes to one partition, every time it is sent.
+  absl::flat_hash_map<int64_t, std::string> value_partition;
+  absl::flat_hash_map<int64_t, int64_t> value_count;
+  for (const auto& [address, address_requests] : requests) {
+    ASSERT_FALSE(address_requests.empty());
+    int64_t num_rows = 0;
+    for (const auto& req : address_requests) {
+      EXPECT_EQ(address, req.address());
+      EXPECT_EQ(address == "localhost:1234" ? 1U : 2U, req.query_result().grpc_source_id());
+      for (auto value : req.query_result().row_batch().cols(0).int64_data().data()) {
+        EXPECT_EQ(address, value_partition.try_emplace(value, address).first->second);
+        ++value_count[value];
+        ++num_rows;
+      }
+    }
+    EXPECT_GT(num_rows, 0);
+    EXPECT_TRUE(address_requests.back().query_result().row_batch().eos());
+  }
+  EXPECT_EQ(50U, value_count.size());
+  for (const auto& [value, count] : value_count) {
+    EXPECT_EQ(2, count);
+  }
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
@@ -0,0 +1,568 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/join_hash_table.h"
+
+#include <arrow/memory_pool.h>
+
+#include <algorithm>
+
+#include "src/shared/types/type_utils.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::internal::ColdBatch;
+using table_store::schema::RowBatch;
+using table_store::schema::RowDescriptor;
+
+namespace {
+
+constexpr int64_t kBloomFilterBitsPerKey = 16;
+constexpr uint64_t kMaxSpillFileSize = 64 * 1024 * 1024;
+// Build rows of a spilled partition, and deferred probe rows, are written out in batches of about
+// this size.
+constexpr int64_t kSpillBatchBytes = 4 * 1024 * 1024;
+
+template <types::DataType DT>
+void AppendColumnRows(const arrow::Array* arr, const int64_t* rows, int64_t num_rows,
+                      types::ColumnWrapper* wrapper) {
+  auto* mutable_arr = const_cast<arrow::Array*>(arr);
+  wrapper->Reserve(wrapper->Size() + num_rows);
+  for (int64_t i = 0; i < num_rows; ++i) {
+    types::ExtractValueToColumnWrapper<DT>(wrapper, mutable_arr, rows == nullptr ? i : rows[i]);
+  }
+}
+
+int64_t WrappersBytes(const std::vector<types::SharedColumnWrapper>& wrappers) {
+  int64_t bytes = 0;
+  for (const auto& wrapper : wrappers) {
+    bytes += wrapper->Bytes();
+  }
+  return bytes;
+}
+
+std::vector<types::SharedColumnWrapper> MakeWrappers(
+    const std::vector<types::DataType>& data_types) {
+  std::vector<types::SharedColumnWrapper> wrappers;
+  wrappers.reserve(data_types.size());
+  for (auto data_type : data_types) {
+    wrappers.push_back(types::ColumnWrapper::Make(data_type, 0));
+  }
+  return wrappers;
+}
+
+StatusOr<table_store::internal::SpillBatch> SpillWrappers(
+    const std::vector<types::SharedColumnWrapper>& wrappers,
+    table_store::internal::SpillWriter* writer) {
+  std::vector<table_store::internal::ArrowArrayPtr> arrays;
+  arrays.reserve(wrappers.size());
+  for (const auto& wrapper : wrappers) {
+    arrays.push_back(wrapper->ConvertToArrow(arrow::default_memory_pool()));
+  }
+  return writer->Write(ColdBatch(arrays));
+}
+
+std::vector<int64_t> AllColumns(size_t num_cols) {
+  std::vector<int64_t> cols(num_cols);
+  for (size_t i = 0; i < num_cols; ++i) {
+    cols[i] = i;
+  }
+  return cols;
+}
+
+// Reads the first data_types.size() columns of a spilled batch.
+StatusOr<RowBatch> ReadSpillBatch(const table_store::internal::SpillBatch& batch,
+                                  const std::vector<types::DataType>& data_types) {
+  RowBatch rb(RowDescriptor(data_types), batch.Length());
+  PX_RETURN_IF_ERROR(
+      batch.AddBatchSliceToRowBatch(0, batch.Length(), AllColumns(data_types.size()), &rb));
+  return rb;
+}
+
+std::vector<const arrow::Array*> Columns(const RowBatch& rb, int64_t begin, int64_t end) {
+  std::vector<const arrow::Array*> columns;
+  for (int64_t col_idx = begin; col_idx < end; ++col_idx) {
+    columns.push_back(rb.ColumnAt(col_idx).get());
+  }
+  return columns;
+}
+
+}  // namespace
+
+JoinBloomFilter::JoinBloomFilter(int64_t num_keys) {
+  uint64_t min_words = (std::max<int64_t>(num_keys, 1) * kBloomFilterBitsPerKey + 63) / 64;
+  uint64_t num_words = 1;
+  while (num_words < min_words) {
+    num_words <<= 1;
+  }
+  words_.assign(num_words, 0);
+  word_mask_ = num_words - 1;
+}
+
+JoinHashTable::JoinHashTable(std::vector<types::DataType> key_types,
+                             std::vector<types::DataType> build_value_types,
+                             std::vector<types::DataType> probe_types, Options opts)
+    : key_types_(std::move(key_types)),
+      build_value_types_(std::move(build_value_types)),
+      probe_types_(std::move(probe_types)),
+      opts_(std::move(opts)) {
+  build_types_ = key_types_;
+  build_types_.insert(build_types_.end(), build_value_types_.begin(), build_value_types_.end());
+  probe_spill_types_ = probe_types_;
+  probe_spill_types_.push_back(types::INT64);
+  partitions_.resize(kNumPartitions);
+  for (auto& partition : partitions_) {
+    partition.pending_build = MakeWrappers(build_types_);
+    partition.pending_probe = MakeWrappers(probe_spill_types_);
+  }
+  if (!opts_.spill_dir.empty()) {
+    spill_writer_.emplace(opts_.spill_dir, "join", kMaxSpillFileSize);
+  }
+}
+
+void JoinHashTable::AppendRows(const std::vector<const arrow::Array*>& arrays,
+                               const std::vector<types::DataType>& data_types, const int64_t* rows,
+                               int64_t num_rows,
+                               std::vector<types::SharedColumnWrapper>* wrappers) {
+  DCHECK_EQ(arrays.size(), data_types.size());
+  for (size_t col_idx = 0; col_idx < arrays.size(); ++col_idx) {
+    auto* wrapper = (*wrappers)[col_idx].get();
+#define TYPE_CASE(_dt_) AppendColumnRows<_dt_>(arrays[col_idx], rows, num_rows, wrapper);
+    PX_SWITCH_FOREACH_DATATYPE(data_types[col_idx], TYPE_CASE);
+#undef TYPE_CASE
+  }
+}
+
+int JoinHashTable::PartitionOf(uint64_t hash) const {
+  int p = SubPartitionOf(hash, 1);
+  while (partitions_[p].first_child >= 0) {
+    p = partitions_[p].first_child + SubPartitionOf(hash, partitions_[p].level + 1);
+  }
+  return p;
+}
+
+void JoinHashTable::AddBuildHash(Partition* partition, uint64_t hash) {
+  if (!partition->has_build_rows) {
+    partition->has_build_rows = true;
+    partition->build_hash = hash;
+  } else if (hash != partition->build_hash) {
+    partition->mixed_build_hashes = true;
+  }
+}
+
+void JoinHashTable::PartitionRows(const std::vector<int64_t>& rows) {
+  partition_starts_.assign(NumPartitions() + 1, 0);
+  for (int64_t row : rows) {
+    ++partition_starts_[row_partitions_[row] + 1];
+  }
+  for (int p = 0; p < NumPartitions(); ++p) {
+    partition_starts_[p + 1] += partition_starts_[p];
+  }
+  std::vector<int64_t> next(partition_starts_.begin(), partition_starts_.end() - 1);
+  partition_rows_.resize(rows.size());
+  for (int64_t row : rows) {
+    partition_rows_[next[row_partitions_[row]]++] = row;
+  }
+}
+
+Status JoinHashTable::AppendBuildBatch(const std::vector<const arrow::Array*>& keys,
+                                       const std::vector<const arrow::Array*>& values) {
+  DCHECK(!build_finished_);
+  std::vector<const arrow::Array*> columns = keys;
+  columns.insert(columns.end(), values.begin(), values.end());
+
+  HashKeyColumns(keys, key_types_, &hashes_);
+  int64_t num_rows = hashes_.size();
+  row_partitions_.resize(num_rows);
+  selected_rows_.resize(num_rows);
+  for (int64_t i = 0; i < num_rows; ++i) {
+    row_partitions_[i] = PartitionOf(hashes_[i]);
+    AddBuildHash(&partitions_[row_partitions_[i]], hashes_[i]);
+    selected_rows_[i] = i;
+  }
+  PartitionRows(selected_rows_);
+
+  for (int p = 0; p < NumPartitions(); ++p) {
+    int64_t start = partition_starts_[p];
+    int64_t num_partition_rows = partition_starts_[p + 1] - start;
+    if (num_partition_rows == 0) {
+      continue;
+    }
+    PX_RETURN_IF_ERROR(AppendPendingBuild(&partitions_[p], columns, partition_rows_.data() + start,
+                                          num_partition_rows));
+  }
+  return MaybeSpill();
+}
+
+Status JoinHashTable::AppendPendingBuild(Partition* partition,
+                                         const std::vector<const arrow::Array*>& columns,
+                                         const int64_t* rows, int64_t num_rows) {
+  AppendRows(columns, build_types_, rows, num_rows, &partition->pending_build);
+  int64_t bytes = WrappersBytes(partition->pending_build);
+  memory_used_bytes_ += bytes - partition->pending_build_bytes;
+  partition->pending_build_bytes = bytes;
+  partition->pending_build_rows += num_rows;
+  if (partition->spilled && partition->pending_build_bytes >= kSpillBatchBytes) {
+    PX_RETURN_IF_ERROR(SpillPendingBuild(partition));
+  }
+  return Status::OK();
+}
+
+Status JoinHashTable::AppendPendingProbe(Partition* partition,
+                                         const std::vector<const arrow::Array*>& columns,
+                                         const int64_t* rows, int64_t num_rows) {
+  AppendRows(columns, probe_types_, rows, num_rows, &partition->pending_probe);
+  auto* hash_wrapper = static_cast<types::Int64ValueColumnWrapper*>(
+      partition->pending_probe.back().get());
+  for (int64_t i = 0; i < num_rows; ++i) {
+    hash_wrapper->Append(static_cast<int64_t>(hashes_[rows[i]]));
+  }
+  int64_t bytes = WrappersBytes(partition->pending_probe);
+  memory_used_bytes_ += bytes - partition->pending_probe_bytes;
+  partition->pending_probe_bytes = bytes;
+  partition->pending_probe_rows += num_rows;
+  if (partition->pending_probe_bytes >= kSpillBatchBytes) {
+    PX_RETURN_IF_ERROR(SpillPendingProbe(partition));
+  }
+  return Status::OK();
+}
+
+Status JoinHashTable::MaybeSpill() {
+  if (!SpillEnabled()) {
+    return Status::OK();
+  }
+  while (memory_used_bytes_ > opts_.memory_limit_bytes) {
+    Partition* largest = nullptr;
+    for (auto& partition : partitions_) {
+      if (largest == nullptr || partition.pending_build_bytes > largest->pending_build_bytes) {
+        largest = &partition;
+      }
+    }
+    if (largest->pending_build_bytes == 0) {
+      break;
+    }
+    largest->spilled = true;
+    PX_RETURN_IF_ERROR(SpillPendingBuild(largest));
+  }
+  return Status::OK();
+}
+
+Status JoinHashTable::SpillPendingBuild(Partition* partition) {
+  if (partition->pending_build_rows == 0) {
+    return Status::OK();
+  }
+  PX_ASSIGN_OR_RETURN(auto batch, SpillWrappers(partition->pending_build, &*spill_writer_));
+  bytes_spilled_ += batch.Bytes();
+  partition->spilled_build_bytes += batch.Bytes();
+  partition->spilled_build.push_back(std::move(batch));
+  memory_used_bytes_ -= partition->pending_build_bytes;
+  partition->pending_build = MakeWrappers(build_types_);
+  partition->pending_build_rows = 0;
+  partition->pending_build_bytes = 0;
+  return Status::OK();
+}
+
+Status JoinHashTable::SpillPendingProbe(Partition* partition) {
+  if (partition->pending_probe_rows == 0) {
+    return Status::OK();
+  }
+  PX_ASSIGN_OR_RETURN(auto batch, SpillWrappers(partition->pending_probe, &*spill_writer_));
+  bytes_spilled_ += batch.Bytes();
+  partition->spilled_probe.push_back(std::move(batch));
+  memory_used_bytes_ -= partition->pending_probe_bytes;
+  partition->pending_probe = MakeWrappers(probe_spill_types_);
+  partition->pending_probe_rows = 0;
+  partition->pending_probe_bytes = 0;
+  return Status::OK();
+}
+
+void JoinHashTable::BuildPartitionTable(Partition* partition, bool add_to_bloom) {
+  size_t num_keys = key_types_.size();
+  std::vector<std::shared_ptr<arrow::Array>> key_arrays;
+  std::vector<const arrow::Array*> keys;
+  for (size_t col_idx = 0; col_idx < num_keys; ++col_idx) {
+    key_arrays.push_back(
+        partition->pending_build[col_idx]->ConvertToArrow(arrow::default_memory_pool()));
+    keys.push_back(key_arrays.back().get());
+  }
+  partition->table = GroupHashTable::Create(key_types_);
+  partition->table->FindOrInsert(keys, &key_ids_);
+
+  // Counting sort the rows by key id, so that the rows of each key are contiguous.
+  int64_t num_groups = partition->table->NumGroups();
+  partition->key_starts.assign(num_groups + 1, 0);
+  for (int64_t key : key_ids_) {
+    ++partition->key_starts[key + 1];
+  }
+  for (int64_t key = 0; key < num_groups; ++key) {
+    partition->key_starts[key + 1] += partition->key_starts[key];
+  }
+  std::vector<int64_t> next(partition->key_starts.begin(), partition->key_starts.end() - 1);
+  std::vector<size_t> order(key_ids_.size());
+  for (const auto& [row, key] : Enumerate(key_ids_)) {
+    order[next[key]++] = row;
+  }
+  partition->values.clear();
+  for (size_t col_idx = num_keys; col_idx < build_types_.size(); ++col_idx) {
+    partition->values.push_back(partition->pending_build[col_idx]->CopyIndexes(order));
+  }
+  partition->key_probed.assign(num_groups, false);
+
+  if (add_to_bloom) {
+    HashKeyColumns(keys, key_types_, &hashes_);
+    for (uint64_t hash : hashes_) {
+      bloom_filter_->Insert(hash);
+    }
+    partition->in_bloom = true;
+  }
+
+  partition->values_bytes = WrappersBytes(partition->values);
+  memory_used_bytes_ += partition->values_bytes - partition->pending_build_bytes;
+  partition->pending_build = MakeWrappers(build_types_);
+  partition->pending_build_rows = 0;
+  partition->pending_build_bytes = 0;
+}
+
+Status JoinHashTable::FinishBuild() {
+  DCHECK(!build_finished_);
+  build_finished_ = true;
+  int64_t num_build_rows = 0;
+  for (auto& partition : partitions_) {
+    if (partition.spilled) {
+      PX_RETURN_IF_ERROR(SpillPendingBuild(&partition));
+    } else {
+      num_build_rows += partition.pending_build_rows;
+    }
+  }
+  // Size the filter by the number of rows rather than the number of keys, since the keys aren't
+  // known until the tables are built. This only over-sizes the filter when keys repeat.
+  bloom_filter_ = std::make_unique<JoinBloomFilter>(num_build_rows);
+  for (auto& partition : partitions_) {
+    if (!partition.spilled) {
+      BuildPartitionTable(&partition, /*add_to_bloom*/ true);
+    }
+  }
+  return Status::OK();
+}
+
+Status JoinHashTable::ProbeBatch(const std::vector<const arrow::Array*>& keys, const RowBatch& rb,
+                                 std::vector<ProbeResult>* results) {
+  DCHECK(build_finished_);
+  HashKeyColumns(keys, key_types_, &hashes_);
+  int64_t num_rows = hashes_.size();
+  results->assign(num_rows, ProbeResult{});
+  row_partitions_.resize(num_rows);
+  selected_rows_.clear();
+  deferred_rows_.clear();
+  for (int64_t i = 0; i < num_rows; ++i) {
+    int p = PartitionOf(hashes_[i]);
+    row_partitions_[i] = p;
+    const auto& partition = partitions_[p];
+    if (partition.table == nullptr) {
+      (*results)[i].partition = kDeferred;
+      deferred_rows_.push_back(i);
+    } else if (!partition.in_bloom || bloom_filter_->MayContain(hashes_[i])) {
+      selected_rows_.push_back(i);
+    }
+  }
+
+  if (!deferred_rows_.empty()) {
+    auto columns = Columns(rb, 0, rb.num_columns());
+    PartitionRows(deferred_rows_);
+    for (int p = 0; p < NumPartitions(); ++p) {
+      int64_t start = partition_starts_[p];
+      int64_t num_partition_rows = partition_starts_[p + 1] - start;
+      if (num_partition_rows == 0) {
+        continue;
+      }
+      PX_RETURN_IF_ERROR(AppendPendingProbe(&partitions_[p], columns,
+                                            partition_rows_.data() + start, num_partition_rows));
+    }
+  }
+
+  PartitionRows(selected_rows_);
+  for (int p = 0; p < NumPartitions(); ++p) {
+    if (partition_starts_[p] == partition_starts_[p + 1]) {
+      continue;
+    }
+    auto& partition = partitions_[p];
+    find_rows_.assign(partition_rows_.begin() + partition_starts_[p],
+                      partition_rows_.begin() + partition_starts_[p + 1]);
+    partition.table->Find(keys, find_rows_, &key_ids_);
+    for (const auto& [i, key] : Enumerate(key_ids_)) {
+      if (key == GroupHashTable::kNotFound) {
+        continue;
+      }
+      (*results)[find_rows_[i]] = ProbeResult{p, key};
+      partition.key_probed[key] = true;
+    }
+  }
+  return Status::OK();
+}
+
+Status JoinHashTable::FinishProbe() {
+  for (auto& partition : partitions_) {
+    if (partition.spilled) {
+      PX_RETURN_IF_ERROR(SpillPendingProbe(&partition));
+    }
+  }
+  return Status::OK();
+}
+
+JoinHashTable::BuildRows JoinHashTable::GetBuildRows(int partition, int64_t key) {
+  auto& p = partitions_[partition];
+  return BuildRows{&p.values, p.key_starts[key], p.key_starts[key + 1] - p.key_starts[key]};
+}
+
+std::vector<int64_t> JoinHashTable::UnmatchedKeys(int partition) const {
+  std::vector<int64_t> keys;
+  const auto& key_probed = partitions_[partition].key_probed;
+  for (size_t key = 0; key < key_probed.size(); ++key) {
+    if (!key_probed[key]) {
+      keys.push_back(key);
+    }
+  }
+  return keys;
+}
+
+std::vector<int> JoinHashTable::SpilledPartitions() const {
+  std::vector<int> spilled;
+  for (int p = 0; p < NumPartitions(); ++p) {
+    if (partitions_[p].spilled) {
+      spilled.push_back(p);
+    }
+  }
+  return spilled;
+}
+
+Status JoinHashTable::LoadPartition(int p) {
+  auto& partition = partitions_[p];
+  DCHECK(partition.spilled);
+  DCHECK(partition.table == nullptr);
+  DCHECK_EQ(partition.pending_build_rows, 0);
+  if (memory_used_bytes_ + partition.spilled_build_bytes > opts_.memory_limit_bytes &&
+      partition.mixed_build_hashes && partition.level < kMaxPartitionLevels) {
+    return SplitPartition(p);
+  }
+  for (const auto& batch : partition.spilled_build) {
+    PX_ASSIGN_OR_RETURN(auto rb, ReadSpillBatch(batch, build_types_));
+    AppendRows(Columns(rb, 0, rb.num_columns()), build_types_, nullptr, batch.Length(),
+               &partition.pending_build);
+  }
+  partition.pending_build_bytes = WrappersBytes(partition.pending_build);
+  memory_used_bytes_ += partition.pending_build_bytes;
+  partition.spilled_build.clear();
+  partition.spilled_build_bytes = 0;
+  BuildPartitionTable(&partition, /*add_to_bloom*/ false);
+  return Status::OK();
+}
+
+Status JoinHashTable::SplitPartition(int p) {
+  const int first_child = NumPartitions();
+  const int child_level = partitions_[p].level + 1;
+  for (int i = 0; i < kNumPartitions; ++i) {
+    auto& child = partitions_.emplace_back();
+    child.pending_build = MakeWrappers(build_types_);
+    child.pending_probe = MakeWrappers(probe_spill_types_);
+    child.spilled = true;
+    child.level = child_level;
+  }
+  auto& partition = partitions_[p];
+  partition.first_child = first_child;
+  partition.spilled = false;
+
+  const int64_t num_keys = key_types_.size();
+  for (const auto& batch : partition.spilled_build) {
+    PX_ASSIGN_OR_RETURN(auto rb, ReadSpillBatch(batch, build_types_));
+    HashKeyColumns(Columns(rb, 0, num_keys), key_types_, &hashes_);
+    int64_t num_rows = hashes_.size();
+    row_partitions_.resize(num_rows);
+    selected_rows_.resize(num_rows);
+    for (int64_t i = 0; i < num_rows; ++i) {
+      row_partitions_[i] = first_child + SubPartitionOf(hashes_[i], child_level);
+      AddBuildHash(&partitions_[row_partitions_[i]], hashes_[i]);
+      selected_rows_[i] = i;
+    }
+    PartitionRows(selected_rows_);
+    auto columns = Columns(rb, 0, rb.num_columns());
+    for (int c = first_child; c < first_child + kNumPartitions; ++c) {
+      int64_t start = partition_starts_[c];
+      int64_t num_child_rows = partition_starts_[c + 1] - start;
+      if (num_child_rows > 0) {
+        PX_RETURN_IF_ERROR(AppendPendingBuild(&partitions_[c], columns,
+                                              partition_rows_.data() + start, num_child_rows));
+      }
+    }
+  }
+
+  const int64_t num_probe_cols = probe_types_.size();
+  for (const auto& batch : partition.spilled_probe) {
+    PX_ASSIGN_OR_RETURN(auto rb, ReadSpillBatch(batch, probe_spill_types_));
+    const auto* hash_col = static_cast<const arrow::Int64Array*>(rb.ColumnAt(num_probe_cols).get());
+    int64_t num_rows = rb.num_rows();
+    hashes_.resize(num_rows);
+    row_partitions_.resize(num_rows);
+    selected_rows_.resize(num_rows);
+    for (int64_t i = 0; i < num_rows; ++i) {
+      hashes_[i] = static_cast<uint64_t>(hash_col->Value(i));
+      row_partitions_[i] = first_child + SubPartitionOf(hashes_[i], child_level);
+      selected_rows_[i] = i;
+    }
+    PartitionRows(selected_rows_);
+    auto columns = Columns(rb, 0, num_probe_cols);
+    for (int c = first_child; c < first_child + kNumPartitions; ++c) {
+      int64_t start = partition_starts_[c];
+      int64_t num_child_rows = partition_starts_[c + 1] - start;
+      if (num_child_rows > 0) {
+        PX_RETURN_IF_ERROR(AppendPendingProbe(&partitions_[c], columns,
+                                              partition_rows_.data() + start, num_child_rows));
+      }
+    }
+  }
+
+  for (int c = first_child; c < first_child + kNumPartitions; ++c) {
+    PX_RETURN_IF_ERROR(SpillPendingBuild(&partitions_[c]));
+    PX_RETURN_IF_ERROR(SpillPendingProbe(&partitions_[c]));
+  }
+  partition.spilled_build.clear();
+  partition.spilled_build_bytes = 0;
+  partition.spilled_probe.clear();
+  return Status::OK();
+}
+
+StatusOr<RowBatch> JoinHashTable::ReadDeferredProbeBatch(int p, size_t idx) const {
+  return ReadSpillBatch(partitions_[p].spilled_probe[idx], probe_types_);
+}
+
+void JoinHashTable::ReleasePartition(int p) {
+  auto& partition = partitions_[p];
+  memory_used_bytes_ -= partition.values_bytes;
+  partition.table.reset();
+  partition.values.clear();
+  partition.values_bytes = 0;
+  partition.key_starts.clear();
+  partition.key_probed.clear();
+  partition.spilled_build.clear();
+  partition.spilled_probe.clear();
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
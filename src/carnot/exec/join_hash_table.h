@@ -0,0 +1,314 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/array.h>
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "src/carnot/exec/agg_hash_table.h"
+#include "src/common/base/base.h"
+#include "src/shared/types/column_wrapper.h"
+#include "src/shared/types/types.h"
+#include "src/table_store/schema/row_batch.h"
+#include "src/table_store/table/internal/spill_batch.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * JoinBloomFilter is a register blocked bloom filter over 64-bit key hashes. All of the bits of a
+ * key are set in the same 64-bit word, so a lookup only touches a single cache line.
+ */
+class JoinBloomFilter {
+ public:
+  // Sizes the filter for roughly 16 bits per key.
+  explicit JoinBloomFilter(int64_t num_keys);
+
+  void Insert(uint64_t hash) { words_[WordIndex(hash)] |= BitMask(hash); }
+  bool MayContain(uint64_t hash) const {
+    uint64_t mask = BitMask(hash);
+    return (words_[WordIndex(hash)] & mask) == mask;
+  }
+
+ private:
+  // The low 18 bits of the hash pick the bits within the word, and the bits above them pick the
+  // word.
+  uint64_t WordIndex(uint64_t hash) const { return (hash >> 18) & word_mask_; }
+  static uint64_t BitMask(uint64_t hash) {
+    return (1ULL << (hash & 63)) | (1ULL << ((hash >> 6) & 63)) | (1ULL << ((hash >> 12) & 63));
+  }
+
+  std::vector<uint64_t> words_;
+  uint64_t word_mask_;
+};
+
+/**
+ * JoinHashTable holds the build side of a hash join, and looks up probe rows against it a batch at
+ * a time.
+ *
+ * Build rows are radix partitioned by the top bits of their key hash into kNumPartitions
+ * partitions, so that each partition's hash table is a fraction of the size of the whole build
+ * side, and probes of a batch are grouped by partition. Once the build side is complete, each
+ * partition's rows are reordered by key, so that the build rows of a key are a contiguous range of
+ * the partition's value columns. A bloom filter over the build keys lets probe rows without a
+ * match skip the hash table lookup.
+ *
+ * When a spill directory is set, and the in-memory build rows grow past the memory limit, the
+ * largest in-memory partition is spilled to disk (and the rest of its build rows follow it). Probe
+ * rows of a spilled partition are deferred: they are spilled as well, and joined partition by
+ * partition once the probe side is complete, by loading the partition's build rows back into
+ * memory (see LoadPartition). Deferred rows are therefore joined out of order.
+ *
+ * A spilled partition can still be too large to load, e.g. when the keys are skewed. Such a
+ * partition is split instead, by the next kPartitionBits bits of the key hash, into kNumPartitions
+ * new spilled partitions, up to kMaxPartitionLevels levels deep. Partitions whose build rows all
+ * have the same key hash can't be split, and are loaded whatever their size.
+ *
+ * JoinHashTable is not thread-safe.
+ */
+class JoinHashTable : public NotCopyable {
+ public:
+  static constexpr int kPartitionBits = 4;
+  static constexpr int kNumPartitions = 1 << kPartitionBits;
+  // Split partitions take the bits under the ones of their parent, so the hash bits used for
+  // partitioning stay clear of the low bits that the hash tables and bloom filter use.
+  static constexpr int kMaxPartitionLevels = 4;
+
+  // Values of ProbeResult::partition for probe rows without a build partition.
+  static constexpr int kNoMatch = -1;
+  static constexpr int kDeferred = -2;
+
+  struct Options {
+    // The number of bytes of build rows (and deferred probe rows) to keep in memory, before
+    // partitions are spilled. Only used when spill_dir is set.
+    int64_t memory_limit_bytes = 0;
+    // The directory to spill partitions to. Spilling is disabled when it's empty.
+    std::string spill_dir;
+  };
+
+  struct ProbeResult {
+    // The partition of the matching build rows, or kNoMatch/kDeferred.
+    int partition = kNoMatch;
+    // The key id within the partition.
+    int64_t key = GroupHashTable::kNotFound;
+  };
+
+  // The build rows with a given key: rows [start, start + num_rows) of *values.
+  struct BuildRows {
+    std::vector<types::SharedColumnWrapper>* values = nullptr;
+    int64_t start = 0;
+    int64_t num_rows = 0;
+  };
+
+  /**
+   * @param key_types the types of the join keys.
+   * @param build_value_types the types of the build columns that are stored for the output.
+   * @param probe_types the types of all of the probe input columns (used for deferred rows).
+   * @param opts memory limit and spill options.
+   */
+  JoinHashTable(std::vector<types::DataType> key_types,
+                std::vector<types::DataType> build_value_types,
+                std::vector<types::DataType> probe_types, Options opts);
+
+  /**
+   * Appends a batch of build rows. May spill partitions to disk.
+   */
+  Status AppendBuildBatch(const std::vector<const arrow::Array*>& keys,
+                          const std::vector<const arrow::Array*>& values);
+
+  /**
+   * Builds the hash tables and bloom filter for the in-memory partitions. Must be called once all
+   * build rows have been appended, and before any probes.
+   */
+  Status FinishBuild();
+
+  /**
+   * Looks up the keys of a batch of probe rows, and marks matched keys as probed.
+   * @param keys the probe key columns of rb.
+   * @param rb the probe row batch. Rows that belong to spilled partitions are copied out of it and
+   * deferred.
+   * @param results output, resized to the number of rows in rb.
+   */
+  Status ProbeBatch(const std::vector<const arrow::Array*>& keys,
+                    const table_store::schema::RowBatch& rb, std::vector<ProbeResult>* results);
+
+  /**
+   * Spills any deferred probe rows that are still in memory. Must be called once the probe side is
+   * complete, before the spilled partitions are joined.
+   */
+  Status FinishProbe();
+
+  BuildRows GetBuildRows(int partition, int64_t key);
+
+  /**
+   * Returns the keys of an in-memory partition that weren't matched by any probe row.
+   */
+  std::vector<int64_t> UnmatchedKeys(int partition) const;
+
+  /**
+   * Returns the number of partitions, which grows when spilled partitions are split.
+   */
+  int NumPartitions() const { return static_cast<int>(partitions_.size()); }
+  /**
+   * Returns the partitions that are spilled to disk.
+   */
+  std::vector<int> SpilledPartitions() const;
+  bool IsSpilled(int partition) const { return partitions_[partition].spilled; }
+  /**
+   * Returns whether the partition's hash table is in memory.
+   */
+  bool IsInMemory(int partition) const { return partitions_[partition].table != nullptr; }
+
+  /**
+   * Reads a spilled partition's build rows back into memory and builds its hash table, so that its
+   * deferred probe rows can be joined. If the build rows don't fit in the memory limit and can be
+   * split, the partition's rows are split into new spilled partitions instead, which are appended
+   * after the existing ones, and the partition is left empty (not spilled nor in memory).
+   */
+  Status LoadPartition(int partition);
+  size_t NumDeferredProbeBatches(int partition) const {
+    return partitions_[partition].spilled_probe.size();
+  }
+  /**
+   * Reads a deferred batch of probe rows of a spilled partition. The batch has the columns of the
+   * probe input.
+   */
+  StatusOr<table_store::schema::RowBatch> ReadDeferredProbeBatch(int partition, size_t idx) const;
+  /**
+   * Frees the memory and spilled data of a partition once it has been joined.
+   */
+  void ReleasePartition(int partition);
+
+  int64_t memory_used_bytes() const { return memory_used_bytes_; }
+  int64_t bytes_spilled() const { return bytes_spilled_; }
+
+ private:
+  struct Partition {
+    // Rows that have been appended, but aren't in the hash table (or on disk) yet: the build keys
+    // followed by the build values.
+    std::vector<types::SharedColumnWrapper> pending_build;
+    int64_t pending_build_rows = 0;
+    int64_t pending_build_bytes = 0;
+    // Deferred probe rows that haven't been spilled yet, with all of the probe columns.
+    std::vector<types::SharedColumnWrapper> pending_probe;
+    int64_t pending_probe_rows = 0;
+    int64_t pending_probe_bytes = 0;
+
+    bool spilled = false;
+    std::vector<table_store::internal::SpillBatch> spilled_build;
+    int64_t spilled_build_bytes = 0;
+    // Deferred probe rows are spilled with their key hash as an extra column, so that they can be
+    // split along with the build rows.
+    std::vector<table_store::internal::SpillBatch> spilled_probe;
+
+    // The number of hash bit groups that route rows to the partition, and the first of the
+    // partition's kNumPartitions children once it has been split.
+    int level = 1;
+    int first_child = -1;
+    // The key hash of the first build row, and whether any build row had a different one. A
+    // partition can only be split when they differ.
+    bool has_build_rows = false;
+    uint64_t build_hash = 0;
+    bool mixed_build_hashes = false;
+
+    // Set once the partition's hash table is built.
+    std::unique_ptr<GroupHashTable> table;
+    // The build values, ordered by key id.
+    std::vector<types::SharedColumnWrapper> values;
+    // The build rows of key k are [key_starts[k], key_starts[k + 1]) of values.
+    std::vector<int64_t> key_starts;
+    std::vector<bool> key_probed;
+    int64_t values_bytes = 0;
+    // Whether the partition's keys were added to the bloom filter.
+    bool in_bloom = false;
+  };
+
+  // Returns the index among its siblings of the partition at the given level for a hash.
+  static int SubPartitionOf(uint64_t hash, int level) {
+    return static_cast<int>((hash >> (64 - level * kPartitionBits)) & (kNumPartitions - 1));
+  }
+  // Returns the partition of a hash, following the splits of the partitions.
+  int PartitionOf(uint64_t hash) const;
+  static void AddBuildHash(Partition* partition, uint64_t hash);
+  // Appends the given rows (or every row, if rows is null) of arrays to wrappers.
+  void AppendRows(const std::vector<const arrow::Array*>& arrays,
+                  const std::vector<types::DataType>& data_types, const int64_t* rows,
+                  int64_t num_rows, std::vector<types::SharedColumnWrapper>* wrappers);
+  // Sorts rows by partition into partition_rows_ and partition_starts_.
+  void PartitionRows(const std::vector<int64_t>& rows);
+
+  // Appends the given rows of columns to the pending rows of a partition, spilling them once enough
+  // have accumulated if the partition is spilled. Probe rows get their hash from hashes_.
+  Status AppendPendingBuild(Partition* partition, const std::vector<const arrow::Array*>& columns,
+                            const int64_t* rows, int64_t num_rows);
+  Status AppendPendingProbe(Partition* partition, const std::vector<const arrow::Array*>& columns,
+                            const int64_t* rows, int64_t num_rows);
+  Status SpillPendingBuild(Partition* partition);
+  Status SpillPendingProbe(Partition* partition);
+  // Spills the partitions with the most in-memory build rows until the memory limit is met.
+  Status MaybeSpill();
+  // Splits the spilled rows of a partition into kNumPartitions new spilled partitions.
+  Status SplitPartition(int p);
+  // Builds the hash table of a partition from its pending build rows, and optionally adds its keys
+  // to the bloom filter.
+  void BuildPartitionTable(Partition* partition, bool add_to_bloom);
+
+  bool SpillEnabled() const { return spill_writer_.has_value(); }
+
+  const std::vector<types::DataType> key_types_;
+  const std::vector<types::DataType> build_value_types_;
+  const std::vector<types::DataType> probe_types_;
+  // The probe types followed by the INT64 key hash, as deferred probe rows are spilled.
+  std::vector<types::DataType> probe_spill_types_;
+  // The key types followed by the build value types.
+  std::vector<types::DataType> build_types_;
+  const Options opts_;
+
+  // A deque, so that partitions stay in place when split partitions are appended.
+  std::deque<Partition> partitions_;
+  std::unique_ptr<JoinBloomFilter> bloom_filter_;
+  std::optional<table_store::internal::SpillWriter> spill_writer_;
+  bool build_finished_ = false;
+  int64_t memory_used_bytes_ = 0;
+  int64_t bytes_spilled_ = 0;
+
+  // Scratch space for the current batch.
+  std::vector<uint64_t> hashes_;
+  std::vector<int> row_partitions_;
+  std::vector<int64_t> selected_rows_;
+  std::vector<int64_t> deferred_rows_;
+  // The selected rows ordered by partition. The rows of partition p are
+  // [partition_starts_[p], partition_starts_[p + 1]) of partition_rows_.
+  std::vector<int64_t> partition_rows_;
+  std::vector<int64_t> partition_starts_;
+  std::vector<int64_t> find_rows_;
+  std::vector<int64_t> key_ids_;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
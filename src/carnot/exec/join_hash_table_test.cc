@@ -0,0 +1,225 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/join_hash_table.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/types.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+using table_store::schema::RowDescriptor;
+using ::testing::ElementsAre;
+using ::testing::UnorderedElementsAre;
+
+template <typename TValue>
+std::shared_ptr<arrow::Array> MakeArray(const std::vector<TValue>& values) {
+  return types::ToArrow(values, arrow::default_memory_pool());
+}
+
+// Probe rows are [key:Int, val:Int].
+RowBatch MakeProbeBatch(const std::vector<types::Int64Value>& keys,
+                        const std::vector<types::Int64Value>& values) {
+  RowBatch rb(RowDescriptor({types::INT64, types::INT64}), keys.size());
+  EXPECT_OK(rb.AddColumn(MakeArray(keys)));
+  EXPECT_OK(rb.AddColumn(MakeArray(values)));
+  return rb;
+}
+
+// Returns the build values (a Float64 column) matched by a probe result.
+std::vector<double> BuildValues(JoinHashTable* table, const JoinHashTable::ProbeResult& result) {
+  std::vector<double> values;
+  if (result.partition < 0) {
+    return values;
+  }
+  auto rows = table->GetBuildRows(result.partition, result.key);
+  for (int64_t i = rows.start; i < rows.start + rows.num_rows; ++i) {
+    values.push_back((*rows.values)[0]->Get<types::Float64Value>(i).val);
+  }
+  return values;
+}
+
+using Match = std::pair<int64_t, double>;
+
+// Joins the spilled partitions the way EquijoinNode does, and collects the (probe value, build
+// value) pairs of the deferred probe rows and the unmatched build values.
+void JoinSpilledPartitions(JoinHashTable* table, std::vector<Match>* matches,
+                           std::vector<double>* unmatched) {
+  std::vector<JoinHashTable::ProbeResult> results;
+  for (int p = 0; p < table->NumPartitions(); ++p) {
+    if (!table->IsSpilled(p)) {
+      continue;
+    }
+    ASSERT_OK(table->LoadPartition(p));
+    if (!table->IsInMemory(p)) {
+      continue;
+    }
+    for (size_t i = 0; i < table->NumDeferredProbeBatches(p); ++i) {
+      ASSERT_OK_AND_ASSIGN(auto rb, table->ReadDeferredProbeBatch(p, i));
+      ASSERT_OK(table->ProbeBatch({rb.ColumnAt(0).get()}, rb, &results));
+      for (const auto& [row, result] : Enumerate(results)) {
+        auto probe_val = types::GetValueFromArrowArray<types::INT64>(rb.ColumnAt(1).get(), row);
+        for (double build_val : BuildValues(table, result)) {
+          matches->emplace_back(probe_val.val, build_val);
+        }
+      }
+    }
+    for (int64_t key : table->UnmatchedKeys(p)) {
+      auto matched = BuildValues(table, {p, key});
+      unmatched->insert(unmatched->end(), matched.begin(), matched.end());
+    }
+    table->ReleasePartition(p);
+  }
+}
+
+TEST(JoinBloomFilterTest, no_false_negatives) {
+  JoinBloomFilter filter(1000);
+  for (uint64_t i = 0; i < 1000; ++i) {
+    filter.Insert(i * 0x9e3779b97f4a7c15ULL);
+  }
+  int64_t false_positives = 0;
+  for (uint64_t i = 0; i < 1000; ++i) {
+    EXPECT_TRUE(filter.MayContain(i * 0x9e3779b97f4a7c15ULL));
+    false_positives += filter.MayContain((i + 1000) * 0x9e3779b97f4a7c15ULL);
+  }
+  EXPECT_LT(false_positives, 100);
+}
+
+TEST(JoinHashTableTest, in_memory) {
+  JoinHashTable table({types::INT64}, {types::FLOAT64}, {types::INT64, types::INT64}, {});
+
+  auto keys = MakeArray<types::Int64Value>({1, 2, 1, 3});
+  auto values = MakeArray<types::Float64Value>({1.0, 2.0, 1.1, 3.0});
+  ASSERT_OK(table.AppendBuildBatch({keys.get()}, {values.get()}));
+  ASSERT_OK(table.FinishBuild());
+  EXPECT_TRUE(table.SpilledPartitions().empty());
+
+  auto probe = MakeProbeBatch({1, 4, 3, 1}, {0, 1, 2, 3});
+  std::vector<JoinHashTable::ProbeResult> results;
+  ASSERT_OK(table.ProbeBatch({probe.ColumnAt(0).get()}, probe, &results));
+  ASSERT_EQ(4U, results.size());
+  EXPECT_THAT(BuildValues(&table, results[0]), ElementsAre(1.0, 1.1));
+  EXPECT_EQ(JoinHashTable::kNoMatch, results[1].partition);
+  EXPECT_THAT(BuildValues(&table, results[2]), ElementsAre(3.0));
+  EXPECT_THAT(BuildValues(&table, results[3]), ElementsAre(1.0, 1.1));
+
+  std::vector<double> unmatched;
+  for (int p = 0; p < JoinHashTable::kNumPartitions; ++p) {
+    for (int64_t key : table.UnmatchedKeys(p)) {
+      auto matched = BuildValues(&table, {p, key});
+      unmatched.insert(unmatched.end(), matched.begin(), matched.end());
+    }
+  }
+  EXPECT_THAT(unmatched, ElementsAre(2.0));
+  EXPECT_EQ(0, table.bytes_spilled());
+}
+
+TEST(JoinHashTableTest, spill) {
+  px::testing::TempDir temp_dir;
+  JoinHashTable::Options opts;
+  opts.memory_limit_bytes = 0;
+  opts.spill_dir = temp_dir.path().string();
+  JoinHashTable table({types::INT64}, {types::FLOAT64}, {types::INT64, types::INT64}, opts);
+
+  auto keys = MakeArray<types::Int64Value>({1, 2, 1, 3});
+  auto values = MakeArray<types::Float64Value>({1.0, 2.0, 1.1, 3.0});
+  ASSERT_OK(table.AppendBuildBatch({keys.get()}, {values.get()}));
+  ASSERT_OK(table.FinishBuild());
+  EXPECT_GT(table.bytes_spilled(), 0);
+
+  // Every partition with build rows is spilled, so all of the rows with a matching partition are
+  // deferred.
+  auto probe = MakeProbeBatch({1, 4, 3, 1}, {0, 1, 2, 3});
+  std::vector<JoinHashTable::ProbeResult> results;
+  ASSERT_OK(table.ProbeBatch({probe.ColumnAt(0).get()}, probe, &results));
+  ASSERT_EQ(4U, results.size());
+  EXPECT_EQ(JoinHashTable::kDeferred, results[0].partition);
+  EXPECT_EQ(JoinHashTable::kDeferred, results[2].partition);
+  EXPECT_EQ(JoinHashTable::kDeferred, results[3].partition);
+  ASSERT_OK(table.FinishProbe());
+
+  std::vector<Match> matches;
+  std::vector<double> unmatched;
+  JoinSpilledPartitions(&table, &matches, &unmatched);
+  EXPECT_THAT(matches, UnorderedElementsAre(Match{0, 1.0}, Match{0, 1.1}, Match{2, 3.0},
+                                            Match{3, 1.0}, Match{3, 1.1}));
+  EXPECT_THAT(unmatched, ElementsAre(2.0));
+}
+
+TEST(JoinHashTableTest, splits_skewed_partitions) {
+  px::testing::TempDir temp_dir;
+  JoinHashTable::Options opts;
+  opts.memory_limit_bytes = 0;
+  opts.spill_dir = temp_dir.path().string();
+  JoinHashTable table({types::INT64}, {types::FLOAT64}, {types::INT64, types::INT64}, opts);
+
+  // Key 0 is on most of the build rows, and keys [1, kNumKeys] are on one row each.
+  constexpr int64_t kNumHotRows = 4096;
+  constexpr int64_t kNumKeys = 256;
+  std::vector<types::Int64Value> build_keys(kNumHotRows, 0);
+  std::vector<types::Float64Value> build_values(kNumHotRows, 0.0);
+  std::vector<types::Int64Value> probe_keys;
+  for (int64_t key = 1; key <= kNumKeys; ++key) {
+    build_keys.push_back(key);
+    build_values.push_back(static_cast<double>(key));
+  }
+  for (int64_t key = 0; key <= kNumKeys + 1; ++key) {
+    probe_keys.push_back(key);
+  }
+  auto keys = MakeArray(build_keys);
+  auto values = MakeArray(build_values);
+  ASSERT_OK(table.AppendBuildBatch({keys.get()}, {values.get()}));
+  ASSERT_OK(table.FinishBuild());
+
+  // Probe each key once, with the key as the probe value.
+  auto probe = MakeProbeBatch(probe_keys, probe_keys);
+  std::vector<JoinHashTable::ProbeResult> results;
+  ASSERT_OK(table.ProbeBatch({probe.ColumnAt(0).get()}, probe, &results));
+  ASSERT_OK(table.FinishProbe());
+
+  std::vector<Match> matches;
+  std::vector<double> unmatched;
+  JoinSpilledPartitions(&table, &matches, &unmatched);
+
+  // Nothing fits in memory, so the partitions with more than one key were split, while the rows of
+  // key 0 stayed together.
+  EXPECT_GT(table.NumPartitions(), JoinHashTable::kNumPartitions);
+  EXPECT_EQ(static_cast<size_t>(kNumHotRows + kNumKeys), matches.size());
+  for (const auto& [probe_val, build_val] : matches) {
+    EXPECT_EQ(static_cast<double>(probe_val), build_val);
+  }
+  EXPECT_EQ(kNumHotRows, std::count_if(matches.begin(), matches.end(),
+                                       [](const Match& m) { return m.first == 0; }));
+  EXPECT_TRUE(unmatched.empty());
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -193,6 +193,37 @@ TEST_F(LimitNodeTest, limits_records_split) {
       .Close();
 }
 
+TEST_F(LimitNodeTest, limits_records_split_with_selection) {
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64});
+  RowDescriptor output_rd({types::DataType::INT64, types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<LimitNode, plan::LimitOperator>(*plan_node_, output_rd,
+                                                                     {input_rd}, exec_state_.get());
+  auto rb1 = RowBatchBuilder(input_rd, 6, /*eow*/ false, /*eos*/ false)
+                 .AddColumn<types::Int64Value>({1, 2, 3, 4, 5, 6})
+                 .AddColumn<types::Int64Value>({1, 3, 6, 9, 12, 15})
+                 .get();
+  rb1.set_selection(std::make_shared<const std::vector<int64_t>>(std::vector<int64_t>{1, 3, 5}));
+  auto rb2 = RowBatchBuilder(input_rd, 8, true, true)
+                 .AddColumn<types::Int64Value>({1, 2, 3, 4, 5, 6, 7, 8})
+                 .AddColumn<types::Int64Value>({1, 4, 6, 8, 10, 12, 14, 16})
+                 .get();
+  rb2.set_selection(
+      std::make_shared<const std::vector<int64_t>>(std::vector<int64_t>{0, 1, 2, 3, 4, 6, 7}));
+  tester.ConsumeNext(rb1, 0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 3, false, false)
+                          .AddColumn<types::Int64Value>({2, 4, 6})
+                          .AddColumn<types::Int64Value>({3, 9, 15})
+                          .get())
+      .ConsumeNext(rb2, 0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 7, true, true)
+                          .AddColumn<types::Int64Value>({1, 2, 3, 4, 5, 7, 8})
+                          .AddColumn<types::Int64Value>({1, 4, 6, 8, 10, 14, 16})
+                          .get(),
+                      0)
+      .Close();
+}
+
 TEST_F(LimitNodeTest, limits_exact_boundary) {
   RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64});
   RowDescriptor output_rd({types::DataType::INT64, types::DataType::INT64});
@@ -20,7 +20,9 @@
 #include "src/table_store/table/table.h"
 
 #include <limits>
+#include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <absl/strings/substitute.h>
@@ -34,6 +36,70 @@ namespace exec {
 
 using StartSpec = Table::Cursor::StartSpec;
 using StopSpec = Table::Cursor::StopSpec;
+using ColumnPredicate = Table::ColumnPredicate;
+
+namespace {
+
+// Converts the predicate to the table store's representation. Returns std::nullopt for predicates
+// that the table store can't use, which is always safe since predicates are only used to skip
+// batches.
+std::optional<ColumnPredicate> ColumnPredicateFromProto(const planpb::ColumnPredicate& pb) {
+  ColumnPredicate predicate;
+  predicate.col_idx = pb.column_idx();
+  switch (pb.op()) {
+    case planpb::ColumnPredicate::EQUAL:
+      predicate.op = ColumnPredicate::Op::kEqual;
+      break;
+    case planpb::ColumnPredicate::NOT_EQUAL:
+      predicate.op = ColumnPredicate::Op::kNotEqual;
+      break;
+    case planpb::ColumnPredicate::LESS_THAN:
+      predicate.op = ColumnPredicate::Op::kLessThan;
+      break;
+    case planpb::ColumnPredicate::LESS_THAN_EQUAL:
+      predicate.op = ColumnPredicate::Op::kLessThanEqual;
+      break;
+    case planpb::ColumnPredicate::GREATER_THAN:
+      predicate.op = ColumnPredicate::Op::kGreaterThan;
+      break;
+    case planpb::ColumnPredicate::GREATER_THAN_EQUAL:
+      predicate.op = ColumnPredicate::Op::kGreaterThanEqual;
+      break;
+    default:
+      return std::nullopt;
+  }
+  const auto& value = pb.value();
+  switch (value.value_case()) {
+    case planpb::ScalarValue::kBoolValue:
+      predicate.value = value.bool_value();
+      break;
+    case planpb::ScalarValue::kInt64Value:
+      predicate.value = value.int64_value();
+      break;
+    case planpb::ScalarValue::kTime64NsValue:
+      predicate.value = value.time64_ns_value();
+      break;
+    case planpb::ScalarValue::kFloat64Value:
+      predicate.value = value.float64_value();
+      break;
+    case planpb::ScalarValue::kStringValue:
+      predicate.value = value.string_value();
+      break;
+    default:
+      return std::nullopt;
+  }
+  return predicate;
+}
+
+}  // namespace
+
+StatusOr<std::unique_ptr<RowBatch>> MorselQueue::Next(const std::vector<int64_t>& cols) {
+  std::lock_guard<std::mutex> lock(mu_);
+  if (!cursor_->NextBatchReady()) {
+    return std::unique_ptr<RowBatch>();
+  }
+  return cursor_->GetNextRowBatch(cols);
+}
 
 std::string MemorySourceNode::DebugStringImpl() {
   return absl::Substitute("Exec::MemorySourceNode: <name: $0, output: $1>", plan_node_->TableName(),
@@ -85,7 +151,14 @@ Status MemorySourceNode::OpenImpl(ExecState* exec_state) {
       stop_spec.type = StopSpec::StopType::CurrentEndOfTable;
     }
   }
-  cursor_ = std::make_unique<Table::Cursor>(table_, start_spec, stop_spec);
+  std::vector<ColumnPredicate> predicates;
+  for (const auto& predicate_pb : plan_node_->predicates()) {
+    auto predicate = ColumnPredicateFromProto(predicate_pb);
+    if (predicate.has_value()) {
+      predicates.push_back(std::move(predicate.value()));
+    }
+  }
+  cursor_ = std::make_unique<Table::Cursor>(table_, start_spec, stop_spec, std::move(predicates));
 
   return Status::OK();
 }
@@ -95,9 +168,32 @@ Status MemorySourceNode::CloseImpl(ExecState*) {
   return Status::OK();
 }
 
+std::shared_ptr<MorselQueue> MemorySourceNode::ShareCursor() {
+  DCHECK(!streaming_);
+  DCHECK(cursor_ != nullptr);
+  morsels_ = std::make_shared<MorselQueue>(std::move(cursor_));
+  return morsels_;
+}
+
+void MemorySourceNode::SetMorselQueue(std::shared_ptr<MorselQueue> morsels) {
+  DCHECK(!streaming_);
+  cursor_.reset();
+  morsels_ = std::move(morsels);
+}
+
 StatusOr<std::unique_ptr<RowBatch>> MemorySourceNode::GetNextRowBatch(ExecState*) {
   DCHECK(table_ != nullptr);
 
+  if (morsels_ != nullptr) {
+    PX_ASSIGN_OR_RETURN(auto row_batch, morsels_->Next(plan_node_->Columns()));
+    if (row_batch == nullptr) {
+      return RowBatch::WithZeroRows(*output_descriptor_, /* eow */ true, /* eos */ true);
+    }
+    rows_processed_ += row_batch->num_rows();
+    bytes_processed_ += row_batch->NumBytes();
+    return row_batch;
+  }
+
   if (!cursor_->NextBatchReady()) {
     // If the NextBatch is not ready, but the cursor is not yet exhausted, then we need to output
     // 0-row row batches, while we wait for more data to be added. This currently only occurs in the
@@ -20,6 +20,7 @@
 
 #include <stdint.h>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -39,6 +40,25 @@ namespace exec {
 using table_store::Table;
 using table_store::schema::RowBatch;
 
+/**
+ * MorselQueue hands out the batches of a table cursor one at a time, so that the copies of a
+ * MemorySourceNode in a parallel pipeline can split a scan between them. Each batch (morsel) is
+ * processed by whichever worker takes it.
+ */
+class MorselQueue : public NotCopyable {
+ public:
+  explicit MorselQueue(std::unique_ptr<Table::Cursor> cursor) : cursor_(std::move(cursor)) {}
+
+  /**
+   * Returns the next batch of the given columns, or nullptr once the cursor is exhausted.
+   */
+  StatusOr<std::unique_ptr<RowBatch>> Next(const std::vector<int64_t>& cols);
+
+ private:
+  std::mutex mu_;
+  std::unique_ptr<Table::Cursor> cursor_;
+};
+
 class MemorySourceNode : public SourceNode {
  public:
   MemorySourceNode() = default;
@@ -46,6 +66,17 @@ class MemorySourceNode : public SourceNode {
 
   bool NextBatchReady() override;
 
+  /**
+   * Hands this node's cursor over to a MorselQueue, which can be shared with other copies of this
+   * node (see SetMorselQueue). Must be called after Open, on a non-streaming source.
+   */
+  std::shared_ptr<MorselQueue> ShareCursor();
+  /**
+   * Makes this node read its batches from a shared MorselQueue, rather than its own cursor. The
+   * node sends eos once the queue is empty.
+   */
+  void SetMorselQueue(std::shared_ptr<MorselQueue> morsels);
+
  protected:
   std::string DebugStringImpl() override;
   Status InitImpl(const plan::Operator& plan_node) override;
@@ -61,6 +92,8 @@ class MemorySourceNode : public SourceNode {
   bool streaming_ = false;
 
   std::unique_ptr<Table::Cursor> cursor_;
+  // Set when the node is one of the workers of a parallel pipeline.
+  std::shared_ptr<MorselQueue> morsels_;
 
   std::unique_ptr<plan::MemorySourceOperator> plan_node_;
   table_store::Table* table_ = nullptr;
@@ -19,7 +19,9 @@
 #include "src/carnot/exec/memory_source_node.h"
 
 #include <arrow/memory_pool.h>
+#include <algorithm>
 #include <memory>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -225,6 +227,97 @@ TEST_F(MemorySourceNodeTest, all_range) {
   tester.Close();
 }
 
+class MorselQueueTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    table_store::schema::Relation rel({types::DataType::TIME64NS}, {"time_"});
+    table_ = Table::Create("morsels", rel);
+    for (int64_t i = 0; i < kNumBatches; ++i) {
+      auto rb = RowBatch(RowDescriptor(rel.col_types()), 1);
+      std::vector<types::Time64NSValue> times = {i};
+      EXPECT_OK(rb.AddColumn(types::ToArrow(times, arrow::default_memory_pool())));
+      EXPECT_OK(table_->WriteRowBatch(rb));
+    }
+  }
+
+  // Returns the time of the single row of each batch that `morsels` hands out to one consumer.
+  static std::vector<int64_t> Consume(MorselQueue* morsels) {
+    std::vector<int64_t> times;
+    while (true) {
+      auto rb_or_s = morsels->Next({0});
+      EXPECT_OK(rb_or_s);
+      auto rb = rb_or_s.ConsumeValueOrDie();
+      if (rb == nullptr) {
+        return times;
+      }
+      EXPECT_EQ(1, rb->num_rows());
+      times.push_back(types::GetValueFromArrowArray<types::TIME64NS>(rb->ColumnAt(0).get(), 0));
+    }
+  }
+
+  static constexpr int64_t kNumBatches = 64;
+  std::shared_ptr<Table> table_;
+};
+
+TEST_F(MorselQueueTest, hands_out_batches_in_order) {
+  MorselQueue morsels(std::make_unique<Table::Cursor>(table_.get()));
+  auto times = Consume(&morsels);
+  ASSERT_EQ(kNumBatches, times.size());
+  for (int64_t i = 0; i < kNumBatches; ++i) {
+    EXPECT_EQ(i, times[i]);
+  }
+  // An exhausted queue keeps returning nullptr.
+  ASSERT_OK_AND_ASSIGN(auto rb, morsels.Next({0}));
+  EXPECT_EQ(nullptr, rb);
+}
+
+TEST_F(MorselQueueTest, splits_batches_between_consumers) {
+  MorselQueue morsels(std::make_unique<Table::Cursor>(table_.get()));
+  std::vector<int64_t> first;
+  std::vector<int64_t> second;
+  for (int64_t i = 0; i < kNumBatches; ++i) {
+    ASSERT_OK_AND_ASSIGN(auto rb, morsels.Next({0}));
+    ASSERT_NE(nullptr, rb);
+    auto time = types::GetValueFromArrowArray<types::TIME64NS>(rb->ColumnAt(0).get(), 0);
+    (i % 2 == 0 ? first : second).push_back(time);
+  }
+  ASSERT_OK_AND_ASSIGN(auto rb, morsels.Next({0}));
+  EXPECT_EQ(nullptr, rb);
+
+  // Each batch goes to exactly one consumer, and each consumer sees its batches in table order.
+  ASSERT_EQ(kNumBatches / 2, first.size());
+  ASSERT_EQ(kNumBatches / 2, second.size());
+  for (int64_t i = 0; i < kNumBatches / 2; ++i) {
+    EXPECT_EQ(2 * i, first[i]);
+    EXPECT_EQ(2 * i + 1, second[i]);
+  }
+}
+
+TEST_F(MorselQueueTest, concurrent_consumers) {
+  constexpr int kNumConsumers = 4;
+  MorselQueue morsels(std::make_unique<Table::Cursor>(table_.get()));
+  std::vector<std::vector<int64_t>> consumed(kNumConsumers);
+  std::vector<std::thread> threads;
+  for (int c = 0; c < kNumConsumers; ++c) {
+    threads.emplace_back([&, c] { consumed[c] = Consume(&morsels); });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  std::vector<int64_t> all;
+  for (const auto& times : consumed) {
+    // Batches are taken from the front of the cursor, so each consumer sees increasing times.
+    EXPECT_TRUE(std::is_sorted(times.begin(), times.end()));
+    all.insert(all.end(), times.begin(), times.end());
+  }
+  std::sort(all.begin(), all.end());
+  ASSERT_EQ(kNumBatches, all.size());
+  for (int64_t i = 0; i < kNumBatches; ++i) {
+    EXPECT_EQ(i, all[i]);
+  }
+}
+
 class MemorySourceNodeTabletTest : public ::testing::Test {
  protected:
   void SetUp() override {
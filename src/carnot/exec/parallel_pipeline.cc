@@ -0,0 +1,254 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/parallel_pipeline.h"
+
+#include <string>
+#include <thread>
+#include <utility>
+
+#include <absl/strings/substitute.h>
+
+#include "src/carnot/exec/agg_node.h"
+#include "src/carnot/exec/filter_node.h"
+#include "src/carnot/exec/map_node.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+using table_store::schema::RowDescriptor;
+
+/**
+ * PartialAggCollectorNode stores the partial aggregates emitted by a worker's aggregate, until
+ * they can be merged on the main thread.
+ */
+class PartialAggCollectorNode : public SinkNode {
+ public:
+  const std::vector<RowBatch>& batches() const { return batches_; }
+
+ protected:
+  std::string DebugStringImpl() override { return "Exec::PartialAggCollectorNode"; }
+  Status InitImpl(const plan::Operator&) override { return Status::OK(); }
+  Status PrepareImpl(ExecState*) override { return Status::OK(); }
+  Status OpenImpl(ExecState*) override { return Status::OK(); }
+  Status CloseImpl(ExecState*) override {
+    batches_.clear();
+    return Status::OK();
+  }
+  Status ConsumeNextImpl(ExecState*, const RowBatch& rb, size_t) override {
+    batches_.push_back(rb);
+    return Status::OK();
+  }
+
+ private:
+  std::vector<RowBatch> batches_;
+};
+
+bool ParallelPipeline::CanParallelize(const plan::AggregateOperator& agg, ExecState* exec_state) {
+  if (agg.windowed() || !agg.partial_agg()) {
+    return false;
+  }
+  for (const auto& value : agg.values()) {
+    auto def = exec_state->GetUDADefinition(value->uda_id());
+    if (def == nullptr || !def->supports_partial()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+StatusOr<std::unique_ptr<plan::AggregateOperator>> ParallelPipeline::MergeOperator(
+    const plan::AggregateOperator& agg) {
+  planpb::AggregateOperator pb = agg.pb();
+  pb.set_partial_agg(false);
+  // The partial aggregates start with the group columns.
+  for (int idx = 0; idx < pb.groups_size(); ++idx) {
+    pb.mutable_groups(idx)->set_index(idx);
+  }
+  auto op = std::make_unique<plan::AggregateOperator>(agg.id());
+  PX_RETURN_IF_ERROR(op->Init(pb));
+  return op;
+}
+
+RowDescriptor ParallelPipeline::PartialDescriptor(const plan::AggregateOperator& agg,
+                                                  const RowDescriptor& agg_input) {
+  std::vector<types::DataType> types;
+  for (const auto& group : agg.groups()) {
+    types.push_back(agg_input.type(group.idx));
+  }
+  types.insert(types.end(), agg.values().size(), types::STRING);
+  return RowDescriptor(types);
+}
+
+Status ParallelPipeline::Init(const plan::MemorySourceOperator& source,
+                              const RowDescriptor& source_descriptor,
+                              const std::vector<Stage>& stages, const plan::AggregateOperator& agg,
+                              ExecNode* merge_node) {
+  merge_node_ = merge_node;
+
+  planpb::AggregateOperator partial_pb = agg.pb();
+  partial_pb.set_finalize_results(false);
+  plan::AggregateOperator partial_agg(agg.id());
+  PX_RETURN_IF_ERROR(partial_agg.Init(partial_pb));
+
+  for (int64_t worker = 0; worker < num_workers_; ++worker) {
+    auto source_node = std::make_unique<MemorySourceNode>();
+    PX_RETURN_IF_ERROR(source_node->Init(source, source_descriptor, {}));
+    sources_.push_back(source_node.get());
+    ExecNode* parent = source_node.get();
+    RowDescriptor parent_descriptor = source_descriptor;
+    nodes_.push_back(std::move(source_node));
+
+    for (const auto& stage : stages) {
+      std::unique_ptr<ExecNode> node;
+      switch (stage.op->op_type()) {
+        case planpb::MAP_OPERATOR:
+          node = std::make_unique<MapNode>();
+          break;
+        case planpb::FILTER_OPERATOR:
+          node = std::make_unique<FilterNode>();
+          break;
+        default:
+          return error::InvalidArgument("Operator $0 can't be run in a parallel pipeline",
+                                        static_cast<int>(stage.op->op_type()));
+      }
+      PX_RETURN_IF_ERROR(node->Init(*stage.op, stage.output_descriptor, {parent_descriptor}));
+      parent->AddChild(node.get(), 0);
+      parent = node.get();
+      parent_descriptor = stage.output_descriptor;
+      nodes_.push_back(std::move(node));
+    }
+
+    auto partial_descriptor = PartialDescriptor(agg, parent_descriptor);
+    auto agg_node = std::make_unique<AggNode>();
+    PX_RETURN_IF_ERROR(agg_node->Init(partial_agg, partial_descriptor, {parent_descriptor}));
+    parent->AddChild(agg_node.get(), 0);
+
+    auto collector = std::make_unique<PartialAggCollectorNode>();
+    PX_RETURN_IF_ERROR(collector->Init(partial_agg, partial_descriptor, {partial_descriptor}));
+    agg_node->AddChild(collector.get(), 0);
+    collectors_.push_back(collector.get());
+    nodes_.push_back(std::move(agg_node));
+    nodes_.push_back(std::move(collector));
+  }
+  return Status::OK();
+}
+
+Status ParallelPipeline::Prepare(ExecState* exec_state) {
+  for (const auto& node : nodes_) {
+    PX_RETURN_IF_ERROR(node->Prepare(exec_state));
+  }
+  return Status::OK();
+}
+
+Status ParallelPipeline::Open(ExecState* exec_state) {
+  for (const auto& node : nodes_) {
+    PX_RETURN_IF_ERROR(node->Open(exec_state));
+  }
+  // Every worker scans the same table, so share the first worker's cursor between all of them.
+  auto morsels = sources_[0]->ShareCursor();
+  for (size_t worker = 1; worker < sources_.size(); ++worker) {
+    sources_[worker]->SetMorselQueue(morsels);
+  }
+  return Status::OK();
+}
+
+Status ParallelPipeline::Close(ExecState* exec_state) {
+  Status status = Status::OK();
+  for (const auto& node : nodes_) {
+    auto s = node->Close(exec_state);
+    if (!s.ok()) {
+      status = s;
+    }
+  }
+  return status;
+}
+
+Status ParallelPipeline::RunWorker(ExecState* exec_state, int64_t worker) {
+  auto* source = sources_[worker];
+  while (source->HasBatchesRemaining()) {
+    if (cancelled_) {
+      return error::Cancelled("Parallel pipeline was cancelled");
+    }
+    auto s = source->GenerateNext(exec_state);
+    if (!s.ok()) {
+      cancelled_ = true;
+      return s;
+    }
+  }
+  return Status::OK();
+}
+
+Status ParallelPipeline::Run(ExecState* exec_state) {
+  std::vector<Status> statuses(num_workers_);
+  std::vector<std::thread> workers;
+  workers.reserve(num_workers_);
+  for (int64_t worker = 0; worker < num_workers_; ++worker) {
+    workers.emplace_back([this, exec_state, worker, &statuses] {
+      statuses[worker] = RunWorker(exec_state, worker);
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  // Return the error that caused the cancellation, rather than a cancelled status.
+  for (const auto& s : statuses) {
+    if (!s.ok() && !error::IsCancelled(s)) {
+      return s;
+    }
+  }
+  for (const auto& s : statuses) {
+    PX_RETURN_IF_ERROR(s);
+  }
+
+  // Each worker's aggregate ends its output with eos, so only pass the last eos on to the merge
+  // node.
+  std::vector<RowBatch> partials;
+  for (const auto* collector : collectors_) {
+    partials.insert(partials.end(), collector->batches().begin(), collector->batches().end());
+  }
+  for (size_t i = 0; i < partials.size(); ++i) {
+    bool last = i + 1 == partials.size();
+    partials[i].set_eow(last);
+    partials[i].set_eos(last);
+    PX_RETURN_IF_ERROR(merge_node_->ConsumeNext(exec_state, partials[i], 0));
+  }
+  return Status::OK();
+}
+
+int64_t ParallelPipeline::BytesProcessed() const {
+  int64_t bytes = 0;
+  for (const auto* source : sources_) {
+    bytes += source->BytesProcessed();
+  }
+  return bytes;
+}
+
+int64_t ParallelPipeline::RowsProcessed() const {
+  int64_t rows = 0;
+  for (const auto* source : sources_) {
+    rows += source->RowsProcessed();
+  }
+  return rows;
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
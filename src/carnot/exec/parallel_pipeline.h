@@ -0,0 +1,119 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "src/carnot/exec/exec_node.h"
+#include "src/carnot/exec/exec_state.h"
+#include "src/carnot/exec/memory_source_node.h"
+#include "src/carnot/plan/operators.h"
+#include "src/common/base/base.h"
+#include "src/table_store/schema/row_batch.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+class PartialAggCollectorNode;
+
+/**
+ * ParallelPipeline runs a pipeline from a memory source, through maps and filters, to a blocking
+ * aggregate, on several threads at once (morsel-driven parallelism).
+ *
+ * Each worker thread runs its own copy of the pipeline's nodes, so no exec node is shared between
+ * threads. The workers' memory sources take the table's batches (morsels) from a shared
+ * MorselQueue, and the workers' aggregates emit their serialized partial aggregates instead of
+ * final results. Once every worker is done, the partial aggregates are fed to the merge node (an
+ * aggregate that deserializes and merges them), which takes the original aggregate's place in the
+ * execution graph.
+ */
+class ParallelPipeline : public NotCopyable {
+ public:
+  // A map or filter between the source and the aggregate.
+  struct Stage {
+    const plan::Operator* op;
+    table_store::schema::RowDescriptor output_descriptor;
+  };
+
+  explicit ParallelPipeline(int64_t num_workers) : num_workers_(num_workers) {}
+
+  /**
+   * Returns whether the aggregate can be split into partial aggregates that are merged later.
+   */
+  static bool CanParallelize(const plan::AggregateOperator& agg, ExecState* exec_state);
+
+  /**
+   * Creates the workers' copies of the pipeline.
+   * @param source the memory source of the pipeline.
+   * @param source_descriptor the output descriptor of the source.
+   * @param stages the maps and filters from the source to the aggregate, in order.
+   * @param agg the aggregate at the end of the pipeline. It must do its own partial aggregation.
+   * @param merge_node the node the partial aggregates are sent to, created by the caller with
+   * MergeOperator and PartialDescriptor.
+   */
+  Status Init(const plan::MemorySourceOperator& source,
+              const table_store::schema::RowDescriptor& source_descriptor,
+              const std::vector<Stage>& stages, const plan::AggregateOperator& agg,
+              ExecNode* merge_node);
+
+  /**
+   * Returns the plan of an aggregate that merges the partial aggregates of agg.
+   */
+  static StatusOr<std::unique_ptr<plan::AggregateOperator>> MergeOperator(
+      const plan::AggregateOperator& agg);
+  /**
+   * Returns the descriptor of the partial aggregates of agg: the group columns followed by one
+   * serialized (string) column per value.
+   */
+  static table_store::schema::RowDescriptor PartialDescriptor(
+      const plan::AggregateOperator& agg, const table_store::schema::RowDescriptor& agg_input);
+
+  Status Prepare(ExecState* exec_state);
+  Status Open(ExecState* exec_state);
+  Status Close(ExecState* exec_state);
+
+  /**
+   * Runs the workers to completion, and then sends their partial aggregates to the merge node.
+   */
+  Status Run(ExecState* exec_state);
+
+  int64_t BytesProcessed() const;
+  int64_t RowsProcessed() const;
+
+ private:
+  Status RunWorker(ExecState* exec_state, int64_t worker);
+
+  const int64_t num_workers_;
+  ExecNode* merge_node_ = nullptr;
+
+  // All of the workers' nodes, in pipeline order for each worker.
+  std::vector<std::unique_ptr<ExecNode>> nodes_;
+  std::vector<MemorySourceNode*> sources_;
+  std::vector<PartialAggCollectorNode*> collectors_;
+  // Set when a worker fails, so that the other workers stop early.
+  std::atomic<bool> cancelled_ = false;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,246 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/sort_node.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <absl/strings/substitute.h>
+
+#include "src/carnot/planpb/plan.pb.h"
+
+DEFINE_int64(carnot_sort_memory_limit_bytes,
+             gflags::Int64FromEnv("PL_CARNOT_SORT_MEMORY_LIMIT_BYTES", 256 * 1024 * 1024),
+             "The number of bytes of input a sort keeps in memory before it spills a sorted run "
+             "to disk. Only used when --carnot_sort_spill_dir is set.");
+DEFINE_string(carnot_sort_spill_dir, gflags::StringFromEnv("PL_CARNOT_SORT_SPILL_DIR", ""),
+              "The directory sorts spill sorted runs to when they go over their memory limit. "
+              "Spilling is disabled when this is empty.");
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::internal::ColdBatch;
+using table_store::schema::RowBatch;
+using table_store::schema::RowDescriptor;
+
+namespace {
+
+constexpr uint64_t kMaxSpillFileSize = 64 * 1024 * 1024;
+// Sorted runs are written out in batches of about this size.
+constexpr int64_t kSpillBatchBytes = 4 * 1024 * 1024;
+
+std::vector<int64_t> AllColumns(size_t num_cols) {
+  std::vector<int64_t> cols(num_cols);
+  for (size_t i = 0; i < num_cols; ++i) {
+    cols[i] = i;
+  }
+  return cols;
+}
+
+}  // namespace
+
+std::string SortNode::DebugStringImpl() {
+  return absl::Substitute("Exec::SortNode<$0>", plan_node_->DebugString());
+}
+
+Status SortNode::InitImpl(const plan::Operator& plan_node) {
+  CHECK(plan_node.op_type() == planpb::OperatorType::SORT_OPERATOR);
+  const auto* sort_plan_node = static_cast<const plan::SortOperator*>(&plan_node);
+  plan_node_ = std::make_unique<plan::SortOperator>(*sort_plan_node);
+  if (input_descriptors_.size() != 1) {
+    return error::InvalidArgument("SortNode expects a single input, got $0",
+                                  input_descriptors_.size());
+  }
+  comparator_ = std::make_unique<RowComparator>(plan_node_->keys(), input_descriptors_[0]);
+
+  if (!options_set_) {
+    opts_.memory_limit_bytes = FLAGS_carnot_sort_memory_limit_bytes;
+    opts_.spill_dir = FLAGS_carnot_sort_spill_dir;
+  }
+  if (!opts_.spill_dir.empty()) {
+    spill_writer_.emplace(opts_.spill_dir, "sort", kMaxSpillFileSize);
+  }
+  return Status::OK();
+}
+
+Status SortNode::PrepareImpl(ExecState*) { return Status::OK(); }
+
+Status SortNode::OpenImpl(ExecState*) { return Status::OK(); }
+
+Status SortNode::CloseImpl(ExecState*) {
+  if (bytes_spilled_ > 0) {
+    stats()->AddExtraMetric("bytes_spilled", bytes_spilled_);
+  }
+  batches_.clear();
+  runs_.clear();
+  held_bytes_ = 0;
+  return Status::OK();
+}
+
+Status SortNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_t) {
+  if (rb.num_rows() > 0) {
+    batches_.emplace_back(rb, *comparator_);
+    held_bytes_ += rb.NumBytes();
+    if (spill_writer_.has_value() && held_bytes_ > opts_.memory_limit_bytes) {
+      PX_RETURN_IF_ERROR(SpillRun());
+    }
+  }
+
+  if (!rb.eow() && !rb.eos()) {
+    return Status::OK();
+  }
+  if (runs_.empty()) {
+    return SendHeldRows(exec_state, rb.eos());
+  }
+  if (!batches_.empty()) {
+    PX_RETURN_IF_ERROR(SpillRun());
+  }
+  return MergeRuns(exec_state, rb.eos());
+}
+
+std::vector<SortNode::RowRef> SortNode::SortHeldRows() const {
+  std::vector<RowRef> refs;
+  for (size_t b = 0; b < batches_.size(); ++b) {
+    for (int64_t row = 0; row < batches_[b].rb.num_rows(); ++row) {
+      refs.push_back({static_cast<int64_t>(b), row});
+    }
+  }
+  // The rows start out in input order, so a stable sort keeps the input order of equal rows.
+  std::stable_sort(refs.begin(), refs.end(), [this](const RowRef& a, const RowRef& b) {
+    return comparator_->Compare(batches_[a.batch].keys.data(), a.row,
+                                batches_[b.batch].keys.data(), b.row) < 0;
+  });
+  return refs;
+}
+
+Status SortNode::SpillRun() {
+  SortedRowWriter writer(input_descriptors_[0], AllColumns(input_descriptors_[0].size()));
+  SortedRun run;
+  auto write_batch = [&]() -> Status {
+    PX_ASSIGN_OR_RETURN(auto batch, spill_writer_->Write(ColdBatch(writer.FlushArrays())));
+    bytes_spilled_ += batch.Bytes();
+    run.push_back(std::move(batch));
+    return Status::OK();
+  };
+
+  for (const auto& ref : SortHeldRows()) {
+    writer.AppendRow(batches_[ref.batch].columns, ref.row);
+    if (writer.num_rows() % kDefaultSortRowBatchSize == 0 && writer.Bytes() >= kSpillBatchBytes) {
+      PX_RETURN_IF_ERROR(write_batch());
+    }
+  }
+  if (writer.num_rows() > 0) {
+    PX_RETURN_IF_ERROR(write_batch());
+  }
+  runs_.push_back(std::move(run));
+  batches_.clear();
+  held_bytes_ = 0;
+  return Status::OK();
+}
+
+Status SortNode::SendHeldRows(ExecState* exec_state, bool eos) {
+  SortedRowWriter writer(*output_descriptor_, plan_node_->selected_cols());
+  for (const auto& ref : SortHeldRows()) {
+    writer.AppendRow(batches_[ref.batch].columns, ref.row);
+    if (writer.num_rows() == kDefaultSortRowBatchSize) {
+      PX_ASSIGN_OR_RETURN(auto out, writer.Flush(/*eow*/ false, /*eos*/ false));
+      PX_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, out));
+    }
+  }
+  batches_.clear();
+  held_bytes_ = 0;
+
+  PX_ASSIGN_OR_RETURN(auto out, writer.Flush(/*eow*/ true, eos));
+  return SendRowBatchToChildren(exec_state, out);
+}
+
+Status SortNode::MergeRuns(ExecState* exec_state, bool eos) {
+  // A cursor reads through the batches of a run one at a time.
+  struct Cursor {
+    size_t run;
+    size_t batch;
+    std::unique_ptr<SortedBatch> current;
+    int64_t row;
+  };
+  const auto& input_desc = input_descriptors_[0];
+  auto all_cols = AllColumns(input_desc.size());
+  auto load = [&](Cursor* cursor) -> Status {
+    const auto& spilled = runs_[cursor->run][cursor->batch];
+    RowBatch rb(input_desc, spilled.Length());
+    PX_RETURN_IF_ERROR(spilled.AddBatchSliceToRowBatch(0, spilled.Length(), all_cols, &rb));
+    cursor->current = std::make_unique<SortedBatch>(std::move(rb), *comparator_);
+    cursor->row = 0;
+    return Status::OK();
+  };
+
+  std::vector<Cursor> cursors(runs_.size());
+  std::vector<size_t> heap;
+  for (size_t i = 0; i < runs_.size(); ++i) {
+    cursors[i].run = i;
+    cursors[i].batch = 0;
+    if (!runs_[i].empty()) {
+      PX_RETURN_IF_ERROR(load(&cursors[i]));
+      heap.push_back(i);
+    }
+  }
+  // A min heap of the cursors by their current row. The runs are in input order, so ties go to
+  // the earlier run.
+  auto sorts_after = [&cursors, this](size_t a, size_t b) {
+    const auto& ca = cursors[a];
+    const auto& cb = cursors[b];
+    int c = comparator_->Compare(ca.current->keys.data(), ca.row, cb.current->keys.data(),
+                                 cb.row);
+    return c != 0 ? c > 0 : ca.run > cb.run;
+  };
+  std::make_heap(heap.begin(), heap.end(), sorts_after);
+
+  SortedRowWriter writer(*output_descriptor_, plan_node_->selected_cols());
+  while (!heap.empty()) {
+    std::pop_heap(heap.begin(), heap.end(), sorts_after);
+    auto& cursor = cursors[heap.back()];
+    writer.AppendRow(cursor.current->columns, cursor.row);
+    if (writer.num_rows() == kDefaultSortRowBatchSize) {
+      PX_ASSIGN_OR_RETURN(auto out, writer.Flush(/*eow*/ false, /*eos*/ false));
+      PX_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, out));
+    }
+
+    if (++cursor.row == cursor.current->rb.num_rows()) {
+      if (++cursor.batch == runs_[cursor.run].size()) {
+        cursor.current.reset();
+        heap.pop_back();
+        continue;
+      }
+      PX_RETURN_IF_ERROR(load(&cursor));
+    }
+    std::push_heap(heap.begin(), heap.end(), sorts_after);
+  }
+  runs_.clear();
+
+  PX_ASSIGN_OR_RETURN(auto out, writer.Flush(/*eow*/ true, eos));
+  return SendRowBatchToChildren(exec_state, out);
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,102 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "src/carnot/exec/exec_node.h"
+#include "src/carnot/exec/exec_state.h"
+#include "src/carnot/exec/sort_utils.h"
+#include "src/carnot/plan/operators.h"
+#include "src/common/base/base.h"
+#include "src/table_store/schema/row_batch.h"
+#include "src/table_store/table/internal/spill_batch.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * SortNode runs a sort without a limit. It holds its input until the end of each window, and then
+ * outputs all of the rows in sort order. Rows with equal sort keys keep their input order.
+ *
+ * When a spill directory is set, and the held input grows past the memory limit, the held rows are
+ * sorted and written to disk as a sorted run. At the end of the window the runs are merged.
+ */
+class SortNode : public ProcessingNode {
+ public:
+  struct Options {
+    // The number of bytes of input the sort holds in memory before it spills a run. Only used
+    // when spill_dir is set.
+    int64_t memory_limit_bytes = 0;
+    // The directory to spill runs to. Spilling is disabled when it's empty.
+    std::string spill_dir;
+  };
+
+  // Takes the memory limit and spill directory from flags.
+  SortNode() = default;
+  explicit SortNode(Options opts) : opts_(std::move(opts)), options_set_(true) {}
+  virtual ~SortNode() = default;
+
+  int64_t bytes_spilled() const { return bytes_spilled_; }
+
+ protected:
+  std::string DebugStringImpl() override;
+  Status InitImpl(const plan::Operator& plan_node) override;
+  Status PrepareImpl(ExecState* exec_state) override;
+  Status OpenImpl(ExecState* exec_state) override;
+  Status CloseImpl(ExecState* exec_state) override;
+  Status ConsumeNextImpl(ExecState* exec_state, const table_store::schema::RowBatch& rb,
+                         size_t parent_index) override;
+
+ private:
+  struct RowRef {
+    int64_t batch;
+    int64_t row;
+  };
+  using SortedRun = std::vector<table_store::internal::SpillBatch>;
+
+  // Returns all of the held rows in sort order.
+  std::vector<RowRef> SortHeldRows() const;
+  // Sorts the held rows and writes them out as a sorted run.
+  Status SpillRun();
+  // Sends the held rows to the children in sort order.
+  Status SendHeldRows(ExecState* exec_state, bool eos);
+  // Sends the rows of the spilled runs to the children in sort order.
+  Status MergeRuns(ExecState* exec_state, bool eos);
+
+  std::unique_ptr<plan::SortOperator> plan_node_;
+  std::unique_ptr<RowComparator> comparator_;
+  Options opts_;
+  bool options_set_ = false;
+  std::optional<table_store::internal::SpillWriter> spill_writer_;
+
+  std::vector<SortedBatch> batches_;
+  int64_t held_bytes_ = 0;
+  std::vector<SortedRun> runs_;
+  int64_t bytes_spilled_ = 0;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
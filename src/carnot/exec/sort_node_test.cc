@@ -0,0 +1,163 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/sort_node.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <sole.hpp>
+
+#include "src/carnot/exec/test_utils.h"
+#include "src/carnot/planpb/test_proto.h"
+#include "src/carnot/udf/registry.h"
+#include "src/common/base/base.h"
+#include "src/common/testing/testing.h"
+#include "src/shared/types/types.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowDescriptor;
+using types::Int64Value;
+
+class SortNodeTest : public ::testing::Test {
+ public:
+  SortNodeTest() {
+    func_registry_ = std::make_unique<udf::Registry>("test_registry");
+    auto table_store = std::make_shared<table_store::TableStore>();
+    exec_state_ = std::make_unique<ExecState>(func_registry_.get(), table_store,
+                                              MockResultSinkStubGenerator, MockMetricsStubGenerator,
+                                              MockTraceStubGenerator, sole::uuid4(), nullptr);
+    plan_node_ = plan::SortOperator::FromProto(planpb::testutils::CreateTestSort1PB(0), 1);
+  }
+
+ protected:
+  std::unique_ptr<plan::Operator> plan_node_;
+  std::unique_ptr<ExecState> exec_state_;
+  std::unique_ptr<udf::Registry> func_registry_;
+  RowDescriptor rd_{{types::DataType::INT64, types::DataType::INT64}};
+};
+
+// The test sort orders by column 1 descending, then by column 0 ascending.
+TEST_F(SortNodeTest, sorts_all_rows) {
+  auto tester =
+      ExecNodeTester<SortNode, plan::SortOperator>(*plan_node_, rd_, {rd_}, exec_state_.get());
+  tester
+      .ConsumeNext(RowBatchBuilder(rd_, 4, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<Int64Value>({1, 2, 3, 4})
+                       .AddColumn<Int64Value>({10, 30, 20, 30})
+                       .get(),
+                   0, /*child_called_times*/ 0)
+      .ConsumeNext(RowBatchBuilder(rd_, 3, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<Int64Value>({5, 6, 7})
+                       .AddColumn<Int64Value>({40, 30, 5})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(rd_, 7, true, true)
+                          .AddColumn<Int64Value>({5, 2, 4, 6, 3, 1, 7})
+                          .AddColumn<Int64Value>({40, 30, 30, 30, 20, 10, 5})
+                          .get())
+      .Close();
+}
+
+TEST_F(SortNodeTest, spills_and_merges_runs) {
+  px::testing::TempDir temp_dir;
+  SortNode::Options opts;
+  // Spill a run for every input batch.
+  opts.memory_limit_bytes = 1;
+  opts.spill_dir = temp_dir.path().string();
+
+  constexpr int64_t kBatches = 3;
+  constexpr int64_t kRowsPerBatch = 1000;
+  std::vector<std::pair<int64_t, int64_t>> rows;
+  for (int64_t i = 0; i < kBatches * kRowsPerBatch; ++i) {
+    rows.emplace_back(i, (i * 7919) % 500);
+  }
+
+  auto tester = ExecNodeTester<SortNode, plan::SortOperator>(*plan_node_, rd_, {rd_},
+                                                             exec_state_.get(), opts);
+  for (int64_t b = 0; b < kBatches; ++b) {
+    std::vector<Int64Value> col0;
+    std::vector<Int64Value> col1;
+    for (int64_t i = b * kRowsPerBatch; i < (b + 1) * kRowsPerBatch; ++i) {
+      col0.push_back(rows[i].first);
+      col1.push_back(rows[i].second);
+    }
+    bool last = b == kBatches - 1;
+    auto num_output_batches =
+        last ? (kBatches * kRowsPerBatch + kDefaultSortRowBatchSize - 1) / kDefaultSortRowBatchSize
+             : 0;
+    tester.ConsumeNext(RowBatchBuilder(rd_, kRowsPerBatch, last, last)
+                           .AddColumn<Int64Value>(col0)
+                           .AddColumn<Int64Value>(col1)
+                           .get(),
+                       0, num_output_batches);
+  }
+  EXPECT_GT(tester.node()->bytes_spilled(), 0);
+
+  std::sort(rows.begin(), rows.end(), [](const auto& a, const auto& b) {
+    return a.second != b.second ? a.second > b.second : a.first < b.first;
+  });
+  for (size_t start = 0; start < rows.size(); start += kDefaultSortRowBatchSize) {
+    size_t end = std::min(rows.size(), start + kDefaultSortRowBatchSize);
+    std::vector<Int64Value> col0;
+    std::vector<Int64Value> col1;
+    for (size_t i = start; i < end; ++i) {
+      col0.push_back(rows[i].first);
+      col1.push_back(rows[i].second);
+    }
+    bool last = end == rows.size();
+    tester.ExpectRowBatch(RowBatchBuilder(rd_, end - start, last, last)
+                              .AddColumn<Int64Value>(col0)
+                              .AddColumn<Int64Value>(col1)
+                              .get());
+  }
+  tester.Close();
+}
+
+TEST(CompareArrowValuesTest, nan_sorts_last) {
+  constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+  std::vector<types::Float64Value> values = {1.5, kNaN, -2.0, kNaN};
+  auto arr = types::ToArrow(values, arrow::default_memory_pool());
+  auto compare = [&](int64_t a, int64_t b) {
+    return CompareArrowValues<types::DataType::FLOAT64>(arr.get(), a, arr.get(), b);
+  };
+  EXPECT_EQ(-1, compare(0, 1));
+  EXPECT_EQ(1, compare(1, 0));
+  EXPECT_EQ(0, compare(1, 3));
+  EXPECT_EQ(1, compare(0, 2));
+
+  std::vector<int64_t> rows = {0, 1, 2, 3};
+  std::sort(rows.begin(), rows.end(), [&](int64_t a, int64_t b) { return compare(a, b) < 0; });
+  EXPECT_EQ(2, rows[0]);
+  EXPECT_EQ(0, rows[1]);
+  EXPECT_TRUE(std::isnan(values[rows[2]].val));
+  EXPECT_TRUE(std::isnan(values[rows[3]].val));
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
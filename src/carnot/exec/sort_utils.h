@@ -0,0 +1,224 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/array.h>
+#include <arrow/memory_pool.h>
+
+#include <cmath>
+#include <memory>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "src/carnot/plan/operators.h"
+#include "src/common/base/base.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/column_wrapper.h"
+#include "src/shared/types/type_utils.h"
+#include "src/shared/types/types.h"
+#include "src/table_store/schema/row_batch.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+// The number of rows in each batch that the sort nodes output.
+constexpr int64_t kDefaultSortRowBatchSize = 1024;
+
+template <types::DataType DT>
+int CompareArrowValues(const arrow::Array* a, int64_t a_row, const arrow::Array* b,
+                       int64_t b_row) {
+  if constexpr (DT == types::DataType::STRING) {
+    int c = types::GetStringViewFromArrowArray(a, a_row)
+                .compare(types::GetStringViewFromArrowArray(b, b_row));
+    return c < 0 ? -1 : (c > 0 ? 1 : 0);
+  } else if constexpr (DT == types::DataType::FLOAT64) {
+    // NaN compares unordered to everything, so it is ordered explicitly: NaNs are equal to each
+    // other and sort after every other value. This keeps the comparison a strict weak ordering.
+    double a_val = types::GetValueFromArrowArray<DT>(a, a_row);
+    double b_val = types::GetValueFromArrowArray<DT>(b, b_row);
+    bool a_nan = std::isnan(a_val);
+    bool b_nan = std::isnan(b_val);
+    if (a_nan || b_nan) {
+      return a_nan == b_nan ? 0 : (a_nan ? 1 : -1);
+    }
+    return a_val < b_val ? -1 : (b_val < a_val ? 1 : 0);
+  } else {
+    auto a_val = types::GetValueFromArrowArray<DT>(a, a_row);
+    auto b_val = types::GetValueFromArrowArray<DT>(b, b_row);
+    return a_val < b_val ? -1 : (b_val < a_val ? 1 : 0);
+  }
+}
+
+/**
+ * RowComparator orders the rows of a sort's input by its sort keys. A row is passed as the key
+ * columns of its batch (see KeyColumns) and its index in the batch, so that the columns of a batch
+ * only have to be looked up once.
+ */
+class RowComparator {
+ public:
+  RowComparator(const std::vector<plan::SortOperator::SortKey>& keys,
+                const table_store::schema::RowDescriptor& input_desc) {
+    keys_.reserve(keys.size());
+    for (const auto& key : keys) {
+      keys_.push_back({key.index, input_desc.type(key.index), key.ascending});
+    }
+  }
+
+  /**
+   * Returns the key columns of the given batch, in the order of the sort keys.
+   */
+  std::vector<const arrow::Array*> KeyColumns(
+      const std::vector<const arrow::Array*>& columns) const {
+    std::vector<const arrow::Array*> key_columns;
+    key_columns.reserve(keys_.size());
+    for (const auto& key : keys_) {
+      key_columns.push_back(columns[key.index]);
+    }
+    return key_columns;
+  }
+
+  /**
+   * Returns a negative number if row a sorts before row b, a positive number if it sorts after
+   * row b, and 0 if their sort keys are equal.
+   */
+  int Compare(const arrow::Array* const* a_keys, int64_t a_row, const arrow::Array* const* b_keys,
+              int64_t b_row) const {
+    for (size_t i = 0; i < keys_.size(); ++i) {
+      int c = 0;
+#define TYPE_CASE(_dt_) c = CompareArrowValues<_dt_>(a_keys[i], a_row, b_keys[i], b_row);
+      PX_SWITCH_FOREACH_DATATYPE(keys_[i].type, TYPE_CASE);
+#undef TYPE_CASE
+      if (c != 0) {
+        return keys_[i].ascending ? c : -c;
+      }
+    }
+    return 0;
+  }
+
+ private:
+  struct Key {
+    int64_t index;
+    types::DataType type;
+    bool ascending;
+  };
+  std::vector<Key> keys_;
+};
+
+/**
+ * SortedBatch is an input batch held by a sort, along with raw pointers to its columns.
+ */
+struct SortedBatch {
+  SortedBatch(table_store::schema::RowBatch batch, const RowComparator& comparator)
+      : rb(std::move(batch)) {
+    columns.reserve(rb.num_columns());
+    for (int64_t i = 0; i < rb.num_columns(); ++i) {
+      columns.push_back(rb.ColumnAt(i).get());
+    }
+    keys = comparator.KeyColumns(columns);
+  }
+
+  table_store::schema::RowBatch rb;
+  std::vector<const arrow::Array*> columns;
+  std::vector<const arrow::Array*> keys;
+};
+
+/**
+ * SortedRowWriter copies rows, in the order they are appended, into output batches made up of a
+ * subset of the input columns.
+ */
+class SortedRowWriter {
+ public:
+  /**
+   * @param output_desc the types of the output columns.
+   * @param input_cols the index of each output column in the input.
+   */
+  SortedRowWriter(table_store::schema::RowDescriptor output_desc, std::vector<int64_t> input_cols)
+      : output_desc_(std::move(output_desc)), input_cols_(std::move(input_cols)) {
+    DCHECK_EQ(output_desc_.size(), input_cols_.size());
+    Reset();
+  }
+
+  void AppendRow(const std::vector<const arrow::Array*>& input_columns, int64_t row) {
+    for (size_t i = 0; i < input_cols_.size(); ++i) {
+      auto* arr = const_cast<arrow::Array*>(input_columns[input_cols_[i]]);
+      auto* wrapper = wrappers_[i].get();
+#define TYPE_CASE(_dt_) types::ExtractValueToColumnWrapper<_dt_>(wrapper, arr, row);
+      PX_SWITCH_FOREACH_DATATYPE(output_desc_.type(i), TYPE_CASE);
+#undef TYPE_CASE
+    }
+    ++num_rows_;
+  }
+
+  int64_t num_rows() const { return num_rows_; }
+
+  int64_t Bytes() const {
+    int64_t bytes = 0;
+    for (const auto& wrapper : wrappers_) {
+      bytes += wrapper->Bytes();
+    }
+    return bytes;
+  }
+
+  /**
+   * Returns the arrays of the rows appended since the last flush, and starts a new batch.
+   */
+  std::vector<std::shared_ptr<arrow::Array>> FlushArrays() {
+    std::vector<std::shared_ptr<arrow::Array>> arrays;
+    arrays.reserve(wrappers_.size());
+    for (const auto& wrapper : wrappers_) {
+      arrays.push_back(wrapper->ConvertToArrow(arrow::default_memory_pool()));
+    }
+    Reset();
+    return arrays;
+  }
+
+  /**
+   * Returns a row batch of the rows appended since the last flush, and starts a new batch.
+   */
+  StatusOr<table_store::schema::RowBatch> Flush(bool eow, bool eos) {
+    table_store::schema::RowBatch rb(output_desc_, num_rows_);
+    for (const auto& arr : FlushArrays()) {
+      PX_RETURN_IF_ERROR(rb.AddColumn(arr));
+    }
+    rb.set_eow(eow);
+    rb.set_eos(eos);
+    return rb;
+  }
+
+ private:
+  void Reset() {
+    wrappers_.clear();
+    for (size_t i = 0; i < output_desc_.size(); ++i) {
+      wrappers_.push_back(types::ColumnWrapper::Make(output_desc_.type(i), 0));
+      wrappers_.back()->Reserve(kDefaultSortRowBatchSize);
+    }
+    num_rows_ = 0;
+  }
+
+  table_store::schema::RowDescriptor output_desc_;
+  std::vector<int64_t> input_cols_;
+  std::vector<types::SharedColumnWrapper> wrappers_;
+  int64_t num_rows_ = 0;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
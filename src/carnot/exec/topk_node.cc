@@ -0,0 +1,176 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/topk_node.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <absl/strings/substitute.h>
+
+#include "src/carnot/planpb/plan.pb.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+using table_store::schema::RowDescriptor;
+
+namespace {
+// The heap is compacted once the held batches have more than this many rows per row in the
+// heap (and at least kMinCompactRows rows).
+constexpr int64_t kCompactRatio = 4;
+constexpr int64_t kMinCompactRows = 64 * 1024;
+}  // namespace
+
+std::string TopKNode::DebugStringImpl() {
+  return absl::Substitute("Exec::TopKNode<$0>", plan_node_->DebugString());
+}
+
+Status TopKNode::InitImpl(const plan::Operator& plan_node) {
+  CHECK(plan_node.op_type() == planpb::OperatorType::SORT_OPERATOR);
+  const auto* sort_plan_node = static_cast<const plan::SortOperator*>(&plan_node);
+  plan_node_ = std::make_unique<plan::SortOperator>(*sort_plan_node);
+  if (plan_node_->limit() <= 0) {
+    return error::InvalidArgument("TopKNode requires a positive limit, got $0",
+                                  plan_node_->limit());
+  }
+  if (input_descriptors_.size() != 1) {
+    return error::InvalidArgument("TopKNode expects a single input, got $0",
+                                  input_descriptors_.size());
+  }
+  comparator_ = std::make_unique<RowComparator>(plan_node_->keys(), input_descriptors_[0]);
+  return Status::OK();
+}
+
+Status TopKNode::PrepareImpl(ExecState*) { return Status::OK(); }
+
+Status TopKNode::OpenImpl(ExecState*) { return Status::OK(); }
+
+Status TopKNode::CloseImpl(ExecState*) {
+  batches_.clear();
+  heap_.clear();
+  held_rows_ = 0;
+  return Status::OK();
+}
+
+bool TopKNode::SortsBefore(const RowRef& a, const RowRef& b) const {
+  int c = comparator_->Compare(batches_[a.batch].keys.data(), a.row,
+                               batches_[b.batch].keys.data(), b.row);
+  if (c != 0) {
+    return c < 0;
+  }
+  // Batches and rows are held in input order, so ties keep the input order.
+  return a.batch < b.batch || (a.batch == b.batch && a.row < b.row);
+}
+
+Status TopKNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_t) {
+  auto limit = static_cast<size_t>(plan_node_->limit());
+  auto cmp = [this](const RowRef& a, const RowRef& b) { return SortsBefore(a, b); };
+
+  if (rb.num_selected_rows() > 0) {
+    batches_.emplace_back(rb, *comparator_);
+    auto batch_idx = static_cast<int64_t>(batches_.size()) - 1;
+    bool kept_rows = false;
+    for (int64_t i = 0; i < rb.num_selected_rows(); ++i) {
+      RowRef ref{batch_idx, rb.HasSelection() ? rb.selection()[i] : i};
+      if (heap_.size() < limit) {
+        heap_.push_back(ref);
+        std::push_heap(heap_.begin(), heap_.end(), cmp);
+        kept_rows = true;
+      } else if (SortsBefore(ref, heap_.front())) {
+        std::pop_heap(heap_.begin(), heap_.end(), cmp);
+        heap_.back() = ref;
+        std::push_heap(heap_.begin(), heap_.end(), cmp);
+        kept_rows = true;
+      }
+    }
+    if (!kept_rows) {
+      // None of the heap's rows reference the batch, since it was just added.
+      batches_.pop_back();
+    } else {
+      held_rows_ += rb.num_rows();
+    }
+    if (held_rows_ > std::max<int64_t>(kMinCompactRows, kCompactRatio * heap_.size())) {
+      PX_RETURN_IF_ERROR(Compact());
+    }
+  }
+
+  if (rb.eow() || rb.eos()) {
+    return SendRows(exec_state, rb.eos());
+  }
+  return Status::OK();
+}
+
+Status TopKNode::Compact() {
+  // Copy the rows out in input order, so that the order of rows with equal keys is kept, and the
+  // heap stays a heap after its references are rewritten.
+  std::vector<size_t> order(heap_.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+    return heap_[a].batch < heap_[b].batch ||
+           (heap_[a].batch == heap_[b].batch && heap_[a].row < heap_[b].row);
+  });
+
+  const auto& input_desc = input_descriptors_[0];
+  std::vector<int64_t> all_cols(input_desc.size());
+  for (size_t i = 0; i < all_cols.size(); ++i) {
+    all_cols[i] = i;
+  }
+  SortedRowWriter writer(input_desc, all_cols);
+  for (size_t i = 0; i < order.size(); ++i) {
+    auto& ref = heap_[order[i]];
+    writer.AppendRow(batches_[ref.batch].columns, ref.row);
+    ref = RowRef{0, static_cast<int64_t>(i)};
+  }
+  PX_ASSIGN_OR_RETURN(auto rb, writer.Flush(/*eow*/ false, /*eos*/ false));
+  batches_.clear();
+  batches_.emplace_back(std::move(rb), *comparator_);
+  held_rows_ = heap_.size();
+  return Status::OK();
+}
+
+Status TopKNode::SendRows(ExecState* exec_state, bool eos) {
+  auto cmp = [this](const RowRef& a, const RowRef& b) { return SortsBefore(a, b); };
+  std::sort_heap(heap_.begin(), heap_.end(), cmp);
+
+  SortedRowWriter writer(*output_descriptor_, plan_node_->selected_cols());
+  for (const auto& ref : heap_) {
+    writer.AppendRow(batches_[ref.batch].columns, ref.row);
+    if (writer.num_rows() == kDefaultSortRowBatchSize) {
+      PX_ASSIGN_OR_RETURN(auto out, writer.Flush(/*eow*/ false, /*eos*/ false));
+      PX_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, out));
+    }
+  }
+  heap_.clear();
+  batches_.clear();
+  held_rows_ = 0;
+
+  PX_ASSIGN_OR_RETURN(auto out, writer.Flush(/*eow*/ true, eos));
+  return SendRowBatchToChildren(exec_state, out);
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/carnot/exec/exec_node.h"
+#include "src/carnot/exec/exec_state.h"
+#include "src/carnot/exec/sort_utils.h"
+#include "src/carnot/plan/operators.h"
+#include "src/common/base/base.h"
+#include "src/table_store/schema/row_batch.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * TopKNode runs a sort with a limit. It keeps the first `limit` rows of its input in sort order in
+ * a bounded heap, and outputs them in order at the end of each window. Rows with equal sort keys
+ * keep their input order.
+ *
+ * The heap references rows of the input batches, so a batch is held for as long as one of its
+ * rows is in the heap. Once the held batches add up to more than a few times the limit, the rows
+ * in the heap are copied out into a single batch and the rest are released.
+ */
+class TopKNode : public ProcessingNode {
+ public:
+  TopKNode() = default;
+  virtual ~TopKNode() = default;
+
+ protected:
+  std::string DebugStringImpl() override;
+  Status InitImpl(const plan::Operator& plan_node) override;
+  Status PrepareImpl(ExecState* exec_state) override;
+  Status OpenImpl(ExecState* exec_state) override;
+  Status CloseImpl(ExecState* exec_state) override;
+  Status ConsumeNextImpl(ExecState* exec_state, const table_store::schema::RowBatch& rb,
+                         size_t parent_index) override;
+  bool AcceptsSelection(const table_store::schema::RowBatch&) const override { return true; }
+
+ private:
+  struct RowRef {
+    int64_t batch;
+    int64_t row;
+  };
+
+  // Whether row a comes before row b in the output. The heap is a max heap under this order, so
+  // its front is the kept row that sorts last.
+  bool SortsBefore(const RowRef& a, const RowRef& b) const;
+  // Copies the rows in the heap into a single batch, and releases the other batches.
+  Status Compact();
+  // Sends the rows in the heap to the children in sort order, and clears the heap.
+  Status SendRows(ExecState* exec_state, bool eos);
+
+  std::unique_ptr<plan::SortOperator> plan_node_;
+  std::unique_ptr<RowComparator> comparator_;
+  std::vector<SortedBatch> batches_;
+  std::vector<RowRef> heap_;
+  // The number of rows in batches_.
+  int64_t held_rows_ = 0;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,142 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/topk_node.h"
+
+#include <memory>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <sole.hpp>
+
+#include "src/carnot/exec/test_utils.h"
+#include "src/carnot/planpb/test_proto.h"
+#include "src/carnot/udf/registry.h"
+#include "src/common/base/base.h"
+#include "src/shared/types/types.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowDescriptor;
+using types::Int64Value;
+
+class TopKNodeTest : public ::testing::Test {
+ public:
+  TopKNodeTest() {
+    func_registry_ = std::make_unique<udf::Registry>("test_registry");
+    auto table_store = std::make_shared<table_store::TableStore>();
+    exec_state_ = std::make_unique<ExecState>(func_registry_.get(), table_store,
+                                              MockResultSinkStubGenerator, MockMetricsStubGenerator,
+                                              MockTraceStubGenerator, sole::uuid4(), nullptr);
+  }
+
+ protected:
+  std::unique_ptr<ExecState> exec_state_;
+  std::unique_ptr<udf::Registry> func_registry_;
+  RowDescriptor rd_{{types::DataType::INT64, types::DataType::INT64}};
+};
+
+// The test sort orders by column 1 descending, then by column 0 ascending.
+TEST_F(TopKNodeTest, keeps_top_rows_across_batches) {
+  auto plan_node = plan::SortOperator::FromProto(planpb::testutils::CreateTestSort1PB(3), 1);
+  auto tester =
+      ExecNodeTester<TopKNode, plan::SortOperator>(*plan_node, rd_, {rd_}, exec_state_.get());
+  tester
+      .ConsumeNext(RowBatchBuilder(rd_, 4, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<Int64Value>({1, 2, 3, 4})
+                       .AddColumn<Int64Value>({10, 30, 20, 30})
+                       .get(),
+                   0, /*child_called_times*/ 0)
+      .ConsumeNext(RowBatchBuilder(rd_, 3, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<Int64Value>({5, 6, 7})
+                       .AddColumn<Int64Value>({40, 30, 5})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(rd_, 3, true, true)
+                          .AddColumn<Int64Value>({5, 2, 4})
+                          .AddColumn<Int64Value>({40, 30, 30})
+                          .get())
+      .Close();
+}
+
+TEST_F(TopKNodeTest, fewer_rows_than_limit) {
+  auto plan_node = plan::SortOperator::FromProto(planpb::testutils::CreateTestSort1PB(10), 1);
+  auto tester =
+      ExecNodeTester<TopKNode, plan::SortOperator>(*plan_node, rd_, {rd_}, exec_state_.get());
+  tester
+      .ConsumeNext(RowBatchBuilder(rd_, 3, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<Int64Value>({1, 2, 3})
+                       .AddColumn<Int64Value>({5, 5, 7})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(rd_, 3, true, true)
+                          .AddColumn<Int64Value>({3, 1, 2})
+                          .AddColumn<Int64Value>({7, 5, 5})
+                          .get())
+      .Close();
+}
+
+TEST_F(TopKNodeTest, empty_input) {
+  auto plan_node = plan::SortOperator::FromProto(planpb::testutils::CreateTestSort1PB(3), 1);
+  auto tester =
+      ExecNodeTester<TopKNode, plan::SortOperator>(*plan_node, rd_, {rd_}, exec_state_.get());
+  tester
+      .ConsumeNext(RowBatchBuilder(rd_, 0, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<Int64Value>({})
+                       .AddColumn<Int64Value>({})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(rd_, 0, true, true)
+                          .AddColumn<Int64Value>({})
+                          .AddColumn<Int64Value>({})
+                          .get())
+      .Close();
+}
+
+TEST_F(TopKNodeTest, outputs_each_window) {
+  auto plan_node = plan::SortOperator::FromProto(planpb::testutils::CreateTestSort1PB(2), 1);
+  auto tester =
+      ExecNodeTester<TopKNode, plan::SortOperator>(*plan_node, rd_, {rd_}, exec_state_.get());
+  tester
+      .ConsumeNext(RowBatchBuilder(rd_, 3, /*eow*/ true, /*eos*/ false)
+                       .AddColumn<Int64Value>({1, 2, 3})
+                       .AddColumn<Int64Value>({1, 3, 2})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(rd_, 2, true, false)
+                          .AddColumn<Int64Value>({2, 3})
+                          .AddColumn<Int64Value>({3, 2})
+                          .get())
+      .ConsumeNext(RowBatchBuilder(rd_, 2, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<Int64Value>({4, 5})
+                       .AddColumn<Int64Value>({0, 1})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(rd_, 2, true, true)
+                          .AddColumn<Int64Value>({5, 4})
+                          .AddColumn<Int64Value>({1, 0})
+                          .get())
+      .Close();
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
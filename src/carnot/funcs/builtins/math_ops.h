@@ -35,6 +35,12 @@ template <typename TReturn, typename TArg1 = TReturn, typename TArg2 = TReturn>
 class AddUDF : public udf::ScalarUDF {
  public:
   TReturn Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1.val + b2.val; }
+  void ExecBatch(FunctionContext*, size_t count, udf::NativeType<TReturn>* out,
+                 const udf::NativeType<TArg1>* b1, const udf::NativeType<TArg2>* b2) {
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = b1[i] + b2[i];
+    }
+  }
   static udf::InfRuleVec SemanticInferenceRules() {
     return {
         udf::InheritTypeFromArgs<AddUDF>::Create({types::ST_BYTES, types::ST_THROUGHPUT_PER_NS,
@@ -60,6 +66,12 @@ template <typename TReturn, typename TArg1 = TReturn, typename TArg2 = TReturn>
 class SubtractUDF : public udf::ScalarUDF {
  public:
   TReturn Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1.val - b2.val; }
+  void ExecBatch(FunctionContext*, size_t count, udf::NativeType<TReturn>* out,
+                 const udf::NativeType<TArg1>* b1, const udf::NativeType<TArg2>* b2) {
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = b1[i] - b2[i];
+    }
+  }
   static udf::InfRuleVec SemanticInferenceRules() {
     return {
         udf::InheritTypeFromArgs<SubtractUDF>::Create({types::ST_BYTES, types::ST_THROUGHPUT_PER_NS,
@@ -88,6 +100,12 @@ class DivideUDF : public udf::ScalarUDF {
   types::Float64Value Exec(FunctionContext*, TArg1 b1, TArg2 b2) {
     return static_cast<double>(b1.val) / static_cast<double>(b2.val);
   }
+  void ExecBatch(FunctionContext*, size_t count, udf::NativeType<types::Float64Value>* out,
+                 const udf::NativeType<TArg1>* b1, const udf::NativeType<TArg2>* b2) {
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = static_cast<double>(b1[i]) / static_cast<double>(b2[i]);
+    }
+  }
 
   static udf::InfRuleVec SemanticInferenceRules() {
     return {udf::ExplicitRule::Create<DivideUDF>(types::ST_THROUGHPUT_PER_NS,
@@ -113,6 +131,12 @@ template <typename TReturn, typename TArg1 = TReturn, typename TArg2 = TReturn>
 class MultiplyUDF : public udf::ScalarUDF {
  public:
   TReturn Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1.val * b2.val; }
+  void ExecBatch(FunctionContext*, size_t count, udf::NativeType<TReturn>* out,
+                 const udf::NativeType<TArg1>* b1, const udf::NativeType<TArg2>* b2) {
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = b1[i] * b2[i];
+    }
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Multiplies the arguments.")
         .Details("Multiplies the two values together. Accessible using the `*` operator syntax.")
@@ -213,6 +237,12 @@ template <typename TArg1>
 class AbsUDF : public udf::ScalarUDF {
  public:
   TArg1 Exec(FunctionContext*, TArg1 v) { return std::abs(v.val); }
+  void ExecBatch(FunctionContext*, size_t count, udf::NativeType<TArg1>* out,
+                 const udf::NativeType<TArg1>* v) {
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = std::abs(v[i]);
+    }
+  }
 
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Computes absolute value")
@@ -266,6 +296,12 @@ template <typename TArg1, typename TArg2 = TArg1>
 class LogicalOrUDF : public udf::ScalarUDF {
  public:
   BoolValue Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1.val || b2.val; }
+  void ExecBatch(FunctionContext*, size_t count, udf::NativeType<BoolValue>* out,
+                 const udf::NativeType<TArg1>* b1, const udf::NativeType<TArg2>* b2) {
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = b1[i] || b2[i];
+    }
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Boolean ORs the passed in values.")
         .Example(R"doc(# Implicit call.
@@ -285,6 +321,12 @@ template <typename TArg1, typename TArg2 = TArg1>
 class LogicalAndUDF : public udf::ScalarUDF {
  public:
   BoolValue Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1.val && b2.val; }
+  void ExecBatch(FunctionContext*, size_t count, udf::NativeType<BoolValue>* out,
+                 const udf::NativeType<TArg1>* b1, const udf::NativeType<TArg2>* b2) {
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = b1[i] && b2[i];
+    }
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Boolean ANDs the passed in values.")
         .Example(R"doc(# Implicit call.
@@ -302,6 +344,12 @@ template <typename TArg1>
 class LogicalNotUDF : public udf::ScalarUDF {
  public:
   BoolValue Exec(FunctionContext*, TArg1 b1) { return !b1.val; }
+  void ExecBatch(FunctionContext*, size_t count, udf::NativeType<BoolValue>* out,
+                 const udf::NativeType<TArg1>* b1) {
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = !b1[i];
+    }
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Boolean NOTs the passed in value.")
         .Example(R"doc(# Implicit call.
@@ -318,6 +366,12 @@ template <typename TArg1>
 class NegateUDF : public udf::ScalarUDF {
  public:
   TArg1 Exec(FunctionContext*, TArg1 b1) { return -b1.val; }
+  void ExecBatch(FunctionContext*, size_t count, udf::NativeType<TArg1>* out,
+                 const udf::NativeType<TArg1>* b1) {
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = -b1[i];
+    }
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Negates the passed in value.")
         .Example(R"doc(# Implicit call.
@@ -333,6 +387,12 @@ template <typename TArg1>
 class InvertUDF : public udf::ScalarUDF {
  public:
   TArg1 Exec(FunctionContext*, TArg1 b1) { return ~b1.val; }
+  void ExecBatch(FunctionContext*, size_t count, udf::NativeType<TArg1>* out,
+                 const udf::NativeType<TArg1>* b1) {
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = ~b1[i];
+    }
+  }
 
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Invert the bits of the given value.")
@@ -374,6 +434,12 @@ template <typename TArg1, typename TArg2 = TArg1>
 class EqualUDF : public udf::ScalarUDF {
  public:
   BoolValue Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1 == b2; }
+  void ExecBatch(FunctionContext*, size_t count, udf::NativeType<BoolValue>* out,
+                 const udf::NativeType<TArg1>* b1, const udf::NativeType<TArg2>* b2) {
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = b1[i] == b2[i];
+    }
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Returns whether the values are equal.")
         .Details(
@@ -394,6 +460,12 @@ template <typename TArg1, typename TArg2 = TArg1>
 class NotEqualUDF : public udf::ScalarUDF {
  public:
   BoolValue Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1 != b2; }
+  void ExecBatch(FunctionContext*, size_t count, udf::NativeType<BoolValue>* out,
+                 const udf::NativeType<TArg1>* b1, const udf::NativeType<TArg2>* b2) {
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = b1[i] != b2[i];
+    }
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Returns whether the values are not equal.")
         .Details(
@@ -439,6 +511,12 @@ template <typename TArg1, typename TArg2 = TArg1>
 class GreaterThanUDF : public udf::ScalarUDF {
  public:
   BoolValue Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1 > b2; }
+  void ExecBatch(FunctionContext*, size_t count, udf::NativeType<BoolValue>* out,
+                 const udf::NativeType<TArg1>* b1, const udf::NativeType<TArg2>* b2) {
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = b1[i] > b2[i];
+    }
+  }
 
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
@@ -458,6 +536,12 @@ template <typename TArg1, typename TArg2 = TArg1>
 class GreaterThanEqualUDF : public udf::ScalarUDF {
  public:
   BoolValue Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1 >= b2; }
+  void ExecBatch(FunctionContext*, size_t count, udf::NativeType<BoolValue>* out,
+                 const udf::NativeType<TArg1>* b1, const udf::NativeType<TArg2>* b2) {
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = b1[i] >= b2[i];
+    }
+  }
 
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
@@ -478,6 +562,12 @@ template <typename TArg1, typename TArg2 = TArg1>
 class LessThanUDF : public udf::ScalarUDF {
  public:
   BoolValue Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1 < b2; }
+  void ExecBatch(FunctionContext*, size_t count, udf::NativeType<BoolValue>* out,
+                 const udf::NativeType<TArg1>* b1, const udf::NativeType<TArg2>* b2) {
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = b1[i] < b2[i];
+    }
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Returns which value is less than the other.")
         .Example(R"doc(# Implict call.
@@ -494,6 +584,12 @@ template <typename TArg1, typename TArg2 = TArg1>
 class LessThanEqualUDF : public udf::ScalarUDF {
  public:
   BoolValue Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1 <= b2; }
+  void ExecBatch(FunctionContext*, size_t count, udf::NativeType<BoolValue>* out,
+                 const udf::NativeType<TArg1>* b1, const udf::NativeType<TArg2>* b2) {
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = b1[i] <= b2[i];
+    }
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Returns which value is less than or equal to the the other.")
         .Example(R"doc(
@@ -552,6 +648,12 @@ class RoundUDF : public udf::ScalarUDF {
 class TimeToInt64UDF : public udf::ScalarUDF {
  public:
   Int64Value Exec(FunctionContext*, Time64NSValue value) { return value.val; }
+  void ExecBatch(FunctionContext*, size_t count, udf::NativeType<Int64Value>* out,
+                 const udf::NativeType<Time64NSValue>* value) {
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = value[i];
+    }
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Converts a time value to an int64 value")
         .Details(
@@ -568,6 +670,12 @@ class TimeToInt64UDF : public udf::ScalarUDF {
 class Int64ToTimeUDF : public udf::ScalarUDF {
  public:
   Time64NSValue Exec(FunctionContext*, Int64Value value) { return value.val; }
+  void ExecBatch(FunctionContext*, size_t count, udf::NativeType<Time64NSValue>* out,
+                 const udf::NativeType<Int64Value>* value) {
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = value[i];
+    }
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Converts a int64 value to a time")
         .Details(
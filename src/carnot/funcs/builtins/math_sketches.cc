@@ -16,6 +16,10 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <cmath>
+#include <limits>
+#include <string>
+#include <string_view>
 #include <vector>
 
 #include "src/carnot/funcs/builtins/math_sketches.h"
@@ -27,6 +31,12 @@ namespace builtins {
 void RegisterMathSketchesOrDie(udf::Registry* registry) {
   registry->RegisterOrDie<QuantilesUDA<types::Int64Value>>("quantiles");
   registry->RegisterOrDie<QuantilesUDA<types::Float64Value>>("quantiles");
+  registry->RegisterOrDie<ApproxCountDistinctUDA<types::Int64Value>>("approx_count_distinct");
+  registry->RegisterOrDie<ApproxCountDistinctUDA<types::Float64Value>>("approx_count_distinct");
+  registry->RegisterOrDie<ApproxCountDistinctUDA<types::StringValue>>("approx_count_distinct");
+  registry->RegisterOrDie<ApproxTopKUDA<types::Int64Value>>("approx_top_k");
+  registry->RegisterOrDie<ApproxTopKUDA<types::Float64Value>>("approx_top_k");
+  registry->RegisterOrDie<ApproxTopKUDA<types::StringValue>>("approx_top_k");
 }
 
 void WriteCentroidArray(rapidjson::Writer<rapidjson::StringBuffer>* writer,
@@ -52,6 +62,79 @@ std::vector<tdigest::Centroid> CentroidArrayFromJSON(const rapidjson::Value& val
   return centroids;
 }
 
+int64_t HyperLogLogEstimate(const uint8_t* registers, size_t num_registers) {
+  double m = static_cast<double>(num_registers);
+  double inverse_sum = 0;
+  int64_t num_zeros = 0;
+  for (size_t i = 0; i < num_registers; ++i) {
+    inverse_sum += std::ldexp(1.0, -registers[i]);
+    num_zeros += registers[i] == 0;
+  }
+  double alpha = 0.7213 / (1 + 1.079 / m);
+  double estimate = alpha * m * m / inverse_sum;
+  // Linear counting is more accurate while many of the registers are still empty.
+  if (estimate <= 2.5 * m && num_zeros > 0) {
+    estimate = m * std::log(m / static_cast<double>(num_zeros));
+  }
+  return std::llround(estimate);
+}
+
+void WriteSketchKey(rapidjson::Writer<rapidjson::StringBuffer>* writer, int64_t key) {
+  writer->Int64(key);
+}
+
+void WriteSketchKey(rapidjson::Writer<rapidjson::StringBuffer>* writer, double key) {
+  // JSON has no numbers for NaN and the infinities.
+  if (std::isnan(key)) {
+    writer->String("NaN");
+  } else if (std::isinf(key)) {
+    writer->String(key > 0 ? "Infinity" : "-Infinity");
+  } else {
+    writer->Double(key);
+  }
+}
+
+void WriteSketchKey(rapidjson::Writer<rapidjson::StringBuffer>* writer, const std::string& key) {
+  writer->String(key.data(), key.size());
+}
+
+bool SketchKeyFromJSON(const rapidjson::Value& val, int64_t* key) {
+  if (!val.IsInt64()) {
+    return false;
+  }
+  *key = val.GetInt64();
+  return true;
+}
+
+bool SketchKeyFromJSON(const rapidjson::Value& val, double* key) {
+  if (val.IsNumber()) {
+    *key = val.GetDouble();
+    return true;
+  }
+  if (!val.IsString()) {
+    return false;
+  }
+  std::string_view str(val.GetString(), val.GetStringLength());
+  if (str == "NaN") {
+    *key = std::numeric_limits<double>::quiet_NaN();
+  } else if (str == "Infinity") {
+    *key = std::numeric_limits<double>::infinity();
+  } else if (str == "-Infinity") {
+    *key = -std::numeric_limits<double>::infinity();
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool SketchKeyFromJSON(const rapidjson::Value& val, std::string* key) {
+  if (!val.IsString()) {
+    return false;
+  }
+  *key = std::string(val.GetString(), val.GetStringLength());
+  return true;
+}
+
 }  // namespace builtins
 }  // namespace carnot
 }  // namespace px
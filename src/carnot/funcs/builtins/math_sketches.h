@@ -20,11 +20,20 @@
 #include <rapidjson/document.h>
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/writer.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <string>
 #include <utility>
 #include <vector>
 
+#include <absl/container/flat_hash_map.h>
 #include "src/carnot/udf/registry.h"
 #include "src/common/base/error.h"
+#include "src/shared/types/hash_utils.h"
 #include "src/shared/types/types.h"
 #include "tdigest/tdigest.h"
 
@@ -37,6 +46,44 @@ void WriteCentroidArray(rapidjson::Writer<rapidjson::StringBuffer>* writer,
 
 std::vector<tdigest::Centroid> CentroidArrayFromJSON(const rapidjson::Value& val);
 
+/**
+ * @brief Estimates the number of distinct values from the registers of a HyperLogLog sketch.
+ */
+int64_t HyperLogLogEstimate(const uint8_t* registers, size_t num_registers);
+
+inline int64_t SketchKey(types::Int64Value val) { return val.val; }
+// All NaNs are counted as the same value.
+inline double SketchKey(types::Float64Value val) {
+  return std::isnan(val.val) ? std::numeric_limits<double>::quiet_NaN() : val.val;
+}
+inline const std::string& SketchKey(const types::StringValue& val) { return val; }
+
+// Compares sketch keys, with NaN equal to itself.
+template <typename TKey>
+struct SketchKeyEq : std::equal_to<TKey> {};
+
+template <>
+struct SketchKeyEq<double> {
+  bool operator()(double lhs, double rhs) const {
+    return lhs == rhs || (std::isnan(lhs) && std::isnan(rhs));
+  }
+};
+
+// Orders sketch keys, with NaN after all other values.
+inline bool SketchKeyLess(int64_t lhs, int64_t rhs) { return lhs < rhs; }
+inline bool SketchKeyLess(double lhs, double rhs) {
+  return std::isnan(rhs) ? !std::isnan(lhs) : lhs < rhs;
+}
+inline bool SketchKeyLess(const std::string& lhs, const std::string& rhs) { return lhs < rhs; }
+
+void WriteSketchKey(rapidjson::Writer<rapidjson::StringBuffer>* writer, int64_t key);
+void WriteSketchKey(rapidjson::Writer<rapidjson::StringBuffer>* writer, double key);
+void WriteSketchKey(rapidjson::Writer<rapidjson::StringBuffer>* writer, const std::string& key);
+
+bool SketchKeyFromJSON(const rapidjson::Value& val, int64_t* key);
+bool SketchKeyFromJSON(const rapidjson::Value& val, double* key);
+bool SketchKeyFromJSON(const rapidjson::Value& val, std::string* key);
+
 // TODO(zasgar): PL-419 Replace this when we add support for structs.
 template <typename TArg>
 class QuantilesUDA : public udf::UDA {
@@ -129,6 +176,290 @@ class QuantilesUDA : public udf::UDA {
   tdigest::TDigest digest_;
 };
 
+/**
+ * @brief Counts the distinct values with a HyperLogLog sketch, so that the partial aggregates have
+ * a fixed size, no matter how many distinct values there are.
+ */
+template <typename TArg>
+class ApproxCountDistinctUDA : public udf::UDA {
+ public:
+  // 2^12 registers give a standard error of about 1.6%.
+  static constexpr int kPrecision = 12;
+  static constexpr size_t kNumRegisters = 1 << kPrecision;
+
+  void Update(FunctionContext*, TArg val) {
+    uint64_t hash = types::utils::hash<TArg>()(val);
+    size_t idx = hash >> (64 - kPrecision);
+    // The rank is the position of the first set bit in the rest of the hash. Setting the last bit
+    // that is left after the shift caps the rank, and keeps clz away from zero.
+    uint64_t rest = (hash << kPrecision) | (1ULL << (kPrecision - 1));
+    uint8_t rank = __builtin_clzll(rest) + 1;
+    registers_[idx] = std::max(registers_[idx], rank);
+  }
+
+  void Merge(FunctionContext*, const ApproxCountDistinctUDA& other) {
+    for (size_t i = 0; i < kNumRegisters; ++i) {
+      registers_[i] = std::max(registers_[i], other.registers_[i]);
+    }
+  }
+
+  Int64Value Finalize(FunctionContext*) {
+    return HyperLogLogEstimate(registers_.data(), kNumRegisters);
+  }
+
+  StringValue Serialize(FunctionContext*) {
+    return StringValue(reinterpret_cast<const char*>(registers_.data()), kNumRegisters);
+  }
+
+  Status Deserialize(FunctionContext*, const StringValue& data) {
+    if (data.size() != kNumRegisters) {
+      return error::InvalidArgument("invalid serialized HyperLogLog of $0 bytes", data.size());
+    }
+    std::memcpy(registers_.data(), data.data(), kNumRegisters);
+    return Status::OK();
+  }
+
+  static udf::UDADocBuilder Doc() {
+    return udf::UDADocBuilder("Approximates the number of distinct values in the group.")
+        .Details(
+            "Estimates the number of distinct values with a "
+            "[HyperLogLog](https://en.wikipedia.org/wiki/HyperLogLog) sketch. The estimate is "
+            "usually within 2% of the exact count, and uses a fixed amount of memory, no matter "
+            "how many distinct values there are.")
+        .Example(R"doc(
+        | # Count the unique clients of each service.
+        | df = df.groupby('service').agg(clients=('remote_addr', px.approx_count_distinct))
+        )doc")
+        .Arg("val", "The values to count.")
+        .Returns("The approximate number of distinct values.");
+  }
+
+ protected:
+  std::array<uint8_t, kNumRegisters> registers_ = {};
+};
+
+/**
+ * @brief Finds the most frequent values with a SpaceSaving sketch, which counts at most
+ * kCapacity values at a time. The counters are kept in a min-heap by count, indexed by value, so
+ * that the smallest counter is found in constant time and updates take O(log kCapacity).
+ */
+template <typename TArg>
+class ApproxTopKUDA : public udf::UDA {
+  using Key = typename types::ValueTypeTraits<TArg>::native_type;
+
+ public:
+  static constexpr size_t kCapacity = 100;
+  static constexpr size_t kNumResults = 10;
+
+  void Update(FunctionContext*, TArg val) {
+    const auto& key = SketchKey(val);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+      size_t pos = it->second;
+      ++heap_[pos].counter.count;
+      SiftDown(pos);
+      return;
+    }
+    if (heap_.size() < kCapacity) {
+      index_.emplace(key, heap_.size());
+      heap_.push_back(Slot{key, Counter{1, 0}});
+      SiftUp(heap_.size() - 1);
+      return;
+    }
+    // The new value takes over the smallest counter, which might have counted it before.
+    Slot& min_slot = heap_.front();
+    index_.erase(min_slot.key);
+    int64_t min_count = min_slot.counter.count;
+    min_slot = Slot{key, Counter{min_count + 1, min_count}};
+    index_.emplace(key, 0);
+    SiftDown(0);
+  }
+
+  void Merge(FunctionContext*, const ApproxTopKUDA& other) {
+    // A value missing from a full sketch occurred at most as many times as its smallest count.
+    int64_t min_count = MinCount();
+    int64_t other_min_count = other.MinCount();
+    std::vector<Slot> merged;
+    merged.reserve(heap_.size() + other.heap_.size());
+    for (const auto& slot : heap_) {
+      auto other_it = other.index_.find(slot.key);
+      if (other_it == other.index_.end()) {
+        merged.push_back(Slot{slot.key, Counter{slot.counter.count + other_min_count,
+                                                slot.counter.error + other_min_count}});
+      } else {
+        const Counter& other_counter = other.heap_[other_it->second].counter;
+        merged.push_back(Slot{slot.key, Counter{slot.counter.count + other_counter.count,
+                                                slot.counter.error + other_counter.error}});
+      }
+    }
+    for (const auto& slot : other.heap_) {
+      if (!index_.contains(slot.key)) {
+        merged.push_back(Slot{slot.key, Counter{slot.counter.count + min_count,
+                                                slot.counter.error + min_count}});
+      }
+    }
+    if (merged.size() > kCapacity) {
+      SortSlots(&merged);
+      merged.resize(kCapacity);
+    }
+    Assign(std::move(merged));
+  }
+
+  StringValue Finalize(FunctionContext*) {
+    auto sorted = heap_;
+    SortSlots(&sorted);
+    rapidjson::StringBuffer sb;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+    writer.StartArray();
+    for (size_t i = 0; i < std::min(sorted.size(), kNumResults); ++i) {
+      writer.StartObject();
+      writer.Key("value");
+      WriteSketchKey(&writer, sorted[i].key);
+      writer.Key("count");
+      writer.Int64(sorted[i].counter.count);
+      writer.EndObject();
+    }
+    writer.EndArray();
+    return sb.GetString();
+  }
+
+  StringValue Serialize(FunctionContext*) {
+    rapidjson::StringBuffer sb;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+    writer.StartArray();
+    for (const auto& slot : heap_) {
+      writer.StartArray();
+      WriteSketchKey(&writer, slot.key);
+      writer.Int64(slot.counter.count);
+      writer.Int64(slot.counter.error);
+      writer.EndArray();
+    }
+    writer.EndArray();
+    return sb.GetString();
+  }
+
+  Status Deserialize(FunctionContext*, const StringValue& json) {
+    rapidjson::Document d;
+    rapidjson::ParseResult ok = d.Parse(json.data(), json.size());
+    if (ok == nullptr || !d.IsArray()) {
+      return error::InvalidArgument("invalid serialized top-k sketch");
+    }
+    absl::flat_hash_map<Key, Counter, absl::Hash<Key>, SketchKeyEq<Key>> counters;
+    for (const auto& entry : d.GetArray()) {
+      Key key;
+      if (!entry.IsArray() || entry.Size() != 3 || !SketchKeyFromJSON(entry[0], &key) ||
+          !entry[1].IsInt64() || !entry[2].IsInt64()) {
+        return error::InvalidArgument("invalid serialized top-k sketch");
+      }
+      counters[key] = Counter{entry[1].GetInt64(), entry[2].GetInt64()};
+    }
+    std::vector<Slot> slots;
+    slots.reserve(counters.size());
+    for (const auto& [key, counter] : counters) {
+      slots.push_back(Slot{key, counter});
+    }
+    Assign(std::move(slots));
+    return Status::OK();
+  }
+
+  static udf::UDADocBuilder Doc() {
+    return udf::UDADocBuilder("Approximates the most frequent values in the group.")
+        .Details(
+            "Finds the 10 most frequent values with a "
+            "[SpaceSaving](https://www.cs.ucsb.edu/sites/default/files/documents/2005-23.pdf) "
+            "sketch, which keeps at most 100 counters. The counts can be overestimated by at most "
+            "the number of values divided by 100. Returns a serialized JSON array of objects, "
+            "each with a `value` and a `count`, from the most to the least frequent. Float "
+            "values that aren't finite are returned as the strings `NaN`, `Infinity` and "
+            "`-Infinity`.")
+        .Example(R"doc(
+        | # Find the busiest clients of each service.
+        | df = df.groupby('service').agg(top_clients=('remote_addr', px.approx_top_k))
+        )doc")
+        .Arg("val", "The values to count.")
+        .Returns("The most frequent values and their counts, serialized as a JSON array.");
+  }
+
+ protected:
+  struct Counter {
+    int64_t count;
+    // How much of the count might come from the values that had the counter before.
+    int64_t error;
+  };
+
+  struct Slot {
+    Key key;
+    Counter counter;
+  };
+
+  int64_t MinCount() const {
+    if (heap_.size() < kCapacity) {
+      return 0;
+    }
+    return heap_.front().counter.count;
+  }
+
+  // Sorts the slots from the highest to the lowest count.
+  static void SortSlots(std::vector<Slot>* slots) {
+    std::sort(slots->begin(), slots->end(), [](const Slot& lhs, const Slot& rhs) {
+      if (lhs.counter.count != rhs.counter.count) {
+        return lhs.counter.count > rhs.counter.count;
+      }
+      return SketchKeyLess(lhs.key, rhs.key);
+    });
+  }
+
+  // Replaces the counters with `slots`.
+  void Assign(std::vector<Slot> slots) {
+    heap_ = std::move(slots);
+    index_.clear();
+    for (size_t i = 0; i < heap_.size(); ++i) {
+      index_[heap_[i].key] = i;
+    }
+    for (size_t i = heap_.size() / 2; i > 0; --i) {
+      SiftDown(i - 1);
+    }
+  }
+
+  void Swap(size_t i, size_t j) {
+    std::swap(heap_[i], heap_[j]);
+    index_[heap_[i].key] = i;
+    index_[heap_[j].key] = j;
+  }
+
+  void SiftUp(size_t pos) {
+    while (pos > 0) {
+      size_t parent = (pos - 1) / 2;
+      if (heap_[parent].counter.count <= heap_[pos].counter.count) {
+        return;
+      }
+      Swap(pos, parent);
+      pos = parent;
+    }
+  }
+
+  void SiftDown(size_t pos) {
+    while (true) {
+      size_t smallest = pos;
+      for (size_t child = 2 * pos + 1; child <= 2 * pos + 2 && child < heap_.size(); ++child) {
+        if (heap_[child].counter.count < heap_[smallest].counter.count) {
+          smallest = child;
+        }
+      }
+      if (smallest == pos) {
+        return;
+      }
+      Swap(pos, smallest);
+      pos = smallest;
+    }
+  }
+
+  // A min-heap of the counters by count.
+  std::vector<Slot> heap_;
+  // The position of each value's counter in heap_.
+  absl::flat_hash_map<Key, size_t, absl::Hash<Key>, SketchKeyEq<Key>> index_;
+};
+
 void RegisterMathSketchesOrDie(udf::Registry* registry);
 
 }  // namespace builtins
@@ -0,0 +1,133 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
+#include <absl/strings/str_cat.h>
+
+#include "src/carnot/funcs/builtins/math_sketches.h"
+
+namespace px {
+namespace carnot {
+namespace builtins {
+
+constexpr int64_t kNumRows = 1 << 16;
+
+// Returns kNumRows client addresses, with num_distinct distinct values.
+std::vector<types::StringValue> ClientAddresses(int64_t num_distinct) {
+  std::vector<types::StringValue> addrs;
+  addrs.reserve(kNumRows);
+  for (int64_t i = 0; i < kNumRows; ++i) {
+    // Skew the values, so that the small ones are the most frequent.
+    int64_t client = (i * i) % num_distinct;
+    addrs.emplace_back(absl::StrCat("10.0.", client / 256, ".", client % 256));
+  }
+  return addrs;
+}
+
+// The partial_bytes counter is the size of the partial aggregate that a PEM sends to Kelvin.
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_ApproxCountDistinct(benchmark::State& state) {
+  auto addrs = ClientAddresses(state.range(0));
+  int64_t partial_bytes = 0;
+  for (auto _ : state) {
+    ApproxCountDistinctUDA<types::StringValue> uda;
+    for (const auto& addr : addrs) {
+      uda.Update(nullptr, addr);
+    }
+    partial_bytes = uda.Serialize(nullptr).size();
+    benchmark::DoNotOptimize(uda.Finalize(nullptr));
+  }
+  state.counters["partial_bytes"] = partial_bytes;
+  state.SetItemsProcessed(kNumRows * state.iterations());
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_ExactCountDistinct(benchmark::State& state) {
+  auto addrs = ClientAddresses(state.range(0));
+  int64_t partial_bytes = 0;
+  for (auto _ : state) {
+    absl::flat_hash_set<std::string> distinct;
+    for (const auto& addr : addrs) {
+      distinct.insert(addr);
+    }
+    partial_bytes = 0;
+    for (const auto& addr : distinct) {
+      partial_bytes += addr.size();
+    }
+    benchmark::DoNotOptimize(distinct.size());
+  }
+  state.counters["partial_bytes"] = partial_bytes;
+  state.SetItemsProcessed(kNumRows * state.iterations());
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_ApproxTopK(benchmark::State& state) {
+  auto addrs = ClientAddresses(state.range(0));
+  int64_t partial_bytes = 0;
+  for (auto _ : state) {
+    ApproxTopKUDA<types::StringValue> uda;
+    for (const auto& addr : addrs) {
+      uda.Update(nullptr, addr);
+    }
+    partial_bytes = uda.Serialize(nullptr).size();
+    benchmark::DoNotOptimize(uda.Finalize(nullptr));
+  }
+  state.counters["partial_bytes"] = partial_bytes;
+  state.SetItemsProcessed(kNumRows * state.iterations());
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_ExactTopK(benchmark::State& state) {
+  auto addrs = ClientAddresses(state.range(0));
+  int64_t partial_bytes = 0;
+  for (auto _ : state) {
+    absl::flat_hash_map<std::string, int64_t> counts;
+    for (const auto& addr : addrs) {
+      ++counts[addr];
+    }
+    std::vector<std::pair<std::string, int64_t>> sorted(counts.begin(), counts.end());
+    size_t k = std::min(sorted.size(), ApproxTopKUDA<types::StringValue>::kNumResults);
+    std::partial_sort(sorted.begin(), sorted.begin() + k, sorted.end(),
+                      [](const auto& lhs, const auto& rhs) { return lhs.second > rhs.second; });
+    partial_bytes = 0;
+    for (const auto& [addr, count] : counts) {
+      partial_bytes += addr.size() + sizeof(count);
+    }
+    benchmark::DoNotOptimize(sorted.data());
+  }
+  state.counters["partial_bytes"] = partial_bytes;
+  state.SetItemsProcessed(kNumRows * state.iterations());
+}
+
+BENCHMARK(BM_ApproxCountDistinct)->RangeMultiplier(16)->Range(16, 1 << 16);
+BENCHMARK(BM_ExactCountDistinct)->RangeMultiplier(16)->Range(16, 1 << 16);
+BENCHMARK(BM_ApproxTopK)->RangeMultiplier(16)->Range(16, 1 << 16);
+BENCHMARK(BM_ExactTopK)->RangeMultiplier(16)->Range(16, 1 << 16);
+
+}  // namespace builtins
+}  // namespace carnot
+}  // namespace px
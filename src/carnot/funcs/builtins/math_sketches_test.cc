@@ -22,6 +22,11 @@
 
 #include <gtest/gtest.h>
 
+#include <limits>
+#include <string>
+
+#include <absl/strings/str_cat.h>
+
 #include "src/carnot/funcs/builtins/math_sketches.h"
 #include "src/carnot/udf/test_utils.h"
 #include "src/common/base/base.h"
@@ -108,6 +113,159 @@ TEST(MathSketches, quantiles_serde) {
   EXPECT_EQ(res_before_serde, res_after_serde);
 }
 
+TEST(MathSketches, approx_count_distinct_small) {
+  // Few distinct values are counted exactly.
+  udf::UDATester<ApproxCountDistinctUDA<types::StringValue>>()
+      .ForInput("a")
+      .ForInput("b")
+      .ForInput("a")
+      .ForInput("c")
+      .ForInput("b")
+      .Expect(3);
+}
+
+// The UDATester keeps a UDA per input to test merging, so the larger tests use the UDA directly.
+TEST(MathSketches, approx_count_distinct_large) {
+  ApproxCountDistinctUDA<types::Int64Value> uda;
+  for (int64_t i = 0; i < 100000; ++i) {
+    uda.Update(nullptr, i % 50000);
+  }
+  EXPECT_NEAR(uda.Finalize(nullptr).val, 50000, 50000 * 0.05);
+}
+
+TEST(MathSketches, approx_count_distinct_merge) {
+  ApproxCountDistinctUDA<types::StringValue> uda;
+  ApproxCountDistinctUDA<types::StringValue> other;
+  for (int64_t i = 0; i < 20000; ++i) {
+    uda.Update(nullptr, absl::StrCat("client", i));
+    other.Update(nullptr, absl::StrCat("client", i + 10000));
+  }
+  uda.Merge(nullptr, other);
+  EXPECT_NEAR(uda.Finalize(nullptr).val, 30000, 30000 * 0.05);
+}
+
+TEST(MathSketches, approx_count_distinct_serde) {
+  ApproxCountDistinctUDA<types::Int64Value> uda;
+  for (int64_t i = 0; i < 10000; ++i) {
+    uda.Update(nullptr, i);
+  }
+  ApproxCountDistinctUDA<types::Int64Value> new_uda;
+  EXPECT_OK(new_uda.Deserialize(nullptr, uda.Serialize(nullptr)));
+  EXPECT_EQ(uda.Finalize(nullptr).val, new_uda.Finalize(nullptr).val);
+
+  EXPECT_NOT_OK(new_uda.Deserialize(nullptr, "abc"));
+}
+
+TEST(MathSketches, approx_top_k) {
+  auto uda_tester = udf::UDATester<ApproxTopKUDA<types::StringValue>>();
+  // Many more values than counters, but only "a" and "b" occur often.
+  for (int64_t i = 0; i < 1000; ++i) {
+    uda_tester.ForInput(absl::StrCat("rare", i));
+    if (i % 2 == 0) {
+      uda_tester.ForInput("a");
+    }
+    if (i % 4 == 0) {
+      uda_tester.ForInput("b");
+    }
+  }
+  auto res = uda_tester.Result();
+  rapidjson::Document d;
+  d.Parse(res.data());
+  ASSERT_TRUE(d.IsArray());
+  ASSERT_EQ(d.Size(), ApproxTopKUDA<types::StringValue>::kNumResults);
+  EXPECT_EQ(std::string(d[0]["value"].GetString()), "a");
+  EXPECT_EQ(std::string(d[1]["value"].GetString()), "b");
+  // The counts are never underestimated, and overestimated by at most n / capacity.
+  EXPECT_GE(d[0]["count"].GetInt64(), 500);
+  EXPECT_LE(d[0]["count"].GetInt64(), 500 + 1750 / 100);
+  EXPECT_GE(d[1]["count"].GetInt64(), 250);
+}
+
+TEST(MathSketches, approx_top_k_exact) {
+  auto res = udf::UDATester<ApproxTopKUDA<types::Int64Value>>()
+                 .ForInput(200)
+                 .ForInput(404)
+                 .ForInput(200)
+                 .ForInput(500)
+                 .ForInput(200)
+                 .ForInput(404)
+                 .Result();
+  EXPECT_EQ(std::string(res),
+            R"([{"value":200,"count":3},{"value":404,"count":2},{"value":500,"count":1}])");
+}
+
+TEST(MathSketches, approx_top_k_float64) {
+  auto uda_tester = udf::UDATester<ApproxTopKUDA<types::Float64Value>>();
+  double nan = std::numeric_limits<double>::quiet_NaN();
+  uda_tester.ForInput(0.5).ForInput(nan).ForInput(-nan).ForInput(nan).ForInput(0.5).ForInput(
+      std::numeric_limits<double>::infinity());
+  auto res = uda_tester.Result();
+  // All NaNs are counted as one value.
+  EXPECT_EQ(std::string(res), R"([{"value":"NaN","count":3},{"value":0.5,"count":2},)"
+                              R"({"value":"Infinity","count":1}])");
+
+  auto new_uda_tester = udf::UDATester<ApproxTopKUDA<types::Float64Value>>();
+  EXPECT_OK(new_uda_tester.Deserialize(uda_tester.Serialize()));
+  EXPECT_EQ(res, new_uda_tester.Result());
+}
+
+TEST(MathSketches, approx_top_k_keeps_counters_ordered) {
+  auto uda_tester = udf::UDATester<ApproxTopKUDA<types::Int64Value>>();
+  // Values 0 to 9 occur 10 to 100 times, interleaved with 500 distinct values that keep
+  // replacing the smallest counter.
+  int64_t rare = 1000;
+  for (int64_t round = 0; round < 100; ++round) {
+    for (int64_t v = 0; v < 10; ++v) {
+      if (round < 10 * (v + 1)) {
+        uda_tester.ForInput(v);
+      }
+    }
+    for (int i = 0; i < 5; ++i) {
+      uda_tester.ForInput(rare++);
+    }
+  }
+  auto res = uda_tester.Result();
+  rapidjson::Document d;
+  d.Parse(res.data());
+  ASSERT_TRUE(d.IsArray());
+  ASSERT_EQ(d.Size(), ApproxTopKUDA<types::Int64Value>::kNumResults);
+  for (rapidjson::SizeType i = 0; i < d.Size(); ++i) {
+    EXPECT_EQ(d[i]["value"].GetInt64(), 9 - static_cast<int64_t>(i));
+    EXPECT_EQ(d[i]["count"].GetInt64(), 10 * (10 - static_cast<int64_t>(i)));
+  }
+}
+
+TEST(MathSketches, approx_top_k_merge) {
+  auto uda_tester = udf::UDATester<ApproxTopKUDA<types::Int64Value>>();
+  auto other_tester = udf::UDATester<ApproxTopKUDA<types::Int64Value>>();
+  for (int64_t i = 0; i < 1000; ++i) {
+    uda_tester.ForInput(1000 + i);
+    other_tester.ForInput(2000 + i);
+    if (i % 4 == 0) {
+      uda_tester.ForInput(1);
+      other_tester.ForInput(1);
+    }
+  }
+  uda_tester.Merge(&other_tester);
+  auto res = uda_tester.Result();
+  rapidjson::Document d;
+  d.Parse(res.data());
+  ASSERT_TRUE(d.IsArray());
+  EXPECT_EQ(d[0]["value"].GetInt64(), 1);
+  EXPECT_GE(d[0]["count"].GetInt64(), 500);
+}
+
+TEST(MathSketches, approx_top_k_serde) {
+  auto uda_tester = udf::UDATester<ApproxTopKUDA<types::StringValue>>();
+  auto res_before_serde =
+      uda_tester.ForInput("a").ForInput("b").ForInput("a").ForInput("c").Result();
+  auto new_uda_tester = udf::UDATester<ApproxTopKUDA<types::StringValue>>();
+  EXPECT_OK(new_uda_tester.Deserialize(uda_tester.Serialize()));
+  EXPECT_EQ(res_before_serde, new_uda_tester.Result());
+
+  EXPECT_NOT_OK(new_uda_tester.Deserialize("[[1, 2]]"));
+}
+
 }  // namespace builtins
 }  // namespace carnot
 }  // namespace px
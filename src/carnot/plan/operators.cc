@@ -75,6 +75,8 @@ std::unique_ptr<Operator> Operator::FromProto(const planpb::Operator& pb, int64_
       return CreateOperator<FilterOperator>(id, pb.filter_op());
     case planpb::LIMIT_OPERATOR:
       return CreateOperator<LimitOperator>(id, pb.limit_op());
+    case planpb::SORT_OPERATOR:
+      return CreateOperator<SortOperator>(id, pb.sort_op());
     case planpb::UNION_OPERATOR:
       return CreateOperator<UnionOperator>(id, pb.union_op());
     case planpb::JOIN_OPERATOR:
@@ -325,9 +327,23 @@ std::string GRPCSinkOperator::DebugString() const {
   } else if (has_grpc_source_id()) {
     destination = absl::Substitute("source_id=$0", grpc_source_id());
   }
+  if (partitioned()) {
+    return absl::Substitute("Op:GRPCSink(partitions=$0, partition_columns=[$1])", num_partitions(),
+                            absl::StrJoin(pb_.partition_column_indices(), ","));
+  }
   return absl::Substitute("Op:GRPCSink($0, $1)", address(), destination);
 }
 
+planpb::GRPCSinkOperator GRPCSinkOperator::PartitionPlan(int64_t partition) const {
+  DCHECK_LT(partition, num_partitions());
+  const auto& dest = pb_.partition_destinations(partition);
+  planpb::GRPCSinkOperator pb;
+  pb.set_address(dest.address());
+  pb.set_grpc_source_id(dest.grpc_source_id());
+  *pb.mutable_connection_options() = dest.connection_options();
+  return pb;
+}
+
 Status GRPCSinkOperator::Init(const planpb::GRPCSinkOperator& pb) {
   pb_ = pb;
   is_initialized_ = true;
@@ -454,6 +470,73 @@ StatusOr<table_store::schema::Relation> LimitOperator::OutputRelation(
   return output_relation;
 }
 
+/**
+ * Sort Operator Implementation.
+ */
+std::string SortOperator::DebugString() const {
+  std::vector<std::string> keys;
+  for (const auto& key : keys_) {
+    keys.push_back(absl::Substitute("$0 $1", key.index, key.ascending ? "asc" : "desc"));
+  }
+  return absl::Substitute("Op:Sort(keys: [$0], limit: $1, cols: [$2])", absl::StrJoin(keys, ","),
+                          limit_, absl::StrJoin(selected_cols_, ","));
+}
+
+Status SortOperator::Init(const planpb::SortOperator& pb) {
+  pb_ = pb;
+  limit_ = pb_.limit();
+  if (limit_ < 0) {
+    return error::InvalidArgument("Sort limit must not be negative, got $0", limit_);
+  }
+
+  keys_.reserve(pb_.keys_size());
+  for (const auto& key : pb_.keys()) {
+    keys_.push_back({key.column().index(), key.ascending()});
+  }
+
+  selected_cols_.reserve(pb_.columns_size());
+  for (const auto& col : pb_.columns()) {
+    selected_cols_.push_back(col.index());
+  }
+
+  is_initialized_ = true;
+  return Status::OK();
+}
+
+StatusOr<table_store::schema::Relation> SortOperator::OutputRelation(
+    const table_store::schema::Schema& schema, const PlanState& /*state*/,
+    const std::vector<int64_t>& input_ids) const {
+  DCHECK(is_initialized_) << "Not initialized";
+
+  if (input_ids.size() != 1) {
+    return error::InvalidArgument("Sort operator must have exactly one input");
+  }
+  if (!schema.HasRelation(input_ids[0])) {
+    return error::NotFound("Missing relation ($0) for input of SortOperator", input_ids[0]);
+  }
+
+  PX_ASSIGN_OR_RETURN(const table_store::schema::Relation& input_relation,
+                      schema.GetRelation(input_ids[0]));
+  auto num_columns = static_cast<int64_t>(input_relation.NumColumns());
+  for (const auto& key : keys_) {
+    if (key.index >= num_columns) {
+      return error::InvalidArgument("Sort key index $0 is out of bounds, number of columns is $1",
+                                    key.index, num_columns);
+    }
+  }
+  table_store::schema::Relation output_relation;
+  for (auto selected_col_idx : selected_cols_) {
+    if (selected_col_idx >= num_columns) {
+      return error::InvalidArgument("Column index $0 is out of bounds, number of columns is $1",
+                                    selected_col_idx, num_columns);
+    }
+    output_relation.AddColumn(input_relation.GetColumnType(selected_col_idx),
+                              input_relation.GetColumnName(selected_col_idx),
+                              input_relation.GetColumnDesc(selected_col_idx));
+  }
+  return output_relation;
+}
+
 /**
  * Zip Operator Implementation.
  */
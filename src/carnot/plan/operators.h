@@ -97,6 +97,9 @@ class MemorySourceOperator : public Operator {
   std::vector<int64_t> Columns() const { return column_idxs_; }
   const types::TabletID& Tablet() const { return pb_.tablet(); }
   bool streaming() const { return pb_.streaming(); }
+  const google::protobuf::RepeatedPtrField<planpb::ColumnPredicate>& predicates() const {
+    return pb_.predicates();
+  }
 
  private:
   planpb::MemorySourceOperator pb_;
@@ -146,6 +149,7 @@ class AggregateOperator : public Operator {
   bool windowed() const { return pb_.windowed(); }
   bool partial_agg() const { return pb_.partial_agg(); }
   bool finalize_results() const { return pb_.finalize_results(); }
+  const planpb::AggregateOperator& pb() const { return pb_; }
 
  private:
   std::vector<std::shared_ptr<AggregateExpression>> values_;
@@ -217,6 +221,20 @@ class GRPCSinkOperator : public Operator {
   }
   std::string table_name() const { return pb_.output_table().table_name(); }
 
+  // Whether the sink hash partitions its rows over several destinations.
+  bool partitioned() const { return pb_.partition_destinations_size() > 0; }
+  int64_t num_partitions() const { return pb_.partition_destinations_size(); }
+  std::vector<int64_t> partition_column_indices() const {
+    return std::vector<int64_t>(pb_.partition_column_indices().begin(),
+                                pb_.partition_column_indices().end());
+  }
+
+  /**
+   * Returns the plan of an unpartitioned sink, which sends its rows to the destination of the
+   * given partition.
+   */
+  planpb::GRPCSinkOperator PartitionPlan(int64_t partition) const;
+
  private:
   planpb::GRPCSinkOperator pb_;
 };
@@ -264,6 +282,33 @@ class LimitOperator : public Operator {
   planpb::LimitOperator pb_;
 };
 
+class SortOperator : public Operator {
+ public:
+  struct SortKey {
+    int64_t index;
+    bool ascending;
+  };
+
+  explicit SortOperator(int64_t id) : Operator(id, planpb::SORT_OPERATOR) {}
+  ~SortOperator() override = default;
+
+  StatusOr<table_store::schema::Relation> OutputRelation(
+      const table_store::schema::Schema& schema, const PlanState& state,
+      const std::vector<int64_t>& input_ids) const override;
+  Status Init(const planpb::SortOperator& pb);
+  std::string DebugString() const override;
+  const std::vector<int64_t>& selected_cols() const { return selected_cols_; }
+  const std::vector<SortKey>& keys() const { return keys_; }
+  // The number of rows to keep, or 0 if all of the rows are kept.
+  int64_t limit() const { return limit_; }
+
+ private:
+  std::vector<SortKey> keys_;
+  int64_t limit_ = 0;
+  std::vector<int64_t> selected_cols_;
+  planpb::SortOperator pb_;
+};
+
 class UnionOperator : public Operator {
  public:
   explicit UnionOperator(int64_t id) : Operator(id, planpb::UNION_OPERATOR) {}
@@ -25,6 +25,7 @@
 
 #include "src/carnot/planner/compiler/analyzer/add_limit_to_batch_result_sink_rule.h"
 #include "src/carnot/planner/compiler/analyzer/combine_consecutive_maps_rule.h"
+#include "src/carnot/planner/compiler/analyzer/combine_sort_limit_rule.h"
 #include "src/carnot/planner/compiler/analyzer/convert_metadata_rule.h"
 #include "src/carnot/planner/compiler/analyzer/drop_to_map_rule.h"
 #include "src/carnot/planner/compiler/analyzer/merge_group_by_into_group_acceptor_rule.h"
@@ -90,6 +91,11 @@ class Analyzer : public RuleExecutor<IR> {
     consecutive_maps->AddRule<CombineConsecutiveMapsRule>();
   }
 
+  void CreateCombineSortLimitBatch() {
+    RuleBatch* sort_limit = CreateRuleBatch<FailOnMax>("CombineSortLimit", 2);
+    sort_limit->AddRule<CombineSortLimitRule>();
+  }
+
   void CreateDataTypeResolutionBatch() {
     RuleBatch* intermediate_resolution_batch =
         CreateRuleBatch<FailOnMax>("DataTypeResolution", 100);
@@ -124,6 +130,7 @@ class Analyzer : public RuleExecutor<IR> {
     CreateUniqueSinkNamesBatch();
     CreateAddLimitToBatchResultSinkBatch();
     CreateCombineConsecutiveMapsRule();
+    CreateCombineSortLimitBatch();
     CreateDataTypeResolutionBatch();
     CreateManageColumnAccessBatch();
     CreateMetadataConversionBatch();
@@ -0,0 +1,65 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <algorithm>
+
+#include "src/carnot/planner/compiler/analyzer/combine_sort_limit_rule.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace compiler {
+
+StatusOr<bool> CombineSortLimitRule::Apply(IRNode* ir_node) {
+  if (!Match(ir_node, Limit())) {
+    return false;
+  }
+  auto limit = static_cast<LimitIR*>(ir_node);
+  // PEM-only limits are not blocking, they only cut down the data each PEM sends.
+  if (limit->pem_only() || !limit->limit_value_set()) {
+    return false;
+  }
+  CHECK_EQ(limit->parents().size(), 1UL);
+  auto parent_op = limit->parents()[0];
+  if (!Match(parent_op, Sort())) {
+    return false;
+  }
+  auto sort = static_cast<SortIR*>(parent_op);
+  // The other children of the sort still need all of its rows.
+  if (sort->Children().size() > 1) {
+    return false;
+  }
+
+  int64_t new_limit = limit->limit_value();
+  if (sort->has_limit()) {
+    new_limit = std::min(new_limit, sort->limit());
+  }
+  sort->SetLimit(new_limit);
+
+  PX_RETURN_IF_ERROR(limit->RemoveParent(sort));
+  for (auto child : limit->Children()) {
+    PX_RETURN_IF_ERROR(child->ReplaceParent(limit, sort));
+  }
+  PX_RETURN_IF_ERROR(limit->graph()->DeleteNode(limit->id()));
+  return true;
+}
+
+}  // namespace compiler
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include "src/carnot/planner/compiler/analyzer/combine_sort_limit_rule.h"
+#include "src/carnot/planner/compiler/test_utils.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace compiler {
+
+using ::testing::ElementsAre;
+
+using CombineSortLimitRuleTest = RulesTest;
+TEST_F(CombineSortLimitRuleTest, basic) {
+  MemorySourceIR* mem_src = MakeMemSource();
+  auto sort = MakeSort(mem_src, {"cpu0"}, {false});
+  auto limit = MakeLimit(sort, 10);
+  auto limit_id = limit->id();
+  auto sink = MakeMemSink(limit, "abc");
+
+  CombineSortLimitRule rule;
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  ASSERT_TRUE(result.ConsumeValueOrDie());
+
+  EXPECT_FALSE(graph->HasNode(limit_id));
+  EXPECT_THAT(sort->Children(), ElementsAre(sink));
+  EXPECT_EQ(10, sort->limit());
+}
+
+TEST_F(CombineSortLimitRuleTest, keeps_smaller_limit) {
+  MemorySourceIR* mem_src = MakeMemSource();
+  auto sort = MakeSort(mem_src, {"cpu0"}, {false}, 5);
+  auto limit = MakeLimit(sort, 10);
+  MakeMemSink(limit, "abc");
+
+  CombineSortLimitRule rule;
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  ASSERT_TRUE(result.ConsumeValueOrDie());
+  EXPECT_EQ(5, sort->limit());
+}
+
+TEST_F(CombineSortLimitRuleTest, sort_with_other_children) {
+  MemorySourceIR* mem_src = MakeMemSource();
+  auto sort = MakeSort(mem_src, {"cpu0"}, {false});
+  auto limit = MakeLimit(sort, 10);
+  MakeMemSink(limit, "abc");
+  MakeMemSink(sort, "def");
+
+  CombineSortLimitRule rule;
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_FALSE(result.ConsumeValueOrDie());
+  EXPECT_TRUE(graph->HasNode(limit->id()));
+  EXPECT_FALSE(sort->has_limit());
+}
+
+TEST_F(CombineSortLimitRuleTest, pem_only_limit) {
+  MemorySourceIR* mem_src = MakeMemSource();
+  auto sort = MakeSort(mem_src, {"cpu0"}, {false});
+  auto limit = MakeLimit(sort, 10, /*pem_only*/ true);
+  MakeMemSink(limit, "abc");
+
+  CombineSortLimitRule rule;
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_FALSE(result.ConsumeValueOrDie());
+  EXPECT_TRUE(graph->HasNode(limit->id()));
+}
+
+}  // namespace compiler
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
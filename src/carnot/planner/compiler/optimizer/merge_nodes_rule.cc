@@ -203,6 +203,15 @@ bool MergeNodesRule::CanMerge(OperatorIR* a, OperatorIR* b) {
     DCHECK_EQ(1U, b->parents().size());
     return limit_a->limit_value() == limit_b->limit_value() &&
            a->parents()[0]->resolved_table_type()->Equals(b->parents()[0]->resolved_table_type());
+  } else if (Match(a, Sort())) {
+    auto sort_a = static_cast<SortIR*>(a);
+    auto sort_b = static_cast<SortIR*>(b);
+    // Sort's output type mirrors its input parent type, like Limit.
+    DCHECK_EQ(1U, a->parents().size());
+    DCHECK_EQ(1U, b->parents().size());
+    return EqualStringVector(sort_a->sort_columns(), sort_b->sort_columns()) &&
+           sort_a->ascending() == sort_b->ascending() && sort_a->limit() == sort_b->limit() &&
+           a->parents()[0]->resolved_table_type()->Equals(b->parents()[0]->resolved_table_type());
   }
   VLOG(1) << "Can't match, so excluding from merge." << a->DebugString();
   return false;
@@ -367,6 +376,11 @@ StatusOr<OperatorIR*> MergeNodesRule::MergeOps(IR* graph,
     PX_ASSIGN_OR_RETURN(LimitIR * new_limit, graph->CopyNode(limit));
     PX_RETURN_IF_ERROR(new_limit->CopyParentsFrom(limit));
     merged_op = new_limit;
+  } else if (Match(base_op, Sort())) {
+    SortIR* sort = static_cast<SortIR*>(base_op);
+    PX_ASSIGN_OR_RETURN(SortIR * new_sort, graph->CopyNode(sort));
+    PX_RETURN_IF_ERROR(new_sort->CopyParentsFrom(sort));
+    merged_op = new_sort;
   } else {
     return base_op->CreateIRNodeError("Can't optimize $0", base_op->DebugString());
   }
@@ -177,15 +177,43 @@ StatusOr<SchemaToAgentsMap> LoadSchemaMap(
   return agent_schema_map;
 }
 
+std::vector<CarnotInfo> CoordinatorImpl::GetPartitionKelvins() const {
+  std::vector<CarnotInfo> kelvins;
+  for (const auto& carnot_info : remote_processor_nodes_) {
+    if (static_cast<int64_t>(kelvins.size()) >= distributed_state_->max_partition_kelvins()) {
+      break;
+    }
+    // Kelvins that also store data get a PEM plan instead.
+    if (!carnot_info.has_data_store()) {
+      kelvins.push_back(carnot_info);
+    }
+  }
+  return kelvins;
+}
+
 StatusOr<std::unique_ptr<DistributedPlan>> CoordinatorImpl::CoordinateImpl(const IR* logical_plan) {
   PX_ASSIGN_OR_RETURN(std::unique_ptr<Splitter> splitter,
                       Splitter::Create(compiler_state_, /* support_partial_agg */ false));
   PX_ASSIGN_OR_RETURN(std::unique_ptr<BlockingSplitPlan> split_plan,
                       splitter->SplitKelvinAndAgents(logical_plan));
+
+  auto partition_kelvins = GetPartitionKelvins();
+  if (partition_kelvins.size() > 1) {
+    PX_ASSIGN_OR_RETURN(std::unique_ptr<PartitionSplitPlan> partition_split,
+                        splitter->SplitKelvinPartitions(split_plan->original_plan.get()));
+    if (!partition_split->partition_columns.empty()) {
+      PX_ASSIGN_OR_RETURN(
+          std::unique_ptr<DistributedPlan> distributed_plan,
+          CoordinatePartitions(*split_plan, *partition_split, partition_kelvins));
+      if (distributed_plan != nullptr) {
+        return distributed_plan;
+      }
+    }
+  }
+
   auto distributed_plan = std::make_unique<DistributedPlan>();
   PX_ASSIGN_OR_RETURN(int64_t remote_node_id, distributed_plan->AddCarnot(GetRemoteProcessor()));
   // TODO(philkuz) Need to update the Blocking Split Plan to better represent what we expect.
-  // TODO(philkuz) (PL-1469) Future support for grabbing data from multiple Kelvin nodes.
 
   PX_ASSIGN_OR_RETURN(std::unique_ptr<IR> remote_plan_uptr, split_plan->original_plan->Clone());
   CarnotInstance* remote_carnot = distributed_plan->Get(remote_node_id);
@@ -194,19 +222,106 @@ StatusOr<std::unique_ptr<DistributedPlan>> CoordinatorImpl::CoordinateImpl(const
   remote_carnot->AddPlan(remote_plan);
   distributed_plan->AddPlan(std::move(remote_plan_uptr));
 
+  PX_ASSIGN_OR_RETURN(auto agent_schema_map,
+                      AddDataStores(split_plan->before_blocking.get(), {remote_node_id},
+                                    distributed_plan.get()));
+
+  // Prune unnecessary sources from the Kelvin plan.
+  DistributedPruneUnavailableSourcesRule prune_sources_rule(agent_schema_map);
+  PX_RETURN_IF_ERROR(prune_sources_rule.Apply(remote_carnot));
+
+  distributed_plan->SetKelvin(remote_carnot);
+  return distributed_plan;
+}
+
+StatusOr<std::unique_ptr<DistributedPlan>> CoordinatorImpl::CoordinatePartitions(
+    const BlockingSplitPlan& split_plan, const PartitionSplitPlan& partition_split,
+    const std::vector<CarnotInfo>& kelvin_infos) {
+  auto distributed_plan = std::make_unique<DistributedPlan>();
+  std::vector<CarnotInstance*> kelvins;
+  std::vector<int64_t> kelvin_ids;
+  for (const auto& [partition, kelvin_info] : Enumerate(kelvin_infos)) {
+    PX_ASSIGN_OR_RETURN(int64_t kelvin_id, distributed_plan->AddCarnot(kelvin_info));
+    CarnotInstance* kelvin = distributed_plan->Get(kelvin_id);
+    // The first Kelvin gathers the output of the partitions, and also runs partition 0.
+    const IR* kelvin_plan =
+        partition == 0 ? partition_split.gather_plan.get() : partition_split.partition_plan.get();
+    PX_ASSIGN_OR_RETURN(std::unique_ptr<IR> kelvin_plan_uptr, kelvin_plan->Clone());
+    for (IRNode* node : kelvin_plan_uptr->FindNodesOfType(IRNodeType::kGRPCSourceGroup)) {
+      auto group = static_cast<GRPCSourceGroupIR*>(node);
+      if (partition_split.partition_columns.contains(group->source_id())) {
+        group->SetPartition(partition);
+      }
+    }
+    kelvin->AddPlan(kelvin_plan_uptr.get());
+    distributed_plan->AddPlan(std::move(kelvin_plan_uptr));
+    if (partition > 0) {
+      distributed_plan->AddEdge(kelvin, kelvins[0]);
+      distributed_plan->AddPartitionKelvin(kelvin);
+    }
+    kelvins.push_back(kelvin);
+    kelvin_ids.push_back(kelvin_id);
+  }
+
+  PX_ASSIGN_OR_RETURN(auto agent_schema_map,
+                      AddDataStores(split_plan.before_blocking.get(), kelvin_ids,
+                                    distributed_plan.get()));
+
+  DistributedPruneUnavailableSourcesRule prune_sources_rule(agent_schema_map);
+  PX_RETURN_IF_ERROR(prune_sources_rule.Apply(kelvins[0]));
+  // Sources that run on the gather Kelvin, such as some UDTFs, would also have to partition their
+  // output over the Kelvins. That isn't supported, so those queries run on a single Kelvin.
+  for (IRNode* node : kelvins[0]->plan()->FindNodesOfType(IRNodeType::kGRPCSink)) {
+    auto sink = static_cast<GRPCSinkIR*>(node);
+    if (sink->has_destination_id() &&
+        partition_split.partition_columns.contains(sink->destination_id())) {
+      return std::unique_ptr<DistributedPlan>(nullptr);
+    }
+  }
+
+  // The PEMs partition their output by the partition columns of the source group they feed.
+  for (const auto& [pem_plan, agents] : distributed_plan->plan_to_agent_map()) {
+    for (IRNode* node : pem_plan->FindNodesOfType(IRNodeType::kGRPCSink)) {
+      auto sink = static_cast<GRPCSinkIR*>(node);
+      if (!sink->has_destination_id() ||
+          !partition_split.partition_columns.contains(sink->destination_id())) {
+        continue;
+      }
+      const auto& col_names = sink->resolved_table_type()->ColumnNames();
+      std::vector<int64_t> partition_cols;
+      for (const auto& col_name : partition_split.partition_columns.at(sink->destination_id())) {
+        auto col_iter = std::find(col_names.begin(), col_names.end(), col_name);
+        if (col_iter == col_names.end()) {
+          return sink->CreateIRNodeError("Partition column '$0' not found in '$1'", col_name,
+                                         sink->DebugString());
+        }
+        partition_cols.push_back(col_iter - col_names.begin());
+      }
+      sink->SetPartitionColumns(partition_cols);
+    }
+  }
+
+  distributed_plan->SetKelvin(kelvins[0]);
+  return distributed_plan;
+}
+
+StatusOr<SchemaToAgentsMap> CoordinatorImpl::AddDataStores(IR* pem_plan,
+                                                           const std::vector<int64_t>& kelvin_ids,
+                                                           DistributedPlan* distributed_plan) {
   std::vector<int64_t> source_node_ids;
-  for (const auto& [i, data_store_info] : Enumerate(data_store_nodes_)) {
+  for (const auto& data_store_info : data_store_nodes_) {
     PX_ASSIGN_OR_RETURN(int64_t source_node_id, distributed_plan->AddCarnot(data_store_info));
-    distributed_plan->AddEdge(source_node_id, remote_node_id);
+    for (int64_t kelvin_id : kelvin_ids) {
+      distributed_plan->AddEdge(source_node_id, kelvin_id);
+    }
     source_node_ids.push_back(source_node_id);
   }
 
   PX_ASSIGN_OR_RETURN(auto agent_schema_map,
                       LoadSchemaMap(*distributed_state_, distributed_plan->uuid_to_id_map()));
 
-  PX_ASSIGN_OR_RETURN(auto agent_to_plan_map,
-                      GetUniquePEMPlans(split_plan->before_blocking.get(), distributed_plan.get(),
-                                        source_node_ids, agent_schema_map));
+  PX_ASSIGN_OR_RETURN(auto agent_to_plan_map, GetUniquePEMPlans(pem_plan, distributed_plan,
+                                                                source_node_ids, agent_schema_map));
 
   // Add the PEM plans to the distributed plan.
   for (const auto carnot_id : source_node_ids) {
@@ -220,15 +335,8 @@ StatusOr<std::unique_ptr<DistributedPlan>> CoordinatorImpl::CoordinateImpl(const
   for (size_t i = 0; i < agent_to_plan_map.plan_pool.size(); ++i) {
     distributed_plan->AddPlan(std::move(agent_to_plan_map.plan_pool[i]));
   }
-
-  // Prune unnecessary sources from the Kelvin plan.
-  DistributedPruneUnavailableSourcesRule prune_sources_rule(agent_schema_map);
-  PX_RETURN_IF_ERROR(prune_sources_rule.Apply(remote_carnot));
-
-  distributed_plan->SetKelvin(remote_carnot);
   distributed_plan->AddPlanToAgentMap(std::move(agent_to_plan_map.plan_to_agents));
-
-  return distributed_plan;
+  return agent_schema_map;
 }
 
 }  // namespace distributed
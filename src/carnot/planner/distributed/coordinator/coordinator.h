@@ -24,6 +24,7 @@
 
 #include <absl/container/flat_hash_map.h>
 #include "src/carnot/planner/distributed/distributed_plan/distributed_plan.h"
+#include "src/carnot/planner/distributed/splitter/splitter.h"
 #include "src/carnot/planner/ir/ir.h"
 #include "src/carnot/planner/ir/pattern_match.h"
 
@@ -82,6 +83,9 @@ class Coordinator : public NotCopyable {
  * @brief This coordinator creates a plan layout with 1 remote processor getting data
  * from N sources. If the passed in plan has special conditions, it will split differntly.
  *
+ * When the distributed state allows several Kelvins per query, and the plan has aggregates by
+ * group or joins that can be partitioned, the PEMs instead hash partition their output over up to
+ * max_partition_kelvins Kelvins, and the first of them gathers the output of the others.
  */
 class CoordinatorImpl : public Coordinator {
  protected:
@@ -92,6 +96,15 @@ class CoordinatorImpl : public Coordinator {
 
  private:
   const distributedpb::CarnotInfo& GetRemoteProcessor() const;
+  // The Kelvins that a partitioned query can run on.
+  std::vector<CarnotInfo> GetPartitionKelvins() const;
+  // Returns nullptr if the plan can't run on partitions after all.
+  StatusOr<std::unique_ptr<DistributedPlan>> CoordinatePartitions(
+      const BlockingSplitPlan& split_plan, const PartitionSplitPlan& partition_split,
+      const std::vector<CarnotInfo>& kelvin_infos);
+  // Adds the data store Carnots, with their plans and an edge to each of the Kelvins.
+  StatusOr<SchemaToAgentsMap> AddDataStores(IR* pem_plan, const std::vector<int64_t>& kelvin_ids,
+                                            DistributedPlan* distributed_plan);
   bool HasExecutableNodes(const IR* plan);
 
   // Nodes that have a source of data.
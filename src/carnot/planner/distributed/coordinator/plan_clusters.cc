@@ -35,6 +35,33 @@ namespace carnot {
 namespace planner {
 namespace distributed {
 
+// Deletes the subtree of op_id, and then the ancestors that are left without any children.
+Status DeleteSubtreeAndDeadAncestors(IR* ir, int64_t op_id) {
+  std::queue<int64_t> ancestor_to_maybe_delete_q;
+  // Read the parents from the graph, because a join might already have lost one of its parents.
+  for (int64_t p : ir->dag().ParentsOf(op_id)) {
+    ancestor_to_maybe_delete_q.push(p);
+  }
+
+  PX_RETURN_IF_ERROR(ir->DeleteSubtree(op_id));
+  while (!ancestor_to_maybe_delete_q.empty()) {
+    int64_t ancestor_id = ancestor_to_maybe_delete_q.front();
+    ancestor_to_maybe_delete_q.pop();
+    if (!ir->HasNode(ancestor_id)) {
+      continue;
+    }
+    // If all the children have been deleted, clean up the ancestor.
+    if (static_cast<OperatorIR*>(ir->Get(ancestor_id))->Children().size() != 0) {
+      continue;
+    }
+    for (int64_t p : ir->dag().ParentsOf(ancestor_id)) {
+      ancestor_to_maybe_delete_q.push(p);
+    }
+    PX_RETURN_IF_ERROR(ir->DeleteSubtree(ancestor_id));
+  }
+  return Status::OK();
+}
+
 StatusOr<std::unique_ptr<IR>> PlanCluster::CreatePlan(const IR* base_query) const {
   // TODO(philkuz) invert this so we don't clone everything.
   PX_ASSIGN_OR_RETURN(std::unique_ptr<IR> new_ir, base_query->Clone());
@@ -46,23 +73,20 @@ StatusOr<std::unique_ptr<IR>> PlanCluster::CreatePlan(const IR* base_query) cons
     auto cur_op = new_ir->Get(op->id());
     CHECK(cur_op != nullptr);
     CHECK(Match(cur_op, Operator()));
-    std::queue<OperatorIR*> ancestor_to_maybe_delete_q;
-    for (const auto& p : static_cast<OperatorIR*>(new_ir->Get(op->id()))->parents()) {
-      ancestor_to_maybe_delete_q.push(p);
-    }
+    PX_RETURN_IF_ERROR(DeleteSubtreeAndDeadAncestors(new_ir.get(), op->id()));
+  }
 
-    PX_RETURN_IF_ERROR(new_ir->DeleteSubtree(op->id()));
-    while (!ancestor_to_maybe_delete_q.empty()) {
-      OperatorIR* ancestor = ancestor_to_maybe_delete_q.front();
-      ancestor_to_maybe_delete_q.pop();
-      // If all the children have been deleted, clean up the ancestor.
-      if (ancestor->Children().size() != 0) {
-        continue;
-      }
-      for (const auto& p : ancestor->parents()) {
-        ancestor_to_maybe_delete_q.push(p);
+  // A join that runs on the PEMs has nothing to output once one of its inputs is removed, so it
+  // is removed along with the rest of its inputs.
+  bool removed_join = true;
+  while (removed_join) {
+    removed_join = false;
+    for (IRNode* join : new_ir->FindNodesOfType(IRNodeType::kJoin)) {
+      if (new_ir->dag().ParentsOf(join->id()).size() < 2) {
+        PX_RETURN_IF_ERROR(DeleteSubtreeAndDeadAncestors(new_ir.get(), join->id()));
+        removed_join = true;
+        break;
       }
-      PX_RETURN_IF_ERROR(new_ir->DeleteSubtree(ancestor->id()));
     }
   }
   return new_ir;
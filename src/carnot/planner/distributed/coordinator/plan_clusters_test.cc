@@ -64,6 +64,23 @@ TEST_F(PlanClustersTest, create_plan) {
             pem_plan->FindNodesThatMatch(Operator()).size());
 }
 
+TEST_F(PlanClustersTest, create_plan_removes_join_missing_input) {
+  auto left_src = MakeMemSource();
+  auto right_src = MakeMemSource();
+  auto join = MakeJoin({left_src, right_src}, "inner", MakeRelation(), MakeRelation(),
+                       {"count"}, {"count"}, {"", "_right"});
+  MakeMemSink(join, "out");
+
+  // Without the left input, the join and the rest of the plan have nothing to do.
+  PlanCluster left_cluster({1}, {left_src});
+  ASSERT_OK_AND_ASSIGN(auto left_plan, left_cluster.CreatePlan(graph.get()));
+  EXPECT_TRUE(left_plan->FindNodesThatMatch(Operator()).empty());
+
+  PlanCluster right_cluster({2}, {right_src});
+  ASSERT_OK_AND_ASSIGN(auto right_plan, right_cluster.CreatePlan(graph.get()));
+  EXPECT_TRUE(right_plan->FindNodesThatMatch(Operator()).empty());
+}
+
 TEST_F(PlanClustersTest, cluster_operators) {
   auto mem_src = MakeMemSource();
   auto filter = MakeFilter(MakeMemSource(), MakeEqualsFunc(MakeColumn("cpu", 0), MakeInt(10)));
@@ -147,6 +147,16 @@ class DistributedPlan {
     kelvin_ = kelvin;
   }
 
+  /**
+   * @brief Adds a Kelvin that runs a partition of the plan of a query that is partitioned over
+   * several Kelvins. The Kelvin set by SetKelvin() gathers the output of these Kelvins, and runs
+   * partition 0 itself, so the partition of the i-th Kelvin added here is i + 1.
+   */
+  void AddPartitionKelvin(CarnotInstance* kelvin) {
+    DCHECK(id_to_node_map_.contains(kelvin->id()));
+    partition_kelvins_.push_back(kelvin);
+  }
+
   void SetExecutionCompleteAddress(const std::string& grpc_address,
                                    const std::string& ssl_targetname) {
     exec_complete_address_ = grpc_address;
@@ -163,12 +173,14 @@ class DistributedPlan {
   }
 
   CarnotInstance* kelvin() const { return kelvin_; }
+  const std::vector<CarnotInstance*>& partition_kelvins() const { return partition_kelvins_; }
 
  private:
   plan::DAG dag_;
   absl::flat_hash_map<int64_t, std::unique_ptr<CarnotInstance>> id_to_node_map_;
   absl::flat_hash_map<IR*, absl::flat_hash_set<int64_t>> plan_to_agent_map_;
   CarnotInstance* kelvin_ = nullptr;
+  std::vector<CarnotInstance*> partition_kelvins_;
   std::vector<std::unique_ptr<IR>> plan_pool_;
   absl::flat_hash_map<int64_t, IR*> agent_to_plan_map_;
   absl::flat_hash_map<sole::uuid, int64_t> uuid_to_id_map_;
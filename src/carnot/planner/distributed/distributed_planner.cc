@@ -48,23 +48,39 @@ Status StitchPlan(DistributedPlan* distributed_plan) {
   auto remote_node_id = remote_carnot->id();
   IR* remote_plan = remote_carnot->plan();
   DCHECK(remote_plan);
+  const auto& partition_kelvins = distributed_plan->partition_kelvins();
 
   DistributedSetSourceGroupGRPCAddressRule set_grpc_address_rule;
   PX_RETURN_IF_ERROR(set_grpc_address_rule.Apply(remote_carnot));
+  for (CarnotInstance* partition_kelvin : partition_kelvins) {
+    PX_RETURN_IF_ERROR(set_grpc_address_rule.Apply(partition_kelvin));
+  }
 
   // Connect the plans.
   for (const auto& [plan, agents] : distributed_plan->plan_to_agent_map()) {
     PX_ASSIGN_OR_RETURN(auto did_connect_plan, AssociateDistributedPlanEdgesRule::ConnectGraphs(
                                                    plan, agents, remote_plan));
     DCHECK(did_connect_plan);
+    // When the query is partitioned, the PEMs send a partition of their output to each Kelvin.
+    for (CarnotInstance* partition_kelvin : partition_kelvins) {
+      PX_RETURN_IF_ERROR(
+          AssociateDistributedPlanEdgesRule::ConnectGraphs(plan, agents, partition_kelvin->plan()));
+    }
+  }
+  for (CarnotInstance* partition_kelvin : partition_kelvins) {
+    PX_RETURN_IF_ERROR(AssociateDistributedPlanEdgesRule::ConnectGraphs(
+        partition_kelvin->plan(), {partition_kelvin->id()}, remote_plan));
   }
 
   // TODO(philkuz) make this connect to self without a grpc bridge.
   PX_RETURN_IF_ERROR(
       AssociateDistributedPlanEdgesRule::ConnectGraphs(remote_plan, {remote_node_id}, remote_plan));
 
-  // Expand GRPCSourceGroups in the remote_plan.
+  // Expand GRPCSourceGroups in the Kelvin plans.
   GRPCSourceGroupConversionRule conversion_rule;
+  for (CarnotInstance* partition_kelvin : partition_kelvins) {
+    PX_RETURN_IF_ERROR(conversion_rule.Execute(partition_kelvin->plan()));
+  }
   PX_RETURN_IF_ERROR(conversion_rule.Execute(remote_plan));
   return MergeSameNodeGRPCBridgeRule(remote_node_id).Execute(remote_plan).status();
 }
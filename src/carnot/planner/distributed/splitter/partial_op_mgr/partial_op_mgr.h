@@ -87,6 +87,23 @@ class LimitOperatorMgr : public PartialOperatorMgr {
                                             OperatorIR* op) const override;
 };
 
+/**
+ * @brief TopKOperatorMgr manages splitting sorts with a limit over the boundary. Each PEM only
+ * sends its own top rows, which is all the merging top-k on the Kelvin needs.
+ */
+class TopKOperatorMgr : public PartialOperatorMgr {
+ public:
+  bool Matches(OperatorIR* op) const override {
+    if (!Match(op, Sort())) {
+      return false;
+    }
+    return static_cast<SortIR*>(op)->has_limit();
+  }
+  StatusOr<OperatorIR*> CreatePrepareOperator(IR* plan, OperatorIR* op) const override;
+  StatusOr<OperatorIR*> CreateMergeOperator(IR* plan, OperatorIR* new_parent,
+                                            OperatorIR* op) const override;
+};
+
 /**
  * @brief AggOperatorMgr manages splitting aggregates into partial aggregate and the merging node
  * over a network boundary.
@@ -0,0 +1,129 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <optional>
+#include <utility>
+
+#include "src/carnot/planner/distributed/splitter/presplit_optimizer/memory_source_predicate_rule.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace distributed {
+
+namespace {
+
+std::optional<planpb::ColumnPredicate::Op> PredicateOp(FuncIR::Opcode opcode) {
+  switch (opcode) {
+    case FuncIR::Opcode::eq:
+      return planpb::ColumnPredicate::EQUAL;
+    case FuncIR::Opcode::neq:
+      return planpb::ColumnPredicate::NOT_EQUAL;
+    case FuncIR::Opcode::lt:
+      return planpb::ColumnPredicate::LESS_THAN;
+    case FuncIR::Opcode::lteq:
+      return planpb::ColumnPredicate::LESS_THAN_EQUAL;
+    case FuncIR::Opcode::gt:
+      return planpb::ColumnPredicate::GREATER_THAN;
+    case FuncIR::Opcode::gteq:
+      return planpb::ColumnPredicate::GREATER_THAN_EQUAL;
+    default:
+      return std::nullopt;
+  }
+}
+
+// Returns the equivalent op when the operands are swapped, ie. `a OP b` == `b Flip(OP) a`.
+planpb::ColumnPredicate::Op Flip(planpb::ColumnPredicate::Op op) {
+  switch (op) {
+    case planpb::ColumnPredicate::LESS_THAN:
+      return planpb::ColumnPredicate::GREATER_THAN;
+    case planpb::ColumnPredicate::LESS_THAN_EQUAL:
+      return planpb::ColumnPredicate::GREATER_THAN_EQUAL;
+    case planpb::ColumnPredicate::GREATER_THAN:
+      return planpb::ColumnPredicate::LESS_THAN;
+    case planpb::ColumnPredicate::GREATER_THAN_EQUAL:
+      return planpb::ColumnPredicate::LESS_THAN_EQUAL;
+    default:
+      return op;
+  }
+}
+
+}  // namespace
+
+Status MemorySourcePredicateRule::CollectPredicates(
+    ExpressionIR* expr, std::vector<MemorySourceIR::ColumnPredicate>* predicates) {
+  if (!Match(expr, Func())) {
+    return Status::OK();
+  }
+  auto func = static_cast<FuncIR*>(expr);
+  if (func->all_args().size() != 2) {
+    return Status::OK();
+  }
+  if (func->opcode() == FuncIR::Opcode::logand) {
+    // Every conjunct must hold for a row to match, so each of them can be used separately.
+    for (ExpressionIR* arg : func->all_args()) {
+      PX_RETURN_IF_ERROR(CollectPredicates(arg, predicates));
+    }
+    return Status::OK();
+  }
+  auto op = PredicateOp(func->opcode());
+  if (!op.has_value()) {
+    return Status::OK();
+  }
+  ExpressionIR* lhs = func->all_args()[0];
+  ExpressionIR* rhs = func->all_args()[1];
+  if (Match(lhs, DataNode()) && Match(rhs, ColumnNode())) {
+    std::swap(lhs, rhs);
+    op = Flip(op.value());
+  }
+  if (!Match(lhs, ColumnNode()) || !Match(rhs, DataNode())) {
+    return Status::OK();
+  }
+  MemorySourceIR::ColumnPredicate predicate;
+  predicate.col_name = static_cast<ColumnIR*>(lhs)->col_name();
+  predicate.op = op.value();
+  PX_RETURN_IF_ERROR(static_cast<DataIR*>(rhs)->ToProto(&predicate.value));
+  predicates->push_back(std::move(predicate));
+  return Status::OK();
+}
+
+StatusOr<bool> MemorySourcePredicateRule::Apply(IRNode* ir_node) {
+  if (!Match(ir_node, MemorySource())) {
+    return false;
+  }
+  auto src = static_cast<MemorySourceIR*>(ir_node);
+  std::vector<MemorySourceIR::ColumnPredicate> predicates;
+  // Walk the chain of filters that directly follow the source. Once the chain branches, filters
+  // only apply to some of the source's consumers, so they can't be used.
+  OperatorIR* op = src;
+  while (op->Children().size() == 1 && Match(op->Children()[0], Filter())) {
+    auto filter = static_cast<FilterIR*>(op->Children()[0]);
+    PX_RETURN_IF_ERROR(CollectPredicates(filter->filter_expr(), &predicates));
+    op = filter;
+  }
+  if (predicates.empty() && src->predicates().empty()) {
+    return false;
+  }
+  src->SetPredicates(std::move(predicates));
+  return true;
+}
+
+}  // namespace distributed
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
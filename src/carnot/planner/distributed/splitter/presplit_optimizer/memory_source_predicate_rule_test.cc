@@ -0,0 +1,106 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "src/carnot/planner/compiler/test_utils.h"
+#include "src/carnot/planner/distributed/splitter/presplit_optimizer/memory_source_predicate_rule.h"
+#include "src/carnot/planner/test_utils.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace distributed {
+
+class MemorySourcePredicateRuleTest : public testutils::DistributedRulesTest {
+ protected:
+  FuncIR* MakeBinaryFunc(const std::string& op, ExpressionIR* left, ExpressionIR* right) {
+    return graph
+        ->CreateNode<FuncIR>(ast, FuncIR::op_map.find(op)->second,
+                             std::vector<ExpressionIR*>({left, right}))
+        .ConsumeValueOrDie();
+  }
+
+  Relation relation_{
+      std::vector<types::DataType>{types::DataType::INT64, types::DataType::STRING,
+                                   types::DataType::FLOAT64},
+      std::vector<std::string>{"latency", "req_path", "cpu"}};
+};
+
+TEST_F(MemorySourcePredicateRuleTest, filter_chain) {
+  MemorySourceIR* src = MakeMemSource(relation_);
+  FilterIR* filter1 = MakeFilter(
+      src, MakeAndFunc(MakeBinaryFunc(">", MakeColumn("latency", 0), MakeInt(100)),
+                       MakeEqualsFunc(MakeString("/healthz"), MakeColumn("req_path", 0))));
+  // The literal is on the left, so the comparison must be flipped.
+  FilterIR* filter2 =
+      MakeFilter(filter1, MakeBinaryFunc("<", MakeFloat(0.5), MakeColumn("cpu", 0)));
+  MakeMemSink(filter2, "foo", {});
+
+  MemorySourcePredicateRule rule(compiler_state_.get());
+  ASSERT_OK_AND_ASSIGN(bool changed, rule.Execute(graph.get()));
+  EXPECT_TRUE(changed);
+
+  const auto& predicates = src->predicates();
+  ASSERT_EQ(3, predicates.size());
+  EXPECT_EQ("latency", predicates[0].col_name);
+  EXPECT_EQ(planpb::ColumnPredicate::GREATER_THAN, predicates[0].op);
+  EXPECT_EQ(100, predicates[0].value.int64_value());
+  EXPECT_EQ("req_path", predicates[1].col_name);
+  EXPECT_EQ(planpb::ColumnPredicate::EQUAL, predicates[1].op);
+  EXPECT_EQ("/healthz", predicates[1].value.string_value());
+  EXPECT_EQ("cpu", predicates[2].col_name);
+  EXPECT_EQ(planpb::ColumnPredicate::GREATER_THAN, predicates[2].op);
+  EXPECT_EQ(0.5, predicates[2].value.float64_value());
+  // The filters must stay in the plan.
+  EXPECT_EQ(std::vector<OperatorIR*>{filter1}, src->Children());
+}
+
+TEST_F(MemorySourcePredicateRuleTest, unsupported_exprs) {
+  MemorySourceIR* src = MakeMemSource(relation_);
+  FilterIR* filter = MakeFilter(
+      src, MakeOrFunc(MakeBinaryFunc(">", MakeColumn("latency", 0), MakeInt(100)),
+                      MakeEqualsFunc(MakeColumn("req_path", 0), MakeString("/healthz"))));
+  MakeMemSink(filter, "foo", {});
+
+  MemorySourcePredicateRule rule(compiler_state_.get());
+  ASSERT_OK_AND_ASSIGN(bool changed, rule.Execute(graph.get()));
+  EXPECT_FALSE(changed);
+  EXPECT_TRUE(src->predicates().empty());
+}
+
+TEST_F(MemorySourcePredicateRuleTest, branching_source) {
+  MemorySourceIR* src = MakeMemSource(relation_);
+  FilterIR* filter = MakeFilter(src, MakeEqualsFunc(MakeColumn("latency", 0), MakeInt(100)));
+  MakeMemSink(filter, "foo", {});
+  // The second sink reads every row, so the source can't skip any data.
+  MakeMemSink(src, "bar", {});
+
+  MemorySourcePredicateRule rule(compiler_state_.get());
+  ASSERT_OK_AND_ASSIGN(bool changed, rule.Execute(graph.get()));
+  EXPECT_FALSE(changed);
+  EXPECT_TRUE(src->predicates().empty());
+}
+
+}  // namespace distributed
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
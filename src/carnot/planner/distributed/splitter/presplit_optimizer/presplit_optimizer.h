@@ -22,6 +22,7 @@
 #include "src/carnot/planner/compiler_state/compiler_state.h"
 #include "src/carnot/planner/distributed/splitter/presplit_optimizer/filter_push_down_rule.h"
 #include "src/carnot/planner/distributed/splitter/presplit_optimizer/limit_push_down_rule.h"
+#include "src/carnot/planner/distributed/splitter/presplit_optimizer/memory_source_predicate_rule.h"
 #include "src/carnot/planner/rules/rule_executor.h"
 
 namespace px {
@@ -60,9 +61,16 @@ class PreSplitOptimizer : public RuleExecutor<IR> {
     filter_pushdown->AddRule<FilterPushdownRule>(compiler_state_);
   }
 
+  void CreateMemorySourcePredicateBatch() {
+    // Must run after filter pushdown, so that it sees filters in their final position.
+    RuleBatch* source_predicates = CreateRuleBatch<DoOnce>("MemorySourcePredicates");
+    source_predicates->AddRule<MemorySourcePredicateRule>(compiler_state_);
+  }
+
   Status Init() {
     CreateLimitPushdownBatch();
     CreateFilterPushdownBatch();
+    CreateMemorySourcePredicateBatch();
     return Status::OK();
   }
 
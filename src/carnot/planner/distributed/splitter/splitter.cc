@@ -33,20 +33,96 @@ namespace carnot {
 namespace planner {
 namespace distributed {
 
+bool IsUPIDColumn(OperatorIR* parent, ColumnIR* col) {
+  auto col_type_or_s = parent->resolved_table_type()->GetColumnType(col->col_name());
+  if (!col_type_or_s.ok() || !col_type_or_s.ValueOrDie()->IsValueType()) {
+    return false;
+  }
+  auto value_type = std::static_pointer_cast<ValueType>(col_type_or_s.ConsumeValueOrDie());
+  return value_type->semantic_type() == types::ST_UPID;
+}
+
+// Returns whether op and all of its ancestors run on the PEMs without blocking, and form a single
+// chain up from a MemorySource.
+StatusOr<bool> IsPEMLocalChain(CompilerState* compiler_state, OperatorIR* op) {
+  while (true) {
+    PX_ASSIGN_OR_RETURN(bool runs_on_pem,
+                        ScalarUDFsRunOnPEMRule::OperatorUDFsRunOnPEM(compiler_state, op));
+    if (!runs_on_pem || op->IsBlocking() || op->Children().size() != 1) {
+      return false;
+    }
+    if (Match(op, MemorySource())) {
+      return true;
+    }
+    if (op->parents().size() != 1) {
+      return false;
+    }
+    op = op->parents()[0];
+  }
+}
+
+/**
+ * @brief Returns whether op is an inner join that can run on each PEM before the data is sent to
+ * Kelvin. A UPID contains the ASID of the agent that the process runs on, so when the join keys
+ * include a UPID on both sides, every matching pair of rows is already on the same PEM.
+ *
+ * This is the only join that runs on the PEMs. Joins with a small build side (a UDTF, a small
+ * table such as process_stats, or an aggregate) still run on Kelvin, because the planner has no
+ * table statistics to tell which side is small, and PEMs run no GRPC server that Kelvin could
+ * broadcast the small side to.
+ */
+StatusOr<bool> IsColocatedJoin(CompilerState* compiler_state, OperatorIR* op) {
+  if (!Match(op, Join())) {
+    return false;
+  }
+  auto join = static_cast<JoinIR*>(op);
+  const auto& parents = join->parents();
+  // An outer join has to see every row of its input, which a PEM that is missing one of the
+  // tables can't do.
+  if (join->join_type() != JoinIR::JoinType::kInner || parents.size() != 2 ||
+      parents[0] == parents[1] ||
+      join->left_on_columns().size() != join->right_on_columns().size()) {
+    return false;
+  }
+  bool joins_on_upid = false;
+  for (size_t i = 0; i < join->left_on_columns().size(); ++i) {
+    ColumnIR* left_col = join->left_on_columns()[i];
+    ColumnIR* right_col = join->right_on_columns()[i];
+    if (IsUPIDColumn(parents[left_col->container_op_parent_idx()], left_col) &&
+        IsUPIDColumn(parents[right_col->container_op_parent_idx()], right_col)) {
+      joins_on_upid = true;
+      break;
+    }
+  }
+  if (!joins_on_upid) {
+    return false;
+  }
+  for (OperatorIR* parent : parents) {
+    PX_ASSIGN_OR_RETURN(bool pem_local, IsPEMLocalChain(compiler_state, parent));
+    if (!pem_local) {
+      return false;
+    }
+  }
+  return true;
+}
+
 StatusOr<bool> OperatorMustRunOnKelvin(CompilerState* compiler_state, OperatorIR* op) {
   // If the operator can't run on a PEM, or is a blocking operator, we should
   // schedule this node to run on a Kelvin.
   PX_ASSIGN_OR_RETURN(bool runs_on_pem,
                       ScalarUDFsRunOnPEMRule::OperatorUDFsRunOnPEM(compiler_state, op));
-  return !runs_on_pem || op->IsBlocking();
+  if (!runs_on_pem) {
+    return true;
+  }
+  PX_ASSIGN_OR_RETURN(bool colocated_join, IsColocatedJoin(compiler_state, op));
+  return op->IsBlocking() && !colocated_join;
 }
 
 StatusOr<bool> OperatorCanRunOnPEM(CompilerState* compiler_state, OperatorIR* op) {
   // If the operator can't run on a Kelvin, and is not a blocking operator, we can
   // schedule this node to run on a PEM.
-  PX_ASSIGN_OR_RETURN(bool runs_on_pem,
-                      ScalarUDFsRunOnPEMRule::OperatorUDFsRunOnPEM(compiler_state, op));
-  return runs_on_pem && !op->IsBlocking();
+  PX_ASSIGN_OR_RETURN(bool must_run_on_kelvin, OperatorMustRunOnKelvin(compiler_state, op));
+  return !must_run_on_kelvin;
 }
 
 BlockingSplitNodeIDGroups Splitter::GetSplitGroups(
@@ -468,6 +544,142 @@ StatusOr<std::unique_ptr<IR>> Splitter::CreateGRPCBridgePlan(
   return grpc_bridge_plan;
 }
 
+StatusOr<types::DataType> ColumnDataType(OperatorIR* op, const std::string& col_name) {
+  PX_ASSIGN_OR_RETURN(TypePtr col_type, op->resolved_table_type()->GetColumnType(col_name));
+  if (!col_type->IsValueType()) {
+    return error::Internal("Column '$0' of $1 doesn't have a value type", col_name,
+                           op->DebugString());
+  }
+  return std::static_pointer_cast<ValueType>(col_type)->data_type();
+}
+
+// Returns whether op reads straight from a GRPCSourceGroup that doesn't feed any other operator.
+bool ReadsOnlyFromGRPCSourceGroup(OperatorIR* parent, OperatorIR* op) {
+  return Match(parent, GRPCSourceGroup()) && parent->Children().size() == 1 &&
+         parent->Children()[0] == op;
+}
+
+/**
+ * @brief Returns the partition columns of each GRPCSourceGroup that feeds op, if op only needs
+ * the rows with equal keys to be together. Returns an empty map if op can't be partitioned.
+ */
+StatusOr<absl::flat_hash_map<GRPCSourceGroupIR*, std::vector<std::string>>> PartitionColumnsOf(
+    OperatorIR* op) {
+  absl::flat_hash_map<GRPCSourceGroupIR*, std::vector<std::string>> partition_columns;
+  if (Match(op, BlockingAgg())) {
+    auto agg = static_cast<BlockingAggIR*>(op);
+    if (agg->groups().empty() || !ReadsOnlyFromGRPCSourceGroup(agg->parents()[0], agg)) {
+      return partition_columns;
+    }
+    auto group = static_cast<GRPCSourceGroupIR*>(agg->parents()[0]);
+    for (ColumnIR* col : agg->groups()) {
+      partition_columns[group].push_back(col->col_name());
+    }
+    return partition_columns;
+  }
+
+  if (!Match(op, Join())) {
+    return partition_columns;
+  }
+  auto join = static_cast<JoinIR*>(op);
+  const auto& parents = join->parents();
+  if (parents.size() != 2 || parents[0] == parents[1] ||
+      !ReadsOnlyFromGRPCSourceGroup(parents[0], join) ||
+      !ReadsOnlyFromGRPCSourceGroup(parents[1], join) ||
+      join->left_on_columns().size() != join->right_on_columns().size() ||
+      join->left_on_columns().empty()) {
+    return partition_columns;
+  }
+  // Both sides have to hash the same key values to the same partition, so the key columns are
+  // partitioned in the same order, and must have the same types.
+  for (size_t i = 0; i < join->left_on_columns().size(); ++i) {
+    ColumnIR* left_col = join->left_on_columns()[i];
+    ColumnIR* right_col = join->right_on_columns()[i];
+    auto left = static_cast<GRPCSourceGroupIR*>(parents[left_col->container_op_parent_idx()]);
+    auto right = static_cast<GRPCSourceGroupIR*>(parents[right_col->container_op_parent_idx()]);
+    if (left == right) {
+      return absl::flat_hash_map<GRPCSourceGroupIR*, std::vector<std::string>>{};
+    }
+    PX_ASSIGN_OR_RETURN(types::DataType left_type, ColumnDataType(left, left_col->col_name()));
+    PX_ASSIGN_OR_RETURN(types::DataType right_type, ColumnDataType(right, right_col->col_name()));
+    if (left_type != right_type) {
+      return absl::flat_hash_map<GRPCSourceGroupIR*, std::vector<std::string>>{};
+    }
+    partition_columns[left].push_back(left_col->col_name());
+    partition_columns[right].push_back(right_col->col_name());
+  }
+  return partition_columns;
+}
+
+StatusOr<std::unique_ptr<PartitionSplitPlan>> Splitter::SplitKelvinPartitions(
+    const IR* grpc_bridge_plan) {
+  PX_ASSIGN_OR_RETURN(std::unique_ptr<IR> plan, grpc_bridge_plan->Clone());
+  auto split_plan = std::make_unique<PartitionSplitPlan>();
+
+  // Collect the operators first, because inserting the bridges adds nodes to the plan.
+  std::vector<OperatorIR*> ops;
+  for (IRNode* node : plan->FindNodesThatMatch(Operator())) {
+    ops.push_back(static_cast<OperatorIR*>(node));
+  }
+  for (OperatorIR* op : ops) {
+    PX_ASSIGN_OR_RETURN(auto partition_columns, PartitionColumnsOf(op));
+    if (partition_columns.empty()) {
+      continue;
+    }
+    // Maps and Filters only look at one row at a time, so they also run on the partitions, to
+    // send less data to the gather Kelvin.
+    OperatorIR* last_partitioned_op = op;
+    while (last_partitioned_op->Children().size() == 1 &&
+           (Match(last_partitioned_op->Children()[0], Map()) ||
+            Match(last_partitioned_op->Children()[0], Filter()))) {
+      last_partitioned_op = last_partitioned_op->Children()[0];
+    }
+    std::vector<OperatorIR*> gather_children = last_partitioned_op->Children();
+    if (gather_children.empty()) {
+      continue;
+    }
+    for (const auto& [group, columns] : partition_columns) {
+      split_plan->partition_columns[group->source_id()] = columns;
+    }
+
+    PX_ASSIGN_OR_RETURN(GRPCSinkIR * grpc_sink,
+                        CreateGRPCSink(last_partitioned_op, grpc_id_counter_));
+    PX_ASSIGN_OR_RETURN(GRPCSourceGroupIR * grpc_source_group,
+                        CreateGRPCSourceGroup(last_partitioned_op, grpc_id_counter_));
+    DCHECK_EQ(grpc_sink->destination_id(), grpc_source_group->source_id());
+    for (OperatorIR* child : gather_children) {
+      PX_RETURN_IF_ERROR(child->ReplaceParent(last_partitioned_op, grpc_source_group));
+    }
+    ++grpc_id_counter_;
+  }
+  if (split_plan->partition_columns.empty()) {
+    return split_plan;
+  }
+
+  // The new bridges cut the partitioned operators off from the rest of the plan, so the
+  // partition plan is made of the subgraphs that contain a partitioned GRPCSourceGroup.
+  absl::flat_hash_set<int64_t> gather_only_nodes;
+  for (auto& node_set : plan->IndependentGraphs()) {
+    bool is_partitioned = false;
+    for (int64_t node_id : node_set) {
+      IRNode* node = plan->Get(node_id);
+      if (Match(node, GRPCSourceGroup()) &&
+          split_plan->partition_columns.contains(
+              static_cast<GRPCSourceGroupIR*>(node)->source_id())) {
+        is_partitioned = true;
+        break;
+      }
+    }
+    if (!is_partitioned) {
+      gather_only_nodes.merge(node_set);
+    }
+  }
+  PX_ASSIGN_OR_RETURN(split_plan->partition_plan, plan->Clone());
+  PX_RETURN_IF_ERROR(split_plan->partition_plan->Prune(gather_only_nodes));
+  split_plan->gather_plan = std::move(plan);
+  return split_plan;
+}
+
 StatusOr<GRPCSinkIR*> Splitter::CreateGRPCSink(OperatorIR* parent_op, int64_t grpc_id) {
   DCHECK(parent_op->is_type_resolved()) << parent_op->DebugString();
   IR* graph = parent_op->graph();
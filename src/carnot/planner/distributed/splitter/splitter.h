@@ -58,6 +58,26 @@ struct BlockingSplitPlan {
   std::unique_ptr<IR> original_plan;
 };
 
+/**
+ * @brief The Kelvin part of a plan, split so that the aggregates by group and the joins run on
+ * several Kelvins, each of which receives a hash partition of the PEM output.
+ *
+ * partition_plan: runs on every Kelvin that receives a partition. Its sources are the
+ * GRPCSourceGroups fed by partitioned GRPCSinks, and it sinks data into GRPCSinks to the gather
+ * plan.
+ *
+ * gather_plan: runs on the Kelvin that gathers the output of the partitions. It has the whole
+ * plan, including the partition_plan, so the gather Kelvin also receives a partition.
+ */
+struct PartitionSplitPlan {
+  std::unique_ptr<IR> partition_plan;
+  std::unique_ptr<IR> gather_plan;
+  // The names of the columns that the GRPCSinks feeding each partitioned GRPCSourceGroup hash to
+  // pick a partition, keyed by the source id of the GRPCSourceGroup. Empty if no part of the plan
+  // can be partitioned.
+  absl::flat_hash_map<int64_t, std::vector<std::string>> partition_columns;
+};
+
 /**
  * @brief Two sets of nodes that correspond to the nodes of the original plan for those
  * that occur before blocking nodes and those that occur after.
@@ -110,6 +130,45 @@ class Splitter : public NotCopyable {
    */
   StatusOr<std::unique_ptr<BlockingSplitPlan>> SplitKelvinAndAgents(const IR* logical_plan);
 
+  /**
+   * @brief Splits the Kelvin part of a plan so that it can run on several Kelvins. An aggregate
+   * by group, or a join, that reads straight from GRPCSourceGroups only needs the rows with the
+   * same group or join key together, so the PEMs can hash partition their rows by those keys
+   * over several Kelvins. This inserts a second GRPCBridge after each such operator and after
+   * any Maps and Filters that follow it, to gather the partitions back on a single Kelvin.
+   *
+   * Graphically, we convert the following plan, the original_plan of SplitKelvinAndAgents():
+   * GRPCSource(1)
+   *  |
+   * Agg(by=service)
+   *  |
+   * Map
+   *  |
+   * Sink
+   *
+   * Into
+   * GRPCSource(1)
+   *  |
+   * Agg(by=service)
+   *  |
+   * Map
+   *  |
+   * GRPCSink(2)
+   *
+   * GRPCSource(2)
+   *  |
+   * Sink
+   *
+   * Where the GRPCSinks feeding GRPCSource(1) are partitioned by "service".
+   *
+   * This must be called on the Splitter that split the plan, so that the new bridges get unused
+   * ids.
+   *
+   * @param grpc_bridge_plan: the original_plan of a BlockingSplitPlan.
+   * @return StatusOr<std::unique_ptr<PartitionSplitPlan>>
+   */
+  StatusOr<std::unique_ptr<PartitionSplitPlan>> SplitKelvinPartitions(const IR* grpc_bridge_plan);
+
   static StatusOr<std::unique_ptr<Splitter>> Create(CompilerState* compiler_state,
                                                     bool support_partial_agg) {
     std::unique_ptr<Splitter> splitter = std::unique_ptr<Splitter>(new Splitter(compiler_state));
@@ -124,6 +183,7 @@ class Splitter : public NotCopyable {
       partial_operator_mgrs_.push_back(std::make_unique<AggOperatorMgr>());
     }
     partial_operator_mgrs_.push_back(std::make_unique<LimitOperatorMgr>());
+    partial_operator_mgrs_.push_back(std::make_unique<TopKOperatorMgr>());
     return Status::OK();
   }
   /**
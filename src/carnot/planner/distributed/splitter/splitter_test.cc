@@ -567,6 +567,174 @@ TEST_F(SplitterTest, agg_join_children) {
   EXPECT_EQ(join_parent->source_id(), grpc_sink->destination_id());
 }
 
+TEST_F(SplitterTest, partition_agg_test) {
+  auto mem_src = MakeMemSource("cpu", cpu_relation);
+  auto mean_func = MakeMeanFuncWithFloatType(MakeColumn("cpu0", 0, types::DataType::FLOAT64));
+  auto agg = MakeBlockingAgg(mem_src, {MakeColumn("count", 0, types::DataType::INT64)},
+                             {{"cpu0_mean", mean_func}});
+  auto map = MakeMap(agg, {{"count", MakeColumn("count", 0)}});
+  auto sink = MakeMemSink(map, "out");
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  auto splitter_or_s = Splitter::Create(compiler_state_.get(), /* perform_partial_agg */ false);
+  ASSERT_OK(splitter_or_s);
+  std::unique_ptr<Splitter> splitter = splitter_or_s.ConsumeValueOrDie();
+  std::unique_ptr<BlockingSplitPlan> split_plan =
+      splitter->SplitKelvinAndAgents(graph.get()).ConsumeValueOrDie();
+  std::unique_ptr<PartitionSplitPlan> partition_split =
+      splitter->SplitKelvinPartitions(split_plan->original_plan.get()).ConsumeValueOrDie();
+
+  auto grpc_source_group =
+      static_cast<GRPCSourceGroupIR*>(GetEquivalentInNewPlan(split_plan->after_blocking.get(), agg)
+                                          ->parents()[0]);
+  ASSERT_EQ(partition_split->partition_columns.size(), 1);
+  EXPECT_THAT(partition_split->partition_columns[grpc_source_group->source_id()],
+              ElementsAre("count"));
+
+  // The agg and the map run on the partitions, and send their output to the gather plan.
+  auto partition_plan = partition_split->partition_plan.get();
+  EXPECT_FALSE(HasEquivalentInNewPlan(partition_plan, mem_src));
+  EXPECT_FALSE(HasEquivalentInNewPlan(partition_plan, sink));
+  auto partition_agg = GetEquivalentInNewPlan(partition_plan, agg);
+  ASSERT_MATCH(partition_agg->parents()[0], GRPCSourceGroup());
+  EXPECT_EQ(static_cast<GRPCSourceGroupIR*>(partition_agg->parents()[0])->source_id(),
+            grpc_source_group->source_id());
+  auto partition_map = GetEquivalentInNewPlan(partition_plan, map);
+  ASSERT_EQ(partition_map->Children().size(), 1);
+  ASSERT_MATCH(partition_map->Children()[0], GRPCSink());
+  auto gather_sink = static_cast<GRPCSinkIR*>(partition_map->Children()[0]);
+
+  auto gather_plan = partition_split->gather_plan.get();
+  auto gather_sink_parent = GetEquivalentInNewPlan(gather_plan, sink)->parents()[0];
+  ASSERT_MATCH(gather_sink_parent, GRPCSourceGroup());
+  EXPECT_EQ(static_cast<GRPCSourceGroupIR*>(gather_sink_parent)->source_id(),
+            gather_sink->destination_id());
+  EXPECT_NE(gather_sink->destination_id(), grpc_source_group->source_id());
+  // The gather plan also runs a partition.
+  EXPECT_TRUE(HasEquivalentInNewPlan(gather_plan, agg));
+}
+
+TEST_F(SplitterTest, partition_join_test) {
+  auto left_src = MakeMemSource("cpu", cpu_relation);
+  auto right_src = MakeMemSource("cpu", cpu_relation);
+  auto join = MakeJoin({left_src, right_src}, "inner", cpu_relation, cpu_relation, {"count"},
+                       {"count"}, {"", "_right"});
+  MakeMemSink(join, "out");
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  auto splitter_or_s = Splitter::Create(compiler_state_.get(), /* perform_partial_agg */ false);
+  ASSERT_OK(splitter_or_s);
+  std::unique_ptr<Splitter> splitter = splitter_or_s.ConsumeValueOrDie();
+  std::unique_ptr<BlockingSplitPlan> split_plan =
+      splitter->SplitKelvinAndAgents(graph.get()).ConsumeValueOrDie();
+  std::unique_ptr<PartitionSplitPlan> partition_split =
+      splitter->SplitKelvinPartitions(split_plan->original_plan.get()).ConsumeValueOrDie();
+
+  // Both sides of the join are partitioned by the join key.
+  auto new_join = GetEquivalentInNewPlan(partition_split->partition_plan.get(), join);
+  ASSERT_EQ(new_join->parents().size(), 2);
+  for (OperatorIR* parent : new_join->parents()) {
+    ASSERT_MATCH(parent, GRPCSourceGroup());
+    auto source_id = static_cast<GRPCSourceGroupIR*>(parent)->source_id();
+    EXPECT_THAT(partition_split->partition_columns[source_id], ElementsAre("count"));
+  }
+  ASSERT_EQ(new_join->Children().size(), 1);
+  EXPECT_MATCH(new_join->Children()[0], GRPCSink());
+}
+
+// A join on the UPIDs of both sides runs on the PEMs, because the matching rows are always on the
+// same PEM.
+TEST_F(SplitterTest, upid_join_runs_on_pem) {
+  Relation upid_relation({types::UINT128, types::INT64}, {"upid", "count"},
+                         {types::ST_UPID, types::ST_NONE});
+  compiler_state_->relation_map()->emplace("process_stats", upid_relation);
+  auto left_src = MakeMemSource("process_stats", upid_relation);
+  auto right_src = MakeMemSource("process_stats", upid_relation);
+  auto join = MakeJoin({left_src, right_src}, "inner", upid_relation, upid_relation, {"upid"},
+                       {"upid"}, {"", "_right"});
+  auto sink = MakeMemSink(join, "out");
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  auto splitter_or_s = Splitter::Create(compiler_state_.get(), /* perform_partial_agg */ false);
+  ASSERT_OK(splitter_or_s);
+  std::unique_ptr<Splitter> splitter = splitter_or_s.ConsumeValueOrDie();
+  std::unique_ptr<BlockingSplitPlan> split_plan =
+      splitter->SplitKelvinAndAgents(graph.get()).ConsumeValueOrDie();
+
+  auto before_blocking = split_plan->before_blocking.get();
+  auto after_blocking = split_plan->after_blocking.get();
+  auto new_join = GetEquivalentInNewPlan(before_blocking, join);
+  EXPECT_EQ(new_join->parents()[0]->id(), left_src->id());
+  EXPECT_EQ(new_join->parents()[1]->id(), right_src->id());
+  ASSERT_EQ(new_join->Children().size(), 1);
+  ASSERT_MATCH(new_join->Children()[0], GRPCSink());
+  auto grpc_sink = static_cast<GRPCSinkIR*>(new_join->Children()[0]);
+
+  EXPECT_FALSE(HasEquivalentInNewPlan(after_blocking, join));
+  auto new_sink = GetEquivalentInNewPlan(after_blocking, sink);
+  ASSERT_MATCH(new_sink->parents()[0], GRPCSourceGroup());
+  EXPECT_EQ(static_cast<GRPCSourceGroupIR*>(new_sink->parents()[0])->source_id(),
+            grpc_sink->destination_id());
+}
+
+// An outer join on the UPIDs still runs on Kelvin, because a PEM might not have one of the tables.
+TEST_F(SplitterTest, upid_outer_join_runs_on_kelvin) {
+  Relation upid_relation({types::UINT128, types::INT64}, {"upid", "count"},
+                         {types::ST_UPID, types::ST_NONE});
+  compiler_state_->relation_map()->emplace("process_stats", upid_relation);
+  auto left_src = MakeMemSource("process_stats", upid_relation);
+  auto right_src = MakeMemSource("process_stats", upid_relation);
+  auto join = MakeJoin({left_src, right_src}, "left", upid_relation, upid_relation, {"upid"},
+                       {"upid"}, {"", "_right"});
+  MakeMemSink(join, "out");
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  auto splitter_or_s = Splitter::Create(compiler_state_.get(), /* perform_partial_agg */ false);
+  ASSERT_OK(splitter_or_s);
+  std::unique_ptr<Splitter> splitter = splitter_or_s.ConsumeValueOrDie();
+  std::unique_ptr<BlockingSplitPlan> split_plan =
+      splitter->SplitKelvinAndAgents(graph.get()).ConsumeValueOrDie();
+
+  EXPECT_FALSE(HasEquivalentInNewPlan(split_plan->before_blocking.get(), join));
+  auto new_join = GetEquivalentInNewPlan(split_plan->after_blocking.get(), join);
+  for (OperatorIR* parent : new_join->parents()) {
+    EXPECT_MATCH(parent, GRPCSourceGroup());
+  }
+}
+
+TEST_F(SplitterTest, partition_shared_source_group) {
+  // The source group feeds both the agg and the join, so neither can be partitioned.
+  auto mem_src = MakeMemSource("cpu", cpu_relation);
+  auto mean_func = MakeMeanFuncWithFloatType(MakeColumn("cpu0", 0, types::DataType::INT64));
+  auto blocking_agg = MakeBlockingAgg(mem_src, {MakeColumn("count", 0, types::DataType::INT64)},
+                                      {{"cpu0_mean", mean_func}});
+  auto join = MakeJoin({mem_src, blocking_agg}, "inner", MakeRelation(),
+                       Relation({types::INT64, types::FLOAT64}, {"count", "cpu0_mean"}), {"count"},
+                       {"count"}, {"", "_right"});
+  MakeMemSink(join, "out");
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  auto splitter_or_s = Splitter::Create(compiler_state_.get(), /* perform_partial_agg */ false);
+  ASSERT_OK(splitter_or_s);
+  std::unique_ptr<Splitter> splitter = splitter_or_s.ConsumeValueOrDie();
+  std::unique_ptr<BlockingSplitPlan> split_plan =
+      splitter->SplitKelvinAndAgents(graph.get()).ConsumeValueOrDie();
+  std::unique_ptr<PartitionSplitPlan> partition_split =
+      splitter->SplitKelvinPartitions(split_plan->original_plan.get()).ConsumeValueOrDie();
+
+  EXPECT_TRUE(partition_split->partition_columns.empty());
+}
+
 TEST_F(SplitterTest, simple_split_test) {
   auto mem_src = MakeMemSource("cpu", cpu_relation);
   auto map1 = MakeMap(mem_src, {{"cpu0", MakeColumn("cpu0", 0)}, {"cpu1", MakeColumn("cpu1", 0)}});
@@ -31,9 +31,30 @@ Status GRPCSinkIR::CopyFromNodeImpl(const IRNode* node,
   destination_ssl_targetname_ = grpc_sink->destination_ssl_targetname_;
   name_ = grpc_sink->name_;
   out_columns_ = grpc_sink->out_columns_;
+  partition_columns_ = grpc_sink->partition_columns_;
+  partition_destinations_ = grpc_sink->partition_destinations_;
   return Status::OK();
 }
 
+void GRPCSinkIR::SetPartitionDestination(int64_t partition, const std::string& address,
+                                         const std::string& ssl_targetname) {
+  DCHECK_GE(partition, 0);
+  if (partition >= num_partitions()) {
+    partition_destinations_.resize(partition + 1);
+  }
+  partition_destinations_[partition].address = address;
+  partition_destinations_[partition].ssl_targetname = ssl_targetname;
+}
+
+void GRPCSinkIR::AddPartitionDestinationIDMap(int64_t partition, int64_t destination_id,
+                                              int64_t agent_id) {
+  DCHECK_GE(partition, 0);
+  if (partition >= num_partitions()) {
+    partition_destinations_.resize(partition + 1);
+  }
+  partition_destinations_[partition].agent_id_to_destination_id[agent_id] = destination_id;
+}
+
 Status GRPCSinkIR::ToProto(planpb::Operator* op) const {
   CHECK(has_output_table());
   auto pb = op->mutable_grpc_sink_op();
@@ -56,6 +77,25 @@ Status GRPCSinkIR::ToProto(planpb::Operator* op) const {
 Status GRPCSinkIR::ToProto(planpb::Operator* op, int64_t agent_id) const {
   auto pb = op->mutable_grpc_sink_op();
   op->set_op_type(planpb::GRPC_SINK_OPERATOR);
+  if (partitioned()) {
+    for (int64_t col_idx : partition_columns_) {
+      pb->add_partition_column_indices(col_idx);
+    }
+    for (int64_t i = 0; i < num_partitions(); ++i) {
+      const auto& destination = partition_destinations_[i];
+      auto iter = destination.agent_id_to_destination_id.find(agent_id);
+      if (iter == destination.agent_id_to_destination_id.end()) {
+        return CreateIRNodeError("No agent ID '$0' found for partition $1 in grpc sink '$2'",
+                                 agent_id, i, DebugString());
+      }
+      auto destination_pb = pb->add_partition_destinations();
+      destination_pb->set_address(destination.address);
+      destination_pb->set_grpc_source_id(iter->second);
+      destination_pb->mutable_connection_options()->set_ssl_targetname(
+          destination.ssl_targetname);
+    }
+    return Status::OK();
+  }
   pb->set_address(destination_address());
   pb->mutable_connection_options()->set_ssl_targetname(destination_ssl_targetname());
   if (!agent_id_to_destination_id_.contains(agent_id)) {
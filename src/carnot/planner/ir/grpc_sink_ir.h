@@ -138,6 +138,25 @@ class GRPCSinkIR : public OperatorIR {
     return agent_id_to_destination_id_;
   }
 
+  /**
+   * @brief Makes this sink hash partition its rows over several destinations, by the values of
+   * the columns at the passed in indices. Each destination is a GRPCSourceGroup with the same
+   * source id as this sink's destination id, which sets the address of its partition when the
+   * plans are stitched together.
+   *
+   * @param partition_columns the indices of the partition columns in the sink's input.
+   */
+  void SetPartitionColumns(const std::vector<int64_t>& partition_columns) {
+    partition_columns_ = partition_columns;
+  }
+  bool partitioned() const { return !partition_columns_.empty(); }
+  const std::vector<int64_t>& partition_columns() const { return partition_columns_; }
+  int64_t num_partitions() const { return partition_destinations_.size(); }
+
+  void SetPartitionDestination(int64_t partition, const std::string& address,
+                               const std::string& ssl_targetname);
+  void AddPartitionDestinationIDMap(int64_t partition, int64_t destination_id, int64_t agent_id);
+
  protected:
   Status CopyFromNodeImpl(const IRNode* node,
                           absl::flat_hash_map<const IRNode*, IRNode*>* copied_nodes_map) override;
@@ -156,6 +175,15 @@ class GRPCSinkIR : public OperatorIR {
   std::string name_;
   std::vector<std::string> out_columns_;
   absl::flat_hash_map<int64_t, int64_t> agent_id_to_destination_id_;
+
+  // Used when the sink is partitioned.
+  struct PartitionDestination {
+    std::string address;
+    std::string ssl_targetname;
+    absl::flat_hash_map<int64_t, int64_t> agent_id_to_destination_id;
+  };
+  std::vector<int64_t> partition_columns_;
+  std::vector<PartitionDestination> partition_destinations_;
 };
 
 }  // namespace planner
@@ -62,6 +62,13 @@ class GRPCSourceGroupIR : public OperatorIR {
   void SetGRPCAddress(const std::string& grpc_address) { grpc_address_ = grpc_address; }
   void SetSSLTargetName(const std::string& ssl_targetname) { ssl_targetname_ = ssl_targetname; }
 
+  /**
+   * @brief Sets the partition of the rows of partitioned GRPCSinks that this source group
+   * receives. Only source groups fed by partitioned sinks have a partition.
+   */
+  void SetPartition(int64_t partition) { partition_ = partition; }
+  int64_t partition() const { return partition_; }
+
   /**
    * @brief Associate the passed in GRPCSinkOperator with this Source Group. The sink_op passed in
    * will most likely exist outside of the graph this contains, so instead of holding a pointer, we
@@ -99,6 +106,7 @@ class GRPCSourceGroupIR : public OperatorIR {
   int64_t source_id_ = -1;
   std::string grpc_address_ = "";
   std::string ssl_targetname_ = "";
+  int64_t partition_ = -1;
   std::vector<std::pair<GRPCSinkIR*, absl::flat_hash_set<int64_t>>> dependent_sinks_;
 };
 }  // namespace planner
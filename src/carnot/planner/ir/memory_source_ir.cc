@@ -64,6 +64,19 @@ Status MemorySourceIR::ToProto(planpb::Operator* op) const {
   }
 
   pb->set_streaming(streaming());
+
+  const auto& column_names = resolved_table_type()->ColumnNames();
+  for (const auto& predicate : predicates_) {
+    auto it = std::find(column_names.begin(), column_names.end(), predicate.col_name);
+    if (it == column_names.end()) {
+      // The column was pruned from the source's output, so the predicate is no longer needed.
+      continue;
+    }
+    auto predicate_pb = pb->add_predicates();
+    predicate_pb->set_column_idx(column_index_map_[std::distance(column_names.begin(), it)]);
+    predicate_pb->set_op(predicate.op);
+    *predicate_pb->mutable_value() = predicate.value;
+  }
   return Status::OK();
 }
 
@@ -106,6 +119,7 @@ Status MemorySourceIR::CopyFromNodeImpl(const IRNode* node,
   column_index_map_set_ = source_ir->column_index_map_set_;
   column_index_map_ = source_ir->column_index_map_;
   streaming_ = source_ir->streaming_;
+  predicates_ = source_ir->predicates_;
 
   return Status::OK();
 }
@@ -21,12 +21,14 @@
 #include <algorithm>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "src/carnot/planner/compiler_state/compiler_state.h"
 #include "src/carnot/planner/ir/expression_ir.h"
 #include "src/carnot/planner/ir/operator_ir.h"
 #include "src/carnot/planner/types/types.h"
+#include "src/carnot/planpb/plan.pb.h"
 #include "src/carnot/udfspb/udfs.pb.h"
 #include "src/common/base/base.h"
 #include "src/shared/types/column_wrapper.h"
@@ -42,6 +44,17 @@ namespace planner {
  */
 class MemorySourceIR : public OperatorIR {
  public:
+  /**
+   * @brief A comparison between one of the source's output columns and a constant, collected from
+   * the filters applied directly to the source. The source can use these to skip reading data, but
+   * doesn't filter the rows it returns.
+   */
+  struct ColumnPredicate {
+    std::string col_name;
+    planpb::ColumnPredicate::Op op;
+    planpb::ScalarValue value;
+  };
+
   MemorySourceIR() = delete;
   explicit MemorySourceIR(int64_t id) : OperatorIR(id, IRNodeType::kMemorySource) {}
 
@@ -102,6 +115,11 @@ class MemorySourceIR : public OperatorIR {
 
   void SetColumnNames(const std::vector<std::string>& col_names) { column_names_ = col_names; }
 
+  const std::vector<ColumnPredicate>& predicates() const { return predicates_; }
+  void SetPredicates(std::vector<ColumnPredicate> predicates) {
+    predicates_ = std::move(predicates);
+  }
+
   bool IsSource() const override { return true; }
 
   Status ResolveType(CompilerState* compiler_state);
@@ -126,6 +144,8 @@ class MemorySourceIR : public OperatorIR {
 
   types::TabletID tablet_value_;
   bool has_tablet_value_ = false;
+
+  std::vector<ColumnPredicate> predicates_;
 };
 
 }  // namespace planner
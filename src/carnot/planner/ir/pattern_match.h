@@ -72,6 +72,7 @@
 #include "src/carnot/planner/ir/limit_ir.h"
 #include "src/carnot/planner/ir/memory_source_ir.h"
 #include "src/carnot/planner/ir/otel_export_sink_ir.h"
+#include "src/carnot/planner/ir/sort_ir.h"
 #include "src/carnot/planner/ir/string_ir.h"
 
 namespace px {
@@ -164,6 +165,7 @@ inline ClassMatch<IRNodeType::kEmptySource> EmptySource() {
   return ClassMatch<IRNodeType::kEmptySource>();
 }
 inline ClassMatch<IRNodeType::kLimit> Limit() { return ClassMatch<IRNodeType::kLimit>(); }
+inline ClassMatch<IRNodeType::kSort> Sort() { return ClassMatch<IRNodeType::kSort>(); }
 
 inline ClassMatch<IRNodeType::kGRPCSource> GRPCSource() {
   return ClassMatch<IRNodeType::kGRPCSource>();
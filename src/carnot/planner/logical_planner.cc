@@ -18,6 +18,8 @@
 
 #include "src/carnot/planner/logical_planner.h"
 
+#include <algorithm>
+#include <string>
 #include <utility>
 
 #include "src/carnot/planner/compiler_state/compiler_state.h"
@@ -65,6 +67,13 @@ static inline RedactionOptions RedactionOptionsFromPb(
 StatusOr<std::unique_ptr<CompilerState>> CreateCompilerState(
     const distributedpb::LogicalPlannerState& logical_state, RegistryInfo* registry_info,
     int64_t max_output_rows_per_table) {
+  return CreateCompilerState(logical_state, registry_info, max_output_rows_per_table,
+                             px::CurrentTimeNS());
+}
+
+StatusOr<std::unique_ptr<CompilerState>> CreateCompilerState(
+    const distributedpb::LogicalPlannerState& logical_state, RegistryInfo* registry_info,
+    int64_t max_output_rows_per_table, int64_t time_now) {
   PX_ASSIGN_OR_RETURN(std::unique_ptr<RelationMap> rel_map,
                       MakeRelationMapFromDistributedState(logical_state.distributed_state()));
 
@@ -97,9 +106,9 @@ StatusOr<std::unique_ptr<CompilerState>> CreateCompilerState(
   for (const auto& debug_info_pb : logical_state.debug_info().otel_debug_attributes()) {
     debug_info.otel_debug_attrs.push_back({debug_info_pb.name(), debug_info_pb.value()});
   }
-  // Create a CompilerState obj using the relation map and grabbing the current time.
+  // Create a CompilerState obj using the relation map and the planning time.
   return std::make_unique<planner::CompilerState>(
-      std::move(rel_map), sensitive_columns, registry_info, px::CurrentTimeNS(),
+      std::move(rel_map), sensitive_columns, registry_info, types::Time64NSValue(time_now),
       max_output_rows_per_table, logical_state.result_address(),
       logical_state.result_ssl_targetname(),
       // TODO(philkuz) add an endpoint config to logical_state and pass that in here.
@@ -125,13 +134,18 @@ Status LogicalPlanner::Init(const udfspb::UDFInfo& udf_info) {
 
 StatusOr<std::unique_ptr<distributed::DistributedPlan>> LogicalPlanner::Plan(
     const plannerpb::QueryRequest& query_request) {
+  return PlanAt(query_request, px::CurrentTimeNS());
+}
+
+StatusOr<std::unique_ptr<distributed::DistributedPlan>> LogicalPlanner::PlanAt(
+    const plannerpb::QueryRequest& query_request, int64_t time_now) {
   // Compile into the IR.
 
   auto ms = query_request.logical_planner_state().plan_options().max_output_rows_per_table();
   VLOG(1) << "Max output rows: " << ms;
-  PX_ASSIGN_OR_RETURN(
-      std::unique_ptr<CompilerState> compiler_state,
-      CreateCompilerState(query_request.logical_planner_state(), registry_info_.get(), ms));
+  PX_ASSIGN_OR_RETURN(std::unique_ptr<CompilerState> compiler_state,
+                      CreateCompilerState(query_request.logical_planner_state(),
+                                          registry_info_.get(), ms, time_now));
 
   std::vector<plannerpb::FuncToExecute> exec_funcs(query_request.exec_funcs().begin(),
                                                    query_request.exec_funcs().end());
@@ -149,6 +163,56 @@ StatusOr<std::unique_ptr<distributed::DistributedPlan>> LogicalPlanner::Plan(
   return distributed_plan;
 }
 
+StatusOr<distributedpb::DistributedPlan> LogicalPlanner::PlanToProtoAt(
+    const plannerpb::QueryRequest& query_request, int64_t time_now) {
+  PX_ASSIGN_OR_RETURN(auto distributed_plan, PlanAt(query_request, time_now));
+  // In the future, if we actually have plan options that will actually determine how the plan is
+  // constructed, we may want to pass the planOptions to planner.Plan. However, this
+  // will need to go through many more layers (such as the coordinator), so this is fine for now.
+  distributed_plan->SetPlanOptions(query_request.logical_planner_state().plan_options());
+  return distributed_plan->ToProto();
+}
+
+StatusOr<distributedpb::DistributedPlan> LogicalPlanner::PlanToProto(
+    const plannerpb::QueryRequest& query_request, distributedpb::PlanCacheResult* cache_result) {
+  int64_t start_ns = px::CurrentTimeNS();
+  auto anchors = PlanCache::Anchors(query_request, start_ns);
+  PlanCache::Fingerprint key = PlanCache::Key(query_request);
+
+  distributedpb::DistributedPlan plan_pb;
+  int64_t planning_time_ns = 0;
+  auto lookup = plan_cache_.Lookup(key, anchors, &plan_pb, &planning_time_ns);
+  if (lookup == PlanCache::LookupResult::kHit) {
+    cache_result->set_hit(true);
+    cache_result->set_saved_planning_time_ns(
+        std::max<int64_t>(0, planning_time_ns - (px::CurrentTimeNS() - start_ns)));
+    return plan_pb;
+  }
+  cache_result->set_hit(false);
+
+  PX_ASSIGN_OR_RETURN(plan_pb, PlanToProtoAt(query_request, anchors.time_now));
+  planning_time_ns = px::CurrentTimeNS() - start_ns;
+  if (lookup == PlanCache::LookupResult::kNotCacheable) {
+    return plan_pb;
+  }
+
+  if (plan_cache_.Insert(key, plan_pb, anchors, planning_time_ns) !=
+      PlanCache::InsertResult::kNeedsProbe) {
+    return plan_pb;
+  }
+
+  // The anchors didn't move apart since the query's pending plan, so plan the query again with
+  // its time anchors moved to find out which time ranges of the plan follow which anchor.
+  PlanCache::TimeAnchors probe_anchors;
+  auto probe_query = PlanCache::ProbeQuery(query_request, anchors, &probe_anchors);
+  auto probe_or_s = PlanToProtoAt(probe_query, probe_anchors.time_now);
+  if (probe_or_s.ok()) {
+    plan_cache_.InsertWithProbe(key, plan_pb, anchors, probe_or_s.ConsumeValueOrDie(),
+                                probe_anchors, planning_time_ns);
+  }
+  return plan_pb;
+}
+
 StatusOr<std::unique_ptr<compiler::MutationsIR>> LogicalPlanner::CompileTrace(
     const plannerpb::CompileMutationsRequest& mutations_req) {
   // Compile into the IR.
@@ -25,6 +25,8 @@
 #include "src/carnot/planner/compiler_state/compiler_state.h"
 #include "src/carnot/planner/distributed/distributed_plan/distributed_plan.h"
 #include "src/carnot/planner/distributed/distributed_planner.h"
+#include "src/carnot/planner/distributedpb/distributed_plan.pb.h"
+#include "src/carnot/planner/plan_cache.h"
 #include "src/carnot/planner/plannerpb/service.pb.h"
 #include "src/carnot/planner/probes/probes.h"
 #include "src/shared/scriptspb/scripts.pb.h"
@@ -57,6 +59,17 @@ class LogicalPlanner : public NotCopyable {
   StatusOr<std::unique_ptr<distributed::DistributedPlan>> Plan(
       const plannerpb::QueryRequest& query);
 
+  /**
+   * @brief Plans the query like Plan(), and returns the distributed plan as a protobuf with the
+   * query's plan options set. Queries that were planned before are served from the plan cache.
+   *
+   * @param query: QueryRequest
+   * @param cache_result: set to how the plan cache served the query.
+   * @return distributedpb::DistributedPlan or error if one occurs during compilation.
+   */
+  StatusOr<distributedpb::DistributedPlan> PlanToProto(
+      const plannerpb::QueryRequest& query, distributedpb::PlanCacheResult* cache_result);
+
   StatusOr<std::unique_ptr<compiler::MutationsIR>> CompileTrace(
       const plannerpb::CompileMutationsRequest& mutations_req);
 
@@ -70,14 +83,26 @@ class LogicalPlanner : public NotCopyable {
   LogicalPlanner() {}
 
  private:
+  // The number of plans kept in the plan cache.
+  static constexpr size_t kPlanCacheSize = 64;
+
+  StatusOr<std::unique_ptr<distributed::DistributedPlan>> PlanAt(
+      const plannerpb::QueryRequest& query, int64_t time_now);
+  StatusOr<distributedpb::DistributedPlan> PlanToProtoAt(const plannerpb::QueryRequest& query,
+                                                         int64_t time_now);
+
   compiler::Compiler compiler_;
   std::unique_ptr<distributed::Planner> distributed_planner_;
   std::unique_ptr<planner::RegistryInfo> registry_info_;
+  PlanCache plan_cache_{kPlanCacheSize};
 };
 
 StatusOr<std::unique_ptr<CompilerState>> CreateCompilerState(
     const distributedpb::LogicalPlannerState& logical_state, RegistryInfo* registry_info,
     int64_t max_output_rows_per_table);
+StatusOr<std::unique_ptr<CompilerState>> CreateCompilerState(
+    const distributedpb::LogicalPlannerState& logical_state, RegistryInfo* registry_info,
+    int64_t max_output_rows_per_table, int64_t time_now);
 
 }  // namespace planner
 }  // namespace carnot
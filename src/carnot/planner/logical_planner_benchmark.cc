@@ -45,6 +45,24 @@ void BM_Query(benchmark::State& state) {
 
 BENCHMARK(BM_Query);
 
+// NOLINTNEXTLINE : runtime/references.
+void BM_CachedQuery(benchmark::State& state) {
+  auto info = udfexporter::ExportUDFInfo().ConsumeValueOrDie()->info_pb();
+  auto planner = LogicalPlanner::Create(info).ConsumeValueOrDie();
+  plannerpb::QueryRequest query_request;
+  query_request.set_query_str(testutils::kHttpRequestStats);
+  *query_request.mutable_logical_planner_state() =
+      testutils::CreateTwoPEMsOneKelvinPlannerState(testutils::kHttpEventsSchema);
+
+  distributedpb::PlanCacheResult cache_result;
+  for (auto _ : state) {
+    auto plan_or_s = planner->PlanToProto(query_request, &cache_result);
+    EXPECT_OK(plan_or_s);
+  }
+}
+
+BENCHMARK(BM_CachedQuery);
+
 }  // namespace logical_planner
 }  // namespace planner
 }  // namespace carnot
@@ -132,6 +132,55 @@ TEST_F(LogicalPlannerTest, max_output_rows) {
   EXPECT_OK(plan->ToProto());
 }
 
+TEST_F(LogicalPlannerTest, plan_cache) {
+  auto planner = LogicalPlanner::Create(info_).ConsumeValueOrDie();
+  auto state = testutils::CreateTwoPEMsOneKelvinPlannerState(testutils::kHttpEventsSchema);
+  auto query = MakeQueryRequest(state, kSimpleQueryDefaultLimit);
+
+  distributedpb::PlanCacheResult cache_result;
+  // The first plan of the query is only kept as pending, the second one is cached.
+  ASSERT_OK_AND_ASSIGN(auto first_pb, planner->PlanToProto(query, &cache_result));
+  EXPECT_FALSE(cache_result.hit());
+  ASSERT_OK(planner->PlanToProto(query, &cache_result));
+  EXPECT_FALSE(cache_result.hit());
+  ASSERT_OK_AND_ASSIGN(auto second_pb, planner->PlanToProto(query, &cache_result));
+  EXPECT_TRUE(cache_result.hit());
+
+  // The cached plan's time range is moved to the time of the last query.
+  auto start_time = [](const distributedpb::DistributedPlan& plan_pb) {
+    for (const auto& fragment : plan_pb.qb_address_to_plan().at("pem1").nodes()) {
+      for (const auto& node : fragment.nodes()) {
+        if (node.op().op_type() == planpb::MEMORY_SOURCE_OPERATOR) {
+          return node.op().mem_source_op().start_time().value();
+        }
+      }
+    }
+    return int64_t{0};
+  };
+  EXPECT_GT(start_time(first_pb), 0);
+  EXPECT_GE(start_time(second_pb), start_time(first_pb));
+  EXPECT_EQ(first_pb.qb_address_to_plan_size(), second_pb.qb_address_to_plan_size());
+}
+
+constexpr char kNowInFilterQuery[] = R"pxl(
+import px
+t1 = px.DataFrame(table='http_events', select=['time_'])
+t1 = t1[t1.time_ > px.now() - px.seconds(2)]
+px.display(t1)
+)pxl";
+
+TEST_F(LogicalPlannerTest, plan_cache_skips_time_dependent_plans) {
+  auto planner = LogicalPlanner::Create(info_).ConsumeValueOrDie();
+  auto state = testutils::CreateTwoPEMsOneKelvinPlannerState(testutils::kHttpEventsSchema);
+  auto query = MakeQueryRequest(state, kNowInFilterQuery);
+
+  distributedpb::PlanCacheResult cache_result;
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_OK(planner->PlanToProto(query, &cache_result));
+    EXPECT_FALSE(cache_result.hit());
+  }
+}
+
 constexpr char kCompileTimeQuery[] = R"pxl(
 import px
 
@@ -606,6 +655,63 @@ TEST_F(LogicalPlannerTest, partial_agg) {
   EXPECT_OK(plan->ToProto());
 }
 
+constexpr char kPartitionedAggQuery[] = R"pxl(
+import px
+df = px.DataFrame(table='http_events', start_time='-5m')
+df = df.groupby('req_path').agg(count=('resp_status', px.count))
+df = df[df['count'] > 10]
+px.display(df, 'out')
+)pxl";
+
+TEST_F(LogicalPlannerTest, partitioned_agg_two_kelvins) {
+  auto planner = LogicalPlanner::Create(info_).ConsumeValueOrDie();
+  ASSERT_OK_AND_ASSIGN(
+      auto plan,
+      planner->Plan(MakeQueryRequest(
+          testutils::CreateTwoPEMsTwoKelvinsPlannerState(testutils::kHttpEventsSchema),
+          kPartitionedAggQuery)));
+  ASSERT_OK_AND_ASSIGN(auto plan_pb, plan->ToProto());
+
+  auto grpc_sinks = [&plan_pb](const std::string& qb_address) {
+    std::vector<planpb::GRPCSinkOperator> sinks;
+    for (const auto& fragment : plan_pb.qb_address_to_plan().at(qb_address).nodes()) {
+      for (const auto& node : fragment.nodes()) {
+        if (node.op().op_type() == planpb::GRPC_SINK_OPERATOR) {
+          sinks.push_back(node.op().grpc_sink_op());
+        }
+      }
+    }
+    return sinks;
+  };
+
+  // The PEMs partition their rows by req_path over both Kelvins.
+  for (const auto& pem : {"pem1", "pem2"}) {
+    SCOPED_TRACE(pem);
+    auto sinks = grpc_sinks(pem);
+    ASSERT_EQ(sinks.size(), 1);
+    EXPECT_EQ(sinks[0].partition_column_indices_size(), 1);
+    ASSERT_EQ(sinks[0].partition_destinations_size(), 2);
+    EXPECT_EQ(sinks[0].partition_destinations(0).address(), "1111");
+    EXPECT_EQ(sinks[0].partition_destinations(1).address(), "1112");
+    const auto& pem_plan = plan_pb.qb_address_to_plan().at(pem);
+    EXPECT_EQ(pem_plan.execution_status_destinations_size(), 2);
+  }
+
+  // kelvin2 aggregates its partition, and sends the result to kelvin1, which gathers the
+  // partitions and sends the final result.
+  auto kelvin2_sinks = grpc_sinks("kelvin2");
+  ASSERT_EQ(kelvin2_sinks.size(), 1);
+  EXPECT_EQ(kelvin2_sinks[0].address(), "1111");
+  EXPECT_EQ(kelvin2_sinks[0].partition_destinations_size(), 0);
+  const auto& kelvin2_plan = plan_pb.qb_address_to_plan().at("kelvin2");
+  ASSERT_EQ(kelvin2_plan.execution_status_destinations_size(), 1);
+  EXPECT_EQ(kelvin2_plan.execution_status_destinations(0).grpc_address(), "1111");
+
+  auto kelvin1_sinks = grpc_sinks("kelvin1");
+  ASSERT_EQ(kelvin1_sinks.size(), 1);
+  EXPECT_EQ(kelvin1_sinks[0].output_table().table_name(), "out");
+}
+
 constexpr char kPemOnlyLimit[] = R"pxl(
 import px
 df = px.DataFrame(table='http_events')
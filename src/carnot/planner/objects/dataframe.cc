@@ -270,6 +270,30 @@ StatusOr<QLObjectPtr> LimitHandler(CompilerState* compiler_state, IR* graph, Ope
   return Dataframe::Create(compiler_state, limit_op, visitor);
 }
 
+// Handles the sort() DataFrame logic.
+StatusOr<QLObjectPtr> SortHandler(CompilerState* compiler_state, IR* graph, OperatorIR* op,
+                                  const pypa::AstPtr& ast, const ParsedArgs& args,
+                                  ASTVisitor* visitor) {
+  PX_ASSIGN_OR_RETURN(std::vector<std::string> columns,
+                      ParseAsListOfStrings(args.GetArg("by"), "by"));
+  PX_ASSIGN_OR_RETURN(std::vector<BoolIR*> ascending_nodes,
+                      ParseAsListOf<BoolIR>(args.GetArg("ascending"), "ascending"));
+  std::vector<bool> ascending;
+  for (BoolIR* node : ascending_nodes) {
+    ascending.push_back(node->val());
+  }
+  // A single value applies to every sort column.
+  if (ascending.size() == 1) {
+    ascending.resize(columns.size(), ascending[0]);
+  }
+  if (ascending.size() != columns.size()) {
+    return CreateAstError(ast, "Expected $0 values for 'ascending', got $1", columns.size(),
+                          ascending.size());
+  }
+  PX_ASSIGN_OR_RETURN(SortIR * sort_op, graph->CreateNode<SortIR>(ast, op, columns, ascending));
+  return Dataframe::Create(compiler_state, sort_op, visitor);
+}
+
 class SubscriptHandler {
  public:
   /**
@@ -515,6 +539,23 @@ Status Dataframe::Init() {
   PX_RETURN_IF_ERROR(limitfn->SetDocString(kLimitOpDocstring));
   AddMethod(kLimitOpID, limitfn);
 
+  /**
+   * # Equivalent to the python method method syntax:
+   * def sort(self, by, ascending=True):
+   *     ...
+   */
+  PX_ASSIGN_OR_RETURN(
+      std::shared_ptr<FuncObject> sortfn,
+      FuncObject::Create(
+          kSortOpID, {"by", "ascending"}, {{"ascending", "True"}},
+          /* has_variable_len_args */ false,
+          /* has_variable_len_kwargs */ false,
+          std::bind(&SortHandler, compiler_state_, graph(), op(), std::placeholders::_1,
+                    std::placeholders::_2, std::placeholders::_3),
+          ast_visitor()));
+  PX_RETURN_IF_ERROR(sortfn->SetDocString(kSortOpDocstring));
+  AddMethod(kSortOpID, sortfn);
+
   /**
    *
    * # Equivalent to the python method method syntax:
@@ -280,6 +280,30 @@ class Dataframe : public QLObject {
   Returns:
     px.DataFrame: DataFrame with the first n rows.
   )doc";
+  inline static constexpr char kSortOpID[] = "sort";
+  inline static constexpr char kSortOpDocstring[] = R"doc(
+  Sorts the DataFrame by the specified columns.
+
+  Returns a DataFrame with its rows ordered by the values of the `by` columns.
+  Followed by `head()`, only the top n rows are kept while sorting, which
+  is much cheaper than sorting the whole DataFrame.
+
+  :topic: dataframe_ops
+  :opname: Sort
+
+  Examples:
+    df = px.DataFrame('http_events')
+    # The 10 slowest http requests.
+    df = df.sort('latency', ascending=False).head(10)
+
+  Args:
+    by (Union[str,List[str]]): The column or columns to sort by, most significant first.
+    ascending (Union[bool,List[bool]]): Whether to sort in ascending order, either for all
+      the columns or as a list with one entry per column. If not set, default is True.
+
+  Returns:
+    px.DataFrame: DataFrame with the rows sorted.
+  )doc";
 
   inline static constexpr char kMergeOpID[] = "merge";
   inline static constexpr char kMergeOpDocstring[] = R"doc(
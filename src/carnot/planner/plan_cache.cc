@@ -0,0 +1,329 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/planner/plan_cache.h"
+
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include <google/protobuf/util/message_differencer.h>
+
+#include <farmhash.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace px {
+namespace carnot {
+namespace planner {
+
+namespace {
+
+// How far each anchor is moved for the probe plan. The offsets must all be different, so that
+// every memory source time can be matched to a single anchor.
+constexpr int64_t kProbeTimeNowOffsetNS = 3600LL * 1000 * 1000 * 1000;
+constexpr int64_t kProbePluginStartOffsetNS = 2 * kProbeTimeNowOffsetNS;
+constexpr int64_t kProbePluginEndOffsetNS = 3 * kProbeTimeNowOffsetNS;
+
+void ClearMemorySourceTimes(distributedpb::DistributedPlan* plan) {
+  for (auto& [address, carnot_plan] : *plan->mutable_qb_address_to_plan()) {
+    for (auto& fragment : *carnot_plan.mutable_nodes()) {
+      for (auto& node : *fragment.mutable_nodes()) {
+        if (node.op().op_type() != planpb::MEMORY_SOURCE_OPERATOR) {
+          continue;
+        }
+        node.mutable_op()->mutable_mem_source_op()->clear_start_time();
+        node.mutable_op()->mutable_mem_source_op()->clear_stop_time();
+      }
+    }
+  }
+}
+
+}  // namespace
+
+PlanCache::Fingerprint PlanCache::Key(const plannerpb::QueryRequest& query) {
+  plannerpb::QueryRequest key_query = query;
+  if (key_query.logical_planner_state().has_plugin_config()) {
+    key_query.mutable_logical_planner_state()->mutable_plugin_config()->clear_start_time_ns();
+    key_query.mutable_logical_planner_state()->mutable_plugin_config()->clear_end_time_ns();
+  }
+  // Maps in the request (e.g. the OTel headers) must serialize the same way every time.
+  std::string serialized;
+  {
+    google::protobuf::io::StringOutputStream stream(&serialized);
+    google::protobuf::io::CodedOutputStream coded(&stream);
+    coded.SetSerializationDeterministic(true);
+    key_query.SerializeToCodedStream(&coded);
+  }
+  const ::util::uint128_t fingerprint =
+      ::util::Fingerprint128(serialized.data(), serialized.size());
+  return absl::MakeUint128(::util::Uint128High64(fingerprint), ::util::Uint128Low64(fingerprint));
+}
+
+PlanCache::TimeAnchors PlanCache::Anchors(const plannerpb::QueryRequest& query,
+                                          int64_t time_now) {
+  TimeAnchors anchors;
+  anchors.time_now = time_now;
+  anchors.plugin_start_time = query.logical_planner_state().plugin_config().start_time_ns();
+  anchors.plugin_end_time = query.logical_planner_state().plugin_config().end_time_ns();
+  anchors.has_plugin_config = query.logical_planner_state().has_plugin_config();
+  return anchors;
+}
+
+plannerpb::QueryRequest PlanCache::ProbeQuery(const plannerpb::QueryRequest& query,
+                                              const TimeAnchors& anchors,
+                                              TimeAnchors* probe_anchors) {
+  plannerpb::QueryRequest probe_query = query;
+  *probe_anchors = anchors;
+  probe_anchors->time_now += kProbeTimeNowOffsetNS;
+  if (anchors.has_plugin_config) {
+    probe_anchors->plugin_start_time += kProbePluginStartOffsetNS;
+    probe_anchors->plugin_end_time += kProbePluginEndOffsetNS;
+    auto plugin_config = probe_query.mutable_logical_planner_state()->mutable_plugin_config();
+    plugin_config->set_start_time_ns(probe_anchors->plugin_start_time);
+    plugin_config->set_end_time_ns(probe_anchors->plugin_end_time);
+  }
+  return probe_query;
+}
+
+bool PlanCache::AnchorsMovedApart(const TimeAnchors& a, const TimeAnchors& b) {
+  int64_t now_diff = b.time_now - a.time_now;
+  if (now_diff == 0) {
+    return false;
+  }
+  if (!a.has_plugin_config) {
+    return true;
+  }
+  int64_t start_diff = b.plugin_start_time - a.plugin_start_time;
+  int64_t end_diff = b.plugin_end_time - a.plugin_end_time;
+  return start_diff != 0 && end_diff != 0 && start_diff != end_diff && start_diff != now_diff &&
+         end_diff != now_diff;
+}
+
+StatusOr<std::vector<PlanCache::TimeParam>> PlanCache::MatchTimeParams(
+    const distributedpb::DistributedPlan& plan, const TimeAnchors& anchors,
+    const distributedpb::DistributedPlan& probe, const TimeAnchors& probe_anchors) {
+  // Anything but the memory source times must not depend on the time.
+  distributedpb::DistributedPlan plan_without_times = plan;
+  distributedpb::DistributedPlan probe_without_times = probe;
+  ClearMemorySourceTimes(&plan_without_times);
+  ClearMemorySourceTimes(&probe_without_times);
+  if (!google::protobuf::util::MessageDifferencer::Equals(plan_without_times,
+                                                          probe_without_times)) {
+    return error::FailedPrecondition("Plan depends on the time outside of memory sources");
+  }
+
+  auto match_anchor = [&](int64_t value, int64_t probe_value) -> StatusOr<Anchor> {
+    int64_t diff = probe_value - value;
+    if (diff == 0) {
+      return Anchor::kAbsolute;
+    }
+    if (diff == probe_anchors.time_now - anchors.time_now) {
+      return Anchor::kTimeNow;
+    }
+    if (diff == probe_anchors.plugin_start_time - anchors.plugin_start_time) {
+      return Anchor::kPluginStart;
+    }
+    if (diff == probe_anchors.plugin_end_time - anchors.plugin_end_time) {
+      return Anchor::kPluginEnd;
+    }
+    return error::FailedPrecondition("Memory source time $0 doesn't follow a single anchor", value);
+  };
+
+  std::vector<TimeParam> params;
+  for (const auto& [address, carnot_plan] : plan.qb_address_to_plan()) {
+    // The plans are equal without the times, so they have the same layout.
+    const auto& probe_plan = probe.qb_address_to_plan().at(address);
+    for (int f = 0; f < carnot_plan.nodes_size(); ++f) {
+      for (int n = 0; n < carnot_plan.nodes(f).nodes_size(); ++n) {
+        const auto& op = carnot_plan.nodes(f).nodes(n).op();
+        if (op.op_type() != planpb::MEMORY_SOURCE_OPERATOR) {
+          continue;
+        }
+        const auto& src = op.mem_source_op();
+        const auto& probe_src = probe_plan.nodes(f).nodes(n).op().mem_source_op();
+        if (src.has_start_time() != probe_src.has_start_time() ||
+            src.has_stop_time() != probe_src.has_stop_time()) {
+          return error::FailedPrecondition("Memory source time range depends on the time");
+        }
+        if (src.has_start_time()) {
+          PX_ASSIGN_OR_RETURN(Anchor anchor, match_anchor(src.start_time().value(),
+                                                          probe_src.start_time().value()));
+          params.push_back({address, f, n, /*stop_time*/ false, anchor});
+        }
+        if (src.has_stop_time()) {
+          PX_ASSIGN_OR_RETURN(Anchor anchor, match_anchor(src.stop_time().value(),
+                                                          probe_src.stop_time().value()));
+          params.push_back({address, f, n, /*stop_time*/ true, anchor});
+        }
+      }
+    }
+  }
+  return params;
+}
+
+PlanCache::LookupResult PlanCache::Lookup(Fingerprint key, const TimeAnchors& anchors,
+                                          distributedpb::DistributedPlan* plan,
+                                          int64_t* planning_time_ns) {
+  std::shared_ptr<const distributedpb::DistributedPlan> cached_plan;
+  TimeAnchors cached_anchors;
+  std::vector<TimeParam> params;
+  {
+    absl::MutexLock lock(&lock_);
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+      return LookupResult::kMiss;
+    }
+    lru_.splice(lru_.begin(), lru_, it->second.lru_it);
+    switch (it->second.state) {
+      case State::kPending:
+        return LookupResult::kMiss;
+      case State::kNotCacheable:
+        return LookupResult::kNotCacheable;
+      case State::kCacheable:
+        break;
+    }
+    cached_plan = it->second.plan;
+    cached_anchors = it->second.anchors;
+    params = it->second.params;
+    *planning_time_ns = it->second.planning_time_ns;
+  }
+
+  *plan = *cached_plan;
+  for (const auto& param : params) {
+    int64_t offset = 0;
+    switch (param.anchor) {
+      case Anchor::kAbsolute:
+        continue;
+      case Anchor::kTimeNow:
+        offset = anchors.time_now - cached_anchors.time_now;
+        break;
+      case Anchor::kPluginStart:
+        offset = anchors.plugin_start_time - cached_anchors.plugin_start_time;
+        break;
+      case Anchor::kPluginEnd:
+        offset = anchors.plugin_end_time - cached_anchors.plugin_end_time;
+        break;
+    }
+    auto src = (*plan->mutable_qb_address_to_plan())[param.qb_address]
+                   .mutable_nodes(param.fragment_idx)
+                   ->mutable_nodes(param.node_idx)
+                   ->mutable_op()
+                   ->mutable_mem_source_op();
+    auto time = param.stop_time ? src->mutable_stop_time() : src->mutable_start_time();
+    time->set_value(time->value() + offset);
+  }
+  return LookupResult::kHit;
+}
+
+PlanCache::InsertResult PlanCache::Insert(Fingerprint key,
+                                          const distributedpb::DistributedPlan& plan,
+                                          const TimeAnchors& anchors, int64_t planning_time_ns) {
+  if (capacity_ == 0) {
+    return InsertResult::kNotCacheable;
+  }
+  std::shared_ptr<const distributedpb::DistributedPlan> pending_plan;
+  TimeAnchors pending_anchors;
+  {
+    absl::MutexLock lock(&lock_);
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+      Entry entry;
+      entry.state = State::kPending;
+      entry.plan = std::make_shared<const distributedpb::DistributedPlan>(plan);
+      entry.anchors = anchors;
+      entry.planning_time_ns = planning_time_ns;
+      InsertEntry(key, std::move(entry));
+      return InsertResult::kPending;
+    }
+    switch (it->second.state) {
+      case State::kCacheable:
+        return InsertResult::kCached;
+      case State::kNotCacheable:
+        return InsertResult::kNotCacheable;
+      case State::kPending:
+        break;
+    }
+    if (!AnchorsMovedApart(it->second.anchors, anchors)) {
+      return InsertResult::kNeedsProbe;
+    }
+    pending_plan = it->second.plan;
+    pending_anchors = it->second.anchors;
+  }
+
+  if (!InsertMatched(key, plan, anchors, *pending_plan, pending_anchors, planning_time_ns)) {
+    return InsertResult::kNotCacheable;
+  }
+  return InsertResult::kCached;
+}
+
+bool PlanCache::InsertWithProbe(Fingerprint key, const distributedpb::DistributedPlan& plan,
+                                const TimeAnchors& anchors,
+                                const distributedpb::DistributedPlan& probe,
+                                const TimeAnchors& probe_anchors, int64_t planning_time_ns) {
+  if (capacity_ == 0) {
+    return false;
+  }
+  return InsertMatched(key, plan, anchors, probe, probe_anchors, planning_time_ns);
+}
+
+bool PlanCache::InsertMatched(Fingerprint key, const distributedpb::DistributedPlan& plan,
+                              const TimeAnchors& anchors,
+                              const distributedpb::DistributedPlan& other,
+                              const TimeAnchors& other_anchors, int64_t planning_time_ns) {
+  Entry entry;
+  auto params_or_s = MatchTimeParams(plan, anchors, other, other_anchors);
+  if (params_or_s.ok()) {
+    entry.state = State::kCacheable;
+    entry.plan = std::make_shared<const distributedpb::DistributedPlan>(plan);
+    entry.anchors = anchors;
+    entry.params = params_or_s.ConsumeValueOrDie();
+    entry.planning_time_ns = planning_time_ns;
+  } else {
+    VLOG(1) << "Not caching plan: " << params_or_s.msg();
+  }
+
+  absl::MutexLock lock(&lock_);
+  InsertEntry(key, std::move(entry));
+  return params_or_s.ok();
+}
+
+void PlanCache::InsertEntry(Fingerprint key, Entry entry) {
+  auto it = entries_.find(key);
+  if (it != entries_.end()) {
+    lru_.erase(it->second.lru_it);
+    entries_.erase(it);
+  }
+  lru_.push_front(key);
+  entry.lru_it = lru_.begin();
+  entries_.emplace(key, std::move(entry));
+
+  while (entries_.size() > capacity_) {
+    entries_.erase(lru_.back());
+    lru_.pop_back();
+  }
+}
+
+size_t PlanCache::size() const {
+  absl::MutexLock lock(&lock_);
+  return entries_.size();
+}
+
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,185 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <absl/base/thread_annotations.h>
+#include <absl/container/flat_hash_map.h>
+#include <absl/numeric/int128.h>
+#include <absl/synchronization/mutex.h>
+
+#include "src/carnot/planner/distributedpb/distributed_plan.pb.h"
+#include "src/carnot/planner/plannerpb/service.pb.h"
+#include "src/common/base/base.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+
+/**
+ * @brief PlanCache holds the plans of recently planned queries, so that scripts which are run
+ * over and over again (live views, cron scripts) skip compilation.
+ *
+ * Plans are keyed by a 128-bit fingerprint of the whole query request: the script, its arguments
+ * and the logical planner state, which holds the schemas and the agents (distributed state). The
+ * state can be large, so only its fingerprint is kept and compared. The times of the plugin config
+ * are left out of the key, because they change on every run of a cron script.
+ *
+ * Scripts usually read a time range relative to px.now() or to the plugin's start and end times.
+ * Those ranges end up as the start and stop times of the MemorySourceOperators, which are moved
+ * with their anchor when a cached plan is reused. Plans that depend on the time anywhere else
+ * (e.g. px.now() in a filter) are not cached.
+ *
+ * Which anchor a time follows is found by comparing two plans of the query made at different
+ * times. The first plan of a query is only kept as pending, so that scripts which are run once
+ * are planned once; the next plan of the query is compared to it.
+ */
+class PlanCache : public NotCopyable {
+ public:
+  // The times that a script's time ranges can be relative to.
+  struct TimeAnchors {
+    int64_t time_now = 0;
+    int64_t plugin_start_time = 0;
+    int64_t plugin_end_time = 0;
+    bool has_plugin_config = false;
+  };
+
+  enum class LookupResult {
+    // The query was not planned before, or only its pending plan is known.
+    kMiss,
+    // The plan was found in the cache.
+    kHit,
+    // The query was planned before, but its plan can't be reused.
+    kNotCacheable,
+  };
+
+  enum class InsertResult {
+    // The plan was kept as the pending plan of the query.
+    kPending,
+    // The plan was cached.
+    kCached,
+    // The query's plans can't be reused.
+    kNotCacheable,
+    // The anchors moved by the same amount since the pending plan, so the two plans can't tell
+    // which anchor each time follows. The caller should plan ProbeQuery() and call
+    // InsertWithProbe().
+    kNeedsProbe,
+  };
+
+  // The fingerprint of a query request. At 128 bits, collisions aren't guarded against.
+  using Fingerprint = absl::uint128;
+
+  explicit PlanCache(size_t capacity) : capacity_(capacity) {}
+
+  /**
+   * @brief Returns the cache key of the query.
+   */
+  static Fingerprint Key(const plannerpb::QueryRequest& query);
+
+  /**
+   * @brief Returns the time anchors of the query, when planned at `time_now`.
+   */
+  static TimeAnchors Anchors(const plannerpb::QueryRequest& query, int64_t time_now);
+
+  /**
+   * @brief Returns the query with its plugin times moved like the probe anchors of `anchors`, and
+   * sets `probe_anchors`. See InsertWithProbe().
+   */
+  static plannerpb::QueryRequest ProbeQuery(const plannerpb::QueryRequest& query,
+                                            const TimeAnchors& anchors,
+                                            TimeAnchors* probe_anchors);
+
+  /**
+   * @brief Looks up the plan for `key`. On a hit, `plan` is set to the cached plan with its time
+   * ranges moved to `anchors`, and `planning_time_ns` to the time it took to plan the query.
+   */
+  LookupResult Lookup(Fingerprint key, const TimeAnchors& anchors,
+                      distributedpb::DistributedPlan* plan, int64_t* planning_time_ns);
+
+  /**
+   * @brief Adds `plan`, which was planned at `anchors`, to the cache. If the key has no pending
+   * plan yet, `plan` becomes its pending plan. Otherwise each memory source time is matched to the
+   * anchor it moved with between the pending plan and `plan`, and `plan` is cached. If the plans
+   * differ anywhere else, the key is marked as not cacheable.
+   */
+  InsertResult Insert(Fingerprint key, const distributedpb::DistributedPlan& plan,
+                      const TimeAnchors& anchors, int64_t planning_time_ns);
+
+  /**
+   * @brief Caches `plan` like Insert(), but matches its times against `probe`, which must be the
+   * plan of ProbeQuery(), planned at `probe_anchors`. Returns false if the key is not cacheable.
+   */
+  bool InsertWithProbe(Fingerprint key, const distributedpb::DistributedPlan& plan,
+                       const TimeAnchors& anchors, const distributedpb::DistributedPlan& probe,
+                       const TimeAnchors& probe_anchors, int64_t planning_time_ns);
+
+  size_t size() const;
+
+ private:
+  enum class Anchor { kAbsolute, kTimeNow, kPluginStart, kPluginEnd };
+
+  // A start or stop time of a memory source in the plan.
+  struct TimeParam {
+    std::string qb_address;
+    int fragment_idx;
+    int node_idx;
+    bool stop_time;
+    Anchor anchor;
+  };
+
+  enum class State { kPending, kCacheable, kNotCacheable };
+
+  struct Entry {
+    State state = State::kNotCacheable;
+    // Shared with lookups, so that the plan is copied outside of the lock.
+    std::shared_ptr<const distributedpb::DistributedPlan> plan;
+    TimeAnchors anchors;
+    std::vector<TimeParam> params;
+    int64_t planning_time_ns = 0;
+    std::list<Fingerprint>::iterator lru_it;
+  };
+
+  // Whether a time that moved between plans made at `a` and at `b` can only follow one anchor.
+  static bool AnchorsMovedApart(const TimeAnchors& a, const TimeAnchors& b);
+
+  static StatusOr<std::vector<TimeParam>> MatchTimeParams(
+      const distributedpb::DistributedPlan& plan, const TimeAnchors& anchors,
+      const distributedpb::DistributedPlan& probe, const TimeAnchors& probe_anchors);
+
+  // Caches `plan` if its times match those of `other`, or marks the key as not cacheable.
+  bool InsertMatched(Fingerprint key, const distributedpb::DistributedPlan& plan,
+                     const TimeAnchors& anchors, const distributedpb::DistributedPlan& other,
+                     const TimeAnchors& other_anchors, int64_t planning_time_ns);
+
+  void InsertEntry(Fingerprint key, Entry entry) ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  const size_t capacity_;
+  mutable absl::Mutex lock_;
+  absl::flat_hash_map<Fingerprint, Entry> entries_ ABSL_GUARDED_BY(lock_);
+  // The keys, most recently used first.
+  std::list<Fingerprint> lru_ ABSL_GUARDED_BY(lock_);
+};
+
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,245 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gmock/gmock.h>
+#include <google/protobuf/text_format.h>
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include <absl/strings/substitute.h>
+
+#include "src/carnot/planner/plan_cache.h"
+#include "src/common/testing/protobuf.h"
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+
+using ::px::testing::proto::EqualsProto;
+
+constexpr char kPlanTmpl[] = R"proto(
+qb_address_to_plan {
+  key: "pem"
+  value {
+    nodes {
+      id: 1
+      nodes {
+        id: 1
+        op {
+          op_type: MEMORY_SOURCE_OPERATOR
+          mem_source_op { name: "table1" start_time { value: $0 } stop_time { value: $1 } }
+        }
+      }
+      nodes {
+        id: 2
+        op {
+          op_type: LIMIT_OPERATOR
+          limit_op { limit: $2 }
+        }
+      }
+    }
+  }
+}
+)proto";
+
+distributedpb::DistributedPlan MakePlan(int64_t start_time, int64_t stop_time, int64_t limit = 10) {
+  distributedpb::DistributedPlan plan;
+  CHECK(google::protobuf::TextFormat::ParseFromString(
+      absl::Substitute(kPlanTmpl, start_time, stop_time, limit), &plan));
+  return plan;
+}
+
+plannerpb::QueryRequest MakeQuery(int64_t plugin_start_time, int64_t plugin_end_time) {
+  plannerpb::QueryRequest query;
+  query.set_query_str("import px\npx.display(px.DataFrame('table1'))");
+  auto plugin_config = query.mutable_logical_planner_state()->mutable_plugin_config();
+  plugin_config->set_start_time_ns(plugin_start_time);
+  plugin_config->set_end_time_ns(plugin_end_time);
+  return query;
+}
+
+class PlanCacheTest : public ::testing::Test {
+ protected:
+  // Inserts a plan planned at `anchors`, where the plan's start and stop times are computed by
+  // `start_fn` and `stop_fn` from the anchors, like the compiler would.
+  template <typename TStartFn, typename TStopFn>
+  bool InsertPlan(const plannerpb::QueryRequest& query, const PlanCache::TimeAnchors& anchors,
+                  TStartFn start_fn, TStopFn stop_fn) {
+    PlanCache::TimeAnchors probe_anchors;
+    PlanCache::ProbeQuery(query, anchors, &probe_anchors);
+    return cache_.InsertWithProbe(
+        PlanCache::Key(query), MakePlan(start_fn(anchors), stop_fn(anchors)), anchors,
+        MakePlan(start_fn(probe_anchors), stop_fn(probe_anchors)), probe_anchors,
+        /*planning_time_ns*/ 1000);
+  }
+
+  PlanCache cache_{2};
+};
+
+TEST_F(PlanCacheTest, moves_times_with_their_anchor) {
+  auto query = MakeQuery(/*plugin_start_time*/ 100, /*plugin_end_time*/ 200);
+  auto anchors = PlanCache::Anchors(query, /*time_now*/ 1000);
+  // start_time='-30ns' relative to now, and end_time=px.plugin.end_time.
+  ASSERT_TRUE(InsertPlan(
+      query, anchors, [](const PlanCache::TimeAnchors& a) { return a.time_now - 30; },
+      [](const PlanCache::TimeAnchors& a) { return a.plugin_end_time; }));
+
+  auto next_query = MakeQuery(/*plugin_start_time*/ 150, /*plugin_end_time*/ 250);
+  EXPECT_EQ(PlanCache::Key(query), PlanCache::Key(next_query));
+  distributedpb::DistributedPlan plan;
+  int64_t planning_time_ns;
+  EXPECT_EQ(PlanCache::LookupResult::kHit,
+            cache_.Lookup(PlanCache::Key(next_query), PlanCache::Anchors(next_query, 2000), &plan,
+                          &planning_time_ns));
+  EXPECT_THAT(plan, EqualsProto(MakePlan(1970, 250).DebugString()));
+  EXPECT_EQ(1000, planning_time_ns);
+}
+
+TEST_F(PlanCacheTest, absolute_times_are_kept) {
+  auto query = MakeQuery(100, 200);
+  ASSERT_TRUE(InsertPlan(
+      query, PlanCache::Anchors(query, 1000), [](const PlanCache::TimeAnchors&) { return 5; },
+      [](const PlanCache::TimeAnchors& a) { return a.time_now; }));
+
+  distributedpb::DistributedPlan plan;
+  int64_t planning_time_ns;
+  EXPECT_EQ(PlanCache::LookupResult::kHit,
+            cache_.Lookup(PlanCache::Key(query), PlanCache::Anchors(query, 3000), &plan,
+                          &planning_time_ns));
+  EXPECT_THAT(plan, EqualsProto(MakePlan(5, 3000).DebugString()));
+}
+
+TEST_F(PlanCacheTest, time_outside_of_memory_sources_is_not_cacheable) {
+  auto query = MakeQuery(100, 200);
+  auto anchors = PlanCache::Anchors(query, 1000);
+  PlanCache::TimeAnchors probe_anchors;
+  PlanCache::ProbeQuery(query, anchors, &probe_anchors);
+  auto key = PlanCache::Key(query);
+  // The limit stands in for an expression that uses px.now().
+  EXPECT_FALSE(cache_.InsertWithProbe(key, MakePlan(1, 2, anchors.time_now), anchors,
+                                      MakePlan(1, 2, probe_anchors.time_now), probe_anchors,
+                                      1000));
+
+  distributedpb::DistributedPlan plan;
+  int64_t planning_time_ns;
+  EXPECT_EQ(PlanCache::LookupResult::kNotCacheable,
+            cache_.Lookup(key, anchors, &plan, &planning_time_ns));
+}
+
+TEST_F(PlanCacheTest, caches_second_plan_without_probe) {
+  auto query = MakeQuery(100, 200);
+  auto key = PlanCache::Key(query);
+  auto anchors = PlanCache::Anchors(query, 1000);
+  EXPECT_EQ(PlanCache::InsertResult::kPending,
+            cache_.Insert(key, MakePlan(anchors.time_now - 30, anchors.plugin_end_time), anchors,
+                          1000));
+
+  distributedpb::DistributedPlan plan;
+  int64_t planning_time_ns;
+  EXPECT_EQ(PlanCache::LookupResult::kMiss,
+            cache_.Lookup(key, anchors, &plan, &planning_time_ns));
+
+  // Every anchor moved by a different amount, so the two plans are enough to match the times.
+  auto next_query = MakeQuery(110, 230);
+  auto next_anchors = PlanCache::Anchors(next_query, 1500);
+  EXPECT_EQ(
+      PlanCache::InsertResult::kCached,
+      cache_.Insert(key, MakePlan(next_anchors.time_now - 30, next_anchors.plugin_end_time),
+                    next_anchors, 2000));
+
+  auto last_query = MakeQuery(150, 250);
+  EXPECT_EQ(PlanCache::LookupResult::kHit,
+            cache_.Lookup(key, PlanCache::Anchors(last_query, 2000), &plan, &planning_time_ns));
+  EXPECT_THAT(plan, EqualsProto(MakePlan(1970, 250).DebugString()));
+  EXPECT_EQ(2000, planning_time_ns);
+}
+
+TEST_F(PlanCacheTest, needs_probe_when_anchors_move_together) {
+  auto query = MakeQuery(100, 200);
+  auto key = PlanCache::Key(query);
+  auto anchors = PlanCache::Anchors(query, 1000);
+  EXPECT_EQ(PlanCache::InsertResult::kPending, cache_.Insert(key, MakePlan(1, 2), anchors, 1000));
+
+  // A cron script's window moves by the same amount as px.now().
+  auto next_query = MakeQuery(600, 700);
+  EXPECT_EQ(PlanCache::InsertResult::kNeedsProbe,
+            cache_.Insert(key, MakePlan(1, 2), PlanCache::Anchors(next_query, 1500), 1000));
+  EXPECT_EQ(PlanCache::InsertResult::kNeedsProbe,
+            cache_.Insert(key, MakePlan(1, 2), PlanCache::Anchors(query, 1000), 1000));
+}
+
+TEST_F(PlanCacheTest, time_dependent_pending_plan_is_not_cacheable) {
+  auto query = MakeQuery(100, 200);
+  auto key = PlanCache::Key(query);
+  auto anchors = PlanCache::Anchors(query, 1000);
+  EXPECT_EQ(PlanCache::InsertResult::kPending,
+            cache_.Insert(key, MakePlan(1, 2, anchors.time_now), anchors, 1000));
+  auto next_anchors = PlanCache::Anchors(MakeQuery(110, 230), 1500);
+  EXPECT_EQ(PlanCache::InsertResult::kNotCacheable,
+            cache_.Insert(key, MakePlan(1, 2, next_anchors.time_now), next_anchors, 1000));
+
+  distributedpb::DistributedPlan plan;
+  int64_t planning_time_ns;
+  EXPECT_EQ(PlanCache::LookupResult::kNotCacheable,
+            cache_.Lookup(key, next_anchors, &plan, &planning_time_ns));
+}
+
+TEST_F(PlanCacheTest, keys_differ_by_script_and_state) {
+  auto query = MakeQuery(1, 2);
+  auto other_script = MakeQuery(1, 2);
+  other_script.set_query_str("import px\npx.display(px.DataFrame('table2'))");
+  auto other_state = MakeQuery(1, 2);
+  other_state.mutable_logical_planner_state()->set_result_address("query-broker:50300");
+
+  EXPECT_NE(PlanCache::Key(query), PlanCache::Key(other_script));
+  EXPECT_NE(PlanCache::Key(query), PlanCache::Key(other_state));
+  EXPECT_NE(PlanCache::Key(other_script), PlanCache::Key(other_state));
+}
+
+TEST_F(PlanCacheTest, evicts_least_recently_used) {
+  auto time_fn = [](const PlanCache::TimeAnchors& a) { return a.time_now; };
+  auto query1 = MakeQuery(1, 2);
+  auto query2 = MakeQuery(1, 2);
+  query2.set_query_str("query2");
+  auto query3 = MakeQuery(1, 2);
+  query3.set_query_str("query3");
+  ASSERT_TRUE(InsertPlan(query1, PlanCache::Anchors(query1, 1000), time_fn, time_fn));
+  ASSERT_TRUE(InsertPlan(query2, PlanCache::Anchors(query2, 1000), time_fn, time_fn));
+
+  distributedpb::DistributedPlan plan;
+  int64_t planning_time_ns;
+  // Using query1 makes query2 the least recently used plan.
+  EXPECT_EQ(PlanCache::LookupResult::kHit,
+            cache_.Lookup(PlanCache::Key(query1), PlanCache::Anchors(query1, 1000), &plan,
+                          &planning_time_ns));
+  ASSERT_TRUE(InsertPlan(query3, PlanCache::Anchors(query3, 1000), time_fn, time_fn));
+
+  EXPECT_EQ(2, cache_.size());
+  EXPECT_EQ(PlanCache::LookupResult::kMiss,
+            cache_.Lookup(PlanCache::Key(query2), PlanCache::Anchors(query2, 1000), &plan,
+                          &planning_time_ns));
+  EXPECT_EQ(PlanCache::LookupResult::kHit,
+            cache_.Lookup(PlanCache::Key(query1), PlanCache::Anchors(query1, 1000), &plan,
+                          &planning_time_ns));
+}
+
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
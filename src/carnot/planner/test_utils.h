@@ -558,6 +558,25 @@ distributedpb::LogicalPlannerState CreateTwoPEMsOneKelvinPlannerState() {
   return CreateTwoPEMsOneKelvinPlannerState(kSchema);
 }
 
+std::string TwoPEMsTwoKelvinsDistributedState() {
+  std::string table_name = "table1";
+  std::string tabletization_key = "upid";
+  std::string table_info1 = MakeTableInfoStr(table_name, tabletization_key, {"1", "2"});
+  std::string table_info2 = MakeTableInfoStr(table_name, tabletization_key, {"3", "4"});
+  return MakeDistributedState(
+      {MakePEMCarnotInfo("pem1", "00000001-0000-0000-0000-000000000001", 123, {table_info1}),
+       MakePEMCarnotInfo("pem2", "00000001-0000-0000-0000-000000000002", 456, {table_info2}),
+       MakeKelvinCarnotInfo("kelvin1", "00000001-0000-0000-0000-000000000003", "1111", 789),
+       MakeKelvinCarnotInfo("kelvin2", "00000001-0000-0000-0000-000000000004", "1112", 790)});
+}
+
+// A planner state that lets queries be partitioned over both of its Kelvins.
+distributedpb::LogicalPlannerState CreateTwoPEMsTwoKelvinsPlannerState(std::string_view schema) {
+  auto logical_state = LoadLogicalPlannerStatePB(TwoPEMsTwoKelvinsDistributedState(), schema);
+  logical_state.mutable_distributed_state()->set_max_partition_kelvins(2);
+  return logical_state;
+}
+
 constexpr char kExpectedPlanTwoPEMs[] = R"proto(
 qb_address_to_plan {
   key: "pem1"
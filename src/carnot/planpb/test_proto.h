@@ -328,6 +328,33 @@ columns {
 }
 )";
 
+// Sorts by column 1 descending, then column 0 ascending, and outputs both columns.
+constexpr char kSortOperator1[] = R"(
+keys {
+  column {
+    node: 1
+    index: 1
+  }
+  ascending: false
+}
+keys {
+  column {
+    node: 1
+    index: 0
+  }
+  ascending: true
+}
+limit: $0
+columns {
+  node: 1
+  index: 0
+}
+columns {
+  node: 1
+  index: 1
+}
+)";
+
 constexpr char kLimitDropOperator1[] = R"(
 limit: 10
 columns {
@@ -1474,6 +1501,14 @@ planpb::Operator CreateTestLimit1PB() {
   return op;
 }
 
+planpb::Operator CreateTestSort1PB(int64_t limit) {
+  planpb::Operator op;
+  auto op_proto = absl::Substitute(kOperatorProtoTmpl, "SORT_OPERATOR", "sort_op",
+                                   absl::Substitute(kSortOperator1, limit));
+  CHECK(google::protobuf::TextFormat::MergeFromString(op_proto, &op)) << "Failed to parse proto";
+  return op;
+}
+
 planpb::Operator CreateTestDropLimit1PB() {
   planpb::Operator op;
   auto op_proto =
@@ -74,6 +74,14 @@ class AnyUDA : public BaseFunc {
  *      Status Init(FunctionContext *ctx, UDFValue... init_args) {}
  *  This function is called once during initialization of each instance (many instances
  *  may exists in a given query). The arguments are as provided by the query.
+ *
+ * If all of the argument and return types are BOOLEAN, INT64, FLOAT64 or TIME64NS, the
+ * ScalarUDF can also _optionally_ implement:
+ *      void ExecBatch(FunctionContext *ctx, size_t count, NativeType<ReturnValue>* out,
+ *                     const NativeType<UDFValue>*... values) {}
+ *  This function is called instead of Exec with whole columns of raw values, and must compute
+ *  the same result as Exec for each of the count rows. Simple loops over the arrays can be
+ *  vectorized by the compiler.
  */
 class ScalarUDF : public AnyUDF {
  public:
@@ -143,6 +151,28 @@ static constexpr bool IsValidExecFunc(ReturnType (TUDF::*)(FunctionContext*, Typ
   return true;
 }
 
+/**
+ * The native type of a UDF value type, e.g. int64_t for Int64Value.
+ */
+template <typename T>
+using NativeType = typename types::ValueTypeTraits<T>::native_type;
+
+// SFINAE test for ExecBatch fn.
+template <typename T, typename = void>
+struct has_udf_exec_batch_fn : std::false_type {};
+
+template <typename T>
+struct has_udf_exec_batch_fn<T, std::void_t<decltype(&T::ExecBatch)>> : std::true_type {};
+
+/**
+ * Checks whether columns of the given type can be passed to an ExecBatch function as an array of
+ * native values.
+ */
+constexpr bool IsExecBatchType(types::DataType type) {
+  return type == types::BOOLEAN || type == types::INT64 || type == types::FLOAT64 ||
+         type == types::TIME64NS;
+}
+
 /**
  * Checks to see if a valid looking Executor function exists.
  */
@@ -228,6 +258,26 @@ class ScalarUDFTraits {
    */
   static constexpr bool HasExecutor() { return has_udf_executor_fn<T>::value; }
 
+  /**
+   * Checks if the UDF has an ExecBatch function that can be used for its argument and return
+   * types.
+   * @return true if ExecBatch should be called instead of Exec.
+   */
+  static constexpr bool HasExecBatch() {
+    if constexpr (has_udf_exec_batch_fn<T>::value) {
+      if (!IsExecBatchType(ReturnType())) {
+        return false;
+      }
+      for (const auto& type : ExecArguments()) {
+        if (!IsExecBatchType(type)) {
+          return false;
+        }
+      }
+      return true;
+    }
+    return false;
+  }
+
   template <typename Q = T, std::enable_if_t<ScalarUDFTraits<Q>::HasInit(), void>* = nullptr>
   static constexpr auto InitArguments() {
     return GetArgumentTypesHelper(&Q::Init);
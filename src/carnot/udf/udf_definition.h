@@ -196,6 +196,7 @@ class UDADefinition : public UDFDefinition {
     make_fn_ = UDAWrapper<T>::Make;
     exec_batch_update_fn_ = UDAWrapper<T>::ExecBatchUpdate;
     exec_batch_update_arrow_fn_ = UDAWrapper<T>::ExecBatchUpdateArrow;
+    exec_batch_update_arrow_rows_fn_ = UDAWrapper<T>::ExecBatchUpdateArrowRows;
     init_wrapper_fn_ = UDAWrapper<T>::ExecInit;
 
     auto init_arguments_array = UDATraits<T>::InitArguments();
@@ -235,6 +236,12 @@ class UDADefinition : public UDFDefinition {
                               const std::vector<const arrow::Array*>& inputs) {
     return exec_batch_update_arrow_fn_(uda, ctx, inputs);
   }
+  // Updates the UDA with the given rows of the inputs only.
+  Status ExecBatchUpdateArrow(UDA* uda, FunctionContext* ctx,
+                              const std::vector<const arrow::Array*>& inputs, const int64_t* rows,
+                              size_t num_rows) {
+    return exec_batch_update_arrow_rows_fn_(uda, ctx, inputs, rows, num_rows);
+  }
 
   Status ExecInit(UDA* uda, FunctionContext* ctx,
                   const std::vector<std::shared_ptr<types::BaseValueType>>& inputs) {
@@ -270,6 +277,10 @@ class UDADefinition : public UDFDefinition {
   std::function<Status(UDA* uda, FunctionContext* ctx,
                        const std::vector<const arrow::Array*>& inputs)>
       exec_batch_update_arrow_fn_;
+  std::function<Status(UDA* uda, FunctionContext* ctx,
+                       const std::vector<const arrow::Array*>& inputs, const int64_t* rows,
+                       size_t num_rows)>
+      exec_batch_update_arrow_rows_fn_;
 
   std::function<Status(UDA* uda, FunctionContext* ctx, arrow::ArrayBuilder* output)>
       finalize_arrow_fn_;
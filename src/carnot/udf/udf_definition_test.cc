@@ -52,6 +52,31 @@ class AddUDF : public ScalarUDF {
   }
 };
 
+class BatchAddUDF : public ScalarUDF {
+ public:
+  types::Int64Value Exec(FunctionContext*, types::Int64Value v1, types::Int64Value v2) {
+    return v1.val + v2.val;
+  }
+  void ExecBatch(FunctionContext*, size_t count, int64_t* out, const int64_t* v1,
+                 const int64_t* v2) {
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = v1[i] + v2[i];
+    }
+  }
+};
+
+class BatchLessThanUDF : public ScalarUDF {
+ public:
+  types::BoolValue Exec(FunctionContext*, types::Float64Value v1, types::BoolValue v2) {
+    return v2.val && v1.val < 1.0;
+  }
+  void ExecBatch(FunctionContext*, size_t count, bool* out, const double* v1, const bool* v2) {
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = v2[i] && v1[i] < 1.0;
+    }
+  }
+};
+
 class InitArgUDF : public ScalarUDF {
  public:
   Status Init(FunctionContext*, types::StringValue str, types::Int64Value i) {
@@ -137,6 +162,46 @@ TEST(UDFDefinition, arrow_write) {
   EXPECT_EQ(6, resArr->Value(1));
 }
 
+TEST(UDFDefinition, exec_batch) {
+  auto ctx = FunctionContext(nullptr, nullptr);
+  ScalarUDFDefinition def("add");
+  EXPECT_OK(def.Init<BatchAddUDF>());
+  EXPECT_TRUE(ScalarUDFTraits<BatchAddUDF>::HasExecBatch());
+
+  types::Int64ValueColumnWrapper v1({1, 2, 3});
+  types::Int64ValueColumnWrapper v2({3, 4, 5});
+
+  types::Int64ValueColumnWrapper out(v1.Size());
+  auto u = def.Make();
+  EXPECT_OK(def.ExecBatch(u.get(), &ctx, {&v1, &v2}, &out, v1.Size()));
+  EXPECT_EQ(4, out[0].val);
+  EXPECT_EQ(6, out[1].val);
+  EXPECT_EQ(8, out[2].val);
+}
+
+TEST(UDFDefinition, exec_batch_arrow_bool) {
+  auto ctx = FunctionContext(nullptr, nullptr);
+  std::vector<types::Float64Value> v1 = {0.5, 2.0, 0.1, 0.2};
+  std::vector<types::BoolValue> v2 = {true, true, false, true};
+
+  auto v1a = ToArrow(v1, arrow::default_memory_pool());
+  auto v2a = ToArrow(v2, arrow::default_memory_pool());
+
+  auto output_builder = std::make_shared<arrow::BooleanBuilder>();
+  auto u = std::make_shared<BatchLessThanUDF>();
+  EXPECT_OK(ScalarUDFWrapper<BatchLessThanUDF>::ExecBatchArrow(
+      u.get(), &ctx, {v1a.get(), v2a.get()}, output_builder.get(), 4));
+
+  std::shared_ptr<arrow::Array> res;
+  EXPECT_TRUE(output_builder->Finish(&res).ok());
+  auto* res_arr = static_cast<arrow::BooleanArray*>(res.get());
+  ASSERT_EQ(4, res_arr->length());
+  EXPECT_TRUE(res_arr->Value(0));
+  EXPECT_FALSE(res_arr->Value(1));
+  EXPECT_FALSE(res_arr->Value(2));
+  EXPECT_TRUE(res_arr->Value(3));
+}
+
 TEST(UDFDefinition, init_args) {
   auto ctx = FunctionContext(nullptr, nullptr);
   ScalarUDFDefinition def("initargudf");
@@ -296,6 +361,30 @@ TEST(UDADefinition, init_args) {
   EXPECT_EQ("123, init_arg, true, [1, 2, 3]", out);
 }
 
+TEST(UDADefinition, arrow_update_rows) {
+  auto ctx = FunctionContext(nullptr, nullptr);
+  UDADefinition def("initarguda");
+  EXPECT_OK(def.Init<InitArgUDA>());
+
+  std::vector<std::shared_ptr<types::BaseValueType>> init_args = {
+      std::make_shared<types::Int64Value>(123),
+      std::make_shared<types::StringValue>("init_arg"),
+      std::make_shared<types::BoolValue>(true),
+  };
+
+  auto uda = def.Make();
+  EXPECT_OK(def.ExecInit(uda.get(), &ctx, init_args));
+
+  std::vector<types::Int64Value> v1 = {1, 2, 3, 4, 5};
+  auto v1a = ToArrow(v1, arrow::default_memory_pool());
+  std::vector<int64_t> rows = {4, 0, 2};
+
+  types::StringValue out;
+  EXPECT_OK(def.ExecBatchUpdateArrow(uda.get(), &ctx, {v1a.get()}, rows.data(), rows.size()));
+  EXPECT_OK(def.FinalizeValue(uda.get(), &ctx, &out));
+  EXPECT_EQ("123, init_arg, true, [5, 1, 3]", out);
+}
+
 TEST(UDADefinition, serialize_deserialize) {
   auto ctx = FunctionContext(nullptr, nullptr);
   UDADefinition def("serdeuda");
@@ -57,12 +57,25 @@ class AddUDF : public ScalarUDF {
   Int64Value Exec(FunctionContext*, Int64Value v1, Int64Value v2) { return v1.val + v2.val; }
 };
 
+// Same as AddUDF, but computes the whole batch at once.
+class BatchAddUDF : public ScalarUDF {
+ public:
+  Int64Value Exec(FunctionContext*, Int64Value v1, Int64Value v2) { return v1.val + v2.val; }
+  void ExecBatch(FunctionContext*, size_t count, int64_t* out, const int64_t* v1,
+                 const int64_t* v2) {
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = v1[i] + v2[i];
+    }
+  }
+};
+
 class SubStrUDF : public ScalarUDF {
  public:
   StringValue Exec(FunctionContext*, StringValue v1) { return v1.substr(1, 2); }
 };
 
 // This benchmark add two columns using Int64ValueVectors.
+template <typename TUDF>
 // NOLINTNEXTLINE : runtime/references.
 static void BM_AddInt64Values(benchmark::State& state) {
   auto vec1 = CreateLargeData<Int64Value>(state.range(0));
@@ -75,7 +88,7 @@ static void BM_AddInt64Values(benchmark::State& state) {
 
   // Create the UDF.
   ScalarUDFDefinition def("add");
-  CHECK(def.template Init<AddUDF>().ok());
+  CHECK(def.template Init<TUDF>().ok());
   auto u = def.Make();
 
   // Loop the test.
@@ -127,13 +140,14 @@ static void BM_SubStr(benchmark::State& state) {
 }
 
 // Benchmark adding two integers using arrow as the interface.
+template <typename TUDF>
 // NOLINTNEXTLINE : runtime/references.
 static void BM_AddTwoInt64sArrow(benchmark::State& state) {
   size_t size = state.range(0);
   auto arr1 = ToArrow(CreateLargeData<Int64Value>(size), arrow::default_memory_pool());
   auto arr2 = ToArrow(CreateLargeData<Int64Value>(size), arrow::default_memory_pool());
 
-  auto u = std::make_shared<AddUDF>();
+  auto u = std::make_shared<TUDF>();
   std::shared_ptr<arrow::Array> out;
   // NOLINTNEXTLINE : clang-analyzer-deadcode.DeadStores.
   for (auto _ : state) {
@@ -141,8 +155,8 @@ static void BM_AddTwoInt64sArrow(benchmark::State& state) {
       out.reset();
     }
     auto output_builder = std::make_shared<arrow::Int64Builder>();
-    auto res = ScalarUDFWrapper<AddUDF>::ExecBatchArrow(u.get(), nullptr, {arr1.get(), arr2.get()},
-                                                        output_builder.get(), size);
+    auto res = ScalarUDFWrapper<TUDF>::ExecBatchArrow(u.get(), nullptr, {arr1.get(), arr2.get()},
+                                                      output_builder.get(), size);
     CHECK(res.ok());
     CHECK(output_builder->Finish(&out).ok());
     benchmark::DoNotOptimize(out);
@@ -245,8 +259,10 @@ static void BM_SubStrArrow(benchmark::State& state) {
 }
 
 BENCHMARK(BM_AddInt64ValueToArrow)->RangeMultiplier(2)->Range(1, 1 << 16);
-BENCHMARK(BM_AddTwoInt64sArrow)->RangeMultiplier(2)->Range(1, 1 << 16);
-BENCHMARK(BM_AddInt64Values)->RangeMultiplier(2)->Range(1, 1 << 16);
+BENCHMARK_TEMPLATE(BM_AddTwoInt64sArrow, AddUDF)->RangeMultiplier(2)->Range(1, 1 << 16);
+BENCHMARK_TEMPLATE(BM_AddTwoInt64sArrow, BatchAddUDF)->RangeMultiplier(2)->Range(1, 1 << 16);
+BENCHMARK_TEMPLATE(BM_AddInt64Values, AddUDF)->RangeMultiplier(2)->Range(1, 1 << 16);
+BENCHMARK_TEMPLATE(BM_AddInt64Values, BatchAddUDF)->RangeMultiplier(2)->Range(1, 1 << 16);
 
 BENCHMARK(BM_ConvertToArrowString)->RangeMultiplier(2)->Range(1, 1 << 16);
 BENCHMARK(BM_ConvertToArrowInt64)->RangeMultiplier(2)->Range(1, 1 << 16);
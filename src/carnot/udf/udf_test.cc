@@ -19,6 +19,7 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include <iostream>
+#include <string>
 #include <type_traits>
 
 #include "src/carnot/udf/udf_wrapper.h"
@@ -51,6 +52,25 @@ TEST(ScalarUDF, basic_tests) {
   EXPECT_TRUE(ScalarUDFTraits<ScalarUDF1WithInit>::HasInit());
 }
 
+class ScalarUDF1WithExecBatch : ScalarUDF {
+ public:
+  types::Int64Value Exec(FunctionContext*, types::BoolValue, types::Int64Value) { return 0; }
+  void ExecBatch(FunctionContext*, size_t, int64_t*, const bool*, const int64_t*) {}
+};
+
+class StringUDFWithExecBatch : ScalarUDF {
+ public:
+  types::Int64Value Exec(FunctionContext*, types::StringValue) { return 0; }
+  void ExecBatch(FunctionContext*, size_t, int64_t*, const std::string*) {}
+};
+
+TEST(ScalarUDF, exec_batch) {
+  EXPECT_FALSE(ScalarUDFTraits<ScalarUDF1>::HasExecBatch());
+  EXPECT_TRUE(ScalarUDFTraits<ScalarUDF1WithExecBatch>::HasExecBatch());
+  // Strings aren't stored contiguously, so they always use the row at a time path.
+  EXPECT_FALSE(ScalarUDFTraits<StringUDFWithExecBatch>::HasExecBatch());
+}
+
 TEST(UDFDataTypes, valid_tests) {
   EXPECT_TRUE((true == types::IsValidValueType<types::BoolValue>::value));
   EXPECT_TRUE((true == types::IsValidValueType<types::Int64Value>::value));
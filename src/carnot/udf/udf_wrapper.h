@@ -22,6 +22,8 @@
 
 #include <memory>
 #include <string>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 #include "src/carnot/udf/udf.h"
@@ -133,6 +135,89 @@ Status ExecWrapperArrow(TUDF* udf, FunctionContext* ctx, size_t count, TOutput*
   return Status::OK();
 }
 
+/**
+ * Reinterprets the values of a fixed size column wrapper as an array of native values. This is
+ * valid since each value type only holds its native value.
+ */
+template <types::DataType T>
+inline auto NativeValues(const types::BaseValueType* values) {
+  using value_type = typename types::DataTypeTraits<T>::value_type;
+  using native_type = typename types::DataTypeTraits<T>::native_type;
+  static_assert(sizeof(value_type) == sizeof(native_type), "value type must only hold its value");
+  return reinterpret_cast<const native_type*>(static_cast<const value_type*>(values));
+}
+
+/**
+ * This is the inner wrapper for UDFs with an ExecBatch function, which is called once for the
+ * whole batch.
+ */
+template <typename TUDF, typename TOutput, std::size_t... I>
+Status ExecBatchWrapper(TUDF* udf, FunctionContext* ctx, size_t count, TOutput* out,
+                        const std::vector<const types::BaseValueType*>& args,
+                        std::index_sequence<I...>) {
+  [[maybe_unused]] constexpr auto exec_argument_types = ScalarUDFTraits<TUDF>::ExecArguments();
+  constexpr types::DataType return_type = ScalarUDFTraits<TUDF>::ReturnType();
+  using native_type = typename types::DataTypeTraits<return_type>::native_type;
+  static_assert(sizeof(TOutput) == sizeof(native_type), "value type must only hold its value");
+  udf->ExecBatch(ctx, count, reinterpret_cast<native_type*>(out),
+                 NativeValues<exec_argument_types[I]>(args[I])...);
+  return Status::OK();
+}
+
+/**
+ * ArrowNativeValues exposes the values of an arrow array as an array of native values. Boolean
+ * arrays are bitmaps, so they are unpacked into one bool per value.
+ */
+template <types::DataType T>
+class ArrowNativeValues {
+ public:
+  using native_type = typename types::DataTypeTraits<T>::native_type;
+
+  explicit ArrowNativeValues(const arrow::Array* arr) {
+    if constexpr (T == types::BOOLEAN) {
+      const auto* bool_arr = static_cast<const arrow::BooleanArray*>(arr);
+      unpacked_ = std::make_unique<bool[]>(arr->length());
+      for (int64_t i = 0; i < arr->length(); ++i) {
+        unpacked_[i] = bool_arr->Value(i);
+      }
+      values_ = unpacked_.get();
+    } else {
+      values_ = arr->data()->GetValues<native_type>(1);
+    }
+  }
+
+  const native_type* values() const { return values_; }
+
+ private:
+  const native_type* values_ = nullptr;
+  std::unique_ptr<bool[]> unpacked_;
+};
+
+/**
+ * This is the inner wrapper for UDFs with an ExecBatch function, for the arrow type. The results
+ * are computed into a native array and then appended to the output builder in one go.
+ */
+template <typename TUDF, typename TOutput, std::size_t... I>
+Status ExecBatchWrapperArrow(TUDF* udf, FunctionContext* ctx, size_t count, TOutput* out,
+                             const std::vector<arrow::Array*>& args, std::index_sequence<I...>) {
+  [[maybe_unused]] static constexpr auto exec_argument_types =
+      ScalarUDFTraits<TUDF>::ExecArguments();
+  constexpr types::DataType return_type = ScalarUDFTraits<TUDF>::ReturnType();
+  using native_type = typename types::DataTypeTraits<return_type>::native_type;
+
+  std::tuple<ArrowNativeValues<exec_argument_types[I]>...> inputs(
+      ArrowNativeValues<exec_argument_types[I]>(args[I])...);
+  auto results = std::make_unique<native_type[]>(count);
+  udf->ExecBatch(ctx, count, results.get(), std::get<I>(inputs).values()...);
+
+  if constexpr (return_type == types::BOOLEAN) {
+    PX_RETURN_IF_ERROR(out->AppendValues(reinterpret_cast<const uint8_t*>(results.get()), count));
+  } else {
+    PX_RETURN_IF_ERROR(out->AppendValues(results.get(), count));
+  }
+  return Status::OK();
+}
+
 /**
  * Checks types between column wrapper and array of types::UDFDataTypes.
  * @return true if all types match.
@@ -201,10 +286,16 @@ struct ScalarUDFWrapper {
     // The outer wrapper just casts the output type and UDF type. We then pass in
     // the inputs with a sequence based on the number of arguments to iterate through and
     // cast the inputs.
-    return ExecWrapperArrow<TUDF>(
-        static_cast<TUDF*>(udf), ctx, count,
-        static_cast<typename types::DataTypeTraits<return_type>::arrow_builder_type*>(output),
-        inputs, std::make_index_sequence<exec_argument_types.size()>{});
+    auto* casted_output =
+        static_cast<typename types::DataTypeTraits<return_type>::arrow_builder_type*>(output);
+    if constexpr (ScalarUDFTraits<TUDF>::HasExecBatch()) {
+      return ExecBatchWrapperArrow<TUDF>(static_cast<TUDF*>(udf), ctx, count, casted_output,
+                                         inputs,
+                                         std::make_index_sequence<exec_argument_types.size()>{});
+    } else {
+      return ExecWrapperArrow<TUDF>(static_cast<TUDF*>(udf), ctx, count, casted_output, inputs,
+                                    std::make_index_sequence<exec_argument_types.size()>{});
+    }
   }
 
   /**
@@ -242,9 +333,15 @@ struct ScalarUDFWrapper {
     // The outer wrapper just casts the output type and UDF type. We then pass in
     // the inputs with a sequence based on the number of arguments to iterate through and
     // cast the inputs.
-    return ExecWrapper<TUDF>(static_cast<TUDF*>(udf), ctx, count, casted_output,
-                             input_as_base_value,
-                             std::make_index_sequence<exec_argument_types.size()>{});
+    if constexpr (ScalarUDFTraits<TUDF>::HasExecBatch()) {
+      return ExecBatchWrapper<TUDF>(static_cast<TUDF*>(udf), ctx, count, casted_output,
+                                    input_as_base_value,
+                                    std::make_index_sequence<exec_argument_types.size()>{});
+    } else {
+      return ExecWrapper<TUDF>(static_cast<TUDF*>(udf), ctx, count, casted_output,
+                               input_as_base_value,
+                               std::make_index_sequence<exec_argument_types.size()>{});
+    }
   }
 
   /**
@@ -310,6 +407,21 @@ Status UpdateWrapperArrow(TUDA* uda, FunctionContext* ctx, size_t count,
   return Status::OK();
 }
 
+/**
+ * Performs an update on the given rows of a batch of records (arrow).
+ */
+template <typename TUDA, std::size_t... I>
+Status UpdateWrapperArrowRows(TUDA* uda, FunctionContext* ctx, const int64_t* rows,
+                              size_t num_rows, const std::vector<const arrow::Array*>& args,
+                              std::index_sequence<I...>) {
+  constexpr auto update_argument_types = UDATraits<TUDA>::UpdateArgumentTypes();
+  for (size_t idx = 0; idx < num_rows; ++idx) {
+    uda->Update(ctx,
+                types::GetValueFromArrowArray<update_argument_types[I]>(args[I], rows[idx])...);
+  }
+  return Status::OK();
+}
+
 /**
  * Provides a set of static methods that wrap UDAs and allow vectorized execution (for update).
  * @tparam TUDA The UDA class.
@@ -362,6 +474,25 @@ struct UDAWrapper {
                                     std::make_index_sequence<update_argument_types.size()>{});
   }
 
+  /**
+   * Perform a batch update of the passed in UDA based on the given rows of the inputs.
+   * @param uda The UDA instances.
+   * @param ctx The function context.
+   * @param inputs A vector of pointers to arrow arrays.
+   * @param rows The indices of the rows of the inputs to update with, in update order.
+   * @param num_rows The number of indices in rows.
+   * @return Status of update.
+   */
+  static Status ExecBatchUpdateArrowRows(UDA* uda, FunctionContext* ctx,
+                                         const std::vector<const arrow::Array*>& inputs,
+                                         const int64_t* rows, size_t num_rows) {
+    constexpr auto update_argument_types = UDATraits<TUDA>::UpdateArgumentTypes();
+    DCHECK(inputs.size() == update_argument_types.size());
+
+    return UpdateWrapperArrowRows<TUDA>(static_cast<TUDA*>(uda), ctx, rows, num_rows, inputs,
+                                        std::make_index_sequence<update_argument_types.size()>{});
+  }
+
   /**
    * Call the UDA's init method.
    *
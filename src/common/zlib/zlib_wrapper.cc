@@ -60,5 +60,35 @@ StatusOr<std::string> Inflate(std::string_view in, size_t output_block_size) {
   return out;
 }
 
+StatusOr<std::string> Compress(std::string_view in, int level) {
+  uLongf out_size = compressBound(in.size());
+  std::string out(out_size, '\0');
+
+  int ret = compress2(reinterpret_cast<Bytef*>(out.data()), &out_size,
+                      reinterpret_cast<const Bytef*>(in.data()), in.size(), level);
+  if (ret != Z_OK) {
+    return error::Internal("zlib compression failed with error code $0.", ret);
+  }
+
+  out.resize(out_size);
+  return out;
+}
+
+StatusOr<std::string> Uncompress(std::string_view in, size_t uncompressed_size) {
+  std::string out(uncompressed_size, '\0');
+  uLongf out_size = uncompressed_size;
+
+  int ret = uncompress(reinterpret_cast<Bytef*>(out.data()), &out_size,
+                       reinterpret_cast<const Bytef*>(in.data()), in.size());
+  if (ret != Z_OK) {
+    return error::Internal("zlib decompression failed with error code $0.", ret);
+  }
+  if (out_size != uncompressed_size) {
+    return error::Internal("zlib decompression produced $0 bytes, expected $1.", out_size,
+                           uncompressed_size);
+  }
+  return out;
+}
+
 }  // namespace zlib
 }  // namespace px
@@ -35,5 +35,23 @@ namespace zlib {
  */
 StatusOr<std::string> Inflate(std::string_view in, size_t output_block_size = 16384);
 
+/**
+ * @brief Compresses a source buffer into the zlib format, in a single block.
+ *
+ * @param in A view into the source buffer.
+ * @param level The zlib compression level (0-9). Lower levels trade compression ratio for speed.
+ * @return Status or the compressed content as a string.
+ */
+StatusOr<std::string> Compress(std::string_view in, int level = 1);
+
+/**
+ * @brief Decompresses a buffer produced by Compress().
+ *
+ * @param in A view into the compressed buffer.
+ * @param uncompressed_size The exact size of the original uncompressed content.
+ * @return Status or the decompressed content as a string.
+ */
+StatusOr<std::string> Uncompress(std::string_view in, size_t uncompressed_size);
+
 }  // namespace zlib
 }  // namespace px
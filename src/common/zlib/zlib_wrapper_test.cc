@@ -46,4 +46,21 @@ TEST_F(ZlibTest, inflate_test) {
   EXPECT_OK_AND_EQ(result, GetExpectedResult());
 }
 
+TEST_F(ZlibTest, compress_uncompress_roundtrip) {
+  std::string input;
+  for (int i = 0; i < 100; ++i) {
+    input += GetExpectedResult();
+  }
+  ASSERT_OK_AND_ASSIGN(std::string compressed, px::zlib::Compress(input));
+  EXPECT_LT(compressed.size(), input.size());
+
+  auto result = px::zlib::Uncompress(compressed, input.size());
+  EXPECT_OK_AND_EQ(result, input);
+}
+
+TEST_F(ZlibTest, uncompress_wrong_size) {
+  ASSERT_OK_AND_ASSIGN(std::string compressed, px::zlib::Compress(GetExpectedResult()));
+  EXPECT_NOT_OK(px::zlib::Uncompress(compressed, GetExpectedResult().size() - 1));
+}
+
 }  // namespace px
@@ -132,6 +132,22 @@ static void BM_elf_reader_symbolization_indexed(benchmark::State& state) {
   }
 }
 
+// Measures the cost of indexing the symbols of a binary, which is paid once per binary.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_elf_reader_build_symbolizer(benchmark::State& state) {
+  PX_ASSIGN_OR_EXIT(std::filesystem::path self_path, ::px::fs::ReadSymlink("/proc/self/exe"));
+
+  size_t num_symbols = 0;
+  for (auto _ : state) {
+    PX_ASSIGN_OR_EXIT(auto elf_reader, ElfReader::Create(self_path.string()));
+    PX_ASSIGN_OR_EXIT(std::unique_ptr<ElfReader::Symbolizer> symbolizer,
+                      elf_reader->GetSymbolizer());
+    num_symbols = symbolizer->num_symbols();
+    benchmark::DoNotOptimize(symbolizer);
+  }
+  state.counters["num_symbols"] = num_symbols;
+}
+
 // NOLINTNEXTLINE : runtime/references.
 static void BM_bcc_symbolization(benchmark::State& state) {
   BCCWrapperImpl bcc_wrapper;
@@ -153,3 +169,4 @@ static void BM_bcc_symbolization(benchmark::State& state) {
 BENCHMARK(BM_bcc_symbolization);
 BENCHMARK(BM_elf_reader_symbolization);
 BENCHMARK(BM_elf_reader_symbolization_indexed);
+BENCHMARK(BM_elf_reader_build_symbolizer);
@@ -33,6 +33,9 @@ int main(int argc, char** argv) {
     printf("    Argument: PID\n");
     printf("    Positive PID values enable tracing; negative PID values disable tracing.\n");
     printf("    Note: Can be used multiple times to enable/disable tracing of multiple PIDs.\n");
+    printf("  opcode 3: Limit the bytes of each read/write of a protocol that are traced\n");
+    printf("    Argument: (protocol << 24) | limit_bytes\n");
+    printf("    The protocol is a traffic_protocol_t value; a limit of 0 removes the limit.\n");
     printf("\n");
     printf("Remember to use sudo if required.");
     printf("\n");
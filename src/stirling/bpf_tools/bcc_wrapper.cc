@@ -23,6 +23,9 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
+
+#include <bcc/libbpf.h>
 
 #include <magic_enum.hpp>
 
@@ -401,6 +404,101 @@ void BCCWrapperImpl::ClosePerfBuffers() {
   perf_buffer_specs_.clear();
 }
 
+bool BCCWrapper::RingBuffersSupported() {
+  // BPF_MAP_TYPE_RINGBUF was introduced in Linux 5.8.
+  constexpr uint32_t kLinux5p8VersionCode = 329728;
+  return system::GetCachedKernelVersion().code() >= kLinux5p8VersionCode;
+}
+
+int BCCWrapper::RingBufferNumPages(size_t size_bytes) {
+  const size_t page_size_bytes = system::Config::GetInstance().PageSizeBytes();
+  int num_pages = 1;
+  while (2 * num_pages * page_size_bytes <= size_bytes) {
+    num_pages *= 2;
+  }
+  return num_pages;
+}
+
+int BCCWrapperImpl::HandleRingBufferEvent(void* ctx, void* data, size_t data_size) {
+  auto* ring_buffer = static_cast<RingBufferState*>(ctx);
+  ring_buffer->spec.probe_output_fn(ring_buffer->spec.cb_cookie, data,
+                                    static_cast<int>(data_size));
+  return 0;
+}
+
+Status BCCWrapperImpl::OpenRingBuffer(const RingBufferSpec& ring_buffer_spec) {
+  DCHECK(ring_buffer_spec.cb_cookie != nullptr) << "ring_buffer_spec.cb_cookie must be non-null.";
+  VLOG(1) << absl::Substitute("Opening ring buffer: [$0]", ring_buffer_spec.ToString());
+
+  const int fd = bpf_.get_table(ring_buffer_spec.name).get_fd();
+  if (fd < 0) {
+    return error::NotFound("Ring buffer \"$0\" not found.", ring_buffer_spec.name);
+  }
+
+  auto state = std::make_unique<RingBufferState>();
+  state->spec = ring_buffer_spec;
+
+  if (ring_buffer_ == nullptr) {
+    ring_buffer_ =
+        static_cast<struct ring_buffer*>(bpf_new_ringbuf(fd, &HandleRingBufferEvent, state.get()));
+    if (ring_buffer_ == nullptr) {
+      return error::Internal("Failed to open ring buffer \"$0\".", ring_buffer_spec.name);
+    }
+  } else if (bpf_add_ringbuf(ring_buffer_, fd, &HandleRingBufferEvent, state.get()) != 0) {
+    return error::Internal("Failed to open ring buffer \"$0\".", ring_buffer_spec.name);
+  }
+
+  ring_buffers_.push_back(std::move(state));
+  ++num_open_ring_buffers_;
+  return Status::OK();
+}
+
+Status BCCWrapperImpl::OpenRingBuffers(const ArrayView<RingBufferSpec>& ring_buffers) {
+  for (const RingBufferSpec& r : ring_buffers) {
+    PX_RETURN_IF_ERROR(OpenRingBuffer(r));
+  }
+  return Status::OK();
+}
+
+void BCCWrapperImpl::PollRingBuffers() {
+  if (ring_buffer_ == nullptr) {
+    return;
+  }
+  bpf_consume_ringbuf(ring_buffer_);
+
+  for (auto& ring_buffer : ring_buffers_) {
+    const RingBufferSpec& spec = ring_buffer->spec;
+    if (spec.lost_events_map.empty() || spec.probe_loss_fn == nullptr) {
+      continue;
+    }
+    std::vector<uint64_t> per_cpu_lost_events;
+    auto s = bpf_.get_percpu_array_table<uint64_t>(spec.lost_events_map)
+                 .get_value(spec.lost_events_index, per_cpu_lost_events);
+    if (!s.ok()) {
+      LOG(ERROR) << absl::Substitute("Failed to read lost events of ring buffer $0: $1", spec.name,
+                                     s.msg());
+      continue;
+    }
+    uint64_t lost_events = 0;
+    for (uint64_t n : per_cpu_lost_events) {
+      lost_events += n;
+    }
+    if (lost_events > ring_buffer->lost_events) {
+      spec.probe_loss_fn(spec.cb_cookie, lost_events - ring_buffer->lost_events);
+      ring_buffer->lost_events = lost_events;
+    }
+  }
+}
+
+void BCCWrapperImpl::CloseRingBuffers() {
+  if (ring_buffer_ != nullptr) {
+    bpf_free_ringbuf(ring_buffer_);
+    ring_buffer_ = nullptr;
+  }
+  num_open_ring_buffers_ -= ring_buffers_.size();
+  ring_buffers_.clear();
+}
+
 Status BCCWrapperImpl::AttachPerfEvent(const PerfEventSpec& perf_event) {
   VLOG(1) << absl::Substitute("Attaching perf event:\n   type=$0\n   probe_fn=$1",
                               magic_enum::enum_name(perf_event.type), perf_event.probe_fn);
@@ -462,6 +560,7 @@ void BCCWrapperImpl::PollPerfBuffers(const int timeout_ms) {
 void BCCWrapperImpl::Close() {
   DetachPerfEvents();
   ClosePerfBuffers();
+  CloseRingBuffers();
   DetachKProbes();
   DetachUProbes();
   DetachTracepoints();
@@ -146,6 +146,26 @@ class BCCWrapper {
    */
   virtual Status OpenPerfBuffer(const PerfBufferSpec& perf_buffer) = 0;
 
+  /**
+   * Returns true if the kernel supports BPF ring buffers (Linux 5.8+).
+   * Callers should fall back to perf buffers otherwise.
+   */
+  static bool RingBuffersSupported();
+
+  /**
+   * Returns the number of pages to declare with BPF_RINGBUF_OUTPUT for a ring buffer of at most
+   * size_bytes. Ring buffers must be a power of two pages in size, so this rounds down, but never
+   * returns fewer than one page.
+   */
+  static int RingBufferNumPages(size_t size_bytes);
+
+  /**
+   * Open a ring buffer for reading events.
+   * @param ring_buffer Specifications of the ring buffer (name, callback function, etc.).
+   * @return Error if ring buffer cannot be opened (e.g. ring buffer does not exist).
+   */
+  virtual Status OpenRingBuffer(const RingBufferSpec& ring_buffer) = 0;
+
   /**
    * Attach a perf event, which runs a probe every time a perf counter reaches a threshold
    * condition.
@@ -194,6 +214,13 @@ class BCCWrapper {
    */
   virtual Status OpenPerfBuffers(const ArrayView<PerfBufferSpec>& perf_buffers) = 0;
 
+  /**
+   * Convenience function that opens multiple ring buffers.
+   * @param ring_buffers Vector of ring buffer descriptors.
+   * @return Error of first failure (remaining ring buffer opens are not attempted).
+   */
+  virtual Status OpenRingBuffers(const ArrayView<RingBufferSpec>& ring_buffers) = 0;
+
   /**
    * Convenience function that opens multiple perf events.
    * @param probes Vector of perf event descriptors.
@@ -235,6 +262,13 @@ class BCCWrapper {
    */
   virtual void PollPerfBuffers(const int timeout_ms = 0) = 0;
 
+  /**
+   * Drains all of the opened ring buffers, in the order they were opened, calling the handle
+   * function that was specified in the RingBufferSpec. Also reports the events that were dropped
+   * since the previous call through the loss function.
+   */
+  virtual void PollRingBuffers() = 0;
+
   /**
    * Detaches all probes, and closes all perf buffers that are open.
    */
@@ -244,6 +278,7 @@ class BCCWrapper {
   // It is meant for verification that we have cleaned-up all resources in tests.
   static size_t num_attached_probes() { return num_attached_kprobes_ + num_attached_uprobes_; }
   static size_t num_open_perf_buffers() { return num_open_perf_buffers_; }
+  static size_t num_open_ring_buffers() { return num_open_ring_buffers_; }
   static size_t num_attached_perf_events() { return num_attached_perf_events_; }
 
   virtual Status ClosePerfBuffer(const PerfBufferSpec& perf_buffer) = 0;
@@ -259,6 +294,7 @@ class BCCWrapper {
   inline static size_t num_attached_uprobes_;
   inline static size_t num_attached_tracepoints_;
   inline static size_t num_open_perf_buffers_;
+  inline static size_t num_open_ring_buffers_;
   inline static size_t num_attached_perf_events_;
 
  private:
@@ -290,6 +326,7 @@ class BCCWrapperImpl : public BCCWrapper {
   Status AttachTracepoint(const TracepointSpec& probe) override;
   Status AttachSamplingProbe(const SamplingProbeSpec& probe) override;
   Status OpenPerfBuffer(const PerfBufferSpec& perf_buffer) override;
+  Status OpenRingBuffer(const RingBufferSpec& ring_buffer) override;
   Status AttachPerfEvent(const PerfEventSpec& perf_event) override;
   Status AttachKProbes(const ArrayView<KProbeSpec>& probes) override;
   Status AttachTracepoints(const ArrayView<TracepointSpec>& probes) override;
@@ -297,6 +334,7 @@ class BCCWrapperImpl : public BCCWrapper {
   Status AttachSamplingProbes(const ArrayView<SamplingProbeSpec>& probes) override;
   Status AttachXDP(const std::string& dev_name, const std::string& fn_name) override;
   Status OpenPerfBuffers(const ArrayView<PerfBufferSpec>& perf_buffers) override;
+  Status OpenRingBuffers(const ArrayView<RingBufferSpec>& ring_buffers) override;
   Status AttachPerfEvents(const ArrayView<PerfEventSpec>& perf_events) override;
   Status PopulateBPFPerfArray(const std::string& table_name, const uint32_t type,
                               const uint64_t config) override {
@@ -305,11 +343,21 @@ class BCCWrapperImpl : public BCCWrapper {
   }
   void PollPerfBuffers(const int timeout_ms = 0) override;
   Status PollPerfBuffer(const std::string& name, const int timeout_ms = 0) override;
+  void PollRingBuffers() override;
   void Close() override;
 
   Status ClosePerfBuffer(const PerfBufferSpec& perf_buffer) override;
 
  private:
+  // An open ring buffer, and the number of lost events reported for it so far.
+  struct RingBufferState {
+    RingBufferSpec spec;
+    uint64_t lost_events = 0;
+  };
+
+  // Adapts the ring buffer callback to the perf buffer style callback of the spec.
+  static int HandleRingBufferEvent(void* ctx, void* data, size_t data_size);
+
   FRIEND_TEST(BCCWrapperTest, DetachUProbe);
 
   Status DetachKProbe(const KProbeSpec& probe);
@@ -323,6 +371,7 @@ class BCCWrapperImpl : public BCCWrapper {
   void DetachUProbes();
   void DetachTracepoints();
   void ClosePerfBuffers();
+  void CloseRingBuffers();
   void DetachPerfEvents();
 
   // Returns the name that identifies the target to attach this k-probe.
@@ -333,6 +382,11 @@ class BCCWrapperImpl : public BCCWrapper {
   std::vector<TracepointSpec> tracepoints_;
   std::vector<PerfEventSpec> perf_events_;
 
+  // All ring buffers are polled through a single ring_buffer object. The states are the callback
+  // contexts, so they must not move once opened.
+  struct ring_buffer* ring_buffer_ = nullptr;
+  std::vector<std::unique_ptr<RingBufferState>> ring_buffers_;
+
  protected:
   std::vector<PerfBufferSpec> perf_buffer_specs_;
 
@@ -362,6 +416,11 @@ class RecordingBCCWrapperImpl : public BCCWrapperImpl {
 
   Status OpenPerfBuffer(const PerfBufferSpec& perf_buffer) override;
 
+  // Only perf buffer events can be recorded, so the callers fall back to perf buffers.
+  Status OpenRingBuffer(const RingBufferSpec& ring_buffer) override {
+    return error::Unimplemented("Cannot record ring buffer $0.", ring_buffer.name);
+  }
+
   RecordingBCCWrapperImpl() { recorder_ = std::make_unique<BPFRecorder>(); }
 
   void WriteProto(const std::string& pb_file_path) { recorder_->WriteProto(pb_file_path); }
@@ -440,6 +499,18 @@ class ReplayingBCCWrapperImpl : public BCCWrapper {
 
   Status ClosePerfBuffer(const PerfBufferSpec&) override { return Status::OK(); }
 
+  // Only perf buffer events are recorded, so there is nothing to replay through ring buffers.
+  Status OpenRingBuffer(const RingBufferSpec& spec) override {
+    return error::Unimplemented("Cannot replay ring buffer $0.", spec.name);
+  }
+  Status OpenRingBuffers(const ArrayView<RingBufferSpec>& specs) override {
+    for (const auto& spec : specs) {
+      PX_RETURN_IF_ERROR(OpenRingBuffer(spec));
+    }
+    return Status::OK();
+  }
+  void PollRingBuffers() override {}
+
   Status OpenReplayProtobuf(const std::string& file_path) {
     return replayer_->OpenReplayProtobuf(file_path);
   }
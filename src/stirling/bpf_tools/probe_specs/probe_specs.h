@@ -195,6 +195,36 @@ struct PerfBufferSpec {
   }
 };
 
+/**
+ * Describes a BPF ring buffer (BPF_MAP_TYPE_RINGBUF), through which data is returned to user-space.
+ * Unlike perf buffers, a single ring buffer is shared by all CPUs, so events arrive in order, and
+ * a burst on one CPU can use the space left over by the others. Requires Linux 5.8+.
+ */
+struct RingBufferSpec {
+  // Name of the ring buffer.
+  // Must be the same as the ring buffer name declared in the probe code with BPF_RINGBUF_OUTPUT.
+  std::string name;
+
+  // Function that will be called for every event in the ring buffer,
+  // when ring buffer read is triggered. Same signature as for perf buffers.
+  perf_reader_raw_cb probe_output_fn;
+
+  // Function that will be called with the number of events that were dropped, because the ring
+  // buffer was full. Ring buffers don't report losses themselves, so the probe code counts them in
+  // lost_events_map, a BPF_PERCPU_ARRAY of uint64_t, at index lost_events_index.
+  perf_reader_lost_cb probe_loss_fn;
+  std::string lost_events_map;
+  int lost_events_index = 0;
+
+  // Used to invoke callback.
+  void* cb_cookie;
+
+  std::string ToString() const {
+    return absl::Substitute("name=$0 lost_events_map=$1[$2]", name, lost_events_map,
+                            lost_events_index);
+  }
+};
+
 /**
  * Describes a perf event to attach.
  * This can be run stand-alone and is not dependent on kProbes.
@@ -0,0 +1,102 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/core/connector_scheduler.h"
+
+#include <utility>
+
+namespace px {
+namespace stirling {
+
+ConnectorScheduler::ConnectorScheduler(int num_threads) {
+  for (int i = 0; i < num_threads; ++i) {
+    workers_.emplace_back(&ConnectorScheduler::WorkerLoop, this);
+  }
+}
+
+ConnectorScheduler::~ConnectorScheduler() {
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    stop_ = true;
+  }
+  task_cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+bool ConnectorScheduler::Schedule(const SourceConnector* source, std::function<void()> fn) {
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    if (!in_flight_.insert(source).second) {
+      return false;
+    }
+    tasks_.push_back({source, std::move(fn)});
+  }
+  task_cv_.notify_one();
+  return true;
+}
+
+bool ConnectorScheduler::InFlight(const SourceConnector* source) const {
+  std::lock_guard<std::mutex> lock(mu_);
+  return in_flight_.contains(source);
+}
+
+void ConnectorScheduler::WaitForIdle(const SourceConnector* source) {
+  std::unique_lock<std::mutex> lock(mu_);
+  done_cv_.wait(lock, [this, source] { return !in_flight_.contains(source); });
+}
+
+void ConnectorScheduler::WaitForAllIdle() {
+  std::unique_lock<std::mutex> lock(mu_);
+  done_cv_.wait(lock, [this] { return in_flight_.empty(); });
+}
+
+void ConnectorScheduler::WaitForCompletion(std::chrono::milliseconds timeout) {
+  std::unique_lock<std::mutex> lock(mu_);
+  done_cv_.wait_for(lock, timeout, [this] { return num_completed_ != num_completed_seen_; });
+  num_completed_seen_ = num_completed_;
+}
+
+void ConnectorScheduler::WorkerLoop() {
+  while (true) {
+    Task task;
+    {
+      std::unique_lock<std::mutex> lock(mu_);
+      task_cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+      if (tasks_.empty()) {
+        // Only reached when stopping. Queued tasks are always drained first.
+        return;
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+
+    task.fn();
+
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      in_flight_.erase(task.source);
+      ++num_completed_;
+    }
+    done_cv_.notify_all();
+  }
+}
+
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,99 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <absl/container/flat_hash_set.h>
+
+#include "src/common/base/base.h"
+#include "src/stirling/core/source_connector.h"
+
+namespace px {
+namespace stirling {
+
+/**
+ * ConnectorScheduler runs the TransferData() and PushData() work of thread-safe source connectors
+ * on a small pool of worker threads, so that one slow connector does not hold up the sampling of
+ * the others. At most one task per connector is in flight at any time, so a connector's own state
+ * never needs to be protected against concurrent calls.
+ */
+class ConnectorScheduler : public NotCopyable {
+ public:
+  explicit ConnectorScheduler(int num_threads);
+  ~ConnectorScheduler();
+
+  int num_threads() const { return static_cast<int>(workers_.size()); }
+
+  /**
+   * Queues fn to run on a worker thread on behalf of source.
+   * @return false, without queuing fn, if a previous task of the source is still in flight.
+   */
+  bool Schedule(const SourceConnector* source, std::function<void()> fn);
+
+  /**
+   * Returns true if a task of the source is queued or running.
+   */
+  bool InFlight(const SourceConnector* source) const;
+
+  /**
+   * Blocks until no task of the source is in flight.
+   */
+  void WaitForIdle(const SourceConnector* source);
+
+  /**
+   * Blocks until no task is in flight.
+   */
+  void WaitForAllIdle();
+
+  /**
+   * Blocks until the timeout expires, or until a task completes. Completions that happened since
+   * the previous call return immediately, so none are missed by a single waiting thread.
+   */
+  void WaitForCompletion(std::chrono::milliseconds timeout);
+
+ private:
+  struct Task {
+    const SourceConnector* source;
+    std::function<void()> fn;
+  };
+
+  void WorkerLoop();
+
+  mutable std::mutex mu_;
+  std::condition_variable task_cv_;
+  std::condition_variable done_cv_;
+
+  std::deque<Task> tasks_;
+  absl::flat_hash_set<const SourceConnector*> in_flight_;
+  uint64_t num_completed_ = 0;
+  uint64_t num_completed_seen_ = 0;
+  bool stop_ = false;
+
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,103 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/core/connector_scheduler.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "src/stirling/source_connectors/seq_gen/seq_gen_connector.h"
+
+namespace px {
+namespace stirling {
+
+TEST(ConnectorSchedulerTest, OneTaskPerSourceInFlight) {
+  auto source = SeqGenConnector::Create("seq_gen");
+  ConnectorScheduler scheduler(2);
+  EXPECT_EQ(scheduler.num_threads(), 2);
+
+  std::atomic<bool> release = false;
+  std::atomic<int> num_runs = 0;
+  auto task = [&] {
+    while (!release) {
+      std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    ++num_runs;
+  };
+
+  EXPECT_TRUE(scheduler.Schedule(source.get(), task));
+  EXPECT_TRUE(scheduler.InFlight(source.get()));
+  // The source's first task blocks, so a second one is refused.
+  EXPECT_FALSE(scheduler.Schedule(source.get(), task));
+
+  release = true;
+  scheduler.WaitForIdle(source.get());
+  EXPECT_FALSE(scheduler.InFlight(source.get()));
+  EXPECT_EQ(num_runs, 1);
+
+  EXPECT_TRUE(scheduler.Schedule(source.get(), task));
+  scheduler.WaitForAllIdle();
+  EXPECT_EQ(num_runs, 2);
+}
+
+TEST(ConnectorSchedulerTest, SourcesRunConcurrently) {
+  auto slow_source = SeqGenConnector::Create("slow");
+  auto fast_source = SeqGenConnector::Create("fast");
+  ConnectorScheduler scheduler(2);
+
+  std::atomic<bool> release = false;
+  EXPECT_TRUE(scheduler.Schedule(slow_source.get(), [&] {
+    while (!release) {
+      std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+  }));
+
+  // The fast source completes while the slow source is still running.
+  std::atomic<bool> fast_done = false;
+  EXPECT_TRUE(scheduler.Schedule(fast_source.get(), [&] { fast_done = true; }));
+  scheduler.WaitForIdle(fast_source.get());
+  EXPECT_TRUE(fast_done);
+  EXPECT_TRUE(scheduler.InFlight(slow_source.get()));
+
+  release = true;
+  scheduler.WaitForAllIdle();
+}
+
+TEST(ConnectorSchedulerTest, WaitForCompletion) {
+  auto source = SeqGenConnector::Create("seq_gen");
+  ConnectorScheduler scheduler(1);
+
+  // Nothing completes, so this waits for the full timeout.
+  auto start = std::chrono::steady_clock::now();
+  scheduler.WaitForCompletion(std::chrono::milliseconds{20});
+  EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds{20});
+
+  // A completion that happened before the wait is not missed.
+  EXPECT_TRUE(scheduler.Schedule(source.get(), [] {}));
+  scheduler.WaitForIdle(source.get());
+  start = std::chrono::steady_clock::now();
+  scheduler.WaitForCompletion(std::chrono::seconds{10});
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds{10});
+}
+
+}  // namespace stirling
+}  // namespace px
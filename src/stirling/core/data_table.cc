@@ -59,6 +59,31 @@ Tablet* DataTable::GetTablet(types::TabletIDView tablet_id) {
   return &tablet;
 }
 
+namespace {
+template <types::DataType TDataType>
+void MoveColumnValues(ColumnWrapper* src, ColumnWrapper* dst) {
+  using TValueType = typename types::DataTypeTraits<TDataType>::value_type;
+  for (size_t i = 0; i < src->Size(); ++i) {
+    dst->Append<TValueType>(std::move(src->Get<TValueType>(i)));
+  }
+}
+}  // namespace
+
+void DataTable::AppendRecords(DataTable* other) {
+  DCHECK_EQ(&table_schema_, &other->table_schema_);
+  for (auto& [tablet_id, src] : other->tablets_) {
+    Tablet* dst = GetTablet(tablet_id);
+    for (size_t col = 0; col < src.records.size(); ++col) {
+      types::DataType type = table_schema_.elements()[col].type();
+#define TYPE_CASE(_dt_) MoveColumnValues<_dt_>(src.records[col].get(), dst->records[col].get());
+      PX_SWITCH_FOREACH_DATATYPE(type, TYPE_CASE);
+#undef TYPE_CASE
+    }
+    dst->times.insert(dst->times.end(), src.times.begin(), src.times.end());
+  }
+  other->tablets_.clear();
+}
+
 std::vector<TaggedRecordBatch> DataTable::ConsumeRecords() {
   std::vector<TaggedRecordBatch> tablets_out;
   absl::flat_hash_map<types::TabletID, Tablet> carryover_tablets;
@@ -83,6 +83,14 @@ class DataTable : public NotCopyable {
     cutoff_time_ = cutoff_time;
   }
 
+  /**
+   * Moves all of the records buffered in another data table of the same schema into this table.
+   * Used to combine the records of tables that were filled in parallel.
+   *
+   * @param other The table to take the records from. It is left empty.
+   */
+  void AppendRecords(DataTable* other);
+
   /**
    * Return current occupancy of the Data Table.
    *
@@ -69,6 +69,37 @@ TEST_F(DataTableTest, ResultIsSorted) {
   }
 }
 
+TEST_F(DataTableTest, AppendRecords) {
+  std::vector<int> time_vals = {0, 10, 40, 20, 30, 50, 90, 70, 60, 80};
+  std::vector<int> x_vals = {0, 1, 4, 2, 3, 5, 9, 7, 6, 8};
+  std::vector<std::string> s_vals = {"a", "b", "e", "c", "d", "f", "j", "h", "g", "i"};
+
+  // Split the records between two tables, as if they were built in parallel.
+  DataTable other_table(/*id*/ 0, kSchema);
+  for (size_t i = 0; i < time_vals.size(); ++i) {
+    DataTable* table = (i % 2 == 0) ? data_table_.get() : &other_table;
+    DataTable::RecordBuilder<&kSchema> r(table, time_vals[i]);
+    r.Append<r.ColIndex("time_")>(time_vals[i]);
+    r.Append<r.ColIndex("x")>(x_vals[i]);
+    r.Append<r.ColIndex("s")>(s_vals[i]);
+  }
+
+  data_table_->AppendRecords(&other_table);
+  EXPECT_EQ(other_table.Occupancy(), 0);
+  EXPECT_EQ(data_table_->Occupancy(), time_vals.size());
+
+  std::vector<TaggedRecordBatch> record_batches = data_table_->ConsumeRecords();
+
+  ASSERT_EQ(record_batches.size(), 1);
+  types::ColumnWrapperRecordBatch& rb = record_batches[0].records;
+
+  for (size_t i = 0; i < time_vals.size(); ++i) {
+    EXPECT_EQ(rb[0]->Get<types::Time64NSValue>(i), 10 * static_cast<int>(i));
+    EXPECT_EQ(rb[1]->Get<types::Int64Value>(i), static_cast<int>(i));
+    EXPECT_EQ(rb[2]->Get<types::StringValue>(i), std::string(1, 'a' + i));
+  }
+}
+
 // No time passed to RecordBuilder, so all timestamps should be zero.
 // That means there should never be any expired or carry-over records.
 // Also, nothing should be sorted in any way.
@@ -87,6 +87,13 @@ class SourceConnector : public NotCopyable {
 
   const std::string& name() const { return source_name_; }
 
+  /**
+   * Returns true if TransferData() and PushData() may be called from a Stirling worker thread,
+   * concurrently with the other source connectors. Calls on the same connector are never
+   * concurrent with each other, either way.
+   */
+  virtual bool thread_safe() const { return false; }
+
   const ArrayView<DataTableSchema>& table_schemas() const { return table_schemas_; }
 
   static constexpr uint32_t TableNum(ArrayView<DataTableSchema> tables,
@@ -121,6 +128,9 @@ class SourceConnector : public NotCopyable {
   virtual void SetDebugLevel(int level) { debug_level_ = level; }
   virtual void EnablePIDTrace(int pid) { pids_to_trace_.insert(pid); }
   virtual void DisablePIDTrace(int pid) { pids_to_trace_.erase(pid); }
+  // Limits how many bytes of each read/write of the protocol are traced (0 for no limit).
+  // Only the SocketTracer currently implements this.
+  virtual void SetCaptureLimit(int /*protocol*/, uint32_t /*limit_bytes*/) {}
 
   FrequencyManager& sampling_freq_mgr() { return sampling_freq_mgr_; }
   FrequencyManager& push_freq_mgr() { return push_freq_mgr_; }
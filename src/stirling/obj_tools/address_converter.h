@@ -32,6 +32,7 @@ class ElfAddressConverter {
   static StatusOr<std::unique_ptr<ElfAddressConverter>> Create(ElfReader* elf_reader, int64_t pid);
   uint64_t VirtualAddrToBinaryAddr(uint64_t virtual_addr) const;
   uint64_t BinaryAddrToVirtualAddr(uint64_t binary_addr) const;
+  int64_t virtual_to_binary_addr_offset() const { return virtual_to_binary_addr_offset_; }
 
  private:
   explicit ElfAddressConverter(int64_t offset) : virtual_to_binary_addr_offset_(offset) {}
@@ -21,8 +21,11 @@
 #include "src/common/base/base.h"
 #include "src/common/testing/test_environment.h"
 #include "src/stirling/obj_tools/dwarf_reader.h"
+#include "src/stirling/obj_tools/elf_reader.h"
 
 using px::stirling::obj_tools::DwarfReader;
+using px::stirling::obj_tools::ElfReader;
+using px::stirling::obj_tools::SymbolMatchType;
 using px::testing::BazelRunfilePath;
 
 constexpr std::string_view kBinary =
@@ -105,5 +108,18 @@ static void BM_indexed(benchmark::State& state) {
   }
 }
 
+// The symbol table scan that accompanies the DWARF lookups when deploying uprobes on Go binaries
+// (see ExtractGolangInterfaces()).
+// NOLINTNEXTLINE : runtime/references.
+static void BM_elf_symbol_search(benchmark::State& state) {
+  for (auto _ : state) {
+    PX_ASSIGN_OR_EXIT(std::unique_ptr<ElfReader> elf_reader, ElfReader::Create(kBinary));
+    PX_ASSIGN_OR_EXIT(std::vector<ElfReader::SymbolInfo> symbols,
+                      elf_reader->SearchSymbols("go.itab.", SymbolMatchType::kPrefix));
+    benchmark::DoNotOptimize(symbols);
+  }
+}
+
 BENCHMARK(BM_noindex)->RangeMultiplier(2)->Range(1, 16);
 BENCHMARK(BM_indexed)->RangeMultiplier(2)->Range(1, 16);
+BENCHMARK(BM_elf_symbol_search);
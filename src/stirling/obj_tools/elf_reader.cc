@@ -18,12 +18,18 @@
 
 #include "src/stirling/obj_tools/elf_reader.h"
 
+#include <sys/stat.h>
+
 #include <llvm-c/Disassembler.h>
 #include <llvm/Demangle/Demangle.h>
 #include <llvm/MC/MCDisassembler/MCDisassembler.h>
 #include <llvm/Support/TargetSelect.h>
 
 #include <absl/container/flat_hash_set.h>
+#include <absl/strings/match.h>
+#include <algorithm>
+#include <cstring>
+#include <limits>
 #include <set>
 #include <utility>
 
@@ -81,9 +87,22 @@ Status ElfReader::LocateDebugSymbols(const std::filesystem::path& debug_file_dir
       std::string_view desc = std::string_view(psec->get_data() + desc_pos, desc_size);
 
       build_id = BytesToString<LowercaseHex>(desc);
+      build_id_ = build_id;
       VLOG(1) << absl::Substitute("Found build-id: $0", build_id);
     }
 
+    // Go binaries that are not linked externally have no GNU build-id, but have a Go build ID,
+    // which is stored in a note of the same structure, with a string as the "desc" field.
+    if (psec->get_name() == ".note.go.buildid" && build_id_.empty()) {
+      int32_t name_size =
+          utils::LEndianBytesToInt<int32_t>(std::string_view(psec->get_data(), sizeof(int32_t)));
+      int32_t desc_size = utils::LEndianBytesToInt<int32_t>(
+          std::string_view(psec->get_data() + sizeof(int32_t), sizeof(int32_t)));
+      // The name is padded to a multiple of 4 bytes.
+      int32_t desc_pos = 3 * sizeof(int32_t) + ((name_size + 3) & ~3);
+      build_id_ = std::string(psec->get_data() + desc_pos, desc_size);
+    }
+
     // Method 2: .gnu_debuglink.
     if (psec->get_name() == ".gnu_debuglink") {
       constexpr int kCRCBytes = 4;
@@ -158,6 +177,15 @@ Status ElfReader::LocateDebugSymbols(const std::filesystem::path& debug_file_dir
   return error::Internal("Could not find debug symbols for $0", binary_path_);
 }
 
+StatusOr<std::string> ElfReader::Identity() const {
+  if (!build_id_.empty()) {
+    return absl::StrCat("build-id:", build_id_);
+  }
+  PX_ASSIGN_OR_RETURN(struct stat st, fs::Stat(binary_path_));
+  return absl::Substitute("inode:$0:$1:$2:$3.$4", st.st_dev, st.st_ino, st.st_size,
+                          st.st_mtim.tv_sec, st.st_mtim.tv_nsec);
+}
+
 // TODO(oazizi): Consider changing binary_path to std::filesystem::path.
 StatusOr<std::unique_ptr<ElfReader>> ElfReader::Create(
     const std::string& binary_path, const std::filesystem::path& debug_file_dir) {
@@ -166,6 +194,7 @@ StatusOr<std::unique_ptr<ElfReader>> ElfReader::Create(
   auto elf_reader = std::unique_ptr<ElfReader>(new ElfReader);
 
   elf_reader->binary_path_ = binary_path;
+  elf_reader->elf_path_ = binary_path;
 
   if (!elf_reader->elf_reader_.load_header_and_sections(binary_path)) {
     return error::Internal("Can't find or process ELF file $0", binary_path);
@@ -185,6 +214,7 @@ StatusOr<std::unique_ptr<ElfReader>> ElfReader::Create(
       LOG(INFO) << absl::Substitute("Found debug symbols file $0 for binary $1", debug_symbols_path,
                                     binary_path);
       elf_reader->elf_reader_.load_header_and_sections(debug_symbols_path);
+      elf_reader->elf_path_ = debug_symbols_path;
       return elf_reader;
     }
   }
@@ -214,6 +244,87 @@ StatusOr<ELFIO::section*> ElfReader::SymtabSection() {
   return symtab_section;
 }
 
+StatusOr<ElfReader::SymbolTable> ElfReader::MappedSymbolTable() {
+  PX_ASSIGN_OR_RETURN(ELFIO::section * symtab_section, SymtabSection());
+
+  // The symbols are read in place, so the ELF file must use the byte order of this machine.
+  if (elf_reader_.get_encoding() != ELFIO::ELFDATA2LSB) {
+    return error::Unimplemented("Big-endian ELF files are not supported, binary=$0", elf_path_);
+  }
+
+  const ELFIO::Elf_Word strtab_index = symtab_section->get_link();
+  if (strtab_index >= elf_reader_.sections.size()) {
+    return error::Internal("Invalid string table index $0 in binary=$1", strtab_index, elf_path_);
+  }
+  ELFIO::section* strtab_section = elf_reader_.sections[strtab_index];
+
+  if (elf_file_ == nullptr) {
+    PX_ASSIGN_OR_RETURN(elf_file_, MappedFile::Create(elf_path_));
+  }
+
+  SymbolTable symtab;
+  symtab.is_64bit = elf_reader_.get_class() == ELFIO::ELFCLASS64;
+  symtab.entry_size = symtab_section->get_entry_size();
+  const size_t min_entry_size =
+      symtab.is_64bit ? sizeof(ELFIO::Elf64_Sym) : sizeof(ELFIO::Elf32_Sym);
+  if (symtab.entry_size < min_entry_size) {
+    return error::Internal("Invalid symbol size $0 in binary=$1", symtab.entry_size, elf_path_);
+  }
+  PX_ASSIGN_OR_RETURN(symtab.symbols, elf_file_->Slice(symtab_section->get_offset(),
+                                                       symtab_section->get_size()));
+  PX_ASSIGN_OR_RETURN(symtab.strings, elf_file_->Slice(strtab_section->get_offset(),
+                                                       strtab_section->get_size()));
+  return symtab;
+}
+
+namespace {
+
+std::string_view SymbolName(std::string_view strings, uint32_t name_offset) {
+  if (name_offset >= strings.size()) {
+    return {};
+  }
+  const char* name = strings.data() + name_offset;
+  return std::string_view(name, strnlen(name, strings.size() - name_offset));
+}
+
+}  // namespace
+
+template <typename TFn>
+Status ElfReader::ForEachSymbol(TFn fn) {
+  PX_ASSIGN_OR_RETURN(SymbolTable symtab, MappedSymbolTable());
+
+  const size_t num_symbols = symtab.symbols.size() / symtab.entry_size;
+  for (size_t i = 0; i < num_symbols; ++i) {
+    const char* entry = symtab.symbols.data() + i * symtab.entry_size;
+    uint32_t name_offset = 0;
+    unsigned char info = 0;
+    uint64_t addr = 0;
+    uint64_t size = 0;
+    // The entries are not necessarily aligned in the file, so copy them out.
+    if (symtab.is_64bit) {
+      ELFIO::Elf64_Sym sym;
+      memcpy(&sym, entry, sizeof(sym));
+      name_offset = sym.st_name;
+      info = sym.st_info;
+      addr = sym.st_value;
+      size = sym.st_size;
+    } else {
+      ELFIO::Elf32_Sym sym;
+      memcpy(&sym, entry, sizeof(sym));
+      name_offset = sym.st_name;
+      info = sym.st_info;
+      addr = sym.st_value;
+      size = sym.st_size;
+    }
+    // The type is in the low 4 bits of st_info.
+    const int type = info & 0xf;
+    if (!fn(SymbolName(symtab.strings, name_offset), name_offset, type, addr, size)) {
+      break;
+    }
+  }
+  return Status::OK();
+}
+
 // TODO(ddelnano): This function only works with sections that exist in LOAD segments.
 // This function should be able to handle any section, but for the time being its is limited
 // in scope.
@@ -248,36 +359,23 @@ static auto NoTextStartAddrError =
 StatusOr<std::vector<ElfReader::SymbolInfo>> ElfReader::SearchSymbols(
     std::string_view search_symbol, SymbolMatchType match_type, std::optional<int> symbol_type,
     bool stop_at_first_match) {
-  PX_ASSIGN_OR_RETURN(ELFIO::section * symtab_section, SymtabSection());
-
   std::vector<SymbolInfo> symbol_infos;
 
   // Scan all symbols inside the symbol table.
-  const ELFIO::symbol_section_accessor symbols(elf_reader_, symtab_section);
-  for (unsigned int j = 0; j < symbols.get_symbols_num(); ++j) {
-    std::string name;
-    ELFIO::Elf64_Addr addr = 0;
-    ELFIO::Elf_Xword size = 0;
-    unsigned char bind = 0;
-    unsigned char type = ELFIO::STT_NOTYPE;
-    ELFIO::Elf_Half section_index;
-    unsigned char other;
-    symbols.get_symbol(j, name, addr, size, bind, type, section_index, other);
-
+  PX_RETURN_IF_ERROR(ForEachSymbol([&](std::string_view name, uint32_t /*name_offset*/, int type,
+                                       uint64_t addr, uint64_t size) {
     if (symbol_type.has_value() && type != symbol_type.value()) {
-      continue;
+      return true;
     }
 
     if (!MatchesSymbol(name, {match_type, search_symbol})) {
-      continue;
+      return true;
     }
 
-    symbol_infos.push_back({std::move(name), type, addr, size});
+    symbol_infos.push_back({std::string(name), type, addr, size});
 
-    if (stop_at_first_match) {
-      break;
-    }
-  }
+    return !stop_at_first_match;
+  }));
   return symbol_infos;
 }
 
@@ -325,94 +423,69 @@ std::optional<int64_t> ElfReader::SymbolAddress(std::string_view symbol) {
 }
 
 StatusOr<std::optional<std::string>> ElfReader::AddrToSymbol(size_t sym_addr) {
-  PX_ASSIGN_OR_RETURN(ELFIO::section * symtab_section, SymtabSection());
-
-  const ELFIO::symbol_section_accessor symbols(elf_reader_, symtab_section);
-
-  // Call ELFIO to get symbol by address.
-  // ELFIO looks up the symbol and then populates name, size, type, etc.
-  // We only care about the name, but need to declare the other variables as well.
-  const ELFIO::Elf64_Addr addr = sym_addr;
-  std::string name;
-  ELFIO::Elf_Xword size = 0;
-  unsigned char bind = 0;
-  unsigned char type = ELFIO::STT_NOTYPE;
-  ELFIO::Elf_Half section_index;
-  unsigned char other;
-  bool found = symbols.get_symbol(addr, name, size, bind, type, section_index, other);
-
-  if (!found) {
-    return std::optional<std::string>();
-  }
-
-  return std::optional<std::string>(std::move(name));
+  std::optional<std::string> symbol;
+  PX_RETURN_IF_ERROR(ForEachSymbol([&](std::string_view name, uint32_t /*name_offset*/,
+                                       int /*type*/, uint64_t addr, uint64_t /*size*/) {
+    if (addr != sym_addr) {
+      return true;
+    }
+    symbol = std::string(name);
+    return false;
+  }));
+  return symbol;
 }
 
 // TODO(oazizi): Optimize by indexing or switching to binary search if we can guarantee addresses
-//               are ordered.
+//               are ordered. GetSymbolizer() builds such an index.
 StatusOr<std::optional<std::string>> ElfReader::InstrAddrToSymbol(size_t sym_addr) {
-  PX_ASSIGN_OR_RETURN(ELFIO::section * symtab_section, SymtabSection());
-
-  const ELFIO::symbol_section_accessor symbols(elf_reader_, symtab_section);
-  for (unsigned int j = 0; j < symbols.get_symbols_num(); ++j) {
-    // Call ELFIO to get symbol by index.
-    // ELFIO looks up the index and then populates name, addr, size, type, etc.
-    // We only care about the name and addr, but need to declare the other variables as well.
-    std::string name;
-    ELFIO::Elf64_Addr addr = 0;
-    ELFIO::Elf_Xword size = 0;
-    unsigned char bind = 0;
-    unsigned char type = ELFIO::STT_NOTYPE;
-    ELFIO::Elf_Half section_index;
-    unsigned char other;
-    symbols.get_symbol(j, name, addr, size, bind, type, section_index, other);
-
+  std::optional<std::string> symbol;
+  PX_RETURN_IF_ERROR(ForEachSymbol([&](std::string_view name, uint32_t /*name_offset*/,
+                                       int /*type*/, uint64_t addr, uint64_t size) {
     if (sym_addr >= addr && sym_addr < addr + size) {
-      return std::optional<std::string>(llvm::demangle(name));
+      symbol = llvm::demangle(std::string(name));
+      return false;
     }
-  }
-
-  return std::optional<std::string>();
+    return true;
+  }));
+  return symbol;
 }
 
 StatusOr<std::unique_ptr<ElfReader::Symbolizer>> ElfReader::GetSymbolizer() {
-  PX_ASSIGN_OR_RETURN(ELFIO::section * symtab_section, SymtabSection());
+  PX_ASSIGN_OR_RETURN(SymbolTable symtab, MappedSymbolTable());
 
   auto symbolizer = std::make_unique<ElfReader::Symbolizer>();
+  symbolizer->file_ = elf_file_;
+  symbolizer->strings_ = symtab.strings;
 
-  const ELFIO::symbol_section_accessor symbols(elf_reader_, symtab_section);
-  for (unsigned int j = 0; j < symbols.get_symbols_num(); ++j) {
-    // Call ELFIO to get symbol by index.
-    // ELFIO looks up the index and then populates name, addr, size, type, etc.
-    // We only care about the name and addr, but need to declare the other variables as well.
-    std::string name;
-    ELFIO::Elf64_Addr addr = 0;
-    ELFIO::Elf_Xword size = 0;
-    unsigned char bind = 0;
-    unsigned char type = ELFIO::STT_NOTYPE;
-    ELFIO::Elf_Half section_index;
-    unsigned char other;
-    symbols.get_symbol(j, name, addr, size, bind, type, section_index, other);
-
+  std::vector<Symbolizer::SymbolAddrInfo>& symbols = symbolizer->symbols_;
+  PX_RETURN_IF_ERROR(ForEachSymbol([&symbols](std::string_view /*name*/, uint32_t name_offset,
+                                              int type, uint64_t addr, uint64_t size) {
     if (type == ELFIO::STT_FUNC) {
-      symbolizer->AddEntry(addr, size, llvm::demangle(name));
+      size = std::min<uint64_t>(size, std::numeric_limits<uint32_t>::max());
+      symbols.push_back({addr, static_cast<uint32_t>(size), name_offset});
     }
-  }
+    return true;
+  }));
 
-  return symbolizer;
-}
+  // Keep the first symbol of each address, like the symbol table order would.
+  std::stable_sort(symbols.begin(), symbols.end(),
+                   [](const auto& a, const auto& b) { return a.addr < b.addr; });
+  symbols.erase(std::unique(symbols.begin(), symbols.end(),
+                            [](const auto& a, const auto& b) { return a.addr == b.addr; }),
+                symbols.end());
+  symbols.shrink_to_fit();
 
-void ElfReader::Symbolizer::AddEntry(size_t addr, size_t size, std::string name) {
-  symbols_.emplace(addr, SymbolAddrInfo{size, std::move(name)});
+  return symbolizer;
 }
 
 std::string_view ElfReader::Symbolizer::Lookup(size_t addr) const {
   static std::string symbol_str;
 
   // Find the first symbol for which the address_range_start > addr.
-  auto iter = symbols_.upper_bound(addr);
+  auto iter = std::upper_bound(symbols_.begin(), symbols_.end(), addr,
+                               [](uintptr_t a, const auto& sym) { return a < sym.addr; });
 
-  if (iter == symbols_.begin() || symbols_.empty()) {
+  if (iter == symbols_.begin()) {
     symbol_str = absl::StrFormat("0x%016llx", addr);
     return symbol_str;
   }
@@ -420,13 +493,22 @@ std::string_view ElfReader::Symbolizer::Lookup(size_t addr) const {
   // std::upper_bound will make us overshoot our potential match,
   // so go back by one, and check if it is indeed a match.
   --iter;
-  if (addr >= iter->first && addr < iter->first + iter->second.size) {
-    return iter->second.name;
+  if (addr >= iter->addr + iter->size) {
+    // Couldn't find the address.
+    symbol_str = absl::StrFormat("0x%016llx", addr);
+    return symbol_str;
   }
 
-  // Couldn't find the address.
-  symbol_str = absl::StrFormat("0x%016llx", addr);
-  return symbol_str;
+  std::string_view name = SymbolName(strings_, iter->name_offset);
+  // Only mangled names (e.g. C++ and Rust) need demangling; the rest are used as is.
+  if (!absl::StartsWith(name, "_Z") && !absl::StartsWith(name, "_R")) {
+    return name;
+  }
+  auto [demangled_iter, inserted] = demangled_names_.try_emplace(iter->name_offset);
+  if (inserted) {
+    demangled_iter->second = llvm::demangle(std::string(name));
+  }
+  return demangled_iter->second;
 }
 
 namespace {
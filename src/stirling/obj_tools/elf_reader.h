@@ -23,12 +23,13 @@
 #include <string>
 #include <vector>
 
-#include <absl/container/btree_map.h>
 #include <absl/container/flat_hash_map.h>
+#include <absl/container/node_hash_map.h>
 
 #include <elfio/elfio.hpp>
 
 #include "src/common/base/base.h"
+#include "src/stirling/obj_tools/mapped_file.h"
 #include "src/stirling/obj_tools/utils.h"
 
 using ::px::utils::u8string;
@@ -55,6 +56,19 @@ class ElfReader {
 
   std::filesystem::path& debug_symbols_path() { return debug_symbols_path_; }
 
+  /**
+   * Returns the GNU build-id of the binary as a hex string or, for Go binaries without one, the
+   * Go build ID. Returns an empty string if the binary has neither.
+   */
+  const std::string& build_id() const { return build_id_; }
+
+  /**
+   * Returns a string that identifies the contents of the binary, so that copies of the binary at
+   * different paths (e.g. in different containers) can share state. This is the build-id if there
+   * is one, otherwise the device, inode, size and modification time of the file.
+   */
+  StatusOr<std::string> Identity() const;
+
   struct SymbolInfo {
     std::string name;
     int type = -1;
@@ -125,27 +139,40 @@ class ElfReader {
    */
   StatusOr<std::optional<std::string>> InstrAddrToSymbol(size_t addr);
 
+  /**
+   * An index of the function symbols of the binary, sorted by address. The names are not copied;
+   * they point into the string table of the memory-mapped ELF file, which the Symbolizer keeps
+   * mapped. Names are only demangled when they are looked up.
+   */
   class Symbolizer {
    public:
-    /**
-     * Associate the address range [addr, addr+size] with the provided symbol name.
-     * No checking is performed for overlapping regions, which will result in undefined behavior.
-     */
-    void AddEntry(uintptr_t addr, size_t size, std::string name);
-
     /**
      * Lookup the symbol for the specified address.
      */
     std::string_view Lookup(uintptr_t addr) const;
 
+    size_t num_symbols() const { return symbols_.size(); }
+
    private:
+    friend class ElfReader;
+
     struct SymbolAddrInfo {
-      size_t size;
-      std::string name;
+      uintptr_t addr;
+      // Sizes are truncated to 32 bits, to keep the entries compact.
+      uint32_t size;
+      // The offset of the name in the string table.
+      uint32_t name_offset;
     };
 
-    // Key is an address.
-    absl::btree_map<uintptr_t, SymbolAddrInfo> symbols_;
+    // Keeps the string table mapped.
+    std::shared_ptr<const MappedFile> file_;
+    std::string_view strings_;
+
+    // Sorted by address, with a single symbol per address.
+    std::vector<SymbolAddrInfo> symbols_;
+
+    // The demangled names of the symbols that were looked up, keyed by name offset.
+    mutable absl::node_hash_map<uint32_t, std::string> demangled_names_;
   };
 
   StatusOr<std::unique_ptr<Symbolizer>> GetSymbolizer();
@@ -211,6 +238,23 @@ class ElfReader {
 
   StatusOr<ELFIO::section*> SymtabSection();
 
+  // A view of the symbol table and its string table in the memory-mapped ELF file.
+  struct SymbolTable {
+    std::string_view symbols;
+    size_t entry_size = 0;
+    bool is_64bit = true;
+    std::string_view strings;
+  };
+
+  StatusOr<SymbolTable> MappedSymbolTable();
+
+  /**
+   * Calls fn(name, name_offset, type, addr, size) for each symbol of the symbol table, until it
+   * returns false.
+   */
+  template <typename TFn>
+  Status ForEachSymbol(TFn fn);
+
   /**
    * Locates the debug symbols for the currently loaded ELF object.
    * External symbols are discovered using either the build-id or the debug-link.
@@ -227,8 +271,16 @@ class ElfReader {
 
   std::string binary_path_;
 
+  // The file that elf_reader_ loaded, which is the external debug symbols file if there is one.
+  std::string elf_path_;
+
+  // Mapped on first use.
+  std::shared_ptr<const MappedFile> elf_file_;
+
   std::filesystem::path debug_symbols_path_;
 
+  std::string build_id_;
+
   // Set up an elf reader, so we can extract debug symbols.
   ELFIO::elfio elf_reader_;
 };
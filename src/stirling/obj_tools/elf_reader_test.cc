@@ -19,6 +19,8 @@
 #include "src/stirling/obj_tools/elf_reader.h"
 
 #include "src/common/exec/exec.h"
+#include "src/common/fs/fs_wrapper.h"
+#include "src/common/testing/temp_dir.h"
 #include "src/common/testing/test_environment.h"
 #include "src/common/testing/testing.h"
 #include "src/stirling/obj_tools/testdata/cc/test_exe_fixture.h"
@@ -36,6 +38,7 @@ using ::testing::Field;
 using ::testing::IsEmpty;
 using ::testing::Pair;
 using ::testing::SizeIs;
+using ::testing::StartsWith;
 using ::testing::UnorderedElementsAre;
 
 using ::px::operator<<;
@@ -246,6 +249,26 @@ TEST(ElfReaderTest, InstrAddrToSymbol) {
   }
 }
 
+TEST(ElfReaderTest, Symbolizer) {
+  const std::string path = kTestExeFixture.Path().string();
+  const std::string nm_output_path = kTestExeFixture.NmOutputPath().string();
+  const std::string kSymbolName = "CanYouFindThis";
+  ASSERT_OK_AND_ASSIGN(const int64_t kSymbolAddr, NmSymbolNameToAddr(nm_output_path, kSymbolName));
+
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<ElfReader> elf_reader, ElfReader::Create(path));
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<ElfReader::Symbolizer> symbolizer,
+                       elf_reader->GetSymbolizer());
+  EXPECT_GT(symbolizer->num_symbols(), 0);
+
+  // The symbolizer keeps the string table mapped after the ElfReader is gone.
+  elf_reader.reset();
+
+  EXPECT_EQ(symbolizer->Lookup(kSymbolAddr), kSymbolName);
+  EXPECT_EQ(symbolizer->Lookup(kSymbolAddr + 4), kSymbolName);
+  EXPECT_NE(symbolizer->Lookup(kSymbolAddr + 1000), kSymbolName);
+  EXPECT_EQ(symbolizer->Lookup(0), "0x0000000000000000");
+}
+
 TEST(ElfReaderTest, ExternalDebugSymbolsBuildID) {
   const std::string stripped_bin =
       px::testing::BazelRunfilePath("src/stirling/obj_tools/testdata/cc/stripped_test_exe");
@@ -259,6 +282,38 @@ TEST(ElfReaderTest, ExternalDebugSymbolsBuildID) {
                      ElementsAre(SymbolNameIs("CanYouFindThis")));
 }
 
+TEST(ElfReaderTest, Identity) {
+  const std::string stripped_bin =
+      px::testing::BazelRunfilePath("src/stirling/obj_tools/testdata/cc/stripped_test_exe");
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<ElfReader> elf_reader, ElfReader::Create(stripped_bin));
+  ASSERT_OK_AND_ASSIGN(std::string identity, elf_reader->Identity());
+  EXPECT_EQ(identity, absl::StrCat("build-id:", elf_reader->build_id()));
+  EXPECT_FALSE(elf_reader->build_id().empty());
+}
+
+// Binaries without a build ID are identified by their file, so a copy of the binary has another
+// identity.
+TEST(ElfReaderTest, IdentityWithoutBuildID) {
+  const std::string path =
+      px::testing::BazelRunfilePath("src/stirling/obj_tools/testdata/cc/prebuilt_test_exe");
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<ElfReader> elf_reader, ElfReader::Create(path));
+  EXPECT_TRUE(elf_reader->build_id().empty());
+  ASSERT_OK_AND_ASSIGN(std::string identity, elf_reader->Identity());
+  EXPECT_THAT(identity, StartsWith("inode:"));
+
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<ElfReader> same_elf_reader, ElfReader::Create(path));
+  EXPECT_OK_AND_EQ(same_elf_reader->Identity(), identity);
+
+  px::testing::TempDir tmp_dir;
+  const std::filesystem::path copy_path = tmp_dir.path() / "prebuilt_test_exe";
+  ASSERT_OK(fs::Copy(path, copy_path));
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<ElfReader> copy_elf_reader,
+                       ElfReader::Create(copy_path.string()));
+  ASSERT_OK_AND_ASSIGN(std::string copy_identity, copy_elf_reader->Identity());
+  EXPECT_THAT(copy_identity, StartsWith("inode:"));
+  EXPECT_NE(copy_identity, identity);
+}
+
 TEST(ElfReaderTest, ExternalDebugSymbolsDebugLink) {
   const std::string stripped_bin =
       px::testing::BazelRunfilePath("src/stirling/obj_tools/testdata/cc/test_exe_debuglink");
@@ -0,0 +1,75 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/obj_tools/mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <utility>
+
+namespace px {
+namespace stirling {
+namespace obj_tools {
+
+StatusOr<std::shared_ptr<const MappedFile>> MappedFile::Create(const std::filesystem::path& path) {
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return error::Internal("Failed to open $0: $1", path.string(), std::strerror(errno));
+  }
+  DEFER(close(fd));
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    return error::Internal("Failed to stat $0: $1", path.string(), std::strerror(errno));
+  }
+  const size_t size = st.st_size;
+
+  // mmap() rejects empty mappings, but an empty file is still a valid (if useless) file.
+  const char* addr = nullptr;
+  if (size > 0) {
+    void* mapped = mmap(/*addr*/ nullptr, size, PROT_READ, MAP_PRIVATE, fd, /*offset*/ 0);
+    if (mapped == MAP_FAILED) {
+      return error::Internal("Failed to mmap $0: $1", path.string(), std::strerror(errno));
+    }
+    addr = static_cast<const char*>(mapped);
+  }
+
+  return std::shared_ptr<const MappedFile>(new MappedFile(path, addr, size));
+}
+
+MappedFile::~MappedFile() {
+  if (addr_ != nullptr) {
+    munmap(const_cast<char*>(addr_), size_);
+  }
+}
+
+StatusOr<std::string_view> MappedFile::Slice(uint64_t offset, uint64_t size) const {
+  if (offset > size_ || size > size_ - offset) {
+    return error::OutOfRange("Range [$0, $1) is out of bounds of $2, which has $3 bytes", offset,
+                             offset + size, path_.string(), size_);
+  }
+  return std::string_view(addr_ + offset, size);
+}
+
+}  // namespace obj_tools
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,61 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <string_view>
+#include <utility>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace stirling {
+namespace obj_tools {
+
+/**
+ * A read-only memory mapping of a whole file. The pages are only read from disk when accessed,
+ * and are shared with the page cache, so large binaries can be inspected without copying them
+ * into memory.
+ */
+class MappedFile : public NotCopyMoveable {
+ public:
+  static StatusOr<std::shared_ptr<const MappedFile>> Create(const std::filesystem::path& path);
+
+  ~MappedFile();
+
+  std::string_view data() const { return std::string_view(addr_, size_); }
+
+  /**
+   * Returns the bytes [offset, offset + size) of the file, or an error if they are out of bounds.
+   */
+  StatusOr<std::string_view> Slice(uint64_t offset, uint64_t size) const;
+
+ private:
+  MappedFile(std::filesystem::path path, const char* addr, size_t size)
+      : path_(std::move(path)), addr_(addr), size_(size) {}
+
+  const std::filesystem::path path_;
+  const char* const addr_;
+  const size_t size_;
+};
+
+}  // namespace obj_tools
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,59 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/obj_tools/mapped_file.h"
+
+#include <gtest/gtest.h>
+
+#include "src/common/base/file.h"
+#include "src/common/testing/temp_dir.h"
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace stirling {
+namespace obj_tools {
+
+TEST(MappedFileTest, Slice) {
+  px::testing::TempDir tmp_dir;
+  const std::filesystem::path path = tmp_dir.path() / "file";
+  ASSERT_OK(WriteFileFromString(path, "0123456789"));
+
+  ASSERT_OK_AND_ASSIGN(std::shared_ptr<const MappedFile> file, MappedFile::Create(path));
+  EXPECT_EQ(file->data(), "0123456789");
+  ASSERT_OK_AND_EQ(file->Slice(2, 3), "234");
+  ASSERT_OK_AND_EQ(file->Slice(10, 0), "");
+  EXPECT_NOT_OK(file->Slice(8, 3));
+  EXPECT_NOT_OK(file->Slice(11, 0));
+}
+
+TEST(MappedFileTest, EmptyFile) {
+  px::testing::TempDir tmp_dir;
+  const std::filesystem::path path = tmp_dir.path() / "file";
+  ASSERT_OK(WriteFileFromString(path, ""));
+
+  ASSERT_OK_AND_ASSIGN(std::shared_ptr<const MappedFile> file, MappedFile::Create(path));
+  EXPECT_TRUE(file->data().empty());
+}
+
+TEST(MappedFileTest, MissingFile) {
+  EXPECT_NOT_OK(MappedFile::Create("/does/not/exist"));
+}
+
+}  // namespace obj_tools
+}  // namespace stirling
+}  // namespace px
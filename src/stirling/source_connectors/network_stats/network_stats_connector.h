@@ -54,6 +54,7 @@ class NetworkStatsConnector : public SourceConnector {
   Status StopImpl() override;
 
   void TransferDataImpl(ConnectorContext* ctx) override;
+  bool thread_safe() const override { return true; }
 
  protected:
   explicit NetworkStatsConnector(std::string_view source_name)
@@ -115,3 +115,78 @@ int sample_call_stack(struct bpf_perf_event_data* ctx) {
 
   return 0;
 }
+
+// Off-CPU profiling: measures how long threads are switched out by the scheduler (blocked on a
+// futex, on IO, or waiting in a run queue), and attributes that time to the stack trace at which
+// they were switched out. The blocked time is aggregated in BPF, in a histogram from stack trace
+// to nanoseconds, so that only one entry per distinct stack trace reaches user space.
+// The histograms and the stack traces use the same double buffering scheme as the CPU samples.
+
+BPF_HASH(off_cpu_histogram_a, struct stack_trace_key_t, uint64_t, CFG_OFF_CPU_HISTOGRAM_ENTRIES);
+BPF_HASH(off_cpu_histogram_b, struct stack_trace_key_t, uint64_t, CFG_OFF_CPU_HISTOGRAM_ENTRIES);
+
+// Thread ID => time at which the thread was switched out.
+// An LRU map, because the entries of threads that exit while switched out are never deleted.
+BPF_TABLE("lru_hash", uint32_t, uint64_t, off_cpu_start_ns, CFG_OFF_CPU_THREAD_ENTRIES);
+
+// Probes finish_task_switch(prev), which runs in the context of the thread that was just switched
+// in, after the switch out of prev. Unlike the sched_switch tracepoint, this allows collecting the
+// stack trace of the thread that was blocked, which is where it resumes.
+int sample_off_cpu(struct pt_regs* ctx, struct task_struct* prev) {
+  const uint64_t now = bpf_ktime_get_ns();
+
+  // The idle task (pid 0) is never blocked.
+  uint32_t prev_tid = prev->pid;
+  if (prev_tid != 0) {
+    off_cpu_start_ns.update(&prev_tid, &now);
+  }
+
+  const uint64_t id = bpf_get_current_pid_tgid();
+  uint32_t tid = id;
+  uint64_t* start_ns = off_cpu_start_ns.lookup(&tid);
+  if (start_ns == NULL) {
+    return 0;
+  }
+  const uint64_t blocked_ns = now - *start_ns;
+  off_cpu_start_ns.delete(&tid);
+
+  if (blocked_ns < CFG_OFF_CPU_MIN_BLOCK_NS) {
+    return 0;
+  }
+
+  int transfer_count_idx = kTransferCountIdx;
+  uint64_t* transfer_count_ptr = profiler_state.lookup(&transfer_count_idx);
+  if (transfer_count_ptr == NULL) {
+    int error_status_idx = kErrorStatusIdx;
+    uint64_t rd_fail_status_code = kMapReadFailureError;
+    profiler_state.update(&error_status_idx, &rd_fail_status_code);
+    return 0;
+  }
+
+  struct stack_trace_key_t key = {};
+  key.upid.tgid = id >> 32;
+  key.upid.start_time_ticks = get_tgid_start_time();
+
+  uint64_t zero = 0;
+  uint64_t* total_blocked_ns = NULL;
+  if (*transfer_count_ptr % 2 == 0) {
+    key.user_stack_id = stack_traces_a.get_stackid(ctx, BPF_F_USER_STACK);
+    key.kernel_stack_id = stack_traces_a.get_stackid(ctx, 0);
+    total_blocked_ns = off_cpu_histogram_a.lookup_or_init(&key, &zero);
+  } else {
+    key.user_stack_id = stack_traces_b.get_stackid(ctx, BPF_F_USER_STACK);
+    key.kernel_stack_id = stack_traces_b.get_stackid(ctx, 0);
+    total_blocked_ns = off_cpu_histogram_b.lookup_or_init(&key, &zero);
+  }
+
+  if (total_blocked_ns == NULL) {
+    // The histogram is full: user space reads it too rarely for the number of stack traces.
+    int error_status_idx = kErrorStatusIdx;
+    uint64_t histogram_full_status_code = kOffCPUHistogramFullError;
+    profiler_state.update(&error_status_idx, &histogram_full_status_code);
+    return 0;
+  }
+  __sync_fetch_and_add(total_blocked_ns, blocked_ns);
+
+  return 0;
+}
@@ -74,15 +74,21 @@ struct stack_trace_key_t {
 // Bit positions in the error status bitfield:
 static const uint32_t kOverflowBitPos = 0;
 static const uint32_t kMapReadFailureBitPos = 1;
+static const uint32_t kOffCPUHistogramFullBitPos = 2;
 
 // The error codes, themselves:
 static const uint64_t kPerfProfilerStatusOk = 0ULL;
 static const uint64_t kOverflowError = 1ULL << kOverflowBitPos;
 static const uint64_t kMapReadFailureError = 1ULL << kMapReadFailureBitPos;
+static const uint64_t kOffCPUHistogramFullError = 1ULL << kOffCPUHistogramFullBitPos;
 
 #ifdef __cplusplus
 // NOLINTNEXTLINE : runtime/string
 static const std::string kHistogramAName = "histogram_a";
 // NOLINTNEXTLINE : runtime/string
 static const std::string kHistogramBName = "histogram_b";
+// NOLINTNEXTLINE : runtime/string
+static const std::string kOffCPUHistogramAName = "off_cpu_histogram_a";
+// NOLINTNEXTLINE : runtime/string
+static const std::string kOffCPUHistogramBName = "off_cpu_histogram_b";
 #endif
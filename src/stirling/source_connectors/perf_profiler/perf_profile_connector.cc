@@ -51,6 +51,18 @@ DEFINE_double(stirling_profiler_stack_trace_size_factor, 3.0,
 DEFINE_double(stirling_profiler_perf_buffer_size_factor, 1.2,
               "Scaling factor to apply to Profiler's eBPF perf buffer sizes");
 
+DEFINE_bool(stirling_profiler_off_cpu, gflags::BoolFromEnv("PL_PROFILER_OFF_CPU", false),
+            "If true, also profile the time that threads spend blocked off-CPU, into the same "
+            "table as the CPU samples.");
+DEFINE_uint32(stirling_profiler_off_cpu_min_block_us, 100,
+              "Off-CPU intervals shorter than this are not recorded, to bound the overhead of "
+              "frequent context switches.");
+DEFINE_uint32(stirling_profiler_off_cpu_stack_traces, 8192,
+              "Number of distinct off-CPU stack traces per table update period for which the "
+              "profiler's eBPF maps are sized.");
+DEFINE_uint32(stirling_profiler_off_cpu_threads, 65536,
+              "Maximum number of threads that can be tracked as off-CPU at the same time.");
+
 namespace px {
 namespace stirling {
 
@@ -73,6 +85,9 @@ PerfProfileConnector::PerfProfileConnector(std::string_view source_name)
       profiler_state_map_read_error_counter_(
           BuildCounter("perf_profiler_map_read_error",
                        "Count of times the perf profiler encountered a map lookup error")),
+      profiler_state_off_cpu_histogram_full_counter_(BuildCounter(
+          "perf_profiler_off_cpu_histogram_full",
+          "Count of times the off-CPU histogram was full and dropped blocked time")),
       stats_log_interval_(std::chrono::minutes(FLAGS_stirling_profiler_log_period_minutes) /
                           sampling_period_) {
   constexpr auto kMaxSamplingPeriod = std::chrono::milliseconds{30000};
@@ -129,9 +144,21 @@ Status PerfProfileConnector::InitImpl() {
       sizeof(struct perf_event_header) + sizeof(uint32_t) + sizeof(stack_trace_key_t);
   const int32_t perf_buffer_size = perf_buffer_entry_size * num_perf_buffer_entries;
 
+  // The off-CPU samples are aggregated in BPF, so they add one stack trace per distinct stack.
+  // Keep the maps minimal if off-CPU profiling is disabled.
+  const uint32_t off_cpu_stack_traces =
+      FLAGS_stirling_profiler_off_cpu ? FLAGS_stirling_profiler_off_cpu_stack_traces : 1;
+  const uint32_t off_cpu_threads =
+      FLAGS_stirling_profiler_off_cpu ? FLAGS_stirling_profiler_off_cpu_threads : 1;
+
   const std::vector<std::string> defines = {
-      absl::Substitute("-DCFG_STACK_TRACE_ENTRIES=$0", provisioned_stack_traces),
+      absl::Substitute("-DCFG_STACK_TRACE_ENTRIES=$0",
+                       provisioned_stack_traces + 2 * off_cpu_stack_traces),
       absl::Substitute("-DCFG_OVERRUN_THRESHOLD=$0", overrun_threshold),
+      absl::Substitute("-DCFG_OFF_CPU_HISTOGRAM_ENTRIES=$0", off_cpu_stack_traces),
+      absl::Substitute("-DCFG_OFF_CPU_THREAD_ENTRIES=$0", off_cpu_threads),
+      absl::Substitute("-DCFG_OFF_CPU_MIN_BLOCK_NS=$0ULL",
+                       1000ULL * FLAGS_stirling_profiler_off_cpu_min_block_us),
   };
 
   const auto probe_specs = MakeArray<bpf_tools::SamplingProbeSpec>(
@@ -152,6 +179,12 @@ Status PerfProfileConnector::InitImpl() {
 
   LOG(INFO) << "PerfProfiler: Stack trace profiling sampling probe successfully deployed.";
 
+  if (FLAGS_stirling_profiler_off_cpu) {
+    // Off-CPU profiling is an addition to the CPU profile, so failing to deploy it is not fatal.
+    const Status s = InitOffCPUProfiling();
+    LOG_IF(WARNING, !s.ok()) << "PerfProfiler: Off-CPU profiling disabled: " << s.msg();
+  }
+
   // Create a symbolizer for user symbols.
   if (FLAGS_stirling_profiler_symbolizer == "bcc") {
     PX_ASSIGN_OR_RETURN(u_symbolizer_, BCCSymbolizer::Create());
@@ -181,6 +214,28 @@ Status PerfProfileConnector::InitImpl() {
   return Status::OK();
 }
 
+Status PerfProfileConnector::InitOffCPUProfiling() {
+  using bpf_tools::BPFProbeAttachType;
+  using bpf_tools::KProbeSpec;
+
+  // finish_task_switch() is renamed by some compilers, e.g. to finish_task_switch.isra.0.
+  KProbeSpec off_cpu_probe = {"finish_task_switch", BPFProbeAttachType::kEntry, "sample_off_cpu",
+                              /*is_syscall*/ false};
+  off_cpu_probe.fallback_probe = std::make_shared<KProbeSpec>(
+      KProbeSpec{"finish_task_switch.isra.0", BPFProbeAttachType::kEntry, "sample_off_cpu",
+                 /*is_syscall*/ false});
+  PX_RETURN_IF_ERROR(bcc_->AttachKProbe(off_cpu_probe));
+
+  off_cpu_histogram_a_ =
+      WrappedBCCMap<stack_trace_key_t, uint64_t>::Create(bcc_.get(), kOffCPUHistogramAName);
+  off_cpu_histogram_b_ =
+      WrappedBCCMap<stack_trace_key_t, uint64_t>::Create(bcc_.get(), kOffCPUHistogramBName);
+  off_cpu_enabled_ = true;
+
+  LOG(INFO) << "PerfProfiler: Off-CPU profiling probe successfully deployed.";
+  return Status::OK();
+}
+
 Status PerfProfileConnector::StopImpl() {
   // Must call Close() after attach_uprobes_thread_ has joined,
   // otherwise the two threads will cause concurrent accesses to BCC,
@@ -227,12 +282,14 @@ void PerfProfileConnector::CleanupSymbolizers(const absl::flat_hash_set<md::UPID
   }
 }
 
-PerfProfileConnector::StackTraceHisto PerfProfileConnector::AggregateStackTraces(
-    ConnectorContext* ctx, WrappedBCCStackTable* stack_traces) {
+void PerfProfileConnector::AggregateStackTraces(ConnectorContext* ctx,
+                                                WrappedBCCStackTable* stack_traces,
+                                                const OffCPUHistoData& off_cpu_histo_data,
+                                                StackTraceHisto* cpu_histo,
+                                                StackTraceHisto* off_cpu_histo) {
   // TODO(jps): switch from using get_table_offline() to directly stepping through
   // the histogram data structure. Inline populating our own data structures with this.
   // Avoid an unnecessary copy of the information in local stack_trace_keys_and_counts.
-  StackTraceHisto symbolic_histogram;
   uint64_t cum_sum_count = 0;
 
   const uint32_t asid = ctx->GetASID();
@@ -246,7 +303,7 @@ PerfProfileConnector::StackTraceHisto PerfProfileConnector::AggregateStackTraces
 
   absl::flat_hash_set<int> k_stack_ids_to_remove;
 
-  for (const auto& stack_trace_key : raw_histo_data_) {
+  auto symbolize = [&](const stack_trace_key_t& stack_trace_key) {
     std::string stack_trace_str;
 
     const md::UPID upid(asid, stack_trace_key.upid.pid, stack_trace_key.upid.start_time_ticks);
@@ -273,9 +330,11 @@ PerfProfileConnector::StackTraceHisto PerfProfileConnector::AggregateStackTraces
       stack_trace_str = std::string(profiler::kNotSymbolizedMessage);
     }
 
-    profiler::SymbolicStackTrace symbolic_stack_trace = {upid, std::move(stack_trace_str)};
+    return profiler::SymbolicStackTrace{upid, std::move(stack_trace_str)};
+  };
 
-    ++symbolic_histogram[symbolic_stack_trace];
+  for (const auto& stack_trace_key : raw_histo_data_) {
+    ++(*cpu_histo)[symbolize(stack_trace_key)];
     ++cum_sum_count;
 
     // TODO(jps): If we see a perf. issue with having two maps keyed by symbolic-stack-trace,
@@ -290,6 +349,12 @@ PerfProfileConnector::StackTraceHisto PerfProfileConnector::AggregateStackTraces
     // alternate impl. is a map from "stack-trace-id" => "count & symbolic-stack-trace"
   }
 
+  // The off-CPU samples use the same stack traces table, so they are symbolized by the same
+  // stringifier, before the kernel stack-ids are cleared.
+  for (const auto& [stack_trace_key, blocked_ns] : off_cpu_histo_data) {
+    (*off_cpu_histo)[symbolize(stack_trace_key)] += blocked_ns;
+  }
+
   // Clear any kernel stack-ids, that were potentially not already cleared,
   // out of the stack traces table.
   for (const int k_stack_id : k_stack_ids_to_remove) {
@@ -300,11 +365,12 @@ PerfProfileConnector::StackTraceHisto PerfProfileConnector::AggregateStackTraces
 
   VLOG(1) << "PerfProfileConnector::AggregateStackTraces(): cum_sum_count: " << cum_sum_count;
   stats_.Increment(StatKey::kCumulativeSumOfAllStackTraces, cum_sum_count);
-  return symbolic_histogram;
+  stats_.Increment(StatKey::kOffCPUStackTraces, off_cpu_histo_data.size());
 }
 
-void PerfProfileConnector::CreateRecords(WrappedBCCStackTable* stack_traces, ConnectorContext* ctx,
-                                         DataTable* data_table) {
+void PerfProfileConnector::CreateRecords(WrappedBCCStackTable* stack_traces,
+                                         const OffCPUHistoData& off_cpu_histo_data,
+                                         ConnectorContext* ctx, DataTable* data_table) {
   constexpr size_t kMaxSymbolSize = 512;
   constexpr size_t kMaxStackDepth = 64;
   constexpr size_t kMaxStackTraceSize = kMaxStackDepth * kMaxSymbolSize;
@@ -317,14 +383,18 @@ void PerfProfileConnector::CreateRecords(WrappedBCCStackTable* stack_traces, Con
   // p0, p1, p2 => main;qux;baz   # both p2 & p3 point into baz.
   // p0, p1, p3 => main;qux;baz
 
-  StackTraceHisto stack_trace_histogram = AggregateStackTraces(ctx, stack_traces);
+  StackTraceHisto stack_trace_histogram;
+  StackTraceHisto off_cpu_histogram;
+  AggregateStackTraces(ctx, stack_traces, off_cpu_histo_data, &stack_trace_histogram,
+                       &off_cpu_histogram);
 
   constexpr auto age_tick_period = std::chrono::minutes(5);
   if (sampling_freq_mgr_.count() % (age_tick_period / sampling_period_) == 0) {
     stack_trace_ids_.AgeTick();
   }
 
-  for (const auto& [key, count] : stack_trace_histogram) {
+  auto append_record = [&](const profiler::SymbolicStackTrace& key, uint64_t count,
+                           StackTraceSampleType sample_type) {
     DataTable::RecordBuilder<&kStackTraceTable> r(data_table, timestamp_ns);
 
     r.Append<r.ColIndex("time_")>(timestamp_ns);
@@ -332,6 +402,22 @@ void PerfProfileConnector::CreateRecords(WrappedBCCStackTable* stack_traces, Con
     r.Append<r.ColIndex("stack_trace_id")>(stack_trace_ids_.Lookup(key));
     r.Append<r.ColIndex("stack_trace")>(key.stack_trace_str, kMaxStackTraceSize);
     r.Append<r.ColIndex("count")>(count);
+    r.Append<r.ColIndex("sample_type")>(static_cast<int64_t>(sample_type));
+  };
+
+  for (const auto& [key, count] : stack_trace_histogram) {
+    append_record(key, count, StackTraceSampleType::kCPU);
+  }
+
+  // Express the blocked time in sampling periods, i.e. the number of samples the stack trace
+  // would have had if it had been running, so that the two kinds of samples add up.
+  const uint64_t sampling_period_ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(stack_trace_sampling_period_).count();
+  for (const auto& [key, blocked_ns] : off_cpu_histogram) {
+    const uint64_t count = (blocked_ns + sampling_period_ns / 2) / sampling_period_ns;
+    if (count > 0) {
+      append_record(key, count, StackTraceSampleType::kOffCPU);
+    }
   }
 }
 
@@ -341,6 +427,7 @@ void PerfProfileConnector::ProcessBPFStackTraces(ConnectorContext* ctx, DataTabl
   auto& stack_traces = using_map_set_a ? stack_traces_a_ : stack_traces_b_;
   auto& perfbuf_name = using_map_set_a ? kHistogramAName : kHistogramBName;
   const uint32_t sample_count_idx = using_map_set_a ? kSampleCountAIdx : kSampleCountBIdx;
+  auto& off_cpu_histogram = using_map_set_a ? off_cpu_histogram_a_ : off_cpu_histogram_b_;
 
   // Read out the perf buffer that contains the histogram for this iteration.
   // TODO(jps): change PollPerfBuffer() to use std::chrono.
@@ -354,8 +441,14 @@ void PerfProfileConnector::ProcessBPFStackTraces(ConnectorContext* ctx, DataTabl
   const auto map_status = profiler_state_->SetValue(kTransferCountIdx, transfer_count_);
   LOG_IF(ERROR, !map_status.ok()) << "Error writing transfer_count_: " << map_status.msg();
 
+  // Drain the off-CPU histogram that BPF aggregated for this iteration.
+  OffCPUHistoData off_cpu_histo_data;
+  if (off_cpu_enabled_) {
+    off_cpu_histo_data = off_cpu_histogram->GetTableOffline(/*clear_table*/ true);
+  }
+
   // Read BPF stack traces & histogram, build records, incorporate records to data table.
-  CreateRecords(stack_traces.get(), ctx, data_table);
+  CreateRecords(stack_traces.get(), off_cpu_histo_data, ctx, data_table);
 
   const uint64_t num_stack_traces_sampled = profiler_state_->GetValue(sample_count_idx).ValueOr(0);
   CheckProfilerState(num_stack_traces_sampled);
@@ -399,6 +492,12 @@ void PerfProfileConnector::CheckProfilerState(const uint64_t num_stack_traces) {
       profiler_state_map_read_error_counter_.Increment();
       break;
     }
+    case kOffCPUHistogramFullError: {
+      // Busy hosts can block on more distinct stacks than the histogram holds, so this is not
+      // checked like the overflow count above.
+      profiler_state_off_cpu_histogram_full_counter_.Increment();
+      break;
+    }
   }
   // Reset the BPF map to its default value so that each occurrence
   // can be detected.
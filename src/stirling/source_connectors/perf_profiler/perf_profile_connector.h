@@ -43,6 +43,7 @@ namespace px {
 namespace stirling {
 
 using bpf_tools::WrappedBCCArrayTable;
+using bpf_tools::WrappedBCCMap;
 using bpf_tools::WrappedBCCStackTable;
 
 namespace profiler {
@@ -62,16 +63,20 @@ class PerfProfileConnector : public BCCSourceConnector {
   Status InitImpl() override;
   Status StopImpl() override;
   void TransferDataImpl(ConnectorContext* ctx) override;
+  bool thread_safe() const override { return true; }
 
   std::chrono::milliseconds SamplingPeriod() const { return sampling_period_; }
   std::chrono::milliseconds StackTraceSamplingPeriod() const {
     return stack_trace_sampling_period_;
   }
 
+  bool off_cpu_enabled() const { return off_cpu_enabled_; }
+
   enum class StatKey {
     kBPFMapSwitchoverEvent,
     kCumulativeSumOfAllStackTraces,
     kLossHistoEvent,
+    kOffCPUStackTraces,
   };
 
   utils::StatCounter<StatKey> stats() const { return stats_; }
@@ -92,15 +97,24 @@ class PerfProfileConnector : public BCCSourceConnector {
   // RawHistoData: a list of stack trace keys that will need to be histogrammed.
   using RawHistoData = std::vector<stack_trace_key_t>;
 
+  // OffCPUHistoData: the histogram aggregated in BPF, stack trace key => blocked nanoseconds.
+  using OffCPUHistoData = std::vector<std::pair<stack_trace_key_t, uint64_t>>;
+
   explicit PerfProfileConnector(std::string_view source_name);
 
   void ProcessBPFStackTraces(ConnectorContext* ctx, DataTable* data_table);
 
   // Read BPF data structures, build & incorporate records to the table.
-  void CreateRecords(WrappedBCCStackTable* stack_traces, ConnectorContext* ctx,
-                     DataTable* data_table);
+  void CreateRecords(WrappedBCCStackTable* stack_traces, const OffCPUHistoData& off_cpu_histo_data,
+                     ConnectorContext* ctx, DataTable* data_table);
+
+  // Symbolizes the CPU samples (raw_histo_data_) and the off-CPU samples, which share the
+  // stack traces table, into a histogram each.
+  void AggregateStackTraces(ConnectorContext* ctx, WrappedBCCStackTable* stack_traces,
+                            const OffCPUHistoData& off_cpu_histo_data, StackTraceHisto* cpu_histo,
+                            StackTraceHisto* off_cpu_histo);
 
-  StackTraceHisto AggregateStackTraces(ConnectorContext* ctx, WrappedBCCStackTable* stack_traces);
+  Status InitOffCPUProfiling();
 
   void CleanupSymbolizers(const absl::flat_hash_set<md::UPID>& deleted_upids);
 
@@ -111,15 +125,22 @@ class PerfProfileConnector : public BCCSourceConnector {
   std::unique_ptr<WrappedBCCStackTable> stack_traces_a_;
   std::unique_ptr<WrappedBCCStackTable> stack_traces_b_;
 
+  std::unique_ptr<WrappedBCCMap<stack_trace_key_t, uint64_t>> off_cpu_histogram_a_;
+  std::unique_ptr<WrappedBCCMap<stack_trace_key_t, uint64_t>> off_cpu_histogram_b_;
+
   std::unique_ptr<WrappedBCCArrayTable<uint64_t>> profiler_state_;
   prometheus::Gauge& profiler_state_overflow_gauge_;
   prometheus::Counter& profiler_transfer_data_counter_;
   prometheus::Counter& profiler_state_overflow_counter_;
   prometheus::Counter& profiler_state_map_read_error_counter_;
+  prometheus::Counter& profiler_state_off_cpu_histogram_full_counter_;
 
   // Expected number of stack traces sampled per transfer data invocation.
   int32_t expected_stack_traces_;
 
+  // Set if the off-CPU probe was deployed.
+  bool off_cpu_enabled_ = false;
+
   // Number of iterations, where each iteration is drains the information collected in BPF.
   uint64_t transfer_count_ = 0;
 
@@ -29,6 +29,7 @@
 #include "src/common/base/base.h"
 #include "src/common/exec/subprocess.h"
 #include "src/common/fs/fs_wrapper.h"
+#include "src/common/testing/test_environment.h"
 #include "src/common/testing/test_utils/container_runner.h"
 #include "src/stirling/core/connector_context.h"
 #include "src/stirling/core/unit_connector.h"
@@ -43,6 +44,7 @@ DEFINE_uint32(test_run_time, 10, "Number of seconds to run the test.");
 DEFINE_string(test_java_image_names, JDK_IMAGE_NAMES,
               "Java docker images to use as Java test cases.");
 DECLARE_bool(stirling_profiler_java_symbols);
+DECLARE_bool(stirling_profiler_off_cpu);
 DECLARE_string(stirling_profiler_java_agent_libs);
 DECLARE_uint32(stirling_profiler_table_update_period_seconds);
 DECLARE_uint32(stirling_profiler_stack_trace_sample_period_ms);
@@ -122,7 +124,8 @@ class PerfProfilerTestSubProcesses {
 
 class CPUPinnedSubProcesses final : public PerfProfilerTestSubProcesses {
  public:
-  CPUPinnedSubProcesses(const std::string& binary_path) : binary_path_(binary_path) {}
+  CPUPinnedSubProcesses(const std::string& binary_path, std::vector<std::string> args = {})
+      : binary_path_(binary_path), args_(std::move(args)) {}
 
   ~CPUPinnedSubProcesses() { KillAll(); }
 
@@ -141,7 +144,9 @@ class CPUPinnedSubProcesses final : public PerfProfilerTestSubProcesses {
 
       // Run the sub-process & pin it to a CPU.
       std::string mask = absl::StrFormat("%#x", 1 << i);
-      ASSERT_OK(sub_process->Start({std::string(kTasksetBinPath), mask, binary_path_}));
+      std::vector<std::string> cmd = {std::string(kTasksetBinPath), mask, binary_path_};
+      cmd.insert(cmd.end(), args_.begin(), args_.end());
+      ASSERT_OK(sub_process->Start(cmd));
 
       // Grab the PID and generate a UPID.
       const int pid = sub_process->child_pid();
@@ -166,6 +171,7 @@ class CPUPinnedSubProcesses final : public PerfProfilerTestSubProcesses {
   static constexpr std::string_view kTasksetBinPath = "/bin/taskset";
   std::vector<std::unique_ptr<SubProcess>> sub_processes_;
   const std::string binary_path_;
+  const std::vector<std::string> args_;
 };
 
 class ContainerSubProcesses final : public PerfProfilerTestSubProcesses {
@@ -417,6 +423,37 @@ TEST_F(FastPerfProfileBPFTest, PerfProfilerCppTest) {
   ASSERT_NO_FATAL_FAILURE(CheckExpectedProfile(leaf_histo, key1x, key2x));
 }
 
+TEST_F(FastPerfProfileBPFTest, PerfProfilerOffCPUTest) {
+  PX_SET_FOR_SCOPE(FLAGS_stirling_profiler_off_cpu, true);
+
+  // The shells spend almost all of their time blocked, waiting for sleep to exit.
+  sub_processes_ = std::make_unique<CPUPinnedSubProcesses>(
+      "/bin/sh", std::vector<std::string>{"-c", "while true; do sleep 0.01; done"});
+  ASSERT_NO_FATAL_FAILURE(sub_processes_->StartAll());
+
+  ASSERT_OK(RunTest());
+  ASSERT_TRUE(source_.RawPtr()->off_cpu_enabled());
+
+  ASSERT_OK_AND_ASSIGN(columns_, source_.ConsumeRecords(kProfilerTableNum));
+  const auto target_row_idxs =
+      FindRecordIdxMatchesPIDs(columns_, kStackTraceUPIDIdx, sub_processes_->pids());
+
+  uint64_t off_cpu_count = 0;
+  for (const auto row_idx : target_row_idxs) {
+    const int64_t sample_type = columns_[kStackTraceSampleTypeIdx]->Get<types::Int64Value>(row_idx);
+    if (sample_type == static_cast<int64_t>(StackTraceSampleType::kOffCPU)) {
+      off_cpu_count += columns_[kStackTraceCountIdx]->Get<types::Int64Value>(row_idx).val;
+    }
+  }
+
+  // The off-CPU counts are in sampling periods, so blocking all the time adds up to the
+  // wall-clock time divided by the sampling period.
+  const double bpf_period_s = source_.RawPtr()->StackTraceSamplingPeriod().count() / 1000.0;
+  const double expected_count = kNumSubProcs * t_elapsed_.count() / bpf_period_s;
+  EXPECT_GT(off_cpu_count, 0.5 * expected_count);
+  EXPECT_LT(off_cpu_count, 1.1 * expected_count);
+}
+
 TEST_F(FastPerfProfileBPFTest, GraalVM_AOT_Test) {
   const std::string app_path = "ProfilerTest";
   const std::filesystem::path bazel_app_path = BazelJavaTestAppPath(app_path);
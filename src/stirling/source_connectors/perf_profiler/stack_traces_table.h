@@ -20,6 +20,7 @@
 
 #include <map>
 
+#include "src/common/base/enum_utils.h"
 #include "src/stirling/core/canonical_types.h"
 #include "src/stirling/core/output.h"
 #include "src/stirling/core/types.h"
@@ -27,6 +28,17 @@
 namespace px {
 namespace stirling {
 
+// What a stack trace was sampled for.
+enum class StackTraceSampleType {
+  // Running on a CPU.
+  kCPU = 0,
+  // Blocked, i.e. switched out by the scheduler (e.g. waiting on a futex, IO or a run queue).
+  kOffCPU = 1,
+};
+
+static const std::map<int64_t, std::string_view> kStackTraceSampleTypeDecoder =
+    px::EnumDefToMap<StackTraceSampleType>();
+
 // clang-format off
 static constexpr DataElement kElements[] = {
     canonical_data_elements::kTime,
@@ -41,8 +53,14 @@ static constexpr DataElement kElements[] = {
      "If symbols cannot be resolved, addresses are populated instead.",
      types::DataType::STRING, types::SemanticType::ST_NONE, types::PatternType::GENERAL},
     {"count",
-     "Number of times the stack trace has been sampled.",
-     types::DataType::INT64, types::SemanticType::ST_NONE, types::PatternType::METRIC_GAUGE}
+     "Number of times the stack trace has been sampled. For off-CPU samples, this is the time "
+     "blocked in the stack trace divided by the sampling period, so that CPU and off-CPU counts "
+     "can be added up into a wall-clock profile.",
+     types::DataType::INT64, types::SemanticType::ST_NONE, types::PatternType::METRIC_GAUGE},
+    {"sample_type",
+     "Whether the stack trace was sampled running on a CPU, or blocked off-CPU.",
+     types::DataType::INT64, types::SemanticType::ST_NONE, types::PatternType::GENERAL_ENUM,
+     &kStackTraceSampleTypeDecoder}
 };
 
 constexpr auto kStackTraceTable = DataTableSchema(
@@ -59,6 +77,7 @@ constexpr int kStackTraceUPIDIdx = kStackTraceTable.ColIndex("upid");
 constexpr int kStackTraceStackTraceIDIdx = kStackTraceTable.ColIndex("stack_trace_id");
 constexpr int kStackTraceStackTraceStrIdx = kStackTraceTable.ColIndex("stack_trace");
 constexpr int kStackTraceCountIdx = kStackTraceTable.ColIndex("count");
+constexpr int kStackTraceSampleTypeIdx = kStackTraceTable.ColIndex("sample_type");
 
 }  // namespace stirling
 }  // namespace px
@@ -16,6 +16,9 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <memory>
+#include <optional>
+#include <string>
 #include <utility>
 
 #include <absl/functional/bind_front.h>
@@ -41,36 +44,89 @@ void CachingSymbolizer::IterationPreTick() { symbolizer_->IterationPreTick(); }
 
 profiler::SymbolizerFn CachingSymbolizer::GetSymbolizerFn(const struct upid_t& upid) {
   if (symbolizer_->Uncacheable(upid)) {
+    auto symbolizer_fn = symbolizer_->GetSymbolizerFn(upid);
+    // A process whose symbols became uncacheable (e.g. a Java agent attached to it) leaves the
+    // shared cache of its binary, which no longer has its symbols.
     // NB: the normal cache eviction process will eventually zero out the memory used
     // by the cache that was created while the Java symbolizer was in its "attach" phase.
-    return symbolizer_->GetSymbolizerFn(upid);
+    auto iter = symbol_caches_.find(upid);
+    if (iter != symbol_caches_.end() && !iter->second->shared_key.empty()) {
+      ReleaseSharedCache(iter->second.get());
+      iter->second->cache = std::make_shared<SymbolCache>(symbolizer_fn);
+      iter->second->virtual_to_binary_addr_offset = 0;
+    }
+    return symbolizer_fn;
   }
 
-  const auto [iter, inserted] = symbol_caches_.try_emplace(upid, nullptr);
+  std::unique_ptr<UPIDCache>& upid_cache_ptr = symbol_caches_[upid];
+  if (upid_cache_ptr == nullptr) {
+    upid_cache_ptr = std::make_unique<UPIDCache>();
+  }
+  // The UPIDCache is updated in place, so that the symbolizer functions that were returned
+  // before stay valid.
+  UPIDCache* upid_cache = upid_cache_ptr.get();
 
   // Here, we trigger the get symbolizer logic in the underlying symbolizer to ensure that
   // we catch any Java processes that may have had their agent delayed by attach rate limiting.
   auto symbolizer_fn = symbolizer_->GetSymbolizerFn(upid);
 
-  if (inserted) {
-    iter->second = std::make_unique<SymbolCache>(symbolizer_fn);
+  // Whether the symbols of the process are shared is checked on every call, because it can
+  // change after the first lookup, e.g. when a Java agent attaches to the process later.
+  std::optional<SharedSymbols> shared_symbols = symbolizer_->GetSharedSymbols(upid);
+  if (shared_symbols.has_value()) {
+    if (upid_cache->cache == nullptr || upid_cache->shared_key != shared_symbols->key) {
+      ReleaseSharedCache(upid_cache);
+      std::weak_ptr<SymbolCache>& shared_cache = shared_caches_[shared_symbols->key];
+      upid_cache->cache = shared_cache.lock();
+      if (upid_cache->cache == nullptr) {
+        upid_cache->cache = std::make_shared<SymbolCache>(shared_symbols->binary_symbolizer_fn);
+        shared_cache = upid_cache->cache;
+      }
+      upid_cache->virtual_to_binary_addr_offset = shared_symbols->virtual_to_binary_addr_offset;
+      upid_cache->shared_key = std::move(shared_symbols->key);
+    }
+  } else if (upid_cache->cache == nullptr || !upid_cache->shared_key.empty()) {
+    // The process moves to a cache of its own.
+    ReleaseSharedCache(upid_cache);
+    upid_cache->cache = std::make_shared<SymbolCache>(symbolizer_fn);
+    upid_cache->virtual_to_binary_addr_offset = 0;
   }
-  auto& cache = iter->second;
 
   // TODO(jps): Remove this extra 'set_symbolizer_fn()' when we deprecate agent rate limiting.
-  cache->set_symbolizer_fn(symbolizer_fn);
+  // Shared caches keep the symbolizer of the binary.
+  if (upid_cache->shared_key.empty()) {
+    upid_cache->cache->set_symbolizer_fn(symbolizer_fn);
+  }
 
-  auto fn = absl::bind_front(&CachingSymbolizer::Symbolize, this, cache.get());
+  auto fn = absl::bind_front(&CachingSymbolizer::Symbolize, this, upid_cache);
   return fn;
 }
 
 void CachingSymbolizer::DeleteUPID(const struct upid_t& upid) {
-  // The inner map is owned by a unique_ptr; this will free the memory.
-  symbol_caches_.erase(upid);
+  auto iter = symbol_caches_.find(upid);
+  if (iter != symbol_caches_.end()) {
+    ReleaseSharedCache(iter->second.get());
+    symbol_caches_.erase(iter);
+  }
 
   symbolizer_->DeleteUPID(upid);
 }
 
+void CachingSymbolizer::ReleaseSharedCache(UPIDCache* upid_cache) {
+  if (upid_cache->shared_key.empty()) {
+    return;
+  }
+  const std::string shared_key = std::move(upid_cache->shared_key);
+  upid_cache->shared_key.clear();
+  // The inner map is owned by a shared_ptr; this will free the memory, unless other processes
+  // of the same binary still use it.
+  upid_cache->cache.reset();
+  auto shared_iter = shared_caches_.find(shared_key);
+  if (shared_iter != shared_caches_.end() && shared_iter->second.expired()) {
+    shared_caches_.erase(shared_iter);
+  }
+}
+
 size_t CachingSymbolizer::PerformEvictions() {
   // Zero has a special meaning: no evictions.
   if (FLAGS_stirling_profiler_cache_eviction_threshold == 0) {
@@ -78,24 +134,36 @@ size_t CachingSymbolizer::PerformEvictions() {
   }
 
   size_t active_entries = 0;
-  for (const auto& sym_cache : symbol_caches_) {
-    active_entries += sym_cache.second->active_entries();
-  }
+  ForEachCache(
+      [&active_entries](SymbolCache* cache) { active_entries += cache->active_entries(); });
 
   size_t evict_count = 0;
   if (active_entries > FLAGS_stirling_profiler_cache_eviction_threshold) {
-    for (const auto& sym_cache : symbol_caches_) {
-      evict_count += sym_cache.second->PerformEvictions();
-    }
+    ForEachCache([&evict_count](SymbolCache* cache) { evict_count += cache->PerformEvictions(); });
   }
 
   return evict_count;
 }
 
-std::string_view CachingSymbolizer::Symbolize(SymbolCache* symbol_cache, const uintptr_t addr) {
+void CachingSymbolizer::ForEachCache(const std::function<void(SymbolCache*)>& fn) const {
+  for (const auto& [upid, upid_cache] : symbol_caches_) {
+    if (upid_cache->shared_key.empty()) {
+      fn(upid_cache->cache.get());
+    }
+  }
+  for (const auto& [key, shared_cache] : shared_caches_) {
+    std::shared_ptr<SymbolCache> cache = shared_cache.lock();
+    if (cache != nullptr) {
+      fn(cache.get());
+    }
+  }
+}
+
+std::string_view CachingSymbolizer::Symbolize(const UPIDCache* upid_cache, const uintptr_t addr) {
   ++stat_accesses_;
 
-  const SymbolCache::LookupResult result = symbol_cache->Lookup(addr);
+  const SymbolCache::LookupResult result =
+      upid_cache->cache->Lookup(addr + upid_cache->virtual_to_binary_addr_offset);
 
   if (result.hit) {
     ++stat_hits_;
@@ -105,9 +173,7 @@ std::string_view CachingSymbolizer::Symbolize(SymbolCache* symbol_cache, const u
 
 uint64_t CachingSymbolizer::GetNumberOfSymbolsCached() const {
   uint64_t n = 0;
-  for (const auto& [upid, symbol_cache] : symbol_caches_) {
-    n += symbol_cache->total_entries();
-  }
+  ForEachCache([&n](SymbolCache* cache) { n += cache->total_entries(); });
   return n;
 }
 
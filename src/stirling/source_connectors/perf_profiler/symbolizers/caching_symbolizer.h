@@ -18,7 +18,9 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
+#include <string>
 
 #include "src/stirling/source_connectors/perf_profiler/symbol_cache/symbol_cache.h"
 #include "src/stirling/source_connectors/perf_profiler/symbolizers/symbolizer.h"
@@ -30,6 +32,9 @@ namespace stirling {
 
 /**
  * A class that takes another symbolizer and adds a cache to it.
+ * Processes whose symbols are shared by the inner symbolizer (see Symbolizer::GetSharedSymbols())
+ * also share a cache, which is keyed by binary address instead of virtual address. A process moves
+ * to a cache of its own when its symbols stop being shared, e.g. when a Java agent attaches to it.
  */
 class CachingSymbolizer : public Symbolizer {
  public:
@@ -49,11 +54,30 @@ class CachingSymbolizer : public Symbolizer {
  private:
   CachingSymbolizer() = default;
 
-  std::string_view Symbolize(SymbolCache* symbol_cache, const uintptr_t addr);
+  struct UPIDCache {
+    std::shared_ptr<SymbolCache> cache;
+    // Added to the addresses before the lookup, for caches that are shared by binary address.
+    int64_t virtual_to_binary_addr_offset = 0;
+    // The key in shared_caches_, or empty if the cache is not shared.
+    std::string shared_key;
+  };
+
+  std::string_view Symbolize(const UPIDCache* upid_cache, const uintptr_t addr);
+
+  // Drops the reference of the UPID cache to its shared cache, if it has one, and erases the
+  // shared cache if no other process uses it.
+  void ReleaseSharedCache(UPIDCache* upid_cache);
+
+  // Calls fn once for each distinct cache.
+  void ForEachCache(const std::function<void(SymbolCache*)>& fn) const;
 
   std::unique_ptr<Symbolizer> symbolizer_;
 
-  absl::flat_hash_map<struct upid_t, std::unique_ptr<SymbolCache>> symbol_caches_;
+  absl::flat_hash_map<struct upid_t, std::unique_ptr<UPIDCache>> symbol_caches_;
+
+  // The caches that are shared by the processes running the same binary, keyed by
+  // SharedSymbols::key. Erased when the last process of the binary is deleted.
+  absl::flat_hash_map<std::string, std::weak_ptr<SymbolCache>> shared_caches_;
 
   int64_t stat_accesses_ = 0;
   int64_t stat_hits_ = 0;
@@ -17,6 +17,7 @@
  */
 
 #include <memory>
+#include <string>
 #include <utility>
 
 #include <absl/functional/bind_front.h>
@@ -40,20 +41,48 @@ StatusOr<std::unique_ptr<Symbolizer>> ElfSymbolizer::Create() {
   return symbolizer;
 }
 
-void ElfSymbolizer::DeleteUPID(const struct upid_t& upid) { symbolizers_.erase(upid); }
+void ElfSymbolizer::DeleteUPID(const struct upid_t& upid) {
+  auto iter = symbolizers_.find(upid);
+  if (iter == symbolizers_.end()) {
+    return;
+  }
+  if (iter->second == nullptr) {
+    // Creating the symbolizer failed.
+    symbolizers_.erase(iter);
+    return;
+  }
+  const std::string binary_key = iter->second->binary_key();
+  symbolizers_.erase(iter);
 
-StatusOr<std::unique_ptr<ElfSymbolizer::SymbolizerWithConverter>> CreateUPIDSymbolizer(
-    const struct upid_t& upid) {
+  auto binary_iter = binary_symbolizers_.find(binary_key);
+  if (binary_iter != binary_symbolizers_.end() && binary_iter->second.expired()) {
+    binary_symbolizers_.erase(binary_iter);
+  }
+}
+
+StatusOr<std::unique_ptr<ElfSymbolizer::SymbolizerWithConverter>>
+ElfSymbolizer::CreateUPIDSymbolizer(const struct upid_t& upid) {
   const pid_t pid = upid.pid;
   const system::ProcParser proc_parser;
   PX_ASSIGN_OR_RETURN(const auto proc_exe, proc_parser.GetExePath(pid));
   PX_ASSIGN_OR_RETURN(auto elf_reader, ElfReader::Create(ProcPidRootPath(pid, proc_exe.string())));
+  PX_ASSIGN_OR_RETURN(std::string binary_key, elf_reader->Identity());
+
+  // Reuse the symbol table if another process runs the same binary.
+  std::shared_ptr<const ElfReader::Symbolizer> symbolizer;
+  auto binary_iter = binary_symbolizers_.find(binary_key);
+  if (binary_iter != binary_symbolizers_.end()) {
+    symbolizer = binary_iter->second.lock();
+  }
+  if (symbolizer == nullptr) {
+    PX_ASSIGN_OR_RETURN(symbolizer, elf_reader->GetSymbolizer());
+    binary_symbolizers_[binary_key] = symbolizer;
+  }
 
-  PX_ASSIGN_OR_RETURN(auto symbolizer, elf_reader->GetSymbolizer());
   PX_ASSIGN_OR_RETURN(auto converter,
                       obj_tools::ElfAddressConverter::Create(elf_reader.get(), pid));
-  return std::make_unique<ElfSymbolizer::SymbolizerWithConverter>(std::move(symbolizer),
-                                                                  std::move(converter));
+  return std::make_unique<ElfSymbolizer::SymbolizerWithConverter>(
+      std::move(binary_key), std::move(symbolizer), std::move(converter));
 }
 
 std::string_view EmptySymbolizerFn(const uintptr_t addr) {
@@ -85,6 +114,19 @@ profiler::SymbolizerFn ElfSymbolizer::GetSymbolizerFn(const struct upid_t& upid)
                           symbolizer_with_converter.get());
 }
 
+std::optional<Symbolizer::SharedSymbols> ElfSymbolizer::GetSharedSymbols(
+    const struct upid_t& upid) {
+  auto iter = symbolizers_.find(upid);
+  if (iter == symbolizers_.end() || iter->second == nullptr) {
+    return std::nullopt;
+  }
+  const SymbolizerWithConverter& symbolizer_with_converter = *iter->second;
+  return SharedSymbols{
+      symbolizer_with_converter.binary_key(),
+      absl::bind_front(&ElfReader::Symbolizer::Lookup, symbolizer_with_converter.symbolizer()),
+      symbolizer_with_converter.converter().virtual_to_binary_addr_offset()};
+}
+
 std::string_view ElfSymbolizer::SymbolizerWithConverter::Lookup(uint64_t virtual_addr) const {
   auto binary_addr = converter_->VirtualAddrToBinaryAddr(virtual_addr);
   return symbolizer_->Lookup(binary_addr);
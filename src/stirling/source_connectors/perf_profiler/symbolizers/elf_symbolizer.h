@@ -19,6 +19,7 @@
 #pragma once
 
 #include <memory>
+#include <string>
 #include <utility>
 
 #include "src/stirling/obj_tools/address_converter.h"
@@ -29,6 +30,8 @@ namespace stirling {
 
 /**
  * A Symbolizer using the ElfReader symbolization core.
+ * The symbol table of a binary is shared by all the processes that run it, even from different
+ * paths; only the address converter is per process.
  */
 class ElfSymbolizer : public Symbolizer, public NotCopyMoveable {
  public:
@@ -38,24 +41,44 @@ class ElfSymbolizer : public Symbolizer, public NotCopyMoveable {
   void IterationPreTick() override {}
   void DeleteUPID(const struct upid_t& upid) override;
   bool Uncacheable(const struct upid_t& /*upid*/) override { return false; }
+  std::optional<SharedSymbols> GetSharedSymbols(const struct upid_t& upid) override;
 
   class SymbolizerWithConverter {
    public:
-    SymbolizerWithConverter(std::unique_ptr<obj_tools::ElfReader::Symbolizer> symbolizer,
+    SymbolizerWithConverter(std::string binary_key,
+                            std::shared_ptr<const obj_tools::ElfReader::Symbolizer> symbolizer,
                             std::unique_ptr<obj_tools::ElfAddressConverter> converter)
-        : symbolizer_(std::move(symbolizer)), converter_(std::move(converter)) {}
+        : binary_key_(std::move(binary_key)),
+          symbolizer_(std::move(symbolizer)),
+          converter_(std::move(converter)) {}
     std::string_view Lookup(uintptr_t addr) const;
 
+    const std::string& binary_key() const { return binary_key_; }
+    const obj_tools::ElfReader::Symbolizer* symbolizer() const { return symbolizer_.get(); }
+    const obj_tools::ElfAddressConverter& converter() const { return *converter_; }
+
    private:
-    std::unique_ptr<obj_tools::ElfReader::Symbolizer> symbolizer_;
+    std::string binary_key_;
+    std::shared_ptr<const obj_tools::ElfReader::Symbolizer> symbolizer_;
     std::unique_ptr<obj_tools::ElfAddressConverter> converter_;
   };
 
+  // The number of distinct symbol tables that are loaded.
+  size_t num_binaries() const { return binary_symbolizers_.size(); }
+
  private:
   ElfSymbolizer() = default;
 
+  StatusOr<std::unique_ptr<SymbolizerWithConverter>> CreateUPIDSymbolizer(
+      const struct upid_t& upid);
+
   // A symbolizer per UPID.
   absl::flat_hash_map<struct upid_t, std::unique_ptr<SymbolizerWithConverter>> symbolizers_;
+
+  // The symbol tables, keyed by ElfReader::Identity(). They are owned by the
+  // SymbolizerWithConverter of the UPIDs, and erased when the last UPID of the binary is deleted.
+  absl::flat_hash_map<std::string, std::weak_ptr<const obj_tools::ElfReader::Symbolizer>>
+      binary_symbolizers_;
 };
 
 }  // namespace stirling
@@ -354,6 +354,16 @@ bool JavaSymbolizer::Uncacheable(const struct upid_t& upid) {
   return true;
 }
 
+std::optional<Symbolizer::SharedSymbols> JavaSymbolizer::GetSharedSymbols(
+    const struct upid_t& upid) {
+  // Only native symbols are shared. Callers must check Uncacheable() before using them, since a
+  // process can become a symbolized Java process later.
+  if (symbolization_contexts_.contains(upid)) {
+    return std::nullopt;
+  }
+  return native_symbolizer_->GetSharedSymbols(upid);
+}
+
 profiler::SymbolizerFn JavaSymbolizer::GetSymbolizerFn(const struct upid_t& upid) {
   auto fn_it = symbolizer_functions_.find(upid);
   if (fn_it != symbolizer_functions_.end()) {
@@ -74,6 +74,7 @@ class JavaSymbolizer : public Symbolizer {
   void IterationPreTick() override;
   void DeleteUPID(const struct upid_t& upid) override;
   bool Uncacheable(const struct upid_t& upid) override;
+  std::optional<SharedSymbols> GetSharedSymbols(const struct upid_t& upid) override;
 
  private:
   JavaSymbolizer() = delete;
@@ -19,6 +19,7 @@
 #pragma once
 
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 
@@ -63,6 +64,26 @@ class Symbolizer : public NotCopyable {
    * Indicates that underlying symbols cannot be cached because they are subject to change.
    */
   virtual bool Uncacheable(const struct upid_t& upid) = 0;
+
+  /**
+   * The symbols of a process that are shared with the other processes that run the same binary.
+   */
+  struct SharedSymbols {
+    // Identifies the binary. Processes with the same key have the same symbols.
+    std::string key;
+    // Converts the addresses of the binary (not the virtual addresses of the process) to symbols.
+    profiler::SymbolizerFn binary_symbolizer_fn;
+    // Added to a virtual address of the process to get the address in the binary.
+    int64_t virtual_to_binary_addr_offset = 0;
+  };
+
+  /**
+   * Returns the symbols of the process, if they are shared by binary identity, so that symbol
+   * caches can be shared too. Must be called after GetSymbolizerFn() for the UPID.
+   */
+  virtual std::optional<SharedSymbols> GetSharedSymbols(const struct upid_t& /*upid*/) {
+    return std::nullopt;
+  }
 };
 
 }  // namespace stirling
@@ -18,8 +18,11 @@
 
 #include <sys/mount.h>
 
+#include <absl/container/flat_hash_set.h>
 #include <gtest/gtest.h>
 
+#include <memory>
+#include <optional>
 #include <set>
 
 #include "src/common/exec/subprocess.h"
@@ -82,6 +85,133 @@ TYPED_TEST(SymbolizerTest, UserSymbols) {
   EXPECT_EQ(symbolize(kBarAddr), "test::bar()");
 }
 
+TEST_F(ElfSymbolizerTest, SharedBetweenProcessesOfSameBinary) {
+  // Two UPIDs of this process stand in for two processes that run the same binary.
+  const uint32_t pid = getpid();
+  const struct upid_t upid1 = {.pid = pid, .start_time_ticks = 0};
+  const struct upid_t upid2 = {.pid = pid, .start_time_ticks = 1};
+
+  auto symbolize1 = symbolizer_->GetSymbolizerFn(upid1);
+  auto symbolize2 = symbolizer_->GetSymbolizerFn(upid2);
+  EXPECT_EQ(symbolize1(kFooAddr), "test::foo()");
+  EXPECT_EQ(symbolize2(kBarAddr), "test::bar()");
+
+  auto* elf_symbolizer = static_cast<ElfSymbolizer*>(symbolizer_.get());
+  EXPECT_EQ(elf_symbolizer->num_binaries(), 1U);
+
+  std::optional<Symbolizer::SharedSymbols> shared1 = symbolizer_->GetSharedSymbols(upid1);
+  std::optional<Symbolizer::SharedSymbols> shared2 = symbolizer_->GetSharedSymbols(upid2);
+  ASSERT_TRUE(shared1.has_value());
+  ASSERT_TRUE(shared2.has_value());
+  EXPECT_EQ(shared1->key, shared2->key);
+  EXPECT_EQ(shared1->binary_symbolizer_fn(kFooAddr + shared1->virtual_to_binary_addr_offset),
+            "test::foo()");
+
+  symbolizer_->DeleteUPID(upid1);
+  EXPECT_EQ(elf_symbolizer->num_binaries(), 1U);
+  EXPECT_EQ(symbolize2(kFooAddr), "test::foo()");
+  symbolizer_->DeleteUPID(upid2);
+  EXPECT_EQ(elf_symbolizer->num_binaries(), 0U);
+}
+
+TEST(CachingSymbolizerTest, SharedCacheForSameBinary) {
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<Symbolizer> elf_symbolizer, ElfSymbolizer::Create());
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<Symbolizer> symbolizer_uptr,
+                       CachingSymbolizer::Create(std::move(elf_symbolizer)));
+  auto* symbolizer = static_cast<CachingSymbolizer*>(symbolizer_uptr.get());
+
+  const uint32_t pid = getpid();
+  const struct upid_t upid1 = {.pid = pid, .start_time_ticks = 0};
+  const struct upid_t upid2 = {.pid = pid, .start_time_ticks = 1};
+
+  EXPECT_EQ(symbolizer->GetSymbolizerFn(upid1)(kFooAddr), "test::foo()");
+  EXPECT_EQ(symbolizer->GetSymbolizerFn(upid2)(kFooAddr), "test::foo()");
+  EXPECT_EQ(symbolizer->GetSymbolizerFn(upid2)(kBarAddr), "test::bar()");
+
+  // The second process hits the entry cached by the first one.
+  EXPECT_EQ(symbolizer->stat_accesses(), 3);
+  EXPECT_EQ(symbolizer->stat_hits(), 1);
+  EXPECT_EQ(symbolizer->GetNumberOfSymbolsCached(), 2U);
+}
+
+// A symbolizer that shares the native symbols of all processes, like an ElfSymbolizer for
+// processes of the same binary, until a process is set to be symbolized as Java, like by a
+// JavaSymbolizer whose agent attached to the process.
+class FakeJavaSymbolizer : public Symbolizer {
+ public:
+  profiler::SymbolizerFn GetSymbolizerFn(const struct upid_t& upid) override {
+    if (java_upids_.contains(upid)) {
+      return profiler::SymbolizerFn(&JavaSymbol);
+    }
+    return profiler::SymbolizerFn(&NativeSymbol);
+  }
+  void IterationPreTick() override {}
+  void DeleteUPID(const struct upid_t& upid) override { java_upids_.erase(upid); }
+  bool Uncacheable(const struct upid_t& upid) override {
+    return java_uncacheable_ && java_upids_.contains(upid);
+  }
+  std::optional<SharedSymbols> GetSharedSymbols(const struct upid_t& upid) override {
+    if (java_upids_.contains(upid)) {
+      return std::nullopt;
+    }
+    return SharedSymbols{"build-id:1234", profiler::SymbolizerFn(&NativeSymbol), 0};
+  }
+
+  void AttachJava(const struct upid_t& upid, bool uncacheable) {
+    java_upids_.insert(upid);
+    java_uncacheable_ = uncacheable;
+  }
+
+ private:
+  static std::string_view NativeSymbol(const uintptr_t) { return "native"; }
+  static std::string_view JavaSymbol(const uintptr_t) { return "[j] java"; }
+
+  absl::flat_hash_set<struct upid_t> java_upids_;
+  bool java_uncacheable_ = false;
+};
+
+class CachingJavaSymbolizerTest : public ::testing::TestWithParam<bool> {
+ protected:
+  void SetUp() override {
+    auto java_symbolizer = std::make_unique<FakeJavaSymbolizer>();
+    java_symbolizer_ = java_symbolizer.get();
+    ASSERT_OK_AND_ASSIGN(symbolizer_uptr_, CachingSymbolizer::Create(std::move(java_symbolizer)));
+    symbolizer_ = static_cast<CachingSymbolizer*>(symbolizer_uptr_.get());
+  }
+
+  std::unique_ptr<Symbolizer> symbolizer_uptr_;
+  CachingSymbolizer* symbolizer_;
+  FakeJavaSymbolizer* java_symbolizer_;
+};
+
+// Tests that a process that becomes a Java process after its first lookup leaves the shared
+// cache of its binary, whether its Java symbols are uncacheable or just not shared.
+TEST_P(CachingJavaSymbolizerTest, JavaAttachedAfterFirstLookup) {
+  const bool uncacheable = GetParam();
+  const struct upid_t upid1 = {.pid = 1, .start_time_ticks = 0};
+  const struct upid_t upid2 = {.pid = 2, .start_time_ticks = 0};
+
+  auto symbolize1 = symbolizer_->GetSymbolizerFn(upid1);
+  EXPECT_EQ(symbolize1(kFooAddr), "native");
+  EXPECT_EQ(symbolizer_->GetSymbolizerFn(upid2)(kFooAddr), "native");
+  EXPECT_EQ(symbolizer_->stat_hits(), 1);
+  EXPECT_EQ(symbolizer_->GetNumberOfSymbolsCached(), 1U);
+
+  java_symbolizer_->AttachJava(upid1, uncacheable);
+  EXPECT_EQ(symbolizer_->GetSymbolizerFn(upid1)(kFooAddr), "[j] java");
+  // The symbolizer function of the first lookup stays valid.
+  EXPECT_EQ(symbolize1(kFooAddr), "[j] java");
+  // The other process of the binary still uses the shared cache.
+  EXPECT_EQ(symbolizer_->GetSymbolizerFn(upid2)(kFooAddr), "native");
+
+  // The shared cache is freed with the last process of the binary that uses it, which leaves the
+  // Java symbol in the cache of the first process.
+  symbolizer_->DeleteUPID(upid2);
+  EXPECT_EQ(symbolizer_->GetNumberOfSymbolsCached(), 1U);
+}
+
+INSTANTIATE_TEST_SUITE_P(UncacheableOrNotShared, CachingJavaSymbolizerTest, ::testing::Bool());
+
 TEST_F(BCCSymbolizerTest, KernelSymbols) {
   ASSERT_OK_AND_ASSIGN(std::unique_ptr<Symbolizer> symbolizer, BCCSymbolizer::Create());
 
@@ -54,6 +54,7 @@ class ProcessStatsConnector : public SourceConnector {
   Status StopImpl() override;
 
   void TransferDataImpl(ConnectorContext* ctx) override;
+  bool thread_safe() const override { return true; }
 
  protected:
   explicit ProcessStatsConnector(std::string_view source_name)
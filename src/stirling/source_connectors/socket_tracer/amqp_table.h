@@ -78,6 +78,7 @@ static constexpr DataElement kAMQPElements[] = {
          types::SemanticType::ST_NONE,
          types::PatternType::GENERAL},
         canonical_data_elements::kLatencyNS,
+        canonical_data_elements::kSamplingRatio,
 };
 // clang-format on
 
@@ -44,9 +44,25 @@ const int32_t kInvalidFD = -1;
 // is reported to user-space. It applies to read and write traffic combined.
 const int kConnStatsDataThreshold = 65536;
 
+// USE_RINGBUF selects BPF ring buffers (Linux 5.8+) over perf buffers for the data and control
+// events. User-space sets it, along with the ring buffer sizes in pages.
+#ifndef USE_RINGBUF
+#define USE_RINGBUF 0
+#endif
+
+#if USE_RINGBUF
+// Unlike perf buffers, a ring buffer is shared by all CPUs.
+BPF_RINGBUF_OUTPUT(socket_data_events, SOCKET_DATA_EVENTS_RINGBUF_PAGES);
+BPF_RINGBUF_OUTPUT(socket_control_events, SOCKET_CONTROL_EVENTS_RINGBUF_PAGES);
+
+// Ring buffers don't report dropped events to user-space, so they are counted here,
+// indexed by ringbuf_channel_t.
+BPF_PERCPU_ARRAY(ringbuf_lost_events, uint64_t, kNumRingBufChannels);
+#else
 // This is the perf buffer for BPF program to export data from kernel to user space.
 BPF_PERF_OUTPUT(socket_data_events);
 BPF_PERF_OUTPUT(socket_control_events);
+#endif
 BPF_PERF_OUTPUT(conn_stats_events);
 
 // This output is used to export notification of processes that have performed an mmap.
@@ -58,6 +74,11 @@ BPF_PERF_OUTPUT(mmap_events);
 // There is a control map element for each protocol.
 BPF_PERCPU_ARRAY(control_map, uint64_t, kNumProtocols);
 
+// The maximum number of bytes of each read/write that are sent to user-space, per protocol.
+// The rest of the bytes are reported as a data-less event, which user-space turns into filler.
+// A value of 0 means there is no limit. Set by user-space.
+BPF_PERCPU_ARRAY(capture_limit_map, uint32_t, kNumProtocols);
+
 // Map from user-space file descriptors to the connections obtained from accept() syscall.
 // Tracks connection from accept() -> close().
 // Key is {tgid, fd}.
@@ -123,6 +144,44 @@ BPF_PERCPU_ARRAY(conn_stats_event_buffer_heap, struct conn_stats_event_t, 1);
 // number of arrays with only 1 element.
 BPF_PERCPU_ARRAY(control_values, int64_t, kNumControlValues);
 
+// The data event rate limits of the processes, keyed by tgid.
+// An LRU map, so that the buckets of exited processes are evicted.
+BPF_TABLE("lru_hash", uint32_t, struct rate_limit_bucket_t, upid_rate_limit_map, 16384);
+
+#if USE_RINGBUF
+static __inline void count_ringbuf_lost_event(int channel) {
+  uint64_t* lost_events = ringbuf_lost_events.lookup(&channel);
+  if (lost_events != NULL) {
+    *lost_events += 1;
+  }
+}
+#endif
+
+// User-space consumes the ring buffers on its own schedule rather than waiting on them, so
+// submitting an event doesn't wake it up, which saves a wakeup per event.
+static __inline void submit_data_event(struct pt_regs* ctx, struct socket_data_event_t* event,
+                                       size_t size) {
+#if USE_RINGBUF
+  if (socket_data_events.ringbuf_output(event, size, BPF_RB_NO_WAKEUP) != 0) {
+    count_ringbuf_lost_event(kSocketDataEventsRingBuf);
+  }
+#else
+  socket_data_events.perf_submit(ctx, event, size);
+#endif
+}
+
+static __inline void submit_control_event(struct pt_regs* ctx,
+                                          struct socket_control_event_t* event) {
+#if USE_RINGBUF
+  if (socket_control_events.ringbuf_output(event, sizeof(struct socket_control_event_t),
+                                           BPF_RB_NO_WAKEUP) != 0) {
+    count_ringbuf_lost_event(kSocketControlEventsRingBuf);
+  }
+#else
+  socket_control_events.perf_submit(ctx, event, sizeof(struct socket_control_event_t));
+#endif
+}
+
 /***********************************************************
  * General helper functions
  ***********************************************************/
@@ -138,12 +197,39 @@ static __inline void init_conn_id(uint32_t tgid, int32_t fd, struct conn_id_t* c
   conn_id->tsid = bpf_ktime_get_ns();
 }
 
+// Decides whether the data of the connection is sent to user-space. The decision is a
+// deterministic function of the conn_id, made once when the connection is first seen, so a
+// connection is either sampled in full or not at all.
+static __inline void init_conn_sampling(struct conn_info_t* conn_info) {
+  conn_info->sampled = true;
+  conn_info->sampling_ratio = kConnSamplingScale;
+
+  int idx = kConnSamplingRatioIndex;
+  int64_t* ratio = control_values.lookup(&idx);
+  if (ratio == NULL || *ratio <= 0 || *ratio >= kConnSamplingScale) {
+    return;
+  }
+
+  uint64_t h = ((uint64_t)conn_info->conn_id.upid.tgid << 32) | (uint32_t)conn_info->conn_id.fd;
+  h ^= conn_info->conn_id.tsid;
+  // The finalization step of MurmurHash3, so that similar conn_ids are spread out.
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+
+  conn_info->sampled = (h % kConnSamplingScale) < *ratio;
+  conn_info->sampling_ratio = *ratio;
+}
+
 static __inline void init_conn_info(uint32_t tgid, int32_t fd, struct conn_info_t* conn_info) {
   init_conn_id(tgid, fd, &conn_info->conn_id);
   // NOTE: BCC code defaults to 0, because kRoleUnknown is not 0, must explicitly initialize.
   conn_info->role = kRoleUnknown;
   conn_info->laddr.sa.sa_family = PX_AF_UNKNOWN;
   conn_info->raddr.sa.sa_family = PX_AF_UNKNOWN;
+  init_conn_sampling(conn_info);
 }
 
 // Be careful calling this function. The automatic creation of BPF map entries can result in a
@@ -152,6 +238,11 @@ static __inline void init_conn_info(uint32_t tgid, int32_t fd, struct conn_info_
 // the relevant map entries every time a ConnTracker is destroyed.
 static __inline struct conn_info_t* get_or_create_conn_info(uint32_t tgid, int32_t fd) {
   uint64_t tgid_fd = gen_tgid_fd(tgid, fd);
+  // Only initialize a new conn_info if there is none, since that reads the sampling ratio.
+  struct conn_info_t* conn_info = conn_info_map.lookup(&tgid_fd);
+  if (conn_info != NULL) {
+    return conn_info;
+  }
   struct conn_info_t new_conn_info = {};
   init_conn_info(tgid, fd, &new_conn_info);
   return conn_info_map.lookup_or_init(&tgid_fd, &new_conn_info);
@@ -214,6 +305,8 @@ static __inline struct socket_data_event_t* fill_socket_data_event(
   event->attr.protocol = conn_info->protocol;
   event->attr.role = conn_info->role;
   event->attr.pos = (direction == kEgress) ? conn_info->wr_bytes : conn_info->rd_bytes;
+  event->attr.truncated = false;
+  event->attr.conn_sampling_ratio = conn_info->sampling_ratio;
   event->attr.prepend_length_header = conn_info->prepend_length_header;
   BPF_PROBE_READ_VAR(event->attr.length_header, conn_info->prev_buf);
   return event;
@@ -268,6 +361,17 @@ static __inline bool should_trace_protocol_data(const struct conn_info_t* conn_i
   return control & conn_info->role;
 }
 
+// Returns the number of the bytes_count bytes of a read/write that should be sent to user-space,
+// according to the capture limit of the protocol.
+static __inline size_t captured_bytes(const struct conn_info_t* conn_info, size_t bytes_count) {
+  uint32_t protocol = conn_info->protocol;
+  uint32_t* limit = capture_limit_map.lookup(&protocol);
+  if (limit == NULL || *limit == 0) {
+    return bytes_count;
+  }
+  return min_size_t(*limit, bytes_count);
+}
+
 static __inline bool is_stirling_tgid(const uint32_t tgid) {
   int idx = kStirlingTGIDIndex;
   int64_t* stirling_tgid = control_values.lookup(&idx);
@@ -407,7 +511,7 @@ static __inline void submit_new_conn(struct pt_regs* ctx, uint32_t tgid, int32_t
   control_event.open.laddr = conn_info.laddr;
   control_event.open.role = conn_info.role;
 
-  socket_control_events.perf_submit(ctx, &control_event, sizeof(struct socket_control_event_t));
+  submit_control_event(ctx, &control_event);
 }
 
 static __inline void submit_close_event(struct pt_regs* ctx, struct conn_info_t* conn_info,
@@ -420,7 +524,7 @@ static __inline void submit_close_event(struct pt_regs* ctx, struct conn_info_t*
   control_event.close.rd_bytes = conn_info->rd_bytes;
   control_event.close.wr_bytes = conn_info->wr_bytes;
 
-  socket_control_events.perf_submit(ctx, &control_event, sizeof(struct socket_control_event_t));
+  submit_control_event(ctx, &control_event);
 }
 
 // Writes the input buf to event, and submits the event to the corresponding perf buffer.
@@ -493,7 +597,7 @@ static __inline void perf_submit_buf(struct pt_regs* ctx, const enum traffic_dir
   // If-statement is redundant, but is required to keep the 4.14 verifier happy.
   if (amount_copied > 0) {
     event->attr.msg_buf_size = amount_copied;
-    socket_data_events.perf_submit(ctx, event, sizeof(event->attr) + amount_copied);
+    submit_data_event(ctx, event, sizeof(event->attr) + amount_copied);
   }
 }
 
@@ -693,8 +797,70 @@ static __inline void process_implicit_conn(struct pt_regs* ctx, uint64_t id,
   submit_new_conn(ctx, tgid, args->fd, args->addr, /*socket*/ NULL, kRoleUnknown, source_fn);
 }
 
-static __inline bool should_send_data(uint32_t tgid, uint64_t conn_disabled_tsid,
-                                      bool force_trace_tgid, struct conn_info_t* conn_info) {
+// Takes a token from the rate limit bucket of the process, and returns false if there were none.
+// Buckets hold up to one second of tokens, which are refilled continuously.
+// Concurrent updates from different CPUs may race, which only makes the limit approximate.
+static __inline bool take_rate_limit_token(uint32_t tgid) {
+  int idx = kUPIDRateLimitIndex;
+  int64_t* rate_ptr = control_values.lookup(&idx);
+  if (rate_ptr == NULL || *rate_ptr <= 0) {
+    return true;
+  }
+  const uint64_t rate = *rate_ptr;
+  const uint64_t now = bpf_ktime_get_ns();
+
+  struct rate_limit_bucket_t* bucket = upid_rate_limit_map.lookup(&tgid);
+  if (bucket == NULL) {
+    struct rate_limit_bucket_t new_bucket = {};
+    new_bucket.last_refill_ns = now;
+    new_bucket.tokens = rate - 1;
+    new_bucket.num_passed = 1;
+    upid_rate_limit_map.update(&tgid, &new_bucket);
+    return true;
+  }
+
+  const uint64_t kNanosPerSecond = 1000000000ULL;
+  const uint64_t elapsed_ns = now - bucket->last_refill_ns;
+  uint64_t refill = (elapsed_ns >= kNanosPerSecond) ? rate : elapsed_ns * rate / kNanosPerSecond;
+  // Only move the refill time when tokens were added, so that fractions of a token accumulate.
+  if (refill > 0) {
+    bucket->tokens = (bucket->tokens + refill > rate) ? rate : bucket->tokens + refill;
+    bucket->last_refill_ns = now;
+  }
+
+  if (bucket->tokens == 0) {
+    ++bucket->num_dropped;
+    return false;
+  }
+  --bucket->tokens;
+  ++bucket->num_passed;
+  return true;
+}
+
+// Returns whether the data event in the given direction passes the rate limit of the process.
+// The rate limit is applied to whole request/response exchanges, so that messages aren't cut short
+// and responses aren't traced without their requests: a token is taken when a request starts, i.e.
+// when the direction changes to the request direction of the connection, and the decision holds
+// for the request and its response.
+static __inline bool pass_rate_limit(uint32_t tgid, enum traffic_direction_t direction,
+                                     struct conn_info_t* conn_info) {
+  // Servers receive requests; clients, and connections of unknown role, send them.
+  const enum traffic_direction_t req_direction =
+      (conn_info->role == kRoleServer) ? kIngress : kEgress;
+  if (!conn_info->has_msg_direction || conn_info->msg_direction != direction) {
+    // The first message always takes a token, in case tracing starts in the middle of an exchange.
+    if (!conn_info->has_msg_direction || direction == req_direction) {
+      conn_info->msg_rate_limited = !take_rate_limit_token(tgid);
+    }
+    conn_info->has_msg_direction = true;
+    conn_info->msg_direction = direction;
+  }
+  return !conn_info->msg_rate_limited;
+}
+
+static __inline bool should_send_data(uint32_t tgid, enum traffic_direction_t direction,
+                                      uint64_t conn_disabled_tsid, bool force_trace_tgid,
+                                      struct conn_info_t* conn_info) {
   // Never trace stirling.
   if (is_stirling_tgid(tgid)) {
     return false;
@@ -706,7 +872,16 @@ static __inline bool should_send_data(uint32_t tgid, uint64_t conn_disabled_tsid
   }
 
   // Only trace data for protocols of interest, or if forced on.
-  return (force_trace_tgid || should_trace_protocol_data(conn_info));
+  if (force_trace_tgid) {
+    return true;
+  }
+  if (!should_trace_protocol_data(conn_info)) {
+    return false;
+  }
+
+  // Sampling and rate limits only apply to data events; conn stats are reported for every
+  // connection. Unsampled connections don't take tokens from the rate limit.
+  return conn_info->sampled && pass_rate_limit(tgid, direction, conn_info);
 }
 
 static __inline void update_conn_stats(struct pt_regs* ctx, struct conn_info_t* conn_info,
@@ -801,7 +976,7 @@ static __inline void process_data(const bool vecs, struct pt_regs* ctx, uint64_t
       }
     }
 
-    if (should_send_data(tgid, conn_disabled_tsid, force_trace_tgid, conn_info)) {
+    if (should_send_data(tgid, direction, conn_disabled_tsid, force_trace_tgid, conn_info)) {
       struct socket_data_event_t* event =
           fill_socket_data_event(args->source_fn, direction, conn_info);
       if (event == NULL) {
@@ -809,14 +984,29 @@ static __inline void process_data(const bool vecs, struct pt_regs* ctx, uint64_t
         return;
       }
 
+      const uint64_t start_pos = event->attr.pos;
+      const size_t bytes_captured = captured_bytes(conn_info, bytes_count);
+
       // TODO(yzhao): Same TODO for split the interface.
       if (!vecs) {
-        perf_submit_wrapper(ctx, direction, args->buf, bytes_count, conn_info, event);
+        perf_submit_wrapper(ctx, direction, args->buf, bytes_captured, conn_info, event);
       } else {
         // TODO(yzhao): iov[0] is copied twice, once in calling update_traffic_class(), and here.
         // This happens to the write probes as well, but the calls are placed in the entry and
         // return probes respectively. Consider remove one copy.
-        perf_submit_iovecs(ctx, direction, args->iov, args->iovlen, bytes_count, conn_info, event);
+        perf_submit_iovecs(ctx, direction, args->iov, args->iovlen, bytes_captured, conn_info,
+                           event);
+      }
+
+      // Report the bytes beyond the capture limit without their data, like sendfile() does, but
+      // marked as truncated, so that user-space knows which protocols can skip over them.
+      if (bytes_captured < bytes_count) {
+        event->attr.pos = start_pos + bytes_captured;
+        event->attr.msg_size = bytes_count - bytes_captured;
+        event->attr.msg_buf_size = 0;
+        event->attr.truncated = true;
+        event->attr.prepend_length_header = false;
+        submit_data_event(ctx, event, sizeof(event->attr));
       }
     }
   }
@@ -888,7 +1078,7 @@ static __inline void process_syscall_sendfile(struct pt_regs* ctx, uint64_t id,
   uint64_t* conn_disabled_tsid_ptr = conn_disabled_map.lookup(&tgid_fd);
   uint64_t conn_disabled_tsid = (conn_disabled_tsid_ptr == NULL) ? 0 : *conn_disabled_tsid_ptr;
 
-  if (should_send_data(tgid, conn_disabled_tsid, force_trace_tgid, conn_info)) {
+  if (should_send_data(tgid, kEgress, conn_disabled_tsid, force_trace_tgid, conn_info)) {
     struct socket_data_event_t* event =
         fill_socket_data_event(kSyscallSendfile, kEgress, conn_info);
     if (event == NULL) {
@@ -899,7 +1089,7 @@ static __inline void process_syscall_sendfile(struct pt_regs* ctx, uint64_t id,
     event->attr.pos = conn_info->wr_bytes;
     event->attr.msg_size = bytes_count;
     event->attr.msg_buf_size = 0;
-    socket_data_events.perf_submit(ctx, event, sizeof(event->attr));
+    submit_data_event(ctx, event, sizeof(event->attr));
   }
 
   update_conn_stats(ctx, conn_info, kEgress, bytes_count);
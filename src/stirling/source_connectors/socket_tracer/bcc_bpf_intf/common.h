@@ -89,9 +89,18 @@ enum control_value_index_t {
   // * Support efficient lookup inside bpf to minimize overhead.
   kTargetTGIDIndex = 0,
   kStirlingTGIDIndex,
+  // The number of connections, out of kConnSamplingScale, whose data is sent to user-space.
+  // Connections are picked by a hash of their conn_id, when they are first seen.
+  // 0 disables sampling.
+  kConnSamplingRatioIndex,
+  // The maximum number of messages per second that each process can send to user-space, where a
+  // message is the run of data events in one direction of a connection. 0 disables rate limiting.
+  kUPIDRateLimitIndex,
   kNumControlValues,
 };
 
+const int64_t kConnSamplingScale = 10000;
+
 // Indicates the source of the TLS library under trace if TLS is in use.
 enum ssl_source_t {
   kSSLNone = 0,
@@ -27,6 +27,7 @@
 #define PX_AF_UNKNOWN 0xff
 
 const char kControlMapName[] = "control_map";
+const char kCaptureLimitMapName[] = "capture_limit_map";
 const char kControlValuesArrayName[] = "control_values";
 
 const int64_t kTraceAllTGIDs = -1;
@@ -89,6 +90,18 @@ struct conn_info_t {
   size_t prev_count;
   char prev_buf[4];
   bool prepend_length_header;
+
+  // Whether the data of this connection is sent to user-space, and the connection sampling ratio
+  // (out of kConnSamplingScale) when that was decided. Both are set when the conn_info is created.
+  bool sampled;
+  uint32_t sampling_ratio;
+
+  // The direction of the message that the last data event belonged to, and whether the exchange
+  // that message belongs to was dropped by the rate limit of the process. A change of direction
+  // starts a new message, and a change to the request direction starts a new exchange.
+  bool has_msg_direction;
+  enum traffic_direction_t msg_direction;
+  bool msg_rate_limited;
 };
 
 // This struct is a subset of conn_info_t. It is used to communicate connect/accept events.
@@ -207,6 +220,14 @@ struct socket_data_event_t {
     // (e.g. if the connection data tracking has been disabled).
     uint32_t msg_buf_size;
 
+    // The connection sampling ratio (out of kConnSamplingScale) under which the connection was
+    // sampled. See conn_info_t::sampling_ratio.
+    uint32_t conn_sampling_ratio;
+
+    // Whether the bytes beyond msg_buf_size were left out because of the capture limit of the
+    // protocol (see capture_limit_map), rather than because they couldn't be traced.
+    bool truncated;
+
     // Whether to prepend length header to the buffer for messages first inferred as Kafka. MySQL
     // may also use this in this future.
     // See infer_kafka_message in protocol_inference.h for details.
@@ -305,6 +326,25 @@ struct sendfile_args_t {
   size_t count;
 };
 
+// A token bucket that limits the rate of request/response exchanges of a process. Each exchange
+// takes one token.
+struct rate_limit_bucket_t {
+  uint64_t last_refill_ns;
+  uint64_t tokens;
+
+  // The number of exchanges that were let through and dropped by the rate limit.
+  // Used by user-space to compute the fraction of the exchanges that were kept.
+  uint64_t num_passed;
+  uint64_t num_dropped;
+};
+
+// Channels that can be sent through BPF ring buffers, used to index the counts of dropped events.
+enum ringbuf_channel_t {
+  kSocketDataEventsRingBuf,
+  kSocketControlEventsRingBuf,
+  kNumRingBufChannels,
+};
+
 static const uint32_t kOpenSSLTraceStatusIdx = 0;
 
 enum openssl_trace_errors_t {
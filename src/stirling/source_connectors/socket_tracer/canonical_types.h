@@ -86,6 +86,16 @@ constexpr DataElement kEncrypted = {
     types::PatternType::GENERAL_ENUM,
 };
 
+constexpr DataElement kSamplingRatio = {
+    "sampling_ratio",
+    "Estimated fraction of the process's messages that were traced: the sampling ratio of the "
+    "connection times the fraction of the process's messages that passed its rate limit. "
+    "Divide counts by it to estimate the totals",
+    types::DataType::FLOAT64,
+    types::SemanticType::ST_NONE,
+    types::PatternType::GENERAL,
+};
+
 constexpr DataElement kPXInfo = {
     "px_info_",
     "Pixie messages regarding the record (e.g. warnings)",
@@ -152,6 +152,12 @@ void ConnTracker::AddDataEvent(std::unique_ptr<SocketDataEvent> event) {
 
   CONN_TRACE(1) << absl::Substitute("Data event: $0", event->ToString());
 
+  // Events that don't come from BPF (e.g. in tests) may not carry the ratio.
+  if (event->attr.conn_sampling_ratio != 0) {
+    conn_sampling_ratio_ =
+        static_cast<double>(event->attr.conn_sampling_ratio) / kConnSamplingScale;
+  }
+
   // TODO(yzhao): Change to let userspace resolve the connection type and signal back to BPF.
   // Then we need at least one data event to let ConnTracker know the field descriptor.
   if (event->attr.protocol == kProtocolUnknown) {
@@ -837,6 +843,11 @@ void ConnTracker::IterationPostTick() {
       send_data().stat_raw_data_gaps(), recv_data().stat_invalid_frames(),
       recv_data().stat_valid_frames(), recv_data().stat_raw_data_gaps());
 
+  // The gaps left by the exchanges that the rate limit dropped aren't the protocol's fault.
+  if (rate_limited()) {
+    return;
+  }
+
   if ((send_data().ParseFailureRate() > kParseFailureRateThreshold) ||
       (recv_data().ParseFailureRate() > kParseFailureRateThreshold)) {
     Disable(absl::Substitute("Connection does not appear parseable as protocol $0",
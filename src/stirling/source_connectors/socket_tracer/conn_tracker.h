@@ -609,6 +609,23 @@ class ConnTracker : NotCopyMoveable {
   void set_is_tracked_upid() { is_tracked_upid_ = true; }
   bool is_tracked_upid() const { return is_tracked_upid_; }
 
+  // The fraction of the exchanges of the process that passed its rate limit in BPF.
+  void set_rate_limit_keep_fraction(double fraction) {
+    rate_limit_keep_fraction_ = fraction;
+    rate_limited_ |= fraction < 1.0;
+  }
+
+  // Whether BPF has dropped exchanges of the process under its rate limit since this tracker was
+  // created. Dropped exchanges look like parse and stitch failures, so such trackers are not
+  // disabled for those.
+  bool rate_limited() const { return rate_limited_; }
+
+  // The estimated fraction of exchanges like the ones of this connection that BPF sends to
+  // user-space: the ratio under which the connection was sampled, times the fraction of the
+  // process's exchanges that passed its rate limit. Reported with the records, so that counts can
+  // be scaled back up.
+  double sampling_ratio() const { return conn_sampling_ratio_ * rate_limit_keep_fraction_; }
+
   template <typename TProtocolTraits>
   size_t MemUsage() const {
     using TFrameType = typename TProtocolTraits::frame_type;
@@ -702,6 +719,11 @@ class ConnTracker : NotCopyMoveable {
   // Used to disable ConnTrackers that are not part of the context.
   bool is_tracked_upid_ = false;
 
+  // The connection sampling ratio that BPF reports with the data events of the connection.
+  double conn_sampling_ratio_ = 1.0;
+  double rate_limit_keep_fraction_ = 1.0;
+  bool rate_limited_ = false;
+
   traffic_protocol_t protocol_ = kProtocolUnknown;
   endpoint_role_t role_ = kRoleUnknown;
   bool ssl_ = false;
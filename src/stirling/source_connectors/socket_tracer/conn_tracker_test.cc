@@ -762,6 +762,37 @@ TEST_F(ConnTrackerTest, DisabledDueToStitchingFailureRate) {
   EXPECT_EQ(records.size(), 0);
 }
 
+// Tests that a connection whose process is rate limited in BPF is not disabled for the stitch
+// failures that the dropped exchanges cause, and that it reports the combined sampling ratio.
+TEST_F(ConnTrackerTest, NotDisabledWhenRateLimited) {
+  using mysql::testutils::GenRawPacket;
+
+  ConnTracker tracker;
+  tracker.set_rate_limit_keep_fraction(0.5);
+
+  for (char c = 'A'; c <= 'G'; ++c) {
+    auto req_frame =
+        event_gen_.InitSendEvent<kProtocolMySQL>(GenRawPacket(0, std::string("\x03 ") + c));
+    req_frame->attr.conn_sampling_ratio = kConnSamplingScale / 2;
+    auto resp_frame = event_gen_.InitRecvEvent<kProtocolMySQL>(GenRawPacket(1, ""));
+    resp_frame->attr.conn_sampling_ratio = kConnSamplingScale / 2;
+    tracker.AddDataEvent(std::move(req_frame));
+    tracker.AddDataEvent(std::move(resp_frame));
+  }
+  std::vector<mysql::Record> records = tracker.ProcessToRecords<mysql::ProtocolTraits>();
+  // No drops in the last period doesn't lift the exemption, the failures are still counted.
+  tracker.set_rate_limit_keep_fraction(1.0);
+  tracker.IterationPostTick();
+
+  EXPECT_GT(tracker.StitchFailureRate(), 0.5);
+  EXPECT_EQ(tracker.state(), ConnTracker::State::kCollecting);
+  EXPECT_TRUE(tracker.rate_limited());
+  EXPECT_DOUBLE_EQ(tracker.sampling_ratio(), 0.5);
+
+  tracker.set_rate_limit_keep_fraction(0.5);
+  EXPECT_DOUBLE_EQ(tracker.sampling_ratio(), 0.25);
+}
+
 TEST_F(ConnTrackerTest, ConnStats) {
   ConnTracker tracker;
 
@@ -17,6 +17,11 @@
  */
 
 #include "src/stirling/source_connectors/socket_tracer/conn_trackers_manager.h"
+
+#include <algorithm>
+
+#include <absl/hash/hash.h>
+
 #include "src/common/metrics/metrics.h"
 
 DEFINE_double(
@@ -110,8 +115,9 @@ uint64_t GetConnMapKey(uint32_t pid, int32_t fd) { return (static_cast<uint64_t>
 
 }  // namespace
 
-ConnTrackersManager::ConnTrackersManager()
-    : trackers_pool_(kMaxConnTrackerPoolSize),
+ConnTrackersManager::ConnTrackersManager(size_t num_shards)
+    : shard_active_trackers_(std::max<size_t>(num_shards, 1)),
+      trackers_pool_(kMaxConnTrackerPoolSize),
       conn_tracker_created_(BuildCounter("conn_tracker_created",
                                          "Counter that tracks when a conn tracker is created")),
       conn_tracker_destroyed_(BuildCounter("conn_tracker_destroyed",
@@ -128,6 +134,8 @@ ConnTracker& ConnTrackersManager::GetOrCreateConnTracker(struct conn_id_t conn_i
 
   if (created) {
     active_trackers_.push_back(conn_tracker_ptr);
+    shard_active_trackers_[absl::Hash<uint64_t>{}(conn_map_key) % num_shards()].push_back(
+        conn_tracker_ptr);
     conn_tracker_ptr->manager_ = this;
 
     stats_.Increment(StatKey::kTotal);
@@ -172,6 +180,9 @@ void ConnTrackersManager::CleanupTrackers() {
         ++iter;
       }
     }
+    for (auto& shard : shard_active_trackers_) {
+      shard.remove_if([](const ConnTracker* tracker) { return tracker->ReadyForDestruction(); });
+    }
   }
 
   // As a performance optimization, we only clean up trackers once we reach a certain threshold
@@ -211,6 +222,13 @@ void ConnTrackersManager::CleanupTrackers() {
 void ConnTrackersManager::DebugChecks() const {
   DCHECK_EQ(stats_.Get(StatKey::kTotal), static_cast<int64_t>(active_trackers_.size()) +
                                              stats_.Get(StatKey::kReadyForDestruction));
+#ifndef NDEBUG
+  size_t num_shard_trackers = 0;
+  for (const auto& shard : shard_active_trackers_) {
+    num_shard_trackers += shard.size();
+  }
+  DCHECK_EQ(num_shard_trackers, active_trackers_.size());
+#endif
 }
 
 std::string ConnTrackersManager::DebugInfo() const {
@@ -88,6 +88,9 @@ class ConnTrackerGenerations {
  * Interface designed for two primary operations:
  *  1) Insertion of events indexed by conn_id (PID+FD+TSID) as they arrive from BPF.
  *  2) Iteration through trackers by protocols.
+ *
+ * The active trackers are also split into shards by PID+FD, so that each shard can be processed
+ * on its own thread. All generations of a PID+FD belong to the same shard.
  */
 class ConnTrackersManager {
  public:
@@ -100,7 +103,7 @@ class ConnTrackersManager {
     kDestroyedGens,
   };
 
-  ConnTrackersManager();
+  explicit ConnTrackersManager(size_t num_shards = 1);
 
   /**
    * Get a connection tracker for the specified conn_id. If a tracker does not exist,
@@ -110,6 +113,15 @@ class ConnTrackersManager {
 
   const std::list<ConnTracker*>& active_trackers() const { return active_trackers_; }
 
+  size_t num_shards() const { return shard_active_trackers_.size(); }
+
+  /**
+   * Returns the active trackers that belong to the given shard.
+   */
+  const std::list<ConnTracker*>& active_trackers(size_t shard) const {
+    return shard_active_trackers_[shard];
+  }
+
   /**
    * Returns the latest generation of a connection tracker for the given pid and fd.
    * If there is no tracker for {pid, fd}, returns error::NotFound.
@@ -149,6 +161,9 @@ class ConnTrackersManager {
 
   std::list<ConnTracker*> active_trackers_;
 
+  // The same trackers as active_trackers_, split into shards by PID+FD.
+  std::vector<std::list<ConnTracker*>> shard_active_trackers_;
+
   // A pool of unused trackers that can be recycled.
   // This is useful for avoiding memory reallocations.
   ConnTrackerPool trackers_pool_;
@@ -18,6 +18,8 @@
 
 #include <random>
 
+#include <absl/container/flat_hash_map.h>
+
 #include "src/common/testing/testing.h"
 #include "src/stirling/source_connectors/socket_tracer/conn_trackers_manager.h"
 
@@ -112,6 +114,35 @@ TEST_F(ConnTrackersManagerTest, DebugInfo) {
   EXPECT_THAT(debug_info, HasSubstr("conn_tracker=conn_id=[upid=1:1 fd=1 gen=1]"));
 }
 
+// Tests that the trackers are split into shards by PID+FD.
+TEST(ConnTrackersManagerShardTest, TrackersAreSharded) {
+  constexpr size_t kNumShards = 4;
+  ConnTrackersManager trackers_mgr(kNumShards);
+  ASSERT_EQ(trackers_mgr.num_shards(), kNumShards);
+
+  for (uint32_t pid = 1; pid <= 100; ++pid) {
+    for (uint64_t tsid = 1; tsid <= 2; ++tsid) {
+      struct conn_id_t conn_id = {{{pid}, 1}, /*fd*/ 1, tsid};
+      trackers_mgr.GetOrCreateConnTracker(conn_id);
+    }
+  }
+
+  absl::flat_hash_map<uint32_t, size_t> pid_shards;
+  size_t num_shard_trackers = 0;
+  for (size_t shard = 0; shard < kNumShards; ++shard) {
+    // With 100 PIDs, every shard is expected to get some trackers.
+    EXPECT_FALSE(trackers_mgr.active_trackers(shard).empty());
+    for (const ConnTracker* tracker : trackers_mgr.active_trackers(shard)) {
+      // All generations of a PID+FD must be in the same shard.
+      auto [iter, inserted] = pid_shards.try_emplace(tracker->conn_id().upid.pid, shard);
+      EXPECT_EQ(iter->second, shard);
+      ++num_shard_trackers;
+    }
+  }
+  EXPECT_EQ(num_shard_trackers, trackers_mgr.active_trackers().size());
+  EXPECT_EQ(pid_shards.size(), 100);
+}
+
 class ConnTrackerGenerationsTest : public ::testing::Test {
  protected:
   ConnTrackerGenerationsTest() : tracker_pool(1024) {
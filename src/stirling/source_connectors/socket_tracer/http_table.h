@@ -101,6 +101,7 @@ constexpr DataElement kHTTPElements[] = {
          types::SemanticType::ST_BYTES,
          types::PatternType::METRIC_GAUGE},
         canonical_data_elements::kLatencyNS,
+        canonical_data_elements::kSamplingRatio,
 #ifndef NDEBUG
         canonical_data_elements::kPXInfo,
 #endif
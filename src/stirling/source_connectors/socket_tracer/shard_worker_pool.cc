@@ -0,0 +1,90 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/shard_worker_pool.h"
+
+namespace px {
+namespace stirling {
+
+ShardWorkerPool::ShardWorkerPool(size_t num_threads) {
+  for (size_t i = 0; i < num_threads; ++i) {
+    workers_.emplace_back(&ShardWorkerPool::WorkerLoop, this);
+  }
+}
+
+ShardWorkerPool::~ShardWorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    stop_ = true;
+  }
+  task_cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+void ShardWorkerPool::Run(size_t num_tasks, const std::function<void(size_t)>& fn) {
+  if (num_tasks == 0) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    fn_ = &fn;
+    next_task_ = 1;
+    num_tasks_ = num_tasks;
+  }
+  task_cv_.notify_all();
+
+  fn(0);
+
+  std::unique_lock<std::mutex> lock(mu_);
+  RunTasks(&lock);
+  done_cv_.wait(lock, [this] { return num_running_ == 0; });
+  fn_ = nullptr;
+  next_task_ = 0;
+  num_tasks_ = 0;
+}
+
+void ShardWorkerPool::RunTasks(std::unique_lock<std::mutex>* lock) {
+  while (next_task_ < num_tasks_) {
+    size_t task = next_task_++;
+    ++num_running_;
+    lock->unlock();
+
+    (*fn_)(task);
+
+    lock->lock();
+    --num_running_;
+  }
+}
+
+void ShardWorkerPool::WorkerLoop() {
+  std::unique_lock<std::mutex> lock(mu_);
+  while (true) {
+    task_cv_.wait(lock, [this] { return stop_ || next_task_ < num_tasks_; });
+    if (stop_) {
+      return;
+    }
+    RunTasks(&lock);
+    done_cv_.notify_all();
+  }
+}
+
+}  // namespace stirling
+}  // namespace px
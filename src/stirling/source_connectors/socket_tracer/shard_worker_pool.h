@@ -0,0 +1,71 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace stirling {
+
+/**
+ * ShardWorkerPool runs the shards of the SocketTraceConnector's trackers in parallel, on threads
+ * that live as long as the pool, so that no threads are started and joined on every transfer.
+ */
+class ShardWorkerPool : public NotCopyable {
+ public:
+  explicit ShardWorkerPool(size_t num_threads);
+  ~ShardWorkerPool();
+
+  size_t num_threads() const { return workers_.size(); }
+
+  /**
+   * Calls fn(i) for every i in [0, num_tasks), and blocks until all calls have returned.
+   * The calling thread runs task 0, and helps with the rest once it's done.
+   * Must not be called concurrently.
+   */
+  void Run(size_t num_tasks, const std::function<void(size_t)>& fn);
+
+ private:
+  void WorkerLoop();
+
+  // Runs the queued tasks of the current Run() until none are left. Expects lock to be held.
+  void RunTasks(std::unique_lock<std::mutex>* lock);
+
+  std::mutex mu_;
+  std::condition_variable task_cv_;
+  std::condition_variable done_cv_;
+
+  // The function of the current Run(), and its next task to hand out.
+  const std::function<void(size_t)>* fn_ = nullptr;
+  size_t next_task_ = 0;
+  size_t num_tasks_ = 0;
+  size_t num_running_ = 0;
+  bool stop_ = false;
+
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace stirling
+}  // namespace px
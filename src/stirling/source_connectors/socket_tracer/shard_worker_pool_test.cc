@@ -0,0 +1,88 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/shard_worker_pool.h"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <absl/container/flat_hash_set.h>
+#include <gtest/gtest.h>
+
+namespace px {
+namespace stirling {
+
+TEST(ShardWorkerPoolTest, RunsEveryTaskOnce) {
+  ShardWorkerPool pool(3);
+  EXPECT_EQ(pool.num_threads(), 3);
+
+  for (size_t num_tasks : {0, 1, 4, 16}) {
+    std::vector<std::atomic<int>> num_runs(num_tasks);
+    pool.Run(num_tasks, [&](size_t task) { ++num_runs[task]; });
+    for (size_t i = 0; i < num_tasks; ++i) {
+      EXPECT_EQ(num_runs[i], 1) << "task " << i;
+    }
+  }
+}
+
+TEST(ShardWorkerPoolTest, RunsTasksInParallel) {
+  constexpr size_t kNumTasks = 4;
+  ShardWorkerPool pool(kNumTasks - 1);
+
+  // Every task waits for all others to start, so this only returns if they run concurrently.
+  std::atomic<size_t> num_started = 0;
+  std::mutex mu;
+  absl::flat_hash_set<std::thread::id> thread_ids;
+  pool.Run(kNumTasks, [&](size_t) {
+    ++num_started;
+    while (num_started < kNumTasks) {
+      std::this_thread::yield();
+    }
+    std::lock_guard<std::mutex> lock(mu);
+    thread_ids.insert(std::this_thread::get_id());
+  });
+  EXPECT_EQ(thread_ids.size(), kNumTasks);
+  EXPECT_TRUE(thread_ids.contains(std::this_thread::get_id()));
+}
+
+TEST(ShardWorkerPoolTest, ReusesThreads) {
+  ShardWorkerPool pool(2);
+
+  std::mutex mu;
+  absl::flat_hash_set<std::thread::id> thread_ids;
+  for (int i = 0; i < 100; ++i) {
+    pool.Run(3, [&](size_t) {
+      std::lock_guard<std::mutex> lock(mu);
+      thread_ids.insert(std::this_thread::get_id());
+    });
+  }
+  // The calling thread and the pool's two threads.
+  EXPECT_LE(thread_ids.size(), 3);
+}
+
+TEST(ShardWorkerPoolTest, NoThreads) {
+  ShardWorkerPool pool(0);
+  std::vector<size_t> tasks;
+  pool.Run(3, [&](size_t task) { tasks.push_back(task); });
+  EXPECT_EQ(tasks, (std::vector<size_t>{0, 1, 2}));
+}
+
+}  // namespace stirling
+}  // namespace px
@@ -90,6 +90,7 @@ void ConnInfoMapManager::ReleaseResources(struct conn_id_t conn_id) {
 void ConnInfoMapManager::Disable(struct conn_id_t conn_id) {
   uint64_t key = id(conn_id);
 
+  std::lock_guard<std::mutex> lock(conn_disabled_map_mutex_);
   if (!conn_disabled_map_->SetValue(key, conn_id.tsid).ok()) {
     VLOG(1) << absl::Substitute("$0 Updating conn_disable_map entry failed.", ToString(conn_id));
   }
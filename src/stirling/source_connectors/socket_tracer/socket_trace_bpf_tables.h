@@ -19,6 +19,7 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -49,6 +50,9 @@ class ConnInfoMapManager {
   std::unique_ptr<WrappedBCCMap<uint64_t, struct conn_info_t>> conn_info_map_;
   std::unique_ptr<WrappedBCCMap<uint64_t, uint64_t>> conn_disabled_map_;
 
+  // Trackers of different shards can be disabled concurrently.
+  std::mutex conn_disabled_map_mutex_;
+
   std::vector<struct conn_id_t> pending_release_queue_;
 
   // TODO(oazizi): Can we share this with the similar function in socket_trace.c?
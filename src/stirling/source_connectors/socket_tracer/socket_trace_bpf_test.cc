@@ -536,6 +536,39 @@ TEST_F(SocketTraceBPFTest, LargeMessages) {
   EXPECT_EQ(server_send_data.substr(server_send_data.size() - 5, 5), ConstStringView("\0\0\0\0\0"));
 }
 
+TEST_F(SocketTraceBPFTest, CaptureLimit) {
+  ConfigureBPFCapture(traffic_protocol_t::kProtocolHTTP, kRoleClient | kRoleServer);
+  constexpr uint32_t kCaptureLimit = 100;
+  ASSERT_OK(source_->UpdateBPFProtocolCaptureLimit(kProtocolHTTP, kCaptureLimit));
+
+  std::string large_response =
+      "HTTP/1.1 200 OK\r\n"
+      "Content-Type: application/json; msg2\r\n"
+      "Content-Length: 131072\r\n"
+      "\r\n";
+  large_response += std::string(131072, '+');
+
+  testing::SendRecvScript script({
+      {{kHTTPReqMsg1}, {large_response}},
+  });
+
+  testing::ClientServerSystem system;
+  system.RunClientServer<&TCPSocket::Recv, &TCPSocket::Send>(script);
+
+  source_->BCC().PollPerfBuffers();
+
+  // Only the first kCaptureLimit bytes of the response are sent from BPF. For HTTP, the rest are
+  // filled in with zeros, so the data stays contiguous.
+  ASSERT_OK_AND_ASSIGN(auto* server_tracker,
+                       GetMutableConnTracker(system.ServerPID(), system.ServerFD()));
+  EXPECT_EQ(server_tracker->recv_data().data_buffer().Head(), kHTTPReqMsg1);
+  std::string server_send_data(server_tracker->send_data().data_buffer().Head());
+  ASSERT_EQ(server_send_data.size(), large_response.size());
+  EXPECT_EQ(server_send_data.substr(0, kCaptureLimit), large_response.substr(0, kCaptureLimit));
+  EXPECT_EQ(server_send_data.substr(kCaptureLimit),
+            std::string(large_response.size() - kCaptureLimit, '\0'));
+}
+
 constexpr std::string_view kHTTPRespMsgHeader =
     "HTTP/1.1 200 OK\r\n"
     "Content-Type: application/json; msg1\r\n"
@@ -544,6 +577,65 @@ constexpr std::string_view kHTTPRespMsgHeader =
 
 constexpr std::string_view kHTTPRespMsgContent = "Pixie labs is awesome!";
 
+// Tests that the rate limit is applied to whole exchanges: the response, which is sent with two
+// writes, passes or is dropped as a whole, together with its request.
+TEST_F(SocketTraceBPFTest, UPIDRateLimit) {
+  ConfigureBPFCapture(traffic_protocol_t::kProtocolHTTP, kRoleClient | kRoleServer);
+  ASSERT_OK(source_->UpdateBPFUPIDRateLimit(1));
+
+  testing::SendRecvScript script({
+      {{kHTTPReqMsg1}, {kHTTPRespMsgHeader, kHTTPRespMsgContent}},
+      {{kHTTPReqMsg2}, {kHTTPRespMsg2}},
+  });
+
+  testing::ClientServerSystem system;
+  system.RunClientServer<&TCPSocket::Recv, &TCPSocket::Send>(script);
+
+  source_->BCC().PollPerfBuffers();
+
+  // The server takes the only token of its process with the first request, which its response
+  // follows; both messages of the second exchange are dropped.
+  ASSERT_OK_AND_ASSIGN(auto* server_tracker,
+                       GetMutableConnTracker(system.ServerPID(), system.ServerFD()));
+  EXPECT_EQ(server_tracker->recv_data().data_buffer().Head(), kHTTPReqMsg1);
+  EXPECT_EQ(server_tracker->send_data().data_buffer().Head(),
+            absl::StrCat(kHTTPRespMsgHeader, kHTTPRespMsgContent));
+}
+
+// Tests that connections are either fully traced or not traced at all when sampling.
+TEST_F(SocketTraceBPFTest, ConnSampling) {
+  ConfigureBPFCapture(traffic_protocol_t::kProtocolHTTP, kRoleClient | kRoleServer);
+
+  testing::SendRecvScript script({
+      {{kHTTPReqMsg1}, {kHTTPRespMsg1}},
+  });
+
+  // The lowest ratio above 0, which no connection of the test is expected to be picked by.
+  ASSERT_OK(source_->UpdateBPFConnSamplingRatio(1.0 / kConnSamplingScale));
+  {
+    testing::ClientServerSystem system;
+    system.RunClientServer<&TCPSocket::Recv, &TCPSocket::Send>(script);
+    source_->BCC().PollPerfBuffers();
+
+    ASSERT_OK_AND_ASSIGN(auto* server_tracker,
+                         GetMutableConnTracker(system.ServerPID(), system.ServerFD()));
+    EXPECT_TRUE(server_tracker->recv_data().data_buffer().empty());
+    EXPECT_TRUE(server_tracker->send_data().data_buffer().empty());
+  }
+
+  ASSERT_OK(source_->UpdateBPFConnSamplingRatio(1.0));
+  {
+    testing::ClientServerSystem system;
+    system.RunClientServer<&TCPSocket::Recv, &TCPSocket::Send>(script);
+    source_->BCC().PollPerfBuffers();
+
+    ASSERT_OK_AND_ASSIGN(auto* server_tracker,
+                         GetMutableConnTracker(system.ServerPID(), system.ServerFD()));
+    EXPECT_EQ(server_tracker->recv_data().data_buffer().Head(), kHTTPReqMsg1);
+    EXPECT_EQ(server_tracker->send_data().data_buffer().Head(), kHTTPRespMsg1);
+  }
+}
+
 TEST_F(SocketTraceBPFTest, SendFile) {
   // FLAGS_stirling_conn_trace_pid = getpid();
 
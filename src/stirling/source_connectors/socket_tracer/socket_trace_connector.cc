@@ -23,11 +23,21 @@
 #include <unistd.h>
 
 #include <algorithm>
+#include <cmath>
 #include <filesystem>
+#include <map>
+#include <optional>
+#include <thread>
+#include <tuple>
 #include <utility>
+#include <vector>
 
 #include <absl/container/flat_hash_map.h>
+#include <absl/strings/ascii.h>
 #include <absl/strings/match.h>
+#include <absl/strings/numbers.h>
+#include <absl/strings/str_split.h>
+#include <absl/strings/strip.h>
 #include <google/protobuf/text_format.h>
 #include <google/protobuf/util/delimited_message_util.h>
 #include <magic_enum.hpp>
@@ -151,6 +161,42 @@ DEFINE_double(stirling_socket_tracer_max_total_bw_overprovision_factor, 1,
               "Factor to overprovision maximum total bandwidth, to account for the fact that "
               "traffic won't be exactly evenly distributed over all cpus.");
 
+DEFINE_bool(stirling_socket_tracer_use_ringbuf,
+            gflags::BoolFromEnv("PX_STIRLING_SOCKET_TRACER_USE_RINGBUF", true),
+            "If true, data and control events are sent through BPF ring buffers, which are shared "
+            "by all CPUs, instead of per-CPU perf buffers. Only applies to kernels 5.8+.");
+
+DEFINE_uint32(stirling_socket_tracer_num_shards,
+              gflags::Uint32FromEnv("PX_STIRLING_SOCKET_TRACER_NUM_SHARDS", 1),
+              "Number of shards that the connection trackers are split into. The shards are parsed "
+              "and stitched in parallel, each on its own thread.");
+
+DEFINE_string(stirling_socket_tracer_capture_limits,
+              gflags::StringFromEnv("PX_STIRLING_SOCKET_TRACER_CAPTURE_LIMITS", ""),
+              "Comma-separated list of protocol:bytes pairs (e.g. \"http:65536,kafka:16384\"), "
+              "that limit how many bytes of each read/write of the protocol are sent from BPF. "
+              "For HTTP, the rest of the bytes are filled in with zeros, so that messages with a "
+              "Content-Length keep their headers. For other protocols, the rest of the bytes are "
+              "skipped like lost data, so frames that span the limit are dropped. "
+              "The limits can be changed at runtime with stirling_ctrl (opcode 3).");
+
+DEFINE_double(stirling_socket_tracer_conn_sampling_ratio,
+              gflags::DoubleFromEnv("PX_STIRLING_SOCKET_TRACER_CONN_SAMPLING_RATIO", 1.0),
+              "Fraction of connections, picked by a hash of their conn_id, whose data is traced. "
+              "Connection stats are always collected for all connections.");
+DEFINE_bool(stirling_socket_tracer_adaptive_sampling,
+            gflags::BoolFromEnv("PX_STIRLING_SOCKET_TRACER_ADAPTIVE_SAMPLING", false),
+            "If true, the connection sampling ratio is halved whenever events are lost, and grows "
+            "back up to --stirling_socket_tracer_conn_sampling_ratio while there are no losses.");
+DEFINE_double(stirling_socket_tracer_min_conn_sampling_ratio,
+              gflags::DoubleFromEnv("PX_STIRLING_SOCKET_TRACER_MIN_CONN_SAMPLING_RATIO", 0.01),
+              "The lowest connection sampling ratio that adaptive sampling goes down to.");
+DEFINE_uint32(stirling_socket_tracer_upid_rate_limit,
+              gflags::Uint32FromEnv("PX_STIRLING_SOCKET_TRACER_UPID_RATE_LIMIT", 0),
+              "Maximum number of request/response exchanges per second that are traced for each "
+              "process. An exchange is a request and its response on one connection. "
+              "0 means no limit.");
+
 DEFINE_uint32(messages_expiry_duration_secs, 1 * 60,
               "The duration after which a parsed message is erased.");
 DEFINE_uint32(messages_size_limit_bytes, 1024 * 1024,
@@ -212,6 +258,8 @@ constexpr char openssl_tls_source_help[] =
 
 SocketTraceConnector::SocketTraceConnector(std::string_view source_name)
     : BCCSourceConnector(source_name, kTables),
+      conn_trackers_mgr_(FLAGS_stirling_socket_tracer_num_shards),
+      shard_workers_(conn_trackers_mgr_.num_shards() - 1),
       conn_stats_(&conn_trackers_mgr_),
       openssl_trace_mismatched_fds_counter_family_(
           BuildCounterFamily(openssl_mismatched_fds_metric, openssl_mismatched_fds_help)),
@@ -220,6 +268,9 @@ SocketTraceConnector::SocketTraceConnector(std::string_view source_name)
       uprobe_mgr_(&this->BCC()) {
   proc_parser_ = std::make_unique<system::ProcParser>();
   InitProtocolTransferSpecs();
+  for (auto& limit_bytes : capture_limits_to_update_) {
+    limit_bytes = -1;
+  }
 }
 
 void SocketTraceConnector::InitProtocolTransferSpecs() {
@@ -445,6 +496,47 @@ auto SocketTraceConnector::InitPerfBufferSpecs() {
   return specs;
 }
 
+StatusOr<absl::flat_hash_map<traffic_protocol_t, uint32_t>> ParseCaptureLimits(
+    std::string_view capture_limits) {
+  absl::flat_hash_map<traffic_protocol_t, uint32_t> limits;
+  for (std::string_view entry : absl::StrSplit(capture_limits, ',', absl::SkipWhitespace())) {
+    std::vector<std::string_view> parts = absl::StrSplit(entry, ':');
+    uint32_t limit_bytes = 0;
+    if (parts.size() != 2 || !absl::SimpleAtoi(parts[1], &limit_bytes)) {
+      return error::InvalidArgument("Invalid capture limit '$0', expected <protocol>:<bytes>.",
+                                    entry);
+    }
+    std::string_view name = absl::StripAsciiWhitespace(parts[0]);
+    bool found = false;
+    for (auto protocol : magic_enum::enum_values<traffic_protocol_t>()) {
+      std::string_view protocol_name = magic_enum::enum_name(protocol);
+      absl::ConsumePrefix(&protocol_name, "kProtocol");
+      if (absl::EqualsIgnoreCase(protocol_name, name)) {
+        limits[protocol] = limit_bytes;
+        found = true;
+        break;
+      }
+    }
+    if (!found) {
+      return error::InvalidArgument("Unknown protocol '$0' in capture limits.", name);
+    }
+  }
+  return limits;
+}
+
+namespace {
+// Returns the ring buffer channel that replaces the perf buffer of the given name, if any.
+std::optional<ringbuf_channel_t> RingBufChannel(std::string_view perf_buffer_name) {
+  if (perf_buffer_name == "socket_data_events") {
+    return kSocketDataEventsRingBuf;
+  }
+  if (perf_buffer_name == "socket_control_events") {
+    return kSocketControlEventsRingBuf;
+  }
+  return std::nullopt;
+}
+}  // namespace
+
 Status SocketTraceConnector::InitBPF() {
   // set BPF loop limit and chunk limit based on kernel version
   auto kernel = system::GetCachedKernelVersion();
@@ -458,6 +550,30 @@ Status SocketTraceConnector::InitBPF() {
         "to $2",
         kernel.ToString(), FLAGS_stirling_bpf_loop_limit, FLAGS_stirling_bpf_chunk_limit);
   }
+
+  // Ring buffers can't be recorded or replayed, so those modes always use perf buffers.
+  use_ringbuf_ = FLAGS_stirling_socket_tracer_use_ringbuf &&
+                 bpf_tools::BCCWrapper::RingBuffersSupported() && !bcc_->IsRecording() &&
+                 !bcc_->IsReplaying();
+
+  // A ring buffer is shared by all CPUs, so it gets the size of all of the per-CPU perf buffers
+  // that it replaces.
+  const int kNCPUs = get_nprocs_conf();
+  std::vector<bpf_tools::PerfBufferSpec> perf_buffer_specs;
+  std::vector<bpf_tools::RingBufferSpec> ring_buffer_specs;
+  std::map<ringbuf_channel_t, int> ring_buffer_pages;
+  for (const auto& spec : InitPerfBufferSpecs()) {
+    std::optional<ringbuf_channel_t> channel = RingBufChannel(spec.name);
+    if (!use_ringbuf_ || !channel.has_value()) {
+      perf_buffer_specs.push_back(spec);
+      continue;
+    }
+    ring_buffer_specs.push_back({spec.name, spec.probe_output_fn, spec.probe_loss_fn,
+                                 "ringbuf_lost_events", channel.value(), spec.cb_cookie});
+    ring_buffer_pages[channel.value()] =
+        bpf_tools::BCCWrapper::RingBufferNumPages(static_cast<size_t>(spec.size_bytes) * kNCPUs);
+  }
+
   // PROTOCOL_LIST: Requires update on new protocols.
   std::vector<std::string> defines = {
       absl::StrCat("-DENABLE_TLS_DEBUG_SOURCES=", FLAGS_stirling_debug_tls_sources),
@@ -474,16 +590,24 @@ Status SocketTraceConnector::InitBPF() {
       absl::StrCat("-DENABLE_MONGO_TRACING=", protocol_transfer_specs_[kProtocolMongo].enabled),
       absl::StrCat("-DBPF_LOOP_LIMIT=", FLAGS_stirling_bpf_loop_limit),
       absl::StrCat("-DBPF_CHUNK_LIMIT=", FLAGS_stirling_bpf_chunk_limit),
+      absl::StrCat("-DUSE_RINGBUF=", use_ringbuf_),
   };
+  if (use_ringbuf_) {
+    defines.push_back(absl::StrCat("-DSOCKET_DATA_EVENTS_RINGBUF_PAGES=",
+                                   ring_buffer_pages[kSocketDataEventsRingBuf]));
+    defines.push_back(absl::StrCat("-DSOCKET_CONTROL_EVENTS_RINGBUF_PAGES=",
+                                   ring_buffer_pages[kSocketControlEventsRingBuf]));
+  }
   PX_RETURN_IF_ERROR(bcc_->InitBPFProgram(socket_trace_bcc_script, defines));
 
   PX_RETURN_IF_ERROR(bcc_->AttachKProbes(kProbeSpecs));
   LOG(INFO) << absl::Substitute("Number of kprobes deployed = $0", kProbeSpecs.size());
   LOG(INFO) << "Probes successfully deployed.";
 
-  const auto perf_buffer_specs = InitPerfBufferSpecs();
-  PX_RETURN_IF_ERROR(bcc_->OpenPerfBuffers(perf_buffer_specs));
+  PX_RETURN_IF_ERROR(bcc_->OpenPerfBuffers(ToArrayView(perf_buffer_specs)));
   LOG(INFO) << absl::Substitute("Number of perf buffers opened = $0", perf_buffer_specs.size());
+  PX_RETURN_IF_ERROR(bcc_->OpenRingBuffers(ToArrayView(ring_buffer_specs)));
+  LOG(INFO) << absl::Substitute("Number of ring buffers opened = $0", ring_buffer_specs.size());
 
   // Set trace role to BPF probes.
   for (const auto& p : magic_enum::enum_values<traffic_protocol_t>()) {
@@ -496,6 +620,19 @@ Status SocketTraceConnector::InitBPF() {
     }
   }
 
+  PX_ASSIGN_OR_RETURN(auto capture_limits,
+                      ParseCaptureLimits(FLAGS_stirling_socket_tracer_capture_limits));
+  for (const auto& [protocol, limit_bytes] : capture_limits) {
+    PX_RETURN_IF_ERROR(UpdateBPFProtocolCaptureLimit(protocol, limit_bytes));
+    LOG(INFO) << absl::Substitute("Capturing at most $0 bytes per read/write for $1", limit_bytes,
+                                  magic_enum::enum_name(protocol));
+  }
+
+  PX_RETURN_IF_ERROR(UpdateBPFConnSamplingRatio(FLAGS_stirling_socket_tracer_conn_sampling_ratio));
+  if (FLAGS_stirling_socket_tracer_upid_rate_limit > 0) {
+    PX_RETURN_IF_ERROR(UpdateBPFUPIDRateLimit(FLAGS_stirling_socket_tracer_upid_rate_limit));
+  }
+
   PX_RETURN_IF_ERROR(TestOnlySetTargetPID());
   if (FLAGS_stirling_disable_self_tracing) {
     PX_RETURN_IF_ERROR(DisableSelfTracing());
@@ -554,6 +691,8 @@ Status SocketTraceConnector::InitImpl() {
   openssl_trace_state_ = WrappedBCCArrayTable<int>::Create(bcc_.get(), "openssl_trace_state");
   openssl_trace_state_debug_ = WrappedBCCMap<uint32_t, struct openssl_trace_state_debug_t>::Create(
       bcc_.get(), "openssl_trace_state_debug");
+  upid_rate_limit_map_ = WrappedBCCMap<uint32_t, struct rate_limit_bucket_t>::Create(
+      bcc_.get(), "upid_rate_limit_map");
 
   return Status::OK();
 }
@@ -659,8 +798,15 @@ void SocketTraceConnector::UpdateCommonState(ConnectorContext* ctx) {
   // so raw data will be pushed to connection trackers more aggressively.
   // No data is lost, but this is a side-effect of sorts that affects timing of transfers.
   // It may be worth noting during debug.
+  // BPF submits to the ring buffers without waking up user-space, so their events are only drained
+  // by this poll, once per transfer iteration. The ring buffers are consumed in the order they were
+  // opened (data, then control); ConnTrackers accept the data of a connection before its open
+  // event, so the order only affects timing.
+  bcc_->PollRingBuffers();
   bcc_->PollPerfBuffers();
 
+  UpdateSampling();
+
   // Set-up current state for connection inference purposes.
   if (socket_info_mgr_ != nullptr) {
     socket_info_mgr_->Flush();
@@ -687,6 +833,72 @@ void SocketTraceConnector::UpdateCommonState(ConnectorContext* ctx) {
   }
 }
 
+void SocketTraceConnector::UpdateSampling() {
+  // The check that state is not uninitialized is required for socket_trace_connector_test.
+  if (state() == State::kUninitialized) {
+    return;
+  }
+
+  const int64_t num_lost_events =
+      stats_.Get(StatKey::kLossSocketDataEvent) + stats_.Get(StatKey::kLossSocketControlEvent);
+  if (FLAGS_stirling_socket_tracer_adaptive_sampling) {
+    // Additive increase would take too long to recover from a low ratio, so the ratio grows
+    // multiplicatively too, just more slowly than it shrinks.
+    constexpr double kDecreaseFactor = 0.5;
+    constexpr double kIncreaseFactor = 1.05;
+    double ratio = num_lost_events > prev_num_lost_events_
+                       ? conn_sampling_ratio_ * kDecreaseFactor
+                       : conn_sampling_ratio_ * kIncreaseFactor;
+    ratio = std::min(FLAGS_stirling_socket_tracer_conn_sampling_ratio,
+                     std::max(FLAGS_stirling_socket_tracer_min_conn_sampling_ratio, ratio));
+    if (std::llround(ratio * kConnSamplingScale) !=
+        std::llround(conn_sampling_ratio_ * kConnSamplingScale)) {
+      VLOG(1) << absl::Substitute("Connection sampling ratio changed from $0 to $1",
+                                  conn_sampling_ratio_, ratio);
+      PX_UNUSED(UpdateBPFConnSamplingRatio(ratio));
+    }
+    conn_sampling_ratio_ = ratio;
+  }
+  prev_num_lost_events_ = num_lost_events;
+
+  // Reading the rate limit buckets is relatively expensive, so only do it once a second.
+  constexpr auto kRateLimitReadPeriod = std::chrono::seconds(1);
+  if (FLAGS_stirling_socket_tracer_upid_rate_limit == 0 ||
+      sampling_freq_mgr_.count() % (kRateLimitReadPeriod / kSamplingPeriod) != 0) {
+    return;
+  }
+  upid_keep_fraction_ =
+      RateLimitKeepFractions(upid_rate_limit_map_->GetTableOffline(), &prev_rate_limit_counts_);
+}
+
+absl::flat_hash_map<uint32_t, double> RateLimitKeepFractions(
+    const std::vector<std::pair<uint32_t, rate_limit_bucket_t>>& buckets,
+    absl::flat_hash_map<uint32_t, std::pair<uint64_t, uint64_t>>* prev_counts) {
+  absl::flat_hash_map<uint32_t, std::pair<uint64_t, uint64_t>> counts;
+  absl::flat_hash_map<uint32_t, double> keep_fractions;
+  for (const auto& [tgid, bucket] : buckets) {
+    counts[tgid] = {bucket.num_passed, bucket.num_dropped};
+    auto iter = prev_counts->find(tgid);
+    uint64_t prev_passed = 0;
+    uint64_t prev_dropped = 0;
+    if (iter != prev_counts->end()) {
+      std::tie(prev_passed, prev_dropped) = iter->second;
+    }
+    // A tgid that was evicted from the LRU map and re-added restarts its counts.
+    if (bucket.num_passed < prev_passed || bucket.num_dropped < prev_dropped) {
+      prev_passed = 0;
+      prev_dropped = 0;
+    }
+    const uint64_t passed = bucket.num_passed - prev_passed;
+    const uint64_t dropped = bucket.num_dropped - prev_dropped;
+    if (dropped > 0) {
+      keep_fractions[tgid] = static_cast<double>(passed) / (passed + dropped);
+    }
+  }
+  *prev_counts = std::move(counts);
+  return keep_fractions;
+}
+
 void SocketTraceConnector::UpdateTrackerTraceLevel(ConnTracker* tracker) {
   if (pids_to_trace_.contains(tracker->conn_id().upid.pid)) {
     tracker->SetDebugTrace(2);
@@ -793,14 +1005,21 @@ void SocketTraceConnector::TransferDataImpl(ConnectorContext* ctx) {
     }
   }
 
-  for (const auto& conn_tracker : conn_trackers_mgr_.active_trackers()) {
-    const auto& transfer_spec = protocol_transfer_specs_[conn_tracker->protocol()];
-
-    DataTable* data_table = nullptr;
-    if (transfer_spec.enabled) {
-      data_table = data_tables_[transfer_spec.table_num];
+  // Apply the capture limits that were set since the last iteration.
+  for (int i = 0; i < kNumProtocols; ++i) {
+    int64_t limit_bytes = capture_limits_to_update_[i].exchange(-1);
+    if (limit_bytes < 0) {
+      continue;
     }
+    auto protocol = static_cast<traffic_protocol_t>(i);
+    Status s = UpdateBPFProtocolCaptureLimit(protocol, static_cast<uint32_t>(limit_bytes));
+    LOG_IF(ERROR, !s.ok()) << absl::Substitute("Failed to update the capture limit of $0: $1",
+                                               magic_enum::enum_name(protocol), s.msg());
+  }
 
+  // The trace levels, UPIDs and socket info lookups use state that is shared between all
+  // trackers, so they are updated up front, on this thread.
+  for (const auto& conn_tracker : conn_trackers_mgr_.active_trackers()) {
     UpdateTrackerTraceLevel(conn_tracker);
 
     // Once a known UPID, always a known UPID.
@@ -812,8 +1031,64 @@ void SocketTraceConnector::TransferDataImpl(ConnectorContext* ctx) {
       }
     }
 
+    auto keep_fraction_iter = upid_keep_fraction_.find(conn_tracker->conn_id().upid.pid);
+    conn_tracker->set_rate_limit_keep_fraction(
+        keep_fraction_iter != upid_keep_fraction_.end() ? keep_fraction_iter->second : 1.0);
+
     conn_tracker->IterationPreTick(iteration_time_, cluster_cidrs, proc_parser_.get(),
                                    socket_info_mgr_.get());
+  }
+
+  // The first shard writes to the output tables directly, the others to their own tables, which
+  // are merged into the output tables after all shards are done.
+  const size_t num_shards = conn_trackers_mgr_.num_shards();
+  if (shard_data_tables_.size() != num_shards - 1) {
+    shard_data_tables_.resize(num_shards - 1);
+    for (auto& tables : shard_data_tables_) {
+      tables.resize(data_tables_.size());
+      for (size_t i = 0; i < data_tables_.size(); ++i) {
+        tables[i] = std::make_unique<DataTable>(/*id*/ 0, table_schemas()[i]);
+      }
+    }
+  }
+
+  std::vector<std::vector<DataTable*>> shard_tables(num_shards);
+  shard_tables[0] = data_tables_;
+  for (size_t shard = 1; shard < num_shards; ++shard) {
+    shard_tables[shard].resize(data_tables_.size(), nullptr);
+    for (size_t i = 0; i < data_tables_.size(); ++i) {
+      if (data_tables_[i] != nullptr) {
+        shard_tables[shard][i] = shard_data_tables_[shard - 1][i].get();
+      }
+    }
+  }
+  shard_workers_.Run(num_shards, [this, ctx, &shard_tables](size_t shard) {
+    TransferShard(ctx, shard, shard_tables[shard]);
+  });
+
+  for (auto& tables : shard_data_tables_) {
+    for (size_t i = 0; i < data_tables_.size(); ++i) {
+      if (data_tables_[i] != nullptr) {
+        data_tables_[i]->AppendRecords(tables[i].get());
+      }
+    }
+  }
+
+  CheckTracerState();
+
+  // Once we've cleared all the debug trace levels for this pid, we can remove it from the list.
+  pids_to_trace_disable_.clear();
+}
+
+void SocketTraceConnector::TransferShard(ConnectorContext* ctx, size_t shard,
+                                         const std::vector<DataTable*>& data_tables) {
+  for (const auto& conn_tracker : conn_trackers_mgr_.active_trackers(shard)) {
+    const auto& transfer_spec = protocol_transfer_specs_[conn_tracker->protocol()];
+
+    DataTable* data_table = nullptr;
+    if (transfer_spec.enabled) {
+      data_table = data_tables[transfer_spec.table_num];
+    }
 
     if (transfer_spec.transfer_fn != nullptr) {
       transfer_spec.transfer_fn(*this, ctx, conn_tracker, data_table);
@@ -827,11 +1102,6 @@ void SocketTraceConnector::TransferDataImpl(ConnectorContext* ctx) {
 
     conn_tracker->IterationPostTick();
   }
-
-  CheckTracerState();
-
-  // Once we've cleared all the debug trace levels for this pid, we can remove it from the list.
-  pids_to_trace_disable_.clear();
 }
 
 Status SocketTraceConnector::UpdateBPFProtocolTraceRole(traffic_protocol_t protocol,
@@ -840,6 +1110,43 @@ Status SocketTraceConnector::UpdateBPFProtocolTraceRole(traffic_protocol_t proto
   return control_map->SetValues(static_cast<int>(protocol), role_mask);
 }
 
+Status SocketTraceConnector::UpdateBPFProtocolCaptureLimit(traffic_protocol_t protocol,
+                                                           uint32_t limit_bytes) {
+  auto capture_limit_map =
+      WrappedBCCPerCPUArrayTable<uint32_t>::Create(bcc_.get(), kCaptureLimitMapName);
+  return capture_limit_map->SetValues(static_cast<int>(protocol), limit_bytes);
+}
+
+void SocketTraceConnector::SetCaptureLimit(int protocol, uint32_t limit_bytes) {
+  if (protocol < 0 || protocol >= kNumProtocols) {
+    LOG(WARNING) << absl::Substitute("Ignoring capture limit of unknown protocol $0", protocol);
+    return;
+  }
+  LOG(INFO) << absl::Substitute("Capturing at most $0 bytes per read/write for $1", limit_bytes,
+                                magic_enum::enum_name(static_cast<traffic_protocol_t>(protocol)));
+  capture_limits_to_update_[protocol] = limit_bytes;
+}
+
+Status SocketTraceConnector::UpdateBPFConnSamplingRatio(double ratio) {
+  if (ratio <= 0 || ratio > 1) {
+    return error::InvalidArgument("Connection sampling ratio must be in (0, 1], got $0", ratio);
+  }
+  auto control_map =
+      WrappedBCCPerCPUArrayTable<int64_t>::Create(bcc_.get(), kControlValuesArrayName);
+  // A value of 0 would disable sampling, so round up to sample at least one connection in the
+  // scale.
+  const int64_t scaled_ratio = std::max<int64_t>(1, std::llround(ratio * kConnSamplingScale));
+  PX_RETURN_IF_ERROR(control_map->SetValues(kConnSamplingRatioIndex, scaled_ratio));
+  conn_sampling_ratio_ = ratio;
+  return Status::OK();
+}
+
+Status SocketTraceConnector::UpdateBPFUPIDRateLimit(uint32_t exchanges_per_sec) {
+  auto control_map =
+      WrappedBCCPerCPUArrayTable<int64_t>::Create(bcc_.get(), kControlValuesArrayName);
+  return control_map->SetValues(kUPIDRateLimitIndex, static_cast<int64_t>(exchanges_per_sec));
+}
+
 Status SocketTraceConnector::TestOnlySetTargetPID() {
   int64_t pid = FLAGS_test_only_socket_trace_target_pid;
   if (pid != kTraceAllTGIDs) {
@@ -884,7 +1191,14 @@ void SocketTraceConnector::HandleDataEvent(void* cb_cookie, void* data, int data
   // we create a filler event instead. This is important to Kafka, for example,
   // where the sendfile data is in the payload and the protocol parser can still succeed
   // as long as it is properly accounted for.
-  std::unique_ptr<SocketDataEvent> filler_event_ptr = data_event_ptr->ExtractFillerEvent();
+  //
+  // Bytes left out by a capture limit are only filled in for HTTP, whose parser keeps the headers
+  // of messages with a Content-Length. The parsers of the other protocols would decode the zeros
+  // as fields of the frame, so the bytes are left as a gap, which they skip like a lost event.
+  std::unique_ptr<SocketDataEvent> filler_event_ptr;
+  if (!data_event_ptr->attr.truncated || data_event_ptr->attr.protocol == kProtocolHTTP) {
+    filler_event_ptr = data_event_ptr->ExtractFillerEvent();
+  }
 
   if (header_event_ptr) {
     connector->AcceptDataEvent(std::move(header_event_ptr));
@@ -1296,6 +1610,7 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   r.Append<r.ColIndex("resp_body")>(std::move(resp_message.body), FLAGS_max_body_bytes);
   r.Append<r.ColIndex("latency")>(
       CalculateLatency(req_message.timestamp_ns, resp_message.timestamp_ns));
+  r.Append<r.ColIndex("sampling_ratio")>(conn_tracker.sampling_ratio());
 #ifndef NDEBUG
   r.Append<r.ColIndex("px_info_")>(PXInfoString(conn_tracker, record));
 #endif
@@ -1370,6 +1685,7 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   // TODO(yzhao): Remove once http2::Record::bpf_timestamp_ns is removed.
   LOG_IF_EVERY_N(WARNING, latency_ns < 0, 100)
       << absl::Substitute("Negative latency found in HTTP2 records, record=$0", record.ToString());
+  r.Append<r.ColIndex("sampling_ratio")>(conn_tracker.sampling_ratio());
 #ifndef NDEBUG
   r.Append<r.ColIndex("px_info_")>(PXInfoString(conn_tracker, record));
 #endif
@@ -1396,6 +1712,7 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   r.Append<r.ColIndex("resp_body")>(std::move(entry.resp.msg), FLAGS_max_body_bytes);
   r.Append<r.ColIndex("latency")>(
       CalculateLatency(entry.req.timestamp_ns, entry.resp.timestamp_ns));
+  r.Append<r.ColIndex("sampling_ratio")>(conn_tracker.sampling_ratio());
 #ifndef NDEBUG
   r.Append<r.ColIndex("px_info_")>(PXInfoString(conn_tracker, entry));
 #endif
@@ -1422,6 +1739,7 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   r.Append<r.ColIndex("resp_body")>(std::move(entry.resp.msg), FLAGS_max_body_bytes);
   r.Append<r.ColIndex("latency")>(
       CalculateLatency(entry.req.timestamp_ns, entry.resp.timestamp_ns));
+  r.Append<r.ColIndex("sampling_ratio")>(conn_tracker.sampling_ratio());
 #ifndef NDEBUG
   r.Append<r.ColIndex("px_info_")>(PXInfoString(conn_tracker, entry));
 #endif
@@ -1448,6 +1766,7 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   r.Append<r.ColIndex("resp_body")>(entry.resp.msg);
   r.Append<r.ColIndex("latency")>(
       CalculateLatency(entry.req.timestamp_ns, entry.resp.timestamp_ns));
+  r.Append<r.ColIndex("sampling_ratio")>(conn_tracker.sampling_ratio());
 #ifndef NDEBUG
   r.Append<r.ColIndex("px_info_")>(PXInfoString(conn_tracker, entry));
 #endif
@@ -1473,6 +1792,7 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   r.Append<r.ColIndex("latency")>(
       CalculateLatency(entry.req.timestamp_ns, entry.resp.timestamp_ns));
   r.Append<r.ColIndex("req_cmd")>(ToString(entry.req.tag, /* is_req */ true));
+  r.Append<r.ColIndex("sampling_ratio")>(conn_tracker.sampling_ratio());
 #ifndef NDEBUG
   r.Append<r.ColIndex("px_info_")>(PXInfoString(conn_tracker, entry));
 #endif
@@ -1496,6 +1816,7 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   r.Append<r.ColIndex("req_type")>(entry.req.type);
   r.Append<r.ColIndex("latency")>(
       CalculateLatency(entry.req.timestamp_ns, entry.resp.timestamp_ns));
+  r.Append<r.ColIndex("sampling_ratio")>(conn_tracker.sampling_ratio());
 #ifndef NDEBUG
   r.Append<r.ColIndex("px_info_")>(PXInfoString(conn_tracker, entry));
 #endif
@@ -1532,6 +1853,7 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   r.Append<r.ColIndex("latency")>(
       AMQPCalculateLatency(entry.req.timestamp_ns, entry.resp.timestamp_ns, entry.req.synchronous,
                            entry.resp.synchronous));
+  r.Append<r.ColIndex("sampling_ratio")>(conn_tracker.sampling_ratio());
 }
 
 namespace {
@@ -1576,6 +1898,7 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   r.Append<r.ColIndex("resp")>(std::string(entry.resp.payload));
   r.Append<r.ColIndex("latency")>(
       CalculateLatency(entry.req.timestamp_ns, entry.resp.timestamp_ns));
+  r.Append<r.ColIndex("sampling_ratio")>(conn_tracker.sampling_ratio());
 #ifndef NDEBUG
   r.Append<r.ColIndex("px_info_")>(PXInfoString(conn_tracker, entry));
 #endif
@@ -1600,6 +1923,7 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   r.Append<r.ColIndex("cmd")>(record.req.command);
   r.Append<r.ColIndex("body")>(record.req.options);
   r.Append<r.ColIndex("resp")>(record.resp.command);
+  r.Append<r.ColIndex("sampling_ratio")>(conn_tracker.sampling_ratio());
 #ifndef NDEBUG
   r.Append<r.ColIndex("px_info_")>(PXInfoString(conn_tracker, record));
 #endif
@@ -1629,6 +1953,7 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   r.Append<r.ColIndex("resp")>(std::move(record.resp.msg), kMaxKafkaBodyBytes);
   r.Append<r.ColIndex("latency")>(
       CalculateLatency(record.req.timestamp_ns, record.resp.timestamp_ns));
+  r.Append<r.ColIndex("sampling_ratio")>(conn_tracker.sampling_ratio());
 #ifndef NDEBUG
   r.Append<r.ColIndex("px_info_")>(PXInfoString(conn_tracker, record));
 #endif
@@ -1656,6 +1981,7 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   r.Append<r.ColIndex("resp_body")>(std::move(record.resp.frame_body));
   r.Append<r.ColIndex("latency")>(
       CalculateLatency(record.req.timestamp_ns, record.resp.timestamp_ns));
+  r.Append<r.ColIndex("sampling_ratio")>(conn_tracker.sampling_ratio());
 #ifndef NDEBUG
   r.Append<r.ColIndex("px_info_")>(PXInfoString(conn_tracker, record));
 #endif
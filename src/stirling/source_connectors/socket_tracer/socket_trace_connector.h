@@ -18,6 +18,8 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <fstream>
 #include <list>
 #include <map>
@@ -44,6 +46,7 @@
 #include "src/stirling/source_connectors/socket_tracer/conn_stats.h"
 #include "src/stirling/source_connectors/socket_tracer/conn_tracker.h"
 #include "src/stirling/source_connectors/socket_tracer/conn_trackers_manager.h"
+#include "src/stirling/source_connectors/socket_tracer/shard_worker_pool.h"
 #include "src/stirling/source_connectors/socket_tracer/socket_trace_bpf_tables.h"
 #include "src/stirling/source_connectors/socket_tracer/socket_trace_tables.h"
 #include "src/stirling/source_connectors/socket_tracer/uprobe_manager.h"
@@ -91,6 +94,19 @@ enum TraceMode : int32_t {
   OnForNewerKernel = 2,
 };
 
+// Parses a comma-separated list of protocol:bytes capture limits, like the value of
+// --stirling_socket_tracer_capture_limits. Protocols are named as in traffic_protocol_t, without
+// the kProtocol prefix (case-insensitive).
+StatusOr<absl::flat_hash_map<traffic_protocol_t, uint32_t>> ParseCaptureLimits(
+    std::string_view capture_limits);
+
+// Returns the fraction of the exchanges of each tgid that passed its rate limit, since the counts
+// in prev_counts (passed, dropped), for the tgids that had exchanges dropped. prev_counts is then
+// updated to the counts of the buckets.
+absl::flat_hash_map<uint32_t, double> RateLimitKeepFractions(
+    const std::vector<std::pair<uint32_t, rate_limit_bucket_t>>& buckets,
+    absl::flat_hash_map<uint32_t, std::pair<uint64_t, uint64_t>>* prev_counts);
+
 class SocketTraceConnector : public BCCSourceConnector {
  public:
   static constexpr std::string_view kName = "socket_tracer";
@@ -123,6 +139,7 @@ class SocketTraceConnector : public BCCSourceConnector {
   Status StopImpl() override;
   void InitContextImpl(ConnectorContext* ctx) override;
   void TransferDataImpl(ConnectorContext* ctx) override;
+  bool thread_safe() const override { return true; }
 
   void CheckTracerState();
 
@@ -140,6 +157,24 @@ class SocketTraceConnector : public BCCSourceConnector {
   // data from inside BPF to user-space.
   Status UpdateBPFProtocolTraceRole(traffic_protocol_t protocol, uint64_t role_mask);
 
+  // Updates the capture limit for protocol: the maximum number of bytes of each read/write that
+  // BPF sends to user-space. The remaining bytes are accounted for with filler.
+  // A limit of 0 sends all bytes.
+  Status UpdateBPFProtocolCaptureLimit(traffic_protocol_t protocol, uint32_t limit_bytes);
+
+  // Updates the fraction of connections whose data BPF sends to user-space. Connections are
+  // picked deterministically by their conn_id, so a connection is either fully traced or not.
+  // Only applies to connections that BPF has not seen yet.
+  Status UpdateBPFConnSamplingRatio(double ratio);
+
+  // Updates the maximum number of request/response exchanges per second that BPF sends to
+  // user-space for each process. 0 disables the limit.
+  Status UpdateBPFUPIDRateLimit(uint32_t exchanges_per_sec);
+
+  // Adapts the connection sampling ratio to the event losses, and computes the fraction of each
+  // process's exchanges that passed its rate limit in BPF.
+  void UpdateSampling();
+
   // Instructs Stirling to log detailed debug information about the traced events from the PID
   // specified by --test_only_socket_trace_target_pid.
   Status TestOnlySetTargetPID();
@@ -150,6 +185,10 @@ class SocketTraceConnector : public BCCSourceConnector {
     pids_to_trace_disable_.insert(pid);
   }
 
+  // The capture limit is applied to BPF on the next TransferDataImpl(), since this may be called
+  // from a signal handler.
+  void SetCaptureLimit(int protocol, uint32_t limit_bytes) override;
+
   /**
    * Gets a pointer to the most recent ConnTracker for the given pid and fd.
    *
@@ -213,6 +252,16 @@ class SocketTraceConnector : public BCCSourceConnector {
   void TransferStream(ConnectorContext* ctx, ConnTracker* tracker, DataTable* data_table);
   void TransferConnStats(ConnectorContext* ctx, DataTable* data_table);
 
+  // Parses and stitches the data of the trackers of one shard into data_tables.
+  // Shards can run concurrently, as long as each has its own data_tables.
+  //
+  // Events from BPF are not routed to the thread of their shard. They are accepted on the polling
+  // thread before the shards run, because the perf and ring buffers are polled on a single thread,
+  // and trackers are created in the shared map of conn_trackers_mgr_. Accepting an event only
+  // appends it to its tracker, while the parsing and stitching run on the shards.
+  void TransferShard(ConnectorContext* ctx, size_t shard,
+                     const std::vector<DataTable*>& data_tables);
+
   void set_iteration_time(std::chrono::time_point<std::chrono::steady_clock> time) {
     DCHECK(time >= iteration_time_);
     iteration_time_ = time;
@@ -235,16 +284,42 @@ class SocketTraceConnector : public BCCSourceConnector {
 
   ConnTrackersManager conn_trackers_mgr_;
 
+  // Output tables of the shards other than the first, which are merged into data_tables_ at the
+  // end of every TransferDataImpl().
+  std::vector<std::vector<std::unique_ptr<DataTable>>> shard_data_tables_;
+
+  // Runs the shards other than the first, which runs on the calling thread.
+  ShardWorkerPool shard_workers_;
+
   ConnStats conn_stats_;
 
   std::unique_ptr<WrappedBCCArrayTable<int>> openssl_trace_state_;
   std::unique_ptr<WrappedBCCMap<uint32_t, struct openssl_trace_state_debug_t>>
       openssl_trace_state_debug_;
+  // The token buckets of the per-process rate limit in BPF, keyed by tgid.
+  std::unique_ptr<WrappedBCCMap<uint32_t, struct rate_limit_bucket_t>> upid_rate_limit_map_;
+
+  // The fraction of connections that are currently sampled in BPF.
+  double conn_sampling_ratio_ = 1.0;
+
+  // The event losses seen by the previous UpdateSampling(), to detect new losses.
+  int64_t prev_num_lost_events_ = 0;
+
+  // The passed and dropped counts of each tgid's rate limit bucket, as of the previous
+  // UpdateSampling(), and the fraction of exchanges that passed in between. Tgids that are not in
+  // upid_keep_fraction_ are not being rate limited.
+  absl::flat_hash_map<uint32_t, std::pair<uint64_t, uint64_t>> prev_rate_limit_counts_;
+  absl::flat_hash_map<uint32_t, double> upid_keep_fraction_;
+
   prometheus::Family<prometheus::Counter>& openssl_trace_mismatched_fds_counter_family_;
   prometheus::Family<prometheus::Counter>& openssl_trace_tls_source_counter_family_;
 
   absl::flat_hash_set<int> pids_to_trace_disable_;
 
+  // The capture limits set by SetCaptureLimit() that are yet to be applied to BPF, indexed by
+  // protocol. A negative value means there is no update.
+  std::array<std::atomic<int64_t>, kNumProtocols> capture_limits_to_update_;
+
   std::function<std::chrono::steady_clock::time_point()> now_fn_ = std::chrono::steady_clock::now;
 
   struct TransferSpec {
@@ -280,6 +355,9 @@ class SocketTraceConnector : public BCCSourceConnector {
   //   Example: data_table->SetConsumeRecordsCutoffTime(perf_buffer_drain_time_);
   uint64_t perf_buffer_drain_time_ = 0;
 
+  // Whether the data and control events are sent through BPF ring buffers instead of perf buffers.
+  bool use_ringbuf_ = false;
+
   // If not a nullptr, writes the events received from perf buffers to this stream.
   std::unique_ptr<std::ofstream> perf_buffer_events_output_stream_;
   enum class OutputFormat {
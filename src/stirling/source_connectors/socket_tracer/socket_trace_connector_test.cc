@@ -41,6 +41,8 @@ namespace stirling {
 namespace http = protocols::http;
 
 using ::testing::ElementsAre;
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
 
 using ::px::stirling::testing::RecordBatchSizeIs;
 
@@ -201,6 +203,30 @@ auto ToIntVector(const types::SharedColumnWrapper& col) {
   return result;
 }
 
+// Returns the BPF events of `event` when its protocol has a capture limit of `limit` bytes:
+// an event with the captured bytes, followed by a truncated event that accounts for the rest.
+std::vector<std::unique_ptr<socket_data_event_t>> CaptureLimitedEvents(const SocketDataEvent& event,
+                                                                       uint32_t limit) {
+  std::vector<std::unique_ptr<socket_data_event_t>> events;
+
+  auto captured = std::make_unique<socket_data_event_t>();
+  captured->attr = event.attr;
+  captured->attr.msg_size = limit;
+  captured->attr.msg_buf_size = limit;
+  event.msg.copy(captured->msg, limit);
+  events.push_back(std::move(captured));
+
+  auto truncated = std::make_unique<socket_data_event_t>();
+  truncated->attr = event.attr;
+  truncated->attr.pos += limit;
+  truncated->attr.msg_size = event.msg.size() - limit;
+  truncated->attr.msg_buf_size = 0;
+  truncated->attr.truncated = true;
+  events.push_back(std::move(truncated));
+
+  return events;
+}
+
 TEST_F(SocketTraceConnectorTest, Basic) {
   struct socket_control_event_t conn = event_gen_.InitConn();
   std::unique_ptr<SocketDataEvent> event0_req = event_gen_.InitSendEvent<kProtocolHTTP>(kReq3);
@@ -331,6 +357,163 @@ TEST_F(SocketTraceConnectorTest, Truncation) {
   EXPECT_THAT(ToStringVector(records[kHTTPRespBodyIdx]), ElementsAre("abcde... [TRUNCATED]"));
 }
 
+// Tests that HTTP messages with a Content-Length are kept when their body is cut off by a capture
+// limit, with the rest of the body filled in with zeros.
+TEST_F(SocketTraceConnectorTest, HTTPCaptureLimit) {
+  const std::string_view kRespHeader =
+      "HTTP/1.1 200 OK\r\n"
+      "Content-Type: json\r\n"
+      "Content-Length: 26\r\n"
+      "\r\n";
+  const std::string kResp = absl::StrCat(kRespHeader, "abcdefghijklmnopqrstuvwxyz");
+
+  struct socket_control_event_t conn = event_gen_.InitConn();
+  std::unique_ptr<SocketDataEvent> req_event0 = event_gen_.InitSendEvent<kProtocolHTTP>(kReq0);
+  std::unique_ptr<SocketDataEvent> resp_event0 = event_gen_.InitRecvEvent<kProtocolHTTP>(kResp);
+  struct socket_control_event_t close_event = event_gen_.InitClose();
+
+  source_->AcceptControlEvent(conn);
+  source_->AcceptDataEvent(std::move(req_event0));
+  for (auto& event : CaptureLimitedEvents(*resp_event0, kRespHeader.size() + 5)) {
+    source_->HandleDataEvent(event.get(), sizeof(event->attr) + event->attr.msg_buf_size);
+  }
+  source_->AcceptControlEvent(close_event);
+
+  connector_->TransferData(ctx_.get());
+
+  std::vector<TaggedRecordBatch> tablets = http_table_->ConsumeRecords();
+  ASSERT_NOT_EMPTY_AND_GET_RECORDS(RecordBatch & records, tablets);
+
+  EXPECT_THAT(records, RecordBatchSizeIs(1));
+  EXPECT_THAT(ToIntVector<types::Int64Value>(records[kHTTPRespStatusIdx]), ElementsAre(200));
+  EXPECT_THAT(ToStringVector(records[kHTTPRespBodyIdx]),
+              ElementsAre(absl::StrCat("abcde", std::string(21, '\0'))));
+}
+
+// Tests that the frames of other protocols that are cut off by a capture limit are skipped,
+// rather than parsed with zeros in place of the bytes that were left out.
+TEST_F(SocketTraceConnectorTest, CQLCaptureLimit) {
+  using protocols::cass::ReqOp;
+  using protocols::cass::RespOp;
+  using protocols::cass::testutils::CreateCQLEmptyEvent;
+  using protocols::cass::testutils::CreateCQLEvent;
+
+  // A CQL request with CQL_VERSION=3.0.0.
+  constexpr uint8_t kStartupReq1[] = {0x00, 0x01, 0x00, 0x0b, 0x43, 0x51, 0x4c, 0x5f,
+                                      0x56, 0x45, 0x52, 0x53, 0x49, 0x4f, 0x4e, 0x00,
+                                      0x05, 0x33, 0x2e, 0x30, 0x2e, 0x30};
+
+  // A CQL request with CQL_VERSION=3.0.1
+  constexpr uint8_t kStartupReq2[] = {0x00, 0x01, 0x00, 0x0b, 0x43, 0x51, 0x4c, 0x5f,
+                                      0x56, 0x45, 0x52, 0x53, 0x49, 0x4f, 0x4e, 0x00,
+                                      0x05, 0x33, 0x2e, 0x30, 0x2e, 0x31};
+
+  // Only the 9 bytes of the frame header of the first request are captured.
+  constexpr uint32_t kCaptureLimit = 9;
+
+  struct socket_control_event_t conn = event_gen_.InitConn();
+  std::unique_ptr<SocketDataEvent> req1 =
+      event_gen_.InitSendEvent<kProtocolCQL>(CreateCQLEvent(ReqOp::kStartup, kStartupReq1, 1));
+  std::unique_ptr<SocketDataEvent> resp1 =
+      event_gen_.InitRecvEvent<kProtocolCQL>(CreateCQLEmptyEvent(RespOp::kReady, 1));
+  std::unique_ptr<SocketDataEvent> req2 =
+      event_gen_.InitSendEvent<kProtocolCQL>(CreateCQLEvent(ReqOp::kStartup, kStartupReq2, 2));
+  std::unique_ptr<SocketDataEvent> resp2 =
+      event_gen_.InitRecvEvent<kProtocolCQL>(CreateCQLEmptyEvent(RespOp::kReady, 2));
+  struct socket_control_event_t close_event = event_gen_.InitClose();
+
+  source_->AcceptControlEvent(conn);
+  for (auto& event : CaptureLimitedEvents(*req1, kCaptureLimit)) {
+    source_->HandleDataEvent(event.get(), sizeof(event->attr) + event->attr.msg_buf_size);
+  }
+  source_->AcceptDataEvent(std::move(resp1));
+  source_->AcceptDataEvent(std::move(req2));
+  source_->AcceptDataEvent(std::move(resp2));
+  source_->AcceptControlEvent(close_event);
+
+  connector_->TransferData(ctx_.get());
+
+  std::vector<TaggedRecordBatch> tablets = cql_table_->ConsumeRecords();
+  ASSERT_NOT_EMPTY_AND_GET_RECORDS(RecordBatch & records, tablets);
+
+  // The first request is dropped, instead of having its body decoded from zeros.
+  EXPECT_THAT(records, RecordBatchSizeIs(1));
+  EXPECT_THAT(ToStringVector(records[kCQLReqBody]), ElementsAre(R"({"CQL_VERSION":"3.0.1"})"));
+}
+
+// Tests that the sampling_ratio column combines the sampling ratio of the connection, which BPF
+// sends with each data event, and the fraction of the process's messages that passed its rate
+// limit.
+TEST_F(SocketTraceConnectorTest, SamplingRatio) {
+  struct socket_control_event_t conn = event_gen_.InitConn();
+  std::unique_ptr<SocketDataEvent> req_event0 = event_gen_.InitSendEvent<kProtocolHTTP>(kReq0);
+  std::unique_ptr<SocketDataEvent> resp_event0 = event_gen_.InitRecvEvent<kProtocolHTTP>(kResp0);
+  req_event0->attr.conn_sampling_ratio = kConnSamplingScale / 4;
+  resp_event0->attr.conn_sampling_ratio = kConnSamplingScale / 4;
+  struct socket_control_event_t close_event = event_gen_.InitClose();
+
+  source_->AcceptControlEvent(conn);
+  source_->AcceptDataEvent(std::move(req_event0));
+  source_->AcceptDataEvent(std::move(resp_event0));
+  source_->AcceptControlEvent(close_event);
+
+  connector_->TransferData(ctx_.get());
+
+  std::vector<TaggedRecordBatch> tablets = http_table_->ConsumeRecords();
+  ASSERT_NOT_EMPTY_AND_GET_RECORDS(RecordBatch & records, tablets);
+
+  constexpr int kHTTPSamplingRatioIdx = kHTTPTable.ColIndex("sampling_ratio");
+  ASSERT_THAT(records, RecordBatchSizeIs(1));
+  EXPECT_DOUBLE_EQ(records[kHTTPSamplingRatioIdx]->Get<types::Float64Value>(0).val, 0.25);
+}
+
+TEST(RateLimitKeepFractionsTest, Basic) {
+  absl::flat_hash_map<uint32_t, std::pair<uint64_t, uint64_t>> prev_counts;
+
+  rate_limit_bucket_t no_drops = {};
+  no_drops.num_passed = 10;
+  rate_limit_bucket_t drops = {};
+  drops.num_passed = 10;
+  drops.num_dropped = 30;
+  EXPECT_THAT(RateLimitKeepFractions({{1, no_drops}, {2, drops}}, &prev_counts),
+              UnorderedElementsAre(Pair(2, 0.25)));
+  EXPECT_THAT(prev_counts, UnorderedElementsAre(Pair(1, Pair(10, 0)), Pair(2, Pair(10, 30))));
+
+  // Only the messages since the previous counts are used.
+  drops.num_passed = 20;
+  drops.num_dropped = 40;
+  no_drops.num_passed = 15;
+  no_drops.num_dropped = 5;
+  EXPECT_THAT(RateLimitKeepFractions({{1, no_drops}, {2, drops}}, &prev_counts),
+              UnorderedElementsAre(Pair(1, 0.5), Pair(2, 0.5)));
+
+  // A bucket whose counts went down was evicted and re-added, so its counts restart from 0.
+  drops.num_passed = 1;
+  drops.num_dropped = 3;
+  EXPECT_THAT(RateLimitKeepFractions({{2, drops}}, &prev_counts),
+              UnorderedElementsAre(Pair(2, 0.25)));
+  EXPECT_THAT(prev_counts, UnorderedElementsAre(Pair(2, Pair(1, 3))));
+}
+
+TEST(ParseCaptureLimitsTest, Basic) {
+  ASSERT_OK_AND_ASSIGN(auto limits, ParseCaptureLimits(" http:65536, KAFKA:16384,MySQL:0 "));
+  EXPECT_THAT(limits, UnorderedElementsAre(Pair(kProtocolHTTP, 65536), Pair(kProtocolKafka, 16384),
+                                           Pair(kProtocolMySQL, 0)));
+
+  ASSERT_OK_AND_ASSIGN(limits, ParseCaptureLimits(""));
+  EXPECT_TRUE(limits.empty());
+}
+
+TEST(ParseCaptureLimitsTest, Errors) {
+  EXPECT_NOT_OK(ParseCaptureLimits("http"));
+  EXPECT_NOT_OK(ParseCaptureLimits("http:"));
+  EXPECT_NOT_OK(ParseCaptureLimits("http:-1"));
+  EXPECT_NOT_OK(ParseCaptureLimits("http:1:2"));
+  EXPECT_NOT_OK(ParseCaptureLimits("http:1kb"));
+  EXPECT_NOT_OK(ParseCaptureLimits("gopher:1024"));
+  EXPECT_NOT_OK(ParseCaptureLimits("http:1024,gopher:1024"));
+}
+
 // Use CQL protocol to check sorting, because it supports parallel request-response streams.
 TEST_F(SocketTraceConnectorTest, SortedByResponseTime) {
   using protocols::cass::ReqOp;
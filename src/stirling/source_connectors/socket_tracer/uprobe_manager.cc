@@ -26,8 +26,14 @@
 #include <unistd.h>
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
 #include <filesystem>
+#include <functional>
 #include <map>
+#include <optional>
+#include <thread>
 #include <tuple>
 
 #include "src/common/base/base.h"
@@ -52,6 +58,16 @@ DEFINE_double(stirling_rescan_exp_backoff_factor, 2.0,
               "Exponential backoff factor used in decided how often to rescan binaries for "
               "dynamically loaded libraries");
 
+DEFINE_string(stirling_uprobe_cache_dir,
+              gflags::StringFromEnv("PX_STIRLING_UPROBE_CACHE_DIR", ""),
+              "Directory in which the analysis of Go binaries for uprobe deployment is persisted, "
+              "keyed by build-id, so that it survives restarts. Should be a host path. "
+              "If empty, the analysis is only cached in memory.");
+
+DEFINE_uint32(stirling_uprobe_deploy_threads,
+              gflags::Uint32FromEnv("PX_STIRLING_UPROBE_DEPLOY_THREADS", 4),
+              "Number of threads that analyze binaries in parallel for uprobe deployment.");
+
 DEFINE_string(
     stirling_uprobe_opt_out, "",
     "Comma separated list of binary filenames that should be excluded from uprobe attachment."
@@ -70,7 +86,20 @@ using ::px::system::ProcPidRootPath;
 constexpr std::string_view kUprobeSkippedMessage =
     "binary filename '$0' contained in uprobe opt out list, skipping.";
 
-UProbeManager::UProbeManager(bpf_tools::BCCWrapper* bcc) : bcc_(bcc) {
+constexpr char kDeployStageSecondsMetric[] = "uprobe_deploy_stage_seconds";
+
+UProbeManager::UProbeManager(bpf_tools::BCCWrapper* bcc)
+    : bcc_(bcc),
+      deploy_stage_seconds_family_(BuildCounterFamily(
+          kDeployStageSecondsMetric,
+          "Total time spent in each stage of uprobe deployment. The go_analysis stage runs "
+          "concurrently with the openssl_attach and grpc_c_attach stages.")),
+      go_binaries_analyzed_counter_(
+          BuildCounter("uprobe_go_binaries_analyzed",
+                       "Number of Go binaries whose DWARF info was read for uprobe deployment")),
+      go_binary_cache_hits_counter_(
+          BuildCounter("uprobe_go_binary_cache_hits",
+                       "Number of Go binaries whose uprobe analysis was found in the cache")) {
   proc_parser_ = std::make_unique<system::ProcParser>();
   auto opt_out_list = absl::StrSplit(FLAGS_stirling_uprobe_opt_out, ",", absl::SkipWhitespace());
   uprobe_opt_out_ = absl::flat_hash_set<std::string>(opt_out_list.begin(), opt_out_list.end());
@@ -91,6 +120,17 @@ void UProbeManager::Init(bool disable_go_tls_tracing, bool enable_http2_tracing,
   node_tlswrap_symaddrs_map_ =
       MapT<struct node_tlswrap_symaddrs_t>::Create(bcc_, "node_tlswrap_symaddrs_map");
   grpc_c_versions_map_ = MapT<uint64_t>::Create(bcc_, "grpc_c_versions");
+
+  go_binary_analysis_cache_ =
+      std::make_unique<GoBinaryAnalysisCache>(FLAGS_stirling_uprobe_cache_dir);
+}
+
+void UProbeManager::RecordStageTime(std::string_view stage,
+                                    std::chrono::steady_clock::time_point start) {
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  deploy_stage_seconds_family_
+      .Add({{"name", kDeployStageSecondsMetric}, {"stage", std::string(stage)}})
+      .Increment(elapsed.count());
 }
 
 void UProbeManager::NotifyMMapEvent(upid_t upid) {
@@ -107,12 +147,12 @@ Status UProbeManager::LogAndAttachUProbe(const bpf_tools::UProbeSpec& spec) {
   return s;
 }
 
-StatusOr<int> UProbeManager::AttachUProbeTmpl(const ArrayView<UProbeTmpl>& probe_tmpls,
-                                              const std::string& binary,
-                                              obj_tools::ElfReader* elf_reader) {
+StatusOr<std::vector<bpf_tools::UProbeSpec>> UProbeManager::ResolveUProbeTmpl(
+    const ArrayView<UProbeTmpl>& probe_tmpls, const std::string& binary,
+    obj_tools::ElfReader* elf_reader) {
   using bpf_tools::BPFProbeAttachType;
 
-  int uprobe_count = 0;
+  std::vector<bpf_tools::UProbeSpec> specs;
   for (const auto& tmpl : probe_tmpls) {
     bpf_tools::UProbeSpec spec = {binary,
                                   /*symbol*/ {},
@@ -133,8 +173,7 @@ StatusOr<int> UProbeManager::AttachUProbeTmpl(const ArrayView<UProbeTmpl>& probe
         case BPFProbeAttachType::kEntry:
         case BPFProbeAttachType::kReturn: {
           spec.symbol = symbol_info.name;
-          PX_RETURN_IF_ERROR(LogAndAttachUProbe(spec));
-          ++uprobe_count;
+          specs.push_back(spec);
           break;
         }
         case BPFProbeAttachType::kReturnInsts: {
@@ -151,8 +190,7 @@ StatusOr<int> UProbeManager::AttachUProbeTmpl(const ArrayView<UProbeTmpl>& probe
           for (const uint64_t& addr : ret_inst_addrs) {
             spec.attach_type = BPFProbeAttachType::kEntry;
             spec.address = addr;
-            PX_RETURN_IF_ERROR(LogAndAttachUProbe(spec));
-            ++uprobe_count;
+            specs.push_back(spec);
           }
           break;
         }
@@ -161,7 +199,102 @@ StatusOr<int> UProbeManager::AttachUProbeTmpl(const ArrayView<UProbeTmpl>& probe
       }
     }
   }
-  return uprobe_count;
+  return specs;
+}
+
+StatusOr<int> UProbeManager::AttachUProbeTmpl(const ArrayView<UProbeTmpl>& probe_tmpls,
+                                              const std::string& binary,
+                                              obj_tools::ElfReader* elf_reader) {
+  PX_ASSIGN_OR_RETURN(std::vector<bpf_tools::UProbeSpec> specs,
+                      ResolveUProbeTmpl(probe_tmpls, binary, elf_reader));
+  for (const auto& spec : specs) {
+    PX_RETURN_IF_ERROR(LogAndAttachUProbe(spec));
+  }
+  return static_cast<int>(specs.size());
+}
+
+namespace {
+
+template <typename TSymAddrs>
+std::string SymAddrsToBytes(const TSymAddrs& symaddrs) {
+  return std::string(reinterpret_cast<const char*>(&symaddrs), sizeof(TSymAddrs));
+}
+
+// Returns nullopt if the bytes are empty, which marks symaddrs that were not found, or if the
+// bytes don't match the struct.
+template <typename TSymAddrs>
+std::optional<TSymAddrs> SymAddrsFromBytes(const std::string& bytes) {
+  if (bytes.size() != sizeof(TSymAddrs)) {
+    return std::nullopt;
+  }
+  TSymAddrs symaddrs;
+  std::memcpy(&symaddrs, bytes.data(), sizeof(TSymAddrs));
+  return symaddrs;
+}
+
+void AddAttachPoints(const std::vector<bpf_tools::UProbeSpec>& specs,
+                     google::protobuf::RepeatedPtrField<sockeventpb::UProbeAttachPoint>* points) {
+  for (const auto& spec : specs) {
+    sockeventpb::UProbeAttachPoint* point = points->Add();
+    point->set_symbol(spec.symbol);
+    point->set_address(spec.address);
+    point->set_attach_type(static_cast<uint32_t>(spec.attach_type));
+    point->set_probe_fn(spec.probe_fn);
+  }
+}
+
+}  // namespace
+
+StatusOr<int> UProbeManager::AttachUProbes(
+    const std::string& binary,
+    const google::protobuf::RepeatedPtrField<sockeventpb::UProbeAttachPoint>& attach_points) {
+  for (const auto& point : attach_points) {
+    bpf_tools::UProbeSpec spec = {binary,
+                                  point.symbol(),
+                                  point.address(),
+                                  bpf_tools::UProbeSpec::kDefaultPID,
+                                  static_cast<bpf_tools::BPFProbeAttachType>(point.attach_type()),
+                                  point.probe_fn()};
+    PX_RETURN_IF_ERROR(LogAndAttachUProbe(spec));
+  }
+  return attach_points.size();
+}
+
+StatusOr<sockeventpb::GoBinaryAnalysis> UProbeManager::AnalyzeGoBinary(
+    const std::string& binary, obj_tools::ElfReader* elf_reader) {
+  PX_ASSIGN_OR_RETURN(std::unique_ptr<DwarfReader> dwarf_reader,
+                      DwarfReader::CreateIndexingAll(binary));
+
+  sockeventpb::GoBinaryAnalysis analysis;
+  StatusOr<struct go_common_symaddrs_t> go_common_symaddrs =
+      GoCommonSymAddrs(elf_reader, dwarf_reader.get());
+  if (!go_common_symaddrs.ok()) {
+    // Without the mandatory symbols, there is nothing to probe.
+    return analysis;
+  }
+  analysis.set_go_common_symaddrs(SymAddrsToBytes(go_common_symaddrs.ValueOrDie()));
+
+  // A binary whose probes can't be resolved is cached as lacking the symaddrs, since it can't be
+  // traced either way.
+  StatusOr<struct go_tls_symaddrs_t> go_tls_symaddrs =
+      GoTLSSymAddrs(elf_reader, dwarf_reader.get());
+  StatusOr<std::vector<bpf_tools::UProbeSpec>> go_tls_specs =
+      ResolveUProbeTmpl(kGoTLSUProbeTmpls, binary, elf_reader);
+  if (go_tls_symaddrs.ok() && go_tls_specs.ok()) {
+    analysis.set_go_tls_symaddrs(SymAddrsToBytes(go_tls_symaddrs.ValueOrDie()));
+    AddAttachPoints(go_tls_specs.ValueOrDie(), analysis.mutable_go_tls_probes());
+  }
+
+  StatusOr<struct go_http2_symaddrs_t> go_http2_symaddrs =
+      GoHTTP2SymAddrs(elf_reader, dwarf_reader.get());
+  StatusOr<std::vector<bpf_tools::UProbeSpec>> go_http2_specs =
+      ResolveUProbeTmpl(kHTTP2ProbeTmpls, binary, elf_reader);
+  if (go_http2_symaddrs.ok() && go_http2_specs.ok()) {
+    analysis.set_go_http2_symaddrs(SymAddrsToBytes(go_http2_symaddrs.ValueOrDie()));
+    AddAttachPoints(go_http2_specs.ValueOrDie(), analysis.mutable_go_http2_probes());
+  }
+
+  return analysis;
 }
 
 Status UProbeManager::UpdateOpenSSLSymAddrs(obj_tools::RawFptrManager* fptr_manager,
@@ -174,11 +307,8 @@ Status UProbeManager::UpdateOpenSSLSymAddrs(obj_tools::RawFptrManager* fptr_mana
   return Status::OK();
 }
 
-Status UProbeManager::UpdateGoCommonSymAddrs(ElfReader* elf_reader, DwarfReader* dwarf_reader,
+Status UProbeManager::UpdateGoCommonSymAddrs(const struct go_common_symaddrs_t& symaddrs,
                                              const std::vector<int32_t>& pids) {
-  PX_ASSIGN_OR_RETURN(struct go_common_symaddrs_t symaddrs,
-                      GoCommonSymAddrs(elf_reader, dwarf_reader));
-
   for (auto& pid : pids) {
     PX_RETURN_IF_ERROR(go_common_symaddrs_map_->SetValue(pid, symaddrs));
   }
@@ -186,11 +316,8 @@ Status UProbeManager::UpdateGoCommonSymAddrs(ElfReader* elf_reader, DwarfReader*
   return Status::OK();
 }
 
-Status UProbeManager::UpdateGoHTTP2SymAddrs(ElfReader* elf_reader, DwarfReader* dwarf_reader,
+Status UProbeManager::UpdateGoHTTP2SymAddrs(const struct go_http2_symaddrs_t& symaddrs,
                                             const std::vector<int32_t>& pids) {
-  PX_ASSIGN_OR_RETURN(struct go_http2_symaddrs_t symaddrs,
-                      GoHTTP2SymAddrs(elf_reader, dwarf_reader));
-
   for (auto& pid : pids) {
     PX_RETURN_IF_ERROR(go_http2_symaddrs_map_->SetValue(pid, symaddrs));
   }
@@ -198,10 +325,8 @@ Status UProbeManager::UpdateGoHTTP2SymAddrs(ElfReader* elf_reader, DwarfReader*
   return Status::OK();
 }
 
-Status UProbeManager::UpdateGoTLSSymAddrs(ElfReader* elf_reader, DwarfReader* dwarf_reader,
+Status UProbeManager::UpdateGoTLSSymAddrs(const struct go_tls_symaddrs_t& symaddrs,
                                           const std::vector<int32_t>& pids) {
-  PX_ASSIGN_OR_RETURN(struct go_tls_symaddrs_t symaddrs, GoTLSSymAddrs(elf_reader, dwarf_reader));
-
   for (auto& pid : pids) {
     PX_RETURN_IF_ERROR(go_tls_symaddrs_map_->SetValue(pid, symaddrs));
   }
@@ -523,12 +648,12 @@ StatusOr<int> UProbeManager::AttachNodeJsOpenSSLUprobes(const uint32_t pid,
 }
 
 StatusOr<int> UProbeManager::AttachGoTLSUProbes(const std::string& binary,
-                                                obj_tools::ElfReader* elf_reader,
-                                                obj_tools::DwarfReader* dwarf_reader,
+                                                const sockeventpb::GoBinaryAnalysis& analysis,
                                                 const std::vector<int32_t>& pids) {
   // Step 1: Update BPF symbols_map on all new PIDs.
-  Status s = UpdateGoTLSSymAddrs(elf_reader, dwarf_reader, pids);
-  if (!s.ok()) {
+  std::optional<struct go_tls_symaddrs_t> symaddrs =
+      SymAddrsFromBytes<struct go_tls_symaddrs_t>(analysis.go_tls_symaddrs());
+  if (!symaddrs.has_value() || !UpdateGoTLSSymAddrs(symaddrs.value(), pids).ok()) {
     // Doesn't appear to be a binary with the mandatory symbols.
     // Might not even be a golang binary.
     // Either way, not of interest to probe.
@@ -541,16 +666,16 @@ StatusOr<int> UProbeManager::AttachGoTLSUProbes(const std::string& binary,
     // This is not a new binary, so nothing more to do.
     return 0;
   }
-  return AttachUProbeTmpl(kGoTLSUProbeTmpls, binary, elf_reader);
+  return AttachUProbes(binary, analysis.go_tls_probes());
 }
 
 StatusOr<int> UProbeManager::AttachGoHTTP2UProbes(const std::string& binary,
-                                                  obj_tools::ElfReader* elf_reader,
-                                                  obj_tools::DwarfReader* dwarf_reader,
+                                                  const sockeventpb::GoBinaryAnalysis& analysis,
                                                   const std::vector<int32_t>& pids) {
   // Step 1: Update BPF symaddrs for this binary.
-  Status s = UpdateGoHTTP2SymAddrs(elf_reader, dwarf_reader, pids);
-  if (!s.ok()) {
+  std::optional<struct go_http2_symaddrs_t> symaddrs =
+      SymAddrsFromBytes<struct go_http2_symaddrs_t>(analysis.go_http2_symaddrs());
+  if (!symaddrs.has_value() || !UpdateGoHTTP2SymAddrs(symaddrs.value(), pids).ok()) {
     return 0;
   }
 
@@ -560,7 +685,7 @@ StatusOr<int> UProbeManager::AttachGoHTTP2UProbes(const std::string& binary,
     // This is not a new binary, so nothing more to do.
     return 0;
   }
-  return AttachUProbeTmpl(kHTTP2ProbeTmpls, binary, elf_reader);
+  return AttachUProbes(binary, analysis.go_http2_probes());
 }
 
 namespace {
@@ -834,12 +959,35 @@ int UProbeManager::DeployGrpcCUProbes(const absl::flat_hash_set<md::UPID>& pids)
   return uprobe_count;
 }
 
-int UProbeManager::DeployGoUProbes(const absl::flat_hash_set<md::UPID>& pids) {
-  int uprobe_count = 0;
+namespace {
+
+// Calls fn on each index in [0, num_items), on up to --stirling_uprobe_deploy_threads threads.
+void RunOnWorkers(size_t num_items, const std::function<void(size_t)>& fn) {
+  const size_t num_threads = std::min<size_t>(
+      std::max<uint32_t>(FLAGS_stirling_uprobe_deploy_threads, 1), num_items);
+  std::atomic<size_t> next_item = 0;
+  std::vector<std::thread> workers;
+  workers.reserve(num_threads);
+  for (size_t i = 0; i < num_threads; ++i) {
+    workers.emplace_back([&next_item, num_items, &fn]() {
+      for (size_t item = next_item++; item < num_items; item = next_item++) {
+        fn(item);
+      }
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+}
+
+}  // namespace
 
+std::vector<UProbeManager::GoBinaryToProbe> UProbeManager::FindGoBinariesToProbe(
+    const absl::flat_hash_set<md::UPID>& pids) {
   static int32_t kPID = getpid();
 
-  for (const auto& [binary, pid_vec] : ConvertPIDsListToMap(pids)) {
+  std::vector<GoBinaryToProbe> binaries;
+  for (auto& [binary, pid_vec] : ConvertPIDsListToMap(pids)) {
     std::filesystem::path binary_path(binary);
     auto binary_filepath = binary_path.filename().string();
     if (uprobe_opt_out_.contains(binary_filepath)) {
@@ -859,46 +1007,129 @@ int UProbeManager::DeployGoUProbes(const absl::flat_hash_set<md::UPID>& pids) {
       }
     }
 
-    // Read binary's symbols.
-    StatusOr<std::unique_ptr<ElfReader>> elf_reader_status = ElfReader::Create(binary);
+    GoBinaryToProbe& to_probe = binaries.emplace_back();
+    to_probe.binary = binary;
+    to_probe.pids = std::move(pid_vec);
+  }
+  return binaries;
+}
+
+void UProbeManager::AnalyzeGoBinaries(std::vector<GoBinaryToProbe>* binaries) {
+  // Stage 1: Read the ELF headers, to find the Go binaries and their cache keys.
+  RunOnWorkers(binaries->size(), [binaries](size_t i) {
+    GoBinaryToProbe& to_probe = (*binaries)[i];
+    StatusOr<std::unique_ptr<ElfReader>> elf_reader_status = ElfReader::Create(to_probe.binary);
     if (!elf_reader_status.ok()) {
       LOG(WARNING) << absl::Substitute(
           "Cannot analyze binary $0 for uprobe deployment. "
           "If file is under /var/lib, container may have terminated. "
           "Message = $1",
-          binary, elf_reader_status.msg());
-      continue;
+          to_probe.binary, elf_reader_status.msg());
+      return;
     }
     std::unique_ptr<ElfReader> elf_reader = elf_reader_status.ConsumeValueOrDie();
 
     // Avoid going past this point if not a golang program.
     // The DwarfReader is memory intensive, and the remaining probes are Golang specific.
     if (!IsGoExecutable(elf_reader.get())) {
+      return;
+    }
+    to_probe.is_go = true;
+
+    StatusOr<std::string> cache_key = elf_reader->Identity();
+    if (cache_key.ok()) {
+      to_probe.cache_key = cache_key.ConsumeValueOrDie();
+    }
+  });
+
+  // Stage 2: Look up the cache, and pick one binary to analyze per cache key, since instances of
+  // the same binary in different containers have different paths.
+  std::vector<size_t> to_analyze;
+  absl::flat_hash_map<std::string, size_t> analyzed_key_idx;
+  for (size_t i = 0; i < binaries->size(); ++i) {
+    GoBinaryToProbe& to_probe = (*binaries)[i];
+    if (!to_probe.is_go) {
       continue;
     }
+    if (to_probe.cache_key.empty()) {
+      to_analyze.push_back(i);
+      continue;
+    }
+    to_probe.analysis = go_binary_analysis_cache_->Lookup(to_probe.cache_key);
+    if (to_probe.analysis != nullptr) {
+      go_binary_cache_hits_counter_.Increment();
+      continue;
+    }
+    if (analyzed_key_idx.try_emplace(to_probe.cache_key, i).second) {
+      to_analyze.push_back(i);
+    }
+  }
+
+  // Stage 3: Read the DWARF info of the binaries that were not in the cache.
+  std::vector<StatusOr<sockeventpb::GoBinaryAnalysis>> results(to_analyze.size());
+  RunOnWorkers(to_analyze.size(), [this, binaries, &to_analyze, &results](size_t i) {
+    const std::string& binary = (*binaries)[to_analyze[i]].binary;
+    StatusOr<std::unique_ptr<ElfReader>> elf_reader = ElfReader::Create(binary);
+    if (!elf_reader.ok()) {
+      results[i] = elf_reader.status();
+      return;
+    }
+    results[i] = AnalyzeGoBinary(binary, elf_reader.ValueOrDie().get());
+  });
+  go_binaries_analyzed_counter_.Increment(to_analyze.size());
 
-    StatusOr<std::unique_ptr<DwarfReader>> dwarf_reader_status =
-        DwarfReader::CreateIndexingAll(binary);
-    if (!dwarf_reader_status.ok()) {
+  // Stage 4: Add the results to the cache.
+  for (size_t i = 0; i < to_analyze.size(); ++i) {
+    GoBinaryToProbe& to_probe = (*binaries)[to_analyze[i]];
+    if (!results[i].ok()) {
       VLOG(1) << absl::Substitute(
           "Failed to get binary $0 debug symbols. Cannot deploy uprobes. "
           "Message = $1",
-          binary, dwarf_reader_status.msg());
+          to_probe.binary, results[i].msg());
       continue;
     }
-    std::unique_ptr<DwarfReader> dwarf_reader = dwarf_reader_status.ConsumeValueOrDie();
-    Status s = UpdateGoCommonSymAddrs(elf_reader.get(), dwarf_reader.get(), pid_vec);
-    if (!s.ok()) {
+    if (to_probe.cache_key.empty()) {
+      to_probe.uncached_analysis = results[i].ConsumeValueOrDie();
+      to_probe.analysis = &to_probe.uncached_analysis;
+    } else {
+      to_probe.analysis =
+          go_binary_analysis_cache_->Insert(to_probe.cache_key, results[i].ConsumeValueOrDie());
+    }
+  }
+  // The other instances of the analyzed binaries.
+  for (auto& to_probe : *binaries) {
+    if (to_probe.analysis == nullptr && !to_probe.cache_key.empty()) {
+      to_probe.analysis = go_binary_analysis_cache_->Lookup(to_probe.cache_key);
+    }
+  }
+}
+
+int UProbeManager::AttachGoUProbes(const std::vector<GoBinaryToProbe>& binaries) {
+  int uprobe_count = 0;
+
+  std::vector<const GoBinaryToProbe*> probed_binaries;
+  for (const auto& to_probe : binaries) {
+    if (to_probe.analysis == nullptr) {
+      continue;
+    }
+    std::optional<struct go_common_symaddrs_t> go_common_symaddrs =
+        SymAddrsFromBytes<struct go_common_symaddrs_t>(to_probe.analysis->go_common_symaddrs());
+    if (!go_common_symaddrs.has_value() ||
+        !UpdateGoCommonSymAddrs(go_common_symaddrs.value(), to_probe.pids).ok()) {
       VLOG(1) << absl::Substitute(
-          "Golang binary $0 does not have the mandatory symbols (e.g. TCPConn).", binary);
+          "Golang binary $0 does not have the mandatory symbols (e.g. TCPConn).", to_probe.binary);
       continue;
     }
+    probed_binaries.push_back(&to_probe);
+  }
 
-    // GoTLS Probes.
-    if (!cfg_disable_go_tls_tracing_) {
+  // The GoTLS probes of all binaries are attached before any HTTP2 probes, because encrypted
+  // traffic can't be traced any other way.
+  if (!cfg_disable_go_tls_tracing_) {
+    for (const GoBinaryToProbe* to_probe : probed_binaries) {
+      const std::string& binary = to_probe->binary;
       VLOG(1) << absl::Substitute("Attempting to attach Go TLS uprobes to binary $0", binary);
-      StatusOr<int> attach_status =
-          AttachGoTLSUProbes(binary, elf_reader.get(), dwarf_reader.get(), pid_vec);
+      StatusOr<int> attach_status = AttachGoTLSUProbes(binary, *to_probe->analysis, to_probe->pids);
       if (!attach_status.ok()) {
         monitor_.AppendSourceStatusRecord("socket_tracer", attach_status.status(),
                                           "AttachGoTLSUProbes");
@@ -908,11 +1139,14 @@ int UProbeManager::DeployGoUProbes(const absl::flat_hash_set<md::UPID>& pids) {
         uprobe_count += attach_status.ValueOrDie();
       }
     }
+  }
 
-    // Go HTTP2 Probes.
-    if (!cfg_disable_go_tls_tracing_ && cfg_enable_http2_tracing_) {
+  // Go HTTP2 Probes.
+  if (!cfg_disable_go_tls_tracing_ && cfg_enable_http2_tracing_) {
+    for (const GoBinaryToProbe* to_probe : probed_binaries) {
+      const std::string& binary = to_probe->binary;
       StatusOr<int> attach_status =
-          AttachGoHTTP2UProbes(binary, elf_reader.get(), dwarf_reader.get(), pid_vec);
+          AttachGoHTTP2UProbes(binary, *to_probe->analysis, to_probe->pids);
       if (!attach_status.ok()) {
         monitor_.AppendSourceStatusRecord("socket_tracer", attach_status.status(),
                                           "AttachGoHTTP2UProbes");
@@ -927,6 +1161,12 @@ int UProbeManager::DeployGoUProbes(const absl::flat_hash_set<md::UPID>& pids) {
   return uprobe_count;
 }
 
+int UProbeManager::DeployGoUProbes(const absl::flat_hash_set<md::UPID>& pids) {
+  std::vector<GoBinaryToProbe> binaries = FindGoBinariesToProbe(pids);
+  AnalyzeGoBinaries(&binaries);
+  return AttachGoUProbes(binaries);
+}
+
 absl::flat_hash_set<md::UPID> UProbeManager::PIDsToRescanForUProbes() {
   // Count number of calls to this function.
   ++rescan_counter_;
@@ -994,10 +1234,24 @@ void UProbeManager::DeployUProbes(const absl::flat_hash_set<md::UPID>& pids) {
 
   int uprobe_count = 0;
 
+  // The Go binaries are analyzed on worker threads, while the OpenSSL probes are attached on this
+  // thread, so that TLS libraries get probed without waiting for the DWARF analysis.
+  // The BCC attach calls all stay on this thread.
+  std::vector<GoBinaryToProbe> go_binaries = FindGoBinariesToProbe(proc_tracker_.new_upids());
+  std::thread go_analysis_thread([this, &go_binaries]() {
+    auto start = std::chrono::steady_clock::now();
+    AnalyzeGoBinaries(&go_binaries);
+    RecordStageTime("go_analysis", start);
+  });
+
+  auto start = std::chrono::steady_clock::now();
   uprobe_count += DeployOpenSSLUProbes(proc_tracker_.new_upids());
+  RecordStageTime("openssl_attach", start);
 
   if (FLAGS_stirling_enable_grpc_c_tracing && KernelVersionAllowsGRPCCTracing()) {
+    start = std::chrono::steady_clock::now();
     uprobe_count += DeployGrpcCUProbes(proc_tracker_.new_upids());
+    RecordStageTime("grpc_c_attach", start);
   }
 
   if (FLAGS_stirling_rescan_for_dlopen) {
@@ -1008,7 +1262,10 @@ void UProbeManager::DeployUProbes(const absl::flat_hash_set<md::UPID>& pids) {
     }
   }
 
-  uprobe_count += DeployGoUProbes(proc_tracker_.new_upids());
+  go_analysis_thread.join();
+  start = std::chrono::steady_clock::now();
+  uprobe_count += AttachGoUProbes(go_binaries);
+  RecordStageTime("go_attach", start);
 
   if (uprobe_count != 0) {
     LOG(INFO) << absl::Substitute("Number of uprobes deployed = $0", uprobe_count);
@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <map>
 #include <memory>
 #include <string>
@@ -26,6 +27,7 @@
 
 #include <absl/synchronization/mutex.h>
 
+#include "src/common/metrics/metrics.h"
 #include "src/common/system/proc_parser.h"
 #include "src/stirling/bpf_tools/bcc_wrapper.h"
 #include "src/stirling/obj_tools/dwarf_reader.h"
@@ -37,6 +39,7 @@
 #include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/symaddrs.h"
 
 #include "src/stirling/source_connectors/socket_tracer/uprobe_symaddrs.h"
+#include "src/stirling/source_connectors/socket_tracer/uprobe_symaddrs_cache.h"
 #include "src/stirling/utils/detect_application.h"
 #include "src/stirling/utils/monitor.h"
 #include "src/stirling/utils/proc_path_tools.h"
@@ -479,6 +482,44 @@ class UProbeManager {
    */
   int DeployGoUProbes(const absl::flat_hash_set<md::UPID>& pids);
 
+  // A binary of new processes, which may be a Go binary to probe.
+  struct GoBinaryToProbe {
+    std::string binary;
+    std::vector<int32_t> pids;
+    bool is_go = false;
+    // Empty if the binary's identity could not be determined, in which case it is not cached.
+    std::string cache_key;
+    // The analysis of the binary, or nullptr if it is not a Go binary or it could not be analyzed.
+    // Points into the cache, or to uncached_analysis.
+    const sockeventpb::GoBinaryAnalysis* analysis = nullptr;
+    sockeventpb::GoBinaryAnalysis uncached_analysis;
+  };
+
+  /**
+   * Returns the binaries of the new processes that have not been scanned before, grouped with
+   * their PIDs. DeployGoUProbes() is split into this, AnalyzeGoBinaries() and AttachGoUProbes(),
+   * so that DeployUProbes() can analyze the binaries while it attaches other probes.
+   */
+  std::vector<GoBinaryToProbe> FindGoBinariesToProbe(const absl::flat_hash_set<md::UPID>& pids);
+
+  /**
+   * Fills in the analysis of the Go binaries, from the cache or by reading their DWARF info.
+   * The binaries are read on a pool of --stirling_uprobe_deploy_threads threads, and binaries with
+   * the same cache key are only read once. Doesn't touch BCC, so it can run concurrently with
+   * the attaching of other probes.
+   */
+  void AnalyzeGoBinaries(std::vector<GoBinaryToProbe>* binaries);
+
+  /**
+   * Updates the symaddrs BPF maps and attaches the probes of the analyzed Go binaries.
+   * The GoTLS probes of all binaries are attached first, then the HTTP2 probes.
+   * @return Number of uprobes deployed.
+   */
+  int AttachGoUProbes(const std::vector<GoBinaryToProbe>& binaries);
+
+  // Adds the time since start to the uprobe_deploy_stage_seconds metric of the stage.
+  void RecordStageTime(std::string_view stage, std::chrono::steady_clock::time_point start);
+
   /**
    * Sets up the BPF maps used for GOID tracking. Required for general Go tracing.
    *
@@ -492,16 +533,15 @@ class UProbeManager {
    * compatible Go binary.
    *
    * @param binary The path to the binary on which to deploy Go HTTP2 probes.
-   * @param elf_reader ELF reader for the binary.
-   * @param dwarf_reader DWARF reader for the binary.
+   * @param analysis The symaddrs and probe attach points of the binary.
    * @param pids The list of PIDs that are new instances of the binary. Used to populate symbol
    *             addresses.
    * @return The number of uprobes deployed, or error. It is not considered an error if the binary
    *         is not a Go binary or doesn't use a Go HTTP2 library; instead the return value will be
    *         zero.
    */
-  StatusOr<int> AttachGoHTTP2UProbes(const std::string& binary, obj_tools::ElfReader* elf_reader,
-                                     obj_tools::DwarfReader* dwarf_reader,
+  StatusOr<int> AttachGoHTTP2UProbes(const std::string& binary,
+                                     const sockeventpb::GoBinaryAnalysis& analysis,
                                      const std::vector<int32_t>& pids);
 
   /**
@@ -509,17 +549,25 @@ class UProbeManager {
    * Go binary.
    *
    * @param binary The path to the binary on which to deploy Go HTTP2 probes.
-   * @param elf_reader ELF reader for the binary.
-   * @param dwarf_reader DWARF reader for the binary.
+   * @param analysis The symaddrs and probe attach points of the binary.
    * @param pids The list of PIDs that are new instances of the binary. Used to populate symbol
    *             addresses.
    * @return The number of uprobes deployed, or error. It is not an error if the binary
    *         is not a Go binary or doesn't use Go TLS; instead the return value will be zero.
    */
-  StatusOr<int> AttachGoTLSUProbes(const std::string& binary, obj_tools::ElfReader* elf_reader,
-                                   obj_tools::DwarfReader* dwarf_reader,
+  StatusOr<int> AttachGoTLSUProbes(const std::string& binary,
+                                   const sockeventpb::GoBinaryAnalysis& analysis,
                                    const std::vector<int32_t>& new_pids);
 
+  /**
+   * Reads the DWARF info of a Go binary, to find the symaddrs and the probe attach points that
+   * the Go probes need. Symaddrs that are not found are left empty in the result.
+   *
+   * @return The analysis, or error if the debug symbols could not be read.
+   */
+  StatusOr<sockeventpb::GoBinaryAnalysis> AnalyzeGoBinary(const std::string& binary,
+                                                          obj_tools::ElfReader* elf_reader);
+
   /**
    * Attaches the required probes for OpenSSL tracing to the specified PID, if it uses OpenSSL.
    *
@@ -574,18 +622,32 @@ class UProbeManager {
   StatusOr<int> AttachUProbeTmpl(const ArrayView<UProbeTmpl>& probe_tmpls,
                                  const std::string& binary, obj_tools::ElfReader* elf_reader);
 
+  /**
+   * Finds the symbol matches of the probe templates, and returns a probe spec per match, without
+   * attaching them.
+   */
+  StatusOr<std::vector<bpf_tools::UProbeSpec>> ResolveUProbeTmpl(
+      const ArrayView<UProbeTmpl>& probe_tmpls, const std::string& binary,
+      obj_tools::ElfReader* elf_reader);
+
+  /**
+   * Attaches probes to the binary at previously resolved attach points.
+   * @return Number of uprobes deployed, or error if uprobes failed to deploy.
+   */
+  StatusOr<int> AttachUProbes(
+      const std::string& binary,
+      const google::protobuf::RepeatedPtrField<sockeventpb::UProbeAttachPoint>& attach_points);
+
   // Returns set of PIDs that have had mmap called on them since the last call.
   absl::flat_hash_set<md::UPID> PIDsToRescanForUProbes();
 
   Status UpdateOpenSSLSymAddrs(px::stirling::obj_tools::RawFptrManager* fptrManager,
                                std::filesystem::path container_lib, uint32_t pid);
-  Status UpdateGoCommonSymAddrs(obj_tools::ElfReader* elf_reader,
-                                obj_tools::DwarfReader* dwarf_reader,
+  Status UpdateGoCommonSymAddrs(const struct go_common_symaddrs_t& symaddrs,
                                 const std::vector<int32_t>& pids);
-  Status UpdateGoHTTP2SymAddrs(obj_tools::ElfReader* elf_reader,
-                               obj_tools::DwarfReader* dwarf_reader,
+  Status UpdateGoHTTP2SymAddrs(const struct go_http2_symaddrs_t& symaddrs,
                                const std::vector<int32_t>& pids);
-  Status UpdateGoTLSSymAddrs(obj_tools::ElfReader* elf_reader, obj_tools::DwarfReader* dwarf_reader,
+  Status UpdateGoTLSSymAddrs(const struct go_tls_symaddrs_t& symaddrs,
                              const std::vector<int32_t>& pids);
   Status UpdateNodeTLSWrapSymAddrs(int32_t pid, const std::filesystem::path& node_exe,
                                    const SemVer& ver);
@@ -636,6 +698,10 @@ class UProbeManager {
   absl::flat_hash_set<std::string> nodejs_binaries_;
   absl::flat_hash_set<std::string> grpc_c_probed_binaries_;
 
+  // The analysis of the Go binaries, keyed by binary identity rather than path, and optionally
+  // persisted across restarts.
+  std::unique_ptr<GoBinaryAnalysisCache> go_binary_analysis_cache_;
+
   // BPF maps through which the addresses of symbols for a given pid are communicated to uprobes.
   std::unique_ptr<MapT<ssl_source_t>> openssl_source_map_;
   std::unique_ptr<MapT<struct openssl_symaddrs_t>> openssl_symaddrs_map_;
@@ -646,6 +712,10 @@ class UProbeManager {
   // Key is python gRPC module's md5 hash, value is the corresponding version enum's numeric value.
   std::unique_ptr<MapT<uint64_t>> grpc_c_versions_map_;
 
+  prometheus::Family<prometheus::Counter>& deploy_stage_seconds_family_;
+  prometheus::Counter& go_binaries_analyzed_counter_;
+  prometheus::Counter& go_binary_cache_hits_counter_;
+
   const system::Config& syscfg_ = system::Config::GetInstance();
   StirlingMonitor& monitor_ = *StirlingMonitor::GetInstance();
 };
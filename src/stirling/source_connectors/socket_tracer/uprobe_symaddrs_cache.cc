@@ -0,0 +1,98 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/uprobe_symaddrs_cache.h"
+
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include <absl/strings/str_replace.h>
+
+#include "src/common/base/file.h"
+#include "src/common/fs/fs_wrapper.h"
+
+namespace px {
+namespace stirling {
+
+GoBinaryAnalysisCache::GoBinaryAnalysisCache(std::filesystem::path dir) : dir_(std::move(dir)) {
+  if (dir_.empty()) {
+    return;
+  }
+  Status s = fs::CreateDirectories(dir_);
+  if (!s.ok()) {
+    LOG(WARNING) << absl::Substitute(
+        "Could not create uprobe cache directory $0, entries will only be kept in memory: $1",
+        dir_.string(), s.msg());
+    dir_.clear();
+  }
+}
+
+std::filesystem::path GoBinaryAnalysisCache::EntryPath(const std::string& key) const {
+  // Go build IDs are '/' separated.
+  return dir_ / absl::StrCat(absl::StrReplaceAll(key, {{"/", "_"}}), ".pb");
+}
+
+const sockeventpb::GoBinaryAnalysis* GoBinaryAnalysisCache::Lookup(const std::string& key) {
+  auto iter = entries_.find(key);
+  if (iter != entries_.end()) {
+    return &iter->second;
+  }
+  if (dir_.empty()) {
+    return nullptr;
+  }
+
+  const std::filesystem::path path = EntryPath(key);
+  if (!fs::Exists(path)) {
+    return nullptr;
+  }
+  PX_ASSIGN_OR(std::string contents,
+               ReadFileToString(path, std::ios_base::in | std::ios_base::binary), return nullptr);
+  sockeventpb::GoBinaryAnalysis analysis;
+  if (!analysis.ParseFromString(contents) || analysis.version() != kVersion) {
+    VLOG(1) << absl::Substitute("Ignoring stale or corrupt uprobe cache entry $0", path.string());
+    return nullptr;
+  }
+  VLOG(1) << absl::Substitute("Loaded uprobe cache entry $0", path.string());
+  return &entries_.insert_or_assign(key, std::move(analysis)).first->second;
+}
+
+const sockeventpb::GoBinaryAnalysis* GoBinaryAnalysisCache::Insert(
+    const std::string& key, sockeventpb::GoBinaryAnalysis analysis) {
+  analysis.set_version(kVersion);
+  if (!dir_.empty()) {
+    // Write to a temporary file first, so that a concurrent reader never sees a partial entry.
+    const std::filesystem::path path = EntryPath(key);
+    std::filesystem::path tmp_path = path;
+    tmp_path += ".tmp";
+    Status s = WriteFileFromString(tmp_path, analysis.SerializeAsString(),
+                                   std::ios_base::out | std::ios_base::binary);
+    std::error_code ec;
+    if (s.ok()) {
+      std::filesystem::rename(tmp_path, path, ec);
+    }
+    if (!s.ok() || ec) {
+      LOG(WARNING) << absl::Substitute("Failed to persist uprobe cache entry $0: $1",
+                                       path.string(), s.ok() ? ec.message() : s.msg());
+    }
+  }
+  return &entries_.insert_or_assign(key, std::move(analysis)).first->second;
+}
+
+}  // namespace stirling
+}  // namespace px
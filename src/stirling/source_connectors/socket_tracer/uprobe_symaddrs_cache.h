@@ -0,0 +1,100 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <initializer_list>
+#include <string>
+
+#include <absl/container/node_hash_map.h>
+
+#include "src/common/base/base.h"
+#include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/symaddrs.h"
+#include "src/stirling/source_connectors/socket_tracer/proto/uprobe_cache.pb.h"
+
+namespace px {
+namespace stirling {
+
+namespace internal {
+
+// Hashes the values with FNV-1a, so that the result is the same in every build.
+constexpr uint32_t HashLayout(std::initializer_list<size_t> values) {
+  uint32_t hash = 2166136261u;
+  for (size_t value : values) {
+    for (int i = 0; i < 8; ++i) {
+      hash ^= static_cast<uint8_t>(value >> (8 * i));
+      hash *= 16777619u;
+    }
+  }
+  return hash;
+}
+
+}  // namespace internal
+
+/**
+ * Caches the analysis of Go binaries for uprobe deployment: the symaddrs for the BPF maps, and the
+ * addresses at which the uprobes are attached. Entries are keyed by ElfReader::Identity() rather
+ * than by path, so that instances of the same binary in different containers share an entry.
+ *
+ * If a directory is provided, entries are also persisted to it, so that they survive restarts.
+ * Reading the DWARF info of a large Go binary can take seconds, while an entry is a few KB.
+ */
+class GoBinaryAnalysisCache {
+ public:
+  // Bump this when the symaddrs structs change without changing their sizes (e.g. reordered
+  // fields), or when the Go probe templates change.
+  static constexpr uint32_t kRevision = 1;
+
+  // The version of the entries, which is derived from the layout of the symaddrs structs whose raw
+  // bytes are cached, so that entries of another layout are never loaded.
+  static constexpr uint32_t kVersion =
+      internal::HashLayout({kRevision, sizeof(struct go_common_symaddrs_t),
+                            sizeof(struct go_tls_symaddrs_t), sizeof(struct go_http2_symaddrs_t)});
+
+  /**
+   * @param dir The directory in which entries are persisted. If empty, entries are only kept in
+   *            memory.
+   */
+  explicit GoBinaryAnalysisCache(std::filesystem::path dir = {});
+
+  /**
+   * Returns the cached analysis of the binary with the key, looking in the directory if it is not
+   * in memory. Returns nullptr on a miss, or if the entry is of an older version.
+   * The returned pointers stay valid for the lifetime of the cache.
+   */
+  const sockeventpb::GoBinaryAnalysis* Lookup(const std::string& key);
+
+  /**
+   * Adds the analysis of a binary to the cache, and returns the cached copy. Failures to persist
+   * the entry are only logged.
+   */
+  const sockeventpb::GoBinaryAnalysis* Insert(const std::string& key,
+                                              sockeventpb::GoBinaryAnalysis analysis);
+
+  size_t size() const { return entries_.size(); }
+
+ private:
+  std::filesystem::path EntryPath(const std::string& key) const;
+
+  std::filesystem::path dir_;
+  absl::node_hash_map<std::string, sockeventpb::GoBinaryAnalysis> entries_;
+};
+
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/uprobe_symaddrs_cache.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "src/common/base/file.h"
+#include "src/common/testing/temp_dir.h"
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace stirling {
+
+using ::px::testing::TempDir;
+
+TEST(GoBinaryAnalysisCacheTest, PersistsEntries) {
+  TempDir tmp_dir;
+
+  sockeventpb::GoBinaryAnalysis analysis;
+  analysis.set_go_common_symaddrs("abc");
+  analysis.add_go_tls_probes()->set_symbol("crypto/tls.(*Conn).Write");
+
+  {
+    GoBinaryAnalysisCache cache(tmp_dir.path());
+    EXPECT_EQ(cache.Lookup("build-id:1234"), nullptr);
+    cache.Insert("build-id:1234", analysis);
+    EXPECT_NE(cache.Lookup("build-id:1234"), nullptr);
+  }
+
+  // A new cache, as after a restart, finds the entry in the directory.
+  GoBinaryAnalysisCache cache(tmp_dir.path());
+  EXPECT_EQ(cache.size(), 0);
+  const sockeventpb::GoBinaryAnalysis* cached = cache.Lookup("build-id:1234");
+  ASSERT_NE(cached, nullptr);
+  EXPECT_EQ(cached->go_common_symaddrs(), "abc");
+  ASSERT_EQ(cached->go_tls_probes_size(), 1);
+  EXPECT_EQ(cached->go_tls_probes(0).symbol(), "crypto/tls.(*Conn).Write");
+  EXPECT_EQ(cache.Lookup("build-id:5678"), nullptr);
+}
+
+TEST(GoBinaryAnalysisCacheTest, IgnoresOldVersions) {
+  TempDir tmp_dir;
+
+  sockeventpb::GoBinaryAnalysis analysis;
+  analysis.set_version(GoBinaryAnalysisCache::kVersion - 1);
+  ASSERT_OK(WriteFileFromString(tmp_dir.path() / "build-id:1234.pb", analysis.SerializeAsString()));
+
+  GoBinaryAnalysisCache cache(tmp_dir.path());
+  EXPECT_EQ(cache.Lookup("build-id:1234"), nullptr);
+}
+
+TEST(GoBinaryAnalysisCacheTest, VersionFollowsLayout) {
+  EXPECT_EQ(GoBinaryAnalysisCache::kVersion,
+            internal::HashLayout({GoBinaryAnalysisCache::kRevision,
+                                  sizeof(struct go_common_symaddrs_t),
+                                  sizeof(struct go_tls_symaddrs_t),
+                                  sizeof(struct go_http2_symaddrs_t)}));
+  // A struct that grows by a field changes the version.
+  EXPECT_NE(GoBinaryAnalysisCache::kVersion,
+            internal::HashLayout({GoBinaryAnalysisCache::kRevision,
+                                  sizeof(struct go_common_symaddrs_t) + sizeof(int32_t),
+                                  sizeof(struct go_tls_symaddrs_t),
+                                  sizeof(struct go_http2_symaddrs_t)}));
+}
+
+TEST(GoBinaryAnalysisCacheTest, MemoryOnly) {
+  GoBinaryAnalysisCache cache;
+  cache.Insert("inode:1:2:3:4.5", sockeventpb::GoBinaryAnalysis());
+  EXPECT_NE(cache.Lookup("inode:1:2:3:4.5"), nullptr);
+}
+
+}  // namespace stirling
+}  // namespace px
@@ -21,8 +21,11 @@
 #include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <ctime>
 #include <functional>
+#include <iterator>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
 #include <utility>
@@ -37,6 +40,7 @@
 #include "src/stirling/utils/system_info.h"
 
 #include "src/stirling/bpf_tools/probe_cleaner.h"
+#include "src/stirling/core/connector_scheduler.h"
 #include "src/stirling/core/data_table.h"
 #include "src/stirling/core/pub_sub_manager.h"
 #include "src/stirling/core/source_connector.h"
@@ -65,6 +69,10 @@ DEFINE_string(stirling_sources, gflags::StringFromEnv("PL_STIRLING_SOURCES", "kP
               "Choose sources to enable. [kAll|kProd|kMetrics|kTracers|kProfiler|kTCPStats] or "
               "comma separated list of "
               "sources (find them the header files of source connector classes).");
+DEFINE_int32(stirling_connector_threads,
+             gflags::Int32FromEnv("PL_STIRLING_CONNECTOR_THREADS", 2),
+             "Number of worker threads that run the thread-safe source connectors. "
+             "With 0, all source connectors run on the main Stirling thread.");
 
 namespace px {
 namespace stirling {
@@ -220,6 +228,7 @@ class StirlingImpl final : public Stirling {
   void SetDebugLevel(int level);
   void EnablePIDTrace(int pid);
   void DisablePIDTrace(int pid);
+  void SetCaptureLimit(int protocol, uint32_t limit_bytes);
 
   void UpdateDynamicTraceStatus(const sole::uuid& uuid,
                                 const StatusOr<stirlingpb::Publish>& status);
@@ -242,6 +251,10 @@ class StirlingImpl final : public Stirling {
   // Main run implementation.
   void RunCore();
 
+  // Calls TransferData() and/or PushData() on the source, whichever is due, and records the
+  // source's lateness and CPU time. Returns the updated time "now".
+  time_point RunSource(SourceConnector* source, ConnectorContext* ctx, time_point now);
+
   // Computes the amount of time to sleep based on the next source connector that needs to wakeup.
   std::chrono::milliseconds TimeUntilNextTick(const time_point now);
 
@@ -260,6 +273,14 @@ class StirlingImpl final : public Stirling {
   // Lock to protect both info_class_mgrs_ and sources_.
   absl::base_internal::SpinLock info_class_mgrs_lock_;
 
+  // Runs the thread-safe sources off of the main thread. While a source has a task in flight,
+  // the worker thread owns the source's state, including its frequency managers.
+  // Declared after sources_, so that the workers are joined before the sources are destroyed.
+  std::unique_ptr<ConnectorScheduler> scheduler_;
+
+  // Serializes the calls to data_push_callback_, which need not be thread-safe.
+  std::mutex push_mutex_;
+
   std::unique_ptr<SourceRegistry> registry_;
 
   /**
@@ -307,6 +328,11 @@ enum class SignalOpCode {
   // Only the SocketTracer currently implements this, but in theory other source connectors
   // could enable PID traces as well.
   kPIDTrace = 2,
+
+  // Limit how many bytes of each read/write of a protocol the SocketTracer traces.
+  // The value packs the traffic_protocol_t in the top 8 bits and the limit in the lower 24 bits,
+  // and a limit of 0 removes the limit. See --stirling_socket_tracer_capture_limits.
+  kSetCaptureLimit = 3,
 };
 
 void ProcessSetDebugLevelOpcode(int level) {
@@ -325,6 +351,14 @@ void ProcessPIDTraceOpcode(int pid) {
   }
 }
 
+void ProcessSetCaptureLimitOpcode(int value) {
+  int protocol = static_cast<uint32_t>(value) >> 24;
+  uint32_t limit_bytes = static_cast<uint32_t>(value) & 0xffffff;
+  LOG(INFO) << absl::Substitute("Setting capture limit of protocol $0 to $1 bytes", protocol,
+                                limit_bytes);
+  g_stirling_ptr->SetCaptureLimit(protocol, limit_bytes);
+}
+
 // To multiplex different actions onto a single signal handler, Stirling uses a simple
 // opcode+value protocol. Stirling expects signals to arrive in pairs:
 //   signal 1: opcode - Chooses what action to perform.
@@ -363,6 +397,9 @@ void UserSignalHandler(int /* signum */, siginfo_t* info, void* /* context */) {
     case SignalOpCode::kPIDTrace:
       ProcessPIDTraceOpcode(value);
       break;
+    case SignalOpCode::kSetCaptureLimit:
+      ProcessSetCaptureLimitOpcode(value);
+      break;
     default:
       LOG(INFO) << absl::Substitute("Unexpected signal opcode: $0", value);
   }
@@ -371,7 +408,8 @@ void UserSignalHandler(int /* signum */, siginfo_t* info, void* /* context */) {
 }
 
 StirlingImpl::StirlingImpl(std::unique_ptr<SourceRegistry> registry)
-    : registry_(std::move(registry)) {}
+    : scheduler_(std::make_unique<ConnectorScheduler>(FLAGS_stirling_connector_threads)),
+      registry_(std::move(registry)) {}
 
 StirlingImpl::~StirlingImpl() { Stop(); }
 
@@ -449,30 +487,40 @@ Status StirlingImpl::AddSource(std::unique_ptr<SourceConnector> source) {
 }
 
 Status StirlingImpl::RemoveSource(std::string_view source_name) {
-  absl::base_internal::SpinLockHolder lock(&info_class_mgrs_lock_);
+  std::unique_ptr<SourceConnector> source;
+  InfoClassManagerVec source_info_class_mgrs;
+  {
+    absl::base_internal::SpinLockHolder lock(&info_class_mgrs_lock_);
 
-  // Find the source.
-  auto source_iter = std::find_if(sources_.begin(), sources_.end(),
-                                  [&source_name](const std::unique_ptr<SourceConnector>& s) {
-                                    return s->name() == source_name;
-                                  });
-  if (source_iter == sources_.end()) {
-    return error::Internal("RemoveSource(): could not find source with name=$0", source_name);
+    // Find the source.
+    auto source_iter = std::find_if(sources_.begin(), sources_.end(),
+                                    [&source_name](const std::unique_ptr<SourceConnector>& s) {
+                                      return s->name() == source_name;
+                                    });
+    if (source_iter == sources_.end()) {
+      return error::Internal("RemoveSource(): could not find source with name=$0", source_name);
+    }
+    source = std::move(*source_iter);
+    sources_.erase(source_iter);
+
+    // Take out all info class managers that point back to the source. They own the data tables
+    // of the source, so they are kept alive until its in-flight work completes.
+    auto mgrs_iter = std::stable_partition(
+        info_class_mgrs_.begin(), info_class_mgrs_.end(),
+        [&source](const std::unique_ptr<InfoClassManager>& mgr) {
+          return mgr->source() != source.get();
+        });
+    std::move(mgrs_iter, info_class_mgrs_.end(), std::back_inserter(source_info_class_mgrs));
+    info_class_mgrs_.erase(mgrs_iter, info_class_mgrs_.end());
   }
-  std::unique_ptr<SourceConnector>& source = *source_iter;
 
-  // Remove all info class managers that point back to the source.
-  info_class_mgrs_.erase(std::remove_if(info_class_mgrs_.begin(), info_class_mgrs_.end(),
-                                        [&source](std::unique_ptr<InfoClassManager>& mgr) {
-                                          return mgr->source() == source.get();
-                                        }),
-                         info_class_mgrs_.end());
+  // The main loop no longer sees the source, so once its in-flight work completes, nothing else
+  // touches the source or its data tables. The wait happens outside of the spin lock, so that the
+  // main loop keeps running the other sources meanwhile.
+  scheduler_->WaitForIdle(source.get());
 
   // Now perform the removal.
-  PX_RETURN_IF_ERROR(source->Stop());
-  sources_.erase(source_iter);
-
-  return Status::OK();
+  return source->Stop();
 }
 
 // Returns, but updates the status map in a concurrent-safe way before doing so.
@@ -742,6 +790,10 @@ std::chrono::milliseconds StirlingImpl::TimeUntilNextTick(const time_point now)
   constexpr std::chrono::milliseconds kMaxSleepDuration{1000};
   auto wakeup_time = now + kMaxSleepDuration;
   for (const auto& source : sources_) {
+    // A source with work in flight wakes us up through the scheduler when it completes.
+    if (scheduler_->InFlight(source.get())) {
+      continue;
+    }
     wakeup_time = std::min(wakeup_time, source->sampling_freq_mgr().next());
     wakeup_time = std::min(wakeup_time, source->push_freq_mgr().next());
   }
@@ -770,8 +822,68 @@ bool DataExceedsThreshold(const std::vector<DataTable*>& data_tables) {
   return false;
 }
 
+// Returns the CPU time used by the calling thread so far.
+std::chrono::nanoseconds ThreadCPUTime() {
+  struct timespec ts = {};
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return std::chrono::seconds{ts.tv_sec} + std::chrono::nanoseconds{ts.tv_nsec};
+}
+
+// To batch up work, i.e. to do more work per wakeup, we want to run our data
+// transfer or push data if its desired run time is anywhere between
+// time "now" and time "now + window".
+constexpr auto kRunWindow = std::chrono::milliseconds{1};
+
 }  // namespace
 
+StirlingImpl::time_point StirlingImpl::RunSource(SourceConnector* source, ConnectorContext* ctx,
+                                                 time_point now) {
+  const time_point start = now;
+  const auto now_plus_run_window = now + kRunWindow;
+  const auto cpu_time_start = ThreadCPUTime();
+
+  // The deadline is when the earliest expired cycle ended. A push triggered by the data tables
+  // filling up has no deadline, so it is never late.
+  time_point deadline = start;
+  bool ran = false;
+
+  // Phase 1: Probe the source for its data.
+  if (source->sampling_freq_mgr().Expired(now_plus_run_window)) {
+    deadline = std::min(deadline, source->sampling_freq_mgr().next());
+    source->TransferData(ctx);
+
+    // TransferData() is normally a significant amount of work: update "time now".
+    now = std::chrono::steady_clock::now();
+    source->sampling_freq_mgr().Reset(now);
+    run_core_stats_.IncrementTransferDataCount();
+    ran = true;
+  }
+
+  // Phase 2: Push Data upstream.
+  if (source->push_freq_mgr().Expired(now_plus_run_window) ||
+      DataExceedsThreshold(source->data_tables())) {
+    if (source->push_freq_mgr().Expired(now_plus_run_window)) {
+      deadline = std::min(deadline, source->push_freq_mgr().next());
+    }
+    {
+      std::lock_guard<std::mutex> lock(push_mutex_);
+      source->PushData(data_push_callback_);
+    }
+
+    // PushData() is normally a significant amount of work: update "time now".
+    now = std::chrono::steady_clock::now();
+    source->push_freq_mgr().Reset(now);
+    run_core_stats_.IncrementPushDataCount();
+    ran = true;
+  }
+
+  if (ran) {
+    const auto lateness = std::max(std::chrono::steady_clock::duration::zero(), start - deadline);
+    run_core_stats_.RecordConnectorRun(source->name(), lateness, ThreadCPUTime() - cpu_time_start);
+  }
+  return now;
+}
+
 // Main Data Collector loop.
 // Poll on Data Source Through connectors, when appropriate, then go to sleep.
 // Must run as a thread, so only call from Run() as a thread.
@@ -801,17 +913,17 @@ void StirlingImpl::RunCore() {
   // a time period has expired and a call to TransferData() or PushData() is required).
   auto now = std::chrono::steady_clock::now();
   auto time_until_next_tick = std::chrono::milliseconds::zero();
-  constexpr auto kRunWindow = std::chrono::milliseconds{1};
 
   // The ctx_freq_mgr controls the update period for the k8s context "ctx".
+  // The context is shared with the tasks in flight on the worker threads, which keep the
+  // context they started with alive after it is replaced here.
   FrequencyManager ctx_freq_mgr;
   ctx_freq_mgr.set_period(std::chrono::milliseconds{200});
-  std::unique_ptr<ConnectorContext> ctx = GetContext();
+  std::shared_ptr<ConnectorContext> ctx = GetContext();
+
+  const bool use_workers = scheduler_->num_threads() > 0;
 
   while (run_enable_) {
-    // To batch up work, i.e. to do more work per wakeup, we want to run our data
-    // transfer or push data if its desired run time is anywhere between
-    // time "now" and time "now + window".
     const auto now_plus_run_window = now + kRunWindow;
 
     if (ctx_freq_mgr.Expired(now_plus_run_window)) {
@@ -825,26 +937,32 @@ void StirlingImpl::RunCore() {
       // Needed to avoid race with main thread update info_class_mgrs_ on new subscription.
       absl::base_internal::SpinLockHolder lock(&info_class_mgrs_lock_);
 
-      // Run through every SourceConnector and InfoClassManager being managed.
+      // Collect the sources that are due, and run them in the order of their deadlines, so that
+      // the most overdue source gets the first free worker thread.
+      std::vector<SourceConnector*> due_sources;
       for (auto& source : sources_) {
-        // Phase 1: Probe each source for its data.
-        if (source->sampling_freq_mgr().Expired(now_plus_run_window)) {
-          source->TransferData(ctx.get());
-
-          // TransferData() is normally a significant amount of work: update "time now".
-          now = std::chrono::steady_clock::now();
-          source->sampling_freq_mgr().Reset(now);
-          run_core_stats_.IncrementTransferDataCount();
+        if (scheduler_->InFlight(source.get())) {
+          continue;
         }
-        // Phase 2: Push Data upstream.
-        if (source->push_freq_mgr().Expired(now_plus_run_window) ||
+        if (source->sampling_freq_mgr().Expired(now_plus_run_window) ||
+            source->push_freq_mgr().Expired(now_plus_run_window) ||
             DataExceedsThreshold(source->data_tables())) {
-          source->PushData(data_push_callback_);
-
-          // PushData() is normally a significant amount of work: update "time now".
-          now = std::chrono::steady_clock::now();
-          source->push_freq_mgr().Reset(now);
-          run_core_stats_.IncrementPushDataCount();
+          due_sources.push_back(source.get());
+        }
+      }
+      std::stable_sort(due_sources.begin(), due_sources.end(),
+                       [](SourceConnector* a, SourceConnector* b) {
+                         return std::min(a->sampling_freq_mgr().next(), a->push_freq_mgr().next()) <
+                                std::min(b->sampling_freq_mgr().next(), b->push_freq_mgr().next());
+                       });
+
+      for (auto* source : due_sources) {
+        if (use_workers && source->thread_safe()) {
+          scheduler_->Schedule(source, [this, source, ctx] {
+            RunSource(source, ctx.get(), std::chrono::steady_clock::now());
+          });
+        } else {
+          now = RunSource(source, ctx.get(), now);
         }
       }
 
@@ -856,20 +974,26 @@ void StirlingImpl::RunCore() {
     // is long enough that Stirling should go to sleep. Otherwise, don't sleep and loop back
     // through the sources, with the expectation that one of the sources triggers a call to
     // either TransferData() or to PushData().
+    // The sleep ends early if a worker thread completes a source, since that source is due again.
     if (time_until_next_tick >= kRunWindow) {
-      std::this_thread::sleep_for(time_until_next_tick);
-
-      // Update the histograms in run core stats *and* trigger a periodic printout of the same.
-      run_core_stats_.EndIter(time_until_next_tick);
+      const auto sleep_start = std::chrono::steady_clock::now();
+      scheduler_->WaitForCompletion(time_until_next_tick);
 
       // We just went to sleep: update time now.
       now = std::chrono::steady_clock::now();
+
+      // Update the histograms in run core stats *and* trigger a periodic printout of the same.
+      run_core_stats_.EndIter(
+          std::chrono::duration_cast<std::chrono::milliseconds>(now - sleep_start));
     } else {
       // Did not sleep, but we still update the histograms in run core stats
       // *and* trigger a periodic printout of the same.
       run_core_stats_.EndIter(std::chrono::milliseconds::zero());
     }
   }
+
+  // Let the in-flight work complete, so that the sources can be stopped safely.
+  scheduler_->WaitForAllIdle();
   running_ = false;
 }
 
@@ -926,6 +1050,13 @@ void StirlingImpl::DisablePIDTrace(int pid) {
   }
 }
 
+void StirlingImpl::SetCaptureLimit(int protocol, uint32_t limit_bytes) {
+  absl::base_internal::SpinLockHolder lock(&info_class_mgrs_lock_);
+  for (auto& s : sources_) {
+    s->SetCaptureLimit(protocol, limit_bytes);
+  }
+}
+
 void StirlingImpl::UpdateDynamicTraceStatus(const sole::uuid& trace_id,
                                             const StatusOr<stirlingpb::Publish>& s) {
   absl::base_internal::SpinLockHolder lock(&dynamic_trace_status_map_lock_);
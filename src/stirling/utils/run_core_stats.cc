@@ -81,27 +81,59 @@ void RunCoreStats::IncrementPushDataCount() {
   ++push_or_transfer_this_iter_;
 }
 
+void RunCoreStats::RecordConnectorRun(std::string_view connector,
+                                      const std::chrono::nanoseconds lateness,
+                                      const std::chrono::nanoseconds cpu_time) {
+  absl::base_internal::SpinLockHolder lock(&connector_stats_lock_);
+  ConnectorStats& stats = connector_stats_[std::string(connector)];
+  ++stats.num_runs;
+  stats.total_lateness += lateness;
+  stats.max_lateness = std::max(stats.max_lateness, lateness);
+  stats.total_cpu_time += cpu_time;
+}
+
+RunCoreStats::ConnectorStats RunCoreStats::connector_stats(std::string_view connector) const {
+  absl::base_internal::SpinLockHolder lock(&connector_stats_lock_);
+  auto iter = connector_stats_.find(connector);
+  if (iter == connector_stats_.end()) {
+    return {};
+  }
+  return iter->second;
+}
+
 void RunCoreStats::LogStats() const {
+  const uint64_t num_transfer_data = num_transfer_data_;
+  const uint64_t num_push_data = num_push_data_;
+
   std::string s = absl::StrJoin(sleep_histo_, ",");
   absl::StrAppend(&s, ",", absl::StrJoin(no_work_histo_, ","));
 
   LOG(INFO) << absl::Substitute("|$0,$1,$2,$3,$4,$5,$6,$7,$8", num_main_loop_iters_,
                                 num_no_work_iters_, (num_main_loop_iters_ - num_no_work_iters_),
-                                (num_transfer_data_ + num_push_data_), num_transfer_data_,
-                                num_push_data_, min_push_or_transfer_, max_push_or_transfer_, s);
+                                (num_transfer_data + num_push_data), num_transfer_data,
+                                num_push_data, min_push_or_transfer_, max_push_or_transfer_, s);
+
+  absl::base_internal::SpinLockHolder lock(&connector_stats_lock_);
+  for (const auto& [name, stats] : connector_stats_) {
+    const auto runs = std::max<uint64_t>(stats.num_runs, 1);
+    LOG(INFO) << absl::Substitute(
+        "|connector=$0,runs=$1,avg_lateness_ms=$2,max_lateness_ms=$3,avg_cpu_ms=$4", name,
+        stats.num_runs, stats.total_lateness.count() / 1e6 / runs, stats.max_lateness.count() / 1e6,
+        stats.total_cpu_time.count() / 1e6 / runs);
+  }
 }
 
 void RunCoreStats::EndIter(const std::chrono::milliseconds sleep_duration) {
   UpdateSleepDurationHisto(sleep_duration, &sleep_histo_);
   ++num_main_loop_iters_;
-  min_push_or_transfer_ = std::min(push_or_transfer_this_iter_, min_push_or_transfer_);
-  max_push_or_transfer_ = std::max(push_or_transfer_this_iter_, max_push_or_transfer_);
+  const uint64_t push_or_transfer_this_iter = push_or_transfer_this_iter_.exchange(0);
+  min_push_or_transfer_ = std::min(push_or_transfer_this_iter, min_push_or_transfer_);
+  max_push_or_transfer_ = std::max(push_or_transfer_this_iter, max_push_or_transfer_);
 
-  if (push_or_transfer_this_iter_ == 0) {
+  if (push_or_transfer_this_iter == 0) {
     ++num_no_work_iters_;
     UpdateSleepDurationHisto(sleep_duration, &no_work_histo_);
   }
-  push_or_transfer_this_iter_ = 0;
 
   constexpr uint64_t kPrintPeriod = 1000;
   constexpr uint64_t kHeaderPeriod = 50 * kPrintPeriod;
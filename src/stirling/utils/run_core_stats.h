@@ -19,10 +19,13 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <string>
 #include <vector>
 
+#include <absl/base/internal/spinlock.h>
+#include <absl/container/flat_hash_map.h>
 #include <absl/strings/str_cat.h>
 #include <absl/strings/str_join.h>
 
@@ -34,14 +37,32 @@ namespace stirling {
 // RunCoreStats tracks the work done in each iteration of StirlingImpl::RunCore.
 // It counts the number of PushData() and TransferData() calls.
 // It also keeps a histogram of sleep durations: total, and those sleeps where no work is done.
+// Per source connector, it tracks how late the connector ran relative to its deadline, and how
+// much CPU time it used.
 class RunCoreStats {
  public:
+  struct ConnectorStats {
+    uint64_t num_runs = 0;
+    std::chrono::nanoseconds total_lateness = {};
+    std::chrono::nanoseconds max_lateness = {};
+    std::chrono::nanoseconds total_cpu_time = {};
+  };
+
   RunCoreStats();
 
   // Increment totals and per iteration counts.
+  // These may be called from the connector worker threads.
   void IncrementTransferDataCount();
   void IncrementPushDataCount();
 
+  // Records one run of a source connector, i.e. its TransferData() and/or PushData() calls.
+  // The lateness is how long after its deadline the connector started running.
+  // Thread-safe.
+  void RecordConnectorRun(std::string_view connector, std::chrono::nanoseconds lateness,
+                          std::chrono::nanoseconds cpu_time);
+
+  ConnectorStats connector_stats(std::string_view connector) const;
+
   // Logs the stats.
   void LogStats() const;
 
@@ -70,14 +91,18 @@ class RunCoreStats {
   const std::string header_string_;
 
   uint64_t num_main_loop_iters_ = 0;
-  uint64_t num_push_data_ = 0;
-  uint64_t num_transfer_data_ = 0;
+  std::atomic<uint64_t> num_push_data_ = 0;
+  std::atomic<uint64_t> num_transfer_data_ = 0;
   uint64_t min_push_or_transfer_ = ~(0ULL);
   uint64_t max_push_or_transfer_ = 0;
   uint64_t num_no_work_iters_ = 0;
-  uint64_t push_or_transfer_this_iter_ = 0;
+  std::atomic<uint64_t> push_or_transfer_this_iter_ = 0;
   std::vector<uint64_t> sleep_histo_;
   std::vector<uint64_t> no_work_histo_;
+
+  mutable absl::base_internal::SpinLock connector_stats_lock_;
+  absl::flat_hash_map<std::string, ConnectorStats> connector_stats_
+      ABSL_GUARDED_BY(connector_stats_lock_);
 };
 
 }  // namespace stirling
@@ -67,5 +67,30 @@ TEST(RunCoreStatsTest, RunCoreStatsTest) {
   stats.LogStats();
 }
 
+TEST(RunCoreStatsTest, ConnectorStats) {
+  RunCoreStats stats;
+
+  EXPECT_EQ(0, stats.connector_stats("socket_tracer").num_runs);
+
+  stats.RecordConnectorRun("socket_tracer", std::chrono::milliseconds{2},
+                           std::chrono::milliseconds{30});
+  stats.RecordConnectorRun("socket_tracer", std::chrono::milliseconds{6},
+                           std::chrono::milliseconds{10});
+  stats.RecordConnectorRun("process_stats", std::chrono::milliseconds{0},
+                           std::chrono::milliseconds{1});
+
+  RunCoreStats::ConnectorStats socket_tracer = stats.connector_stats("socket_tracer");
+  EXPECT_EQ(2, socket_tracer.num_runs);
+  EXPECT_EQ(std::chrono::milliseconds{8}, socket_tracer.total_lateness);
+  EXPECT_EQ(std::chrono::milliseconds{6}, socket_tracer.max_lateness);
+  EXPECT_EQ(std::chrono::milliseconds{40}, socket_tracer.total_cpu_time);
+
+  RunCoreStats::ConnectorStats process_stats = stats.connector_stats("process_stats");
+  EXPECT_EQ(1, process_stats.num_runs);
+  EXPECT_EQ(std::chrono::milliseconds{1}, process_stats.total_cpu_time);
+
+  stats.LogStats();
+}
+
 }  // namespace stirling
 }  // namespace px
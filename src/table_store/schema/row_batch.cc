@@ -159,6 +159,7 @@ Status CopyFromInputPB(std::shared_ptr<arrow::Array>* output_column,
 }
 
 Status RowBatch::ToProto(table_store::schemapb::RowBatchData* proto) const {
+  DCHECK(!HasSelection()) << "RowBatch must be compacted before it's serialized";
   proto->set_num_rows(num_rows_);
   proto->set_eow(eow_);
   proto->set_eos(eos_);
@@ -253,6 +254,7 @@ StatusOr<std::unique_ptr<RowBatch>> RowBatch::WithZeroRows(const RowDescriptor&
 }
 
 StatusOr<std::unique_ptr<RowBatch>> RowBatch::Slice(int64_t offset, int64_t length) const {
+  DCHECK(!HasSelection()) << "RowBatch must be compacted before it's sliced";
   if (offset + length > num_rows() || offset < 0) {
     return error::InvalidArgument("Slice(offset=$0, length=$1) on rowbatch of length $2 is invalid",
                                   offset, length, num_rows());
@@ -265,6 +267,59 @@ StatusOr<std::unique_ptr<RowBatch>> RowBatch::Slice(int64_t offset, int64_t leng
   return output_rb;
 }
 
+namespace {
+
+// Copies the values of the given rows of input_col into a new array.
+template <types::DataType T>
+StatusOr<std::shared_ptr<arrow::Array>> TakeRows(const arrow::Array* input_col,
+                                                 const std::vector<int64_t>& rows) {
+  auto output_col_builder_generic = types::MakeArrowBuilder(T, arrow::default_memory_pool());
+  auto* output_col_builder = static_cast<typename types::DataTypeTraits<T>::arrow_builder_type*>(
+      output_col_builder_generic.get());
+  PX_RETURN_IF_ERROR(output_col_builder->Reserve(rows.size()));
+  if constexpr (T == types::STRING) {
+    // Size the data buffer once, rather than growing it while copying.
+    int64_t data_size = 0;
+    for (int64_t row : rows) {
+      data_size += types::GetStringViewFromArrowArray(input_col, row).size();
+    }
+    PX_RETURN_IF_ERROR(output_col_builder->ReserveData(data_size));
+    for (int64_t row : rows) {
+      auto value = types::GetStringViewFromArrowArray(input_col, row);
+      output_col_builder->UnsafeAppend(value.data(), static_cast<int32_t>(value.size()));
+    }
+  } else {
+    for (int64_t row : rows) {
+      output_col_builder->UnsafeAppend(types::GetValueFromArrowArray<T>(input_col, row));
+    }
+  }
+  std::shared_ptr<arrow::Array> output_col;
+  PX_RETURN_IF_ERROR(output_col_builder->Finish(&output_col));
+  return output_col;
+}
+
+}  // namespace
+
+StatusOr<std::unique_ptr<RowBatch>> RowBatch::Compact() const {
+  auto output_rb = std::make_unique<RowBatch>(desc(), num_selected_rows());
+  output_rb->set_eow(eow());
+  output_rb->set_eos(eos());
+  for (int64_t col_idx = 0; col_idx < num_columns(); ++col_idx) {
+    if (!HasSelection()) {
+      PX_RETURN_IF_ERROR(output_rb->AddColumn(ColumnAt(col_idx)));
+      continue;
+    }
+    auto input_col = ColumnAt(col_idx);
+    std::shared_ptr<arrow::Array> output_col;
+#define TYPE_CASE(_dt_) \
+  PX_ASSIGN_OR_RETURN(output_col, TakeRows<_dt_>(input_col.get(), *selection_));
+    PX_SWITCH_FOREACH_DATATYPE(desc_.type(col_idx), TYPE_CASE);
+#undef TYPE_CASE
+    PX_RETURN_IF_ERROR(output_rb->AddColumn(output_col));
+  }
+  return output_rb;
+}
+
 }  // namespace schema
 }  // namespace table_store
 }  // namespace px
@@ -76,6 +76,16 @@ class RowBatch {
    */
   StatusOr<std::unique_ptr<RowBatch>> Slice(int64_t offset, int64_t length) const;
 
+  /**
+   * @brief Returns a copy of the selected rows of the RowBatch, without a selection vector.
+   *
+   * Keeps eow and eos. If the RowBatch has no selection vector, the columns are shared rather than
+   * copied.
+   *
+   * @return StatusOr<std::unique_ptr<RowBatch>>
+   */
+  StatusOr<std::unique_ptr<RowBatch>> Compact() const;
+
   /**
    * Adds the given column to the row batch, given that it correctly fits the schema.
    * param col ptr to the arrow array that should be added to the row batch.
@@ -99,6 +109,27 @@ class RowBatch {
    */
   int64_t num_rows() const { return num_rows_; }
 
+  /**
+   * A RowBatch can carry a selection vector, which holds the (increasing) indices of the rows that
+   * are part of the batch. The columns still hold num_rows() values, so that filters don't have
+   * to copy them. Exec nodes that don't handle selection vectors receive a compacted copy.
+   */
+  bool HasSelection() const { return selection_ != nullptr; }
+  const std::vector<int64_t>& selection() const { return *selection_; }
+  const std::shared_ptr<const std::vector<int64_t>>& shared_selection() const {
+    return selection_;
+  }
+  void set_selection(std::shared_ptr<const std::vector<int64_t>> selection) {
+    selection_ = std::move(selection);
+  }
+
+  /**
+   * @ return the number of rows that are selected, which is num_rows() without a selection vector.
+   */
+  int64_t num_selected_rows() const {
+    return HasSelection() ? static_cast<int64_t>(selection_->size()) : num_rows_;
+  }
+
   /**
    * @ return the number of columns which the row batch should contain.
    */
@@ -126,6 +157,7 @@ class RowBatch {
   bool eow_ = false;
   bool eos_ = false;
   std::vector<std::shared_ptr<arrow::Array>> columns_;
+  std::shared_ptr<const std::vector<int64_t>> selection_;
 };
 
 // Append a scalar value to an arrow::Array.
@@ -19,6 +19,7 @@
 #include <arrow/array.h>
 #include <google/protobuf/text_format.h>
 #include <google/protobuf/util/message_differencer.h>
+#include <memory>
 #include <vector>
 
 #include "src/common/testing/testing.h"
@@ -231,6 +232,45 @@ TEST_F(RowBatchTest, slice) {
   ASSERT_EQ(status2.msg(), "Slice(offset=-1, length=3) on rowbatch of length 3 is invalid");
 }
 
+TEST_F(RowBatchTest, compact) {
+  EXPECT_FALSE(rb_->HasSelection());
+  rb_->set_selection(std::make_shared<const std::vector<int64_t>>(std::vector<int64_t>{0, 2}));
+  rb_->set_eow(true);
+  rb_->set_eos(true);
+  EXPECT_EQ(3, rb_->num_rows());
+  EXPECT_EQ(2, rb_->num_selected_rows());
+
+  ASSERT_OK_AND_ASSIGN(auto output_rb, rb_->Compact());
+  EXPECT_FALSE(output_rb->HasSelection());
+  EXPECT_EQ(2, output_rb->num_rows());
+  EXPECT_TRUE(output_rb->eow());
+  EXPECT_TRUE(output_rb->eos());
+  EXPECT_EQ("RowBatch(eow=1, eos=1):\n  [\n  true,\n  true\n]\n  [\n  3,\n  5\n]\n  [\n  "
+            "3.3,\n  5.6\n]\n",
+            output_rb->DebugString());
+
+  // An empty selection compacts to a zero row batch.
+  rb_->set_selection(std::make_shared<const std::vector<int64_t>>());
+  ASSERT_OK_AND_ASSIGN(auto empty_rb, rb_->Compact());
+  EXPECT_EQ(0, empty_rb->num_rows());
+  EXPECT_EQ(3, empty_rb->num_columns());
+}
+
+TEST(RowBatchCompactTest, strings) {
+  RowDescriptor rd({types::DataType::STRING});
+  RowBatch rb(rd, 4);
+  std::vector<types::StringValue> in = {"a", "bcd", "", "efgh"};
+  ASSERT_OK(rb.AddColumn(types::ToArrow(in, arrow::default_memory_pool())));
+  rb.set_selection(std::make_shared<const std::vector<int64_t>>(std::vector<int64_t>{1, 2, 3}));
+
+  ASSERT_OK_AND_ASSIGN(auto output_rb, rb.Compact());
+  ASSERT_EQ(3, output_rb->num_rows());
+  auto output_col = output_rb->ColumnAt(0);
+  EXPECT_EQ("bcd", types::GetValueFromArrowArray<types::STRING>(output_col.get(), 0));
+  EXPECT_EQ("", types::GetValueFromArrowArray<types::STRING>(output_col.get(), 1));
+  EXPECT_EQ("efgh", types::GetValueFromArrowArray<types::STRING>(output_col.get(), 2));
+}
+
 }  // namespace schema
 }  // namespace table_store
 }  // namespace px
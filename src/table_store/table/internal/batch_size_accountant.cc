@@ -169,14 +169,15 @@ const BatchSizeAccountant::CompactedBatchSpec& BatchSizeAccountant::GetNextCompa
   return compacted_batch_specs_.front();
 }
 
-uint64_t BatchSizeAccountant::FinishCompactedBatch() {
+uint64_t BatchSizeAccountant::FinishCompactedBatch(std::optional<uint64_t> cold_batch_bytes) {
   DCHECK(CompactedBatchReady());
   auto spec = std::move(compacted_batch_specs_.front());
   compacted_batch_specs_.pop_front();
 
+  auto cold_bytes = cold_batch_bytes.value_or(spec.bytes);
   hot_bytes_ -= spec.bytes;
-  cold_bytes_ += spec.bytes;
-  cold_batch_bytes_.push_back(spec.bytes);
+  cold_bytes_ += cold_bytes;
+  cold_batch_bytes_.push_back(cold_bytes);
 
   if (spec.hot_slices.back().last_slice_for_batch) {
     // If the last slice in the compacted batch was the last slice for the corresponding hot batch,
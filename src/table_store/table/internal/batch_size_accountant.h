@@ -130,10 +130,13 @@ class BatchSizeAccountant {
    * update hot_bytes_ and cold_bytes_ accordingly. It returns the number of rows that need to be
    * removed from start of the first hot batch in order to prevent duplicated data between the hot
    * and cold stores.
+   * @param cold_batch_bytes the number of bytes the compacted batch takes up in the cold store. If
+   * not provided, the cold batch is assumed to be the same size as the hot data it was built from.
+   * This differs when the cold batch is encoded.
    * @return Number of rows to remove from the front of the hot store, since those rows were moved
    * into the cold store via CompactedBatchSpec.
    */
-  uint64_t FinishCompactedBatch();
+  uint64_t FinishCompactedBatch(std::optional<uint64_t> cold_batch_bytes = std::nullopt);
   /**
    * @return the number of bytes stored in the hot store.
    */
@@ -0,0 +1,107 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/table/internal/cold_batch.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+ColdBatch::ColdBatch(const std::vector<ArrowArrayPtr>& columns) {
+  for (const auto& arr : columns) {
+    columns_.push_back(MakePlainColumn(types::ArrowToDataType(arr->type_id()), arr));
+  }
+}
+
+StatusOr<ColdBatch> ColdBatch::Encode(const schema::Relation& rel,
+                                      const std::vector<ArrowArrayPtr>& columns,
+                                      const ColumnEncodingOptions& opts) {
+  std::vector<std::unique_ptr<EncodedColumn>> encoded;
+  for (const auto& [col_idx, arr] : Enumerate(columns)) {
+    PX_ASSIGN_OR_RETURN(auto col, EncodeColumn(rel.GetColumnType(col_idx), arr, opts));
+    encoded.push_back(std::move(col));
+  }
+  return ColdBatch(std::move(encoded));
+}
+
+size_t ColdBatch::Length() const { return columns_[0]->Length(); }
+
+uint64_t ColdBatch::Bytes() const {
+  uint64_t bytes = 0;
+  for (const auto& col : columns_) {
+    bytes += col->Bytes();
+  }
+  return bytes;
+}
+
+int64_t ColdBatch::FindTimeFirstGreaterThanOrEqual(int64_t time_col_idx, Time time) const {
+  const auto& time_col = *columns_[time_col_idx];
+  size_t lo = 0;
+  size_t hi = time_col.Length();
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (time_col.Int64Value(mid) < time) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  if (lo == time_col.Length()) {
+    return -1;
+  }
+  return lo;
+}
+
+int64_t ColdBatch::FindTimeFirstGreaterThan(int64_t time_col_idx, Time time) const {
+  const auto& time_col = *columns_[time_col_idx];
+  size_t lo = 0;
+  size_t hi = time_col.Length();
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (time_col.Int64Value(mid) <= time) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+Time ColdBatch::GetTimeValue(int64_t time_col_idx, int64_t row_idx) const {
+  return columns_[time_col_idx]->Int64Value(row_idx);
+}
+
+Status ColdBatch::AddBatchSliceToRowBatch(size_t row_offset, size_t batch_size,
+                                          const std::vector<int64_t>& cols,
+                                          schema::RowBatch* output_rb) const {
+  for (auto col_idx : cols) {
+    PX_ASSIGN_OR_RETURN(auto arr, columns_[col_idx]->Decode(row_offset, batch_size));
+    PX_RETURN_IF_ERROR(output_rb->AddColumn(arr));
+  }
+  return Status::OK();
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
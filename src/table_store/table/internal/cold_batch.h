@@ -0,0 +1,123 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "src/table_store/schema/relation.h"
+#include "src/table_store/schema/row_batch.h"
+#include "src/table_store/table/internal/column_encoding.h"
+#include "src/table_store/table/internal/types.h"
+#include "src/table_store/table/internal/zone_map.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+/**
+ * ColdBatch is a compacted batch in the cold store. Each column is stored as an `EncodedColumn`,
+ * which is either the plain arrow::Array produced by compaction, or an encoded version of it chosen
+ * at compaction time (see `ColdBatch::Encode`). Columns are only decoded when they are read, and
+ * only for the rows that are read.
+ *
+ * A ColdBatch can also carry a ZoneMap of its columns, which lets readers skip the batch when none
+ * of its rows can match their predicates.
+ */
+class ColdBatch {
+ public:
+  /**
+   * Create a ColdBatch that stores each of the given columns as plain arrow::Array's.
+   */
+  explicit ColdBatch(const std::vector<ArrowArrayPtr>& columns);
+  explicit ColdBatch(std::vector<std::unique_ptr<EncodedColumn>> columns)
+      : columns_(std::move(columns)) {}
+
+  ColdBatch(ColdBatch&&) = default;
+  ColdBatch& operator=(ColdBatch&&) = default;
+
+  /**
+   * Encode creates a ColdBatch, choosing the best encoding for each of the given columns.
+   * @param rel the relation of the table that the columns belong to.
+   * @param columns the compacted arrow arrays for each column.
+   * @param opts the options to pass to `EncodeColumn`.
+   * @return the encoded ColdBatch.
+   */
+  static StatusOr<ColdBatch> Encode(const schema::Relation& rel,
+                                    const std::vector<ArrowArrayPtr>& columns,
+                                    const ColumnEncodingOptions& opts);
+
+  /**
+   * Length returns the number of rows in this batch.
+   */
+  size_t Length() const;
+  /**
+   * Bytes returns the number of bytes used to store this batch (after encoding).
+   */
+  uint64_t Bytes() const;
+  /**
+   * FindTimeFirstGreaterThanOrEqual returns the first row index within this batch that has time
+   * greater than or equal to the given time, or -1 if no such row exists.
+   */
+  int64_t FindTimeFirstGreaterThanOrEqual(int64_t time_col_idx, Time time) const;
+  /**
+   * FindTimeFirstGreaterThan returns the first row index within this batch that has time greater
+   * than the given time, or Length() if no such row exists.
+   */
+  int64_t FindTimeFirstGreaterThan(int64_t time_col_idx, Time time) const;
+  /**
+   * GetTimeValue returns the value of the time column at the given row index.
+   */
+  Time GetTimeValue(int64_t time_col_idx, int64_t row_idx) const;
+  /**
+   * AddBatchSliceToRowBatch decodes a slice of the requested columns of this batch and adds them
+   * to the given output schema::RowBatch.
+   * @param row_offset, row index within this batch to start the output slice at.
+   * @param batch_size, size of the output slice.
+   * @param cols, a vector of column indices to include in the output slice.
+   * @param output_rb, a pointer to the row batch to add the columns to.
+   * @return Status, errors if decoding or adding columns to the row batch fails.
+   */
+  Status AddBatchSliceToRowBatch(size_t row_offset, size_t batch_size,
+                                 const std::vector<int64_t>& cols,
+                                 schema::RowBatch* output_rb) const;
+
+  /**
+   * MayMatch returns false if the batch's zone map shows that no row in the batch can match all of
+   * the given predicates. Batches without a zone map always match.
+   */
+  bool MayMatch(const std::vector<ColumnPredicate>& predicates) const {
+    return zone_map_ == nullptr || zone_map_->MayMatch(predicates);
+  }
+
+  size_t NumColumns() const { return columns_.size(); }
+  const EncodedColumn& column(int64_t col_idx) const { return *columns_[col_idx]; }
+
+  const std::shared_ptr<const ZoneMap>& zone_map() const { return zone_map_; }
+  void set_zone_map(std::shared_ptr<const ZoneMap> zone_map) { zone_map_ = std::move(zone_map); }
+
+ private:
+  std::vector<std::unique_ptr<EncodedColumn>> columns_;
+  std::shared_ptr<const ZoneMap> zone_map_;
+};
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
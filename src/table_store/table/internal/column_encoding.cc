@@ -0,0 +1,452 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <absl/container/flat_hash_map.h>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "src/common/zlib/zlib_wrapper.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/type_utils.h"
+#include "src/table_store/table/internal/column_encoding.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+namespace {
+
+template <types::DataType TDataType>
+using ArrowArrayType = typename types::DataTypeTraits<TDataType>::arrow_array_type;
+template <types::DataType TDataType>
+using ArrowBuilderType = typename types::DataTypeTraits<TDataType>::arrow_builder_type;
+
+// Builds an integer arrow::Array of the given length, where value_at(i) returns the value of the
+// i'th row. value_at is called in order, so it can keep state between calls.
+template <types::DataType TDataType, typename TValueFn>
+StatusOr<ArrowArrayPtr> BuildIntArray(size_t length, arrow::MemoryPool* mem_pool,
+                                      TValueFn value_at) {
+  auto builder = types::MakeArrowBuilder(TDataType, mem_pool);
+  auto typed_builder = static_cast<ArrowBuilderType<TDataType>*>(builder.get());
+  PX_RETURN_IF_ERROR(typed_builder->Reserve(length));
+  for (size_t i = 0; i < length; ++i) {
+    typed_builder->UnsafeAppend(value_at(i));
+  }
+  ArrowArrayPtr out;
+  PX_RETURN_IF_ERROR(typed_builder->Finish(&out));
+  return out;
+}
+
+// Integer arithmetic is done on unsigned integers so that wraparound is well defined. Encoding and
+// decoding wrap around identically, so values always round trip.
+inline int64_t WrappingAdd(int64_t a, uint64_t b) {
+  return static_cast<int64_t>(static_cast<uint64_t>(a) + b);
+}
+
+inline uint64_t WrappingSub(int64_t a, int64_t b) {
+  return static_cast<uint64_t>(a) - static_cast<uint64_t>(b);
+}
+
+class PlainColumn : public EncodedColumn {
+ public:
+  PlainColumn(types::DataType data_type, ArrowArrayPtr arr)
+      : data_type_(data_type), arr_(std::move(arr)) {}
+
+  ColumnEncoding encoding() const override { return ColumnEncoding::kPlain; }
+  size_t Length() const override { return arr_->length(); }
+
+  uint64_t Bytes() const override {
+    uint64_t bytes = 0;
+#define TYPE_CASE(_dt_)                                                              \
+  if constexpr (_dt_ == types::DataType::STRING) {                                   \
+    auto str_arr = static_cast<const arrow::StringArray*>(arr_.get());               \
+    bytes = sizeof(int32_t) * arr_->length() + str_arr->value_offset(arr_->length()) - \
+            str_arr->value_offset(0);                                                \
+  } else {                                                                           \
+    bytes = sizeof(types::DataTypeTraits<_dt_>::native_type) * arr_->length();       \
+  }
+    PX_SWITCH_FOREACH_DATATYPE(data_type_, TYPE_CASE);
+#undef TYPE_CASE
+    return bytes;
+  }
+
+  StatusOr<ArrowArrayPtr> Decode(size_t offset, size_t length) const override {
+    return arr_->Slice(offset, length);
+  }
+
+  int64_t Int64Value(size_t row) const override {
+    if (data_type_ == types::DataType::TIME64NS) {
+      return types::GetValueFromArrowArray<types::DataType::TIME64NS>(arr_.get(), row);
+    }
+    DCHECK_EQ(data_type_, types::DataType::INT64);
+    return types::GetValueFromArrowArray<types::DataType::INT64>(arr_.get(), row);
+  }
+
+ private:
+  const types::DataType data_type_;
+  const ArrowArrayPtr arr_;
+};
+
+template <types::DataType TDataType>
+class FrameOfReferenceColumn : public EncodedColumn {
+ public:
+  FrameOfReferenceColumn(int64_t base, PackedInts offsets, size_t length,
+                         arrow::MemoryPool* mem_pool)
+      : base_(base), offsets_(std::move(offsets)), length_(length), mem_pool_(mem_pool) {}
+
+  ColumnEncoding encoding() const override { return ColumnEncoding::kFrameOfReference; }
+  size_t Length() const override { return length_; }
+  uint64_t Bytes() const override { return sizeof(base_) + offsets_.Bytes(); }
+
+  StatusOr<ArrowArrayPtr> Decode(size_t offset, size_t length) const override {
+    return BuildIntArray<TDataType>(length, mem_pool_, [&](size_t i) {
+      return WrappingAdd(base_, offsets_.Get(offset + i));
+    });
+  }
+
+  int64_t Int64Value(size_t row) const override { return WrappingAdd(base_, offsets_.Get(row)); }
+
+ private:
+  const int64_t base_;
+  const PackedInts offsets_;
+  const size_t length_;
+  arrow::MemoryPool* mem_pool_;
+};
+
+template <types::DataType TDataType>
+class DeltaColumn : public EncodedColumn {
+ public:
+  DeltaColumn(std::vector<int64_t> anchors, int64_t min_delta, PackedInts deltas, size_t length,
+              arrow::MemoryPool* mem_pool)
+      : anchors_(std::move(anchors)),
+        min_delta_(min_delta),
+        deltas_(std::move(deltas)),
+        length_(length),
+        mem_pool_(mem_pool) {}
+
+  ColumnEncoding encoding() const override { return ColumnEncoding::kDelta; }
+  size_t Length() const override { return length_; }
+  uint64_t Bytes() const override {
+    return sizeof(int64_t) * anchors_.size() + sizeof(min_delta_) + deltas_.Bytes();
+  }
+
+  StatusOr<ArrowArrayPtr> Decode(size_t offset, size_t length) const override {
+    int64_t value = 0;
+    return BuildIntArray<TDataType>(length, mem_pool_, [&](size_t i) {
+      size_t row = offset + i;
+      if (i == 0) {
+        value = Int64Value(row);
+      } else if (row % kDeltaFrameSize == 0) {
+        value = anchors_[row / kDeltaFrameSize];
+      } else {
+        value = WrappingAdd(value, static_cast<uint64_t>(min_delta_) + deltas_.Get(row));
+      }
+      return value;
+    });
+  }
+
+  int64_t Int64Value(size_t row) const override {
+    size_t frame_start = row - (row % kDeltaFrameSize);
+    int64_t value = anchors_[frame_start / kDeltaFrameSize];
+    for (size_t i = frame_start + 1; i <= row; ++i) {
+      value = WrappingAdd(value, static_cast<uint64_t>(min_delta_) + deltas_.Get(i));
+    }
+    return value;
+  }
+
+ private:
+  const std::vector<int64_t> anchors_;
+  const int64_t min_delta_;
+  const PackedInts deltas_;
+  const size_t length_;
+  arrow::MemoryPool* mem_pool_;
+};
+
+StatusOr<ArrowArrayPtr> BuildStringArray(size_t length, size_t data_bytes,
+                                         arrow::MemoryPool* mem_pool,
+                                         const std::function<std::string_view(size_t)>& value_at) {
+  arrow::StringBuilder builder(mem_pool);
+  PX_RETURN_IF_ERROR(builder.Reserve(length));
+  PX_RETURN_IF_ERROR(builder.ReserveData(data_bytes));
+  for (size_t i = 0; i < length; ++i) {
+    auto value = value_at(i);
+    builder.UnsafeAppend(reinterpret_cast<const uint8_t*>(value.data()),
+                         static_cast<int32_t>(value.size()));
+  }
+  ArrowArrayPtr out;
+  PX_RETURN_IF_ERROR(builder.Finish(&out));
+  return out;
+}
+
+class DictionaryColumn : public EncodedColumn {
+ public:
+  DictionaryColumn(ArrowArrayPtr dictionary, PackedInts indices, size_t length,
+                   arrow::MemoryPool* mem_pool)
+      : dictionary_(std::move(dictionary)),
+        indices_(std::move(indices)),
+        length_(length),
+        mem_pool_(mem_pool) {}
+
+  ColumnEncoding encoding() const override { return ColumnEncoding::kDictionary; }
+  size_t Length() const override { return length_; }
+  uint64_t Bytes() const override {
+    return PlainColumn(types::DataType::STRING, dictionary_).Bytes() + indices_.Bytes();
+  }
+
+  StatusOr<ArrowArrayPtr> Decode(size_t offset, size_t length) const override {
+    auto dict = static_cast<const arrow::StringArray*>(dictionary_.get());
+    size_t data_bytes = 0;
+    indices_.ForEach(offset, offset + length, [&](size_t, uint64_t dict_idx) {
+      data_bytes += dict->value_length(dict_idx);
+    });
+    return BuildStringArray(length, data_bytes, mem_pool_, [&](size_t i) {
+      return types::GetStringViewFromArrowArray(dict, indices_.Get(offset + i));
+    });
+  }
+
+  int64_t Int64Value(size_t) const override {
+    DCHECK(false) << "Int64Value is not supported on string columns.";
+    return 0;
+  }
+
+ private:
+  const ArrowArrayPtr dictionary_;
+  const PackedInts indices_;
+  const size_t length_;
+  arrow::MemoryPool* mem_pool_;
+};
+
+class CompressedStringColumn : public EncodedColumn {
+ public:
+  CompressedStringColumn(std::vector<std::string> chunks, std::vector<size_t> chunk_rows,
+                         std::vector<int32_t> offsets, arrow::MemoryPool* mem_pool)
+      : chunks_(std::move(chunks)),
+        chunk_rows_(std::move(chunk_rows)),
+        offsets_(std::move(offsets)),
+        mem_pool_(mem_pool) {}
+
+  ColumnEncoding encoding() const override { return ColumnEncoding::kCompressed; }
+  size_t Length() const override { return offsets_.size() - 1; }
+  uint64_t Bytes() const override {
+    uint64_t bytes = sizeof(int32_t) * offsets_.size() + sizeof(size_t) * chunk_rows_.size();
+    for (const auto& chunk : chunks_) {
+      bytes += chunk.size();
+    }
+    return bytes;
+  }
+
+  StatusOr<ArrowArrayPtr> Decode(size_t offset, size_t length) const override {
+    // Only uncompress the chunks that overlap [offset, offset + length).
+    size_t first_chunk =
+        std::upper_bound(chunk_rows_.begin(), chunk_rows_.end(), offset) - chunk_rows_.begin() - 1;
+    std::vector<std::string> data;
+    for (size_t c = first_chunk; c < chunks_.size() && chunk_rows_[c] < offset + length; ++c) {
+      size_t chunk_bytes = offsets_[chunk_rows_[c + 1]] - offsets_[chunk_rows_[c]];
+      PX_ASSIGN_OR_RETURN(std::string chunk_data, zlib::Uncompress(chunks_[c], chunk_bytes));
+      data.push_back(std::move(chunk_data));
+    }
+    size_t data_bytes = offsets_[offset + length] - offsets_[offset];
+    size_t chunk = first_chunk;
+    return BuildStringArray(length, data_bytes, mem_pool_, [&](size_t i) {
+      auto row = offset + i;
+      while (row >= chunk_rows_[chunk + 1]) {
+        ++chunk;
+      }
+      const std::string& chunk_data = data[chunk - first_chunk];
+      auto start = offsets_[row] - offsets_[chunk_rows_[chunk]];
+      return std::string_view(chunk_data.data() + start, offsets_[row + 1] - offsets_[row]);
+    });
+  }
+
+  int64_t Int64Value(size_t) const override {
+    DCHECK(false) << "Int64Value is not supported on string columns.";
+    return 0;
+  }
+
+ private:
+  const std::vector<std::string> chunks_;
+  // chunk_rows_ has one more entry than chunks_, the i'th chunk holds the rows
+  // [chunk_rows_[i], chunk_rows_[i+1]).
+  const std::vector<size_t> chunk_rows_;
+  // offsets_ has Length() + 1 entries, the i'th string spans [offsets_[i], offsets_[i+1]).
+  const std::vector<int32_t> offsets_;
+  arrow::MemoryPool* mem_pool_;
+};
+
+template <types::DataType TDataType>
+std::unique_ptr<EncodedColumn> EncodeIntColumn(const ArrowArrayPtr& arr,
+                                               const ColumnEncodingOptions& opts) {
+  const int64_t* values = static_cast<const ArrowArrayType<TDataType>*>(arr.get())->raw_values();
+  const size_t length = arr->length();
+
+  auto [min_it, max_it] = std::minmax_element(values, values + length);
+  uint8_t for_width = PackedInts::WidthForMaxValue(WrappingSub(*max_it, *min_it));
+  uint64_t for_bytes = sizeof(int64_t) + for_width * length;
+
+  int64_t min_delta = 0;
+  int64_t max_delta = 0;
+  for (size_t i = 1; i < length; ++i) {
+    int64_t delta = static_cast<int64_t>(WrappingSub(values[i], values[i - 1]));
+    min_delta = (i == 1) ? delta : std::min(min_delta, delta);
+    max_delta = (i == 1) ? delta : std::max(max_delta, delta);
+  }
+  size_t num_frames = (length + kDeltaFrameSize - 1) / kDeltaFrameSize;
+  uint8_t delta_width = PackedInts::WidthForMaxValue(WrappingSub(max_delta, min_delta));
+  uint64_t delta_bytes = sizeof(int64_t) * (num_frames + 1) + delta_width * length;
+
+  uint64_t plain_bytes = sizeof(int64_t) * length;
+  uint64_t max_bytes = opts.max_encoded_ratio * plain_bytes;
+
+  if (delta_bytes < for_bytes && delta_bytes <= max_bytes) {
+    std::vector<int64_t> anchors;
+    anchors.reserve(num_frames);
+    PackedInts deltas(delta_width, length);
+    for (size_t i = 0; i < length; ++i) {
+      if (i % kDeltaFrameSize == 0) {
+        anchors.push_back(values[i]);
+        continue;
+      }
+      int64_t delta = static_cast<int64_t>(WrappingSub(values[i], values[i - 1]));
+      deltas.Set(i, WrappingSub(delta, min_delta));
+    }
+    return std::make_unique<DeltaColumn<TDataType>>(std::move(anchors), min_delta,
+                                                    std::move(deltas), length, opts.mem_pool);
+  }
+  if (for_bytes <= max_bytes) {
+    PackedInts offsets(for_width, length);
+    for (size_t i = 0; i < length; ++i) {
+      offsets.Set(i, WrappingSub(values[i], *min_it));
+    }
+    return std::make_unique<FrameOfReferenceColumn<TDataType>>(*min_it, std::move(offsets),
+                                                               length, opts.mem_pool);
+  }
+  return MakePlainColumn(TDataType, arr);
+}
+
+StatusOr<std::unique_ptr<EncodedColumn>> EncodeStringColumn(const ArrowArrayPtr& arr,
+                                                            const ColumnEncodingOptions& opts) {
+  auto str_arr = static_cast<const arrow::StringArray*>(arr.get());
+  const size_t length = arr->length();
+  const size_t data_bytes = str_arr->value_offset(length) - str_arr->value_offset(0);
+  const uint64_t plain_bytes = sizeof(int32_t) * length + data_bytes;
+  const uint64_t max_bytes = opts.max_encoded_ratio * plain_bytes;
+
+  // Try dictionary encoding first, giving up as soon as there are too many distinct values.
+  const size_t max_dict_size = opts.max_dictionary_ratio * length;
+  absl::flat_hash_map<std::string_view, uint32_t> dict;
+  std::vector<std::string_view> dict_values;
+  std::vector<uint32_t> indices(length);
+  size_t dict_data_bytes = 0;
+  bool dict_ok = true;
+  for (size_t i = 0; i < length; ++i) {
+    auto value = types::GetStringViewFromArrowArray(str_arr, i);
+    auto [it, inserted] = dict.try_emplace(value, dict_values.size());
+    if (inserted) {
+      if (dict_values.size() >= max_dict_size) {
+        dict_ok = false;
+        break;
+      }
+      dict_values.push_back(value);
+      dict_data_bytes += value.size();
+    }
+    indices[i] = it->second;
+  }
+  if (dict_ok && !dict_values.empty()) {
+    uint8_t width = PackedInts::WidthForMaxValue(dict_values.size() - 1);
+    uint64_t dict_bytes =
+        sizeof(int32_t) * dict_values.size() + dict_data_bytes + width * length;
+    if (dict_bytes <= max_bytes) {
+      PX_ASSIGN_OR_RETURN(auto dictionary,
+                          BuildStringArray(dict_values.size(), dict_data_bytes, opts.mem_pool,
+                                           [&](size_t i) { return dict_values[i]; }));
+      PackedInts packed_indices(width, length);
+      for (size_t i = 0; i < length; ++i) {
+        packed_indices.Set(i, indices[i]);
+      }
+      return std::unique_ptr<EncodedColumn>(std::make_unique<DictionaryColumn>(
+          std::move(dictionary), std::move(packed_indices), length, opts.mem_pool));
+    }
+  }
+
+  // Only large string values (eg. request/response bodies) are worth compressing.
+  if (data_bytes >= opts.min_compressed_avg_length * length) {
+    std::vector<int32_t> offsets(length + 1);
+    for (size_t i = 0; i <= length; ++i) {
+      offsets[i] = str_arr->value_offset(i) - str_arr->value_offset(0);
+    }
+    auto data_start = reinterpret_cast<const char*>(str_arr->value_data()->data()) +
+                      str_arr->value_offset(0);
+    std::vector<std::string> chunks;
+    std::vector<size_t> chunk_rows = {0};
+    uint64_t compressed_bytes = sizeof(int32_t) * (length + 1);
+    while (chunk_rows.back() < length) {
+      size_t start = chunk_rows.back();
+      size_t end = start + 1;
+      while (end < length && static_cast<size_t>(offsets[end + 1] - offsets[start]) <=
+                                 opts.compressed_chunk_bytes) {
+        ++end;
+      }
+      PX_ASSIGN_OR_RETURN(std::string chunk,
+                          zlib::Compress(std::string_view(data_start + offsets[start],
+                                                          offsets[end] - offsets[start])));
+      compressed_bytes += chunk.size() + sizeof(size_t);
+      chunks.push_back(std::move(chunk));
+      chunk_rows.push_back(end);
+    }
+    if (compressed_bytes <= max_bytes) {
+      return std::unique_ptr<EncodedColumn>(std::make_unique<CompressedStringColumn>(
+          std::move(chunks), std::move(chunk_rows), std::move(offsets), opts.mem_pool));
+    }
+  }
+
+  return MakePlainColumn(types::DataType::STRING, arr);
+}
+
+}  // namespace
+
+std::unique_ptr<EncodedColumn> MakePlainColumn(types::DataType data_type, ArrowArrayPtr arr) {
+  return std::make_unique<PlainColumn>(data_type, std::move(arr));
+}
+
+StatusOr<std::unique_ptr<EncodedColumn>> EncodeColumn(types::DataType data_type,
+                                                      const ArrowArrayPtr& arr,
+                                                      const ColumnEncodingOptions& opts) {
+  // Nulls aren't produced by any of our data sources, so we don't bother encoding them.
+  if (arr->length() == 0 || arr->null_count() > 0) {
+    return MakePlainColumn(data_type, arr);
+  }
+  switch (data_type) {
+    case types::DataType::INT64:
+      return EncodeIntColumn<types::DataType::INT64>(arr, opts);
+    case types::DataType::TIME64NS:
+      return EncodeIntColumn<types::DataType::TIME64NS>(arr, opts);
+    case types::DataType::STRING:
+      return EncodeStringColumn(arr, opts);
+    default:
+      return MakePlainColumn(data_type, arr);
+  }
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
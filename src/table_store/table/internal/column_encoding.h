@@ -0,0 +1,206 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/memory_pool.h>
+
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/shared/types/types.h"
+#include "src/table_store/table/internal/types.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+// Number of rows between absolute anchor values in a kDelta encoded column.
+inline constexpr size_t kDeltaFrameSize = 128;
+
+enum class ColumnEncoding {
+  // The arrow::Array is stored as is.
+  kPlain,
+  // Integers are stored as unsigned offsets from the minimum value in the column.
+  kFrameOfReference,
+  // Integers are stored as the difference from the previous value, with an absolute anchor value
+  // every kDeltaFrameSize rows to bound the cost of random access.
+  kDelta,
+  // Strings are stored as indices into a dictionary of the distinct values in the column.
+  kDictionary,
+  // The string data buffer is stored as zlib compressed chunks of whole rows, so that a slice of
+  // rows only needs the chunks that overlap it to be uncompressed.
+  kCompressed,
+};
+
+/**
+ * PackedInts stores unsigned integers using a fixed byte width of 1, 2, 4 or 8 bytes, picked to be
+ * the smallest width that fits the largest value.
+ */
+class PackedInts {
+ public:
+  PackedInts() = default;
+  PackedInts(uint8_t width, size_t size) : width_(width), data_(width * size) {}
+
+  /**
+   * @return the smallest supported byte width that can represent max_value.
+   */
+  static uint8_t WidthForMaxValue(uint64_t max_value) {
+    if (max_value <= std::numeric_limits<uint8_t>::max()) return sizeof(uint8_t);
+    if (max_value <= std::numeric_limits<uint16_t>::max()) return sizeof(uint16_t);
+    if (max_value <= std::numeric_limits<uint32_t>::max()) return sizeof(uint32_t);
+    return sizeof(uint64_t);
+  }
+
+  void Set(size_t idx, uint64_t value) {
+    switch (width_) {
+      case sizeof(uint8_t):
+        return SetTyped<uint8_t>(idx, value);
+      case sizeof(uint16_t):
+        return SetTyped<uint16_t>(idx, value);
+      case sizeof(uint32_t):
+        return SetTyped<uint32_t>(idx, value);
+      default:
+        return SetTyped<uint64_t>(idx, value);
+    }
+  }
+
+  uint64_t Get(size_t idx) const {
+    switch (width_) {
+      case sizeof(uint8_t):
+        return GetTyped<uint8_t>(idx);
+      case sizeof(uint16_t):
+        return GetTyped<uint16_t>(idx);
+      case sizeof(uint32_t):
+        return GetTyped<uint32_t>(idx);
+      default:
+        return GetTyped<uint64_t>(idx);
+    }
+  }
+
+  /**
+   * Calls fn(i, value) for each i in [start, end). The width dispatch happens once, outside of the
+   * loop, so that the loop body can be inlined.
+   */
+  template <typename TFn>
+  void ForEach(size_t start, size_t end, TFn fn) const {
+    switch (width_) {
+      case sizeof(uint8_t):
+        return ForEachTyped<uint8_t>(start, end, fn);
+      case sizeof(uint16_t):
+        return ForEachTyped<uint16_t>(start, end, fn);
+      case sizeof(uint32_t):
+        return ForEachTyped<uint32_t>(start, end, fn);
+      default:
+        return ForEachTyped<uint64_t>(start, end, fn);
+    }
+  }
+
+  uint8_t width() const { return width_; }
+  size_t Bytes() const { return data_.size(); }
+
+ private:
+  template <typename TInt>
+  void SetTyped(size_t idx, uint64_t value) {
+    TInt v = static_cast<TInt>(value);
+    std::memcpy(data_.data() + idx * sizeof(TInt), &v, sizeof(TInt));
+  }
+
+  template <typename TInt>
+  uint64_t GetTyped(size_t idx) const {
+    TInt v;
+    std::memcpy(&v, data_.data() + idx * sizeof(TInt), sizeof(TInt));
+    return v;
+  }
+
+  template <typename TInt, typename TFn>
+  void ForEachTyped(size_t start, size_t end, TFn fn) const {
+    for (size_t i = start; i < end; ++i) {
+      fn(i, GetTyped<TInt>(i));
+    }
+  }
+
+  uint8_t width_ = sizeof(uint64_t);
+  std::vector<uint8_t> data_;
+};
+
+/**
+ * EncodedColumn is a single column of a cold batch, stored in one of the `ColumnEncoding`s.
+ * Columns are decoded on demand, and only for the rows that are requested, so that queries only
+ * pay the decoding cost for the columns they project.
+ */
+class EncodedColumn {
+ public:
+  virtual ~EncodedColumn() = default;
+
+  virtual ColumnEncoding encoding() const = 0;
+  /**
+   * @return number of rows in the column.
+   */
+  virtual size_t Length() const = 0;
+  /**
+   * @return number of bytes used to store the column, computed in the same manner as
+   * BatchSizeAccountant so that plain columns are accounted identically to uncompacted data.
+   */
+  virtual uint64_t Bytes() const = 0;
+  /**
+   * Decode the rows [offset, offset + length) into an arrow::Array.
+   */
+  virtual StatusOr<ArrowArrayPtr> Decode(size_t offset, size_t length) const = 0;
+  /**
+   * Random access to the value at the given row. Only valid for INT64 and TIME64NS columns.
+   */
+  virtual int64_t Int64Value(size_t row) const = 0;
+};
+
+struct ColumnEncodingOptions {
+  arrow::MemoryPool* mem_pool = arrow::default_memory_pool();
+  // Dictionary encoding is only considered when the number of distinct values is at most this
+  // fraction of the number of rows.
+  double max_dictionary_ratio = 0.5;
+  // Compression is only considered for string columns whose average value is at least this long.
+  size_t min_compressed_avg_length = 32;
+  // Compressed string data is split into chunks of about this many uncompressed bytes.
+  size_t compressed_chunk_bytes = 64 * 1024;
+  // An encoding is only used if its size is at most this fraction of the plain size.
+  double max_encoded_ratio = 0.8;
+};
+
+/**
+ * Create a plain EncodedColumn that wraps the given arrow::Array without any copies.
+ */
+std::unique_ptr<EncodedColumn> MakePlainColumn(types::DataType data_type, ArrowArrayPtr arr);
+
+/**
+ * EncodeColumn picks the encoding that results in the smallest representation of the given
+ * arrow::Array, falling back to a plain column if no encoding beats it by enough.
+ * @param data_type the DataType of the array.
+ * @param arr the array to encode.
+ * @param opts options controlling which encodings are considered.
+ * @return the encoded column.
+ */
+StatusOr<std::unique_ptr<EncodedColumn>> EncodeColumn(types::DataType data_type,
+                                                      const ArrowArrayPtr& arr,
+                                                      const ColumnEncodingOptions& opts);
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,209 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <absl/strings/str_cat.h>
+
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/table/internal/cold_batch.h"
+#include "src/table_store/table/internal/column_encoding.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+// Checks that decoding every slice of the given encoded column matches the original array.
+void ExpectSlicesEqual(const EncodedColumn& col, const ArrowArrayPtr& expected) {
+  ASSERT_EQ(expected->length(), col.Length());
+  std::vector<std::pair<size_t, size_t>> slices = {
+      {0, col.Length()}, {0, 1}, {1, col.Length() - 1}, {col.Length() / 2, col.Length() / 4}};
+  for (const auto& [offset, length] : slices) {
+    ASSERT_OK_AND_ASSIGN(auto decoded, col.Decode(offset, length));
+    EXPECT_TRUE(decoded->Equals(expected->Slice(offset, length)))
+        << "Slice [" << offset << ", " << offset + length << ") doesn't match";
+  }
+}
+
+TEST(PackedIntsTest, width_for_max_value) {
+  EXPECT_EQ(1, PackedInts::WidthForMaxValue(0));
+  EXPECT_EQ(1, PackedInts::WidthForMaxValue(255));
+  EXPECT_EQ(2, PackedInts::WidthForMaxValue(256));
+  EXPECT_EQ(4, PackedInts::WidthForMaxValue(1UL << 20));
+  EXPECT_EQ(8, PackedInts::WidthForMaxValue(1UL << 40));
+}
+
+TEST(PackedIntsTest, set_get) {
+  PackedInts ints(2, 4);
+  ints.Set(0, 1);
+  ints.Set(3, 65535);
+  EXPECT_EQ(1, ints.Get(0));
+  EXPECT_EQ(0, ints.Get(1));
+  EXPECT_EQ(65535, ints.Get(3));
+  EXPECT_EQ(8, ints.Bytes());
+}
+
+TEST(ColumnEncodingTest, time_column_delta) {
+  std::vector<types::Time64NSValue> times;
+  int64_t t = 1600000000000000000;
+  for (int i = 0; i < 1000; ++i) {
+    t += 1000 + (i % 7) * 13;
+    times.push_back(t);
+  }
+  auto arr = types::ToArrow(times, arrow::default_memory_pool());
+
+  ASSERT_OK_AND_ASSIGN(auto col, EncodeColumn(types::DataType::TIME64NS, arr, {}));
+  EXPECT_EQ(ColumnEncoding::kDelta, col->encoding());
+  EXPECT_LT(col->Bytes(), sizeof(int64_t) * times.size() / 4);
+  ExpectSlicesEqual(*col, arr);
+  for (size_t i = 0; i < times.size(); i += 37) {
+    EXPECT_EQ(times[i].val, col->Int64Value(i));
+  }
+}
+
+TEST(ColumnEncodingTest, int_column_frame_of_reference) {
+  std::vector<types::Int64Value> latencies;
+  for (int i = 0; i < 1000; ++i) {
+    // Non-monotonic values in a small range, far away from zero.
+    latencies.push_back(1000000000 + (i * 7919) % 50000);
+  }
+  auto arr = types::ToArrow(latencies, arrow::default_memory_pool());
+
+  ASSERT_OK_AND_ASSIGN(auto col, EncodeColumn(types::DataType::INT64, arr, {}));
+  EXPECT_EQ(ColumnEncoding::kFrameOfReference, col->encoding());
+  EXPECT_EQ(sizeof(int64_t) + 2 * latencies.size(), col->Bytes());
+  ExpectSlicesEqual(*col, arr);
+  EXPECT_EQ(latencies[123].val, col->Int64Value(123));
+}
+
+TEST(ColumnEncodingTest, int_column_plain) {
+  std::vector<types::Int64Value> values;
+  for (int i = 0; i < 100; ++i) {
+    values.push_back((i % 2 == 0) ? std::numeric_limits<int64_t>::min() + i
+                                  : std::numeric_limits<int64_t>::max() - i);
+  }
+  auto arr = types::ToArrow(values, arrow::default_memory_pool());
+
+  ASSERT_OK_AND_ASSIGN(auto col, EncodeColumn(types::DataType::INT64, arr, {}));
+  EXPECT_EQ(ColumnEncoding::kPlain, col->encoding());
+  EXPECT_EQ(sizeof(int64_t) * values.size(), col->Bytes());
+  ExpectSlicesEqual(*col, arr);
+}
+
+TEST(ColumnEncodingTest, string_column_dictionary) {
+  std::vector<std::string> methods = {"GET", "POST", "PUT", "DELETE"};
+  std::vector<types::StringValue> values;
+  for (int i = 0; i < 1000; ++i) {
+    values.push_back(methods[(i * 31) % methods.size()]);
+  }
+  auto arr = types::ToArrow(values, arrow::default_memory_pool());
+
+  ASSERT_OK_AND_ASSIGN(auto col, EncodeColumn(types::DataType::STRING, arr, {}));
+  EXPECT_EQ(ColumnEncoding::kDictionary, col->encoding());
+  // 1 byte index per row, plus the dictionary itself.
+  EXPECT_EQ(values.size() + 4 * sizeof(int32_t) + 3 + 4 + 3 + 6, col->Bytes());
+  ExpectSlicesEqual(*col, arr);
+}
+
+TEST(ColumnEncodingTest, string_column_compressed) {
+  std::vector<types::StringValue> values;
+  for (int i = 0; i < 200; ++i) {
+    values.push_back(absl::StrCat("{\"id\": ", i, ", \"payload\": \"", std::string(200, 'x'),
+                                  "\"}"));
+  }
+  auto arr = types::ToArrow(values, arrow::default_memory_pool());
+
+  ASSERT_OK_AND_ASSIGN(auto col, EncodeColumn(types::DataType::STRING, arr, {}));
+  EXPECT_EQ(ColumnEncoding::kCompressed, col->encoding());
+  EXPECT_LT(col->Bytes(), MakePlainColumn(types::DataType::STRING, arr)->Bytes() / 4);
+  ExpectSlicesEqual(*col, arr);
+}
+
+TEST(ColumnEncodingTest, string_column_compressed_chunks) {
+  std::vector<types::StringValue> values;
+  for (int i = 0; i < 200; ++i) {
+    values.push_back(absl::StrCat("{\"id\": ", i, ", \"payload\": \"", std::string(200, 'x'),
+                                  "\"}"));
+  }
+  auto arr = types::ToArrow(values, arrow::default_memory_pool());
+
+  // Each chunk holds about 10 rows.
+  ColumnEncodingOptions opts;
+  opts.compressed_chunk_bytes = 2500;
+  ASSERT_OK_AND_ASSIGN(auto col, EncodeColumn(types::DataType::STRING, arr, opts));
+  EXPECT_EQ(ColumnEncoding::kCompressed, col->encoding());
+  ExpectSlicesEqual(*col, arr);
+  // Slices inside a single chunk, on chunk boundaries, and across several chunks.
+  for (const auto& [offset, length] : std::vector<std::pair<size_t, size_t>>{
+           {3, 2}, {0, 10}, {10, 10}, {9, 2}, {15, 50}, {199, 1}, {200, 0}}) {
+    ASSERT_OK_AND_ASSIGN(auto decoded, col->Decode(offset, length));
+    EXPECT_TRUE(decoded->Equals(arr->Slice(offset, length)))
+        << "Slice [" << offset << ", " << offset + length << ") doesn't match";
+  }
+}
+
+TEST(ColumnEncodingTest, string_column_plain) {
+  std::vector<types::StringValue> values;
+  for (int i = 0; i < 100; ++i) {
+    values.push_back(absl::StrCat("10.0.0.", i));
+  }
+  auto arr = types::ToArrow(values, arrow::default_memory_pool());
+
+  ASSERT_OK_AND_ASSIGN(auto col, EncodeColumn(types::DataType::STRING, arr, {}));
+  EXPECT_EQ(ColumnEncoding::kPlain, col->encoding());
+  ExpectSlicesEqual(*col, arr);
+}
+
+TEST(ColdBatchTest, encoded_time_search) {
+  schema::Relation rel({types::DataType::TIME64NS, types::DataType::STRING}, {"time_", "method"});
+  std::vector<types::Time64NSValue> times;
+  std::vector<types::StringValue> methods;
+  for (int i = 0; i < 500; ++i) {
+    // Each time appears twice.
+    times.push_back(1000 + 10 * (i / 2));
+    methods.push_back((i % 3 == 0) ? "GET" : "POST");
+  }
+  std::vector<ArrowArrayPtr> columns = {types::ToArrow(times, arrow::default_memory_pool()),
+                                        types::ToArrow(methods, arrow::default_memory_pool())};
+
+  ASSERT_OK_AND_ASSIGN(auto batch, ColdBatch::Encode(rel, columns, {}));
+  EXPECT_EQ(ColumnEncoding::kDelta, batch.column(0).encoding());
+  EXPECT_EQ(ColumnEncoding::kDictionary, batch.column(1).encoding());
+  EXPECT_LT(batch.Bytes(), ColdBatch(columns).Bytes());
+
+  EXPECT_EQ(500, batch.Length());
+  EXPECT_EQ(0, batch.FindTimeFirstGreaterThanOrEqual(0, 0));
+  EXPECT_EQ(2, batch.FindTimeFirstGreaterThanOrEqual(0, 1005));
+  EXPECT_EQ(2, batch.FindTimeFirstGreaterThanOrEqual(0, 1010));
+  EXPECT_EQ(4, batch.FindTimeFirstGreaterThan(0, 1010));
+  EXPECT_EQ(-1, batch.FindTimeFirstGreaterThanOrEqual(0, 1000000));
+  EXPECT_EQ(1010, batch.GetTimeValue(0, 3));
+
+  schema::RowBatch rb(schema::RowDescriptor({types::DataType::STRING}), 10);
+  ASSERT_OK(batch.AddBatchSliceToRowBatch(100, 10, {1}, &rb));
+  EXPECT_TRUE(rb.ColumnAt(0)->Equals(columns[1]->Slice(100, 10)));
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <atomic>
+#include <utility>
+#include <vector>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+/**
+ * MPSCQueue is an unbounded lock-free multi-producer single-consumer queue.
+ *
+ * Producers push onto an intrusive linked stack with a single CAS. The consumer takes the whole
+ * stack at once with an atomic exchange and reverses it, so values are popped in the order they
+ * were pushed (for the values pushed by any single producer, and for values pushed in a
+ * happens-before order across producers). Since the consumer never unlinks individual nodes,
+ * there's no ABA problem and nodes can be freed as soon as they are popped, without any deferred
+ * reclamation.
+ *
+ * Push is safe to call from any number of threads. PopAll must only be called by one thread at a
+ * time.
+ */
+template <typename T>
+class MPSCQueue : public NotCopyable {
+ public:
+  MPSCQueue() = default;
+  ~MPSCQueue() { PopAll(); }
+
+  void Push(T value) {
+    auto* node = new Node{std::move(value), head_.load(std::memory_order_relaxed)};
+    while (!head_.compare_exchange_weak(node->next, node, std::memory_order_release,
+                                        std::memory_order_relaxed)) {
+    }
+  }
+
+  /**
+   * PopAll removes every value from the queue, and returns them in the order they were pushed.
+   */
+  std::vector<T> PopAll() {
+    Node* node = head_.exchange(nullptr, std::memory_order_acquire);
+    // The stack is newest first, so reverse it before popping the values.
+    Node* oldest = nullptr;
+    while (node != nullptr) {
+      Node* next = node->next;
+      node->next = oldest;
+      oldest = node;
+      node = next;
+    }
+    std::vector<T> values;
+    while (oldest != nullptr) {
+      values.push_back(std::move(oldest->value));
+      Node* next = oldest->next;
+      delete oldest;
+      oldest = next;
+    }
+    return values;
+  }
+
+  bool Empty() const { return head_.load(std::memory_order_acquire) == nullptr; }
+
+ private:
+  struct Node {
+    T value;
+    Node* next;
+  };
+
+  std::atomic<Node*> head_ = nullptr;
+};
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
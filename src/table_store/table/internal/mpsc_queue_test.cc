@@ -0,0 +1,81 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+#include "src/table_store/table/internal/mpsc_queue.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+TEST(MPSCQueueTest, fifo_order) {
+  MPSCQueue<std::unique_ptr<int>> queue;
+  EXPECT_TRUE(queue.Empty());
+  for (int i = 0; i < 5; ++i) {
+    queue.Push(std::make_unique<int>(i));
+  }
+  EXPECT_FALSE(queue.Empty());
+
+  auto values = queue.PopAll();
+  ASSERT_EQ(5U, values.size());
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(i, *values[i]);
+  }
+  EXPECT_TRUE(queue.Empty());
+  EXPECT_EQ(0U, queue.PopAll().size());
+}
+
+TEST(MPSCQueueTest, concurrent_producers) {
+  constexpr int kNumProducers = 4;
+  constexpr int kValuesPerProducer = 10000;
+  MPSCQueue<std::pair<int, int>> queue;
+
+  std::vector<std::thread> producers;
+  for (int producer = 0; producer < kNumProducers; ++producer) {
+    producers.emplace_back([&queue, producer]() {
+      for (int i = 0; i < kValuesPerProducer; ++i) {
+        queue.Push({producer, i});
+      }
+    });
+  }
+
+  // Consume concurrently with the producers, and check that each producer's values are popped in
+  // order.
+  std::vector<int> next_value(kNumProducers, 0);
+  int num_popped = 0;
+  while (num_popped < kNumProducers * kValuesPerProducer) {
+    for (const auto& [producer, value] : queue.PopAll()) {
+      EXPECT_EQ(next_value[producer], value);
+      next_value[producer] = value + 1;
+      ++num_popped;
+    }
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  EXPECT_TRUE(queue.Empty());
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
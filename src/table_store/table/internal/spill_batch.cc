@@ -0,0 +1,305 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <arrow/array.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <absl/strings/str_cat.h>
+#include <absl/strings/substitute.h>
+
+#include "src/common/fs/fs_wrapper.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/table/internal/spill_batch.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+namespace {
+
+// Spilled batches are written with the following layout. All positions are relative to the start
+// of the batch, and each buffer starts at a multiple of kBufferAlignment.
+//   SpillBatchHeader
+//   SpillColumnHeader[num_cols]
+//   column buffers.
+constexpr uint64_t kSpillBatchMagic = 0x4c4c495053584c50;  // "PLXSPILL"
+constexpr uint64_t kBufferAlignment = 64;
+
+struct SpillBatchHeader {
+  uint64_t magic;
+  uint64_t num_rows;
+  uint64_t num_cols;
+};
+
+struct SpillColumnHeader {
+  uint64_t data_type;
+  uint64_t offsets_pos;
+  uint64_t offsets_bytes;
+  uint64_t values_pos;
+  uint64_t values_bytes;
+};
+
+uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+uint64_t PageSize() {
+  static const uint64_t page_size = sysconf(_SC_PAGESIZE);
+  return page_size;
+}
+
+// MappedBuffer is an arrow::Buffer over an mmapped region of a file. The region is unmapped once
+// the buffer (and all slices of it) are released.
+class MappedBuffer : public arrow::Buffer {
+ public:
+  MappedBuffer(const uint8_t* addr, int64_t size) : arrow::Buffer(addr, size) {}
+  ~MappedBuffer() override { munmap(const_cast<uint8_t*>(data()), size()); }
+};
+
+// Appends the given data to out at the next aligned position, and returns that position.
+uint64_t AppendBuffer(std::string* out, const void* data, uint64_t len) {
+  out->resize(AlignUp(out->size(), kBufferAlignment), '\0');
+  uint64_t pos = out->size();
+  if (len > 0) {
+    out->append(static_cast<const char*>(data), len);
+  }
+  return pos;
+}
+
+template <typename TSpilledColumn>
+Status SerializeColumn(const ArrowArrayPtr& arr, std::string* out, TSpilledColumn* col) {
+  if (arr->null_count() > 0) {
+    return error::Unimplemented("Spilling arrays with null values is not supported.");
+  }
+  int64_t length = arr->length();
+  switch (arr->type_id()) {
+    case arrow::Type::STRING: {
+      auto str_arr = static_cast<const arrow::StringArray*>(arr.get());
+      int32_t start = str_arr->value_offset(0);
+      // Rebase the offsets so that the spilled array doesn't depend on the slice it came from.
+      std::vector<int32_t> offsets(length + 1);
+      for (int64_t i = 0; i <= length; ++i) {
+        offsets[i] = str_arr->value_offset(i) - start;
+      }
+      col->offsets_bytes = offsets.size() * sizeof(int32_t);
+      col->offsets_pos = AppendBuffer(out, offsets.data(), col->offsets_bytes);
+      col->values_bytes = offsets[length];
+      col->values_pos = AppendBuffer(
+          out, col->values_bytes > 0 ? str_arr->value_data()->data() + start : nullptr,
+          col->values_bytes);
+      break;
+    }
+    case arrow::Type::BOOL: {
+      // Boolean arrays are bit-packed, so repack them in case the array doesn't start on a byte
+      // boundary.
+      auto bool_arr = static_cast<const arrow::BooleanArray*>(arr.get());
+      std::string bits(AlignUp(length, 8) / 8, '\0');
+      for (int64_t i = 0; i < length; ++i) {
+        if (bool_arr->Value(i)) {
+          bits[i / 8] |= static_cast<char>(1 << (i % 8));
+        }
+      }
+      col->values_bytes = bits.size();
+      col->values_pos = AppendBuffer(out, bits.data(), col->values_bytes);
+      break;
+    }
+    default: {
+      uint64_t width = types::ArrowTypeToBytes(arr->type_id());
+      col->values_bytes = length * width;
+      col->values_pos =
+          AppendBuffer(out, arr->data()->buffers[1]->data() + arr->offset() * width,
+                       col->values_bytes);
+      break;
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+StatusOr<std::shared_ptr<SpillFile>> SpillFile::Create(const std::filesystem::path& dir,
+                                                       std::string_view name_prefix) {
+  PX_RETURN_IF_ERROR(fs::CreateDirectories(dir));
+  std::string path = (dir / absl::StrCat(name_prefix, ".XXXXXX")).string();
+  int fd = mkstemp(path.data());
+  if (fd < 0) {
+    return error::System("Failed to create spill file in $0: $1", dir.string(),
+                         std::strerror(errno));
+  }
+  // Unlink the file straight away, so that its disk space is released once the file is closed,
+  // even if the process doesn't exit cleanly.
+  if (unlink(path.c_str()) != 0) {
+    int unlink_errno = errno;
+    close(fd);
+    return error::System("Failed to unlink spill file $0: $1", path, std::strerror(unlink_errno));
+  }
+  return std::shared_ptr<SpillFile>(new SpillFile(fd));
+}
+
+SpillFile::~SpillFile() { close(fd_); }
+
+StatusOr<uint64_t> SpillFile::Append(std::string_view data) {
+  uint64_t offset = AlignUp(size_, PageSize());
+  uint64_t written = 0;
+  while (written < data.size()) {
+    ssize_t n = pwrite(fd_, data.data() + written, data.size() - written, offset + written);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return error::System("Failed to write to spill file: $0", std::strerror(errno));
+    }
+    written += n;
+  }
+  size_ = offset + data.size();
+  return offset;
+}
+
+StatusOr<SpillBatch> SpillBatch::Write(const ColdBatch& batch, std::shared_ptr<SpillFile> file) {
+  size_t length = batch.Length();
+  size_t num_cols = batch.NumColumns();
+
+  // Leave space for the headers at the front, they are filled in once the buffer positions are
+  // known.
+  std::string out(sizeof(SpillBatchHeader) + num_cols * sizeof(SpillColumnHeader), '\0');
+  std::vector<SpilledColumn> columns(num_cols);
+  std::vector<std::vector<Time>> time_samples(num_cols);
+  for (size_t col_idx = 0; col_idx < num_cols; ++col_idx) {
+    PX_ASSIGN_OR_RETURN(auto arr, batch.column(col_idx).Decode(0, length));
+    columns[col_idx].type = arr->type();
+    PX_RETURN_IF_ERROR(SerializeColumn(arr, &out, &columns[col_idx]));
+    if (arr->type_id() == arrow::Type::TIME64) {
+      for (size_t row = 0; row < length; row += kTimeSampleStride) {
+        time_samples[col_idx].push_back(
+            types::GetValueFromArrowArray<types::DataType::TIME64NS>(arr.get(), row));
+      }
+    }
+  }
+
+  SpillBatchHeader header{kSpillBatchMagic, length, num_cols};
+  std::memcpy(out.data(), &header, sizeof(header));
+  for (const auto& [col_idx, col] : Enumerate(columns)) {
+    SpillColumnHeader col_header{
+        static_cast<uint64_t>(types::ArrowToDataType(col.type->id())),
+        col.offsets_pos,
+        col.offsets_bytes,
+        col.values_pos,
+        col.values_bytes,
+    };
+    std::memcpy(out.data() + sizeof(header) + col_idx * sizeof(col_header), &col_header,
+                sizeof(col_header));
+  }
+
+  PX_ASSIGN_OR_RETURN(uint64_t file_offset, file->Append(out));
+  return SpillBatch(std::move(file), file_offset, AlignUp(out.size(), PageSize()), length,
+                    std::move(columns), std::move(time_samples), batch.zone_map());
+}
+
+StatusOr<std::shared_ptr<arrow::Buffer>> SpillBatch::Map() const {
+  void* addr = mmap(nullptr, bytes_, PROT_READ, MAP_SHARED, file_->fd(), file_offset_);
+  if (addr == MAP_FAILED) {
+    return error::System("Failed to mmap spilled batch: $0", std::strerror(errno));
+  }
+  return std::shared_ptr<arrow::Buffer>(
+      std::make_shared<MappedBuffer>(static_cast<const uint8_t*>(addr), bytes_));
+}
+
+std::vector<Time> SpillBatch::ReadTimes(int64_t time_col_idx, size_t begin, size_t end) const {
+  std::vector<Time> times(end - begin);
+  uint64_t pos = file_offset_ + columns_[time_col_idx].values_pos + begin * sizeof(Time);
+  ssize_t n = pread(file_->fd(), times.data(), times.size() * sizeof(Time), pos);
+  LOG_IF(DFATAL, n != static_cast<ssize_t>(times.size() * sizeof(Time))) << absl::Substitute(
+      "Failed to read time values from spill file: $0", std::strerror(errno));
+  return times;
+}
+
+template <typename TBeforeFn>
+size_t SpillBatch::PartitionPoint(int64_t time_col_idx, TBeforeFn before) const {
+  const auto& samples = time_samples_[time_col_idx];
+  DCHECK_EQ(samples.size(), (length_ + kTimeSampleStride - 1) / kTimeSampleStride);
+  // The answer is after the last sample that is before, and at or before the next sample.
+  size_t sample = std::partition_point(samples.begin(), samples.end(), before) - samples.begin();
+  if (sample == 0) {
+    return 0;
+  }
+  size_t begin = (sample - 1) * kTimeSampleStride + 1;
+  size_t end = std::min(sample * kTimeSampleStride, length_);
+  if (begin >= end) {
+    return end;
+  }
+  auto times = ReadTimes(time_col_idx, begin, end);
+  return begin + (std::partition_point(times.begin(), times.end(), before) - times.begin());
+}
+
+int64_t SpillBatch::FindTimeFirstGreaterThanOrEqual(int64_t time_col_idx, Time time) const {
+  size_t row = PartitionPoint(time_col_idx, [time](Time t) { return t < time; });
+  if (row == length_) {
+    return -1;
+  }
+  return row;
+}
+
+int64_t SpillBatch::FindTimeFirstGreaterThan(int64_t time_col_idx, Time time) const {
+  return PartitionPoint(time_col_idx, [time](Time t) { return t <= time; });
+}
+
+Time SpillBatch::GetTimeValue(int64_t time_col_idx, int64_t row_idx) const {
+  if (row_idx % kTimeSampleStride == 0) {
+    return time_samples_[time_col_idx][row_idx / kTimeSampleStride];
+  }
+  return ReadTimes(time_col_idx, row_idx, row_idx + 1)[0];
+}
+
+Status SpillBatch::AddBatchSliceToRowBatch(size_t row_offset, size_t batch_size,
+                                           const std::vector<int64_t>& cols,
+                                           schema::RowBatch* output_rb) const {
+  PX_ASSIGN_OR_RETURN(auto mapped, Map());
+  for (auto col_idx : cols) {
+    const auto& col = columns_[col_idx];
+    // Spilled arrays never have nulls, so the validity bitmap is always empty.
+    std::vector<std::shared_ptr<arrow::Buffer>> buffers = {nullptr};
+    if (col.type->id() == arrow::Type::STRING) {
+      buffers.push_back(arrow::SliceBuffer(mapped, col.offsets_pos, col.offsets_bytes));
+    }
+    buffers.push_back(arrow::SliceBuffer(mapped, col.values_pos, col.values_bytes));
+    auto data = arrow::ArrayData::Make(col.type, length_, std::move(buffers), /*null_count*/ 0);
+    PX_RETURN_IF_ERROR(output_rb->AddColumn(arrow::MakeArray(data)->Slice(row_offset, batch_size)));
+  }
+  return Status::OK();
+}
+
+StatusOr<SpillBatch> SpillWriter::Write(const ColdBatch& batch) {
+  if (current_file_ == nullptr || current_file_->size() >= max_file_size_) {
+    PX_ASSIGN_OR_RETURN(current_file_, SpillFile::Create(dir_, name_prefix_));
+  }
+  return SpillBatch::Write(batch, current_file_);
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
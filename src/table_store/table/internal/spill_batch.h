@@ -0,0 +1,209 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/buffer.h>
+#include <arrow/type.h>
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/table_store/schema/row_batch.h"
+#include "src/table_store/table/internal/cold_batch.h"
+#include "src/table_store/table/internal/types.h"
+#include "src/table_store/table/internal/zone_map.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+/**
+ * SpillFile is an append-only file that spilled batches are written to. The file is unlinked as
+ * soon as it is created, so its disk space is released once the SpillFile is destroyed (ie. once
+ * every SpillBatch stored in it has been expired), or when the process exits.
+ */
+class SpillFile {
+ public:
+  /**
+   * Create a new SpillFile in the given directory. The directory is created if it doesn't exist.
+   * @param dir the directory to create the file in.
+   * @param name_prefix prefix of the (temporary) file name.
+   */
+  static StatusOr<std::shared_ptr<SpillFile>> Create(const std::filesystem::path& dir,
+                                                     std::string_view name_prefix);
+  ~SpillFile();
+
+  /**
+   * Append writes the given data to the end of the file, at an offset aligned to the page size so
+   * that the data can later be mmapped directly.
+   * @return the offset within the file that the data was written to.
+   */
+  StatusOr<uint64_t> Append(std::string_view data);
+
+  int fd() const { return fd_; }
+  uint64_t size() const { return size_; }
+
+ private:
+  explicit SpillFile(int fd) : fd_(fd) {}
+
+  const int fd_;
+  uint64_t size_ = 0;
+};
+
+/**
+ * SpillBatch is a batch in the spill store, ie. a cold batch that was expired from memory and
+ * written to a SpillFile. The batch is stored as a contiguous region of the file, in a columnar
+ * format that mirrors the layout of arrow arrays (a fixed width values buffer per column, plus an
+ * offsets buffer for string columns), so that reading a batch only requires mmapping its region of
+ * the file and wrapping the mapped buffers in arrow arrays, without any copies or decoding.
+ *
+ * Only the layout of the batch, every kTimeSampleStride'th value of its time columns, and the cold
+ * batch's zone map (if it had one) are kept in memory. A time lookup searches the samples, and then
+ * reads the single stride of the time column between two samples from the file.
+ */
+class SpillBatch {
+ public:
+  static constexpr size_t kTimeSampleStride = 64;
+
+  /**
+   * Write serializes the given cold batch (decoding any encoded columns) and appends it to the
+   * given file.
+   * @param batch the cold batch to spill.
+   * @param file the file to write the batch to.
+   * @return the SpillBatch referencing the newly written data.
+   */
+  static StatusOr<SpillBatch> Write(const ColdBatch& batch, std::shared_ptr<SpillFile> file);
+
+  SpillBatch(SpillBatch&&) = default;
+  SpillBatch& operator=(SpillBatch&&) = default;
+
+  /**
+   * Length returns the number of rows in this batch.
+   */
+  size_t Length() const { return length_; }
+  /**
+   * Bytes returns the number of bytes this batch takes up on disk (including alignment padding).
+   */
+  uint64_t Bytes() const { return bytes_; }
+  /**
+   * FindTimeFirstGreaterThanOrEqual returns the first row index within this batch that has time
+   * greater than or equal to the given time, or -1 if no such row exists.
+   */
+  int64_t FindTimeFirstGreaterThanOrEqual(int64_t time_col_idx, Time time) const;
+  /**
+   * FindTimeFirstGreaterThan returns the first row index within this batch that has time greater
+   * than the given time, or Length() if no such row exists.
+   */
+  int64_t FindTimeFirstGreaterThan(int64_t time_col_idx, Time time) const;
+  /**
+   * GetTimeValue returns the value of the time column at the given row index.
+   */
+  Time GetTimeValue(int64_t time_col_idx, int64_t row_idx) const;
+  /**
+   * AddBatchSliceToRowBatch maps this batch's region of the file, and adds slices of the requested
+   * columns to the given output schema::RowBatch. The output arrays reference the mapped memory
+   * directly, which stays mapped until all of the arrays are released.
+   * @param row_offset, row index within this batch to start the output slice at.
+   * @param batch_size, size of the output slice.
+   * @param cols, a vector of column indices to include in the output slice.
+   * @param output_rb, a pointer to the row batch to add the columns to.
+   * @return Status, errors if mapping the file or adding columns to the row batch fails.
+   */
+  Status AddBatchSliceToRowBatch(size_t row_offset, size_t batch_size,
+                                 const std::vector<int64_t>& cols,
+                                 schema::RowBatch* output_rb) const;
+  /**
+   * MayMatch returns false if the batch's zone map shows that no row in the batch can match all of
+   * the given predicates. Batches without a zone map always match.
+   */
+  bool MayMatch(const std::vector<ColumnPredicate>& predicates) const {
+    return zone_map_ == nullptr || zone_map_->MayMatch(predicates);
+  }
+
+ private:
+  struct SpilledColumn {
+    std::shared_ptr<arrow::DataType> type;
+    // Positions of the column's buffers, relative to the start of the batch. The offsets buffer is
+    // only used for string columns.
+    uint64_t offsets_pos = 0;
+    uint64_t offsets_bytes = 0;
+    uint64_t values_pos = 0;
+    uint64_t values_bytes = 0;
+  };
+
+  SpillBatch(std::shared_ptr<SpillFile> file, uint64_t file_offset, uint64_t bytes, size_t length,
+             std::vector<SpilledColumn> columns, std::vector<std::vector<Time>> time_samples,
+             std::shared_ptr<const ZoneMap> zone_map)
+      : file_(std::move(file)),
+        file_offset_(file_offset),
+        bytes_(bytes),
+        length_(length),
+        columns_(std::move(columns)),
+        time_samples_(std::move(time_samples)),
+        zone_map_(std::move(zone_map)) {}
+
+  StatusOr<std::shared_ptr<arrow::Buffer>> Map() const;
+  // Reads the values of the time column for the rows [begin, end) from the file.
+  std::vector<Time> ReadTimes(int64_t time_col_idx, size_t begin, size_t end) const;
+  // Returns the first row for which before(time) is false, given that before is true for a prefix
+  // of the rows.
+  template <typename TBeforeFn>
+  size_t PartitionPoint(int64_t time_col_idx, TBeforeFn before) const;
+
+  std::shared_ptr<SpillFile> file_;
+  uint64_t file_offset_;
+  uint64_t bytes_;
+  size_t length_;
+  std::vector<SpilledColumn> columns_;
+  // The values of rows 0, kTimeSampleStride, 2 * kTimeSampleStride, ... of each TIME64NS column.
+  // Empty for the other columns.
+  std::vector<std::vector<Time>> time_samples_;
+  std::shared_ptr<const ZoneMap> zone_map_;
+};
+
+/**
+ * SpillWriter writes spilled batches for a single table, rotating to a new SpillFile once the
+ * current one reaches `max_file_size`. Older files are released once all of their batches have
+ * been expired.
+ */
+class SpillWriter {
+ public:
+  SpillWriter(std::filesystem::path dir, std::string name_prefix, uint64_t max_file_size)
+      : dir_(std::move(dir)), name_prefix_(std::move(name_prefix)), max_file_size_(max_file_size) {}
+
+  /**
+   * Write appends the given cold batch to the current spill file.
+   */
+  StatusOr<SpillBatch> Write(const ColdBatch& batch);
+
+ private:
+  const std::filesystem::path dir_;
+  const std::string name_prefix_;
+  const uint64_t max_file_size_;
+  std::shared_ptr<SpillFile> current_file_;
+};
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
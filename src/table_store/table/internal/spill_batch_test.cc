@@ -0,0 +1,163 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <absl/strings/str_cat.h>
+
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/table/internal/spill_batch.h"
+#include "src/table_store/table/internal/store_with_row_accounting.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+class SpillBatchTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    rel_ = std::make_unique<schema::Relation>(
+        std::vector<types::DataType>{types::DataType::TIME64NS, types::DataType::BOOLEAN,
+                                     types::DataType::STRING, types::DataType::FLOAT64},
+        std::vector<std::string>{"time_", "col1", "col2", "col3"});
+  }
+
+  std::vector<ArrowArrayPtr> MakeColumns(int64_t start_time, int64_t num_rows) {
+    std::vector<types::Time64NSValue> times;
+    std::vector<types::BoolValue> bools;
+    std::vector<types::StringValue> strings;
+    std::vector<types::Float64Value> floats;
+    for (int64_t i = 0; i < num_rows; ++i) {
+      times.push_back(start_time + 10 * i);
+      bools.push_back(i % 3 == 0);
+      strings.push_back(absl::StrCat("value_", i));
+      floats.push_back(0.5 * i);
+    }
+    return {types::ToArrow(times, arrow::default_memory_pool()),
+            types::ToArrow(bools, arrow::default_memory_pool()),
+            types::ToArrow(strings, arrow::default_memory_pool()),
+            types::ToArrow(floats, arrow::default_memory_pool())};
+  }
+
+  std::unique_ptr<schema::Relation> rel_;
+  px::testing::TempDir temp_dir_;
+};
+
+TEST_F(SpillBatchTest, write_and_read) {
+  auto columns = MakeColumns(1000, 100);
+  ColdBatch cold_batch(columns);
+  SpillWriter writer(temp_dir_.path(), "test_table", 1024 * 1024);
+  ASSERT_OK_AND_ASSIGN(auto spill_batch, writer.Write(cold_batch));
+
+  EXPECT_EQ(100, spill_batch.Length());
+  EXPECT_GT(spill_batch.Bytes(), 0U);
+
+  schema::RowBatch rb(schema::RowDescriptor(rel_->col_types()), 100);
+  ASSERT_OK(spill_batch.AddBatchSliceToRowBatch(0, 100, {0, 1, 2, 3}, &rb));
+  for (const auto& [col_idx, col] : Enumerate(columns)) {
+    EXPECT_TRUE(rb.ColumnAt(col_idx)->Equals(col)) << "Column " << col_idx << " doesn't match";
+  }
+
+  // Unaligned slices, to check that bit-packed and offset buffers are sliced correctly.
+  schema::RowBatch slice_rb(
+      schema::RowDescriptor({types::DataType::STRING, types::DataType::BOOLEAN}), 13);
+  ASSERT_OK(spill_batch.AddBatchSliceToRowBatch(37, 13, {2, 1}, &slice_rb));
+  EXPECT_TRUE(slice_rb.ColumnAt(0)->Equals(columns[2]->Slice(37, 13)));
+  EXPECT_TRUE(slice_rb.ColumnAt(1)->Equals(columns[1]->Slice(37, 13)));
+}
+
+TEST_F(SpillBatchTest, time_search) {
+  ColdBatch cold_batch(MakeColumns(1000, 100));
+  SpillWriter writer(temp_dir_.path(), "test_table", 1024 * 1024);
+  ASSERT_OK_AND_ASSIGN(auto spill_batch, writer.Write(cold_batch));
+
+  EXPECT_EQ(1000, spill_batch.GetTimeValue(0, 0));
+  EXPECT_EQ(1990, spill_batch.GetTimeValue(0, 99));
+  EXPECT_EQ(0, spill_batch.FindTimeFirstGreaterThanOrEqual(0, 0));
+  EXPECT_EQ(5, spill_batch.FindTimeFirstGreaterThanOrEqual(0, 1045));
+  EXPECT_EQ(5, spill_batch.FindTimeFirstGreaterThanOrEqual(0, 1050));
+  EXPECT_EQ(6, spill_batch.FindTimeFirstGreaterThan(0, 1050));
+  EXPECT_EQ(-1, spill_batch.FindTimeFirstGreaterThanOrEqual(0, 2000));
+  EXPECT_EQ(100, spill_batch.FindTimeFirstGreaterThan(0, 2000));
+}
+
+TEST_F(SpillBatchTest, time_search_across_samples) {
+  // Times are 1000, 1010, ..., with a few strides of samples and a partial last stride.
+  constexpr int64_t kLength = 3 * SpillBatch::kTimeSampleStride + 5;
+  ColdBatch cold_batch(MakeColumns(1000, kLength));
+  SpillWriter writer(temp_dir_.path(), "test_table", 1024 * 1024);
+  ASSERT_OK_AND_ASSIGN(auto spill_batch, writer.Write(cold_batch));
+
+  for (int64_t row = 0; row < kLength; ++row) {
+    Time time = 1000 + 10 * row;
+    EXPECT_EQ(time, spill_batch.GetTimeValue(0, row));
+    EXPECT_EQ(row, spill_batch.FindTimeFirstGreaterThanOrEqual(0, time));
+    EXPECT_EQ(row, spill_batch.FindTimeFirstGreaterThanOrEqual(0, time - 5));
+    EXPECT_EQ(row + 1, spill_batch.FindTimeFirstGreaterThan(0, time));
+    EXPECT_EQ(row + 1, spill_batch.FindTimeFirstGreaterThan(0, time + 5));
+  }
+  EXPECT_EQ(-1, spill_batch.FindTimeFirstGreaterThanOrEqual(0, 1000 + 10 * kLength));
+  EXPECT_EQ(kLength, spill_batch.FindTimeFirstGreaterThan(0, 1000 + 10 * kLength));
+}
+
+TEST_F(SpillBatchTest, encoded_cold_batch) {
+  auto columns = MakeColumns(1000, 500);
+  ASSERT_OK_AND_ASSIGN(auto cold_batch, ColdBatch::Encode(*rel_, columns, {}));
+  SpillWriter writer(temp_dir_.path(), "test_table", 1024 * 1024);
+  ASSERT_OK_AND_ASSIGN(auto spill_batch, writer.Write(cold_batch));
+
+  schema::RowBatch rb(schema::RowDescriptor({types::DataType::TIME64NS}), 500);
+  ASSERT_OK(spill_batch.AddBatchSliceToRowBatch(0, 500, {0}, &rb));
+  EXPECT_TRUE(rb.ColumnAt(0)->Equals(columns[0]));
+}
+
+TEST_F(SpillBatchTest, spill_store) {
+  // Use a small max file size, so that the writer rotates through multiple files.
+  SpillWriter writer(temp_dir_.path(), "test_table", 1);
+  StoreWithRowTimeAccounting<StoreType::Spill> store(*rel_, 0);
+
+  for (int64_t i = 0; i < 4; ++i) {
+    ColdBatch cold_batch(MakeColumns(1000 + 1000 * i, 100));
+    ASSERT_OK_AND_ASSIGN(auto spill_batch, writer.Write(cold_batch));
+    store.EmplaceBack(100 * i, std::move(spill_batch));
+  }
+  store.PopFront();
+
+  EXPECT_EQ(100, store.FirstRowID());
+  EXPECT_EQ(399, store.LastRowID());
+  EXPECT_EQ(2000, store.MinTime());
+  EXPECT_EQ(4990, store.MaxTime());
+  EXPECT_EQ(std::optional<RowID>(215), store.FindRowIDFromTimeFirstGreaterThanOrEqual(3145));
+  EXPECT_EQ(std::optional<RowID>(216), store.FindRowIDFromTimeFirstGreaterThan(3150));
+  EXPECT_EQ(std::nullopt, store.FindRowIDFromTimeFirstGreaterThanOrEqual(5000));
+
+  RowID last_read_row_id = 249;
+  BatchHints hints{};
+  ASSERT_OK_AND_ASSIGN(auto rb, store.GetNextRowBatch(&last_read_row_id, &hints, 260, {0}));
+  EXPECT_EQ(10, rb->num_rows());
+  EXPECT_EQ(259, last_read_row_id);
+  EXPECT_EQ(3500,
+            types::GetValueFromArrowArray<types::DataType::TIME64NS>(rb->ColumnAt(0).get(), 0));
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
@@ -28,7 +28,10 @@
 #include "src/shared/types/arrow_adapter.h"
 #include "src/shared/types/column_wrapper.h"
 #include "src/table_store/schema/relation.h"
+#include "src/table_store/table/internal/cold_batch.h"
+#include "src/table_store/table/internal/spill_batch.h"
 #include "src/table_store/table/internal/types.h"
+#include "src/table_store/table/internal/zone_map.h"
 
 namespace px {
 namespace table_store {
@@ -56,10 +59,10 @@ void constexpr_else_static_assert_false() {
 /**
  * StoreWithRowTimeAccounting stores a deque of batches (hot or cold) and keeps track of the first
  * and last unique RowID's for each batch, as well as the first and last times for each batch (if
- * there is a time column in the table). The template parameter specifies whether this is the Hot or
- * Cold store. Since the logic between the Hot and Cold stores is roughly identical, this class
- * deduplicates that logic while allowing the explicit batch accesses to use the correct Hot or Cold
- * batch methods.
+ * there is a time column in the table). The template parameter specifies whether this is the Hot,
+ * Cold or Spill store. Since the logic between the stores is roughly identical, this class
+ * deduplicates that logic while allowing the explicit batch accesses to use the correct batch
+ * methods for each store.
  *
  * Times are used to find row batch's within a given time
  * range. RowIDs are used in case table compaction occurs during query execution. Since the size of
@@ -87,12 +90,16 @@ class StoreWithRowTimeAccounting {
    * @param stop_row_id, an optional unique RowID to stop the batch at. If provided, the batch will
    * be sliced such that no rows are included with `RowID >= stop_row_id.value()`.
    * @param cols, a vector of column indices to include in the outputted row batch.
+   * @param predicates, column predicates that rows must match. Batches where no row can match all
+   * of the predicates (according to the batch's zone map) are skipped, and `last_read_row_id` is
+   * advanced past them. Rows within the outputted batch aren't filtered.
    * @return a unique_ptr to the RowBatch or nullptr if there are no more rows in this store that
    * match the parameters above. On error returns a Status.
    */
   StatusOr<std::unique_ptr<schema::RowBatch>> GetNextRowBatch(
       RowID* last_read_row_id, BatchHints* hints, std::optional<RowID> stop_row_id,
-      const std::vector<int64_t>& cols) const {
+      const std::vector<int64_t>& cols,
+      const std::vector<ColumnPredicate>& predicates = {}) const {
     auto start_row_id = *last_read_row_id + 1;
     if (batches_.empty() || start_row_id < FirstRowID() || start_row_id > LastRowID()) {
       return std::unique_ptr<schema::RowBatch>(nullptr);
@@ -108,6 +115,20 @@ class StoreWithRowTimeAccounting {
       batch_id = FindBatchIDFromRowID(start_row_id);
     }
 
+    while (!BatchMayMatch(GetBatchFromBatchID(batch_id), predicates)) {
+      RowID skipped_last_row_id = BatchLastRowID(batch_id);
+      if (stop_row_id.has_value() && skipped_last_row_id >= stop_row_id.value() - 1) {
+        *last_read_row_id = stop_row_id.value() - 1;
+        return std::unique_ptr<schema::RowBatch>(nullptr);
+      }
+      *last_read_row_id = skipped_last_row_id;
+      if (batch_id == LastBatchID()) {
+        return std::unique_ptr<schema::RowBatch>(nullptr);
+      }
+      batch_id++;
+      start_row_id = skipped_last_row_id + 1;
+    }
+
     const auto& batch = GetBatchFromBatchID(batch_id);
     RowID batch_first_row_id = BatchFirstRowID(batch_id);
     RowID batch_last_row_id = BatchLastRowID(batch_id);
@@ -155,19 +176,19 @@ class StoreWithRowTimeAccounting {
   }
 
   /**
-   * PopFront removes the first batch in the store, and returns an rvalue reference to it.
-   * @return rvalue reference to the removed batch.
+   * PopFront removes the first batch in the store, and returns it.
+   * @return the removed batch.
    */
-  TBatch&& PopFront() {
+  TBatch PopFront() {
     DCHECK(!batches_.empty());
     first_batch_id_++;
 
     row_ids_.pop_front();
     if (time_col_idx_ != -1) times_.pop_front();
 
-    auto&& front = std::move(batches_.front());
+    TBatch front = std::move(batches_.front());
     batches_.pop_front();
-    return std::move(front);
+    return front;
   }
 
   /**
@@ -340,64 +361,38 @@ class StoreWithRowTimeAccounting {
     return first_batch_id_ + std::distance(row_ids_.begin(), it);
   }
 
-  size_t BatchLength(const TBatch& batch) const {
-    if constexpr (std::is_same_v<ColdBatch, TBatch>) {
-      return batch[0]->length();
-    } else if constexpr (std::is_same_v<HotBatch, TBatch>) {
-      return batch.Length();
+  bool BatchMayMatch(const TBatch& batch, const std::vector<ColumnPredicate>& predicates) const {
+    if (predicates.empty()) {
+      return true;
+    }
+    if constexpr (std::is_same_v<TBatch, HotBatch>) {
+      // Hot batches don't have zone maps.
+      return true;
     } else {
-      constexpr_else_static_assert_false();
+      return batch.MayMatch(predicates);
     }
   }
 
+  size_t BatchLength(const TBatch& batch) const {
+    return batch.Length();
+  }
+
   size_t FindTimeFirstGreaterThanOrEqual(const TBatch& batch, Time time) const {
-    if constexpr (std::is_same_v<TBatch, ColdBatch>) {
-      return types::SearchArrowArrayGreaterThanOrEqual<types::DataType::TIME64NS>(
-          batch[time_col_idx_].get(), time);
-    } else if constexpr (std::is_same_v<TBatch, HotBatch>) {
-      return batch.FindTimeFirstGreaterThanOrEqual(time_col_idx_, time);
-    } else {
-      constexpr_else_static_assert_false();
-    }
+    return batch.FindTimeFirstGreaterThanOrEqual(time_col_idx_, time);
   }
 
   size_t FindTimeFirstGreaterThan(const TBatch& batch, Time time) const {
-    if constexpr (std::is_same_v<TBatch, ColdBatch>) {
-      return types::SearchArrowArrayLessThanOrEqual<types::DataType::TIME64NS>(
-                 batch[time_col_idx_].get(), time) +
-             1;
-    } else if constexpr (std::is_same_v<TBatch, HotBatch>) {
-      return batch.FindTimeFirstGreaterThan(time_col_idx_, time);
-    } else {
-      constexpr_else_static_assert_false();
-    }
+    return batch.FindTimeFirstGreaterThan(time_col_idx_, time);
   }
 
   Time GetTimeValue(const TBatch& batch, int64_t row_idx) const {
-    if constexpr (std::is_same_v<TBatch, ColdBatch>) {
-      return types::GetValueFromArrowArray<types::DataType::TIME64NS>(batch[time_col_idx_].get(),
-                                                                      row_idx);
-    } else if constexpr (std::is_same_v<TBatch, HotBatch>) {
-      return batch.GetTimeValue(time_col_idx_, row_idx);
-    } else {
-      constexpr_else_static_assert_false();
-    }
+    return batch.GetTimeValue(time_col_idx_, row_idx);
   }
 
   Status AddBatchSliceToRowBatch(const TBatch& batch, size_t row_offset, size_t batch_size,
                                  const std::vector<int64_t>& cols,
                                  schema::RowBatch* output_rb) const {
-    if constexpr (std::is_same_v<TBatch, ColdBatch>) {
-      for (auto col_idx : cols) {
-        auto arr = batch[col_idx]->Slice(row_offset, batch_size);
-        PX_RETURN_IF_ERROR(output_rb->AddColumn(arr));
-      }
-      return Status::OK();
-    } else if constexpr (std::is_same_v<TBatch, HotBatch>) {
-      return batch.AddBatchSliceToRowBatch(row_offset, batch_size, cols, output_rb);
-    } else {
-      constexpr_else_static_assert_false();
-    }
+    return batch.AddBatchSliceToRowBatch(row_offset, batch_size, cols, output_rb);
   }
 
   BatchID first_batch_id_ = 0;
@@ -53,6 +53,7 @@ struct RecordBatchWithCache {
 enum StoreType {
   Hot,
   Cold,
+  Spill,
 };
 
 struct BatchHints {
@@ -61,8 +62,8 @@ struct BatchHints {
 };
 
 class RecordOrRowBatch;
-
-using ColdBatch = std::vector<ArrowArrayPtr>;
+class ColdBatch;
+class SpillBatch;
 
 template <StoreType type>
 struct StoreTypeTraits {};
@@ -74,6 +75,10 @@ template <>
 struct StoreTypeTraits<StoreType::Cold> {
   using batch_type = ColdBatch;
 };
+template <>
+struct StoreTypeTraits<StoreType::Spill> {
+  using batch_type = SpillBatch;
+};
 
 }  // namespace internal
 }  // namespace table_store
@@ -0,0 +1,216 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+#include <absl/container/flat_hash_set.h>
+#include <absl/hash/hash.h>
+
+#include "src/common/base/base.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/table/internal/zone_map.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+namespace {
+
+uint64_t HashString(std::string_view value) { return absl::Hash<std::string_view>{}(value); }
+
+template <types::DataType TDataType>
+void UpdateMinMax(const arrow::Array* arr, ColumnZoneMap* zone_map) {
+  std::optional<long double> min;
+  std::optional<long double> max;
+  for (int64_t i = 0; i < arr->length(); ++i) {
+    if (arr->IsNull(i)) {
+      continue;
+    }
+    long double value = types::GetValueFromArrowArray<TDataType>(arr, i);
+    if (std::isnan(value)) {
+      // NaNs aren't ordered, so min/max can't be used to skip this column.
+      return;
+    }
+    if (!min.has_value() || value < min.value()) {
+      min = value;
+    }
+    if (!max.has_value() || value > max.value()) {
+      max = value;
+    }
+  }
+  zone_map->min = min;
+  zone_map->max = max;
+}
+
+void BuildBloomFilter(const arrow::Array* arr, ColumnZoneMap* zone_map) {
+  absl::flat_hash_set<std::string_view> distinct;
+  for (int64_t i = 0; i < arr->length(); ++i) {
+    if (!arr->IsNull(i)) {
+      distinct.insert(types::GetStringViewFromArrowArray(arr, i));
+    }
+  }
+  zone_map->bloom_filter = StringBloomFilter::Create(distinct.size());
+  for (const auto& value : distinct) {
+    zone_map->bloom_filter->Insert(value);
+  }
+}
+
+long double NumericValue(const ColumnPredicate& predicate) {
+  if (std::holds_alternative<bool>(predicate.value)) {
+    return std::get<bool>(predicate.value) ? 1 : 0;
+  }
+  if (std::holds_alternative<int64_t>(predicate.value)) {
+    return std::get<int64_t>(predicate.value);
+  }
+  return std::get<double>(predicate.value);
+}
+
+}  // namespace
+
+std::unique_ptr<StringBloomFilter> StringBloomFilter::Create(size_t num_distinct_values) {
+  size_t num_bits = std::clamp<size_t>(num_distinct_values * kBitsPerValue, 64, kMaxBits);
+  return std::unique_ptr<StringBloomFilter>(new StringBloomFilter((num_bits + 63) / 64));
+}
+
+// Both Insert and MayContain derive the kNumHashes bit positions from a single 64-bit hash, using
+// double hashing (h1 + i * h2).
+void StringBloomFilter::Insert(std::string_view value) {
+  uint64_t hash = HashString(value);
+  uint64_t h1 = hash;
+  uint64_t h2 = (hash >> 32) | 1;
+  uint64_t num_bits = words_.size() * 64;
+  for (int i = 0; i < kNumHashes; ++i) {
+    uint64_t bit = (h1 + i * h2) % num_bits;
+    words_[bit / 64] |= (1ULL << (bit % 64));
+  }
+}
+
+bool StringBloomFilter::MayContain(std::string_view value) const {
+  uint64_t hash = HashString(value);
+  uint64_t h1 = hash;
+  uint64_t h2 = (hash >> 32) | 1;
+  uint64_t num_bits = words_.size() * 64;
+  for (int i = 0; i < kNumHashes; ++i) {
+    uint64_t bit = (h1 + i * h2) % num_bits;
+    if ((words_[bit / 64] & (1ULL << (bit % 64))) == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool ColumnZoneMap::MayMatch(const ColumnPredicate& predicate) const {
+  if (num_rows > 0 && null_count == num_rows) {
+    // Nulls never compare true.
+    return false;
+  }
+  if (std::holds_alternative<std::string>(predicate.value)) {
+    if (predicate.op == ColumnPredicate::Op::kEqual && bloom_filter != nullptr) {
+      return bloom_filter->MayContain(std::get<std::string>(predicate.value));
+    }
+    return true;
+  }
+  if (!min.has_value() || !max.has_value()) {
+    return true;
+  }
+  long double value = NumericValue(predicate);
+  if (std::isnan(value)) {
+    return true;
+  }
+  switch (predicate.op) {
+    case ColumnPredicate::Op::kEqual:
+      return min.value() <= value && value <= max.value();
+    case ColumnPredicate::Op::kNotEqual:
+      return !(min.value() == value && max.value() == value);
+    case ColumnPredicate::Op::kLessThan:
+      return min.value() < value;
+    case ColumnPredicate::Op::kLessThanEqual:
+      return min.value() <= value;
+    case ColumnPredicate::Op::kGreaterThan:
+      return max.value() > value;
+    case ColumnPredicate::Op::kGreaterThanEqual:
+      return max.value() >= value;
+  }
+  return true;
+}
+
+std::unique_ptr<ZoneMap> ZoneMap::Build(const schema::Relation& rel,
+                                        const std::vector<ArrowArrayPtr>& columns,
+                                        bool string_bloom_filters) {
+  auto zone_map = std::make_unique<ZoneMap>();
+  zone_map->columns_.resize(columns.size());
+  for (const auto& [col_idx, arr] : Enumerate(columns)) {
+    auto& col = zone_map->columns_[col_idx];
+    col.num_rows = arr->length();
+    col.null_count = arr->null_count();
+    switch (rel.GetColumnType(col_idx)) {
+      case types::DataType::BOOLEAN:
+        UpdateMinMax<types::DataType::BOOLEAN>(arr.get(), &col);
+        break;
+      case types::DataType::INT64:
+        UpdateMinMax<types::DataType::INT64>(arr.get(), &col);
+        break;
+      case types::DataType::TIME64NS:
+        UpdateMinMax<types::DataType::TIME64NS>(arr.get(), &col);
+        break;
+      case types::DataType::FLOAT64:
+        UpdateMinMax<types::DataType::FLOAT64>(arr.get(), &col);
+        break;
+      case types::DataType::STRING:
+        if (string_bloom_filters) {
+          BuildBloomFilter(arr.get(), &col);
+        }
+        break;
+      default:
+        break;
+    }
+  }
+  return zone_map;
+}
+
+bool ZoneMap::MayMatch(const std::vector<ColumnPredicate>& predicates) const {
+  for (const auto& predicate : predicates) {
+    if (predicate.col_idx < 0 || static_cast<size_t>(predicate.col_idx) >= columns_.size()) {
+      continue;
+    }
+    if (!columns_[predicate.col_idx].MayMatch(predicate)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+size_t ZoneMap::Bytes() const {
+  size_t bytes = 0;
+  for (const auto& col : columns_) {
+    if (col.bloom_filter != nullptr) {
+      bytes += col.bloom_filter->Bytes();
+    }
+  }
+  return bytes;
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
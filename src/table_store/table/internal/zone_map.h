@@ -0,0 +1,141 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+#include "src/table_store/schema/relation.h"
+#include "src/table_store/table/internal/types.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+/**
+ * ColumnPredicate is a comparison between a column of a table and a constant, ie. `col OP value`.
+ * Predicates are used to skip batches that can't contain any matching rows, they are never used to
+ * filter rows within a batch.
+ */
+struct ColumnPredicate {
+  enum class Op {
+    kEqual,
+    kNotEqual,
+    kLessThan,
+    kLessThanEqual,
+    kGreaterThan,
+    kGreaterThanEqual,
+  };
+  // Index of the column in the table's relation.
+  int64_t col_idx = -1;
+  Op op = Op::kEqual;
+  std::variant<bool, int64_t, double, std::string> value;
+};
+
+/**
+ * StringBloomFilter is a fixed size bloom filter over string values.
+ */
+class StringBloomFilter {
+ public:
+  /**
+   * Create a bloom filter sized for the given number of distinct values. The filter uses
+   * kBitsPerValue bits per value, up to a maximum of kMaxBits.
+   */
+  static std::unique_ptr<StringBloomFilter> Create(size_t num_distinct_values);
+
+  void Insert(std::string_view value);
+  bool MayContain(std::string_view value) const;
+
+  size_t Bytes() const { return words_.size() * sizeof(uint64_t); }
+
+  static constexpr size_t kBitsPerValue = 10;
+  static constexpr size_t kMaxBits = 8192;
+
+ private:
+  explicit StringBloomFilter(size_t num_words) : words_(num_words, 0) {}
+
+  static constexpr int kNumHashes = 6;
+
+  std::vector<uint64_t> words_;
+};
+
+/**
+ * ColumnZoneMap holds statistics about a single column of a batch.
+ */
+struct ColumnZoneMap {
+  int64_t num_rows = 0;
+  int64_t null_count = 0;
+  // Min and max of the non-null values of INT64, TIME64NS, FLOAT64 and BOOLEAN columns. Unset for
+  // other column types, for FLOAT64 columns that contain NaNs (which aren't ordered) and for
+  // columns where every value is null. long double represents every int64 and double exactly on
+  // the platforms we support, so predicates with either type of value can be compared directly.
+  std::optional<long double> min;
+  std::optional<long double> max;
+  // Only set for STRING columns, and only if bloom filters are enabled.
+  std::unique_ptr<StringBloomFilter> bloom_filter;
+
+  /**
+   * MayMatch returns false if no row in the column can match the given predicate, and true
+   * otherwise.
+   */
+  bool MayMatch(const ColumnPredicate& predicate) const;
+};
+
+/**
+ * ZoneMap holds per-column statistics (min/max, null counts and optionally bloom filters for string
+ * columns) for a batch of the table, which are used to skip reading batches that can't contain any
+ * rows matching a query's predicates.
+ */
+class ZoneMap {
+ public:
+  /**
+   * Build computes the zone map of the given columns.
+   * @param rel the relation of the table that the columns belong to.
+   * @param columns the arrow arrays for each column of the batch.
+   * @param string_bloom_filters whether to build bloom filters for string columns.
+   */
+  static std::unique_ptr<ZoneMap> Build(const schema::Relation& rel,
+                                        const std::vector<ArrowArrayPtr>& columns,
+                                        bool string_bloom_filters);
+
+  /**
+   * MayMatch returns false if no row in the batch can match all of the given predicates, and true
+   * otherwise.
+   */
+  bool MayMatch(const std::vector<ColumnPredicate>& predicates) const;
+
+  /**
+   * Bytes returns the number of bytes used by the zone map's bloom filters.
+   */
+  size_t Bytes() const;
+
+  const ColumnZoneMap& column(int64_t col_idx) const { return columns_[col_idx]; }
+
+ private:
+  std::vector<ColumnZoneMap> columns_;
+};
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,128 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <absl/strings/str_cat.h>
+
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/table/internal/zone_map.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+using Op = ColumnPredicate::Op;
+
+class ZoneMapTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    rel_ = std::make_unique<schema::Relation>(
+        std::vector<types::DataType>{types::DataType::TIME64NS, types::DataType::INT64,
+                                     types::DataType::FLOAT64, types::DataType::STRING,
+                                     types::DataType::BOOLEAN},
+        std::vector<std::string>{"time_", "latency", "cpu", "req_path", "resp"});
+    std::vector<types::Time64NSValue> times;
+    std::vector<types::Int64Value> latencies;
+    std::vector<types::Float64Value> cpus;
+    std::vector<types::StringValue> paths;
+    std::vector<types::BoolValue> resps;
+    for (int64_t i = 0; i < 100; ++i) {
+      times.push_back(1000 + i);
+      latencies.push_back(50 + (i * 37) % 100);
+      cpus.push_back(0.25 * i);
+      paths.push_back(absl::StrCat("/api/v1/", i % 10));
+      resps.push_back(true);
+    }
+    columns_ = {types::ToArrow(times, arrow::default_memory_pool()),
+                types::ToArrow(latencies, arrow::default_memory_pool()),
+                types::ToArrow(cpus, arrow::default_memory_pool()),
+                types::ToArrow(paths, arrow::default_memory_pool()),
+                types::ToArrow(resps, arrow::default_memory_pool())};
+  }
+
+  std::unique_ptr<schema::Relation> rel_;
+  std::vector<ArrowArrayPtr> columns_;
+};
+
+TEST_F(ZoneMapTest, min_max) {
+  auto zone_map = ZoneMap::Build(*rel_, columns_, /*string_bloom_filters*/ false);
+  EXPECT_EQ(1000, zone_map->column(0).min.value());
+  EXPECT_EQ(1099, zone_map->column(0).max.value());
+  EXPECT_EQ(50, zone_map->column(1).min.value());
+  EXPECT_EQ(149, zone_map->column(1).max.value());
+  EXPECT_EQ(0, zone_map->column(1).null_count);
+
+  EXPECT_TRUE(zone_map->MayMatch({{1, Op::kEqual, int64_t{50}}}));
+  EXPECT_FALSE(zone_map->MayMatch({{1, Op::kEqual, int64_t{49}}}));
+  EXPECT_FALSE(zone_map->MayMatch({{1, Op::kGreaterThan, int64_t{149}}}));
+  EXPECT_TRUE(zone_map->MayMatch({{1, Op::kGreaterThanEqual, int64_t{149}}}));
+  EXPECT_FALSE(zone_map->MayMatch({{1, Op::kLessThan, int64_t{50}}}));
+  EXPECT_TRUE(zone_map->MayMatch({{1, Op::kLessThanEqual, int64_t{50}}}));
+  EXPECT_TRUE(zone_map->MayMatch({{1, Op::kNotEqual, int64_t{50}}}));
+  // Integer columns can be compared to float values and vice versa.
+  EXPECT_FALSE(zone_map->MayMatch({{1, Op::kGreaterThan, 149.5}}));
+  EXPECT_TRUE(zone_map->MayMatch({{2, Op::kLessThan, int64_t{1}}}));
+  EXPECT_FALSE(zone_map->MayMatch({{2, Op::kGreaterThan, int64_t{25}}}));
+  // Every row has resp == true.
+  EXPECT_FALSE(zone_map->MayMatch({{4, Op::kEqual, false}}));
+  EXPECT_FALSE(zone_map->MayMatch({{4, Op::kNotEqual, true}}));
+
+  // Predicates are a conjunction.
+  EXPECT_FALSE(zone_map->MayMatch({{1, Op::kLessThan, int64_t{1000}}, {0, Op::kLessThan, 1000.0}}));
+  EXPECT_TRUE(zone_map->MayMatch({}));
+}
+
+TEST_F(ZoneMapTest, nan_disables_min_max) {
+  std::vector<types::Float64Value> cpus = {0.5, std::numeric_limits<double>::quiet_NaN(), 1.5};
+  schema::Relation rel({types::DataType::FLOAT64}, {"cpu"});
+  auto zone_map =
+      ZoneMap::Build(rel, {types::ToArrow(cpus, arrow::default_memory_pool())}, false);
+  EXPECT_FALSE(zone_map->column(0).min.has_value());
+  EXPECT_TRUE(zone_map->MayMatch({{0, Op::kGreaterThan, 100.0}}));
+}
+
+TEST_F(ZoneMapTest, string_bloom_filter) {
+  auto without_bloom = ZoneMap::Build(*rel_, columns_, /*string_bloom_filters*/ false);
+  EXPECT_EQ(0, without_bloom->Bytes());
+  EXPECT_TRUE(without_bloom->MayMatch({{3, Op::kEqual, std::string("/healthz")}}));
+
+  auto zone_map = ZoneMap::Build(*rel_, columns_, /*string_bloom_filters*/ true);
+  ASSERT_NE(nullptr, zone_map->column(3).bloom_filter);
+  EXPECT_GT(zone_map->Bytes(), 0);
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_TRUE(zone_map->MayMatch({{3, Op::kEqual, absl::StrCat("/api/v1/", i)}}));
+  }
+  int false_positives = 0;
+  for (int i = 10; i < 1010; ++i) {
+    if (zone_map->MayMatch({{3, Op::kEqual, absl::StrCat("/api/v1/", i)}})) {
+      false_positives++;
+    }
+  }
+  EXPECT_LT(false_positives, 50);
+  // Bloom filters can only be used for equality.
+  EXPECT_TRUE(zone_map->MayMatch({{3, Op::kNotEqual, std::string("/api/v1/0")}}));
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
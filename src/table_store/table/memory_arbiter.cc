@@ -0,0 +1,136 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include "src/table_store/table/memory_arbiter.h"
+
+namespace px {
+namespace table_store {
+
+double MemoryArbiter::IngestRate(const Table* table) const {
+  auto it = table_states_.find(table);
+  if (it == table_states_.end()) {
+    return 0;
+  }
+  return it->second.ingest_rate;
+}
+
+std::vector<int64_t> MemoryArbiter::TargetSizes(const std::vector<Table*>& tables,
+                                                std::chrono::steady_clock::time_point now) const {
+  const double budget = opts_.budget_bytes;
+  const double min_retention_s = std::chrono::duration<double>(opts_.min_retention).count();
+
+  std::vector<double> floors;
+  std::vector<double> weights;
+  double total_floor = 0;
+  double total_weight = 0;
+  for (const Table* table : tables) {
+    double rate = table_states_.at(table).ingest_rate;
+    double floor = std::max<double>(opts_.min_table_size, rate * min_retention_s);
+    auto last_read = table->LastReadTime();
+    bool recently_read =
+        last_read.has_value() && now - last_read.value() <= opts_.read_recency_window;
+    double weight = recently_read ? rate * opts_.read_weight_boost : rate;
+    floors.push_back(floor);
+    weights.push_back(weight);
+    total_floor += floor;
+    total_weight += weight;
+  }
+
+  std::vector<int64_t> targets;
+  if (total_floor >= budget) {
+    // The retention guarantees don't fit, so every table gets the same fraction of its guarantee.
+    for (double floor : floors) {
+      targets.push_back(static_cast<int64_t>(floor * budget / total_floor));
+    }
+    return targets;
+  }
+  double spare = budget - total_floor;
+  for (const auto& [i, floor] : Enumerate(floors)) {
+    double share = total_weight > 0 ? weights[i] / total_weight : 1.0 / tables.size();
+    targets.push_back(static_cast<int64_t>(floor + spare * share));
+  }
+  return targets;
+}
+
+Status MemoryArbiter::Rebalance(const std::vector<Table*>& tables,
+                                std::chrono::steady_clock::time_point now) {
+  double elapsed_s = 0;
+  if (last_rebalance_.has_value()) {
+    elapsed_s = std::chrono::duration<double>(now - last_rebalance_.value()).count();
+  }
+  last_rebalance_ = now;
+
+  bool all_rates_known = true;
+  int64_t total_size = 0;
+  std::vector<int64_t> sizes;
+  for (Table* table : tables) {
+    auto stats = table->GetTableStats();
+    auto [it, inserted] = table_states_.try_emplace(table);
+    auto& state = it->second;
+    if (!inserted && elapsed_s > 0) {
+      int64_t bytes_added = stats.bytes_added - state.bytes_added;
+      int64_t bytes_expired = stats.bytes_expired - state.bytes_expired;
+      double rate = bytes_added / elapsed_s;
+      state.ingest_rate = state.has_rate ? opts_.rate_smoothing * rate +
+                                               (1 - opts_.rate_smoothing) * state.ingest_rate
+                                         : rate;
+      state.has_rate = true;
+      table->RecordEvictionPressure(
+          bytes_added > 0 ? std::min(1.0, static_cast<double>(bytes_expired) / bytes_added) : 0);
+    }
+    state.bytes_added = stats.bytes_added;
+    state.bytes_expired = stats.bytes_expired;
+    all_rates_known &= state.has_rate;
+    sizes.push_back(stats.max_table_size);
+    total_size += stats.max_table_size;
+  }
+  // Wait until every table's ingest rate has been measured, otherwise new tables would be shrunk
+  // to their minimum size.
+  if (tables.empty() || !all_rates_known) {
+    return Status::OK();
+  }
+
+  auto targets = TargetSizes(tables, now);
+  // If the tables are over budget (eg. because of the sizes they were created with), move straight
+  // to the targets rather than damping, so that the budget is respected.
+  if (total_size <= opts_.budget_bytes) {
+    for (size_t i = 0; i < targets.size(); ++i) {
+      targets[i] = sizes[i] + static_cast<int64_t>(opts_.damping * (targets[i] - sizes[i]));
+    }
+  }
+
+  // Shrink tables before growing others, so that the memory released by the shrinking tables is
+  // available before it's handed out.
+  for (const auto& [i, table] : Enumerate(tables)) {
+    if (targets[i] < sizes[i]) {
+      PX_RETURN_IF_ERROR(table->SetMaxTableSize(targets[i]));
+    }
+  }
+  for (const auto& [i, table] : Enumerate(tables)) {
+    if (targets[i] > sizes[i]) {
+      PX_RETURN_IF_ERROR(table->SetMaxTableSize(targets[i]));
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace table_store
+}  // namespace px
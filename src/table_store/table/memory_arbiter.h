@@ -0,0 +1,107 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+
+#include "src/common/base/base.h"
+#include "src/table_store/table/table.h"
+
+namespace px {
+namespace table_store {
+
+/**
+ * MemoryArbiter splits a single memory budget between a set of tables, instead of each table
+ * having a fixed maximum size.
+ *
+ * Each call to `Rebalance` measures the rate at which bytes were written to each table since the
+ * previous call, and sets the tables' maximum sizes as follows:
+ *   1. Each table is guaranteed enough bytes to hold `min_retention` worth of data at its current
+ *      ingest rate (and at least `min_table_size` bytes). If the guarantees don't fit within the
+ *      budget, they are scaled down proportionally.
+ *   2. The rest of the budget is split in proportion to ingest rate, where tables that were read
+ *      within `read_recency_window` have their rate multiplied by `read_weight_boost`.
+ * Tables only move `damping` of the way towards their new size on each call, so that a short burst
+ * doesn't evict most of the other tables' data. Tables that shrink are resized before tables that
+ * grow, so that the sum of the maximum sizes never exceeds the budget (once it has been reached).
+ *
+ * MemoryArbiter is not thread-safe; `Rebalance` is expected to be called periodically from a single
+ * thread (see `TableStore::RunCompaction`).
+ */
+class MemoryArbiter : public NotCopyable {
+ public:
+  struct Options {
+    // The total number of bytes shared by all of the tables.
+    int64_t budget_bytes = 0;
+    // The amount of data each table should be able to hold, at its current ingest rate.
+    std::chrono::seconds min_retention = std::chrono::minutes(5);
+    // The minimum maximum size of a table, regardless of its ingest rate.
+    int64_t min_table_size = 1024 * 1024;
+    // Tables read within this window get a larger share of the spare budget.
+    std::chrono::seconds read_recency_window = std::chrono::minutes(15);
+    double read_weight_boost = 2.0;
+    // The fraction of the distance to its target size that a table moves on each rebalance.
+    double damping = 0.5;
+    // Weight of the latest measurement in the exponentially weighted average of the ingest rates.
+    double rate_smoothing = 0.5;
+  };
+
+  explicit MemoryArbiter(Options opts) : opts_(opts) {}
+
+  /**
+   * Rebalances the maximum sizes of the given tables. The first call only measures the tables'
+   * ingest rates, and doesn't change their sizes.
+   * @param tables the tables sharing the budget. Tables must outlive the arbiter.
+   * @param now the current time.
+   */
+  Status Rebalance(const std::vector<Table*>& tables, std::chrono::steady_clock::time_point now);
+
+  /**
+   * Returns the current ingest rate estimate of the table in bytes per second, or 0 if the table
+   * hasn't been seen by `Rebalance`.
+   */
+  double IngestRate(const Table* table) const;
+
+  const Options& options() const { return opts_; }
+
+ private:
+  struct TableState {
+    int64_t bytes_added = 0;
+    int64_t bytes_expired = 0;
+    // Bytes per second.
+    double ingest_rate = 0;
+    bool has_rate = false;
+  };
+
+  // Computes the target size of each table, in the same order as tables.
+  std::vector<int64_t> TargetSizes(const std::vector<Table*>& tables,
+                                   std::chrono::steady_clock::time_point now) const;
+
+  const Options opts_;
+  absl::flat_hash_map<const Table*, TableState> table_states_;
+  std::optional<std::chrono::steady_clock::time_point> last_rebalance_;
+};
+
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,127 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/schema/relation.h"
+#include "src/table_store/table/memory_arbiter.h"
+
+namespace px {
+namespace table_store {
+
+class MemoryArbiterTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    rel_ = schema::Relation({types::DataType::INT64}, {"col1"});
+    table1_ = std::make_shared<Table>("table1", rel_, 5000);
+    table2_ = std::make_shared<Table>("table2", rel_, 5000);
+    tables_ = {table1_.get(), table2_.get()};
+    start_ = std::chrono::steady_clock::now();
+  }
+
+  // Writes a batch of num_bytes bytes to the table. num_bytes must be a multiple of 8.
+  void WriteBytes(Table* table, int64_t num_bytes) {
+    std::vector<types::Int64Value> values(num_bytes / sizeof(int64_t), 1);
+    schema::RowBatch rb(schema::RowDescriptor(rel_.col_types()), values.size());
+    ASSERT_OK(rb.AddColumn(types::ToArrow(values, arrow::default_memory_pool())));
+    ASSERT_OK(table->WriteRowBatch(rb));
+  }
+
+  MemoryArbiter::Options DefaultOptions() {
+    MemoryArbiter::Options opts;
+    opts.budget_bytes = 10000;
+    opts.min_retention = std::chrono::seconds(1);
+    opts.min_table_size = 100;
+    opts.damping = 1.0;
+    opts.rate_smoothing = 1.0;
+    return opts;
+  }
+
+  schema::Relation rel_;
+  std::shared_ptr<Table> table1_;
+  std::shared_ptr<Table> table2_;
+  std::vector<Table*> tables_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+TEST_F(MemoryArbiterTest, rebalance_by_ingest_rate_and_reads) {
+  MemoryArbiter arbiter(DefaultOptions());
+
+  // The first rebalance only measures the tables.
+  ASSERT_OK(arbiter.Rebalance(tables_, start_));
+  EXPECT_EQ(5000, table1_->GetTableStats().max_table_size);
+  EXPECT_EQ(5000, table2_->GetTableStats().max_table_size);
+
+  WriteBytes(table1_.get(), 800);
+  WriteBytes(table2_.get(), 200);
+  ASSERT_OK(arbiter.Rebalance(tables_, start_ + std::chrono::seconds(1)));
+  EXPECT_DOUBLE_EQ(800, arbiter.IngestRate(table1_.get()));
+  EXPECT_DOUBLE_EQ(200, arbiter.IngestRate(table2_.get()));
+  // Each table is guaranteed 1s of data, and the remaining 9000 bytes are split 4:1.
+  EXPECT_EQ(800 + 7200, table1_->GetTableStats().max_table_size);
+  EXPECT_EQ(200 + 1800, table2_->GetTableStats().max_table_size);
+
+  // Reading table2 doubles its weight.
+  Table::Cursor cursor(table2_.get());
+  WriteBytes(table1_.get(), 800);
+  WriteBytes(table2_.get(), 200);
+  ASSERT_OK(arbiter.Rebalance(tables_, start_ + std::chrono::seconds(2)));
+  EXPECT_EQ(800 + 6000, table1_->GetTableStats().max_table_size);
+  EXPECT_EQ(200 + 3000, table2_->GetTableStats().max_table_size);
+}
+
+TEST_F(MemoryArbiterTest, damping) {
+  auto opts = DefaultOptions();
+  opts.damping = 0.5;
+  MemoryArbiter arbiter(opts);
+
+  ASSERT_OK(arbiter.Rebalance(tables_, start_));
+  WriteBytes(table1_.get(), 800);
+  WriteBytes(table2_.get(), 200);
+  ASSERT_OK(arbiter.Rebalance(tables_, start_ + std::chrono::seconds(1)));
+  // The tables move half way from 5000 bytes towards their targets of 8000 and 2000 bytes.
+  EXPECT_EQ(6500, table1_->GetTableStats().max_table_size);
+  EXPECT_EQ(3500, table2_->GetTableStats().max_table_size);
+}
+
+TEST_F(MemoryArbiterTest, retention_guarantees_exceed_budget) {
+  auto opts = DefaultOptions();
+  opts.budget_bytes = 1000;
+  MemoryArbiter arbiter(opts);
+
+  ASSERT_OK(arbiter.Rebalance(tables_, start_));
+  WriteBytes(table1_.get(), 800);
+  WriteBytes(table2_.get(), 800);
+  // The tables start over budget, so they move straight to their targets, and the guarantees of
+  // 800 bytes each are scaled down to fit the budget.
+  ASSERT_OK(arbiter.Rebalance(tables_, start_ + std::chrono::seconds(1)));
+  for (const auto& table : {table1_, table2_}) {
+    auto stats = table->GetTableStats();
+    EXPECT_EQ(500, stats.max_table_size);
+    // Shrinking the table expires data straight away.
+    EXPECT_LE(stats.bytes, 500);
+    EXPECT_EQ(800, stats.bytes_expired);
+  }
+}
+
+}  // namespace table_store
+}  // namespace px
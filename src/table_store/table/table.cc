@@ -17,6 +17,7 @@
  */
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <cstddef>
 #include <iterator>
@@ -45,11 +46,34 @@ DEFINE_int32(table_store_table_size_limit,
              "The maximal size a table allows. When the size grows beyond this limit, "
              "old data will be discarded.");
 
+DEFINE_bool(table_store_cold_encoding,
+            gflags::BoolFromEnv("PL_TABLE_STORE_COLD_ENCODING", false),
+            "If true, columns of compacted (cold) batches are stored with per-column encodings "
+            "(dictionary, delta, frame-of-reference, compression) to fit more data in the table.");
+
+DEFINE_string(table_store_spill_dir, gflags::StringFromEnv("PL_TABLE_STORE_SPILL_DIR", ""),
+              "If set, batches that are expired from a table's memory are written to files in this "
+              "directory, and can still be queried until they exceed the spill size limit.");
+
+DEFINE_int64(table_store_table_spill_size_limit,
+             gflags::Int64FromEnv("PL_TABLE_STORE_TABLE_SPILL_SIZE_LIMIT", 1024 * 1024 * 512),
+             "The maximal number of bytes each table can spill to disk. When the spilled data "
+             "grows beyond this limit, the oldest spilled data is discarded.");
+
+DEFINE_bool(table_store_string_bloom_filters,
+            gflags::BoolFromEnv("PL_TABLE_STORE_STRING_BLOOM_FILTERS", false),
+            "If true, the zone map of each compacted (cold) batch includes a bloom filter of each "
+            "string column, so that queries filtering on string equality can skip batches.");
+
 namespace px {
 namespace table_store {
 
-Table::Cursor::Cursor(const Table* table, StartSpec start, StopSpec stop)
-    : table_(table), hints_(internal::BatchHints{}) {
+Table::Cursor::Cursor(const Table* table, StartSpec start, StopSpec stop,
+                      std::vector<ColumnPredicate> predicates)
+    : table_(table), hints_(internal::BatchHints{}), predicates_(std::move(predicates)) {
+  table_->last_read_ns_ = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                              std::chrono::steady_clock::now().time_since_epoch())
+                              .count();
   AdvanceToStart(start);
   StopStateFromSpec(std::move(stop));
 }
@@ -173,8 +197,13 @@ Table::Table(std::string_view table_name, const schema::Relation& relation, size
       rel_(relation),
       max_table_size_(max_table_size),
       compacted_batch_size_(compacted_batch_size),
+      cold_encoding_enabled_(FLAGS_table_store_cold_encoding),
+      string_bloom_filters_enabled_(FLAGS_table_store_string_bloom_filters),
+      max_spill_size_(FLAGS_table_store_table_spill_size_limit),
       // TODO(james): move mem_pool into constructor.
       compactor_(rel_, arrow::default_memory_pool()) {
+  absl::MutexLock write_lock(&spill_write_lock_);
+  absl::MutexLock spill_lock(&spill_lock_);
   absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
   absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
   for (const auto& [i, col_name] : Enumerate(rel_.col_names())) {
@@ -187,6 +216,13 @@ Table::Table(std::string_view table_name, const schema::Relation& relation, size
       rel_, time_col_idx_);
   cold_store_ = std::make_unique<internal::StoreWithRowTimeAccounting<internal::StoreType::Cold>>(
       rel_, time_col_idx_);
+  spill_store_ =
+      std::make_unique<internal::StoreWithRowTimeAccounting<internal::StoreType::Spill>>(
+          rel_, time_col_idx_);
+  if (!FLAGS_table_store_spill_dir.empty()) {
+    spill_writer_ = std::make_unique<internal::SpillWriter>(
+        FLAGS_table_store_spill_dir, std::string(table_name), kSpillFileSize);
+  }
 }
 
 Status Table::ToProto(table_store::schemapb::Table* table_proto) const {
@@ -212,56 +248,116 @@ Status Table::ToProto(table_store::schemapb::Table* table_proto) const {
 StatusOr<std::unique_ptr<schema::RowBatch>> Table::GetNextRowBatch(
     Cursor* cursor, const std::vector<int64_t>& cols) const {
   DCHECK(!cursor->Done()) << "Calling GetNextRowBatch on an exhausted Cursor";
-  absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
+  // Returns true once the cursor has skipped up to its stop row, in which case the remaining stores
+  // must not be read.
+  auto reached_stop = [cursor]() {
+    auto stop_row_id = cursor->StopRowID();
+    return stop_row_id.has_value() && *cursor->LastReadRowID() + 1 >= stop_row_id.value();
+  };
+  const auto& predicates = cursor->Predicates();
+  auto initial_last_read_row_id = *cursor->LastReadRowID();
+
+  absl::ReaderMutexLock spill_lock(&spill_lock_);
+  if (spill_store_->Size() > 0 && *cursor->LastReadRowID() + 1 < spill_store_->FirstRowID()) {
+    // If the cursor was pointing to a batch that has since been expired from the spill store,
+    // update the cursor to point to the oldest spilled batch (as long as it's before the cursor's
+    // stop).
+    auto stop_row_id = cursor->StopRowID();
+    if (!stop_row_id.has_value() || spill_store_->FirstRowID() < stop_row_id.value()) {
+      *cursor->LastReadRowID() = spill_store_->FirstRowID() - 1;
+    }
+  }
   PX_ASSIGN_OR_RETURN(auto rb,
-                      cold_store_->GetNextRowBatch(cursor->LastReadRowID(), cursor->Hints(),
-                                                   cursor->StopRowID(), cols));
-  if (rb == nullptr) {
-    absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
-    PX_ASSIGN_OR_RETURN(rb, hot_store_->GetNextRowBatch(cursor->LastReadRowID(), cursor->Hints(),
-                                                        cursor->StopRowID(), cols));
-    if (rb == nullptr && hot_store_->Size() > 0) {
-      // If the cursor was pointing to an expired row batch, update the cursor to point to the start
-      // of the table, then try to get the next row batch.
-      *cursor->LastReadRowID() = hot_store_->FirstRowID() - 1;
-      if (!cursor->Done()) {
-        PX_ASSIGN_OR_RETURN(rb,
-                            hot_store_->GetNextRowBatch(cursor->LastReadRowID(), cursor->Hints(),
-                                                        cursor->StopRowID(), cols));
+                      spill_store_->GetNextRowBatch(cursor->LastReadRowID(), cursor->Hints(),
+                                                    cursor->StopRowID(), cols, predicates));
+  if (rb == nullptr && !reached_stop()) {
+    absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
+    PX_ASSIGN_OR_RETURN(rb,
+                        cold_store_->GetNextRowBatch(cursor->LastReadRowID(), cursor->Hints(),
+                                                     cursor->StopRowID(), cols, predicates));
+    if (rb == nullptr && !reached_stop()) {
+      absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
+      PublishPendingHotBatches();
+      PX_ASSIGN_OR_RETURN(rb, hot_store_->GetNextRowBatch(cursor->LastReadRowID(),
+                                                          cursor->Hints(), cursor->StopRowID(),
+                                                          cols));
+      if (rb == nullptr && hot_store_->Size() > 0 &&
+          *cursor->LastReadRowID() + 1 < hot_store_->FirstRowID()) {
+        // If the cursor was pointing to an expired row batch, update the cursor to point to the
+        // start of the table, then try to get the next row batch.
+        *cursor->LastReadRowID() = hot_store_->FirstRowID() - 1;
+        if (!reached_stop()) {
+          PX_ASSIGN_OR_RETURN(rb,
+                              hot_store_->GetNextRowBatch(cursor->LastReadRowID(),
+                                                          cursor->Hints(), cursor->StopRowID(),
+                                                          cols));
+        }
       }
     }
   }
-  if (rb == nullptr) {
-    return error::InvalidArgument("Data after Cursor is not in the table.");
+  if (rb != nullptr) {
+    return rb;
   }
-  return rb;
+  if (*cursor->LastReadRowID() != initial_last_read_row_id) {
+    // The cursor skipped every remaining batch that could be read, so return an empty batch.
+    std::vector<types::DataType> col_types;
+    for (int64_t col_idx : cols) {
+      col_types.push_back(rel_.GetColumnType(col_idx));
+    }
+    return schema::RowBatch::WithZeroRows(schema::RowDescriptor(col_types), /*eow*/ false,
+                                          /*eos*/ false);
+  }
+  return error::InvalidArgument("Data after Cursor is not in the table.");
 }
 
 Status Table::ExpireRowBatches(int64_t row_batch_size) {
-  if (row_batch_size > max_table_size_) {
+  int64_t max_table_size = max_table_size_;
+  if (row_batch_size > max_table_size) {
     return error::InvalidArgument("RowBatch size ($0) is bigger than maximum table size ($1).",
-                                  row_batch_size, max_table_size_);
-  }
-  int64_t bytes;
-  {
-    absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
-    bytes = batch_size_accountant_->HotBytes() + batch_size_accountant_->ColdBytes();
+                                  row_batch_size, max_table_size);
   }
-  while (bytes + row_batch_size > max_table_size_) {
+  // Pending hot batches count towards the table's size, even though they aren't in the hot store
+  // yet.
+  auto table_bytes = [this]() { return stored_bytes_.load() + pending_hot_bytes_.load(); };
+  int64_t bytes = table_bytes();
+  while (bytes + row_batch_size > max_table_size) {
     PX_RETURN_IF_ERROR(ExpireBatch());
-    {
-      absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
-      bytes = batch_size_accountant_->HotBytes() + batch_size_accountant_->ColdBytes();
-    }
+    int64_t prev_bytes = bytes;
+    bytes = table_bytes();
     {
       absl::base_internal::SpinLockHolder lock(&stats_lock_);
       batches_expired_++;
       metrics_.batches_expired_counter.Increment();
+      // Concurrent writes can grow the table between the two reads of its size, so don't count
+      // those as negative expired bytes.
+      int64_t expired_bytes = std::max<int64_t>(prev_bytes - bytes, 0);
+      bytes_expired_ += expired_bytes;
+      metrics_.bytes_expired_counter.Increment(expired_bytes);
     }
   }
   return Status::OK();
 }
 
+Status Table::SetMaxTableSize(int64_t max_table_size) {
+  max_table_size_ = max_table_size;
+  PX_RETURN_IF_ERROR(ExpireRowBatches(0));
+  return UpdateTableMetricGauges();
+}
+
+std::optional<std::chrono::steady_clock::time_point> Table::LastReadTime() const {
+  int64_t last_read_ns = last_read_ns_;
+  if (last_read_ns == 0) {
+    return std::nullopt;
+  }
+  return std::chrono::steady_clock::time_point(
+      std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+          std::chrono::nanoseconds(last_read_ns)));
+}
+
+void Table::RecordEvictionPressure(double eviction_pressure) {
+  metrics_.eviction_pressure_gauge.Set(eviction_pressure);
+}
+
 Status Table::WriteRowBatch(const schema::RowBatch& rb) {
   // Don't write empty row batches.
   if (rb.num_columns() == 0 || rb.ColumnAt(0)->length() == 0) {
@@ -298,35 +394,40 @@ Status Table::WriteHot(internal::RecordOrRowBatch&& record_or_row_batch) {
   auto batch_stats = internal::BatchSizeAccountant::CalcBatchStats(
       ABSL_TS_UNCHECKED_READ(batch_size_accountant_)->NonMutableState(), record_or_row_batch);
 
-  PX_RETURN_IF_ERROR(ExpireRowBatches(batch_stats.bytes));
+  int64_t batch_bytes = batch_stats.bytes;
+  PX_RETURN_IF_ERROR(ExpireRowBatches(batch_bytes));
 
-  {
-    absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
-    auto batch_length = record_or_row_batch.Length();
-    batch_size_accountant_->NewHotBatch(std::move(batch_stats));
-    hot_store_->EmplaceBack(next_row_id_, std::move(record_or_row_batch));
-    next_row_id_ += batch_length;
+  pending_hot_bytes_ += batch_bytes;
+  pending_hot_batches_.Push({std::move(record_or_row_batch), std::move(batch_stats)});
+  // Don't wait for the hot lock. If it's held, the batch is published by the holder's next access
+  // to the hot store, or by whoever takes the lock next.
+  if (hot_lock_.TryLock()) {
+    PublishPendingHotBatches();
+    hot_lock_.Unlock();
   }
 
   {
     absl::base_internal::SpinLockHolder lock(&stats_lock_);
     ++batches_added_;
     metrics_.batches_added_counter.Increment();
-    bytes_added_ += batch_stats.bytes;
-    metrics_.bytes_added_counter.Increment(batch_stats.bytes);
+    bytes_added_ += batch_bytes;
+    metrics_.bytes_added_counter.Increment(batch_bytes);
   }
 
-  // Make sure locks are released for this call, since they are reacquired inside.
-  PX_RETURN_IF_ERROR(UpdateTableMetricGauges());
-  return Status::OK();
+  return MaybeUpdateTableMetricGauges();
 }
 
 Table::RowID Table::FirstRowID() const {
+  absl::ReaderMutexLock spill_lock(&spill_lock_);
+  if (spill_store_->Size() > 0) {
+    return spill_store_->FirstRowID();
+  }
   absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
   if (cold_store_->Size() > 0) {
     return cold_store_->FirstRowID();
   }
   absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
+  PublishPendingHotBatches();
   if (hot_store_->Size() > 0) {
     return hot_store_->FirstRowID();
   }
@@ -334,36 +435,52 @@ Table::RowID Table::FirstRowID() const {
 }
 
 Table::RowID Table::LastRowID() const {
+  absl::ReaderMutexLock spill_lock(&spill_lock_);
   absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
   absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
+  PublishPendingHotBatches();
   if (hot_store_->Size() > 0) {
     return hot_store_->LastRowID();
   }
   if (cold_store_->Size() > 0) {
     return cold_store_->LastRowID();
   }
+  if (spill_store_->Size() > 0) {
+    return spill_store_->LastRowID();
+  }
   return -1;
 }
 
 Table::Time Table::MaxTime() const {
+  absl::ReaderMutexLock spill_lock(&spill_lock_);
   absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
   absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
+  PublishPendingHotBatches();
   if (hot_store_->Size() > 0) {
     return hot_store_->MaxTime();
   }
   if (cold_store_->Size() > 0) {
     return cold_store_->MaxTime();
   }
+  if (spill_store_->Size() > 0) {
+    return spill_store_->MaxTime();
+  }
   return -1;
 }
 
 Table::RowID Table::FindRowIDFromTimeFirstGreaterThanOrEqual(Time time) const {
+  absl::ReaderMutexLock spill_lock(&spill_lock_);
+  auto optional_row_id = spill_store_->FindRowIDFromTimeFirstGreaterThanOrEqual(time);
+  if (optional_row_id.has_value()) {
+    return optional_row_id.value();
+  }
   absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
-  auto optional_row_id = cold_store_->FindRowIDFromTimeFirstGreaterThanOrEqual(time);
+  optional_row_id = cold_store_->FindRowIDFromTimeFirstGreaterThanOrEqual(time);
   if (optional_row_id.has_value()) {
     return optional_row_id.value();
   }
   absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
+  PublishPendingHotBatches();
   optional_row_id = hot_store_->FindRowIDFromTimeFirstGreaterThanOrEqual(time);
   if (optional_row_id.has_value()) {
     return optional_row_id.value();
@@ -372,12 +489,18 @@ Table::RowID Table::FindRowIDFromTimeFirstGreaterThanOrEqual(Time time) const {
 }
 
 Table::RowID Table::FindRowIDFromTimeFirstGreaterThan(Time time) const {
+  absl::ReaderMutexLock spill_lock(&spill_lock_);
+  auto optional_row_id = spill_store_->FindRowIDFromTimeFirstGreaterThan(time);
+  if (optional_row_id.has_value()) {
+    return optional_row_id.value();
+  }
   absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
-  auto optional_row_id = cold_store_->FindRowIDFromTimeFirstGreaterThan(time);
+  optional_row_id = cold_store_->FindRowIDFromTimeFirstGreaterThan(time);
   if (optional_row_id.has_value()) {
     return optional_row_id.value();
   }
   absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
+  PublishPendingHotBatches();
   optional_row_id = hot_store_->FindRowIDFromTimeFirstGreaterThan(time);
   if (optional_row_id.has_value()) {
     return optional_row_id.value();
@@ -393,11 +516,18 @@ TableStats Table::GetTableStats() const {
   int64_t num_batches = 0;
   int64_t hot_bytes = 0;
   int64_t cold_bytes = 0;
+  int64_t spill_bytes = 0;
   {
+    absl::ReaderMutexLock spill_lock(&spill_lock_);
+    min_time = spill_store_->MinTime();
+    spill_bytes = spill_bytes_;
     absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
-    min_time = cold_store_->MinTime();
+    if (min_time == -1) {
+      min_time = cold_store_->MinTime();
+    }
     num_batches += cold_store_->Size();
     absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
+    PublishPendingHotBatches();
     num_batches += hot_store_->Size();
     hot_bytes = batch_size_accountant_->HotBytes();
     cold_bytes = batch_size_accountant_->ColdBytes();
@@ -410,6 +540,7 @@ TableStats Table::GetTableStats() const {
   info.batches_added = batches_added_;
   info.batches_expired = batches_expired_;
   info.bytes_added = bytes_added_;
+  info.bytes_expired = bytes_expired_;
   info.num_batches = num_batches;
   info.bytes = hot_bytes + cold_bytes;
   info.hot_bytes = hot_bytes;
@@ -417,11 +548,12 @@ TableStats Table::GetTableStats() const {
   info.compacted_batches = compacted_batches_;
   info.max_table_size = max_table_size_;
   info.min_time = min_time;
+  info.spill_bytes = spill_bytes;
 
   return info;
 }
 
-Status Table::CompactSingleBatchUnlocked(arrow::MemoryPool*) {
+Status Table::CompactSingleBatchUnlocked(arrow::MemoryPool* mem_pool) {
   const auto& compaction_spec = batch_size_accountant_->GetNextCompactedBatchSpec();
 
   PX_RETURN_IF_ERROR(
@@ -441,9 +573,22 @@ Status Table::CompactSingleBatchUnlocked(arrow::MemoryPool*) {
 
   PX_ASSIGN_OR_RETURN(std::vector<ArrowArrayPtr> out_columns, compactor_.Finish());
 
-  cold_store_->EmplaceBack(first_row_id, out_columns);
+  std::shared_ptr<const internal::ZoneMap> zone_map =
+      internal::ZoneMap::Build(rel_, out_columns, string_bloom_filters_enabled_);
+  std::optional<uint64_t> cold_batch_bytes;
+  if (cold_encoding_enabled_) {
+    internal::ColumnEncodingOptions encoding_opts;
+    encoding_opts.mem_pool = mem_pool;
+    PX_ASSIGN_OR_RETURN(auto cold_batch, ColdBatch::Encode(rel_, out_columns, encoding_opts));
+    cold_batch_bytes = cold_batch.Bytes();
+    cold_batch.set_zone_map(std::move(zone_map));
+    cold_store_->EmplaceBack(first_row_id, std::move(cold_batch));
+  } else {
+    auto& cold_batch = cold_store_->EmplaceBack(first_row_id, out_columns);
+    cold_batch.set_zone_map(std::move(zone_map));
+  }
 
-  auto num_rows_to_remove = batch_size_accountant_->FinishCompactedBatch();
+  auto num_rows_to_remove = batch_size_accountant_->FinishCompactedBatch(cold_batch_bytes);
   if (num_rows_to_remove > 0) {
     hot_store_->RemovePrefix(num_rows_to_remove);
   }
@@ -460,43 +605,110 @@ Status Table::CompactHotToCold(arrow::MemoryPool* mem_pool) {
   bool next_ready = false;
   {
     absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
+    PublishPendingHotBatches();
     next_ready = batch_size_accountant_->CompactedBatchReady();
   }
   while (next_ready) {
     absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
     absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
+    PublishPendingHotBatches();
     // We have to check CompactedBatchReady() again, in case hot batches were expired since the last
     // check.
     if (!batch_size_accountant_->CompactedBatchReady()) {
       break;
     }
     PX_RETURN_IF_ERROR(CompactSingleBatchUnlocked(mem_pool));
+    UpdateStoredBytes();
     next_ready = batch_size_accountant_->CompactedBatchReady();
   }
-  return Status::OK();
+  // Writes only update the gauges periodically, so make sure they are updated at least as often as
+  // the table is compacted.
+  return UpdateTableMetricGauges();
 }
 
 StatusOr<bool> Table::ExpireCold() {
-  absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
-  if (cold_store_->Size() == 0) {
-    return false;
+  absl::MutexLock write_lock(&spill_write_lock_);
+  RowID first_row_id = -1;
+  const ColdBatch* oldest_batch = nullptr;
+  {
+    absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
+    if (cold_store_->Size() == 0) {
+      return false;
+    }
+    // Only ExpireCold pops cold batches, and appending to the cold store doesn't move the existing
+    // batches, so the batch stays valid while spill_write_lock_ is held.
+    first_row_id = cold_store_->FirstRowID();
+    oldest_batch = &cold_store_->front();
+  }
+
+  // Write the batch to disk before taking spill_lock_, so that readers aren't blocked on the IO.
+  std::optional<internal::SpillBatch> spill_batch;
+  if (spill_writer_ != nullptr) {
+    auto spill_batch_or_s = spill_writer_->Write(*oldest_batch);
+    if (spill_batch_or_s.ok()) {
+      spill_batch.emplace(spill_batch_or_s.ConsumeValueOrDie());
+    } else {
+      // Failing to spill a batch only loses that batch, so don't fail the write that expired it.
+      LOG_EVERY_N(ERROR, 100) << "Failed to spill expired batch: " << spill_batch_or_s.msg();
+    }
+  }
+
+  // spill_lock_ is held while the batch moves from the cold store to the spill store, so that
+  // readers never see the batch as missing from both.
+  absl::MutexLock spill_lock(&spill_lock_);
+  {
+    absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
+    cold_store_->PopFront();
+    absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
+    batch_size_accountant_->ExpireColdBatch();
+    UpdateStoredBytes();
+  }
+  if (spill_batch.has_value()) {
+    AddSpillBatch(first_row_id, std::move(spill_batch.value()));
   }
-  cold_store_->PopFront();
-  absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
-  batch_size_accountant_->ExpireColdBatch();
   return true;
 }
 
+void Table::AddSpillBatch(RowID first_row_id, internal::SpillBatch spill_batch) {
+  spill_bytes_ += spill_batch.Bytes();
+  spill_store_->EmplaceBack(first_row_id, std::move(spill_batch));
+  // Expire the oldest spilled batches until the spilled data fits within its disk budget.
+  while (spill_bytes_ > max_spill_size_ && spill_store_->Size() > 0) {
+    spill_bytes_ -= spill_store_->front().Bytes();
+    spill_store_->PopFront();
+  }
+}
+
 Status Table::ExpireHot() {
   absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
+  PublishPendingHotBatches();
   if (hot_store_->Size() == 0) {
     return error::InvalidArgument("Failed to expire row batch, no row batches in table");
   }
   hot_store_->PopFront();
   batch_size_accountant_->ExpireHotBatch();
+  UpdateStoredBytes();
   return Status::OK();
 }
 
+void Table::PublishPendingHotBatches() const {
+  if (pending_hot_batches_.Empty()) {
+    return;
+  }
+  for (auto& [batch, batch_stats] : pending_hot_batches_.PopAll()) {
+    auto batch_length = batch.Length();
+    pending_hot_bytes_ -= batch_stats.bytes;
+    batch_size_accountant_->NewHotBatch(std::move(batch_stats));
+    hot_store_->EmplaceBack(next_row_id_, std::move(batch));
+    next_row_id_ += batch_length;
+  }
+  UpdateStoredBytes();
+}
+
+void Table::UpdateStoredBytes() const {
+  stored_bytes_ = batch_size_accountant_->HotBytes() + batch_size_accountant_->ColdBytes();
+}
+
 Status Table::ExpireBatch() {
   PX_ASSIGN_OR_RETURN(auto expired_cold, ExpireCold());
   if (expired_cold) {
@@ -507,12 +719,26 @@ Status Table::ExpireBatch() {
   return ExpireHot();
 }
 
+Status Table::MaybeUpdateTableMetricGauges() {
+  int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now().time_since_epoch())
+                       .count();
+  int64_t updated_ns = gauges_updated_ns_;
+  if (now_ns - updated_ns < std::chrono::nanoseconds(kGaugeUpdatePeriod).count() ||
+      !gauges_updated_ns_.compare_exchange_strong(updated_ns, now_ns)) {
+    return Status::OK();
+  }
+  // Make sure locks are released for this call, since they are reacquired inside.
+  return UpdateTableMetricGauges();
+}
+
 Status Table::UpdateTableMetricGauges() {
   // Update table-level gauge values.
   auto stats = GetTableStats();
   // Set gauge values
   metrics_.cold_bytes_gauge.Set(stats.cold_bytes);
   metrics_.hot_bytes_gauge.Set(stats.hot_bytes);
+  metrics_.spill_bytes_gauge.Set(stats.spill_bytes);
   metrics_.num_batches_gauge.Set(stats.num_batches);
   metrics_.max_table_size_gauge.Set(stats.max_table_size);
   // Compute retention gauge
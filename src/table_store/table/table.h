@@ -22,6 +22,8 @@
 #include <arrow/array.h>
 #include <arrow/record_batch.h>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <deque>
 #include <memory>
 #include <optional>
@@ -43,12 +45,20 @@
 #include "src/table_store/schemapb/schema.pb.h"
 #include "src/table_store/table/internal/arrow_array_compactor.h"
 #include "src/table_store/table/internal/batch_size_accountant.h"
+#include "src/table_store/table/internal/cold_batch.h"
+#include "src/table_store/table/internal/mpsc_queue.h"
 #include "src/table_store/table/internal/record_or_row_batch.h"
+#include "src/table_store/table/internal/spill_batch.h"
 #include "src/table_store/table/internal/store_with_row_accounting.h"
 #include "src/table_store/table/internal/types.h"
+#include "src/table_store/table/internal/zone_map.h"
 #include "src/table_store/table/table_metrics.h"
 
 DECLARE_int32(table_store_table_size_limit);
+DECLARE_bool(table_store_cold_encoding);
+DECLARE_string(table_store_spill_dir);
+DECLARE_int64(table_store_table_spill_size_limit);
+DECLARE_bool(table_store_string_bloom_filters);
 
 namespace px {
 namespace table_store {
@@ -63,9 +73,11 @@ struct TableStats {
   int64_t batches_added;
   int64_t batches_expired;
   int64_t bytes_added;
+  int64_t bytes_expired;
   int64_t compacted_batches;
   int64_t max_table_size;
   int64_t min_time;
+  int64_t spill_bytes;
 };
 
 /**
@@ -78,12 +90,38 @@ struct TableStats {
  * and `Time and Row Indexing` below).
  *
  * Synchronization Scheme:
- * The hot and cold partitions are synchronized separately with spinlocks.
+ * The hot and cold partitions are synchronized separately with spinlocks. The spill store (see
+ * below) is synchronized with a reader-writer mutex, which is always acquired before the cold and
+ * hot locks. Writers don't wait for the hot lock: new batches are pushed onto a lock-free queue of
+ * pending hot batches (see `internal::MPSCQueue`), and whoever next holds the hot lock (a reader,
+ * the compactor, or a writer that finds the lock free) moves them into the hot store, assigning
+ * their row IDs in queue order. Every access to the hot store publishes the pending batches first,
+ * so a batch is visible to every read that starts after its write returns. The table's size is
+ * tracked with atomics, so writes only take locks when they need to expire data.
  *
  * Compaction Scheme:
  * Hot batches are compacted into batches of size roughly `compacted_batch_size_` +/- the size of a
  * single row.  The compaction routine should be called periodically but that is not the
- * responsibility of this class.
+ * responsibility of this class. If `--table_store_cold_encoding` is set, each column of a compacted
+ * batch is stored with the encoding that best fits its data (eg. dictionary encoding for low
+ * cardinality strings, delta encoding for time columns, see `internal::EncodeColumn`), and the
+ * table's size accounting uses the encoded size. Encoded columns are decoded lazily when read.
+ *
+ * Zone Maps:
+ * Each cold batch carries a zone map (see `internal::ZoneMap`), built at compaction time, with the
+ * min/max and null count of each numeric column and, if `--table_store_string_bloom_filters` is
+ * set, a bloom filter of each string column. Cursors created with column predicates skip cold and
+ * spilled batches whose zone maps show that no row can match, without reading (or decoding) them.
+ * Zone maps are kept when batches are spilled. Like the row and time indexes, zone maps don't
+ * count towards `max_table_size_`.
+ *
+ * Spill Scheme:
+ * If `--table_store_spill_dir` is set, cold batches that are expired to keep the table under
+ * `max_table_size_` are written to disk instead of being dropped (see `internal::SpillBatch`). The
+ * spilled batches form a third store, older than the cold store, which is limited to
+ * `--table_store_table_spill_size_limit` bytes of disk per table. Cursors read spilled data
+ * transparently, and time lookups use the spill store's time index to skip spilled batches without
+ * reading them. Spilled data doesn't count towards `max_table_size_`.
  *
  * Time and Row Indexing:
  * The first and last values of the time columns for each batch are stored in
@@ -112,10 +150,13 @@ class Table : public NotCopyable {
   using BatchID = internal::BatchID;
 
   static inline constexpr int64_t kDefaultColdBatchMinSize = 64 * 1024;
+  static inline constexpr int64_t kSpillFileSize = 16 * 1024 * 1024;
+  static inline constexpr std::chrono::milliseconds kGaugeUpdatePeriod{1000};
 
  public:
   static inline constexpr int64_t kMaxBatchesPerCompactionCall = 256;
   using StopPosition = int64_t;
+  using ColumnPredicate = internal::ColumnPredicate;
   static inline std::shared_ptr<Table> Create(std::string_view table_name,
                                               const schema::Relation& relation) {
     // Create naked pointer, because std::make_shared() cannot access the private ctor.
@@ -126,7 +167,9 @@ class Table : public NotCopyable {
   /**
    * Cursor allows iterating the table, while guaranteeing that no row is returned twice (even when
    * compactions occur between accesses). {Start,Stop}Spec specify what rows the cursor should begin
-   * and end at when iterating the cursor.
+   * and end at when iterating the cursor. If the cursor has predicates, it may skip batches that
+   * contain no rows matching all of the predicates, but doesn't filter the rows of the batches it
+   * returns, so the predicates must still be applied by the reader.
    */
   class Cursor {
    public:
@@ -174,7 +217,8 @@ class Table : public NotCopyable {
     };
 
     explicit Cursor(const Table* table) : Cursor(table, StartSpec{}, StopSpec{}) {}
-    Cursor(const Table* table, StartSpec start, StopSpec stop);
+    Cursor(const Table* table, StartSpec start, StopSpec stop,
+           std::vector<ColumnPredicate> predicates = {});
 
     // In the case of StopType == Infinite or StopType == StopAtTime, this returns whether the table
     // has the next batch ready. In the case of StopType == CurrentEndOfTable, this returns !Done().
@@ -182,6 +226,8 @@ class Table : public NotCopyable {
     // For instance, the desired row batch could have been expired between the call to
     // `NextBatchReady()` and `GetNextRowBatch(...)`, and then the row batch after the expired one
     // is past the stopping condition. In this case `GetNextRowBatch(...)` will return an error.
+    // If the cursor has predicates, `GetNextRowBatch(...)` can return a batch with no rows, when
+    // all of the remaining batches were skipped.
     bool NextBatchReady();
     StatusOr<std::unique_ptr<schema::RowBatch>> GetNextRowBatch(const std::vector<int64_t>& cols);
     // In the case of StopType == Infinite, this function always returns false.
@@ -198,6 +244,7 @@ class Table : public NotCopyable {
     internal::RowID* LastReadRowID();
     internal::BatchHints* Hints();
     std::optional<internal::RowID> StopRowID() const;
+    const std::vector<ColumnPredicate>& Predicates() const { return predicates_; }
 
     struct StopState {
       StopSpec spec;
@@ -210,6 +257,7 @@ class Table : public NotCopyable {
     internal::BatchHints hints_;
     RowID last_read_row_id_;
     StopState stop_;
+    std::vector<ColumnPredicate> predicates_;
 
     friend class Table;
   };
@@ -294,6 +342,25 @@ class Table : public NotCopyable {
 
   TableStats GetTableStats() const;
 
+  /**
+   * Changes the maximum number of bytes that the table can hold. If the table holds more than the
+   * new maximum, the oldest batches are expired straight away.
+   * @param max_table_size the new maximum table size in bytes.
+   */
+  Status SetMaxTableSize(int64_t max_table_size);
+
+  /**
+   * Returns the (steady clock) time at which a cursor was last created on the table, or
+   * std::nullopt if the table has never been read.
+   */
+  std::optional<std::chrono::steady_clock::time_point> LastReadTime() const;
+
+  /**
+   * Records the fraction of the bytes added to the table that had to be expired to make room for
+   * them, as computed by whoever manages the table's size (see `MemoryArbiter`).
+   */
+  void RecordEvictionPressure(double eviction_pressure);
+
   /**
    * Compacts hot batches into compacted_batch_size_ sized cold batches. Each call to
    * CompactHotToCold will create a maximum of kMaxBatchesPerCompactionCall cold batches.
@@ -310,9 +377,28 @@ class Table : public NotCopyable {
   int64_t batches_expired_ ABSL_GUARDED_BY(stats_lock_) = 0;
   int64_t batches_added_ ABSL_GUARDED_BY(stats_lock_) = 0;
   int64_t bytes_added_ ABSL_GUARDED_BY(stats_lock_) = 0;
+  int64_t bytes_expired_ ABSL_GUARDED_BY(stats_lock_) = 0;
   int64_t compacted_batches_ ABSL_GUARDED_BY(stats_lock_) = 0;
-  int64_t max_table_size_ = 0;
+  // max_table_size_ is atomic so that it can be changed while the table is being written to.
+  std::atomic<int64_t> max_table_size_ = 0;
+  // Time since the steady clock's epoch, in nanoseconds, at which the last cursor was created. Zero
+  // if the table has never been read.
+  mutable std::atomic<int64_t> last_read_ns_ = 0;
   const int64_t compacted_batch_size_;
+  const bool cold_encoding_enabled_;
+  const bool string_bloom_filters_enabled_;
+  const int64_t max_spill_size_;
+
+  // spill_write_lock_ serializes the expiry of cold batches, so that the oldest cold batch can be
+  // written to disk without holding spill_lock_, which readers need.
+  absl::Mutex spill_write_lock_ ABSL_ACQUIRED_BEFORE(spill_lock_);
+  // spill_writer_ is only set if spilling is enabled.
+  std::unique_ptr<internal::SpillWriter> spill_writer_ ABSL_GUARDED_BY(spill_write_lock_);
+  mutable absl::Mutex spill_lock_;
+  std::unique_ptr<internal::StoreWithRowTimeAccounting<internal::StoreType::Spill>> spill_store_
+      ABSL_GUARDED_BY(spill_lock_);
+  int64_t spill_bytes_ ABSL_GUARDED_BY(spill_lock_) = 0;
+
   mutable absl::base_internal::SpinLock hot_lock_;
   std::unique_ptr<internal::StoreWithRowTimeAccounting<internal::StoreType::Hot>> hot_store_
       ABSL_GUARDED_BY(hot_lock_);
@@ -323,8 +409,20 @@ class Table : public NotCopyable {
   std::deque<int64_t> cold_batch_bytes_ ABSL_GUARDED_BY(cold_lock_);
 
   // Counter to assign a unique row ID to each row. Synchronized by hot_lock_ since its only
-  // accessed on a hot write.
-  int64_t next_row_id_ ABSL_GUARDED_BY(hot_lock_) = 0;
+  // accessed when publishing pending hot batches.
+  mutable int64_t next_row_id_ ABSL_GUARDED_BY(hot_lock_) = 0;
+
+  // Batches that have been written, but not yet moved into the hot store. See "Synchronization
+  // Scheme" above.
+  using PendingHotBatch =
+      std::pair<internal::RecordOrRowBatch, internal::BatchSizeAccountant::BatchStats>;
+  mutable internal::MPSCQueue<PendingHotBatch> pending_hot_batches_;
+  mutable std::atomic<int64_t> pending_hot_bytes_ = 0;
+  // The hot and cold bytes of the batch size accountant, which can be read without the hot lock.
+  mutable std::atomic<int64_t> stored_bytes_ = 0;
+  // Time since the steady clock's epoch, in nanoseconds, at which the gauges were last updated by
+  // a write.
+  std::atomic<int64_t> gauges_updated_ns_ = 0;
   int64_t time_col_idx_ = -1;
 
   Status WriteHot(internal::RecordOrRowBatch&& record_or_row_batch);
@@ -332,10 +430,19 @@ class Table : public NotCopyable {
   Status ExpireBatch();
   Status ExpireHot();
   StatusOr<bool> ExpireCold();
+  void AddSpillBatch(RowID first_row_id, internal::SpillBatch spill_batch)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(spill_lock_);
   Status ExpireRowBatches(int64_t row_batch_size);
   Status CompactSingleBatchUnlocked(arrow::MemoryPool* mem_pool)
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(cold_lock_) ABSL_EXCLUSIVE_LOCKS_REQUIRED(hot_lock_);
   Status UpdateTableMetricGauges();
+  // Updates the gauges at most once every kGaugeUpdatePeriod, since updating them takes every lock
+  // of the table.
+  Status MaybeUpdateTableMetricGauges();
+  // Moves the pending hot batches into the hot store. Must be called after acquiring hot_lock_,
+  // before accessing the hot store.
+  void PublishPendingHotBatches() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(hot_lock_);
+  void UpdateStoredBytes() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(hot_lock_);
 
   Time MaxTime() const;
 
@@ -19,6 +19,7 @@
 #include <absl/synchronization/barrier.h>
 #include <absl/synchronization/notification.h>
 #include <benchmark/benchmark.h>
+#include <atomic>
 #include <chrono>
 #include <deque>
 #include <numeric>
@@ -133,6 +134,39 @@ static void BM_TableReadAllCold(benchmark::State& state) {
   state.SetBytesProcessed(state.iterations() * table_size);
 }
 
+// Reads the cold table with a predicate on the time column that matches the newest
+// `state.range(0)` percent of rows. The cursor starts at the beginning of the table, so the older
+// batches can only be skipped using their zone maps.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_TableReadSelectiveCold(benchmark::State& state) {
+  int64_t table_size = 4 * 1024 * 1024;
+  int64_t compaction_size = 64 * 1024;
+  int64_t batch_length = 256;
+  int64_t selectivity_percent = state.range(0);
+  auto table = MakeTable(table_size, compaction_size);
+  auto last_time = FillTableCold(table.get(), table_size, batch_length);
+  CHECK_EQ(table->GetTableStats().bytes, table_size);
+
+  std::vector<Table::ColumnPredicate> predicates = {
+      {0, Table::ColumnPredicate::Op::kGreaterThanEqual,
+       last_time - last_time * selectivity_percent / 100}};
+  auto make_cursor = [&]() {
+    return Table::Cursor(table.get(), Table::Cursor::StartSpec{}, Table::Cursor::StopSpec{},
+                         predicates);
+  };
+  auto cursor = make_cursor();
+
+  for (auto _ : state) {
+    ReadFullTable(&cursor);
+
+    state.PauseTiming();
+    cursor = make_cursor();
+    state.ResumeTiming();
+  }
+
+  state.SetBytesProcessed(state.iterations() * table_size);
+}
+
 Table::Cursor GetLastBatchCursor(Table* table, int64_t last_time, int64_t batch_length,
                                  const std::vector<int64_t>& cols) {
   Table::Cursor cursor(table,
@@ -360,13 +394,198 @@ static void BM_TableThreaded(benchmark::State& state) {
   state.counters["Write"] = benchmark::Counter(write_average_time);
 }
 
+// Measures write throughput with state.range(0) writers appending to the table, while
+// state.range(1) readers stream the table and a compactor runs continuously. The time reported is
+// the time taken by the writers.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_TableContention(benchmark::State& state) {
+  int64_t num_writers = state.range(0);
+  int64_t num_readers = state.range(1);
+  int64_t table_size = 16 * 1024 * 1024;
+  int64_t compaction_size = 64 * 1024;
+  int64_t batch_length = 256;
+  int64_t batches_per_writer = 2048;
+  int64_t batch_size = batch_length * sizeof(int64_t) + batch_length * sizeof(double);
+
+  int64_t rows_read = 0;
+  for (auto _ : state) {
+    std::shared_ptr<Table> table = MakeTable(table_size, compaction_size);
+    absl::Notification done;
+    std::atomic<int64_t> iteration_rows_read = 0;
+
+    std::thread compaction_thread([&]() {
+      while (!done.WaitForNotificationWithTimeout(absl::Milliseconds(1))) {
+        PX_CHECK_OK(table->CompactHotToCold(arrow::default_memory_pool()));
+      }
+    });
+    std::vector<std::thread> reader_threads;
+    for (int64_t i = 0; i < num_readers; ++i) {
+      reader_threads.emplace_back([&]() {
+        Table::Cursor cursor(table.get(), Table::Cursor::StartSpec{},
+                             Table::Cursor::StopSpec{Table::Cursor::StopSpec::StopType::Infinite});
+        while (!done.HasBeenNotified()) {
+          if (!cursor.NextBatchReady()) {
+            continue;
+          }
+          auto rb_or_s = cursor.GetNextRowBatch({0, 1});
+          if (rb_or_s.ok()) {
+            iteration_rows_read += rb_or_s.ValueOrDie()->num_rows();
+          }
+        }
+      });
+    }
+
+    auto barrier = std::make_unique<absl::Barrier>(num_writers + 1);
+    std::vector<std::thread> writer_threads;
+    for (int64_t i = 0; i < num_writers; ++i) {
+      writer_threads.emplace_back([&]() {
+        // Pre-build the batches so that only the writes are measured.
+        int64_t time_counter = 0;
+        std::vector<std::unique_ptr<types::ColumnWrapperRecordBatch>> batches;
+        for (int64_t j = 0; j < batches_per_writer; ++j) {
+          batches.push_back(MakeHotBatch(batch_length, &time_counter));
+        }
+        barrier->Block();
+        for (auto& batch : batches) {
+          PX_CHECK_OK(table->TransferRecordBatch(std::move(batch)));
+        }
+      });
+    }
+
+    barrier->Block();
+    auto start = std::chrono::high_resolution_clock::now();
+    for (auto& writer_thread : writer_threads) {
+      writer_thread.join();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    state.SetIterationTime(
+        std::chrono::duration_cast<std::chrono::duration<double>>(end - start).count());
+
+    done.Notify();
+    compaction_thread.join();
+    for (auto& reader_thread : reader_threads) {
+      reader_thread.join();
+    }
+    rows_read += iteration_rows_read;
+  }
+
+  state.SetBytesProcessed(state.iterations() * num_writers * batches_per_writer * batch_size);
+  state.counters["rows_read"] = benchmark::Counter(rows_read, benchmark::Counter::kAvgIterations);
+}
+
+static inline std::unique_ptr<Table> MakeHTTPTable(int64_t max_size, int64_t compaction_size) {
+  schema::Relation rel(
+      std::vector<types::DataType>({types::DataType::TIME64NS, types::DataType::STRING,
+                                    types::DataType::STRING, types::DataType::INT64,
+                                    types::DataType::STRING}),
+      std::vector<std::string>({"time_", "req_method", "req_path", "latency", "resp_body"}));
+  return std::make_unique<Table>("http_events", rel, max_size, compaction_size);
+}
+
+static inline std::unique_ptr<types::ColumnWrapperRecordBatch> MakeHTTPHotBatch(
+    int64_t batch_size, int64_t* time_counter, std::mt19937_64* rng) {
+  static const std::vector<std::string> kMethods = {"GET", "POST", "PUT", "DELETE"};
+  static const std::vector<std::string> kPaths = {"/api/v1/users", "/api/v1/orders",
+                                                  "/healthz", "/metrics"};
+  std::uniform_int_distribution<int64_t> latency_dist(100000, 5000000);
+  std::uniform_int_distribution<int64_t> time_step_dist(1000, 100000);
+
+  auto time_col = std::make_shared<types::Time64NSValueColumnWrapper>(batch_size);
+  auto method_col = std::make_shared<types::StringValueColumnWrapper>(batch_size);
+  auto path_col = std::make_shared<types::StringValueColumnWrapper>(batch_size);
+  auto latency_col = std::make_shared<types::Int64ValueColumnWrapper>(batch_size);
+  auto body_col = std::make_shared<types::StringValueColumnWrapper>(batch_size);
+  for (int64_t i = 0; i < batch_size; ++i) {
+    *time_counter += time_step_dist(*rng);
+    (*time_col)[i] = *time_counter;
+    (*method_col)[i] = kMethods[(*rng)() % kMethods.size()];
+    (*path_col)[i] = kPaths[(*rng)() % kPaths.size()];
+    (*latency_col)[i] = latency_dist(*rng);
+    (*body_col)[i] = absl::StrFormat(R"({"id": %d, "status": "ok", "items": [%s]})", *time_counter,
+                                     std::string(128, 'a' + (*rng)() % 26));
+  }
+
+  auto wrapper_batch = std::make_unique<types::ColumnWrapperRecordBatch>();
+  wrapper_batch->push_back(time_col);
+  wrapper_batch->push_back(method_col);
+  wrapper_batch->push_back(path_col);
+  wrapper_batch->push_back(latency_col);
+  wrapper_batch->push_back(body_col);
+  return wrapper_batch;
+}
+
+// Writes num_batches HTTP-like batches to the table, compacting after each write.
+static inline void FillHTTPTableCold(Table* table, int64_t num_batches, int64_t batch_length) {
+  std::mt19937_64 rng(37);
+  int64_t time_counter = 0;
+  for (int64_t i = 0; i < num_batches; ++i) {
+    PX_CHECK_OK(table->TransferRecordBatch(MakeHTTPHotBatch(batch_length, &time_counter, &rng)));
+    PX_CHECK_OK(table->CompactHotToCold(arrow::default_memory_pool()));
+  }
+}
+
+// Measures how many rows a size limited table retains, with and without cold encodings.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_TableRetainedRowsPerMB(benchmark::State& state) {
+  FLAGS_table_store_cold_encoding = state.range(0);
+  int64_t table_size = 4 * 1024 * 1024;
+  int64_t compaction_size = 64 * 1024;
+  int64_t batch_length = 256;
+  // Write enough data to overflow the table several times, so that it is full of cold batches.
+  int64_t num_batches = 4 * table_size / (batch_length * 128);
+
+  double rows_per_mb = 0;
+  for (auto _ : state) {
+    auto table = MakeHTTPTable(table_size, compaction_size);
+    FillHTTPTableCold(table.get(), num_batches, batch_length);
+    auto stats = table->GetTableStats();
+    auto num_rows = table->LastRowID() - table->FirstRowID() + 1;
+    rows_per_mb = num_rows / (static_cast<double>(stats.bytes) / (1024 * 1024));
+  }
+  state.counters["rows_per_mb"] = rows_per_mb;
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_TableReadAllColdHTTP(benchmark::State& state) {
+  FLAGS_table_store_cold_encoding = state.range(0);
+  int64_t table_size = 4 * 1024 * 1024;
+  int64_t compaction_size = 64 * 1024;
+  int64_t batch_length = 256;
+  int64_t num_batches = table_size / (batch_length * 256);
+  auto table = MakeHTTPTable(table_size, compaction_size);
+  FillHTTPTableCold(table.get(), num_batches, batch_length);
+  // Only project the columns typically used by queries over http_events.
+  std::vector<int64_t> cols = {0, 1, 3};
+
+  int64_t rows = 0;
+  for (auto _ : state) {
+    Table::Cursor cursor(table.get());
+    while (!cursor.Done()) {
+      auto rb_or_s = cursor.GetNextRowBatch(cols);
+      rows += rb_or_s.ValueOrDie()->num_rows();
+      benchmark::DoNotOptimize(rb_or_s);
+    }
+  }
+  state.SetItemsProcessed(rows);
+}
+
 BENCHMARK(BM_TableReadAllHot);
 BENCHMARK(BM_TableReadAllCold);
+BENCHMARK(BM_TableReadSelectiveCold)->Arg(1)->Arg(10)->Arg(100);
 BENCHMARK(BM_TableReadLastBatchAllHot)->Iterations(1000);
 BENCHMARK(BM_TableReadLastBatchAllCold)->Iterations(1000);
 BENCHMARK(BM_TableWriteEmpty);
 BENCHMARK(BM_TableWriteFull);
 BENCHMARK(BM_TableCompaction);
 BENCHMARK(BM_TableThreaded)->UseManualTime()->Iterations(1);
+BENCHMARK(BM_TableContention)
+    ->Args({1, 0})
+    ->Args({1, 4})
+    ->Args({4, 0})
+    ->Args({4, 4})
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_TableRetainedRowsPerMB)->Arg(false)->Arg(true)->Iterations(1);
+BENCHMARK(BM_TableReadAllColdHTTP)->Arg(false)->Arg(true);
 
 }  // namespace px::table_store
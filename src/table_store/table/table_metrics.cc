@@ -26,6 +26,12 @@ TableMetrics::TableMetrics(prometheus::Registry* registry, std::string table_nam
                               .Help("Total bytes written to the table in the table's lifetime")
                               .Register(*registry)
                               .Add({{"name", table_name}})),
+      bytes_expired_counter(
+          prometheus::BuildCounter()
+              .Name("table_bytes_expired")
+              .Help("Total bytes expired from the table in the table's lifetime")
+              .Register(*registry)
+              .Add({{"name", table_name}})),
       cold_bytes_gauge(prometheus::BuildGauge()
                            .Name("table_cold_bytes")
                            .Help("Current cold data bytes in the table")
@@ -36,6 +42,11 @@ TableMetrics::TableMetrics(prometheus::Registry* registry, std::string table_nam
                           .Help("Current hot data bytes in the table")
                           .Register(*registry)
                           .Add({{"name", table_name}})),
+      spill_bytes_gauge(prometheus::BuildGauge()
+                            .Name("table_spill_bytes")
+                            .Help("Current bytes of data in the table that were spilled to disk")
+                            .Register(*registry)
+                            .Add({{"name", table_name}})),
       num_batches_gauge(prometheus::BuildGauge()
                             .Name("table_num_batches")
                             .Help("Current number of row batches in the table")
@@ -67,4 +78,11 @@ TableMetrics::TableMetrics(prometheus::Registry* registry, std::string table_nam
                              .Name("min_time")
                              .Help("The current retention window for data in this table")
                              .Register(*registry)
-                             .Add({{"name", table_name}})) {}
+                             .Add({{"name", table_name}})),
+      eviction_pressure_gauge(
+          prometheus::BuildGauge()
+              .Name("table_eviction_pressure")
+              .Help("The fraction of the bytes recently added to the table that were matched by "
+                    "bytes expired from the table")
+              .Register(*registry)
+              .Add({{"name", table_name}})) {}
@@ -17,6 +17,7 @@
  */
 
 #include <algorithm>
+#include <chrono>
 #include <utility>
 #include <vector>
 
@@ -162,6 +163,14 @@ Status TableStore::RunCompaction(arrow::MemoryPool* mem_pool) {
   for (const auto& it : name_to_table_map_) {
     PX_RETURN_IF_ERROR(it.second->CompactHotToCold(mem_pool));
   }
+  if (memory_arbiter_ != nullptr) {
+    std::vector<Table*> tables;
+    tables.reserve(name_to_table_map_.size());
+    for (const auto& it : name_to_table_map_) {
+      tables.push_back(it.second.get());
+    }
+    PX_RETURN_IF_ERROR(memory_arbiter_->Rebalance(tables, std::chrono::steady_clock::now()));
+  }
   return Status::OK();
 }
 
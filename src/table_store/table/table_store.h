@@ -31,6 +31,7 @@
 #include "src/shared/types/hash_utils.h"
 #include "src/table_store/schema/relation.h"
 #include "src/table_store/schema/schema.h"
+#include "src/table_store/table/memory_arbiter.h"
 #include "src/table_store/table/table.h"
 #include "src/table_store/table/tablets_group.h"
 
@@ -165,8 +166,21 @@ class TableStore {
     return "";
   }
 
+  /**
+   * Compacts the hot data of every table and, if a memory arbiter is enabled, rebalances the
+   * tables' maximum sizes.
+   */
   Status RunCompaction(arrow::MemoryPool* mem_pool);
 
+  /**
+   * Shares a single memory budget between all of the tables in the store (including tables added
+   * later), rather than each table keeping the maximum size it was created with. See
+   * `MemoryArbiter` for details.
+   */
+  void EnableMemoryArbiter(MemoryArbiter::Options opts) {
+    memory_arbiter_ = std::make_unique<MemoryArbiter>(opts);
+  }
+
  private:
   void RegisterTableName(const std::string& table_name, const types::TabletID& tablet_id,
                          const schema::Relation& table_relation,
@@ -197,6 +211,8 @@ class TableStore {
   absl::flat_hash_map<std::string, schema::Relation> name_to_relation_map_;
   // Mapping from id to name and relation pair for adding new tablets.
   absl::flat_hash_map<uint64_t, TableInfo> id_to_table_info_map_;
+  // Only set if the memory arbiter is enabled.
+  std::unique_ptr<MemoryArbiter> memory_arbiter_;
 };
 
 }  // namespace table_store
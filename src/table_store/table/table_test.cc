@@ -16,11 +16,16 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <unistd.h>
+
 #include <absl/synchronization/notification.h>
 #include <arrow/array.h>
 #include <google/protobuf/text_format.h>
 #include <google/protobuf/util/message_differencer.h>
+#include <algorithm>
+#include <iterator>
 #include <random>
+#include <string>
 #include <vector>
 
 #include "src/common/testing/testing.h"
@@ -204,6 +209,208 @@ TEST(TableTest, bytes_test_w_compaction) {
   EXPECT_EQ(table.GetTableStats().bytes, rb1_size + rb2_size + rb3_size);
 }
 
+TEST(TableTest, cold_encoding) {
+  PX_SET_FOR_SCOPE(FLAGS_table_store_cold_encoding, true);
+  schema::Relation rel({types::DataType::TIME64NS, types::DataType::STRING, types::DataType::INT64},
+                       {"time_", "req_method", "latency"});
+
+  const int64_t num_rows = 1024;
+  std::vector<types::Time64NSValue> times;
+  std::vector<types::StringValue> methods;
+  std::vector<types::Int64Value> latencies;
+  for (int64_t i = 0; i < num_rows; ++i) {
+    times.push_back(1000 + 3 * i);
+    methods.push_back((i % 4 == 0) ? "POST" : "GET");
+    latencies.push_back(100000 + (i * 37) % 1000);
+  }
+  schema::RowBatch rb(schema::RowDescriptor(rel.col_types()), num_rows);
+  EXPECT_OK(rb.AddColumn(types::ToArrow(times, arrow::default_memory_pool())));
+  EXPECT_OK(rb.AddColumn(types::ToArrow(methods, arrow::default_memory_pool())));
+  EXPECT_OK(rb.AddColumn(types::ToArrow(latencies, arrow::default_memory_pool())));
+
+  auto table_ptr = std::make_shared<Table>("test_table", rel, 1024 * 1024, 1024);
+  EXPECT_OK(table_ptr->WriteRowBatch(rb));
+  auto hot_bytes = table_ptr->GetTableStats().bytes;
+  EXPECT_OK(table_ptr->CompactHotToCold(arrow::default_memory_pool()));
+
+  auto stats = table_ptr->GetTableStats();
+  EXPECT_GT(stats.compacted_batches, 0);
+  EXPECT_LT(stats.cold_bytes, hot_bytes / 2);
+
+  // Reading the data back should return exactly what was written, regardless of the encoding.
+  Table::Cursor cursor(table_ptr.get());
+  std::vector<types::Time64NSValue> out_times;
+  std::vector<types::StringValue> out_methods;
+  while (!cursor.Done()) {
+    ASSERT_OK_AND_ASSIGN(auto out_rb, cursor.GetNextRowBatch({1, 0}));
+    for (int64_t i = 0; i < out_rb->num_rows(); ++i) {
+      out_methods.push_back(
+          types::GetValueFromArrowArray<types::DataType::STRING>(out_rb->ColumnAt(0).get(), i));
+      out_times.push_back(
+          types::GetValueFromArrowArray<types::DataType::TIME64NS>(out_rb->ColumnAt(1).get(), i));
+    }
+  }
+  EXPECT_EQ(times, out_times);
+  EXPECT_EQ(methods, out_methods);
+
+  // Time lookups should work on the encoded time column.
+  EXPECT_EQ(100, table_ptr->FindRowIDFromTimeFirstGreaterThanOrEqual(1000 + 3 * 100 - 1));
+  EXPECT_EQ(101, table_ptr->FindRowIDFromTimeFirstGreaterThan(1000 + 3 * 100));
+}
+
+namespace {
+// Writes num_batches batches of batch_size rows to the given table, compacting after each write so
+// that expiry happens from the cold store. Row i has time i.
+void WriteAndCompact(Table* table, const schema::Relation& rel, int64_t num_batches,
+                     int64_t batch_size) {
+  for (int64_t batch = 0; batch < num_batches; ++batch) {
+    std::vector<types::Time64NSValue> times;
+    std::vector<types::StringValue> methods;
+    for (int64_t i = 0; i < batch_size; ++i) {
+      times.push_back(batch * batch_size + i);
+      methods.push_back((i % 4 == 0) ? "POST" : "GET");
+    }
+    schema::RowBatch rb(schema::RowDescriptor(rel.col_types()), batch_size);
+    EXPECT_OK(rb.AddColumn(types::ToArrow(times, arrow::default_memory_pool())));
+    EXPECT_OK(rb.AddColumn(types::ToArrow(methods, arrow::default_memory_pool())));
+    EXPECT_OK(table->WriteRowBatch(rb));
+    EXPECT_OK(table->CompactHotToCold(arrow::default_memory_pool()));
+  }
+}
+
+// Reads the time column of every row after the given cursor.
+std::vector<int64_t> ReadTimes(Table::Cursor* cursor) {
+  std::vector<int64_t> times;
+  while (!cursor->Done()) {
+    auto rb = cursor->GetNextRowBatch({0}).ConsumeValueOrDie();
+    for (int64_t i = 0; i < rb->num_rows(); ++i) {
+      times.push_back(
+          types::GetValueFromArrowArray<types::DataType::TIME64NS>(rb->ColumnAt(0).get(), i));
+    }
+  }
+  return times;
+}
+}  // namespace
+
+TEST(TableTest, spill_to_disk) {
+  px::testing::TempDir temp_dir;
+  PX_SET_FOR_SCOPE(FLAGS_table_store_spill_dir, temp_dir.path().string());
+  schema::Relation rel({types::DataType::TIME64NS, types::DataType::STRING},
+                       {"time_", "req_method"});
+
+  const int64_t num_batches = 50;
+  const int64_t batch_size = 100;
+  auto table_ptr = std::make_shared<Table>("test_table", rel, 8 * 1024, 2 * 1024);
+  WriteAndCompact(table_ptr.get(), rel, num_batches, batch_size);
+
+  auto stats = table_ptr->GetTableStats();
+  EXPECT_GT(stats.batches_expired, 0);
+  EXPECT_GT(stats.spill_bytes, 0);
+  EXPECT_LE(stats.bytes, 8 * 1024);
+  // None of the expired data was dropped, so the table still starts at the first row.
+  EXPECT_EQ(0, stats.min_time);
+  EXPECT_EQ(0, table_ptr->FirstRowID());
+
+  // A cursor over the whole table reads the spilled rows, followed by the in-memory rows.
+  Table::Cursor cursor(table_ptr.get());
+  auto times = ReadTimes(&cursor);
+  ASSERT_EQ(num_batches * batch_size, times.size());
+  for (const auto& [i, time] : Enumerate(times)) {
+    ASSERT_EQ(static_cast<int64_t>(i), time);
+  }
+
+  // Time lookups use the spill store's time index.
+  EXPECT_EQ(123, table_ptr->FindRowIDFromTimeFirstGreaterThanOrEqual(123));
+  EXPECT_EQ(124, table_ptr->FindRowIDFromTimeFirstGreaterThan(123));
+  Table::Cursor time_cursor(table_ptr.get(),
+                            Table::Cursor::StartSpec{Table::Cursor::StartSpec::StartAtTime, 250},
+                            Table::Cursor::StopSpec{Table::Cursor::StopSpec::StopAtTime, 299});
+  times = ReadTimes(&time_cursor);
+  ASSERT_EQ(50, times.size());
+  EXPECT_EQ(250, times.front());
+  EXPECT_EQ(299, times.back());
+}
+
+TEST(TableTest, spill_to_disk_size_limit) {
+  px::testing::TempDir temp_dir;
+  PX_SET_FOR_SCOPE(FLAGS_table_store_spill_dir, temp_dir.path().string());
+  // Spilled batches are page aligned, so this fits a few spilled batches.
+  const int64_t spill_size_limit = 4 * sysconf(_SC_PAGESIZE);
+  PX_SET_FOR_SCOPE(FLAGS_table_store_table_spill_size_limit, spill_size_limit);
+  schema::Relation rel({types::DataType::TIME64NS, types::DataType::STRING},
+                       {"time_", "req_method"});
+
+  const int64_t num_batches = 50;
+  const int64_t batch_size = 100;
+  auto table_ptr = std::make_shared<Table>("test_table", rel, 8 * 1024, 2 * 1024);
+  WriteAndCompact(table_ptr.get(), rel, num_batches, batch_size);
+
+  auto stats = table_ptr->GetTableStats();
+  EXPECT_GT(stats.spill_bytes, 0);
+  EXPECT_LE(stats.spill_bytes, spill_size_limit);
+  // The oldest spilled data was dropped to stay within the limit.
+  EXPECT_GT(stats.min_time, 0);
+
+  // The remaining rows are still contiguous, from the oldest spilled row to the newest row.
+  Table::Cursor cursor(table_ptr.get());
+  auto times = ReadTimes(&cursor);
+  ASSERT_FALSE(times.empty());
+  EXPECT_EQ(stats.min_time, times.front());
+  EXPECT_EQ(num_batches * batch_size - 1, times.back());
+  EXPECT_EQ(num_batches * batch_size - stats.min_time, static_cast<int64_t>(times.size()));
+}
+
+TEST(TableTest, cursor_predicates_skip_batches) {
+  px::testing::TempDir temp_dir;
+  PX_SET_FOR_SCOPE(FLAGS_table_store_spill_dir, temp_dir.path().string());
+  PX_SET_FOR_SCOPE(FLAGS_table_store_string_bloom_filters, true);
+  schema::Relation rel({types::DataType::TIME64NS, types::DataType::STRING},
+                       {"time_", "req_method"});
+
+  const int64_t num_batches = 50;
+  const int64_t batch_size = 100;
+  const int64_t num_rows = num_batches * batch_size;
+  auto table_ptr = std::make_shared<Table>("test_table", rel, 8 * 1024, 2 * 1024);
+  WriteAndCompact(table_ptr.get(), rel, num_batches, batch_size);
+  ASSERT_GT(table_ptr->GetTableStats().spill_bytes, 0);
+
+  // Batches are skipped, but rows within the returned batches aren't filtered, so the cursor must
+  // return every matching row (and possibly some that don't match).
+  auto expect_matching_rows = [](const std::vector<int64_t>& times, int64_t min_time,
+                                 int64_t max_time) {
+    std::vector<int64_t> matching;
+    std::copy_if(times.begin(), times.end(), std::back_inserter(matching),
+                 [&](int64_t t) { return t >= min_time && t <= max_time; });
+    ASSERT_EQ(max_time - min_time + 1, static_cast<int64_t>(matching.size()));
+    for (const auto& [i, time] : Enumerate(matching)) {
+      ASSERT_EQ(min_time + static_cast<int64_t>(i), time);
+    }
+  };
+
+  // Recent rows, only the newest cold batches and the hot batches are read.
+  Table::Cursor recent_cursor(table_ptr.get(), Table::Cursor::StartSpec{},
+                              Table::Cursor::StopSpec{},
+                              {{0, Table::ColumnPredicate::Op::kGreaterThanEqual, int64_t{4500}}});
+  auto times = ReadTimes(&recent_cursor);
+  expect_matching_rows(times, 4500, num_rows - 1);
+  EXPECT_LT(static_cast<int64_t>(times.size()), 1000);
+
+  // Old rows, only the oldest spilled batches are read, the rest of the table is skipped.
+  Table::Cursor old_cursor(table_ptr.get(), Table::Cursor::StartSpec{}, Table::Cursor::StopSpec{},
+                           {{0, Table::ColumnPredicate::Op::kLessThan, int64_t{300}}});
+  times = ReadTimes(&old_cursor);
+  expect_matching_rows(times, 0, 299);
+  // Hot batches can't be skipped, since they don't have zone maps.
+  EXPECT_LT(static_cast<int64_t>(times.size()), 300 + 2 * batch_size);
+
+  // No row has this method, so every cold and spilled batch is skipped using its bloom filter.
+  Table::Cursor method_cursor(
+      table_ptr.get(), Table::Cursor::StartSpec{}, Table::Cursor::StopSpec{},
+      {{1, Table::ColumnPredicate::Op::kEqual, std::string("DELETE")}});
+  times = ReadTimes(&method_cursor);
+  EXPECT_LT(static_cast<int64_t>(times.size()), 2 * batch_size);
+}
+
 TEST(TableTest, expiry_test) {
   auto rd = schema::RowDescriptor({types::DataType::INT64, types::DataType::STRING});
   schema::Relation rel(rd.types(), {"col1", "col2"});
@@ -864,6 +1071,73 @@ TEST(TableTest, threaded) {
   reader_thread.join();
 }
 
+TEST(TableTest, threaded_multiple_writers) {
+  schema::Relation rel({types::DataType::INT64, types::DataType::INT64}, {"writer", "seq"});
+  std::shared_ptr<Table> table_ptr =
+      std::make_shared<Table>("test_table", rel, 64 * 1024 * 1024, 5 * 1024);
+
+  constexpr int kNumWriters = 4;
+  constexpr int64_t kRowsPerWriter = 64 * 1024;
+  constexpr int64_t kBatchSize = 256;
+
+  // Create the cursor before the writers start, to ensure that we get every row of the table.
+  Table::Cursor cursor(table_ptr.get(), Table::Cursor::StartSpec{},
+                       Table::Cursor::StopSpec{Table::Cursor::StopSpec::StopType::Infinite});
+
+  auto done = std::make_shared<absl::Notification>();
+  std::thread compaction_thread([table_ptr, done]() {
+    while (!done->WaitForNotificationWithTimeout(absl::Milliseconds(5))) {
+      EXPECT_OK(table_ptr->CompactHotToCold(arrow::default_memory_pool()));
+    }
+  });
+
+  std::vector<std::thread> writer_threads;
+  for (int writer = 0; writer < kNumWriters; ++writer) {
+    writer_threads.emplace_back([table_ptr, writer]() {
+      for (int64_t seq = 0; seq < kRowsPerWriter; seq += kBatchSize) {
+        auto wrapper_batch = std::make_unique<types::ColumnWrapperRecordBatch>();
+        auto writer_col = std::make_shared<types::Int64ValueColumnWrapper>(kBatchSize);
+        auto seq_col = std::make_shared<types::Int64ValueColumnWrapper>(kBatchSize);
+        for (int64_t i = 0; i < kBatchSize; ++i) {
+          (*writer_col)[i] = writer;
+          (*seq_col)[i] = seq + i;
+        }
+        wrapper_batch->push_back(writer_col);
+        wrapper_batch->push_back(seq_col);
+        EXPECT_OK(table_ptr->TransferRecordBatch(std::move(wrapper_batch)));
+      }
+    });
+  }
+
+  // Read concurrently with the writers, and check that each writer's rows are read exactly once,
+  // in the order they were written.
+  std::vector<int64_t> next_seq(kNumWriters, 0);
+  int64_t num_rows = 0;
+  while (num_rows < kNumWriters * kRowsPerWriter) {
+    if (!cursor.NextBatchReady()) {
+      continue;
+    }
+    auto batch = cursor.GetNextRowBatch({0, 1}).ConsumeValueOrDie();
+    auto writer_col = std::static_pointer_cast<arrow::Int64Array>(batch->ColumnAt(0));
+    auto seq_col = std::static_pointer_cast<arrow::Int64Array>(batch->ColumnAt(1));
+    for (int64_t i = 0; i < batch->num_rows(); ++i) {
+      auto writer = writer_col->Value(i);
+      ASSERT_EQ(next_seq[writer], seq_col->Value(i));
+      next_seq[writer]++;
+      num_rows++;
+    }
+  }
+
+  for (auto& writer_thread : writer_threads) {
+    writer_thread.join();
+  }
+  done->Notify();
+  compaction_thread.join();
+
+  EXPECT_EQ(kNumWriters * kRowsPerWriter * 2 * static_cast<int64_t>(sizeof(int64_t)),
+            table_ptr->GetTableStats().bytes);
+}
+
 // This test was add when `NextBatch` and `BatchSlice`'s were still around, and there was a bug with
 // generation handling of `BatchSlice`'s. Maintaining so as not to decrease test coverage, but this
 // bug should no longer even be plausible.
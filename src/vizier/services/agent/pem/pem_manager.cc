@@ -43,6 +43,18 @@ DEFINE_int32(table_store_proc_exit_events_limit_bytes,
              gflags::Int32FromEnv("PL_TABLE_STORE_PROC_EXIT_EVENTS_LIMIT_BYTES", 10 * 1024 * 1024),
              "The maximum amount of data to store in the proc_exit_events table.");
 
+DEFINE_bool(table_store_adaptive_memory,
+            gflags::BoolFromEnv("PL_TABLE_STORE_ADAPTIVE_MEMORY", false),
+            "If true, the table store data limit is shared between all tables and rebalanced "
+            "periodically based on each table's ingest rate and query activity, instead of each "
+            "table having a fixed size. The fixed sizes are still used as the starting point.");
+
+DEFINE_int32(table_store_min_retention_seconds,
+             gflags::Int32FromEnv("PL_TABLE_STORE_MIN_RETENTION_SECONDS", 5 * 60),
+             "When --table_store_adaptive_memory is set, the amount of data (in seconds at the "
+             "table's current ingest rate) that each table is guaranteed to be able to hold, as "
+             "long as the data limit allows it.");
+
 namespace px {
 namespace vizier {
 namespace agent {
@@ -164,6 +176,15 @@ Status PEMManager::InitSchemas() {
     table_store()->AddTable(std::move(table_ptr), relation_info.name, relation_info.id);
     PX_RETURN_IF_ERROR(relation_info_manager()->AddRelationInfo(relation_info));
   }
+
+  if (FLAGS_table_store_adaptive_memory) {
+    table_store::MemoryArbiter::Options arbiter_opts;
+    arbiter_opts.budget_bytes = memory_limit;
+    arbiter_opts.min_retention = std::chrono::seconds(FLAGS_table_store_min_retention_seconds);
+    // Never shrink a table below the size of the stirling error tables.
+    arbiter_opts.min_table_size = stirling_error_table_size;
+    table_store()->EnableMemoryArbiter(arbiter_opts);
+  }
   return Status::OK();
 }
 
@@ -46,6 +46,8 @@ import (
 
 var queryExecTimeSummary *prometheus.SummaryVec
 var queryExecNumPEMSummary *prometheus.SummaryVec
+var planCacheLookupCounter *prometheus.CounterVec
+var planCacheSavedTimeCounter prometheus.Counter
 
 func init() {
 	queryExecTimeSummary = promauto.NewSummaryVec(
@@ -64,6 +66,19 @@ func init() {
 		},
 		[]string{"script_name"},
 	)
+	planCacheLookupCounter = promauto.NewCounterVec(
+		prometheus.CounterOpts{
+			Name: "query_plan_cache_lookups",
+			Help: "The number of queries planned, by whether the plan came from the planner's plan cache.",
+		},
+		[]string{"result"},
+	)
+	planCacheSavedTimeCounter = promauto.NewCounter(
+		prometheus.CounterOpts{
+			Name: "query_plan_cache_saved_planning_time_ms",
+			Help: "The planning time in milliseconds saved by serving plans from the planner's plan cache.",
+		},
+	)
 	pflag.String("cloud_addr", "vzconn-service.plc.svc:51600", "The Pixie Cloud service url (load balancer/list is ok)")
 }
 
@@ -390,6 +405,12 @@ func (q *QueryExecutorImpl) compilePlan(ctx context.Context, resultCh chan<- *vi
 		}
 		return nil, StatusToError(plannerResultPB.Status)
 	}
+	if plannerResultPB.GetPlanCache().GetHit() {
+		planCacheLookupCounter.With(prometheus.Labels{"result": "hit"}).Inc()
+		planCacheSavedTimeCounter.Add(float64(plannerResultPB.GetPlanCache().GetSavedPlanningTimeNs()) / 1e6)
+	} else {
+		planCacheLookupCounter.With(prometheus.Labels{"result": "miss"}).Inc()
+	}
 	return plannerResultPB.Plan, nil
 }
 
@@ -60,6 +60,8 @@ func init() {
 	pflag.String("mds_port", "50400", "The querybroker service port")
 	pflag.String("pod_namespace", "pl", "The namespace this pod runs in.")
 	pflag.StringArray("cron_script_sources", scriptrunner.DefaultSources, "Where to find cron scripts (cloud, configmaps)")
+	pflag.Int64("max_partition_kelvins", 0, "The maximum number of Kelvins that the post-PEM part of a query is"+
+		" hash partitioned over. 0 uses every Kelvin")
 }
 
 // NewVizierServiceClient creates a new vz RPC client stub.
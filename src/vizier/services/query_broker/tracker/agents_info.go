@@ -163,6 +163,7 @@ func (a *AgentsInfoImpl) UpdateAgentsInfo(update *metadatapb.AgentUpdatesRespons
 	for _, carnotInfo := range carnotInfoMap {
 		a.pendingDs.CarnotInfo = append(a.pendingDs.CarnotInfo, carnotInfo)
 	}
+	a.pendingDs.MaxPartitionKelvins = maxPartitionKelvins(a.pendingDs.CarnotInfo)
 
 	// If we have reached the end of version, promote the pending DistributedState to the current external-facing
 	// distributed state accessible by clients of `Agents`.
@@ -184,6 +185,21 @@ func (a *AgentsInfoImpl) DistributedState() distributedpb.DistributedState {
 	return a.ds
 }
 
+// maxPartitionKelvins returns the number of Kelvins that the planner may hash partition the
+// post-PEM part of a query over. This is every Kelvin, unless the max_partition_kelvins flag is lower.
+func maxPartitionKelvins(carnotInfos []*distributedpb.CarnotInfo) int64 {
+	numKelvins := int64(0)
+	for _, carnotInfo := range carnotInfos {
+		if !carnotInfo.HasDataStore {
+			numKelvins++
+		}
+	}
+	if limit := viper.GetInt64("max_partition_kelvins"); limit > 0 && limit < numKelvins {
+		return limit
+	}
+	return numKelvins
+}
+
 func makeAgentCarnotInfo(agentID uuid.UUID, asid uint32, agentMetadata *distributedpb.MetadataInfo) *distributedpb.CarnotInfo {
 	return &distributedpb.CarnotInfo{
 		QueryBrokerAddress:   agentID.String(),
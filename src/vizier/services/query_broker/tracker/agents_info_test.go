@@ -269,6 +269,7 @@ func TestAgentsInfo_UpdateAgentsInfo(t *testing.T) {
 	assert.Equal(t, 2, len(agentsMap))
 	assert.Equal(t, expectedPEM1Info, agentsMap[uuids[0]])
 	assert.Equal(t, expectedKelvinInfo, agentsMap[uuids[1]])
+	assert.Equal(t, int64(1), agentsInfo.DistributedState().MaxPartitionKelvins)
 
 	// Update agent 1, and add table metadata for another agent,
 	// create an agent, and delete an agent.
@@ -339,6 +340,8 @@ func TestAgentsInfo_UpdateAgentsInfo(t *testing.T) {
 	assert.Equal(t, expectedPEM1Info, agentsMap[uuids[0]])
 	// Agent 3 should be created.
 	assert.Equal(t, expectedPEM2Info, agentsMap[uuids[2]])
+	// The only Kelvin was deleted.
+	assert.Equal(t, int64(0), agentsInfo.DistributedState().MaxPartitionKelvins)
 
 	// Test the case where the schema is updated to be fully empty.
 	err = agentsInfo.UpdateAgentsInfo(&metadatapb.AgentUpdatesResponse{
@@ -350,3 +353,39 @@ func TestAgentsInfo_UpdateAgentsInfo(t *testing.T) {
 	require.NoError(t, err)
 	assert.Equal(t, 0, len(agentsInfo.DistributedState().SchemaInfo))
 }
+
+func TestAgentsInfo_MaxPartitionKelvins(t *testing.T) {
+	viper.Set("pod_namespace", "pl")
+	defer viper.Set("max_partition_kelvins", 0)
+	uuidpbs := makeTestAgentIDs(t)
+	agents := makeTestAgents(t)
+	// Turn the second PEM into a Kelvin, so that there are two Kelvins.
+	agents[2].Info.Capabilities.CollectsData = false
+
+	var updates []*metadatapb.AgentUpdate
+	for i, agent := range agents {
+		updates = append(updates, &metadatapb.AgentUpdate{
+			AgentID: uuidpbs[i],
+			Update: &metadatapb.AgentUpdate_Agent{
+				Agent: agent,
+			},
+		})
+	}
+
+	agentsInfo := tracker.NewAgentsInfo()
+	err := agentsInfo.UpdateAgentsInfo(&metadatapb.AgentUpdatesResponse{
+		AgentUpdates: updates,
+		EndOfVersion: true,
+	})
+	require.NoError(t, err)
+	assert.Equal(t, int64(2), agentsInfo.DistributedState().MaxPartitionKelvins)
+
+	// The flag caps the number of Kelvins.
+	viper.Set("max_partition_kelvins", 1)
+	err = agentsInfo.UpdateAgentsInfo(&metadatapb.AgentUpdatesResponse{
+		AgentUpdates: updates,
+		EndOfVersion: true,
+	})
+	require.NoError(t, err)
+	assert.Equal(t, int64(1), agentsInfo.DistributedState().MaxPartitionKelvins)
+}